@@ -229,8 +229,9 @@ int main(int argc, char const *argv[]) {
                             .protocol = &CHAT_PROTOCOL_LOGIN),
              "Could not open listening socket as requested.");
   FIO_LOG_INFO("\n\tStarting plain text Chat server example app."
-               "\n\tEngine: " FIO_POLL_ENGINE_STR "\n\tWorkers: %d"
+               "\n\tEngine: %s\n\tWorkers: %d"
                "\n\tPress ^C to exit.",
+               fio_poll_engine(),
                fio_srv_workers(fio_cli_get_i("-w")));
   fio_srv_start(fio_cli_get_i("-w"));
   FIO_LOG_INFO("Shutdown complete.");
@@ -241,9 +241,10 @@ int main(int argc, char const *argv[]) {
   fio_tls_free(tls);
 
   FIO_LOG_INFO("\n\tStarting HTTP echo server example app."
-               "\n\tEngine: " FIO_POLL_ENGINE_STR "\n\tWorkers: %d\t(%s)"
+               "\n\tEngine: %s\n\tWorkers: %d\t(%s)"
                "\n\tThreads: 1+%d\t(per worker)"
                "\n\tPress ^C to exit.",
+               fio_poll_engine(),
                fio_srv_workers(fio_cli_get_i("-w")),
                (fio_srv_workers(fio_cli_get_i("-w")) ? "cluster mode"
                                                      : "single process"),
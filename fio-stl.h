@@ -93,6 +93,15 @@ Settings - Behavioral defaults
 #define FIO_USE_THREAD_MUTEX 0
 #endif
 
+#ifndef FIO_USE_POOL
+/**
+ * Selects between the memory allocator (false) and object pools (true) for the
+ * fixed size objects the server allocates most (IO handles, HTTP handles,
+ * timers, stream packets and small pub/sub messages).
+ */
+#define FIO_USE_POOL 0
+#endif
+
 #ifndef FIO_UNALIGNED_ACCESS
 /** Allows facil.io to attempt unaligned memory access on *some* CPU systems. */
 #define FIO_UNALIGNED_ACCESS 1
@@ -577,6 +586,8 @@ Static Assertions
 ***************************************************************************** */
 #if __STDC_VERSION__ >= 201112L
 #define FIO_ASSERT_STATIC(cond, msg) _Static_assert((cond), msg)
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#define FIO_ASSERT_STATIC(cond, msg) static_assert((cond), msg)
 #else
 #define FIO_ASSERT_STATIC(cond, msg)                                           \
   static const char *FIO_NAME(fio_static_assertion_failed,                     \
@@ -2391,6 +2402,12 @@ FIO_MAP Ordering & Naming Shortcut
 #define FIO_QUEUE
 #endif
 
+#if defined(FIO_POOL_NAME) || defined(FIO_REF_POOL) ||                         \
+    (FIO_USE_POOL && (defined(FIO_QUEUE) || defined(FIO_STREAM)))
+#undef FIO_STATE
+#define FIO_STATE
+#endif
+
 /* *****************************************************************************
 
 
@@ -2465,7 +2482,8 @@ FIO_MAP Ordering & Naming Shortcut
 #define FIO_RAND
 #endif
 
-#if defined(FIO_SERVER)
+#if defined(FIO_SERVER) ||                                                     \
+    (defined(FIO_MEMORY_NAME) && defined(FIO_MEMORY_PROFILE))
 #undef FIO_SIGNAL
 #define FIO_SIGNAL
 #endif
@@ -2860,6 +2878,41 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #if defined(FIO_MEMALT) && !defined(H___FIO_MEMALT___H)
 #define H___FIO_MEMALT___H 1
 
+/* *****************************************************************************
+Memory Helpers - Settings
+***************************************************************************** */
+
+#ifndef FIO_MEMALT_SIMD
+/**
+ * If true, the memory seeking, comparison and copying functions route longer
+ * buffers to SIMD kernels (SSE2 / AVX2 on x86-64, NEON on aarch64).
+ *
+ * On x86-64 the AVX2 kernels are selected once, at startup, using `cpuid`.
+ */
+#define FIO_MEMALT_SIMD 1
+#endif
+
+#ifndef FIO_MEMALT_SIMD_NEON
+/**
+ * If true (and `FIO_MEMALT_SIMD` is true), the NEON kernels are used on
+ * aarch64.
+ *
+ * The NEON kernels are experimental (untested on aarch64 hardware) and must be
+ * opted into. Otherwise aarch64 uses the portable 64 bit word implementations.
+ */
+#define FIO_MEMALT_SIMD_NEON 0
+#endif
+
+#if FIO_MEMALT_SIMD && (defined(__GNUC__) || defined(__clang__)) &&           \
+    (defined(__x86_64__) || defined(__amd64__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define FIO___MEMALT_SIMD_X86 1
+#elif FIO_MEMALT_SIMD && FIO_MEMALT_SIMD_NEON && defined(__aarch64__) &&       \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define FIO___MEMALT_SIMD_NEON 1
+#endif
+
 /* *****************************************************************************
 Memory Helpers - API
 ***************************************************************************** */
@@ -2872,32 +2925,767 @@ Memory Helpers - API
 SFUNC void *fio_memset(void *restrict dest, uint64_t data, size_t bytes);
 
 /**
- * A somewhat naive implementation of `memcpy`.
+ * A somewhat naive implementation of `memcpy` (and `memmove`).
  *
- * Probably slower than the one included with your compiler's C library.
+ * Longer copies use AVX2 when available (see `FIO_MEMALT_SIMD`).
  */
 SFUNC void *fio_memcpy(void *dest_, const void *src_, size_t bytes);
 
 /**
- * A token seeking function. This is a fallback for `memchr`, but `memchr`
- * should be faster.
+ * A token seeking function. This is a fallback for `memchr`.
+ *
+ * Longer buffers use SIMD kernels when available (see `FIO_MEMALT_SIMD`).
  */
 SFUNC void *fio_memchr(const void *buffer, const char token, size_t len);
 
 /**
- * A comparison function. This is a fallback for `memcmp`, but `memcmp`
- * should be faster.
+ * A comparison function. This is a fallback for `memcmp`.
+ *
+ * Longer buffers use SIMD kernels when available (see `FIO_MEMALT_SIMD`).
  */
 SFUNC int fio_memcmp(const void *a_, const void *b_, size_t len);
 
 /** An alternative to `strlen` - may raise Address Sanitation errors. */
 SFUNC size_t fio_strlen(const char *str);
 
+/** Returns the first occurrence of either `a` or `b` in `buffer` (or NULL). */
+SFUNC void *fio_memchr2(const void *buffer,
+                        const char a,
+                        const char b,
+                        size_t len);
+
+/** Returns the first occurrence of `a`, `b` or `c` in `buffer` (or NULL). */
+SFUNC void *fio_memchr3(const void *buffer,
+                        const char a,
+                        const char b,
+                        const char c,
+                        size_t len);
+
+/** A set of byte values (a byte class), see `fio_byte_class_init`. */
+typedef struct {
+  /** Non-zero for every byte value that belongs to the class. */
+  uint8_t map[256];
+  /* SIMD nibble lookup tables (valid only if `nibbles` is set) */
+  uint8_t lo[16];
+  uint8_t hi[16];
+  uint8_t nibbles;
+} fio_byte_class_s;
+
+/**
+ * Initializes a byte class from a 256 entry table (non-zero entries are
+ * members).
+ */
+SFUNC void fio_byte_class_init(fio_byte_class_s *dest,
+                               const uint8_t table[256]);
+
+/** Returns the first byte in `buffer` that belongs to the class (or NULL). */
+SFUNC void *fio_memchr_class(const void *buffer,
+                             const fio_byte_class_s *c,
+                             size_t len);
+
+/** Finds the first occurrence of `needle` in `haystack` (or NULL). */
+SFUNC void *fio_memmem(const void *haystack,
+                       size_t haystack_len,
+                       const void *needle,
+                       size_t needle_len);
+
 /* *****************************************************************************
 Alternatives - Implementation
 ***************************************************************************** */
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 
+/* *****************************************************************************
+SIMD kernels - shared helpers
+***************************************************************************** */
+
+/** Tests the remaining `memmem` candidates in [h, e), one at a time. */
+FIO_SFUNC void *fio___memmem_tail(const char *h,
+                                  const char *e,
+                                  const char *n,
+                                  size_t nl) {
+  for (; h < e; ++h)
+    if (h[0] == n[0] && h[nl - 1] == n[nl - 1] &&
+        !fio_memcmp(h + 1, n + 1, nl - 2))
+      return (void *)h;
+  return NULL;
+}
+
+/** Portable byte class scan (table lookup). */
+FIO_SFUNC void *fio___memchr_class_map(const char *r,
+                                       const fio_byte_class_s *c,
+                                       size_t len) {
+  const uint8_t *u = (const uint8_t *)r;
+  for (; len > 3; (u += 4), (len -= 4)) {
+    if (!(c->map[u[0]] | c->map[u[1]] | c->map[u[2]] | c->map[u[3]]))
+      continue;
+    len = 4; /* the member is in the next 4 bytes */
+    break;
+  }
+  for (; len; (++u), (--len))
+    if (c->map[*u])
+      return (void *)u;
+  return NULL;
+}
+
+/* *****************************************************************************
+SIMD kernels - x86-64 (SSE2 is part of the ABI, AVX2 is selected at startup)
+***************************************************************************** */
+#if FIO___MEMALT_SIMD_X86
+
+#define FIO___MEMALT_AVX2 __attribute__((target("avx2")))
+
+/** SSE2 `memchr` for buffers of 16 bytes or more. */
+FIO_SFUNC void *fio___memchr_sse2(const char *r, const char token, size_t len) {
+  const __m128i t = _mm_set1_epi8(token);
+  const char *const e = r + len;
+  uint32_t m;
+  for (; r + 64 <= e; r += 64) { /* test 64 bytes at a time */
+    const __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)r), t);
+    const __m128i b =
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(r + 16)), t);
+    const __m128i c =
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(r + 32)), t);
+    const __m128i d =
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(r + 48)), t);
+    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)r), t));
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)r), t));
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** AVX2 `memchr` for buffers of 16 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memchr_avx2(const char *r,
+                                                    const char token,
+                                                    size_t len) {
+  if (len < 32)
+    return fio___memchr_sse2(r, token, len);
+  const __m256i t = _mm256_set1_epi8(token);
+  const char *const e = r + len;
+  uint32_t m;
+  for (; r + 128 <= e; r += 128) { /* test 128 bytes at a time */
+    const __m256i a =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)r), t);
+    const __m256i b =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(r + 32)), t);
+    const __m256i c =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(r + 64)), t);
+    const __m256i d =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(r + 96)), t);
+    if (_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d))))
+      break;
+  }
+  for (; r + 32 <= e; r += 32) {
+    m = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)r), t));
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)r), t));
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** SSE2 `memcmp` for buffers of 16 bytes or more. */
+FIO_SFUNC int fio___memcmp_sse2(const char *a, const char *b, size_t len) {
+  size_t i = 0;
+  uint32_t m;
+  for (; i + 64 <= len; i += 64) { /* skip equal 64 byte groups */
+    __m128i eq = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                       _mm_loadu_si128((const __m128i *)(b + i))),
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i + 16)),
+                       _mm_loadu_si128((const __m128i *)(b + i + 16))));
+    eq = _mm_and_si128(
+        eq,
+        _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i + 32)),
+                           _mm_loadu_si128((const __m128i *)(b + i + 32))),
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i + 48)),
+                           _mm_loadu_si128((const __m128i *)(b + i + 48)))));
+    if (_mm_movemask_epi8(eq) != 0xFFFF)
+      break;
+  }
+  for (; i + 16 <= len; i += 16) {
+    m = 0xFFFFU ^ (uint32_t)_mm_movemask_epi8(
+                      _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                     _mm_loadu_si128((const __m128i *)(b + i))));
+    if (m)
+      goto found_diff;
+  }
+  if (i == len)
+    return 0;
+  i = len - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = 0xFFFFU ^ (uint32_t)_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                   _mm_loadu_si128((const __m128i *)(b + i))));
+  if (!m)
+    return 0;
+found_diff:
+  i += fio_lsb_index_unsafe(m);
+  return (int)1 - (int)(((uint8_t)b[i] > (uint8_t)a[i]) << 1);
+}
+
+/** AVX2 `memcmp` for buffers of 16 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 int fio___memcmp_avx2(const char *a,
+                                                  const char *b,
+                                                  size_t len) {
+  if (len < 32)
+    return fio___memcmp_sse2(a, b, len);
+  size_t i = 0;
+  uint32_t m;
+  for (; i + 128 <= len; i += 128) { /* skip equal 128 byte groups */
+    __m256i eq = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                          _mm256_loadu_si256((const __m256i *)(b + i))),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 32)),
+                          _mm256_loadu_si256((const __m256i *)(b + i + 32))));
+    eq = _mm256_and_si256(
+        eq,
+        _mm256_and_si256(
+            _mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i + 64)),
+                _mm256_loadu_si256((const __m256i *)(b + i + 64))),
+            _mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i + 96)),
+                _mm256_loadu_si256((const __m256i *)(b + i + 96)))));
+    if ((uint32_t)_mm256_movemask_epi8(eq) != 0xFFFFFFFFU)
+      break;
+  }
+  for (; i + 32 <= len; i += 32) {
+    m = ~(uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                          _mm256_loadu_si256((const __m256i *)(b + i))));
+    if (m)
+      goto found_diff;
+  }
+  if (i == len)
+    return 0;
+  i = len - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = ~(uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                        _mm256_loadu_si256((const __m256i *)(b + i))));
+  if (!m)
+    return 0;
+found_diff:
+  i += fio_lsb_index_unsafe(m);
+  return (int)1 - (int)(((uint8_t)b[i] > (uint8_t)a[i]) << 1);
+}
+
+/**
+ * SSE2 `strlen` - reads are aligned, so they never cross a page boundary (but
+ * may read before / after the string, which Address Sanitizer reports).
+ */
+FIO_SFUNC FIO___ASAN_AVOID size_t fio___strlen_sse2(const char *str) {
+  const __m128i z = _mm_setzero_si128();
+  const char *p = FIO_PTR_MATH_RMASK(const char, str, 4);
+  uint32_t m = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), z));
+  m >>= (uintptr_t)str & 15;
+  if (m)
+    return fio_lsb_index_unsafe(m);
+  for (p += 16; ((uintptr_t)p & 63); p += 16) { /* align to 64 bytes */
+    m = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+  for (;; p += 64) { /* the minimum of 64 bytes is zero if any byte is zero */
+    const __m128i mn = _mm_min_epu8(
+        _mm_min_epu8(_mm_load_si128((const __m128i *)p),
+                     _mm_load_si128((const __m128i *)(p + 16))),
+        _mm_min_epu8(_mm_load_si128((const __m128i *)(p + 32)),
+                     _mm_load_si128((const __m128i *)(p + 48))));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(mn, z)))
+      break;
+  }
+  for (;; p += 16) {
+    m = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+}
+
+/** AVX2 `strlen` (see `fio___strlen_sse2`). */
+FIO_SFUNC FIO___ASAN_AVOID FIO___MEMALT_AVX2 size_t
+fio___strlen_avx2(const char *str) {
+  const __m256i z = _mm256_setzero_si256();
+  const char *p = FIO_PTR_MATH_RMASK(const char, str, 5);
+  uint32_t m = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), z));
+  m >>= (uintptr_t)str & 31;
+  if (m)
+    return fio_lsb_index_unsafe(m);
+  for (p += 32; ((uintptr_t)p & 127); p += 32) { /* align to 128 bytes */
+    m = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+  for (;; p += 128) { /* the minimum of 128 bytes is zero if any byte is zero */
+    const __m256i mn = _mm256_min_epu8(
+        _mm256_min_epu8(_mm256_load_si256((const __m256i *)p),
+                        _mm256_load_si256((const __m256i *)(p + 32))),
+        _mm256_min_epu8(_mm256_load_si256((const __m256i *)(p + 64)),
+                        _mm256_load_si256((const __m256i *)(p + 96))));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(mn, z)))
+      break;
+  }
+  for (;; p += 32) {
+    m = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+}
+
+/**
+ * AVX2 forward copy for 64 bytes or more, returns the end of `dest`.
+ *
+ * Buffers may overlap only if `d` is more than 128 bytes before `s`.
+ */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memcpy_avx2(void *restrict d_,
+                                                    const void *restrict s_,
+                                                    size_t l) {
+  char *d = (char *)d_;
+  const char *s = (const char *)s_;
+  char *const end = d + l;
+  const __m256i head = _mm256_loadu_si256((const __m256i *)s);
+  const __m256i tail = _mm256_loadu_si256((const __m256i *)(s + l - 32));
+  const size_t skip = 32 - ((uintptr_t)d & 31); /* align stores */
+  _mm256_storeu_si256((__m256i *)d, head);
+  (d += skip), (s += skip), (l -= skip);
+  for (; l >= 128; (d += 128), (s += 128), (l -= 128)) {
+    const __m256i a = _mm256_loadu_si256((const __m256i *)s);
+    const __m256i b = _mm256_loadu_si256((const __m256i *)(s + 32));
+    const __m256i c = _mm256_loadu_si256((const __m256i *)(s + 64));
+    const __m256i e = _mm256_loadu_si256((const __m256i *)(s + 96));
+    _mm256_store_si256((__m256i *)d, a);
+    _mm256_store_si256((__m256i *)(d + 32), b);
+    _mm256_store_si256((__m256i *)(d + 64), c);
+    _mm256_store_si256((__m256i *)(d + 96), e);
+  }
+  if ((l & 64)) { /* no loop, compilers might replace it with `rep movs` */
+    const __m256i a = _mm256_loadu_si256((const __m256i *)s);
+    const __m256i b = _mm256_loadu_si256((const __m256i *)(s + 32));
+    _mm256_store_si256((__m256i *)d, a);
+    _mm256_store_si256((__m256i *)(d + 32), b);
+    (d += 64), (s += 64);
+  }
+  if ((l & 32))
+    _mm256_store_si256((__m256i *)d, _mm256_loadu_si256((const __m256i *)s));
+  _mm256_storeu_si256((__m256i *)(end - 32), tail);
+  return (void *)end;
+}
+
+/** SSE2 multi-token `memchr` (any of `a`, `b` or `c`), 16 bytes or more. */
+FIO_SFUNC void *fio___memchr3_sse2(const char *r,
+                                   const char a,
+                                   const char b,
+                                   const char c,
+                                   size_t len) {
+  const __m128i ta = _mm_set1_epi8(a);
+  const __m128i tb = _mm_set1_epi8(b);
+  const __m128i tc = _mm_set1_epi8(c);
+  const char *const e = r + len;
+  uint32_t m;
+#define FIO___MEMCHR3_TEST(ptr)                                                \
+  (uint32_t) _mm_movemask_epi8(_mm_or_si128(                                   \
+      _mm_or_si128(                                                            \
+          _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(ptr)), ta),         \
+          _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(ptr)), tb)),        \
+      _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(ptr)), tc)))
+  for (; r + 32 <= e; r += 32) { /* test 32 bytes at a time */
+    if ((FIO___MEMCHR3_TEST(r) | FIO___MEMCHR3_TEST(r + 16)))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = FIO___MEMCHR3_TEST(r);
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR3_TEST(r);
+#undef FIO___MEMCHR3_TEST
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** AVX2 multi-token `memchr` (any of `a`, `b` or `c`), 16 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memchr3_avx2(const char *r,
+                                                     const char a,
+                                                     const char b,
+                                                     const char c,
+                                                     size_t len) {
+  if (len < 32)
+    return fio___memchr3_sse2(r, a, b, c, len);
+  const __m256i ta = _mm256_set1_epi8(a);
+  const __m256i tb = _mm256_set1_epi8(b);
+  const __m256i tc = _mm256_set1_epi8(c);
+  const char *const e = r + len;
+  uint32_t m;
+#define FIO___MEMCHR3_TEST(ptr)                                                \
+  (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(                             \
+      _mm256_or_si256(                                                         \
+          _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(ptr)), ta),   \
+          _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(ptr)), tb)),  \
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(ptr)), tc)))
+  for (; r + 64 <= e; r += 64) { /* test 64 bytes at a time */
+    if ((FIO___MEMCHR3_TEST(r) | FIO___MEMCHR3_TEST(r + 32)))
+      break;
+  }
+  for (; r + 32 <= e; r += 32) {
+    m = FIO___MEMCHR3_TEST(r);
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR3_TEST(r);
+#undef FIO___MEMCHR3_TEST
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** AVX2 byte class scan (nibble lookup, `pshufb`), 32 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memchr_class_avx2(
+    const char *r,
+    const fio_byte_class_s *c,
+    size_t len) {
+  const __m256i lo =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)c->lo));
+  const __m256i hi =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)c->hi));
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i z = _mm256_setzero_si256();
+  const char *const e = r + len;
+  uint32_t m;
+#define FIO___MEMCHR_CLASS_TEST(ptr)                                           \
+  ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(                           \
+      _mm256_and_si256(                                                        \
+          _mm256_shuffle_epi8(                                                 \
+              lo,                                                              \
+              _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(ptr)),     \
+                               nibble)),                                       \
+          _mm256_shuffle_epi8(                                                 \
+              hi,                                                              \
+              _mm256_and_si256(                                                \
+                  _mm256_srli_epi16(                                           \
+                      _mm256_loadu_si256((const __m256i *)(ptr)),              \
+                      4),                                                      \
+                  nibble))),                                                   \
+      z))
+  for (; r + 32 <= e; r += 32) {
+    m = FIO___MEMCHR_CLASS_TEST(r);
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR_CLASS_TEST(r);
+#undef FIO___MEMCHR_CLASS_TEST
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/**
+ * SSE2 `memmem` - tests the needle's first and last bytes for 16 positions at a
+ * time. Requires `2 <= nl <= hl`.
+ */
+FIO_SFUNC void *fio___memmem_sse2(const char *h,
+                                  size_t hl,
+                                  const char *n,
+                                  size_t nl) {
+  const __m128i first = _mm_set1_epi8(n[0]);
+  const __m128i last = _mm_set1_epi8(n[nl - 1]);
+  const char *const e = h + (hl - nl) + 1; /* candidates are in [h, e) */
+  for (; h + 16 <= e; h += 16) {
+    uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)h), first),
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(h + nl - 1)), last)));
+    for (; m; m &= m - 1) {
+      const char *p = h + fio_lsb_index_unsafe(m);
+      if (!fio_memcmp(p + 1, n + 1, nl - 2))
+        return (void *)p;
+    }
+  }
+  return fio___memmem_tail(h, e, n, nl);
+}
+
+/** AVX2 `memmem` (see `fio___memmem_sse2`). */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memmem_avx2(const char *h,
+                                                    size_t hl,
+                                                    const char *n,
+                                                    size_t nl) {
+  const __m256i first = _mm256_set1_epi8(n[0]);
+  const __m256i last = _mm256_set1_epi8(n[nl - 1]);
+  const char *const e = h + (hl - nl) + 1; /* candidates are in [h, e) */
+  for (; h + 32 <= e; h += 32) {
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)h), first),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(h + nl - 1)),
+                          last)));
+    for (; m; m &= m - 1) {
+      const char *p = h + fio_lsb_index_unsafe(m);
+      if (!fio_memcmp(p + 1, n + 1, nl - 2))
+        return (void *)p;
+    }
+  }
+  return fio___memmem_tail(h, e, n, nl);
+}
+
+/* the kernels in use - SSE2 until AVX2 support is detected (at startup) */
+static struct {
+  void *(*chr)(const char *, const char, size_t);
+  int (*cmp)(const char *, const char *, size_t);
+  size_t (*len)(const char *);
+  void *(*cpy)(void *restrict, const void *restrict, size_t);
+  void *(*chr3)(const char *, const char, const char, const char, size_t);
+  void *(*cls)(const char *, const fio_byte_class_s *, size_t);
+  void *(*mem)(const char *, size_t, const char *, size_t);
+} fio___memalt_simd = {
+    fio___memchr_sse2,
+    fio___memcmp_sse2,
+    fio___strlen_sse2,
+    fio___memcpy_unsafe_x,
+    fio___memchr3_sse2,
+    fio___memchr_class_map, /* SSE2 has no byte shuffle (pshufb) */
+    fio___memmem_sse2,
+};
+
+/* selects the best kernels supported by the CPU (cpuid) */
+FIO_CONSTRUCTOR(fio___memalt_simd_select) {
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("avx2"))
+    return;
+  fio___memalt_simd.chr = fio___memchr_avx2;
+  fio___memalt_simd.cmp = fio___memcmp_avx2;
+  fio___memalt_simd.len = fio___strlen_avx2;
+  fio___memalt_simd.cpy = fio___memcpy_avx2;
+  fio___memalt_simd.chr3 = fio___memchr3_avx2;
+  fio___memalt_simd.cls = fio___memchr_class_avx2;
+  fio___memalt_simd.mem = fio___memmem_avx2;
+}
+
+#undef FIO___MEMALT_AVX2
+
+/* *****************************************************************************
+SIMD kernels - aarch64 (NEON is part of the ABI)
+***************************************************************************** */
+#elif FIO___MEMALT_SIMD_NEON
+
+/** Packs a NEON byte comparison into a 64 bit map (4 bits per byte). */
+FIO_IFUNC uint64_t fio___memalt_neon_map(uint8x16_t eq) {
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)),
+      0);
+}
+
+/** NEON `memchr` for buffers of 16 bytes or more. */
+FIO_SFUNC void *fio___memchr_neon(const char *r, const char token, size_t len) {
+  const uint8x16_t t = vdupq_n_u8((uint8_t)token);
+  const char *const e = r + len;
+  uint64_t m;
+  for (; r + 64 <= e; r += 64) { /* test 64 bytes at a time */
+    const uint8x16_t a = vceqq_u8(vld1q_u8((const uint8_t *)r), t);
+    const uint8x16_t b = vceqq_u8(vld1q_u8((const uint8_t *)(r + 16)), t);
+    const uint8x16_t c = vceqq_u8(vld1q_u8((const uint8_t *)(r + 32)), t);
+    const uint8x16_t d = vceqq_u8(vld1q_u8((const uint8_t *)(r + 48)), t);
+    if (vmaxvq_u8(vorrq_u8(vorrq_u8(a, b), vorrq_u8(c, d))))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)r), t));
+    if (m)
+      return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)r), t));
+  if (m)
+    return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  return NULL;
+}
+
+/** NEON `memcmp` for buffers of 16 bytes or more. */
+FIO_SFUNC int fio___memcmp_neon(const char *a, const char *b, size_t len) {
+  size_t i = 0;
+  uint64_t m;
+  for (; i + 64 <= len; i += 64) { /* skip equal 64 byte groups */
+    uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(a + i)),
+                                      vld1q_u8((const uint8_t *)(b + i))),
+                             vceqq_u8(vld1q_u8((const uint8_t *)(a + i + 16)),
+                                      vld1q_u8((const uint8_t *)(b + i + 16))));
+    eq = vandq_u8(eq,
+                  vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(a + i + 32)),
+                                    vld1q_u8((const uint8_t *)(b + i + 32))),
+                           vceqq_u8(vld1q_u8((const uint8_t *)(a + i + 48)),
+                                    vld1q_u8((const uint8_t *)(b + i + 48)))));
+    if (vminvq_u8(eq) != 0xFF)
+      break;
+  }
+  for (; i + 16 <= len; i += 16) {
+    m = fio___memalt_neon_map(
+        vmvnq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(a + i)),
+                          vld1q_u8((const uint8_t *)(b + i)))));
+    if (m)
+      goto found_diff;
+  }
+  if (i == len)
+    return 0;
+  i = len - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = fio___memalt_neon_map(vmvnq_u8(vceqq_u8(
+      vld1q_u8((const uint8_t *)(a + i)), vld1q_u8((const uint8_t *)(b + i)))));
+  if (!m)
+    return 0;
+found_diff:
+  i += fio_lsb_index_unsafe(m) >> 2;
+  return (int)1 - (int)(((uint8_t)b[i] > (uint8_t)a[i]) << 1);
+}
+
+/** NEON `strlen` (aligned reads, see `fio_strlen`). */
+FIO_SFUNC FIO___ASAN_AVOID size_t fio___strlen_neon(const char *str) {
+  const uint8x16_t z = vdupq_n_u8(0);
+  const char *p = FIO_PTR_MATH_RMASK(const char, str, 4);
+  uint64_t m =
+      fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)p), z));
+  m >>= ((uintptr_t)str & 15) << 2;
+  if (m)
+    return fio_lsb_index_unsafe(m) >> 2;
+  for (p += 16; ((uintptr_t)p & 63); p += 16) { /* align to 64 bytes */
+    m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)p), z));
+    if (m)
+      return (size_t)(p - str) + (fio_lsb_index_unsafe(m) >> 2);
+  }
+  for (;; p += 64) { /* the minimum of 64 bytes is zero if any byte is zero */
+    const uint8x16_t mn =
+        vminq_u8(vminq_u8(vld1q_u8((const uint8_t *)p),
+                          vld1q_u8((const uint8_t *)(p + 16))),
+                 vminq_u8(vld1q_u8((const uint8_t *)(p + 32)),
+                          vld1q_u8((const uint8_t *)(p + 48))));
+    if (!vminvq_u8(mn))
+      break;
+  }
+  for (;; p += 16) {
+    m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)p), z));
+    if (m)
+      return (size_t)(p - str) + (fio_lsb_index_unsafe(m) >> 2);
+  }
+}
+
+/** NEON multi-token `memchr` (any of `a`, `b` or `c`), 16 bytes or more. */
+FIO_SFUNC void *fio___memchr3_neon(const char *r,
+                                   const char a,
+                                   const char b,
+                                   const char c,
+                                   size_t len) {
+  const uint8x16_t ta = vdupq_n_u8((uint8_t)a);
+  const uint8x16_t tb = vdupq_n_u8((uint8_t)b);
+  const uint8x16_t tc = vdupq_n_u8((uint8_t)c);
+  const char *const e = r + len;
+  uint64_t m;
+#define FIO___MEMCHR3_TEST(ptr)                                                \
+  vorrq_u8(vorrq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(ptr)), ta),            \
+                    vceqq_u8(vld1q_u8((const uint8_t *)(ptr)), tb)),           \
+           vceqq_u8(vld1q_u8((const uint8_t *)(ptr)), tc))
+  for (; r + 32 <= e; r += 32) { /* test 32 bytes at a time */
+    if (vmaxvq_u8(vorrq_u8(FIO___MEMCHR3_TEST(r), FIO___MEMCHR3_TEST(r + 16))))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = fio___memalt_neon_map(FIO___MEMCHR3_TEST(r));
+    if (m)
+      return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = fio___memalt_neon_map(FIO___MEMCHR3_TEST(r));
+#undef FIO___MEMCHR3_TEST
+  if (m)
+    return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  return NULL;
+}
+
+/** NEON byte class scan (nibble lookup, `tbl`), 16 bytes or more. */
+FIO_SFUNC void *fio___memchr_class_neon(const char *r,
+                                        const fio_byte_class_s *c,
+                                        size_t len) {
+  const uint8x16_t lo = vld1q_u8(c->lo);
+  const uint8x16_t hi = vld1q_u8(c->hi);
+  const uint8x16_t nibble = vdupq_n_u8(0x0F);
+  const char *const e = r + len;
+  uint64_t m;
+#define FIO___MEMCHR_CLASS_TEST(ptr)                                           \
+  fio___memalt_neon_map(                                                       \
+      vtstq_u8(vqtbl1q_u8(lo,                                                  \
+                          vandq_u8(vld1q_u8((const uint8_t *)(ptr)), nibble)), \
+               vqtbl1q_u8(hi, vshrq_n_u8(vld1q_u8((const uint8_t *)(ptr)), 4))))
+  for (; r + 16 <= e; r += 16) {
+    m = FIO___MEMCHR_CLASS_TEST(r);
+    if (m)
+      return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR_CLASS_TEST(r);
+#undef FIO___MEMCHR_CLASS_TEST
+  if (m)
+    return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  return NULL;
+}
+
+/** NEON `memmem` - tests the needle's first and last bytes (`2 <= nl <= hl`). */
+FIO_SFUNC void *fio___memmem_neon(const char *h,
+                                  size_t hl,
+                                  const char *n,
+                                  size_t nl) {
+  const uint8x16_t first = vdupq_n_u8((uint8_t)n[0]);
+  const uint8x16_t last = vdupq_n_u8((uint8_t)n[nl - 1]);
+  const char *const e = h + (hl - nl) + 1; /* candidates are in [h, e) */
+  for (; h + 16 <= e; h += 16) {
+    uint64_t m = fio___memalt_neon_map(
+        vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)h), first),
+                 vceqq_u8(vld1q_u8((const uint8_t *)(h + nl - 1)), last)));
+    for (m &= UINT64_C(0x1111111111111111); m; m &= m - 1) {
+      const char *p = h + (fio_lsb_index_unsafe(m) >> 2);
+      if (!fio_memcmp(p + 1, n + 1, nl - 2))
+        return (void *)p;
+    }
+  }
+  return fio___memmem_tail(h, e, n, nl);
+}
+
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+
 /* *****************************************************************************
 FIO_MEMCPY / fio_memcpy - memcpy fallback
 ***************************************************************************** */
@@ -3001,6 +3789,10 @@ SFUNC void *fio_memcpy(void *dest_, const void *src_, size_t bytes) {
 
   if (s + bytes <= d || d + bytes <= s ||
       (uintptr_t)d + FIO___MEMCPY_BLOCKx_NUM < (uintptr_t)s) {
+#if FIO___MEMALT_SIMD_X86
+    if (bytes > 127)
+      return fio___memalt_simd.cpy(d, s, bytes);
+#endif /* FIO___MEMALT_SIMD_X86 */
     return fio___memcpy_unsafe_x(d, s, bytes);
   } else if (d < s) { /* memory overlaps at end (copy forward, use buffer) */
     return fio___memcpy_buffered_x(d, s, bytes);
@@ -3136,6 +3928,13 @@ FIO_SFUNC void *fio_memchr_small(const void *buffer,
 SFUNC void *fio_memchr(const void *buffer, const char token, size_t len) {
   if (!buffer || !len)
     return NULL;
+#if FIO___MEMALT_SIMD_X86
+  if (len > 15)
+    return fio___memalt_simd.chr((const char *)buffer, token, len);
+#elif FIO___MEMALT_SIMD_NEON
+  if (len > 15)
+    return fio___memchr_neon((const char *)buffer, token, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
   if (len < 64)
     return fio_memchr_small(buffer, token, len);
   const char *r = (const char *)buffer;
@@ -3251,6 +4050,11 @@ SFUNC FIO___ASAN_AVOID size_t fio_strlen(const char *str) {
   // return (size_t)(nul - str);
   if (!str)
     return 0;
+#if FIO___MEMALT_SIMD_X86
+  return fio___memalt_simd.len(str);
+#elif FIO___MEMALT_SIMD_NEON
+  return fio___strlen_neon(str);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
   uintptr_t start = (uintptr_t)str;
   /* we must align memory, to avoid crushing when nearing last page boundary */
   switch ((start & 7)) {
@@ -3392,6 +4196,11 @@ SFUNC int fio_memcmp(const void *a_, const void *b_, size_t len) {
     return fio___memcmp_mini(a, b, len);
   if (len < 16)
     return fio___memcmp8(a, b, len);
+#if FIO___MEMALT_SIMD_X86
+  return fio___memalt_simd.cmp(a, b, len);
+#elif FIO___MEMALT_SIMD_NEON
+  return fio___memcmp_neon(a, b, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
   if (len < 32)
     return fio___memcmp16(a, b, len);
   if (len < 1024)
@@ -3407,6 +4216,163 @@ SFUNC int fio_memcmp(const void *a_, const void *b_, size_t len) {
 #endif /* FIO_LIMIT_INTRINSIC_BUFFER */
 }
 
+/* *****************************************************************************
+fio_memchr2 / fio_memchr3
+***************************************************************************** */
+
+/** Portable multi-token `memchr` - tests 8 bytes at a time. */
+FIO_SFUNC void *fio___memchr3_word(const char *r,
+                                   const char a,
+                                   const char b,
+                                   const char c,
+                                   size_t len) {
+  const uint64_t ma = UINT64_C(0x0101010101010101) * (uint8_t)a;
+  const uint64_t mb = UINT64_C(0x0101010101010101) * (uint8_t)b;
+  const uint64_t mc = UINT64_C(0x0101010101010101) * (uint8_t)c;
+  for (; len > 7; (r += 8), (len -= 8)) {
+    uint64_t w, f = 0;
+    fio_memcpy8(&w, r);
+#define FIO___MEMCHR3_HAS_ZERO(u)                                              \
+  (((u)-UINT64_C(0x0101010101010101)) & (~(u)) & UINT64_C(0x8080808080808080))
+    f |= FIO___MEMCHR3_HAS_ZERO(w ^ ma);
+    f |= FIO___MEMCHR3_HAS_ZERO(w ^ mb);
+    f |= FIO___MEMCHR3_HAS_ZERO(w ^ mc);
+#undef FIO___MEMCHR3_HAS_ZERO
+    if (f)
+      break; /* the token is in the next 8 bytes */
+  }
+  for (; len; (++r), (--len))
+    if (*r == a || *r == b || *r == c)
+      return (void *)r;
+  return NULL;
+}
+
+/** Returns the first occurrence of either `a` or `b` in `buffer` (or NULL). */
+SFUNC void *fio_memchr2(const void *buffer,
+                        const char a,
+                        const char b,
+                        size_t len) {
+  return fio_memchr3(buffer, a, b, b, len);
+}
+
+/** Returns the first occurrence of `a`, `b` or `c` in `buffer` (or NULL). */
+SFUNC void *fio_memchr3(const void *buffer,
+                        const char a,
+                        const char b,
+                        const char c,
+                        size_t len) {
+  if (!buffer || !len)
+    return NULL;
+#if FIO___MEMALT_SIMD_X86
+  if (len > 15)
+    return fio___memalt_simd.chr3((const char *)buffer, a, b, c, len);
+#elif FIO___MEMALT_SIMD_NEON
+  if (len > 15)
+    return fio___memchr3_neon((const char *)buffer, a, b, c, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+  return fio___memchr3_word((const char *)buffer, a, b, c, len);
+}
+
+/* *****************************************************************************
+Byte classes (fio_memchr_class)
+***************************************************************************** */
+
+/**
+ * Initializes a byte class from a 256 entry table (non-zero entries are
+ * members).
+ *
+ * SIMD lookups split each byte into two nibbles and test
+ * `lo[byte & 15] & hi[byte >> 4]`. This is exact as long as the table holds no
+ * more than 8 distinct (non-empty) rows of 16 bytes - which covers most
+ * delimiter sets. Otherwise the class is scanned one byte at a time.
+ */
+SFUNC void fio_byte_class_init(fio_byte_class_s *dest,
+                               const uint8_t table[256]) {
+  uint16_t rows[8];
+  size_t count = 0;
+  FIO_MEMSET(dest, 0, sizeof(*dest));
+  dest->nibbles = 1;
+  for (size_t h = 0; h < 16; ++h) {
+    uint16_t row = 0;
+    for (size_t l = 0; l < 16; ++l) {
+      dest->map[(h << 4) | l] = !!table[(h << 4) | l];
+      row |= (uint16_t)(dest->map[(h << 4) | l] << l);
+    }
+    if (!row)
+      continue;
+    size_t k = 0;
+    while (k < count && rows[k] != row)
+      ++k;
+    if (k == count) {
+      if (count == 8) { /* too many distinct rows for 8 bit nibble tables */
+        dest->nibbles = 0;
+        continue;
+      }
+      rows[count++] = row;
+    }
+    dest->hi[h] |= (uint8_t)(1U << k);
+  }
+  if (!dest->nibbles) {
+    FIO_MEMSET(dest->lo, 0, sizeof(dest->lo));
+    FIO_MEMSET(dest->hi, 0, sizeof(dest->hi));
+    return;
+  }
+  for (size_t k = 0; k < count; ++k)
+    for (size_t l = 0; l < 16; ++l)
+      if ((rows[k] >> l) & 1)
+        dest->lo[l] |= (uint8_t)(1U << k);
+}
+
+/** Returns the first byte in `buffer` that belongs to the class (or NULL). */
+SFUNC void *fio_memchr_class(const void *buffer,
+                             const fio_byte_class_s *c,
+                             size_t len) {
+  if (!buffer || !len || !c)
+    return NULL;
+#if FIO___MEMALT_SIMD_X86
+  if (c->nibbles && len > 31)
+    return fio___memalt_simd.cls((const char *)buffer, c, len);
+#elif FIO___MEMALT_SIMD_NEON
+  if (c->nibbles && len > 15)
+    return fio___memchr_class_neon((const char *)buffer, c, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+  return fio___memchr_class_map((const char *)buffer, c, len);
+}
+
+/* *****************************************************************************
+fio_memmem
+***************************************************************************** */
+
+/** Finds the first occurrence of `needle` in `haystack` (or NULL). */
+SFUNC void *fio_memmem(const void *haystack,
+                       size_t haystack_len,
+                       const void *needle,
+                       size_t needle_len) {
+  const char *h = (const char *)haystack;
+  const char *n = (const char *)needle;
+  if (!needle_len)
+    return (void *)h;
+  if (!h || !n || needle_len > haystack_len)
+    return NULL;
+  if (needle_len == 1)
+    return fio_memchr(h, n[0], haystack_len);
+#if FIO___MEMALT_SIMD_X86
+  return fio___memalt_simd.mem(h, haystack_len, n, needle_len);
+#elif FIO___MEMALT_SIMD_NEON
+  return fio___memmem_neon(h, haystack_len, n, needle_len);
+#else
+  /* seek the first byte, test the last byte, then compare the rest */
+  const char *const e = h + (haystack_len - needle_len) + 1;
+  while ((h = (const char *)fio_memchr(h, n[0], (size_t)(e - h)))) {
+    if (h[needle_len - 1] == n[needle_len - 1] &&
+        !fio_memcmp(h + 1, n + 1, needle_len - 2))
+      return (void *)h;
+    ++h;
+  }
+  return NULL;
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+}
+
 /* *****************************************************************************
 Alternatives - cleanup
 ***************************************************************************** */
@@ -9596,6 +10562,7 @@ typedef enum {
 #define FIO_SOCK_UNIX         0
 #define FIO_SOCK_UNIX_PRIVATE 0
 #endif
+  FIO_SOCK_REUSEPORT = 64,
 } fio_sock_open_flags_e;
 
 /**
@@ -9625,8 +10592,13 @@ FIO_IFUNC struct addrinfo *fio_sock_address_new(const char *restrict address,
 /** Frees the pointer returned by `fio_sock_address_new`. */
 FIO_IFUNC void fio_sock_address_free(struct addrinfo *a);
 
-/** Creates a new network socket and binds it to a local address. */
-SFUNC int fio_sock_open_local(struct addrinfo *addr, int nonblock);
+/**
+ * Creates a new network socket and binds it to a local address.
+ *
+ * `flags` may be a boolean (non-blocking) or a combination of
+ * `FIO_SOCK_NONBLOCK` and `FIO_SOCK_REUSEPORT`.
+ */
+SFUNC int fio_sock_open_local(struct addrinfo *addr, int flags);
 
 /** Creates a new network socket and connects it to a remote address. */
 SFUNC int fio_sock_open_remote(struct addrinfo *addr, int nonblock);
@@ -9687,7 +10659,9 @@ FIO_IFUNC int fio_sock_open(const char *restrict address,
     if ((flags & FIO_SOCK_CLIENT)) {
       fd = fio_sock_open_remote(addr, (flags & FIO_SOCK_NONBLOCK));
     } else {
-      fd = fio_sock_open_local(addr, (flags & FIO_SOCK_NONBLOCK));
+      fd = fio_sock_open_local(
+          addr,
+          (flags & ((int)FIO_SOCK_NONBLOCK | (int)FIO_SOCK_REUSEPORT)));
       if (fd != -1 && listen(fd, SOMAXCONN) == -1) {
         FIO_LOG_ERROR("(fio_sock_open) failed on call to listen: %s",
                       strerror(errno));
@@ -9706,7 +10680,9 @@ FIO_IFUNC int fio_sock_open(const char *restrict address,
     if ((flags & FIO_SOCK_CLIENT)) {
       fd = fio_sock_open_remote(addr, (flags & FIO_SOCK_NONBLOCK));
     } else {
-      fd = fio_sock_open_local(addr, (flags & FIO_SOCK_NONBLOCK));
+      fd = fio_sock_open_local(
+          addr,
+          (flags & ((int)FIO_SOCK_NONBLOCK | (int)FIO_SOCK_REUSEPORT)));
     }
     fio_sock_address_free(addr);
     return fd;
@@ -9865,7 +10841,7 @@ SFUNC int fio_sock_set_non_block(int fd) {
 }
 
 /** Creates a new network socket and binds it to a local address. */
-SFUNC int fio_sock_open_local(struct addrinfo *addr, int nonblock) {
+SFUNC int fio_sock_open_local(struct addrinfo *addr, int flags) {
   int fd = -1;
   for (struct addrinfo *p = addr; p != NULL; p = p->ai_next) {
 #if FIO_OS_WIN
@@ -9890,8 +10866,18 @@ SFUNC int fio_sock_open_local(struct addrinfo *addr, int nonblock) {
       // avoid the "address taken"
       int optval = 1;
       setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (void *)&optval, sizeof(optval));
-    }
-    if (nonblock && fio_sock_set_non_block(fd) == -1) {
+#ifdef SO_REUSEPORT
+      // share the port with other sockets (the kernel load-balances them)
+      if ((flags & FIO_SOCK_REUSEPORT))
+        setsockopt(fd,
+                   SOL_SOCKET,
+                   SO_REUSEPORT,
+                   (void *)&optval,
+                   sizeof(optval));
+#endif
+    }
+    if ((flags & ~(int)FIO_SOCK_REUSEPORT) &&
+        fio_sock_set_non_block(fd) == -1) {
       FIO_LOG_DEBUG("Couldn't set socket (%d) to non-blocking mode %s",
                     fd,
                     strerror(errno));
@@ -10272,9 +11258,9 @@ typedef struct {
 } fio___state_task_s;
 
 FIO_IFUNC uint64_t fio___state_callback_hash_fn(fio___state_task_s *t) {
-  uint64_t hash = fio_risky_ptr((void *)(uintptr_t)(t->func));
-  hash ^= hash + fio_risky_ptr(t->arg);
-  return hash;
+  /* note: `h ^ (h + x)` collides for most `h` values when `x` is constant */
+  return fio_risky_num((uint64_t)(uintptr_t)t->arg,
+                       fio_risky_ptr((void *)(uintptr_t)(t->func)));
 }
 
 #define FIO_STATE_CALLBACK_IS_VALID(pobj) ((pobj)->func)
@@ -12101,15 +13087,19 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, free)(void *ptr);
 
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  */
 SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc)(void *ptr,
                                                              size_t new_size);
 
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  *
  * This variation is slightly faster as it might copy less data.
  */
@@ -12134,6 +13124,15 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size);
  */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void);
 
+/**
+ * Returns idle cached system allocations to the system, according to the
+ * FIO_MEMORY_CACHE_DECAY policy (does nothing if the policy is disabled).
+ *
+ * Called automatically by the `FIO_CALL_ON_IDLE` state callback. Could also be
+ * called by a timer, so memory is released while the process is idle.
+ */
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)(void);
+
 /* *****************************************************************************
 Memory Allocation - configuration macros
 
@@ -12166,6 +13165,18 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_CACHE_SLOTS 4
 #endif
 
+#ifndef FIO_MEMORY_CACHE_DECAY
+/**
+ * The number of milliseconds after which an idle cached system allocation is
+ * released to the system (using `madvise`, the mapping is kept).
+ *
+ * After twice this time, the idle cached allocation is unmapped.
+ *
+ * Zero (the default) disables the decay (cached allocations are kept).
+ */
+#define FIO_MEMORY_CACHE_DECAY 0
+#endif
+
 #ifndef FIO_MEMORY_INITIALIZE_ALLOCATIONS
 /**
  * Forces the allocator to zero out memory early and often, so allocations
@@ -12204,6 +13215,17 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_ENABLE_BIG_ALLOC 1
 #endif
 
+#ifndef FIO_MEMORY_SLAB_LIMIT
+/**
+ * Allocations of up to this many bytes are served from size-class slabs
+ * (blocks dedicated to a single allocation size, tracked by a bitmap).
+ *
+ * Freed slab slots are reused right away, so a long lived allocation doesn't
+ * pin a whole block. Zero (the default) disables slabs. Limited to 1024 bytes.
+ */
+#define FIO_MEMORY_SLAB_LIMIT 0
+#endif
+
 #ifndef FIO_MEMORY_ARENA_COUNT
 /**
  * Memory arenas mitigate thread contention while using more memory.
@@ -12216,6 +13238,23 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_ARENA_COUNT -1
 #endif
 
+#ifndef FIO_MEMORY_THREAD_CACHE
+/**
+ * If true, each thread slices a private block before falling back to the
+ * (locked) arenas, so most allocations never touch an arena lock.
+ *
+ * The block is returned to the allocator when the thread exits.
+ *
+ * Requires POSIX threads (`pthread_key_create`), ignored otherwise.
+ */
+#define FIO_MEMORY_THREAD_CACHE 0
+#endif
+
+#if FIO_MEMORY_THREAD_CACHE && !FIO_OS_POSIX
+#undef FIO_MEMORY_THREAD_CACHE
+#define FIO_MEMORY_THREAD_CACHE 0
+#endif
+
 #ifndef FIO_MEMORY_ARENA_COUNT_FALLBACK
 /*
  * Used when dynamic arena count calculations fail.
@@ -12240,6 +13279,73 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_WARMUP 0
 #endif
 
+#ifndef FIO_MEMORY_HUGE_PAGES
+/**
+ * Backs allocator chunks with 2MB huge pages, reducing TLB misses.
+ *
+ * - 0: disabled (default).
+ * - 1: transparent huge pages (`madvise(MADV_HUGEPAGE)`).
+ * - 2: explicit huge pages (`MAP_HUGETLB`), falling back to transparent huge
+ *      pages when the system has no huge pages reserved.
+ *
+ * Chunks are aligned to 2MB, so FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG should be
+ * 21 or more (otherwise the setting is ignored). POSIX only.
+ */
+#define FIO_MEMORY_HUGE_PAGES 0
+#endif
+
+#ifndef FIO_MEMORY_NUMA
+/**
+ * If true, arenas are grouped by NUMA node. Threads use the arenas of the node
+ * they are running on and new chunks are bound (`mbind`) to that node.
+ *
+ * On single node machines the allocator behaves as if NUMA mode was disabled.
+ * Linux only, ignored otherwise.
+ */
+#define FIO_MEMORY_NUMA 0
+#endif
+
+#ifndef FIO_MEMORY_NUMA_MAX_NODES
+/**
+ * The maximum number of NUMA nodes (when FIO_MEMORY_NUMA is true). Nodes above
+ * the limit share arenas with lower nodes and their chunks aren't bound.
+ *
+ * Limited to 64 nodes.
+ */
+#define FIO_MEMORY_NUMA_MAX_NODES 8
+#endif
+
+#if FIO_MEMORY_NUMA && !defined(__linux__)
+#undef FIO_MEMORY_NUMA
+#define FIO_MEMORY_NUMA 0
+#endif
+
+#ifndef FIO_MEMORY_PROFILE
+/**
+ * Enables the sampling heap profiler when set to the average number of bytes
+ * between samples (i.e., 524288 samples about once every 512Kb allocated).
+ *
+ * Sampled allocations record a backtrace and are tracked until freed, so the
+ * live heap can be dumped using `malloc_profile_dump`.
+ *
+ * Defaults to 0 (disabled, no profiling code is compiled).
+ */
+#define FIO_MEMORY_PROFILE 0
+#endif
+
+#ifndef FIO_MEMORY_PROFILE_DEPTH
+/** The maximum number of stack frames recorded for each sample. */
+#define FIO_MEMORY_PROFILE_DEPTH 32
+#endif
+
+#ifndef FIO_MEMORY_PROFILE_SLOTS
+/**
+ * The maximum number of live samples tracked by the heap profiler (rounded up
+ * to a power of 2). When the table is full, new samples are dropped.
+ */
+#define FIO_MEMORY_PROFILE_SLOTS 1024
+#endif
+
 #ifndef FIO_MEMORY_USE_THREAD_MUTEX
 #if FIO_USE_THREAD_MUTEX_TMP
 #define FIO_MEMORY_USE_THREAD_MUTEX 1
@@ -12287,6 +13393,46 @@ Memory Allocation - configuration value - results and constants
 #undef FIO_MEMORY_SYS_ALLOCATION_SIZE
 #undef FIO_MEMORY_BLOCK_ALLOC_LIMIT
 
+#if FIO_MEMORY_HUGE_PAGES &&                                                   \
+    (!FIO_OS_POSIX || FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG < 21)
+#undef FIO_MEMORY_HUGE_PAGES
+#define FIO_MEMORY_HUGE_PAGES 0
+#endif
+
+/* the heap profiler collects backtraces using `execinfo.h` */
+#if FIO_MEMORY_PROFILE && defined(__has_include)
+#if !__has_include(<execinfo.h>)
+#undef FIO_MEMORY_PROFILE
+#define FIO_MEMORY_PROFILE 0
+#endif
+#elif FIO_MEMORY_PROFILE && !FIO_OS_POSIX
+#undef FIO_MEMORY_PROFILE
+#define FIO_MEMORY_PROFILE 0
+#endif
+
+#if FIO_MEMORY_PROFILE
+#if FIO_MEMORY_PROFILE < 0
+#undef FIO_MEMORY_PROFILE
+#define FIO_MEMORY_PROFILE 524288
+#endif
+#if FIO_MEMORY_PROFILE_DEPTH < 2
+#undef FIO_MEMORY_PROFILE_DEPTH
+#define FIO_MEMORY_PROFILE_DEPTH 2
+#endif
+#undef FIO_MEMORY_PROFILE_SLOTS_LOG
+#if FIO_MEMORY_PROFILE_SLOTS <= 64
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 6
+#elif FIO_MEMORY_PROFILE_SLOTS <= 256
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 8
+#elif FIO_MEMORY_PROFILE_SLOTS <= 1024
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 10
+#elif FIO_MEMORY_PROFILE_SLOTS <= 4096
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 12
+#else
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 14
+#endif
+#endif /* FIO_MEMORY_PROFILE */
+
 #if FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG < 0 ||                                \
     FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG > 5
 #undef FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG
@@ -12319,6 +13465,28 @@ Memory Allocation - configuration value - results and constants
 #define FIO_MEMORY_ALLOC_LIMIT FIO_MEMORY_BLOCK_ALLOC_LIMIT
 #endif
 
+#undef FIO_MEMORY_SLAB_CLASSES
+#if FIO_MEMORY_SLAB_LIMIT > 1024
+#undef FIO_MEMORY_SLAB_LIMIT
+#define FIO_MEMORY_SLAB_LIMIT 1024
+#endif
+/** the number of slab size classes (one class per allocation unit count) */
+#define FIO_MEMORY_SLAB_CLASSES (FIO_MEMORY_SLAB_LIMIT >> FIO_MEMORY_ALIGN_LOG)
+
+/** the number of free block lists (one per NUMA node) */
+#if FIO_MEMORY_NUMA
+#if FIO_MEMORY_NUMA_MAX_NODES > 64
+#undef FIO_MEMORY_NUMA_MAX_NODES
+#define FIO_MEMORY_NUMA_MAX_NODES 64
+#elif FIO_MEMORY_NUMA_MAX_NODES < 1
+#undef FIO_MEMORY_NUMA_MAX_NODES
+#define FIO_MEMORY_NUMA_MAX_NODES 1
+#endif
+#define FIO_MEMORY_NUMA_LISTS FIO_MEMORY_NUMA_MAX_NODES
+#else
+#define FIO_MEMORY_NUMA_LISTS 1
+#endif
+
 /* *****************************************************************************
 Memory Allocation - configuration access - UNSTABLE API!!!
 ***************************************************************************** */
@@ -12330,6 +13498,9 @@ FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_sys_alloc_size)(void) {
 FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_cache_slots)(void) {
   return FIO_MEMORY_CACHE_SLOTS;
 }
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay_time)(void) {
+  return (FIO_MEMORY_CACHE_SLOTS ? FIO_MEMORY_CACHE_DECAY : 0);
+}
 FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_alignment)(void) {
   return FIO_MEMORY_ALIGN_SIZE;
 }
@@ -12364,6 +13535,125 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_free_block_list)(void);
 /** Prints the settings used to define the allocator. */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void);
 
+/* *****************************************************************************
+Memory Allocation - statistics
+***************************************************************************** */
+
+/** Allocator wide statistics, see `malloc_stats`. */
+typedef struct {
+  /** the number of arenas. */
+  size_t arenas;
+  /** system allocations (chunks) currently held, including cached chunks. */
+  size_t chunks_mapped;
+  /** system allocations (chunks) in the cache, waiting to be reused. */
+  size_t chunks_cached;
+  /** mapped blocks in the free block list (available for arenas / slabs). */
+  size_t blocks_free;
+  /** bytes sliced from the current big-block. */
+  size_t big_block_bytes;
+  /** live allocations in the current big-block. */
+  size_t big_block_allocations;
+  /** slab slots (all size classes). */
+  size_t slab_slots;
+  /** slab slots in use (all size classes). */
+  size_t slab_slots_used;
+  /** the number of times a thread found its arena locked and switched. */
+  size_t arena_switches;
+  /** allocations redirected to `mmap` because of their size (total). */
+  size_t mmap_redirects;
+  /** live allocations made using `mmap`. */
+  size_t mmap_allocations;
+  /** bytes mapped by live `mmap` allocations. */
+  size_t mmap_bytes;
+} FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s);
+
+/** Arena statistics, see `malloc_arena_stats`. */
+typedef struct {
+  /** bytes sliced from the arena's current block (still in the block). */
+  size_t block_bytes;
+  /** bytes allocated using the arena (total). */
+  size_t bytes;
+  /** allocations made using the arena (total). */
+  size_t allocations;
+  /** the number of times the arena was found locked (contention). */
+  size_t contended;
+  /** blocks emptied by other threads and reclaimed by the arena (total). */
+  size_t reclaimed;
+} FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s);
+
+/**
+ * Returns a snapshot of the allocator's statistics.
+ *
+ * The snapshot is collected without stopping other threads, so values might be
+ * slightly out of sync with each other.
+ */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void);
+
+/**
+ * Returns a snapshot of an arena's statistics.
+ *
+ * Valid indexes are smaller than the `arenas` value reported by
+ * `malloc_stats`. Returns an all zero snapshot if the arena doesn't exist.
+ */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(size_t index);
+
+/* *****************************************************************************
+Memory Allocation - heap profiler
+***************************************************************************** */
+
+/**
+ * Writes the sampled live allocations (the heap profile) to `fd`.
+ *
+ * If `folded` is zero, the (legacy) pprof heap profile text format is used.
+ * Otherwise, the folded stack format used by flame graph tools is used.
+ *
+ * Returns -1 on error. If the allocator wasn't compiled with
+ * FIO_MEMORY_PROFILE, -1 is returned and `errno` is set to `ENOTSUP`.
+ */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded);
+
+/**
+ * Writes the heap profile (pprof format) to `filename` whenever the process
+ * receives `sig`. The file is overwritten by each dump.
+ *
+ * The dump is deferred until `fio_signal_review` is called (the server does so
+ * automatically), so it never runs within a signal handler.
+ *
+ * Returns -1 on error. If the allocator wasn't compiled with
+ * FIO_MEMORY_PROFILE, -1 is returned and `errno` is set to `ENOTSUP`.
+ */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename);
+
+/* *****************************************************************************
+Memory Allocation - NUMA topology
+***************************************************************************** */
+
+/**
+ * Returns the number of NUMA nodes the allocator's arenas are grouped by.
+ *
+ * Returns 1 on single node machines or if the allocator wasn't compiled with
+ * FIO_MEMORY_NUMA.
+ */
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void);
+
+/**
+ * Overrides the detected NUMA topology (i.e., for testing).
+ *
+ * `nodes` is the number of nodes and `node` returns the calling thread's node.
+ * Chunks aren't bound to faked nodes. If `nodes` is zero, the detected topology
+ * is restored.
+ *
+ * Should be called before starting any threads. Returns -1 on error. If the
+ * allocator wasn't compiled with FIO_MEMORY_NUMA, -1 is returned and `errno` is
+ * set to `ENOTSUP`.
+ */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void));
+
 /* *****************************************************************************
 Set global macros to use this allocator if FIO_MALLOC
 ***************************************************************************** */
@@ -12567,6 +13857,76 @@ FIO_IFUNC void FIO_MEM_SYS_FREE_def_func(void *mem, size_t bytes) {
   munmap(mem, bytes);
 }
 
+/* the logarithmic size of a (2MB) huge page */
+#define FIO_MEM_HUGE_PAGE_SIZE_LOG 21
+
+/*
+ * allocates memory backed by huge pages, aligned to (at least) 2MB.
+ *
+ * Explicit huge pages (`MAP_HUGETLB`) are attempted only if `hugetlb` is set.
+ * Once the attempt fails, transparent huge pages are used instead.
+ */
+FIO_SFUNC void *FIO_MEM_SYS_ALLOC_HUGE_def_func(size_t bytes,
+                                                uint8_t alignment_log,
+                                                int hugetlb) {
+  void *result;
+  const size_t huge_mask = (1ULL << FIO_MEM_HUGE_PAGE_SIZE_LOG) - 1;
+  if (alignment_log < FIO_MEM_HUGE_PAGE_SIZE_LOG)
+    alignment_log = FIO_MEM_HUGE_PAGE_SIZE_LOG;
+  bytes = (bytes + huge_mask) & (~huge_mask);
+#if defined(MAP_HUGETLB)
+  static volatile uint8_t explicit_failed;
+  if (hugetlb && !explicit_failed) {
+    /* huge page mappings are 2MB aligned, stricter alignment requires trim */
+    const size_t alignment_size = (1ULL << alignment_log);
+    const size_t extra =
+        (alignment_log > FIO_MEM_HUGE_PAGE_SIZE_LOG) ? alignment_size : 0;
+    result = mmap(NULL,
+                  bytes + extra,
+                  PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                  -1,
+                  0);
+    if (result != MAP_FAILED) {
+      if (extra) {
+        const uintptr_t offset =
+            (alignment_size - ((uintptr_t)result & (alignment_size - 1))) &
+            (alignment_size - 1);
+        if (offset)
+          munmap(result, offset);
+        result = (void *)((uintptr_t)result + offset);
+        munmap((void *)((uintptr_t)result + bytes), extra - offset);
+      }
+      return result;
+    }
+    explicit_failed = 1;
+    FIO_LOG_DEBUG2("explicit huge pages unavailable (MAP_HUGETLB failed), "
+                   "using transparent huge pages.");
+  }
+#endif /* MAP_HUGETLB */
+  result = FIO_MEM_SYS_ALLOC_def_func(bytes, alignment_log);
+#if defined(MADV_HUGEPAGE)
+  if (result)
+    madvise(result, bytes, MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+  return result;
+  (void)hugetlb;
+}
+
+/* returns the memory's physical pages to the system, keeping the mapping. */
+FIO_SFUNC void FIO_MEM_SYS_PURGE_def_func(void *mem, size_t bytes) {
+  bytes = FIO_MEM_BYTES2PAGES(bytes);
+#if defined(MADV_FREE)
+  if (!madvise(mem, bytes, MADV_FREE))
+    return;
+#endif /* MADV_FREE */
+#if defined(MADV_DONTNEED)
+  madvise(mem, bytes, MADV_DONTNEED);
+#endif /* MADV_DONTNEED */
+  (void)mem;
+  (void)bytes;
+}
+
 /* *****************************************************************************
 
 
@@ -12700,8 +14060,31 @@ Overridable system allocation macros
 #define FIO_MEM_SYS_REALLOC(ptr, old_pages, new_pages, alignment_log)          \
   FIO_MEM_SYS_REALLOC_def_func((ptr), (old_pages), (new_pages), (alignment_log))
 #define FIO_MEM_SYS_FREE(ptr, pages) FIO_MEM_SYS_FREE_def_func((ptr), (pages))
+#if FIO_OS_POSIX || __has_include("sys/mman.h")
+#define FIO_MEM_SYS_ALLOC_HUGE(pages, alignment_log, hugetlb)                  \
+  FIO_MEM_SYS_ALLOC_HUGE_def_func((pages), (alignment_log), (hugetlb))
+#define FIO_MEM_SYS_PURGE(ptr, pages) FIO_MEM_SYS_PURGE_def_func((ptr), (pages))
+#endif
 #endif /* FIO_MEM_SYS_ALLOC */
 
+#ifndef FIO_MEM_SYS_PURGE
+/* custom (or non-POSIX) system allocators keep the memory until it's freed */
+#define FIO_MEM_SYS_PURGE(ptr, pages) ((void)(ptr), (void)(pages))
+#endif /* FIO_MEM_SYS_PURGE */
+
+/* monotonic milliseconds, for the allocator's cache decay */
+FIO_IFUNC int64_t fio___mem_time_milli(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return ((int64_t)t.tv_sec * 1000) + ((int64_t)t.tv_nsec / 1000000);
+}
+
+#ifndef FIO_MEM_SYS_ALLOC_HUGE
+/* custom (or non-POSIX) system allocators ignore huge page requests */
+#define FIO_MEM_SYS_ALLOC_HUGE(pages, alignment_log, hugetlb)                  \
+  FIO_MEM_SYS_ALLOC((pages), (alignment_log))
+#endif /* FIO_MEM_SYS_ALLOC_HUGE */
+
 #endif /* H___FIO_MEM_INCLUDE_ONCE___H */
 
 /* *****************************************************************************
@@ -12742,6 +14125,37 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size) {
 }
 
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {}
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)(void) {}
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s) r = {0};
+  return r;
+}
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(size_t index) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s) r = {0};
+  return r;
+  (void)index;
+}
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded) {
+  errno = ENOTSUP;
+  return -1;
+  (void)fd, (void)folded;
+}
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename) {
+  errno = ENOTSUP;
+  return -1;
+  (void)sig, (void)filename;
+}
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void) { return 1; }
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void)) {
+  errno = ENOTSUP;
+  return -1;
+  (void)nodes, (void)node;
+}
 /** Prints the allocator's data structure. May be used for debugging. */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {}
 /** Prints the allocator's free block list. May be used for debugging. */
@@ -12898,6 +14312,8 @@ Chunk and Block data / header
 typedef struct {
   volatile int32_t ref;
   volatile int32_t pos;
+  /* the arena slicing the block (index + 1), or 0 */
+  int32_t arena;
 } FIO_NAME(FIO_MEMORY_NAME, __mem_block_s);
 
 typedef struct {
@@ -12906,6 +14322,10 @@ typedef struct {
   volatile int32_t ref;
   FIO_NAME(FIO_MEMORY_NAME, __mem_block_s)
   blocks[FIO_MEMORY_BLOCKS_PER_ALLOCATION];
+#if FIO_MEMORY_NUMA
+  /* the NUMA node the chunk was allocated for (after the big-block header) */
+  uint32_t node;
+#endif /* FIO_MEMORY_NUMA */
 } FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s);
 
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
@@ -12921,12 +14341,443 @@ typedef struct {
 /* *****************************************************************************
 Arena type
 ***************************************************************************** */
+/* arenas are padded to a multiple of this size to prevent false sharing */
+#define FIO___MEM_ARENA_ALIGN 128
+/* remote-free lists are returned to the free list once they reach this size */
+#define FIO___MEM_REMOTE_FREE_LIMIT                                            \
+  (FIO_MEMORY_BLOCKS_PER_ALLOCATION < 4 ? 4 : FIO_MEMORY_BLOCKS_PER_ALLOCATION)
+
+#define FIO___MEM_ARENA_FIELDS                                                 \
+  void *block;                                                                 \
+  int32_t last_pos;                                                            \
+  FIO_MEMORY_LOCK_TYPE lock;                                                   \
+  /* statistics (allocations / bytes are updated by the arena's owner) */      \
+  size_t allocations;                                                          \
+  size_t bytes;                                                                \
+  volatile size_t contended;                                                   \
+  /* the thread that last locked the arena (see `__mem_thread_token`) */      \
+  void *volatile owner;                                                        \
+  /* blocks emptied by other threads, reclaimed by the arena (lock free) */    \
+  FIO_LIST_NODE *volatile remote;                                              \
+  volatile size_t remote_count; /* approximate */                              \
+  size_t reclaimed;
+
+/* the unpadded arena, used only to compute the padding */
 typedef struct {
-  void *block;
-  int32_t last_pos;
-  FIO_MEMORY_LOCK_TYPE lock;
-  uint8_t pad_for_cache___[115]; /* cache line padding */
+  FIO___MEM_ARENA_FIELDS
+} FIO_NAME(FIO_MEMORY_NAME, __mem_arena_fields_s);
+
+typedef struct {
+  FIO___MEM_ARENA_FIELDS
+  uint8_t pad_for_cache___[FIO___MEM_ARENA_ALIGN -
+                           (sizeof(FIO_NAME(FIO_MEMORY_NAME,
+                                            __mem_arena_fields_s)) &
+                            (FIO___MEM_ARENA_ALIGN - 1))];
 } FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s);
+#undef FIO___MEM_ARENA_FIELDS
+
+FIO_ASSERT_STATIC(!(sizeof(FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s)) &
+                    (FIO___MEM_ARENA_ALIGN - 1)),
+                  "arena size must be a multiple of the cache line padding");
+
+/* the address of this thread local byte identifies the arena's owner */
+static __thread uint8_t FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token);
+
+/* *****************************************************************************
+Slab types - a block dedicated to a single size class
+***************************************************************************** */
+#if FIO_MEMORY_SLAB_CLASSES
+typedef struct FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s);
+
+/* the slab header is placed at the beginning of the block */
+struct FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) {
+  /* partial slab list (class lock) */
+  FIO_LIST_NODE node;
+  /* all the slabs in the class (class lock) */
+  FIO_LIST_NODE all;
+  /* pending stack, slabs that were full when a slot was freed (lock free) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * next;
+  /* slots in use */
+  volatile uint32_t used;
+  /* set while the slab is the class's current, partial or pending slab */
+  volatile uint32_t listed;
+  /* the number of slots in the slab */
+  uint32_t slots;
+  /* slot size in allocation units */
+  uint32_t units;
+  /* the offset of the first slot in allocation units */
+  uint32_t offset;
+  /* the bitmap word where the next search starts */
+  uint32_t hint;
+  /* slot bitmap, a set bit marks a slot that's in use */
+  volatile uint64_t map[];
+};
+
+/* size class data */
+typedef struct {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * current;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * volatile pending;
+  FIO_LIST_HEAD partial;
+  FIO_LIST_HEAD all;
+  FIO_MEMORY_LOCK_TYPE lock;
+  uint8_t pad_for_cache___[63]; /* cache line padding */
+} FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s);
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
+/* *****************************************************************************
+Thread cache - a private arena per thread (the lock is never used)
+***************************************************************************** */
+#if FIO_MEMORY_THREAD_CACHE
+static __thread FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+/* the key's destructor returns the thread's block when the thread exits */
+static pthread_key_t FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key);
+static volatile uint8_t FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+/* *****************************************************************************
+Statistics counters (survive state cleanup, `mmap` may be used before setup)
+***************************************************************************** */
+static struct {
+  /* system allocations (chunks) held, including cached chunks */
+  volatile size_t chunks;
+  /* the number of times a thread had to switch arena */
+  volatile size_t arena_switches;
+  /* allocations redirected to `mmap` because of their size */
+  volatile size_t mmap_redirects;
+  /* live `mmap` allocations and the number of bytes they mapped */
+  volatile size_t mmap_allocations;
+  volatile size_t mmap_bytes;
+} FIO_NAME(FIO_MEMORY_NAME, __mem_counters);
+
+/* *****************************************************************************
+NUMA topology (survives state cleanup)
+***************************************************************************** */
+#if FIO_MEMORY_NUMA
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* CPUs above this limit are assumed to be on node 0 */
+#define FIO_MEMORY_NUMA_MAX_CPUS 1024
+
+static struct {
+  /* the node count arenas are grouped by (0 or 1 == single node) */
+  volatile size_t nodes;
+  /* the detected node count */
+  size_t detected;
+  /* returns the calling thread's node when the topology is faked */
+  size_t (*volatile fake)(void);
+  /* set if chunks can be bound to their node (`mbind`) */
+  uint8_t bind;
+  /* set once the topology was detected */
+  uint8_t ready;
+  /* maps CPUs to nodes (detected topology) */
+  uint8_t cpu2node[FIO_MEMORY_NUMA_MAX_CPUS];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_numa);
+
+/**
+ * Reads a sysfs list file (i.e., "0-3,8"), setting `map[i] = value` for every
+ * listed index `i` (if `map` isn't NULL). Returns the highest index + 1.
+ */
+FIO_SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_numa_list)(const char *path,
+                                                            uint8_t *map,
+                                                            size_t map_len,
+                                                            uint8_t value) {
+  char buf[1024];
+  size_t r = 0;
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+    return r;
+  ssize_t len = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (len <= 0)
+    return r;
+  buf[len] = 0;
+  for (char *pos = buf; *pos >= '0' && *pos <= '9';) {
+    size_t from = 0, to;
+    while (*pos >= '0' && *pos <= '9')
+      from = (from * 10) + (size_t)(*pos++ - '0');
+    to = from;
+    if (*pos == '-') {
+      to = 0;
+      ++pos;
+      while (*pos >= '0' && *pos <= '9')
+        to = (to * 10) + (size_t)(*pos++ - '0');
+    }
+    for (size_t i = from; map && i <= to && i < map_len; ++i)
+      map[i] = value;
+    if (r <= to)
+      r = to + 1;
+    if (*pos == ',')
+      ++pos;
+  }
+  return r;
+}
+
+/* detects the machine's NUMA topology (once) */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_numa_detect)(void) {
+  char path[64];
+  size_t nodes;
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_numa).ready)
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).ready = 1;
+  nodes = FIO_NAME(FIO_MEMORY_NAME, __mem_numa_list)(
+      "/sys/devices/system/node/online",
+      NULL,
+      0,
+      0);
+  for (size_t i = 0; nodes > 1 && i < nodes; ++i) {
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", i);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa_list)
+    (path,
+     FIO_NAME(FIO_MEMORY_NAME, __mem_numa).cpu2node,
+     FIO_MEMORY_NUMA_MAX_CPUS,
+     (uint8_t)(i % FIO_MEMORY_NUMA_MAX_NODES));
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).bind =
+      (nodes > 1 && nodes <= FIO_MEMORY_NUMA_MAX_NODES);
+  if (nodes > FIO_MEMORY_NUMA_MAX_NODES)
+    nodes = FIO_MEMORY_NUMA_MAX_NODES;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected = (nodes ? nodes : 1);
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected;
+}
+
+/* returns the calling thread's NUMA node */
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)(void) {
+  const size_t nodes = FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes;
+  if (nodes < 2)
+    return 0;
+  size_t (*fake)(void) = FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake;
+  if (fake)
+    return fake() % nodes;
+  const int cpu = sched_getcpu();
+  if ((unsigned)cpu >= FIO_MEMORY_NUMA_MAX_CPUS)
+    return 0;
+  return FIO_NAME(FIO_MEMORY_NAME, __mem_numa).cpu2node[cpu];
+}
+
+/* prefers the node for the (untouched) chunk's memory, errors are ignored */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_numa_bind)(void *mem,
+                                                          size_t node) {
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_numa).bind ||
+      FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake)
+    return;
+  unsigned long mask = 1UL << node;
+  /* MPOL_PREFERRED == 1, falls back to other nodes instead of failing */
+  syscall(SYS_mbind,
+          mem,
+          (unsigned long)FIO_MEMORY_SYS_ALLOCATION_SIZE,
+          1,
+          &mask,
+          (unsigned long)((sizeof(mask) << 3) + 1),
+          0);
+}
+
+/* returns the chunk's NUMA node */
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c) {
+  return c->node;
+}
+
+#else /* FIO_MEMORY_NUMA */
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)(void) { return 0; }
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c) {
+  return 0;
+  (void)c;
+}
+#endif /* FIO_MEMORY_NUMA */
+
+/* *****************************************************************************
+Heap profiler - sampled live allocations (survives state cleanup)
+***************************************************************************** */
+#if FIO_MEMORY_PROFILE
+#include <execinfo.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define FIO_MEMORY_PROFILE_MASK                                                \
+  (((size_t)1 << FIO_MEMORY_PROFILE_SLOTS_LOG) - 1)
+/* the counting filter has 64 counters per sample slot */
+#define FIO_MEMORY_PROFILE_FILTER_MASK                                         \
+  (((size_t)1 << (FIO_MEMORY_PROFILE_SLOTS_LOG + 6)) - 1)
+
+/* a sampled live allocation */
+typedef struct {
+  void *ptr;
+  size_t size;
+  size_t depth;
+  void *stack[FIO_MEMORY_PROFILE_DEPTH];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s);
+
+static struct {
+  /* a counting filter, so `free` rarely needs to lock and search the table */
+  volatile uint8_t filter[FIO_MEMORY_PROFILE_FILTER_MASK + 1];
+  fio_lock_i lock;
+  /* live samples in the table */
+  size_t count;
+  /* samples dropped because the table was (almost) full */
+  size_t dropped;
+  /* an open addressing (linear probing) table of samples */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s)
+  table[FIO_MEMORY_PROFILE_MASK + 1];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_prof);
+
+/* bytes left until the thread's next sample */
+static __thread int64_t FIO_NAME(FIO_MEMORY_NAME, __mem_prof_countdown);
+
+FIO_IFUNC uint64_t FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(void *ptr) {
+  return fio_risky_ptr(ptr);
+}
+
+FIO_IFUNC volatile uint8_t *FIO_NAME(FIO_MEMORY_NAME,
+                                     __mem_prof_filter)(uint64_t hash) {
+  return FIO_NAME(FIO_MEMORY_NAME, __mem_prof).filter +
+         ((hash >> 32) & FIO_MEMORY_PROFILE_FILTER_MASK);
+}
+
+/* adds a sample to the table, call only within the lock */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_insert)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) * s,
+    uint64_t hash) {
+  /* keep the load factor low enough for short probe sequences */
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count >=
+      (FIO_MEMORY_PROFILE_MASK - (FIO_MEMORY_PROFILE_MASK >> 3))) {
+    ++FIO_NAME(FIO_MEMORY_NAME, __mem_prof).dropped;
+    return;
+  }
+  size_t i = (size_t)hash & FIO_MEMORY_PROFILE_MASK;
+  while (FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr)
+    i = (i + 1) & FIO_MEMORY_PROFILE_MASK;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i] = *s;
+  ++FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count;
+  volatile uint8_t *f = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash);
+  if (*f != 255) /* saturated counters are never decremented */
+    ++*f;
+}
+
+/* removes a sample from the table (if found), call only within the lock */
+FIO_SFUNC int FIO_NAME(FIO_MEMORY_NAME, __mem_prof_remove)(
+    void *ptr,
+    uint64_t hash,
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) * dest) {
+  size_t i = (size_t)hash & FIO_MEMORY_PROFILE_MASK;
+  while (FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr != ptr) {
+    if (!FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr)
+      return -1;
+    i = (i + 1) & FIO_MEMORY_PROFILE_MASK;
+  }
+  if (dest)
+    *dest = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i];
+  --FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count;
+  volatile uint8_t *f = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash);
+  if (*f != 255)
+    --*f;
+  /* backward shift deletion (no tombstones) */
+  for (size_t j = i;;) {
+    j = (j + 1) & FIO_MEMORY_PROFILE_MASK;
+    void *tmp = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[j].ptr;
+    if (!tmp)
+      break;
+    const size_t home =
+        (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(tmp) &
+        FIO_MEMORY_PROFILE_MASK;
+    /* move the entry unless its home is cyclically within (i, j] */
+    if ((i < j) ? (home <= i || home > j) : (home <= i && home > j)) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[j];
+      i = j;
+    }
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr = NULL;
+  return 0;
+}
+
+/* the slow path, called when the thread's sampling countdown expires */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample)(void *ptr,
+                                                            size_t size) {
+  /* `backtrace` might allocate memory (i.e., when it's first called) */
+  static __thread uint8_t busy;
+  static __thread uint8_t started;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) s;
+  uint64_t hash;
+  if (busy)
+    return;
+  /* a randomized interval prevents sampling bias with periodic allocations */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_countdown) =
+      (int64_t)(((size_t)FIO_MEMORY_PROFILE >> 1) +
+                (size_t)(fio_rand64() % (size_t)FIO_MEMORY_PROFILE));
+  if (!started) { /* the first expiry only initializes the countdown */
+    started = 1;
+    return;
+  }
+  busy = 1;
+  int depth = backtrace(s.stack, FIO_MEMORY_PROFILE_DEPTH);
+  busy = 0;
+  s.ptr = ptr;
+  s.size = size;
+  s.depth = (depth > 0) ? (size_t)depth : 0;
+  hash = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(ptr);
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_insert)(&s, hash);
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+}
+
+/* counts down the allocated bytes, sampling when the countdown expires */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(void *ptr,
+                                                           size_t size) {
+  if ((FIO_NAME(FIO_MEMORY_NAME, __mem_prof_countdown) -= (int64_t)size) > 0)
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample)(ptr, size);
+}
+
+/* removes a freed allocation from the table if it was sampled */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_free)(void *ptr) {
+  const uint64_t hash = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(ptr);
+  if (!*FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash))
+    return;
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_remove)(ptr, hash, NULL);
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+}
+
+/* updates a sampled allocation that was moved by the system (`mremap`) */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_move)(void *from,
+                                                          void *to,
+                                                          size_t size) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) s;
+  const uint64_t hash = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(from);
+  if (!*FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash))
+    return;
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_prof_remove)(from, hash, &s)) {
+    s.ptr = to;
+    s.size = size;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_insert)
+    (&s, FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(to));
+  }
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+}
+
+#else /* FIO_MEMORY_PROFILE */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(void *ptr,
+                                                           size_t size) {
+  (void)ptr, (void)size;
+}
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_free)(void *ptr) {
+  (void)ptr;
+}
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_move)(void *from,
+                                                          void *to,
+                                                          size_t size) {
+  (void)from, (void)to, (void)size;
+}
+#endif /* FIO_MEMORY_PROFILE */
 
 /* *****************************************************************************
 Allocator State
@@ -12942,6 +14793,16 @@ static struct FIO_NAME(FIO_MEMORY_NAME, __mem_state_s) {
     /* chunk slot array */
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * a[FIO_MEMORY_CACHE_SLOTS];
     size_t pos;
+#if FIO_MEMORY_CACHE_DECAY
+    /* the time (in milliseconds) each chunk was cached */
+    int64_t at[FIO_MEMORY_CACHE_SLOTS];
+    /* set once a chunk's memory was released to the system */
+    uint8_t purged[FIO_MEMORY_CACHE_SLOTS];
+#endif /* FIO_MEMORY_CACHE_DECAY */
+#if FIO_MEMORY_NUMA
+    /* each chunk's node (purged chunk headers are lost) */
+    uint8_t node[FIO_MEMORY_CACHE_SLOTS];
+#endif /* FIO_MEMORY_NUMA */
   } cache;
 #endif /* FIO_MEMORY_CACHE_SLOTS */
 
@@ -12953,10 +14814,14 @@ static struct FIO_NAME(FIO_MEMORY_NAME, __mem_state_s) {
   FIO_MEMORY_LOCK_TYPE big_lock;
   uint8_t pad_for_cache___[115]; /* cache line padding */
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
+#if FIO_MEMORY_SLAB_CLASSES
+  /** size-class slabs (one class per allocation unit count) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) slab[FIO_MEMORY_SLAB_CLASSES];
+#endif /* FIO_MEMORY_SLAB_CLASSES */
   /** main memory state lock */
   FIO_MEMORY_LOCK_TYPE lock;
-  /** free list for available blocks */
-  FIO_LIST_HEAD blocks;
+  /** free lists for available blocks (one per NUMA node) */
+  FIO_LIST_HEAD blocks[FIO_MEMORY_NUMA_LISTS];
   /** the arena count for the allocator */
   uint8_t pad_for_cache2___[111]; /* cache line padding */
   size_t arena_count;
@@ -12983,7 +14848,12 @@ void fio___mem_arena_lock___(void);
 FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
     FIO_NAME(FIO_MEMORY_NAME, __mem_arena_lock)(void) {
 #if FIO_MEMORY_ARENA_COUNT == 1
-  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].lock);
+  if (FIO_MEMORY_TRYLOCK(
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].lock)) {
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].contended,
+                   1);
+    FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].lock);
+  }
   return FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena;
 
 #else /* FIO_MEMORY_ARENA_COUNT != 1 */
@@ -13005,14 +14875,25 @@ FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
   /** thread arena value */
   size_t arena_index;
   size_t loop_count = 0;
+  /** the arenas the thread may use (the arenas of the thread's NUMA node) */
+  size_t group_start = 0;
+  size_t group_count = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+#if FIO_MEMORY_NUMA
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes > 1) {
+    group_count /= FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes;
+    if (!group_count)
+      group_count = 1;
+    group_start = (FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)() * group_count) %
+                  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+  }
+#endif /* FIO_MEMORY_NUMA */
   {
     /* select the default arena selection using a thread ID. */
     union {
       void *p;
       fio_thread_t t;
     } u = {.t = fio_thread_current()};
-    arena_index = fio_risky_ptr(u.p) %
-                  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+    arena_index = group_start + (fio_risky_ptr(u.p) % group_count);
 #if defined(DEBUG) && 0
     static void *pthread_last = NULL;
     if (pthread_last != u.p) {
@@ -13031,15 +14912,19 @@ FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
     if (!FIO_MEMORY_TRYLOCK(
             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].lock))
       return (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena + arena_index);
+    fio_atomic_add(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].contended,
+        1);
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).arena_switches,
+                   1);
     FIO_LOG_DDEBUG("thread %p had to switch arena from %zu / %zu",
                    fio_thread_current(),
                    arena_index,
                    (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count);
     ++arena_index;
-    if (arena_index == FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
-      arena_index = 0;
-    if (++loop_count <
-        (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count << 1))
+    if (arena_index == group_start + group_count)
+      arena_index = group_start;
+    if (++loop_count < (group_count << 1))
       continue;
     FIO___MEMORY_ARENA_LOCK_WARNING();
 #undef FIO___MEMORY_ARENA_LOCK_WARNING
@@ -13126,6 +15011,15 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *ptr);
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_big_block_free)(void *ptr);
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c);
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)(
+    FIO_LIST_NODE *n);
+#if FIO_MEMORY_THREAD_CACHE
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)(void *tc);
+#endif
+#if FIO_MEMORY_SLAB_CLASSES
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s);
+#endif
 
 /* IDE marker */
 void fio___mem_state_cleanup___(void);
@@ -13140,6 +15034,11 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
   FIO_LOG_DDEBUG2(
       "starting facil.io memory allocator cleanup for " FIO_MACRO2STR(
           FIO_NAME(FIO_MEMORY_NAME, malloc)) ".");
+#if FIO_MEMORY_THREAD_CACHE
+  /* free the calling thread's block (other threads free theirs on exit) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)
+  (&FIO_NAME(FIO_MEMORY_NAME, __mem_tcache));
+#endif
   /* free arena blocks */
   for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
        ++i) {
@@ -13154,10 +15053,32 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
     FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)
     (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block = NULL;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote_count = 0;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)
+    (fio_atomic_exchange(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote,
+        (FIO_LIST_NODE *)NULL));
     FIO_MEMORY_LOCK_TYPE_INIT(
         FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].lock);
   }
 
+#if FIO_MEMORY_SLAB_CLASSES
+  /* release empty slabs (slabs with leaked slots are reported below) */
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *cls =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + i;
+    cls->current = NULL;
+    cls->pending = NULL;
+    cls->partial = FIO_LIST_INIT(cls->partial);
+    FIO_LIST_EACH(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s), all, &cls->all, s) {
+      if (s->used)
+        continue;
+      FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(s);
+    }
+    FIO_MEMORY_LOCK_TYPE_INIT(cls->lock);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   /* cleanup big-alloc chunk */
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block) {
@@ -13187,8 +15108,10 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
 #endif /* FIO_MEMORY_CACHE_SLOTS */
 
   /* report any blocks in the allocation list - even if not in DEBUG mode */
-  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.next !=
-      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks) {
+  for (size_t i = 0; i < FIO_MEMORY_NUMA_LISTS; ++i) {
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i].next ==
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i])
+      continue;
     struct t_s {
       FIO_LIST_NODE node;
     };
@@ -13198,7 +15121,7 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
                  malloc)) ") blocks left after cleanup - memory leaks?");
     FIO_LIST_EACH(struct t_s,
                   node,
-                  &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks,
+                  &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i],
                   pos) {
       if (last_chunk == (void *)FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(pos))
         continue;
@@ -13230,6 +15153,11 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME,
   FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)();
 }
 
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_cache_decay_task)(void *ignr_) {
+  (void)ignr_;
+  FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+}
+
 /* initializes (allocates) the arenas and state machine */
 FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state))
@@ -13240,6 +15168,20 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
   fio_state_callback_add(FIO_CALL_AT_EXIT,
                          FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup),
                          NULL);
+#if FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY
+  fio_state_callback_add(FIO_CALL_ON_IDLE,
+                         FIO_NAME(FIO_MEMORY_NAME, __mem_cache_decay_task),
+                         NULL);
+#endif /* FIO_MEMORY_CACHE_DECAY */
+#if FIO_MEMORY_THREAD_CACHE
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid) &&
+      !pthread_key_create(&FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key),
+                          FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)))
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid) = 1;
+#endif
+#if FIO_MEMORY_NUMA
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa_detect)();
+#endif /* FIO_MEMORY_NUMA */
   /* allocate the state machine */
   {
 #if FIO_MEMORY_ARENA_COUNT > 0
@@ -13267,6 +15209,13 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
     if (arean_count >= FIO_MEMORY_ARENA_COUNT_MAX)
       arean_count = FIO_MEMORY_ARENA_COUNT_MAX;
 
+#if FIO_MEMORY_NUMA
+    /* an equal number of arenas per node */
+    if (arean_count >= FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected)
+      arean_count -=
+          arean_count % FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected;
+#endif /* FIO_MEMORY_NUMA */
+
 #endif /* FIO_MEMORY_ARENA_COUNT > 0 */
 
     const size_t s = FIO_MEMORY_STATE_SIZE(arean_count);
@@ -13275,8 +15224,17 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
     FIO_ASSERT_ALLOC(FIO_NAME(FIO_MEMORY_NAME, __mem_state));
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count = arean_count;
   }
-  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks =
-      FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks);
+  for (size_t i = 0; i < FIO_MEMORY_NUMA_LISTS; ++i)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i] =
+        FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i]);
+#if FIO_MEMORY_SLAB_CLASSES
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].partial =
+        FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].partial);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].all =
+        FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].all);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
   FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)();
 
 #if defined(FIO_MEMORY_WARMUP) && FIO_MEMORY_WARMUP
@@ -13302,6 +15260,9 @@ void fio_after_fork___(void);
  * memory allocator's locks.
  */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
+#if FIO_MEMORY_PROFILE
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock = FIO_LOCK_INIT;
+#endif /* FIO_MEMORY_PROFILE */
   if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state)) {
     FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)();
     return;
@@ -13312,6 +15273,12 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   FIO_MEMORY_LOCK_TYPE_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
+#if FIO_MEMORY_SLAB_CLASSES
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_MEMORY_LOCK_TYPE_INIT(
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].lock);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
   for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
        ++i) {
     FIO_MEMORY_LOCK_TYPE_INIT(
@@ -13319,6 +15286,468 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
   }
 }
 
+/* *****************************************************************************
+Chunk cache decay - returning idle cached chunks to the system
+***************************************************************************** */
+
+/* SublimeText marker */
+void fio_malloc_cache_decay___(void);
+/**
+ * Returns the blocks waiting in the arenas' remote-free lists, releases the
+ * memory of chunks cached for FIO_MEMORY_CACHE_DECAY milliseconds and unmaps
+ * chunks cached for twice as long.
+ */
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)(void) {
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return;
+  /* idle arenas might hold on to blocks (and chunks) freed by other threads */
+  for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+       ++i) {
+    if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote)
+      continue;
+    fio_atomic_exchange(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote_count,
+        0);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)
+    (fio_atomic_exchange(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote,
+        (FIO_LIST_NODE *)NULL));
+  }
+#if FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * unmap[FIO_MEMORY_CACHE_SLOTS];
+  size_t count = 0;
+  const int64_t now = fio___mem_time_milli();
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  /* the cache is a stack, so the oldest chunks are at the bottom */
+  while (count < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos &&
+         now - FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[count] >=
+             ((int64_t)FIO_MEMORY_CACHE_DECAY << 1)) {
+    unmap[count] = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[count];
+    ++count;
+  }
+  if (count) {
+    const size_t remain =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos - count;
+    for (size_t i = 0; i < remain; ++i) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i + count];
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i + count];
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i + count];
+#if FIO_MEMORY_NUMA
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i + count];
+#endif /* FIO_MEMORY_NUMA */
+    }
+    for (size_t i = remain; i < remain + count; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i] = NULL;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos = remain;
+  }
+  for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos &&
+                     now - FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] >=
+                         (int64_t)FIO_MEMORY_CACHE_DECAY;
+       ++i) {
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i])
+      continue;
+    FIO_MEM_SYS_PURGE(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i],
+                      FIO_MEMORY_SYS_ALLOCATION_SIZE);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i] = 1;
+  }
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  /* unmap outside the lock */
+  for (size_t i = 0; i < count; ++i) {
+    FIO_MEMORY_ON_CHUNK_UNCACHE(unmap[i]);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_dealloc)(unmap[i]);
+  }
+#endif /* FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY */
+}
+
+/* *****************************************************************************
+Memory Allocation - statistics
+***************************************************************************** */
+
+/* SublimeText marker */
+void fio_malloc_stats___(void);
+/** Returns a snapshot of the allocator's statistics. */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+  r = {
+      .chunks_mapped = FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks,
+      .arena_switches =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_counters).arena_switches,
+      .mmap_redirects =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_redirects,
+      .mmap_allocations =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_allocations,
+      .mmap_bytes = FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes,
+  };
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return r;
+  r.arenas = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+#if FIO_MEMORY_CACHE_SLOTS
+  r.chunks_cached = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos;
+#endif /* FIO_MEMORY_CACHE_SLOTS */
+  for (size_t i = 0; i < FIO_MEMORY_NUMA_LISTS; ++i)
+    for (FIO_LIST_NODE *n =
+             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i].next;
+         n != &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i];
+         n = n->next)
+      ++r.blocks_free;
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+
+#if FIO_MEMORY_ENABLE_BIG_ALLOC
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block) {
+    r.big_block_bytes =
+        (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block->pos
+        << FIO_MEMORY_ALIGN_LOG;
+    /* the allocator holds a reference to its current big-block */
+    r.big_block_allocations =
+        (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block->ref - 1;
+  }
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
+#endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
+
+#if FIO_MEMORY_SLAB_CLASSES
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *cls =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + i;
+    FIO_MEMORY_LOCK(cls->lock);
+    FIO_LIST_EACH(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s), all, &cls->all, s) {
+      r.slab_slots += s->slots;
+      r.slab_slots_used += s->used;
+    }
+    FIO_MEMORY_UNLOCK(cls->lock);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+  return r;
+}
+
+/* SublimeText marker */
+void fio_malloc_arena_stats___(void);
+/** Returns a snapshot of an arena's statistics. */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(size_t index) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s) r = {0};
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state) ||
+      index >= FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
+    return r;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena + index;
+  FIO_MEMORY_LOCK(a->lock);
+  if (a->block) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(a->block);
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, a->block);
+    r.block_bytes = (size_t)c->blocks[b].pos << FIO_MEMORY_ALIGN_LOG;
+  }
+  r.bytes = a->bytes;
+  r.allocations = a->allocations;
+  r.reclaimed = a->reclaimed;
+  FIO_MEMORY_UNLOCK(a->lock);
+  r.contended = a->contended;
+  return r;
+}
+
+/* *****************************************************************************
+Memory Allocation - heap profile dump
+***************************************************************************** */
+#if FIO_MEMORY_PROFILE
+
+/* a small buffered writer, so the dump doesn't allocate memory per line */
+typedef struct {
+  int fd;
+  int err;
+  size_t len;
+  char buf[8192];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s);
+
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w) {
+  const char *pos = w->buf;
+  while (w->len && !w->err) {
+    ssize_t r = write(w->fd, pos, w->len);
+    if (r > 0) {
+      pos += r;
+      w->len -= (size_t)r;
+    } else if (r == -1 && errno == EINTR) {
+      continue;
+    } else {
+      w->err = -1;
+    }
+  }
+  w->len = 0;
+}
+
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w,
+    const char *str,
+    size_t len) {
+  while (len) {
+    if (w->len == sizeof(w->buf))
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(w);
+    size_t part = sizeof(w->buf) - w->len;
+    if (part > len)
+      part = len;
+    FIO_MEMCPY(w->buf + w->len, str, part);
+    w->len += part;
+    str += part;
+    len -= part;
+  }
+}
+
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w,
+    const char *format,
+    ...) {
+  char tmp[256];
+  va_list argv;
+  va_start(argv, format);
+  int len = vsnprintf(tmp, sizeof(tmp), format, argv);
+  va_end(argv);
+  if (len <= 0)
+    return;
+  if ((size_t)len >= sizeof(tmp))
+    len = (int)(sizeof(tmp) - 1);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, tmp, (size_t)len);
+}
+
+/* writes a frame's name, as returned by `backtrace_symbols` */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_frame)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w,
+    const char *sym,
+    void *address) {
+  const char *start, *end;
+  if (!sym)
+    goto address;
+  if ((start = strchr(sym, '('))) { /* glibc: "module(name+0x10) [0x...]" */
+    end = ++start;
+    while (*end && *end != '+' && *end != ')')
+      ++end;
+    if (end > start) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, start, end - start);
+      return;
+    }
+    /* unnamed (static) function: "module+0x10" can still be symbolized */
+    const char *module = sym;
+    for (const char *i = sym; i + 1 < start; ++i)
+      if (*i == '/')
+        module = i + 1;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, module, (start - 1) - module);
+    start = end;
+    while (*end && *end != ')')
+      ++end;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, start, end - start);
+    return;
+  }
+  if ((start = strstr(sym, " 0x"))) { /* BSD: "0 module 0x... name + 16" */
+    start += 3;
+    while (*start && *start != ' ')
+      ++start;
+    while (*start == ' ')
+      ++start;
+    if (!(end = strstr(start, " + ")))
+      end = start + strlen(start);
+    if (end > start) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, start, end - start);
+      return;
+    }
+  }
+address:
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+  (w, "0x%zx", (size_t)(uintptr_t)address);
+}
+
+/* SublimeText marker */
+void fio_malloc_profile_dump___(void);
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded) {
+  const size_t table_len = sizeof(FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) *samples;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) *w;
+  size_t count = 0, bytes = 0;
+  if (fd == -1) {
+    errno = EBADF;
+    return -1;
+  }
+  /* system memory, so the dump doesn't change the profile it's reporting */
+  samples = (FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) *)FIO_MEM_SYS_ALLOC(
+      FIO_MEM_BYTES2PAGES(table_len + sizeof(*w)),
+      FIO_MEM_PAGE_SIZE_LOG);
+  if (!samples) {
+    errno = ENOMEM;
+    return -1;
+  }
+  w = (FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) *)((char *)samples +
+                                                         table_len);
+  w->fd = fd;
+  w->err = 0;
+  w->len = 0;
+  /* copy the samples, so formatting (and I/O) is performed outside the lock */
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  for (size_t i = 0; i <= FIO_MEMORY_PROFILE_MASK; ++i) {
+    if (!FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr)
+      continue;
+    samples[count++] = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i];
+  }
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  for (size_t i = 0; i < count; ++i)
+    bytes += samples[i].size;
+
+  if (folded) {
+    /* "root;caller;callee bytes" (frame 0 is the profiler's sampling code) */
+    for (size_t i = 0; i < count && !w->err; ++i) {
+      if (samples[i].depth < 2)
+        continue;
+      char **symbols = backtrace_symbols(samples[i].stack + 1,
+                                         (int)samples[i].depth - 1);
+      for (size_t f = samples[i].depth - 1; f; --f) {
+        FIO_NAME(FIO_MEMORY_NAME, __mem_prof_frame)
+        (w, (symbols ? symbols[f - 1] : NULL), samples[i].stack[f]);
+        if (f > 1)
+          FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, ";", 1);
+      }
+      free(symbols); /* allocated by the system (libc) */
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+      (w, " %zu\n", samples[i].size);
+    }
+  } else {
+    /* the legacy pprof heap profile, with the sampling interval */
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+    (w,
+     "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n",
+     count,
+     bytes,
+     count,
+     bytes,
+     (size_t)FIO_MEMORY_PROFILE);
+    for (size_t i = 0; i < count && !w->err; ++i) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+      (w, "1: %zu [1: %zu] @", samples[i].size, samples[i].size);
+      for (size_t f = 1; f < samples[i].depth; ++f)
+        FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+        (w, " 0x%zx", (size_t)(uintptr_t)samples[i].stack[f]);
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, "\n", 1);
+    }
+    /* pprof uses the memory map to symbolize the addresses */
+    int maps = open("/proc/self/maps", O_RDONLY);
+    if (maps != -1) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, "\nMAPPED_LIBRARIES:\n", 19);
+      for (;;) {
+        if (w->len == sizeof(w->buf))
+          FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(w);
+        ssize_t r = read(maps, w->buf + w->len, sizeof(w->buf) - w->len);
+        if (r > 0) {
+          w->len += (size_t)r;
+          continue;
+        }
+        if (r == -1 && errno == EINTR)
+          continue;
+        break;
+      }
+      close(maps);
+    }
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(w);
+  const int r = w->err;
+  FIO_MEM_SYS_FREE(samples, FIO_MEM_BYTES2PAGES(table_len + sizeof(*w)));
+  return r;
+}
+
+/* dumps the heap profile from the `fio_signal_review` callback */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_on_signal)(int sig,
+                                                               void *filename) {
+  int fd = open((const char *)filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    FIO_LOG_ERROR("heap profile file couldn't be opened (%s): %s",
+                  (const char *)filename,
+                  strerror(errno));
+    return;
+  }
+  if (FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(fd, 0))
+    FIO_LOG_ERROR("heap profile dump failed (%s)", (const char *)filename);
+  else
+    FIO_LOG_INFO("(%d) heap profile written to %s (signal %d)",
+                 (int)getpid(),
+                 (const char *)filename,
+                 sig);
+  close(fd);
+}
+
+/* SublimeText marker */
+void fio_malloc_profile_dump_on_signal___(void);
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename) {
+  if (!filename) {
+    errno = EINVAL;
+    return -1;
+  }
+  return fio_signal_monitor(sig,
+                            FIO_NAME(FIO_MEMORY_NAME, __mem_prof_on_signal),
+                            (void *)filename);
+}
+
+#else /* FIO_MEMORY_PROFILE */
+
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded) {
+  errno = ENOTSUP;
+  return -1;
+  (void)fd, (void)folded;
+}
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename) {
+  errno = ENOTSUP;
+  return -1;
+  (void)sig, (void)filename;
+}
+#endif /* FIO_MEMORY_PROFILE */
+
+/* *****************************************************************************
+Memory Allocation - NUMA topology
+***************************************************************************** */
+#if FIO_MEMORY_NUMA
+
+/** Returns the number of NUMA nodes the allocator's arenas are grouped by. */
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void) {
+  const size_t nodes = FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes;
+  return (nodes ? nodes : 1);
+}
+
+/** Overrides the detected NUMA topology (i.e., for testing). */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void)) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa_detect)();
+  if (!nodes) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake = NULL;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected;
+    return 0;
+  }
+  if (!node || nodes > FIO_MEMORY_NUMA_MAX_NODES) {
+    errno = EINVAL;
+    return -1;
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake = node;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes = nodes;
+  return 0;
+}
+
+#else /* FIO_MEMORY_NUMA */
+
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void) { return 1; }
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void)) {
+  errno = ENOTSUP;
+  return -1;
+  (void)nodes, (void)node;
+}
+#endif /* FIO_MEMORY_NUMA */
+
 /* *****************************************************************************
 Memory Allocation - state printing (debug helper)
 ***************************************************************************** */
@@ -13353,6 +15782,37 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {
               (size_t)c->blocks[b].pos);
     }
   }
+#if FIO_MEMORY_THREAD_CACHE
+  fprintf(stderr,
+          "\t* thread cache block (calling thread): %p\n",
+          (void *)FIO_NAME(FIO_MEMORY_NAME, __mem_tcache).block);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_SLAB_CLASSES
+  fprintf(stderr, "\t---slabs---\n");
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *cls =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + i;
+    size_t slabs = 0, slots = 0, used = 0;
+    FIO_MEMORY_LOCK(cls->lock);
+    FIO_LIST_EACH(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s), all, &cls->all, s) {
+      ++slabs;
+      slots += s->slots;
+      used += s->used;
+    }
+    FIO_MEMORY_UNLOCK(cls->lock);
+    if (!slabs)
+      continue;
+    fprintf(stderr,
+            "\t* class[%zu] (%zu bytes): %zu slabs, %zu/%zu slots used "
+            "(%zu%% fragmentation)\n",
+            i,
+            (i + 1) << FIO_MEMORY_ALIGN_LOG,
+            slabs,
+            used,
+            slots,
+            ((slots - used) * 100) / slots);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block) {
     fprintf(stderr, "\t---big allocations---\n");
@@ -13385,17 +15845,20 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {
 void fio_malloc_print_free_block_list___(void);
 /** Prints the allocator's free block list. May be used for debugging. */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_free_block_list)(void) {
-  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev ==
-      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks)
-    return;
-  fprintf(stderr,
-          FIO_MACRO2STR(FIO_NAME(FIO_MEMORY_NAME,
-                                 malloc)) " allocator free block list:\n");
-  FIO_LIST_NODE *n = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev;
-  for (size_t i = 0; n != &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks;
-       ++i) {
-    fprintf(stderr, "\t[%zu] %p\n", i, (void *)n);
-    n = n->prev;
+  for (size_t node = 0; node < FIO_MEMORY_NUMA_LISTS; ++node) {
+    FIO_LIST_HEAD *head = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks + node;
+    if (head->prev == head)
+      continue;
+    fprintf(stderr,
+            FIO_MACRO2STR(FIO_NAME(
+                FIO_MEMORY_NAME,
+                malloc)) " allocator free block list (node %zu):\n",
+            node);
+    FIO_LIST_NODE *n = head->prev;
+    for (size_t i = 0; n != head; ++i) {
+      fprintf(stderr, "\t[%zu] %p\n", i, (void *)n);
+      n = n->prev;
+    }
   }
 }
 
@@ -13411,6 +15874,7 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_dealloc)(
   if (!c)
     return;
   FIO_MEMORY_ON_CHUNK_FREE(c);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks, 1);
   FIO_MEM_SYS_FREE(((void *)c), FIO_MEMORY_SYS_ALLOCATION_SIZE);
 }
 
@@ -13421,6 +15885,18 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_cache_or_dealloc)(
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos <
       FIO_MEMORY_CACHE_SLOTS) {
     FIO_MEMORY_ON_CHUNK_CACHE(c);
+#if FIO_MEMORY_CACHE_DECAY
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)
+        ->cache.at[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] =
+        fio___mem_time_milli();
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)
+        ->cache.purged[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] = 0;
+#endif /* FIO_MEMORY_CACHE_DECAY */
+#if FIO_MEMORY_NUMA
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)
+        ->cache.node[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] =
+        (uint8_t)c->node;
+#endif /* FIO_MEMORY_NUMA */
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)
         ->cache.a[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos++] = c;
     c = NULL;
@@ -13457,35 +15933,82 @@ void fio___mem_chunk_new___(void);
 FIO_IFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_new)(const size_t needs_lock) {
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c = NULL;
+#if FIO_MEMORY_NUMA
+  const size_t node = FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)();
+#endif /* FIO_MEMORY_NUMA */
 #if FIO_MEMORY_CACHE_SLOTS
   /* cache allocation */
   if (needs_lock) {
     FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
   }
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos) {
-    c = FIO_NAME(FIO_MEMORY_NAME, __mem_state)
-            ->cache.a[--FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos];
+    size_t i = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos - 1;
+#if FIO_MEMORY_NUMA
+    /* use the newest chunk on the thread's node (any chunk if single node) */
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes > 1) {
+      while (i &&
+             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] != node)
+        --i;
+      if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] != node)
+        goto cache_missed;
+    }
+#endif /* FIO_MEMORY_NUMA */
+    c = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i];
+    /* keep the cache ordered (the oldest chunks are at the bottom) */
+    for (; i + 1 < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos; ++i) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i + 1];
+#if FIO_MEMORY_NUMA
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i + 1];
+#endif /* FIO_MEMORY_NUMA */
+#if FIO_MEMORY_CACHE_DECAY
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i + 1];
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i + 1];
+#endif /* FIO_MEMORY_CACHE_DECAY */
+    }
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)
-        ->cache.a[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] = NULL;
+        ->cache.a[--FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] = NULL;
   }
+#if FIO_MEMORY_NUMA
+cache_missed:
+#endif /* FIO_MEMORY_NUMA */
   if (needs_lock) {
     FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
   }
   if (c) {
     FIO_MEMORY_ON_CHUNK_UNCACHE(c);
     *c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s)){.ref = 1};
+#if FIO_MEMORY_NUMA
+    c->node = (uint32_t)node; /* cached chunks have no blocks in free lists */
+#endif /* FIO_MEMORY_NUMA */
     return c;
   }
 #endif /* FIO_MEMORY_CACHE_SLOTS */
 
   /* system allocation */
+#if FIO_MEMORY_HUGE_PAGES
+  c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_ALLOC_HUGE(
+      FIO_MEMORY_SYS_ALLOCATION_SIZE,
+      FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG,
+      (FIO_MEMORY_HUGE_PAGES > 1));
+#else
   c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_ALLOC(
       FIO_MEMORY_SYS_ALLOCATION_SIZE,
       FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG);
+#endif /* FIO_MEMORY_HUGE_PAGES */
 
   if (!c)
     return c;
+#if FIO_MEMORY_NUMA
+  /* bind before the memory is touched (first-touch places unbound memory) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa_bind)(c, node);
+  c->node = (uint32_t)node;
+#endif /* FIO_MEMORY_NUMA */
   FIO_MEMORY_ON_CHUNK_ALLOC(c);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks, 1);
   c->ref = 1;
   return c;
   (void)needs_lock; /* in case it isn't used */
@@ -13548,11 +16071,40 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *p) {
   /* reset memory */
   FIO_NAME(FIO_MEMORY_NAME, __mem_block__reset_memory)(c, b);
 
+  if (c->blocks[b].arena) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena +
+        (c->blocks[b].arena - 1);
+    void *owner;
+    fio_atomic_load(owner, &a->owner);
+    if (owner != (void *)&FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token)) {
+      /* push to the arena's remote-free list (keeps the chunk reference) */
+      FIO_LIST_NODE *n =
+          (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
+      FIO_LIST_NODE *head;
+      n->prev = NULL;
+      do {
+        head = a->remote;
+        n->next = head;
+      } while (!fio_atomic_compare_exchange_p(&a->remote, &head, &n));
+      if (fio_atomic_add(&a->remote_count, 1) + 1 <
+          FIO___MEM_REMOTE_FREE_LIMIT)
+        return;
+      /* don't wait for the arena's next block to release the chunks */
+      fio_atomic_exchange(&a->remote_count, 0);
+      FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)
+      (fio_atomic_exchange(&a->remote, (FIO_LIST_NODE *)NULL));
+      return;
+    }
+  }
+
   /* place in free list */
   FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
   FIO_LIST_NODE *n =
       (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
-  FIO_LIST_PUSH(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks, n);
+  FIO_LIST_PUSH(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c),
+                n);
   /* free chunk reference while in locked state */
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c);
 }
@@ -13564,13 +16116,15 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)(void) {
   void *p = NULL;
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c = NULL;
   size_t b;
+  /* the free list for the calling thread's NUMA node */
+  FIO_LIST_HEAD *const blocks = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                                FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)();
 
   FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
 
   /* try to collect from list */
-  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev !=
-      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks) {
-    FIO_LIST_NODE *n = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev;
+  if (blocks->prev != blocks) {
+    FIO_LIST_NODE *n = blocks->prev;
     FIO_LIST_REMOVE(n);
     n->next = n->prev = NULL;
     c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
@@ -13592,7 +16146,9 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)(void) {
   for (b = 1; b < FIO_MEMORY_BLOCKS_PER_ALLOCATION; ++b) {
     FIO_LIST_NODE *n =
         (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
-    FIO_LIST_PUSH(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks, n);
+    FIO_LIST_PUSH(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c),
+                  n);
   }
   /* set block index to zero */
   b = 0;
@@ -13604,26 +16160,137 @@ done:
   /* update block reference and allocation position */
   c->blocks[b].ref = 1;
   c->blocks[b].pos = 0;
+  c->blocks[b].arena = 0;
   return p;
 }
 
+/* SublimeText marker */
+void fio___mem_block_free_list___(void);
+/** returns a list of empty blocks (linked by `next`) to the free list */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)(
+    FIO_LIST_NODE *n) {
+  if (!n)
+    return;
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  while (n) {
+    FIO_LIST_NODE *next = n->next;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
+    FIO_LIST_PUSH(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c),
+                  n);
+    n = next;
+    /* chunk references only change within the lock */
+    if (c->ref > 1) {
+      fio_atomic_sub(&c->ref, 1);
+      continue;
+    }
+    /* the chunk is free: cache / deallocate (unlocks) */
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c);
+    FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  }
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+}
+
+/* SublimeText marker */
+void fio___mem_arena_block_new___(void);
+/**
+ * Returns a new block for the arena (owned by the caller), reclaiming the
+ * blocks in the arena's remote-free list before using the shared free list.
+ *
+ * The first reclaimed block is reused without locking and the rest are
+ * returned to the free list using a single lock.
+ */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_arena_block_new)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) * a) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c;
+  size_t b;
+  FIO_LIST_NODE *n = NULL;
+  if (a->remote) {
+    fio_atomic_exchange(&a->remote_count, 0);
+    n = fio_atomic_exchange(&a->remote, (FIO_LIST_NODE *)NULL);
+  }
+  if (n) {
+    size_t count = 1;
+    for (FIO_LIST_NODE *i = n->next; i; i = i->next)
+      ++count;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)(n->next);
+    n->next = NULL;
+    a->reclaimed += count;
+    c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
+  } else {
+    n = (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+    if (!n)
+      return NULL;
+    c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
+  }
+  b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, (void *)n);
+  c->blocks[b].ref = 1;
+  c->blocks[b].pos = 0;
+  /* arenas in the state's arena array own their blocks' remote frees */
+  c->blocks[b].arena = 0;
+  if (a >= FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena &&
+      a < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena +
+              FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
+    c->blocks[b].arena =
+        (int32_t)(a - FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena) + 1;
+  return (void *)n;
+}
+
 /* *****************************************************************************
-Small allocation internal API
+Arena slicing (the arena is owned by the caller)
 ***************************************************************************** */
 
 /* SublimeText marker */
-void fio___mem_slice_new___(void);
-/** slice a block to allocate a set number of bytes. */
-FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
-                                           __mem_slice_new)(size_t bytes,
-                                                            void *is_realloc) {
-  void *p = NULL;
-  bytes = (bytes + ((1UL << FIO_MEMORY_ALIGN_LOG) - 1)) >> FIO_MEMORY_ALIGN_LOG;
-  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
-      FIO_NAME(FIO_MEMORY_NAME, __mem_arena_lock)();
+void fio___mem_arena_resize___(void);
+/**
+ * Resizes the last slice in the arena's block (`c`, `b`) in place, keeping
+ * (at most) `keep` bytes. Returns -1 if `ptr` isn't the last slice or the block
+ * is too small.
+ *
+ * The arena must be owned by the caller (locked or thread local).
+ */
+FIO_IFUNC int FIO_NAME(FIO_MEMORY_NAME, __mem_arena_resize)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) * a,
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
+    size_t b,
+    void *ptr,
+    size_t units,
+    size_t keep) {
+  if (ptr != FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, a->last_pos) ||
+      a->last_pos + units >= FIO_MEMORY_UNITS_PER_BLOCK)
+    return -1;
+  const int32_t end = a->last_pos + (int32_t)units;
+  const int32_t old = c->blocks[b].pos;
+  if (end > old)
+    a->bytes += (size_t)(end - old) << FIO_MEMORY_ALIGN_LOG;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  { /* memory past the kept data (and past the block's position) is zero */
+    const size_t used = (size_t)(old - a->last_pos) << FIO_MEMORY_ALIGN_LOG;
+    if (keep < used)
+      FIO_MEMSET((char *)ptr + keep, 0, used - keep);
+  }
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+  c->blocks[b].pos = end;
+  return 0;
+  (void)keep;
+}
 
+/* SublimeText marker */
+void fio___mem_arena_slice___(void);
+/**
+ * Slices the arena's block to allocate a set number of allocation units.
+ *
+ * The arena must be owned by the caller (locked or thread local).
+ */
+FIO_SFUNC void *FIO_MEM_ALIGN_NEW
+FIO_NAME(FIO_MEMORY_NAME, __mem_arena_slice)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) * a,
+    size_t bytes,
+    void *is_realloc) {
+  void *p = NULL;
   if (!a->block) {
-    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_arena_block_new)(a);
     a->last_pos = 0;
   }
   for (;;) {
@@ -13643,21 +16310,26 @@ FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
       a->last_pos = 0;
     }
 
+    /* a lucky realloc? (the last slice is resized in place) */
+    if (is_realloc &&
+        !FIO_NAME(FIO_MEMORY_NAME, __mem_arena_resize)(
+            a,
+            c,
+            b,
+            is_realloc,
+            bytes,
+            bytes << FIO_MEMORY_ALIGN_LOG)) {
+      fio_atomic_sub(&c->blocks[b].ref, 1); /* release reference added */
+      return is_realloc;
+    }
+
     /* enough space? allocate */
     if (c->blocks[b].pos + bytes < FIO_MEMORY_UNITS_PER_BLOCK) {
-      /* a lucky realloc? */
-      if (is_realloc &&
-          is_realloc ==
-              FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, a->last_pos)) {
-        c->blocks[b].pos += bytes;
-        fio_atomic_sub(&c->blocks[b].ref, 1); /* release reference added */
-        FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
-        return is_realloc;
-      }
       p = FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, c->blocks[b].pos);
       a->last_pos = c->blocks[b].pos;
       c->blocks[b].pos += bytes;
-      FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
+      a->bytes += bytes << FIO_MEMORY_ALIGN_LOG;
+      ++a->allocations;
       return p;
     }
     is_realloc = NULL;
@@ -13666,7 +16338,7 @@ FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
      * allocate a new block before freeing the existing block
      * this prevents the last chunk from de-allocating and reallocating
      */
-    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_arena_block_new)(a);
     a->last_pos = 0;
 
     /* release allocation reference added */
@@ -13676,18 +16348,343 @@ FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
   }
 
 no_mem:
-  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
   errno = ENOMEM;
   return p;
 }
 
+/* *****************************************************************************
+Thread cache - lock free slicing of a thread's private block
+***************************************************************************** */
+#if FIO_MEMORY_THREAD_CACHE
+
+/* SublimeText marker */
+void fio___mem_tcache_flush___(void);
+/** Returns a thread's private block to the allocator (on thread exit). */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)(void *tc_) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *tc =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *)tc_;
+  void *block = tc->block;
+  tc->block = NULL;
+  tc->last_pos = 0;
+  if (!block || !FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(block);
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_slice___(void);
+/** Slices the thread's private block, registering the thread on first use. */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME,
+                         __mem_tcache_slice)(size_t units, void *is_realloc) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *tc =
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+  if (!tc->block &&
+      !pthread_getspecific(FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key)))
+    pthread_setspecific(FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key),
+                        (void *)tc);
+  return FIO_NAME(FIO_MEMORY_NAME, __mem_arena_slice)(tc, units, is_realloc);
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_rollback___(void);
+/**
+ * If `p` is the latest slice cut from the thread's private block, the block's
+ * position is rolled back so the memory is reused by the next allocation.
+ */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_rollback)(void *p) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *tc =
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+  if (!tc->block || FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p) !=
+                        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(tc->block))
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *const c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, tc->block);
+  if (p != FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, tc->last_pos) ||
+      c->blocks[b].pos <= tc->last_pos)
+    return;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  FIO_MEMSET(p,
+             0,
+             ((size_t)(c->blocks[b].pos - tc->last_pos)
+              << FIO_MEMORY_ALIGN_LOG));
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+  c->blocks[b].pos = tc->last_pos;
+}
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+/* *****************************************************************************
+Size-class slabs - bitmap slot allocation within a dedicated block
+***************************************************************************** */
+#if FIO_MEMORY_SLAB_CLASSES
+
+/* SublimeText marker */
+void fio___mem_slab_new___(void);
+/** Returns a new (empty) slab for slots of `units` allocation units. */
+FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_new)(size_t units) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *s =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *)FIO_NAME(FIO_MEMORY_NAME,
+                                                         __mem_block_new)();
+  if (!s)
+    return s;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(s);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, s);
+  /* the bitmap is sized for the worst case (no header) */
+  const size_t words = ((FIO_MEMORY_UNITS_PER_BLOCK / units) + 63) >> 6;
+  const size_t offset =
+      (sizeof(*s) + (words << 3) + (FIO_MEMORY_ALIGN_SIZE - 1)) >>
+      FIO_MEMORY_ALIGN_LOG;
+  const size_t slots = (FIO_MEMORY_UNITS_PER_BLOCK - offset) / units;
+  s->node.next = s->node.prev = NULL;
+  s->all.next = s->all.prev = NULL;
+  s->next = NULL;
+  s->used = 0;
+  s->listed = 1;
+  s->slots = (uint32_t)slots;
+  s->units = (uint32_t)units;
+  s->offset = (uint32_t)offset;
+  s->hint = 0;
+  for (size_t i = 0; i < words; ++i)
+    s->map[i] = 0;
+  /* mark the bits past the last slot as used */
+  if ((slots & 63))
+    s->map[slots >> 6] = (~(uint64_t)0) << (slots & 63);
+  /* a negative position marks the block as a slab */
+  c->blocks[b].pos = -(int32_t)units;
+  return s;
+}
+
+/* SublimeText marker */
+void fio___mem_slab_release___(void);
+/** Returns an empty slab's block to the allocator (class lock is held). */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(s);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, s);
+  FIO_LIST_REMOVE(&s->all);
+  /* freed slots are already clean, only the header needs to be reset */
+  c->blocks[b].pos = (int32_t)s->offset;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(s);
+}
+
+/* SublimeText marker */
+void fio___mem_slab_slot_new___(void);
+/** Reserves a free slot in the slab, returns NULL if the slab is full. */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slot_new)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s) {
+  const size_t words = ((size_t)s->slots + 63) >> 6;
+  size_t w = s->hint;
+  for (size_t i = 0; i < words; ++i) {
+    const uint64_t free_slots = ~s->map[w];
+    if (free_slots) {
+      const size_t bit = fio_lsb_index_unsafe(free_slots);
+      /* only allocations set bits and they're serialized by the class lock */
+      fio_atomic_or(s->map + w, ((uint64_t)1 << bit));
+      fio_atomic_add(&s->used, 1);
+      s->hint = (uint32_t)w;
+      return (void *)((uintptr_t)s +
+                      ((s->offset + (((w << 6) | bit) * s->units))
+                       << FIO_MEMORY_ALIGN_LOG));
+    }
+    if (++w == words)
+      w = 0;
+  }
+  return NULL;
+}
+
+/* SublimeText marker */
+void fio___mem_slab_slice_new___(void);
+/** Allocates a slot of `units` allocation units from the size class. */
+FIO_SFUNC void *FIO_MEM_ALIGN_NEW
+FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_new)(size_t units) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *const cls =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + (units - 1);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s;
+  void *p = NULL;
+  FIO_MEMORY_LOCK(cls->lock);
+  for (;;) {
+    if ((s = cls->current)) {
+      if ((p = FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slot_new)(s)))
+        break;
+      /* full slab: unlist it, unless a slot was freed in the meanwhile */
+      cls->current = NULL;
+      fio_atomic_exchange(&s->listed, 0);
+      if (s->used < s->slots && !fio_atomic_exchange(&s->listed, 1))
+        FIO_LIST_PUSH(&cls->partial, &s->node);
+    }
+    /* collect slabs that had a slot freed while they were full */
+    s = fio_atomic_exchange(&cls->pending,
+                            (FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *)NULL);
+    while (s) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *next = s->next;
+      s->next = NULL;
+      FIO_LIST_PUSH(&cls->partial, &s->node);
+      s = next;
+    }
+    /* reuse a partially used slab, releasing surplus empty slabs */
+    while (!FIO_LIST_IS_EMPTY(&cls->partial)) {
+      FIO_LIST_POP(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s),
+                   node,
+                   s,
+                   &cls->partial);
+      s->node.next = s->node.prev = NULL;
+      if (!s->used && !FIO_LIST_IS_EMPTY(&cls->partial)) {
+        FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(s);
+        continue;
+      }
+      cls->current = s;
+      break;
+    }
+    if (cls->current)
+      continue;
+    s = FIO_NAME(FIO_MEMORY_NAME, __mem_slab_new)(units);
+    if (!s)
+      goto no_mem;
+    FIO_LIST_PUSH(&cls->all, &s->all);
+    cls->current = s;
+  }
+  FIO_MEMORY_UNLOCK(cls->lock);
+  return p;
+
+no_mem:
+  FIO_MEMORY_UNLOCK(cls->lock);
+  errno = ENOMEM;
+  return p;
+}
+
+/* SublimeText marker */
+void fio___mem_slab_slice_free___(void);
+/** Frees a slab slot (lock free, unless the slab was full). */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_free)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
+    size_t b,
+    void *p) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *s =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *)FIO_NAME(FIO_MEMORY_NAME,
+                                                         __mem_chunk2ptr)(c,
+                                                                          b,
+                                                                          0);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *const cls =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + (s->units - 1);
+  const size_t units = s->units;
+  const uint32_t slots = s->slots;
+  const size_t i =
+      ((((uintptr_t)p - (uintptr_t)s) >> FIO_MEMORY_ALIGN_LOG) - s->offset) /
+      units;
+  const uint64_t bit = (uint64_t)1 << (i & 63);
+  uint64_t old;
+  FIO_ASSERT_DEBUG(
+      (uintptr_t)p ==
+          (uintptr_t)s + ((s->offset + (i * units)) << FIO_MEMORY_ALIGN_LOG),
+      "slab slot address error (%p), not a slab allocation?",
+      p);
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  FIO_MEMSET(p, 0, units << FIO_MEMORY_ALIGN_LOG);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+  if (s->used == 1 && s != cls->current)
+    goto last_slot;
+  old = fio_atomic_and(s->map + (i >> 6), ~bit);
+  FIO_ASSERT_DEBUG((old & bit), "slab slot freed twice? (%p)", p);
+  if (!(old & bit))
+    return;
+  /* once `used` is updated, the slab may be released by another thread */
+  if (fio_atomic_sub(&s->used, 1) != slots ||
+      fio_atomic_exchange(&s->listed, 1))
+    return;
+  { /* the slab was full and unlisted, push it to the pending stack */
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * head;
+    do {
+      head = cls->pending;
+      s->next = head;
+    } while (!fio_atomic_compare_exchange_p(&cls->pending, &head, &s));
+  }
+  return;
+
+last_slot:
+  /* the slab is (probably) becoming empty, release it while locked */
+  FIO_MEMORY_LOCK(cls->lock);
+  old = fio_atomic_and(s->map + (i >> 6), ~bit);
+  FIO_ASSERT_DEBUG((old & bit), "slab slot freed twice? (%p)", p);
+  if ((old & bit) && fio_atomic_sub(&s->used, 1) == slots &&
+      !fio_atomic_exchange(&s->listed, 1))
+    FIO_LIST_PUSH(&cls->partial, &s->node);
+  if (!s->used && s->node.next && s != cls->current) {
+    FIO_LIST_REMOVE(&s->node);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(s);
+  }
+  FIO_MEMORY_UNLOCK(cls->lock);
+}
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
+/* *****************************************************************************
+Small allocation internal API
+***************************************************************************** */
+
+/* SublimeText marker */
+void fio___mem_slice_new___(void);
+/** slice a block to allocate a set number of bytes. */
+FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
+                                           __mem_slice_new)(size_t bytes,
+                                                            void *is_realloc) {
+  void *p;
+  bytes = (bytes + ((1UL << FIO_MEMORY_ALIGN_LOG) - 1)) >> FIO_MEMORY_ALIGN_LOG;
+#if FIO_MEMORY_THREAD_CACHE
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid))
+    return FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_slice)(bytes, is_realloc);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_arena_lock)();
+  if (a->owner != (void *)&FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token))
+    (void)fio_atomic_exchange(
+        &a->owner,
+        (void *)&FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token));
+  p = FIO_NAME(FIO_MEMORY_NAME, __mem_arena_slice)(a, bytes, is_realloc);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
+  return p;
+}
+
 /* SublimeText marker */
 void fio_____mem_slice_free___(void);
 /** slice a block to allocate a set number of bytes. */
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slice_free)(void *p) {
+#if FIO_MEMORY_THREAD_CACHE
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_rollback)(p);
+#endif /* FIO_MEMORY_THREAD_CACHE */
   FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(p);
 }
 
+/* SublimeText marker */
+void fio_____mem_slice_resize___(void);
+/**
+ * Resizes a slice in place if it's the last slice in its arena's block,
+ * returning NULL if the slice can't be resized (or the arena is busy).
+ */
+FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_slice_resize)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
+    size_t b,
+    void *p,
+    size_t bytes,
+    size_t keep) {
+  void *r = NULL;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena +
+      (c->blocks[b].arena - 1);
+  if (keep > bytes)
+    keep = bytes;
+  bytes = (bytes + ((1UL << FIO_MEMORY_ALIGN_LOG) - 1)) >> FIO_MEMORY_ALIGN_LOG;
+  /* don't wait for the arena, allocating a new slice is cheaper */
+  if (FIO_MEMORY_TRYLOCK(a->lock))
+    return r;
+  if (a->block == FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0) &&
+      !FIO_NAME(FIO_MEMORY_NAME, __mem_arena_resize)(a, c, b, p, bytes, keep))
+    r = p;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
+  return r;
+}
+
 /* *****************************************************************************
 big block allocation / de-allocation
 ***************************************************************************** */
@@ -13826,19 +16823,29 @@ FIO_NAME(FIO_MEMORY_NAME, __mem_big_slice_new)(size_t bytes, void *is_realloc) {
       FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos = 0;
     }
 
+    /* a lucky realloc? (the last slice is resized in place) */
+    if (is_realloc &&
+        is_realloc ==
+            FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(
+                b,
+                FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos) &&
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos + bytes <
+            FIO_MEMORY_UNITS_PER_BIG_BLOCK) {
+      const int32_t end =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos + (int32_t)bytes;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+      if (end < b->pos) /* memory past the block's position is zero */
+        FIO_MEMSET(FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(b, end),
+                   0,
+                   (size_t)(b->pos - end) << FIO_MEMORY_ALIGN_LOG);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+      b->pos = end;
+      FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
+      return is_realloc;
+    }
+
     /* enough space? */
     if (b->pos + bytes < FIO_MEMORY_UNITS_PER_BIG_BLOCK) {
-      /* a lucky realloc? */
-      if (is_realloc &&
-          is_realloc ==
-              FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(
-                  b,
-                  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos)) {
-        b->pos += bytes;
-        FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
-        return is_realloc;
-      }
-
       p = FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(b, b->pos);
       fio_atomic_add(&b->ref, 1); /* keep inside lock to enable reset */
       FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos = b->pos;
@@ -13916,6 +16923,12 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void) {
                    "\t* local per-allocation limit (before mmap): %zu bytes\n"
                    "\t* malloc(0) pointer:                        %p\n"
                    "\t* always initializes memory  (zero-out):    %s\n"
+                   "\t* per-thread block cache:                   %s\n"
+                   "\t* size-class slab limit:                    %zu bytes\n"
+                   "\t* huge page backed chunks:                  %s\n"
+                   "\t* cached system allocation decay:           %zu ms\n"
+                   "\t* heap profiler sampling interval:          %zu bytes\n"
+                   "\t* NUMA nodes (arena groups):                %zu nodes\n"
                    "\t* " FIO_MEMORY_LOCK_NAME " locking system\n",
       (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count,
       (size_t)FIO_MEMORY_SYS_ALLOCATION_SIZE,
@@ -13928,7 +16941,15 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void) {
       (size_t)FIO_MEMORY_BLOCK_ALLOC_LIMIT,
       (size_t)FIO_MEMORY_ALLOC_LIMIT,
       FIO_MEMORY_MALLOC_ZERO_POINTER,
-      (FIO_MEMORY_INITIALIZE_ALLOCATIONS ? "true" : "false"));
+      (FIO_MEMORY_INITIALIZE_ALLOCATIONS ? "true" : "false"),
+      (FIO_MEMORY_THREAD_CACHE ? "true" : "false"),
+      (size_t)FIO_MEMORY_SLAB_LIMIT,
+      (FIO_MEMORY_HUGE_PAGES > 1
+           ? "explicit (MAP_HUGETLB)"
+           : (FIO_MEMORY_HUGE_PAGES ? "transparent (madvise)" : "false")),
+      (size_t)FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay_time)(),
+      (size_t)FIO_MEMORY_PROFILE,
+      FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)());
 }
 
 /* *****************************************************************************
@@ -13968,6 +16989,8 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
             FIO_NAME(FIO_MEMORY_NAME, mmap)) " allocation (slow): %zu bytes",
         FIO_MEM_BYTES2PAGES(size));
 #endif
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_redirects,
+                   1);
     p = FIO_NAME(FIO_MEMORY_NAME, mmap)(size);
     return p;
   }
@@ -13981,14 +17004,28 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
     p = FIO_NAME(FIO_MEMORY_NAME, __mem_big_slice_new)(size, is_realloc);
     if (p && p != is_realloc) {
       FIO_MEMORY_ON_ALLOC_FUNC();
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(p, size);
     }
     return p;
   }
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
 
+#if FIO_MEMORY_SLAB_CLASSES
+  if (size <= FIO_MEMORY_SLAB_LIMIT) {
+    p = FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_new)(
+        (size + (FIO_MEMORY_ALIGN_SIZE - 1)) >> FIO_MEMORY_ALIGN_LOG);
+    if (p) {
+      FIO_MEMORY_ON_ALLOC_FUNC();
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(p, size);
+    }
+    return p;
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
   p = FIO_NAME(FIO_MEMORY_NAME, __mem_slice_new)(size, is_realloc);
   if (p && p != is_realloc) {
     FIO_MEMORY_ON_ALLOC_FUNC();
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(p, size);
   }
   return p;
 malloc_zero:
@@ -14062,6 +17099,7 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, free)(void *ptr) {
     return;
   }
   FIO_MEMORY_ON_FREE_FUNC();
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_free)(ptr);
 
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   if (c->marker == FIO_MEMORY_BIG_BLOCK_MARKER) {
@@ -14074,6 +17112,16 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, free)(void *ptr) {
   if (((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE) == (uintptr_t)ptr && c->marker)
     goto mmap_free;
 
+#if FIO_MEMORY_SLAB_CLASSES
+  { /* slab allocation? (slabs have a negative block position) */
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, ptr);
+    if (c->blocks[b].pos < 0) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_free)(c, b, ptr);
+      return;
+    }
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
   FIO_NAME(FIO_MEMORY_NAME, __mem_slice_free)(ptr);
   return;
 
@@ -14084,14 +17132,20 @@ mmap_free:
              ((size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG) -
                  FIO_MEMORY_ALIGN_SIZE);
   FIO_MEMORY_ON_CHUNK_FREE(c);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_allocations,
+                 1);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes,
+                 (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
   FIO_MEM_SYS_FREE(c, (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
 }
 
 /* SublimeText marker */
 void fio_realloc__(void);
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  */
 SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc)(void *ptr,
                                                              size_t new_size) {
@@ -14105,13 +17159,17 @@ FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
     size_t new_size) {
   const size_t new_len = FIO_MEM_BYTES2PAGES(new_size + FIO_MEMORY_ALIGN_SIZE);
+  const size_t old_len = (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG;
   c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_REALLOC(
       c,
-      (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG,
+      old_len,
       new_len,
       FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG);
   if (!c)
     return NULL;
+  /* unsigned wrap-around subtracts the difference when shrinking */
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes,
+                 new_len - old_len);
   c->marker = (uint32_t)(new_len >> FIO_MEM_PAGE_SIZE_LOG);
   return (void *)((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE);
 }
@@ -14119,8 +17177,10 @@ FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(
 /* SublimeText marker */
 void fio_realloc2__(void);
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  *
  * This variation is slightly faster as it might copy less data.
  */
@@ -14145,6 +17205,9 @@ SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc2)(void *ptr,
         ((uintptr_t)ptr);
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
     if (c->marker == FIO_MEMORY_BIG_BLOCK_MARKER) {
+      /* shrinking? the memory is valid for the new size */
+      if (new_size <= copy_len)
+        return (mem = ptr);
       /* extend max_len to accommodate possible length */
       max_len =
           ((uintptr_t)c + FIO_MEMORY_SYS_ALLOCATION_SIZE) - ((uintptr_t)ptr);
@@ -14152,11 +17215,37 @@ SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc2)(void *ptr,
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
       if ((uintptr_t)(c) + FIO_MEMORY_ALIGN_SIZE == (uintptr_t)ptr &&
           c->marker) {
-        if (new_size > FIO_MEMORY_ALLOC_LIMIT)
-          return (
-              mem = FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(c, new_size));
+        if (new_size > FIO_MEMORY_ALLOC_LIMIT) {
+          mem = FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(c, new_size);
+          if (mem)
+            FIO_NAME(FIO_MEMORY_NAME, __mem_prof_move)(ptr, mem, new_size);
+          return mem;
+        }
         max_len = new_size; /* shrinking from mmap to allocator */
       }
+#if FIO_MEMORY_SLAB_CLASSES
+      else if (c->blocks[b].pos < 0) {
+        /* slab slots are fixed in size, reuse the slot if it's big enough */
+        max_len = (size_t)(-c->blocks[b].pos) << FIO_MEMORY_ALIGN_LOG;
+        if (new_size <= max_len) {
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+          if (copy_len < max_len)
+            FIO_MEMSET((char *)ptr + copy_len, 0, max_len - copy_len);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+          return (mem = ptr);
+        }
+      }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+      else {
+        /* the last slice in an arena's block is resized in place */
+        if (c->blocks[b].arena &&
+            (mem = FIO_NAME(FIO_MEMORY_NAME,
+                            __mem_slice_resize)(c, b, ptr, new_size, copy_len)))
+          return mem;
+        /* shrinking? the memory is valid for the new size */
+        if (new_size <= copy_len)
+          return (mem = ptr);
+      }
 
     if (copy_len > max_len)
       copy_len = max_len;
@@ -14222,7 +17311,12 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size) {
     goto no_mem;
   FIO_MEMORY_ON_ALLOC_FUNC();
   FIO_MEMORY_ON_CHUNK_ALLOC(c);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_allocations,
+                 1);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes, pages);
   c->marker = (uint32_t)(pages >> FIO_MEM_PAGE_SIZE_LOG);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)
+  ((void *)((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE), size);
   return (void *)((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE);
 no_mem:
   errno = ENOMEM;
@@ -14450,6 +17544,74 @@ FIO_IFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
   return NULL;
 }
 
+#if FIO_MEMORY_THREAD_CACHE
+#define FIO___MEM_TEST_TCACHE_SLICES 256
+/* allocates slices in a thread that exits before the slices are freed */
+FIO_SFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                              mem_tcache_tsk)(void *ary_) {
+  void **ary = (void **)ary_;
+  for (size_t i = 0; i < FIO___MEM_TEST_TCACHE_SLICES; ++i) {
+    ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(48);
+    FIO_ASSERT(ary[i], "thread cache allocation failed!");
+    FIO_MEMSET(ary[i], (int)(i & 0xFF), 48);
+  }
+  return NULL;
+}
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+#if !FIO_MEMORY_THREAD_CACHE
+#define FIO___MEM_TEST_REMOTE_SLICES 256
+/* frees slices that were allocated by another thread (NULL terminated) */
+FIO_SFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                              mem_remote_tsk)(void *ary_) {
+  void **ary = (void **)ary_;
+  for (size_t i = 0; ary[i]; ++i)
+    FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+  return NULL;
+}
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+#if FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE
+#define FIO___MEM_TEST_NUMA_SLICES 8
+/* the (fake) NUMA node of the calling thread */
+static __thread size_t FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                     mem_numa_node_value);
+FIO_SFUNC size_t FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                               mem_numa_node)(void) {
+  return FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio), mem_numa_node_value);
+}
+/* allocates blocks on a fake node, testing arena and chunk placement */
+FIO_SFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                              mem_numa_tsk)(void *node_) {
+  void *ary[FIO___MEM_TEST_NUMA_SLICES];
+  const size_t node = (size_t)(uintptr_t)node_;
+  const size_t group = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count /
+                       FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)();
+  FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio), mem_numa_node_value) = node;
+  /* blocks sliced before the topology changed are used up first */
+  for (size_t i = 0; i < FIO___MEM_TEST_NUMA_SLICES; ++i) {
+    ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+    FIO_ASSERT(ary[i], "NUMA block allocation failed!");
+    FIO_MEMSET(ary[i], (int)node, FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+  }
+  void *p = ary[FIO___MEM_TEST_NUMA_SLICES - 1];
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, p);
+  const size_t arena = (size_t)c->blocks[b].arena;
+  FIO_ASSERT(arena > node * group && arena <= (node + 1) * group,
+             "thread on node %zu should use the node's arenas (used %zu)",
+             node,
+             arena - 1);
+  FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c) == node,
+             "blocks should be taken from chunks on the thread's node (%zu)",
+             node);
+  for (size_t i = 0; i < FIO___MEM_TEST_NUMA_SLICES; ++i)
+    FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+  return NULL;
+}
+#endif /* FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE */
+
 /* main test function */
 FIO_SFUNC void FIO_NAME_TEST(FIO_NAME(stl, FIO_MEMORY_NAME), mem)(void) {
   fprintf(stderr,
@@ -14508,6 +17670,351 @@ FIO_SFUNC void FIO_NAME_TEST(FIO_NAME(stl, FIO_MEMORY_NAME), mem)(void) {
       }
     }
   }
+#if FIO_MEMORY_THREAD_CACHE
+  {
+    fprintf(stderr, "* Testing per-thread block cache.\n");
+    char *a = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(32);
+    FIO_ASSERT(a, "thread cache allocation failed!");
+    FIO_MEMSET(a, 0xFF, 32);
+    FIO_NAME(FIO_MEMORY_NAME, free)(a);
+    char *b = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(32);
+    FIO_ASSERT(a == b, "thread cache didn't reuse the latest (freed) slice!");
+    FIO_ASSERT(!FIO_MEMORY_INITIALIZE_ALLOCATIONS || (!b[0] && !b[31]),
+               "thread cache reused memory that wasn't zeroed out!");
+    FIO_NAME(FIO_MEMORY_NAME, free)(b);
+
+    void *ary[4][FIO___MEM_TEST_TCACHE_SLICES];
+    fio_thread_t threads[4];
+    for (size_t i = 0; i < 4; ++i) {
+      FIO_ASSERT(!fio_thread_create(
+                     threads + i,
+                     FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                   mem_tcache_tsk),
+                     (void *)ary[i]),
+                 "couldn't spawn thread for thread cache test");
+    }
+    for (size_t i = 0; i < 4; ++i)
+      fio_thread_join(threads + i);
+    for (size_t i = 0; i < 4; ++i) {
+      /* the thread's reference to the block is released on thread exit */
+      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(ary[i][0]);
+      size_t blk = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, ary[i][0]);
+      FIO_ASSERT((size_t)c->blocks[blk].ref == FIO___MEM_TEST_TCACHE_SLICES,
+                 "thread cache block wasn't released on thread exit (%zu)",
+                 (size_t)c->blocks[blk].ref);
+      for (size_t j = 0; j < FIO___MEM_TEST_TCACHE_SLICES; ++j) {
+        FIO_ASSERT(((uint8_t *)ary[i][j])[0] == (uint8_t)(j & 0xFF) &&
+                       ((uint8_t *)ary[i][j])[47] == (uint8_t)(j & 0xFF),
+                   "thread cache memory corrupted (thread %zu, slice %zu)",
+                   i,
+                   j);
+        FIO_NAME(FIO_MEMORY_NAME, free)(ary[i][j]);
+      }
+    }
+  }
+#undef FIO___MEM_TEST_TCACHE_SLICES
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_SLAB_CLASSES
+  {
+    fprintf(stderr, "* Testing size-class slabs (slot reuse).\n");
+    void *ary[512];
+    char *keep = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(48);
+    FIO_ASSERT(keep, "slab allocation failed!");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(keep);
+    size_t blk = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, keep);
+    FIO_ASSERT(c->blocks[blk].pos < 0, "small allocation isn't in a slab!");
+    for (size_t round = 0; round < 2; ++round) {
+      for (size_t i = 0; i < 512; ++i) {
+        ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(48);
+        FIO_ASSERT(ary[i], "slab allocation failed!");
+        FIO_ASSERT(!FIO_MEMORY_INITIALIZE_ALLOCATIONS ||
+                       (!((char *)ary[i])[0] && !((char *)ary[i])[47]),
+                   "slab slot wasn't zeroed out!");
+        /* freed slots are reused, the kept slot doesn't pin new blocks */
+        FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(ary[i]) == c &&
+                       FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(
+                           c,
+                           ary[i]) == blk,
+                   "slab slots weren't reused (round %zu, slot %zu)",
+                   round,
+                   i);
+        FIO_MEMSET(ary[i], 0xFF, 48);
+      }
+      for (size_t i = 0; i < 512; ++i)
+        FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+    }
+    keep[0] = 1;
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, realloc2)(keep, 40, 1) == keep,
+               "slab reallocation within the slot should be in place");
+    FIO_ASSERT(keep[0] == 1, "slab reallocation lost data!");
+    FIO_NAME(FIO_MEMORY_NAME, free)(keep);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+#if FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY
+  {
+    fprintf(stderr, "* Testing cached chunk decay.\n");
+    /* age (and unmap) any existing cached chunks */
+    for (size_t i = 0; i < FIO_MEMORY_CACHE_SLOTS; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] -=
+          ((int64_t)FIO_MEMORY_CACHE_DECAY << 1);
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos,
+               "aged cached chunks should have been unmapped");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_new)(1);
+    FIO_ASSERT(c, "chunk allocation failed!");
+    FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c); /* caches and unlocks */
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos == 1 &&
+                   FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[0] == c,
+               "freed chunk should have been cached");
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos == 1 &&
+                   !FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[0],
+               "a recently cached chunk shouldn't decay");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[0] -=
+        FIO_MEMORY_CACHE_DECAY;
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos == 1 &&
+                   FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[0],
+               "an idle cached chunk should be released, but remain mapped");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[0] -=
+        FIO_MEMORY_CACHE_DECAY;
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos,
+               "a long idle cached chunk should be unmapped");
+  }
+#endif /* FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY */
+  {
+    fprintf(stderr, "* Testing allocator statistics.\n");
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    s0 = FIO_NAME(FIO_MEMORY_NAME, malloc_stats)();
+    FIO_ASSERT(s0.arenas ==
+                   FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count,
+               "statistics arena count error");
+    FIO_ASSERT(s0.chunks_mapped >= s0.chunks_cached,
+               "statistics should count cached chunks as mapped");
+    void *p = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_ALLOC_LIMIT + 1);
+    FIO_ASSERT(p, "mmap redirected allocation failed!");
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    s1 = FIO_NAME(FIO_MEMORY_NAME, malloc_stats)();
+    FIO_ASSERT(s1.mmap_redirects == s0.mmap_redirects + 1 &&
+                   s1.mmap_allocations == s0.mmap_allocations + 1 &&
+                   s1.mmap_bytes > s0.mmap_bytes + FIO_MEMORY_ALLOC_LIMIT,
+               "statistics should count allocations redirected to mmap");
+    FIO_NAME(FIO_MEMORY_NAME, free)(p);
+    s1 = FIO_NAME(FIO_MEMORY_NAME, malloc_stats)();
+    FIO_ASSERT(s1.mmap_allocations == s0.mmap_allocations &&
+                   s1.mmap_bytes == s0.mmap_bytes,
+               "statistics should count mmap deallocations");
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(s0.arenas)
+                    .allocations,
+               "statistics for a missing arena should be zero");
+#if !FIO_MEMORY_THREAD_CACHE
+    size_t allocations = 0;
+    for (size_t i = 0; i < s0.arenas; ++i)
+      allocations +=
+          FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).allocations;
+    p = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_SLAB_LIMIT + 16);
+    FIO_ASSERT(p, "arena allocation failed!");
+    for (size_t i = 0; i < s0.arenas; ++i)
+      allocations -=
+          FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).allocations;
+    FIO_ASSERT(allocations == (size_t)-1,
+               "statistics should count arena allocations");
+    FIO_NAME(FIO_MEMORY_NAME, free)(p);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+  }
+#if !FIO_MEMORY_THREAD_CACHE
+  {
+    fprintf(stderr, "* Testing remote (cross-thread) block frees.\n");
+    void *ary[FIO___MEM_TEST_REMOTE_SLICES + 1];
+    size_t reclaimed = 0, remote = 0, count;
+    fio_thread_t t;
+    const size_t per_block =
+        FIO_MEMORY_BLOCK_SIZE / FIO_MEMORY_BLOCK_ALLOC_LIMIT;
+    FIO_ASSERT(per_block * FIO_MEMORY_BLOCKS_PER_ALLOCATION * 3 <=
+                       FIO___MEM_TEST_REMOTE_SLICES &&
+                   per_block * FIO___MEM_REMOTE_FREE_LIMIT * 2 <=
+                       FIO___MEM_TEST_REMOTE_SLICES,
+               "remote free test array too small");
+    /* blocks freed by the arena's owner are released without waiting */
+    count = per_block * FIO_MEMORY_BLOCKS_PER_ALLOCATION * 3;
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    {
+      size_t mapped = FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks;
+      size_t cached = 0;
+#if FIO_MEMORY_CACHE_SLOTS
+      cached = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos;
+#endif /* FIO_MEMORY_CACHE_SLOTS */
+      for (size_t i = 0; i < count; ++i)
+        FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+#if FIO_MEMORY_CACHE_SLOTS
+      cached = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos - cached;
+#endif /* FIO_MEMORY_CACHE_SLOTS */
+      FIO_ASSERT(cached ||
+                     FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks < mapped,
+                 "chunks emptied by the arena's owner should be released");
+    }
+    /* remote-free lists are bounded */
+    count = per_block * FIO___MEM_REMOTE_FREE_LIMIT * 2;
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    ary[count] = NULL;
+    FIO_ASSERT(!fio_thread_create(&t,
+                                  FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                                mem_remote_tsk),
+                                  (void *)ary),
+               "couldn't start remote free thread");
+    fio_thread_join(&t);
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i) {
+      size_t len = 0;
+      for (FIO_LIST_NODE *n =
+               FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote;
+           n;
+           n = n->next)
+        ++len;
+      FIO_ASSERT(len < FIO___MEM_REMOTE_FREE_LIMIT,
+                 "remote-free lists should be returned once they're full");
+    }
+    /* remote-free lists are reclaimed by the arena */
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    count = per_block * (FIO___MEM_REMOTE_FREE_LIMIT >> 1);
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    ary[count] = NULL;
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      reclaimed += FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).reclaimed;
+    FIO_ASSERT(!fio_thread_create(&t,
+                                  FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                                mem_remote_tsk),
+                                  (void *)ary),
+               "couldn't start remote free thread");
+    fio_thread_join(&t);
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      remote += !!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote;
+    FIO_ASSERT(remote,
+               "blocks emptied by another thread should wait in the arena's "
+               "remote-free list");
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      reclaimed -= FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).reclaimed;
+    FIO_ASSERT((intptr_t)reclaimed < 0,
+               "the arena should reclaim blocks from its remote-free list");
+    for (size_t i = 0; i < count; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote,
+                 "malloc_cache_decay should empty the remote-free lists");
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if !FIO_MEMORY_THREAD_CACHE
+  if (((FIO_MEMORY_SLAB_LIMIT + 64) << 1) < FIO_MEMORY_BLOCK_ALLOC_LIMIT) {
+    fprintf(stderr, "* Testing in place reallocation (last slice in block).\n");
+    const size_t len = FIO_MEMORY_SLAB_LIMIT + 64;
+    char *p = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(len);
+    FIO_ASSERT(p, "arena allocation failed!");
+    FIO_MEMSET(p, 'a', len);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, p);
+    const size_t offset =
+        (size_t)((uintptr_t)p -
+                 (uintptr_t)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0));
+    char *tmp = (char *)FIO_NAME(FIO_MEMORY_NAME, realloc2)(p, len << 1, len);
+    FIO_ASSERT(tmp, "reallocation failed!");
+    FIO_ASSERT(tmp == p || offset + (len << 1) >= FIO_MEMORY_BLOCK_SIZE,
+               "the last slice in a block should grow in place");
+    p = tmp;
+    FIO_ASSERT(p[0] == 'a' && p[len - 1] == 'a',
+               "in place reallocation should keep the data");
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+    for (size_t i = len; i < (len << 1); ++i)
+      FIO_ASSERT(!p[i], "reallocated memory should be zeroed (%zu)", i);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+    tmp = (char *)FIO_NAME(FIO_MEMORY_NAME, realloc2)(p, 32, 32);
+    FIO_ASSERT(tmp == p, "shrinking should never move the memory");
+    FIO_ASSERT(p[0] == 'a' && p[31] == 'a',
+               "in place shrinking should keep the data");
+    FIO_NAME(FIO_MEMORY_NAME, free)(p);
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count > 1) {
+    fprintf(stderr, "* Testing NUMA arena groups (fake topology).\n");
+    const size_t detected = FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)();
+    FIO_ASSERT(
+        FIO_NAME(FIO_MEMORY_NAME, malloc_numa_topology)(
+            2,
+            FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio), mem_numa_node)) == 0,
+        "faking the NUMA topology failed");
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)() == 2,
+               "the fake NUMA topology should have 2 nodes");
+    for (size_t node = 0; node < 2; ++node) {
+      fio_thread_t t;
+      FIO_ASSERT(
+          !fio_thread_create(&t,
+                             FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                           mem_numa_tsk),
+                             (void *)(uintptr_t)node),
+          "couldn't start NUMA test thread");
+      fio_thread_join(&t);
+    }
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, malloc_numa_topology)(0, NULL) == 0 &&
+                   FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)() == detected,
+               "restoring the detected NUMA topology failed");
+  }
+#endif /* FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_PROFILE
+  {
+    void *p[64];
+    const size_t live = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count;
+    const size_t before = live + FIO_NAME(FIO_MEMORY_NAME, __mem_prof).dropped;
+    fprintf(stderr, "* Testing heap profiler (sampled allocations).\n");
+    /* each allocation is larger than the longest sampling interval */
+    for (size_t i = 0; i < 64; ++i) {
+      p[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_PROFILE * 2);
+      FIO_ASSERT(p[i], "sampled allocation failed!");
+    }
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count +
+                       FIO_NAME(FIO_MEMORY_NAME, __mem_prof).dropped >=
+                   before + 63,
+               "heap profiler should sample large allocations");
+    FILE *tmp = tmpfile();
+    FIO_ASSERT(tmp, "couldn't create a temporary file for the heap profile");
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(fileno(tmp), 0),
+               "heap profile dump (pprof) failed");
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(fileno(tmp), 1),
+               "heap profile dump (folded) failed");
+    char header[16] = {0};
+    FIO_ASSERT(pread(fileno(tmp), header, 14, 0) == 14 &&
+                   !FIO_MEMCMP(header, "heap profile: ", 14),
+               "heap profile dump header error");
+    fclose(tmp);
+    for (size_t i = 0; i < 64; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, free)(p[i]);
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count <= live,
+               "heap profiler should forget freed allocations");
+  }
+#endif /* FIO_MEMORY_PROFILE */
   fprintf(stderr,
           "* Re-validating allocation alignment on %zu byte border.\n",
           (size_t)(FIO_MEMORY_ALIGN_SIZE));
@@ -14549,8 +18056,10 @@ Memory pool cleanup
 #undef FIO_MEMORY_PRINT_STATS_END
 
 #undef FIO_MEMORY_ARENA_COUNT
+#undef FIO_MEMORY_THREAD_CACHE
 #undef FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG
 #undef FIO_MEMORY_CACHE_SLOTS
+#undef FIO_MEMORY_CACHE_DECAY
 #undef FIO_MEMORY_ALIGN_LOG
 #undef FIO_MEMORY_INITIALIZE_ALLOCATIONS
 #undef FIO_MEMORY_USE_THREAD_MUTEX
@@ -14558,6 +18067,19 @@ Memory pool cleanup
 #undef FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG
 #undef FIO_MEMORY_BLOCKS_PER_ALLOCATION
 #undef FIO_MEMORY_ENABLE_BIG_ALLOC
+#undef FIO_MEMORY_SLAB_LIMIT
+#undef FIO_MEMORY_SLAB_CLASSES
+#undef FIO_MEMORY_HUGE_PAGES
+#undef FIO_MEMORY_PROFILE
+#undef FIO_MEMORY_PROFILE_DEPTH
+#undef FIO_MEMORY_PROFILE_SLOTS
+#undef FIO_MEMORY_PROFILE_SLOTS_LOG
+#undef FIO_MEMORY_PROFILE_MASK
+#undef FIO_MEMORY_PROFILE_FILTER_MASK
+#undef FIO_MEMORY_NUMA
+#undef FIO_MEMORY_NUMA_MAX_NODES
+#undef FIO_MEMORY_NUMA_MAX_CPUS
+#undef FIO_MEMORY_NUMA_LISTS
 #undef FIO_MEMORY_ARENA_COUNT_FALLBACK
 #undef FIO_MEMORY_ARENA_COUNT_MAX
 #undef FIO_MEMORY_WARMUP
@@ -14568,11 +18090,950 @@ Memory pool cleanup
 #undef FIO_MEMORY_TRYLOCK
 #undef FIO_MEMORY_LOCK
 #undef FIO_MEMORY_UNLOCK
+#undef FIO___MEM_ARENA_ALIGN
+#undef FIO___MEM_REMOTE_FREE_LIMIT
 
 /* don't undefine FIO_MEMORY_NAME due to possible use in allocation macros */
 /* ************************************************************************* */
 #if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
 #define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_REGION_NAME region /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                  Region (bump / arena) Memory Allocator
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_REGION_NAME) && !defined(FIO___RECURSIVE_INCLUDE)
+
+/* *****************************************************************************
+Region Settings
+***************************************************************************** */
+
+#ifndef FIO_REGION_PAGE_SIZE
+/** The size of each page (system allocation) in the region's page chain. */
+#define FIO_REGION_PAGE_SIZE 8192
+#endif
+
+#ifndef FIO_REGION_ALIGN_LOG
+/** Allocation alignment, MUST be >= 3 and <= 10 */
+#define FIO_REGION_ALIGN_LOG 4
+#elif FIO_REGION_ALIGN_LOG < 3 || FIO_REGION_ALIGN_LOG > 10
+#undef FIO_REGION_ALIGN_LOG
+#define FIO_REGION_ALIGN_LOG 4
+#endif
+
+/* Helper macros, don't change their values */
+#undef FIO_REGION_ALIGN_SIZE
+#undef FIO_REGION_HEADER_SIZE
+#undef FIO_REGION_PAGE_CAPA
+#undef FIO_REGION_ALLOC_LIMIT
+
+#define FIO_REGION_ALIGN_SIZE (1UL << FIO_REGION_ALIGN_LOG)
+/* page header size, rounded up to the allocation alignment */
+#define FIO_REGION_HEADER_SIZE                                                 \
+  ((sizeof(FIO_NAME(FIO_REGION_NAME, __page_s)) +                              \
+    (FIO_REGION_ALIGN_SIZE - 1)) &                                             \
+   (~(FIO_REGION_ALIGN_SIZE - 1)))
+/* bytes available for allocations in each (regular) page */
+#define FIO_REGION_PAGE_CAPA (FIO_REGION_PAGE_SIZE - FIO_REGION_HEADER_SIZE)
+/* larger allocations are given their own (dedicated) page */
+#define FIO_REGION_ALLOC_LIMIT (FIO_REGION_PAGE_CAPA >> 2)
+
+/* *****************************************************************************
+Region API - types, constructor / destructor
+***************************************************************************** */
+
+typedef struct FIO_NAME(FIO_REGION_NAME, __page_s)
+    FIO_NAME(FIO_REGION_NAME, __page_s);
+
+/* a page in the region's page chain, the allocations follow the header */
+struct FIO_NAME(FIO_REGION_NAME, __page_s) {
+  FIO_NAME(FIO_REGION_NAME, __page_s) * next;
+  /* bytes available after the (aligned) header */
+  size_t capa;
+};
+
+typedef struct {
+  /* do not directly access! */
+  FIO_NAME(FIO_REGION_NAME, __page_s) * first; /* retained page chain */
+  FIO_NAME(FIO_REGION_NAME, __page_s) * page;  /* current page in the chain */
+  FIO_NAME(FIO_REGION_NAME, __page_s) * big;   /* dedicated (large) pages */
+  char *pos;
+  char *end;
+  void *last; /* the last allocation may be resized / freed in place */
+} FIO_NAME(FIO_REGION_NAME, s);
+
+#ifndef FIO_REGION_INIT
+/* Initialization macro. */
+#define FIO_REGION_INIT                                                        \
+  { 0 }
+#endif
+
+/* do we have a constructor? */
+#ifndef FIO_REF_CONSTRUCTOR_ONLY
+
+/* Allocates a new region object on the heap and initializes it's memory. */
+FIO_IFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, new)(void);
+
+/* Frees all the region's memory AND the object's container! */
+FIO_IFUNC int FIO_NAME(FIO_REGION_NAME, free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                               r);
+
+#endif /* FIO_REF_CONSTRUCTOR_ONLY */
+
+/** Returns all the region's memory to the system and re-initializes it. */
+SFUNC void FIO_NAME(FIO_REGION_NAME, destroy)(FIO_NAME(FIO_REGION_NAME, s) *
+                                              r);
+
+/**
+ * Invalidates all the allocations made using the region, so its memory can be
+ * reused.
+ *
+ * The page chain is retained, so this is O(1) unless large (dedicated page)
+ * allocations were made, which are returned to the system.
+ */
+FIO_IFUNC void FIO_NAME(FIO_REGION_NAME, reset)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                r);
+
+/* *****************************************************************************
+Region API - allocation
+***************************************************************************** */
+
+/**
+ * Allocates `size` bytes from the region.
+ *
+ * Memory isn't initialized (it may contain junk data from before a `reset`).
+ *
+ * Returns NULL on error (`errno` is set to ENOMEM).
+ */
+FIO_IFUNC void *FIO_NAME(FIO_REGION_NAME, malloc)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                      r,
+                                                  size_t size);
+
+/**
+ * Re-allocates memory, copying (at most) `copy_len` bytes if the memory moved.
+ *
+ * The last allocation made using the region is resized in place whenever
+ * possible. Otherwise the old memory remains reserved until the region is
+ * reset (or destroyed).
+ */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, realloc2)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                    r,
+                                                void *ptr,
+                                                size_t new_size,
+                                                size_t copy_len);
+
+/**
+ * Allows the memory to be reused if `ptr` was the last allocation made using
+ * the region (or a large allocation). Otherwise does nothing.
+ *
+ * Memory is normally reclaimed in bulk, using `reset` or `destroy`.
+ */
+SFUNC void FIO_NAME(FIO_REGION_NAME, dealloc)(FIO_NAME(FIO_REGION_NAME, s) * r,
+                                              void *ptr);
+
+/* *****************************************************************************
+Region API - the calling thread's region (used by types)
+***************************************************************************** */
+
+/**
+ * Sets the calling thread's current region, returning the previous one.
+ *
+ * Types defined in the same `include` statement as the region allocate their
+ * memory from the calling thread's current region (see `FIO_MEM_REALLOC_`).
+ */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) *
+    FIO_NAME(FIO_REGION_NAME, use)(FIO_NAME(FIO_REGION_NAME, s) * r);
+
+/** Returns the calling thread's current region (or NULL). */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, current)(void);
+
+/* *****************************************************************************
+Region Implementation - inlined static functions
+***************************************************************************** */
+
+/* returns the first (aligned) allocation address in a page */
+#define FIO_REGION_PAGE2PTR(page) ((char *)(page) + FIO_REGION_HEADER_SIZE)
+
+/* do we have a constructor? */
+#ifndef FIO_REF_CONSTRUCTOR_ONLY
+/* Allocates a new region object on the heap and initializes it's memory. */
+FIO_IFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, new)(void) {
+  FIO_NAME(FIO_REGION_NAME, s) *r = (FIO_NAME(FIO_REGION_NAME, s) *)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*r), 0);
+  if (r) {
+    *r = (FIO_NAME(FIO_REGION_NAME, s))FIO_REGION_INIT;
+  }
+  return r;
+}
+/* Frees all the region's memory AND the object's container! */
+FIO_IFUNC int FIO_NAME(FIO_REGION_NAME, free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                               r) {
+  FIO_NAME(FIO_REGION_NAME, destroy)(r);
+  FIO_MEM_FREE_(r, sizeof(*r));
+  return 0;
+}
+#endif /* FIO_REF_CONSTRUCTOR_ONLY */
+
+/* allocates a new page / collects a large allocation (slow path) */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, __malloc_slow)(FIO_NAME(FIO_REGION_NAME,
+                                                              s) *
+                                                         r,
+                                                     size_t size);
+
+/* returns the large allocation (dedicated page) list to the system */
+SFUNC void FIO_NAME(FIO_REGION_NAME, __big_free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                 r);
+
+/* Invalidates all allocations (O(1) unless large allocations were made). */
+FIO_IFUNC void FIO_NAME(FIO_REGION_NAME, reset)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                r) {
+  if (!r)
+    return;
+  if (r->big)
+    FIO_NAME(FIO_REGION_NAME, __big_free)(r);
+  r->page = r->first;
+  r->last = NULL;
+  r->pos = r->end = NULL;
+  if (r->first) {
+    r->pos = FIO_REGION_PAGE2PTR(r->first);
+    r->end = r->pos + r->first->capa;
+  }
+}
+
+/* Allocates `size` bytes from the region. */
+FIO_IFUNC void *FIO_NAME(FIO_REGION_NAME, malloc)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                      r,
+                                                  size_t size) {
+  void *p;
+  if (!r || size > ((~(size_t)0) >> 1))
+    goto no_mem;
+  size = (size + (!size << FIO_REGION_ALIGN_LOG) +
+          (FIO_REGION_ALIGN_SIZE - 1)) &
+         (~(FIO_REGION_ALIGN_SIZE - 1));
+  if ((size_t)(r->end - r->pos) < size)
+    return FIO_NAME(FIO_REGION_NAME, __malloc_slow)(r, size);
+  p = (void *)r->pos;
+  r->pos += size;
+  r->last = p;
+  return p;
+no_mem:
+  errno = ENOMEM;
+  return NULL;
+}
+
+/* *****************************************************************************
+Region Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+/* the calling thread's current region */
+static __thread FIO_NAME(FIO_REGION_NAME, s) *
+    FIO_NAME(FIO_REGION_NAME, __current);
+
+/** Sets the calling thread's current region, returning the previous one. */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) *
+    FIO_NAME(FIO_REGION_NAME, use)(FIO_NAME(FIO_REGION_NAME, s) * r) {
+  FIO_NAME(FIO_REGION_NAME, s) *old = FIO_NAME(FIO_REGION_NAME, __current);
+  FIO_NAME(FIO_REGION_NAME, __current) = r;
+  return old;
+}
+
+/** Returns the calling thread's current region (or NULL). */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, current)(void) {
+  return FIO_NAME(FIO_REGION_NAME, __current);
+}
+
+/* allocates a page with `capa` bytes available for allocations */
+FIO_SFUNC FIO_NAME(FIO_REGION_NAME, __page_s) *
+    FIO_NAME(FIO_REGION_NAME, __page_new)(size_t capa) {
+  FIO_NAME(FIO_REGION_NAME, __page_s) *page =
+      (FIO_NAME(FIO_REGION_NAME, __page_s) *)
+          FIO_MEM_REALLOC_(NULL, 0, FIO_REGION_HEADER_SIZE + capa, 0);
+  if (!page)
+    return page;
+  page->next = NULL;
+  page->capa = capa;
+  return page;
+}
+
+/* returns a page list to the system */
+FIO_SFUNC void FIO_NAME(FIO_REGION_NAME, __page_free_all)(
+    FIO_NAME(FIO_REGION_NAME, __page_s) * page) {
+  while (page) {
+    FIO_NAME(FIO_REGION_NAME, __page_s) *tmp = page;
+    page = page->next;
+    FIO_MEM_FREE_(tmp, FIO_REGION_HEADER_SIZE + tmp->capa);
+  }
+}
+
+/* returns the large allocation (dedicated page) list to the system */
+SFUNC void FIO_NAME(FIO_REGION_NAME, __big_free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                 r) {
+  FIO_NAME(FIO_REGION_NAME, __page_free_all)(r->big);
+  r->big = NULL;
+}
+
+/* allocates a new page / collects a large allocation (slow path) */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, __malloc_slow)(FIO_NAME(FIO_REGION_NAME,
+                                                              s) *
+                                                         r,
+                                                     size_t size) {
+  FIO_NAME(FIO_REGION_NAME, __page_s) * page;
+  if (size > FIO_REGION_ALLOC_LIMIT) {
+    /* large allocations are given a dedicated page */
+    if (size + FIO_REGION_HEADER_SIZE < size)
+      goto no_mem;
+    page = FIO_NAME(FIO_REGION_NAME, __page_new)(size);
+    if (!page)
+      goto no_mem;
+    page->next = r->big;
+    r->big = page;
+    return (void *)FIO_REGION_PAGE2PTR(page);
+  }
+  if (r->page && r->page->next) {
+    /* reuse a page retained by `reset` */
+    page = r->page->next;
+  } else {
+    page = FIO_NAME(FIO_REGION_NAME, __page_new)(FIO_REGION_PAGE_CAPA);
+    if (!page)
+      goto no_mem;
+    if (r->page)
+      r->page->next = page;
+    else
+      r->first = page;
+  }
+  r->page = page;
+  r->pos = FIO_REGION_PAGE2PTR(page) + size;
+  r->end = FIO_REGION_PAGE2PTR(page) + page->capa;
+  r->last = (void *)FIO_REGION_PAGE2PTR(page);
+  return r->last;
+no_mem:
+  errno = ENOMEM;
+  return NULL;
+}
+
+/** Returns all the region's memory to the system and re-initializes it. */
+SFUNC void FIO_NAME(FIO_REGION_NAME, destroy)(FIO_NAME(FIO_REGION_NAME, s) *
+                                              r) {
+  if (!r)
+    return;
+  FIO_NAME(FIO_REGION_NAME, __page_free_all)(r->big);
+  FIO_NAME(FIO_REGION_NAME, __page_free_all)(r->first);
+  *r = (FIO_NAME(FIO_REGION_NAME, s))FIO_REGION_INIT;
+}
+
+/** Re-allocates memory, copying (at most) `copy_len` if the memory moved. */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, realloc2)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                    r,
+                                                void *ptr,
+                                                size_t new_size,
+                                                size_t copy_len) {
+  void *p;
+  if (!ptr)
+    return FIO_NAME(FIO_REGION_NAME, malloc)(r, new_size);
+  if (!r || new_size > ((~(size_t)0) >> 1))
+    goto no_mem;
+  new_size = (new_size + (!new_size << FIO_REGION_ALIGN_LOG) +
+              (FIO_REGION_ALIGN_SIZE - 1)) &
+             (~(FIO_REGION_ALIGN_SIZE - 1));
+  if (ptr == r->last && (size_t)(r->end - (char *)ptr) >= new_size) {
+    /* the last allocation is resized in place */
+    r->pos = (char *)ptr + new_size;
+    return ptr;
+  }
+  if (r->big && ptr == (void *)FIO_REGION_PAGE2PTR(r->big) &&
+      new_size > FIO_REGION_ALLOC_LIMIT) {
+    /* the last large allocation is reallocated by the system allocator */
+    if (new_size + FIO_REGION_HEADER_SIZE < new_size)
+      goto no_mem;
+    if (copy_len > new_size)
+      copy_len = new_size;
+    FIO_NAME(FIO_REGION_NAME, __page_s) *page =
+        (FIO_NAME(FIO_REGION_NAME, __page_s) *)FIO_MEM_REALLOC_(
+            r->big,
+            FIO_REGION_HEADER_SIZE + r->big->capa,
+            FIO_REGION_HEADER_SIZE + new_size,
+            FIO_REGION_HEADER_SIZE + copy_len);
+    if (!page)
+      goto no_mem;
+    page->capa = new_size;
+    r->big = page;
+    return (void *)FIO_REGION_PAGE2PTR(page);
+  }
+  p = FIO_NAME(FIO_REGION_NAME, malloc)(r, new_size);
+  if (!p)
+    return p;
+  if (copy_len > new_size)
+    copy_len = new_size;
+  if (copy_len)
+    FIO_MEMCPY(p, ptr, copy_len);
+  return p;
+no_mem:
+  errno = ENOMEM;
+  return NULL;
+}
+
+/** Allows the memory to be reused if `ptr` was the last allocation. */
+SFUNC void FIO_NAME(FIO_REGION_NAME, dealloc)(FIO_NAME(FIO_REGION_NAME, s) * r,
+                                              void *ptr) {
+  if (!r || !ptr)
+    return;
+  if (ptr == r->last) {
+    r->pos = (char *)ptr;
+    r->last = NULL;
+    return;
+  }
+  if (r->big && ptr == (void *)FIO_REGION_PAGE2PTR(r->big)) {
+    FIO_NAME(FIO_REGION_NAME, __page_s) *page = r->big;
+    r->big = page->next;
+    FIO_MEM_FREE_(page, FIO_REGION_HEADER_SIZE + page->capa);
+  }
+}
+
+/* *****************************************************************************
+Module Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO_REGION_PAGE2PTR
+#undef FIO_REGION_ALIGN_SIZE
+#undef FIO_REGION_HEADER_SIZE
+#undef FIO_REGION_PAGE_CAPA
+#undef FIO_REGION_ALLOC_LIMIT
+
+/* *****************************************************************************
+Route the memory allocation macros to the calling thread's current region
+***************************************************************************** */
+#ifndef FIO_MALLOC_TMP_USE_SYSTEM
+
+#undef FIO_MEM_REALLOC_
+#undef FIO_MEM_FREE_
+#undef FIO_MEM_REALLOC_IS_SAFE_
+
+#define FIO_MEM_REALLOC_(ptr, old_size, new_size, copy_len)                    \
+  FIO_NAME(FIO_REGION_NAME, realloc2)                                          \
+  (FIO_NAME(FIO_REGION_NAME, current)(), (ptr), (new_size), (copy_len))
+#define FIO_MEM_FREE_(ptr, size)                                               \
+  FIO_NAME(FIO_REGION_NAME, dealloc)                                           \
+  (FIO_NAME(FIO_REGION_NAME, current)(), (ptr))
+#define FIO_MEM_REALLOC_IS_SAFE_ 0
+
+#endif /* FIO_MALLOC_TMP_USE_SYSTEM */
+
+#undef FIO_REGION_PAGE_SIZE
+#undef FIO_REGION_ALIGN_LOG
+#endif /* FIO_REGION_NAME */
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_POOL_NAME pool     /* Development inclusion - ignore line */
+#define FIO_POOL_TYPE size_t   /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                        Fixed Size Object Pool
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if !defined(H___FIO_POOL_CORE___H) &&                                         \
+    (defined(FIO_POOL_NAME) || defined(FIO_REF_POOL) ||                        \
+     (FIO_USE_POOL && (defined(FIO_QUEUE) || defined(FIO_STREAM))))
+#define H___FIO_POOL_CORE___H
+#if FIO_OS_POSIX
+#include <pthread.h>
+#endif
+
+/* *****************************************************************************
+Pool Settings
+***************************************************************************** */
+
+#ifndef FIO_POOL_DEPOT
+/**
+ * The number of slots in each pool's global (shared) free list, MUST be a power
+ * of 2.
+ *
+ * Each slot holds a chain of free objects (at least a magazine's worth).
+ */
+#define FIO_POOL_DEPOT 32
+#elif (FIO_POOL_DEPOT & (FIO_POOL_DEPOT - 1)) || FIO_POOL_DEPOT < 1
+#undef FIO_POOL_DEPOT
+#define FIO_POOL_DEPOT 32
+#endif
+
+/* *****************************************************************************
+Pool Core - types
+
+Objects are carved from page sized slabs. Each thread caches free objects in a
+private magazine (a singly linked list), so most allocations and frees are a
+pointer swap.
+
+Magazines exchange whole chains of objects with a global "depot" - an array of
+slots, each holding a single chain. A chain is placed in an empty slot using
+CAS (`NULL` => chain) and taken using an atomic exchange (chain => `NULL`),
+which makes the depot lock-free without suffering from the ABA problem.
+***************************************************************************** */
+
+typedef struct fio___pool_node_s fio___pool_node_s;
+/* a free object - the first object in a chain stores the chain's tail / size */
+struct fio___pool_node_s {
+  fio___pool_node_s *next;
+  fio___pool_node_s *tail;
+  size_t count;
+};
+
+typedef struct fio___pool_slab_s fio___pool_slab_s;
+/* a slab (system allocation), objects follow the (aligned) header */
+struct fio___pool_slab_s {
+  fio___pool_slab_s *next;
+};
+
+typedef struct fio___pool_s {
+  /* global free list: chains of free objects (see above) */
+  fio___pool_node_s *volatile depot[FIO_POOL_DEPOT];
+  /* all the slabs allocated by the pool (returned to the system on exit) */
+  fio___pool_slab_s *volatile slabs;
+  /* the number of objects carved from the slabs */
+  volatile size_t objects;
+  /* object (slot) size, slab size and magazine length */
+  size_t size;
+  size_t slab;
+  size_t mag;
+  /* slab allocation and pool cleanup are routed to the defining module */
+  void *(*slab_alloc)(size_t size);
+  void (*slab_free)(void *slab, size_t size);
+  void (*at_exit)(void *ignr_);
+  fio_lock_i lock;
+  volatile uint8_t ready;
+  volatile uint8_t registered;
+#if FIO_OS_POSIX
+  /* the key's destructor returns a thread's magazine when the thread exits */
+  pthread_key_t key;
+#endif
+} fio___pool_s;
+
+/* a thread's magazine (a private list of free objects) */
+typedef struct fio___pool_mag_s {
+  fio___pool_node_s *head;
+  size_t count;
+  size_t hint;
+  fio___pool_s *pool; /* set once the thread is known to the pool */
+} fio___pool_mag_s;
+
+/* slab header size, rounded up to 16 bytes (the objects' alignment) */
+#define FIO___POOL_SLAB_HEADER                                                 \
+  ((sizeof(fio___pool_slab_s) + 15) & (~(size_t)15))
+/* object size, rounded up to 16 bytes and able to hold a chain's head */
+#define FIO___POOL_OBJ_SIZE(size)                                              \
+  ((((size) > sizeof(fio___pool_node_s) ? (size)                               \
+                                        : sizeof(fio___pool_node_s)) +         \
+    15) &                                                                      \
+   (~(size_t)15))
+/* slab size, whole pages holding at least two magazines */
+#define FIO___POOL_SLAB_SIZE(obj_size, mag)                                    \
+  ((FIO___POOL_SLAB_HEADER + ((obj_size) * ((mag) << 1)) +                     \
+    ((1UL << FIO_MEM_PAGE_SIZE_LOG) - 1)) &                                    \
+   (~((1UL << FIO_MEM_PAGE_SIZE_LOG) - 1)))
+
+/* pool initializer */
+#define FIO___POOL_INIT(obj_size, mag_, alloc_fn, free_fn, exit_fn)            \
+  {                                                                            \
+    .depot = {0}, .slabs = NULL, .objects = 0,                                 \
+    .size = FIO___POOL_OBJ_SIZE(obj_size),                                     \
+    .slab = FIO___POOL_SLAB_SIZE(FIO___POOL_OBJ_SIZE(obj_size), (mag_)),       \
+    .mag = (mag_), .slab_alloc = alloc_fn, .slab_free = free_fn,               \
+    .at_exit = exit_fn                                                         \
+  }
+
+/**
+ * Defines a static pool named `name` for objects of `obj_size` bytes, with a
+ * per-thread magazine of `mag` objects (`FIO_NAME(name, __mag)`).
+ *
+ * Slabs are allocated using the `FIO_MEM_REALLOC_` of the defining module and
+ * the pool's memory is returned to the system on exit (if all objects were
+ * returned to the pool).
+ */
+#define FIO___POOL_DEF(name, obj_size, mag_)                                   \
+  FIO_SFUNC void *FIO_NAME(name, __slab_alloc)(size_t size) {                  \
+    return FIO_MEM_REALLOC_(NULL, 0, size, 0);                                 \
+  }                                                                            \
+  FIO_SFUNC void FIO_NAME(name, __slab_free)(void *slab, size_t size) {        \
+    FIO_MEM_FREE_(slab, size);                                                 \
+    (void)size;                                                                \
+  }                                                                            \
+  FIO_SFUNC void FIO_NAME(name, __at_exit)(void *ignr_);                       \
+  static fio___pool_s name = FIO___POOL_INIT(obj_size,                         \
+                                             mag_,                             \
+                                             FIO_NAME(name, __slab_alloc),     \
+                                             FIO_NAME(name, __slab_free),      \
+                                             FIO_NAME(name, __at_exit));       \
+  static __thread fio___pool_mag_s FIO_NAME(name, __mag);                      \
+  FIO_SFUNC void FIO_NAME(name, __at_exit)(void *ignr_) {                      \
+    if (fio___pool_destroy(&name, &FIO_NAME(name, __mag)))                     \
+      FIO_LOG_DEBUG2("object pool " FIO_MACRO2STR(                             \
+          name) " retained (objects still in use at exit).");                  \
+    (void)ignr_;                                                               \
+  }
+
+/* *****************************************************************************
+Pool Core - API (used by the pool template and other modules)
+***************************************************************************** */
+
+/* allocates an object (slow path: refills the magazine). */
+FIO_SFUNC void *fio___pool_alloc_slow(fio___pool_s *p, fio___pool_mag_s *m);
+
+/* moves all but `keep` objects from the magazine to the depot. */
+FIO_SFUNC void fio___pool_flush(fio___pool_s *p,
+                                fio___pool_mag_s *m,
+                                size_t keep);
+
+/* registers the thread's magazine with the pool (for thread exit). */
+FIO_SFUNC void fio___pool_register(fio___pool_s *p, fio___pool_mag_s *m);
+
+/* allocates slabs so that (at least) `count` objects were carved. */
+FIO_SFUNC size_t fio___pool_warmup(fio___pool_s *p, size_t count);
+
+/* returns the pool's memory to the system if all objects were returned. */
+FIO_SFUNC int fio___pool_destroy(fio___pool_s *p, fio___pool_mag_s *m);
+
+/* allocates an object (memory isn't initialized). */
+FIO_IFUNC void *fio___pool_alloc(fio___pool_s *p, fio___pool_mag_s *m) {
+  fio___pool_node_s *n = m->head;
+  if (FIO_UNLIKELY(!n))
+    return fio___pool_alloc_slow(p, m);
+  m->head = n->next;
+  --m->count;
+  return (void *)n;
+}
+
+/* returns an object to the pool. */
+FIO_IFUNC void fio___pool_free(fio___pool_s *p, fio___pool_mag_s *m, void *o) {
+  fio___pool_node_s *n = (fio___pool_node_s *)o;
+  if (!n)
+    return;
+  if (FIO_UNLIKELY(!m->pool))
+    fio___pool_register(p, m);
+  n->next = m->head;
+  m->head = n;
+  if (FIO_UNLIKELY(++m->count >= (p->mag << 1)))
+    fio___pool_flush(p, m, p->mag);
+}
+
+/* *****************************************************************************
+Pool Core - Implementation
+***************************************************************************** */
+
+/* places a chain in the depot, merging chains if the depot is full. */
+FIO_SFUNC void fio___pool_depot_put(fio___pool_s *p,
+                                    fio___pool_node_s *chain,
+                                    size_t hint) {
+  for (;;) {
+    for (size_t i = 0; i < FIO_POOL_DEPOT; ++i) {
+      fio___pool_node_s **slot = (fio___pool_node_s **)(p->depot +
+                                                        ((hint + i) &
+                                                         (FIO_POOL_DEPOT - 1)));
+      fio___pool_node_s *expected = NULL;
+      if (!*slot && fio_atomic_compare_exchange_p(slot, &expected, &chain))
+        return;
+    }
+    /* depot is full, take a chain and append it to ours */
+    fio___pool_node_s *other = fio_atomic_exchange(
+        (fio___pool_node_s **)(p->depot + (hint & (FIO_POOL_DEPOT - 1))),
+        (fio___pool_node_s *)NULL);
+    if (!other)
+      continue;
+    chain->tail->next = other;
+    chain->tail = other->tail;
+    chain->count += other->count;
+  }
+}
+
+/* takes a chain from the depot (or returns NULL). */
+FIO_SFUNC fio___pool_node_s *fio___pool_depot_take(fio___pool_s *p,
+                                                   size_t hint) {
+  for (size_t i = 0; i < FIO_POOL_DEPOT; ++i) {
+    fio___pool_node_s **slot = (fio___pool_node_s **)(p->depot +
+                                                      ((hint + i) &
+                                                       (FIO_POOL_DEPOT - 1)));
+    fio___pool_node_s *c;
+    if (*slot && (c = fio_atomic_exchange(slot, (fio___pool_node_s *)NULL)))
+      return c;
+  }
+  return NULL;
+}
+
+/* allocates a slab and returns its objects as a chain (or NULL). */
+FIO_SFUNC fio___pool_node_s *fio___pool_slab_new(fio___pool_s *p) {
+  fio___pool_slab_s *s = (fio___pool_slab_s *)p->slab_alloc(p->slab);
+  if (!s)
+    return NULL;
+  const size_t count = (p->slab - FIO___POOL_SLAB_HEADER) / p->size;
+  char *pos = (char *)s + FIO___POOL_SLAB_HEADER;
+  fio___pool_node_s *head = (fio___pool_node_s *)pos;
+  for (size_t i = 1; i < count; ++i) {
+    ((fio___pool_node_s *)pos)->next = (fio___pool_node_s *)(pos + p->size);
+    pos += p->size;
+  }
+  ((fio___pool_node_s *)pos)->next = NULL;
+  head->tail = (fio___pool_node_s *)pos;
+  head->count = count;
+  /* push the slab to the slab list (push only, no ABA concerns) */
+  s->next = p->slabs;
+  while (!fio_atomic_compare_exchange_p((fio___pool_slab_s **)&p->slabs,
+                                        &s->next,
+                                        &s))
+    ;
+  fio_atomic_add(&p->objects, count);
+  /* registered after the first slab, so cleanup runs before the allocator's */
+  if (!p->registered && !fio_atomic_exchange(&p->registered, 1))
+    fio_state_callback_add(FIO_CALL_AT_EXIT, p->at_exit, NULL);
+  return head;
+}
+
+/* registers the thread's magazine with the pool (for thread exit). */
+FIO_SFUNC void fio___pool_on_thread_exit(void *m_) {
+  fio___pool_mag_s *m = (fio___pool_mag_s *)m_;
+  if (m && m->pool)
+    fio___pool_flush(m->pool, m, 0);
+}
+
+FIO_SFUNC void fio___pool_register(fio___pool_s *p, fio___pool_mag_s *m) {
+  m->pool = p;
+  m->hint = (size_t)(((uintptr_t)m >> 6) ^ ((uintptr_t)m >> 12));
+#if FIO_OS_POSIX
+  if (!p->ready) {
+    fio_lock(&p->lock);
+    if (!p->ready)
+      p->ready = !pthread_key_create(&p->key, fio___pool_on_thread_exit);
+    fio_unlock(&p->lock);
+  }
+  if (p->ready)
+    pthread_setspecific(p->key, (void *)m);
+#endif
+}
+
+/* allocates an object (slow path: refills the magazine). */
+FIO_SFUNC void *fio___pool_alloc_slow(fio___pool_s *p, fio___pool_mag_s *m) {
+  fio___pool_node_s *c;
+  if (!m->pool)
+    fio___pool_register(p, m);
+  c = fio___pool_depot_take(p, m->hint);
+  if (!c && !(c = fio___pool_slab_new(p))) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  if (c->count > p->mag) { /* keep a magazine's worth, return the rest */
+    fio___pool_node_s *last = c;
+    for (size_t i = 1; i < p->mag; ++i)
+      last = last->next;
+    fio___pool_node_s *rest = last->next;
+    rest->tail = c->tail;
+    rest->count = c->count - p->mag;
+    last->next = NULL;
+    c->count = p->mag;
+    fio___pool_depot_put(p, rest, m->hint + 1);
+  }
+  m->head = c->next;
+  m->count = c->count - 1;
+  return (void *)c;
+}
+
+/* moves all but `keep` objects from the magazine to the depot. */
+FIO_SFUNC void fio___pool_flush(fio___pool_s *p,
+                                fio___pool_mag_s *m,
+                                size_t keep) {
+  fio___pool_node_s *c, **pos = &m->head;
+  if (m->count <= keep)
+    return;
+  /* the most recently freed (cache hot) objects stay in the magazine */
+  for (size_t i = 0; i < keep; ++i)
+    pos = &(*pos)->next;
+  c = *pos;
+  *pos = NULL;
+  c->count = m->count - keep;
+  c->tail = c;
+  while (c->tail->next)
+    c->tail = c->tail->next;
+  m->count = keep;
+  fio___pool_depot_put(p, c, m->hint);
+}
+
+/* allocates slabs so that (at least) `count` objects were carved. */
+FIO_SFUNC size_t fio___pool_warmup(fio___pool_s *p, size_t count) {
+  while (p->objects < count) {
+    fio___pool_node_s *c = fio___pool_slab_new(p);
+    if (!c)
+      break;
+    fio___pool_depot_put(p, c, (size_t)p->objects);
+  }
+  return p->objects;
+}
+
+/* returns the pool's memory to the system if all objects were returned. */
+FIO_SFUNC int fio___pool_destroy(fio___pool_s *p, fio___pool_mag_s *m) {
+  fio___pool_node_s *chains[FIO_POOL_DEPOT];
+  size_t count = 0;
+  if (m && m->pool == p)
+    count = m->count;
+  for (size_t i = 0; i < FIO_POOL_DEPOT; ++i) {
+    chains[i] = fio_atomic_exchange((fio___pool_node_s **)(p->depot + i),
+                                    (fio___pool_node_s *)NULL);
+    if (chains[i])
+      count += chains[i]->count;
+  }
+  if (count != p->objects) { /* objects are still in use, retain memory */
+    for (size_t i = 0; i < FIO_POOL_DEPOT; ++i)
+      if (chains[i])
+        fio___pool_depot_put(p, chains[i], i);
+    return -1;
+  }
+  fio___pool_slab_s *s =
+      fio_atomic_exchange((fio___pool_slab_s **)&p->slabs,
+                          (fio___pool_slab_s *)NULL);
+  while (s) {
+    fio___pool_slab_s *tmp = s;
+    s = s->next;
+    p->slab_free((void *)tmp, p->slab);
+  }
+  p->objects = 0;
+  if (m && m->pool == p) {
+    m->head = NULL;
+    m->count = 0;
+  }
+  return 0;
+}
+
+#endif /* H___FIO_POOL_CORE___H */
+
+/* *****************************************************************************
+
+
+
+
+                        Fixed Size Object Pool Template
+
+
+
+
+***************************************************************************** */
+#if defined(FIO_POOL_NAME)
+
+#ifndef FIO_POOL_TYPE
+#error FIO_POOL_TYPE must be defined when defining an object pool.
+#endif
+
+#ifndef FIO_POOL_MAGAZINE
+/** The number of objects exchanged between a thread and the global list. */
+#define FIO_POOL_MAGAZINE 32
+#elif FIO_POOL_MAGAZINE < 1
+#undef FIO_POOL_MAGAZINE
+#define FIO_POOL_MAGAZINE 32
+#endif
+
+#ifndef FIO_POOL_WARMUP
+/** The number of objects to allocate when the program starts (pre-warming). */
+#define FIO_POOL_WARMUP 0
+#endif
+
+/* *****************************************************************************
+Pool API
+***************************************************************************** */
+
+/**
+ * Allocates an object from the pool.
+ *
+ * Memory isn't initialized (it may contain junk data from a previous object).
+ *
+ * Returns NULL on error (`errno` is set to ENOMEM).
+ */
+SFUNC FIO_POOL_TYPE *FIO_NAME(FIO_POOL_NAME, alloc)(void);
+
+/** Returns an object to the pool. */
+SFUNC void FIO_NAME(FIO_POOL_NAME, free)(FIO_POOL_TYPE *obj);
+
+/**
+ * Allocates slabs until at least `count` objects were carved (pre-warming).
+ *
+ * Returns the number of objects carved from the pool's slabs.
+ */
+SFUNC size_t FIO_NAME(FIO_POOL_NAME, warmup)(size_t count);
+
+/**
+ * Returns the pool's memory to the system if all the objects were returned to
+ * the pool (and other threads exited or aren't holding any free objects).
+ *
+ * Returns 0 on success or -1 if the memory was retained.
+ *
+ * This is performed automatically on exit.
+ */
+SFUNC int FIO_NAME(FIO_POOL_NAME, destroy)(void);
+
+/* *****************************************************************************
+Pool Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+FIO___POOL_DEF(FIO_NAME(FIO_POOL_NAME, __pool),
+               sizeof(FIO_POOL_TYPE),
+               FIO_POOL_MAGAZINE)
+
+/** Allocates an object from the pool. */
+SFUNC FIO_POOL_TYPE *FIO_NAME(FIO_POOL_NAME, alloc)(void) {
+  return (FIO_POOL_TYPE *)fio___pool_alloc(
+      &FIO_NAME(FIO_POOL_NAME, __pool),
+      &FIO_NAME(FIO_NAME(FIO_POOL_NAME, __pool), __mag));
+}
+
+/** Returns an object to the pool. */
+SFUNC void FIO_NAME(FIO_POOL_NAME, free)(FIO_POOL_TYPE *obj) {
+  fio___pool_free(&FIO_NAME(FIO_POOL_NAME, __pool),
+                  &FIO_NAME(FIO_NAME(FIO_POOL_NAME, __pool), __mag),
+                  (void *)obj);
+}
+
+/** Allocates slabs until at least `count` objects were carved. */
+SFUNC size_t FIO_NAME(FIO_POOL_NAME, warmup)(size_t count) {
+  return fio___pool_warmup(&FIO_NAME(FIO_POOL_NAME, __pool), count);
+}
+
+/** Returns the pool's memory to the system if all objects were returned. */
+SFUNC int FIO_NAME(FIO_POOL_NAME, destroy)(void) {
+  return fio___pool_destroy(&FIO_NAME(FIO_POOL_NAME, __pool),
+                            &FIO_NAME(FIO_NAME(FIO_POOL_NAME, __pool), __mag));
+}
+
+#if FIO_POOL_WARMUP
+/* pre-warms the pool when the program starts */
+FIO_CONSTRUCTOR(FIO_NAME(FIO_POOL_NAME, __pool_warmup)) {
+  FIO_NAME(FIO_POOL_NAME, warmup)(FIO_POOL_WARMUP);
+}
+#endif /* FIO_POOL_WARMUP */
+
+/* *****************************************************************************
+Module Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO_POOL_NAME
+#undef FIO_POOL_TYPE
+#undef FIO_POOL_MAGAZINE
+#undef FIO_POOL_WARMUP
+#endif /* FIO_POOL_NAME */
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
 #define FIO_POLL               /* Development inclusion - ignore line */
 #include "./include.h"         /* Development inclusion - ignore line */
 #endif                         /* Development inclusion - ignore line */
@@ -14605,6 +19066,11 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #endif
 #endif
 
+#ifndef FIO_POLL_URING_ENTRIES
+/** relevant only for io_uring - the submission queue's size (power of 2) */
+#define FIO_POLL_URING_ENTRIES 256
+#endif
+
 /* *****************************************************************************
 Possible polling engine (system call) selection
 ***************************************************************************** */
@@ -14621,6 +19087,14 @@ Possible polling engine (system call) selection
 /** define `FIO_POLL_ENGINE` as `FIO_POLL_ENGINE_KQUEUE` to use `kqueue` */
 #define FIO_POLL_ENGINE_KQUEUE 3
 #endif
+#ifndef FIO_POLL_ENGINE_EPOLL_ET
+/** define `FIO_POLL_ENGINE` as `FIO_POLL_ENGINE_EPOLL_ET` for edge triggering */
+#define FIO_POLL_ENGINE_EPOLL_ET 4
+#endif
+#ifndef FIO_POLL_ENGINE_IO_URING
+/** define `FIO_POLL_ENGINE` as `FIO_POLL_ENGINE_IO_URING` to use `io_uring` */
+#define FIO_POLL_ENGINE_IO_URING 5
+#endif
 
 /* if `FIO_POLL_ENGINE` wasn't define, detect automatically. */
 #if !defined(FIO_POLL_ENGINE)
@@ -14645,6 +19119,14 @@ Possible polling engine (system call) selection
 #ifndef FIO_POLL_ENGINE_STR
 #define FIO_POLL_ENGINE_STR "kqueue"
 #endif
+#elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_EPOLL_ET
+#ifndef FIO_POLL_ENGINE_STR
+#define FIO_POLL_ENGINE_STR "epoll-et"
+#endif
+#elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+#ifndef FIO_POLL_ENGINE_STR
+#define FIO_POLL_ENGINE_STR "io_uring"
+#endif
 #endif
 /* *****************************************************************************
 Polling API
@@ -14671,7 +19153,11 @@ FIO_IFUNC void fio_poll_init(fio_poll_s *p, fio_poll_settings_s);
 /** Destroys the polling object, freeing its resources. */
 FIO_IFUNC void fio_poll_destroy(fio_poll_s *p);
 
-/** returns the system call used for polling as a constant string. */
+/**
+ * Returns the system call used for polling as a constant string.
+ *
+ * The `io_uring` engine reports `"epoll-et"` when it falls back to `epoll`.
+ */
 FIO_IFUNC const char *fio_poll_engine(void);
 
 /**
@@ -14708,12 +19194,47 @@ SFUNC int fio_poll_review(fio_poll_s *p, size_t timeout);
 /** Stops monitoring the specified file descriptor (if monitoring). */
 SFUNC int fio_poll_forget(fio_poll_s *p, int fd);
 
+/**
+ * Hints that an IO operation on `fd` would block (i.e., `read` returned
+ * `EAGAIN` or less data than requested), so the `flags` events (`POLLIN` /
+ * `POLLOUT`) are no longer ready.
+ *
+ * Edge triggered engines use the hint to avoid testing if an event that was
+ * already reported is still ready. Other engines ignore it.
+ */
+FIO_IFUNC void fio_poll_would_block(fio_poll_s *p,
+                                    int fd,
+                                    unsigned short flags);
+
+/**
+ * Accepts a new connection from the (monitored) listening socket `fd`, same as
+ * calling `accept(fd, NULL, NULL)`.
+ *
+ * The `io_uring` engine accepts connections in the kernel (multishot accept)
+ * and returns a connection that was already accepted, if any.
+ *
+ * Returns -1 on error (`errno == EAGAIN` when no connections are waiting).
+ */
+SFUNC int fio_poll_accept(fio_poll_s *p, int fd);
+
 /* *****************************************************************************
 Implementation Helpers
 ***************************************************************************** */
 
+#if FIO_POLL_ENGINE != FIO_POLL_ENGINE_IO_URING
 /** returns the system call used for polling as a constant string. */
 FIO_IFUNC const char *fio_poll_engine(void) { return FIO_POLL_ENGINE_STR; }
+#endif
+
+#if FIO_POLL_ENGINE != FIO_POLL_ENGINE_EPOLL_ET &&                             \
+    FIO_POLL_ENGINE != FIO_POLL_ENGINE_IO_URING
+/* one-shot engines review the state of every monitored event. */
+FIO_IFUNC void fio_poll_would_block(fio_poll_s *p,
+                                    int fd,
+                                    unsigned short flags) {
+  (void)p, (void)fd, (void)flags;
+}
+#endif
 
 /* validate settings */
 #define FIO_POLL_VALIDATE(settings_dest)                                       \
@@ -14729,12 +19250,842 @@ SFUNC void fio___poll_ev_mock(void *udata);
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 /* mock event */
 SFUNC void fio___poll_ev_mock(void *udata) { (void)udata; }
+
+#if FIO_POLL_ENGINE != FIO_POLL_ENGINE_IO_URING
+/** Accepts a new connection from the listening socket `fd`. */
+SFUNC int fio_poll_accept(fio_poll_s *p, int fd) {
+  (void)p;
+  return (int)accept(fd, NULL, NULL);
+}
+#endif
 #endif /* defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN) */
 /* *****************************************************************************
 Cleanup
 ***************************************************************************** */
 #endif /* FIO_POLL */
 /* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE)                   /* Dev test - ignore line */
+#define FIO_POLL_ENGINE FIO_POLL_ENGINE_IO_URING /* Dev */
+#define FIO___DEV___    /* Development inclusion - ignore line */
+#define FIO_POLL        /* Development inclusion - ignore line */
+#include "./include.h"  /* Development inclusion - ignore line */
+#endif                  /* Development inclusion - ignore line */
+/* ************************************************************************* */
+#if defined(FIO_POLL) &&                                                       \
+    (defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)) &&                  \
+    (FIO_POLL_ENGINE == FIO_POLL_ENGINE_EPOLL_ET ||                            \
+     FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING) &&                           \
+    !defined(H___FIO_POLL_EGN___H) && !defined(H___FIO_POLL___H) &&            \
+    !defined(FIO___RECURSIVE_INCLUDE)
+#define H___FIO_POLL_EGN___H
+/* *****************************************************************************
+
+
+
+
+        POSIX Portable Polling with edge triggered `epoll` / `io_uring`
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#include <sys/epoll.h>
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef POLLRDHUP
+#define FIO___POLL_EDGE_RDHUP POLLRDHUP
+#else
+#define FIO___POLL_EDGE_RDHUP 0
+#endif
+
+/* *****************************************************************************
+Polling API
+
+File descriptors are registered once (for both reading and writing) and the
+one-shot monitoring state is kept in user space:
+
+* `armed` - events the user is waiting for (removed once fired).
+* `ready` - events reported by the kernel that weren't fired yet.
+* `stale` - fired events that may still be ready (the kernel won't report them).
+
+Armed stale events are tested using a single `poll` call per review, unless the
+user hinted that they would block (see `fio_poll_would_block`).
+
+The kernel reports events using `EPOLLET` or, for the `io_uring` engine, using
+a multishot poll request per file descriptor. The `io_uring` engine falls back
+to `EPOLLET` if the kernel doesn't support `io_uring` (or multishot accept).
+***************************************************************************** */
+
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+/* internal use - a submission and completion queue pair (an `io_uring`) */
+typedef struct {
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_flags;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned sq_mask;
+  unsigned cq_mask;
+  unsigned sq_entries;
+  /** SQEs that were queued but weren't submitted yet. */
+  unsigned queued;
+  void *rings;
+  size_t rings_len;
+  size_t sqes_len;
+  int fd;
+} fio___poll_uring_s;
+
+/* multishot accept states */
+#define FIO___POLL_URING_ACCEPT_NONE    0
+#define FIO___POLL_URING_ACCEPT_ARMED   1
+#define FIO___POLL_URING_ACCEPT_ACTIVE  2
+#define FIO___POLL_URING_ACCEPT_FAILED  3
+#endif
+
+/* internal use - a file descriptor's monitoring state */
+typedef struct {
+  void *udata;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  /** connections accepted by the kernel (listening sockets only). */
+  int *accepted;
+  uint32_t accepted_count;
+  uint32_t accepted_capa;
+  /** invalidates completions of requests made before `fio_poll_forget`. */
+  uint16_t gen;
+  unsigned char accepting;
+#endif
+  unsigned short armed;
+  unsigned short ready;
+  unsigned short stale;
+  unsigned char registered;
+  unsigned char pending;
+} fio___poll_edge_fd_s;
+
+/** the `fio_poll_s` type should be considered opaque. */
+struct fio_poll_s {
+  fio_poll_settings_s settings;
+  /** monitoring state, indexed by file descriptor. */
+  fio___poll_edge_fd_s *fds;
+  /** file descriptors with armed events that are (or may be) ready. */
+  int *pending;
+  size_t capa;
+  size_t pending_count;
+  size_t pending_capa;
+  FIO___LOCK_TYPE lock;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  fio___poll_uring_s ring;
+#endif
+  /** the `epoll` file descriptor (-1 when using `io_uring`). */
+  int fd;
+};
+
+/* *****************************************************************************
+`io_uring` queues (Linux 5.19 or later)
+***************************************************************************** */
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+
+/* request `user_data`: fd (32 bits) | generation (16 bits) | kind (16 bits) */
+#define FIO___POLL_URING_POLL   1
+#define FIO___POLL_URING_ACCEPT 2
+#define FIO___POLL_URING_CANCEL 3
+#define FIO___POLL_URING_ID(fd, gen, kind)                                     \
+  ((uint64_t)(uint32_t)(fd) | ((uint64_t)(uint16_t)(gen) << 32) |              \
+   ((uint64_t)(kind) << 48))
+
+/* `io_uring` support: 0 - untested, 1 - supported, -1 - falls back to epoll */
+static volatile int fio___poll_uring_support;
+
+FIO_IFUNC int fio___poll_uring_enter(int fd,
+                                     unsigned submit,
+                                     unsigned wait,
+                                     unsigned flags,
+                                     void *arg,
+                                     size_t arg_len) {
+  return (int)
+      syscall(__NR_io_uring_enter, fd, submit, wait, flags, arg, arg_len);
+}
+
+/* multishot accept was added together with IORING_OP_SOCKET (Linux 5.19). */
+FIO_SFUNC int fio___poll_uring_probe(int fd) {
+  uint64_t buf[(sizeof(struct io_uring_probe) +
+                (sizeof(struct io_uring_probe_op) * 256)) /
+               sizeof(uint64_t)];
+  struct io_uring_probe *probe = (struct io_uring_probe *)buf;
+  FIO_MEMSET(buf, 0, sizeof(buf));
+  if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256))
+    return -1;
+  if (probe->last_op < IORING_OP_SOCKET ||
+      !(probe->ops[IORING_OP_SOCKET].flags & IO_URING_OP_SUPPORTED))
+    return -1;
+  return 0;
+}
+
+FIO_SFUNC void fio___poll_uring_destroy(fio___poll_uring_s *r) {
+  if (r->sqes)
+    munmap(r->sqes, r->sqes_len);
+  if (r->rings)
+    munmap(r->rings, r->rings_len);
+  if (r->fd != -1)
+    close(r->fd);
+  *r = (fio___poll_uring_s){.fd = -1};
+}
+
+/* sets up the queues, returns -1 (marking `io_uring` as unsupported) on error */
+FIO_SFUNC int fio___poll_uring_init(fio___poll_uring_s *r) {
+  struct io_uring_params params;
+  const uint32_t required =
+      (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG);
+  char *rings;
+  *r = (fio___poll_uring_s){.fd = -1};
+  if (fio___poll_uring_support < 0)
+    return -1;
+  FIO_MEMSET(&params, 0, sizeof(params));
+  r->fd = (int)syscall(__NR_io_uring_setup, FIO_POLL_URING_ENTRIES, &params);
+  if (r->fd == -1 || (params.features & required) != required ||
+      fio___poll_uring_probe(r->fd))
+    goto unsupported;
+  r->rings_len = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+  if (r->rings_len <
+      params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe)))
+    r->rings_len =
+        params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+  r->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+  r->rings = mmap(NULL,
+                  r->rings_len,
+                  PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE,
+                  r->fd,
+                  IORING_OFF_SQ_RING);
+  if (r->rings == MAP_FAILED) {
+    r->rings = NULL;
+    goto unsupported;
+  }
+  r->sqes = (struct io_uring_sqe *)mmap(NULL,
+                                        r->sqes_len,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE,
+                                        r->fd,
+                                        IORING_OFF_SQES);
+  if ((void *)r->sqes == MAP_FAILED) {
+    r->sqes = NULL;
+    goto unsupported;
+  }
+  rings = (char *)r->rings;
+  r->sq_head = (unsigned *)(rings + params.sq_off.head);
+  r->sq_tail = (unsigned *)(rings + params.sq_off.tail);
+  r->sq_flags = (unsigned *)(rings + params.sq_off.flags);
+  r->sq_mask = *(unsigned *)(rings + params.sq_off.ring_mask);
+  r->cq_head = (unsigned *)(rings + params.cq_off.head);
+  r->cq_tail = (unsigned *)(rings + params.cq_off.tail);
+  r->cq_mask = *(unsigned *)(rings + params.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe *)(rings + params.cq_off.cqes);
+  r->sq_entries = params.sq_entries;
+  for (unsigned i = 0; i < params.sq_entries; ++i) /* SQE index == slot */
+    ((unsigned *)(rings + params.sq_off.array))[i] = i;
+  fio___poll_uring_support = 1;
+  return 0;
+unsupported:
+  FIO_LOG_DEBUG2("io_uring unavailable, polling with edge triggered epoll");
+  fio___poll_uring_destroy(r);
+  fio___poll_uring_support = -1;
+  return -1;
+}
+
+/* submits queued SQEs without waiting, returns the number submitted. */
+FIO_SFUNC int fio___poll_uring_submit(fio___poll_uring_s *r) {
+  int ret;
+  if (!r->queued)
+    return 0;
+  ret = fio___poll_uring_enter(r->fd, r->queued, 0, 0, NULL, 0);
+  if (ret > 0)
+    r->queued -= ((unsigned)ret > r->queued) ? r->queued : (unsigned)ret;
+  return ret;
+}
+
+/* returns a zeroed SQE, published by `fio___poll_uring_push`, or NULL. */
+FIO_SFUNC struct io_uring_sqe *fio___poll_uring_sqe(fio___poll_uring_s *r) {
+  unsigned head;
+  const unsigned tail = *r->sq_tail; /* only written by us */
+  fio_atomic_load(head, r->sq_head);
+  if (tail - head >= r->sq_entries) { /* full, submit before queueing more */
+    fio___poll_uring_submit(r);
+    fio_atomic_load(head, r->sq_head);
+    if (tail - head >= r->sq_entries)
+      return NULL;
+  }
+  struct io_uring_sqe *sqe = r->sqes + (tail & r->sq_mask);
+  FIO_MEMSET(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+/* publishes the SQE returned by `fio___poll_uring_sqe`. */
+FIO_IFUNC void fio___poll_uring_push(fio___poll_uring_s *r) {
+  fio_atomic_exchange(r->sq_tail, (*r->sq_tail + 1));
+  ++r->queued;
+}
+
+/* queues a multishot poll request for all the events we care about. */
+FIO_SFUNC int fio___poll_uring_poll(fio___poll_uring_s *r, int fd, uint16_t g) {
+  uint32_t events = (POLLIN | POLLOUT | FIO___POLL_EDGE_RDHUP);
+  struct io_uring_sqe *sqe = fio___poll_uring_sqe(r);
+  if (!sqe)
+    return -1;
+#if __BIG_ENDIAN__
+  events = (events << 16) | (events >> 16);
+#endif
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->user_data = FIO___POLL_URING_ID(fd, g, FIO___POLL_URING_POLL);
+  fio___poll_uring_push(r);
+  return 0;
+}
+
+/* queues a multishot accept request for a listening socket. */
+FIO_SFUNC int fio___poll_uring_accept(fio___poll_uring_s *r,
+                                      int fd,
+                                      uint16_t g) {
+  struct io_uring_sqe *sqe = fio___poll_uring_sqe(r);
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->user_data = FIO___POLL_URING_ID(fd, g, FIO___POLL_URING_ACCEPT);
+  fio___poll_uring_push(r);
+  return 0;
+}
+
+/* queues a cancellation (by `user_data`, the fd might have been closed). */
+FIO_SFUNC int fio___poll_uring_cancel(fio___poll_uring_s *r, uint64_t id) {
+  struct io_uring_sqe *sqe = fio___poll_uring_sqe(r);
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = id;
+  sqe->user_data = FIO___POLL_URING_ID(0, 0, FIO___POLL_URING_CANCEL);
+  fio___poll_uring_push(r);
+  return 0;
+}
+
+/* closes the connections that were accepted for `e` but never collected. */
+FIO_SFUNC void fio___poll_uring_accepted_clear(fio___poll_edge_fd_s *e) {
+  for (uint32_t i = 0; i < e->accepted_count; ++i)
+    close(e->accepted[i]);
+  FIO_MEM_FREE_(e->accepted, sizeof(*e->accepted) * e->accepted_capa);
+  e->accepted = NULL;
+  e->accepted_count = e->accepted_capa = 0;
+}
+
+FIO_SFUNC int fio___poll_uring_accepted_push(fio___poll_edge_fd_s *e, int fd) {
+  if (e->accepted_count == e->accepted_capa) {
+    const uint32_t capa = e->accepted_capa ? (e->accepted_capa << 1) : 16;
+    int *tmp =
+        (int *)FIO_MEM_REALLOC_(e->accepted,
+                                sizeof(*e->accepted) * e->accepted_capa,
+                                sizeof(*e->accepted) * capa,
+                                sizeof(*e->accepted) * e->accepted_count);
+    if (!tmp)
+      return -1;
+    e->accepted = tmp;
+    e->accepted_capa = capa;
+  }
+  e->accepted[e->accepted_count++] = fd;
+  return 0;
+}
+
+/* returns the engine's name, testing for `io_uring` support if required. */
+FIO_IFUNC const char *fio_poll_engine(void) {
+  if (!fio___poll_uring_support) {
+    fio___poll_uring_s r;
+    if (!fio___poll_uring_init(&r))
+      fio___poll_uring_destroy(&r);
+  }
+  return (fio___poll_uring_support > 0) ? FIO_POLL_ENGINE_STR : "epoll-et";
+}
+#endif /* FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING */
+
+/* *****************************************************************************
+Polling object life cycle
+***************************************************************************** */
+
+FIO_SFUNC void fio___poll_edge_after_fork(void *p_) {
+  fio_poll_s *p = (fio_poll_s *)p_;
+  fio_poll_destroy(p);
+  fio_poll_init FIO_NOOP(p, p->settings);
+}
+
+/** Initializes the polling object, allocating its resources. */
+FIO_IFUNC void fio_poll_init FIO_NOOP(fio_poll_s *p, fio_poll_settings_s args) {
+  *p = (fio_poll_s){
+      .settings = args,
+      .lock = FIO___LOCK_INIT,
+      .fd = -1,
+  };
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  if (fio___poll_uring_init(&p->ring))
+#endif
+    p->fd = epoll_create1(0);
+  FIO_POLL_VALIDATE(p->settings);
+  fio_state_callback_add(FIO_CALL_IN_CHILD, fio___poll_edge_after_fork, p);
+}
+
+/** Destroys the polling object, freeing its resources. */
+FIO_IFUNC void fio_poll_destroy(fio_poll_s *p) {
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  for (size_t i = 0; i < p->capa; ++i)
+    fio___poll_uring_accepted_clear(p->fds + i);
+  fio___poll_uring_destroy(&p->ring); /* cancels all requests */
+#endif
+  if (p->fd != -1)
+    close(p->fd);
+  p->fd = -1;
+  FIO_MEM_FREE_(p->fds, sizeof(*p->fds) * p->capa);
+  FIO_MEM_FREE_(p->pending, sizeof(*p->pending) * p->pending_capa);
+  p->fds = NULL;
+  p->pending = NULL;
+  p->capa = p->pending_count = p->pending_capa = 0;
+  FIO___LOCK_DESTROY(p->lock);
+  fio_state_callback_remove(FIO_CALL_IN_CHILD, fio___poll_edge_after_fork, p);
+}
+
+/** Hints that an IO operation on `fd` would block (the events aren't ready). */
+FIO_IFUNC void fio_poll_would_block(fio_poll_s *p,
+                                    int fd,
+                                    unsigned short flags) {
+  FIO___LOCK_LOCK(p->lock);
+  if ((size_t)fd < p->capa)
+    p->fds[fd].stale &= ~flags;
+  FIO___LOCK_UNLOCK(p->lock);
+}
+
+/* *****************************************************************************
+Poll Monitoring Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+/* grows the monitoring state table to fit `fd`. Returns -1 on error. */
+FIO_SFUNC int fio___poll_edge_reserve(fio_poll_s *p, int fd) {
+  size_t capa = p->capa ? p->capa : 64;
+  while (capa <= (size_t)fd)
+    capa <<= 1;
+  fio___poll_edge_fd_s *tmp =
+      (fio___poll_edge_fd_s *)FIO_MEM_REALLOC_(p->fds,
+                                               sizeof(*p->fds) * p->capa,
+                                               sizeof(*p->fds) * capa,
+                                               sizeof(*p->fds) * p->capa);
+  if (!tmp)
+    return -1;
+  FIO_MEMSET(tmp + p->capa, 0, sizeof(*tmp) * (capa - p->capa));
+  p->fds = tmp;
+  p->capa = capa;
+  return 0;
+}
+
+/* lists `fd` as pending if it has armed events that may be ready. */
+FIO_IFUNC int fio___poll_edge_pend(fio_poll_s *p, int fd) {
+  fio___poll_edge_fd_s *e = p->fds + fd;
+  if (e->pending || !(e->armed & (e->ready | e->stale)))
+    return 0;
+  if (p->pending_count == p->pending_capa) {
+    const size_t capa = p->pending_capa ? (p->pending_capa << 1) : 64;
+    int *tmp = (int *)FIO_MEM_REALLOC_(p->pending,
+                                       sizeof(*p->pending) * p->pending_capa,
+                                       sizeof(*p->pending) * capa,
+                                       sizeof(*p->pending) * p->pending_count);
+    if (!tmp)
+      return -1;
+    p->pending = tmp;
+    p->pending_capa = capa;
+  }
+  e->pending = 1;
+  p->pending[p->pending_count++] = fd;
+  return 0;
+}
+
+/* converts `epoll` / `poll` events, a closed connection is also readable. */
+FIO_IFUNC unsigned short fio___poll_edge_flags(uint32_t events,
+                                               uint32_t in,
+                                               uint32_t out,
+                                               uint32_t closed) {
+  unsigned short r = 0;
+  if ((events & in))
+    r |= POLLIN;
+  if ((events & out))
+    r |= POLLOUT;
+  if ((events & closed))
+    r |= (POLLIN | POLLHUP);
+  return r;
+}
+
+/* registers `fd` with the kernel (once), called while locked. */
+FIO_IFUNC int fio___poll_edge_add(fio_poll_s *p, int fd) {
+  int r;
+  struct epoll_event chevent = {
+      .events = (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET),
+      .data.fd = fd,
+  };
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  if (p->fd == -1) /* submitted by the next `fio_poll_review` */
+    return fio___poll_uring_poll(&p->ring, fd, p->fds[fd].gen);
+#endif
+  do {
+    r = epoll_ctl(p->fd, EPOLL_CTL_ADD, fd, &chevent);
+  } while (r == -1 && errno == EINTR);
+  if (r == -1 && errno == EEXIST)
+    r = 0;
+  return r;
+}
+
+/**
+ * Adds a file descriptor to be monitored, adds events to be monitored or
+ * updates the monitored file's `udata`.
+ *
+ * Possible flags are: `POLLIN` and `POLLOUT`. Other flags may be set but might
+ * be ignored.
+ *
+ * Monitoring mode is always one-shot. If an event if fired, it is removed from
+ * the monitoring state.
+ *
+ * Returns -1 on error.
+ */
+SFUNC int fio_poll_monitor(fio_poll_s *p,
+                           int fd,
+                           void *udata,
+                           unsigned short flags) {
+  int r = -1;
+  if (!p || fd < 0)
+    return r;
+  FIO___LOCK_LOCK(p->lock);
+  if ((size_t)fd >= p->capa && fio___poll_edge_reserve(p, fd))
+    goto finish;
+  p->fds[fd].udata = udata;
+  if (!p->fds[fd].registered) {
+    if (fio___poll_edge_add(p, fd))
+      goto finish;
+    p->fds[fd].registered = 1;
+  }
+  p->fds[fd].armed |= (flags & (POLLIN | POLLOUT));
+  r = fio___poll_edge_pend(p, fd);
+finish:
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+}
+
+/** Stops monitoring the specified file descriptor, returning -1 on error. */
+SFUNC int fio_poll_forget(fio_poll_s *p, int fd) {
+  int r = -1;
+  struct epoll_event chevent = {.events = (EPOLLOUT | EPOLLIN)};
+  FIO___LOCK_LOCK(p->lock);
+  if ((size_t)fd < p->capa && p->fds[fd].registered) {
+    fio___poll_edge_fd_s *e = p->fds + fd;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+    const uint16_t gen = e->gen;
+    if (p->fd == -1) {
+      /* requests hold a reference to the (possibly closed) file, submit now */
+      fio___poll_uring_cancel(
+          &p->ring,
+          FIO___POLL_URING_ID(fd, gen, FIO___POLL_URING_POLL));
+      if (e->accepting == FIO___POLL_URING_ACCEPT_ARMED ||
+          e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE)
+        fio___poll_uring_cancel(
+            &p->ring,
+            FIO___POLL_URING_ID(fd, gen, FIO___POLL_URING_ACCEPT));
+      fio___poll_uring_submit(&p->ring);
+    }
+    fio___poll_uring_accepted_clear(e);
+    /* the pending list is cleaned up by `fio_poll_review` */
+    *e = (fio___poll_edge_fd_s){.gen = (uint16_t)(gen + 1),
+                                .pending = e->pending};
+    if (p->fd != -1)
+#else
+    /* the pending list is cleaned up by `fio_poll_review` */
+    *e = (fio___poll_edge_fd_s){.pending = e->pending};
+#endif
+      epoll_ctl(p->fd, EPOLL_CTL_DEL, fd, &chevent); /* fails if fd closed */
+    r = 0;
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+}
+
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+/**
+ * Accepts a connection from a listening socket, as if calling `accept`.
+ *
+ * Starts a multishot accept request for the listening socket, so connections
+ * are accepted by the kernel and collected here without a system call.
+ */
+SFUNC int fio_poll_accept(fio_poll_s *p, int fd) {
+  int r = -1;
+  FIO___LOCK_LOCK(p->lock);
+  if (p->fd == -1 && (size_t)fd < p->capa && p->fds[fd].registered) {
+    fio___poll_edge_fd_s *e = p->fds + fd;
+    if (e->accepted_count) {
+      r = e->accepted[0];
+      if (--e->accepted_count)
+        FIO_MEMMOVE(e->accepted,
+                    e->accepted + 1,
+                    sizeof(*e->accepted) * e->accepted_count);
+      FIO___LOCK_UNLOCK(p->lock);
+      return r;
+    }
+    if (e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE) {
+      e->stale &= ~POLLIN; /* drained */
+      FIO___LOCK_UNLOCK(p->lock);
+      errno = EAGAIN;
+      return r;
+    }
+    if (e->accepting == FIO___POLL_URING_ACCEPT_NONE &&
+        !fio___poll_uring_accept(&p->ring, fd, e->gen))
+      e->accepting = FIO___POLL_URING_ACCEPT_ARMED;
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  /* until the kernel starts accepting connections, accept them here */
+  return accept(fd, NULL, NULL);
+}
+
+/* handles a completion event, called while locked. */
+FIO_SFUNC void fio___poll_uring_on_cqe(fio_poll_s *p, struct io_uring_cqe *c) {
+  const int fd = (int)(uint32_t)c->user_data;
+  const uint16_t gen = (uint16_t)(c->user_data >> 32);
+  const unsigned kind = (unsigned)(c->user_data >> 48);
+  const int more = !!(c->flags & IORING_CQE_F_MORE);
+  fio___poll_edge_fd_s *e = ((size_t)fd < p->capa) ? p->fds + fd : NULL;
+  if (kind == FIO___POLL_URING_CANCEL)
+    return;
+  if (!e || !e->registered || e->gen != gen) {
+    if (kind == FIO___POLL_URING_ACCEPT && c->res >= 0)
+      close(c->res); /* accepted after `fio_poll_forget` was called */
+    return;
+  }
+  if (kind == FIO___POLL_URING_ACCEPT) {
+    if (c->res >= 0) {
+      if (fio___poll_uring_accepted_push(e, c->res))
+        close(c->res);
+      e->accepting = FIO___POLL_URING_ACCEPT_ACTIVE;
+      e->ready |= POLLIN;
+      e->stale &= ~POLLIN;
+    }
+    if (!more) {
+      if (c->res >= 0 && !fio___poll_uring_accept(&p->ring, fd, gen)) {
+        e->accepting = FIO___POLL_URING_ACCEPT_ARMED;
+      } else {
+        /* `accept` reports (or handles) the error, never retry unsupported */
+        e->accepting = (c->res == -EINVAL || c->res == -EOPNOTSUPP)
+                           ? FIO___POLL_URING_ACCEPT_FAILED
+                           : FIO___POLL_URING_ACCEPT_NONE;
+        e->ready |= POLLIN;
+      }
+    }
+  } else if (c->res >= 0) {
+    unsigned short flags =
+        fio___poll_edge_flags((uint32_t)c->res,
+                              POLLIN,
+                              POLLOUT,
+                              (FIO___POLL_EDGE_RDHUP | POLLHUP | POLLERR));
+    /* connections are collected by the kernel, ignore the listening socket */
+    if (e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE && !(flags & POLLHUP))
+      flags &= ~POLLIN;
+    e->ready |= flags;
+    e->stale &= ~flags;
+    /* the request was terminated (i.e., overflow), a new one reports state */
+    if (!more && fio___poll_uring_poll(&p->ring, fd, gen))
+      e->ready |= (POLLIN | POLLHUP);
+  } else { /* errors are handled as disconnections */
+    e->ready |= (POLLIN | POLLHUP);
+  }
+  fio___poll_edge_pend(p, fd);
+}
+
+/* submits queued requests, waits for completions and collects their events. */
+FIO_SFUNC void fio___poll_uring_review(fio_poll_s *p, size_t timeout) {
+  fio___poll_uring_s *r = &p->ring;
+  unsigned submit, head, tail, flags;
+  int submitted = 0;
+  FIO___LOCK_LOCK(p->lock);
+  submit = r->queued;
+  head = *r->cq_head;
+  fio_atomic_load(tail, r->cq_tail);
+  fio_atomic_load(flags, r->sq_flags);
+  FIO___LOCK_UNLOCK(p->lock);
+  if (head == tail && timeout) {
+    struct __kernel_timespec ts = {
+        .tv_sec = (long long)(timeout / 1000),
+        .tv_nsec = (long long)((timeout % 1000) * 1000000),
+    };
+    struct io_uring_getevents_arg arg = {.ts = (uint64_t)(uintptr_t)&ts};
+    submitted =
+        fio___poll_uring_enter(r->fd,
+                               submit,
+                               1,
+                               (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG),
+                               &arg,
+                               sizeof(arg));
+  } else if (submit || (flags & IORING_SQ_CQ_OVERFLOW)) {
+    submitted = fio___poll_uring_enter(r->fd,
+                                       submit,
+                                       0,
+                                       IORING_ENTER_GETEVENTS,
+                                       NULL,
+                                       0);
+  }
+  FIO___LOCK_LOCK(p->lock);
+  if (submitted > 0)
+    r->queued -= ((unsigned)submitted > r->queued) ? r->queued
+                                                   : (unsigned)submitted;
+  head = *r->cq_head;
+  fio_atomic_load(tail, r->cq_tail);
+  for (; head != tail; ++head)
+    fio___poll_uring_on_cqe(p, r->cqes + (head & r->cq_mask));
+  fio_atomic_exchange(r->cq_head, head);
+  FIO___LOCK_UNLOCK(p->lock);
+}
+#endif /* FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING */
+
+/* waits for `epoll` events and collects them. */
+FIO_SFUNC void fio___poll_edge_epoll_review(fio_poll_s *p, size_t timeout) {
+  struct epoll_event events[FIO_POLL_MAX_EVENTS];
+  int count = epoll_wait(p->fd, events, FIO_POLL_MAX_EVENTS, (int)timeout);
+  FIO___LOCK_LOCK(p->lock);
+  for (int i = 0; i < count; ++i) {
+    const int fd = events[i].data.fd;
+    const unsigned short flags =
+        fio___poll_edge_flags(events[i].events,
+                              EPOLLIN,
+                              EPOLLOUT,
+                              (EPOLLRDHUP | EPOLLHUP | EPOLLERR));
+    if ((size_t)fd >= p->capa || !p->fds[fd].registered)
+      continue;
+    p->fds[fd].ready |= flags;
+    p->fds[fd].stale &= ~flags;
+    fio___poll_edge_pend(p, fd);
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+}
+
+/**
+ * Reviews if any of the monitored file descriptors has any events.
+ *
+ * `timeout` is in milliseconds.
+ *
+ * Returns the number of events called.
+ *
+ * Polling is thread safe, but has different effects on different threads.
+ *
+ * Adding a new file descriptor from one thread while polling in a different
+ * thread will not poll that IO until `fio_poll_review` is called again.
+ */
+SFUNC int fio_poll_review(fio_poll_s *p, size_t timeout) {
+  struct pollfd tests[FIO_POLL_MAX_EVENTS];
+  struct {
+    void *udata;
+    unsigned short flags;
+  } fired[FIO_POLL_MAX_EVENTS];
+  size_t test_count = 0, fired_count = 0, kept = 0;
+  /* armed events might be ready, don't wait */
+  FIO___LOCK_LOCK(p->lock);
+  if (p->pending_count)
+    timeout = 0;
+  FIO___LOCK_UNLOCK(p->lock);
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  if (p->fd == -1)
+    fio___poll_uring_review(p, timeout);
+  else
+#endif
+    fio___poll_edge_epoll_review(p, timeout);
+  FIO___LOCK_LOCK(p->lock);
+  /* test armed stale events, the kernel won't report these again */
+  for (size_t i = 0; i < p->pending_count && test_count < FIO_POLL_MAX_EVENTS;
+       ++i) {
+    fio___poll_edge_fd_s *e = p->fds + p->pending[i];
+    unsigned short flags = e->armed & e->stale & ~e->ready;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+    if ((flags & POLLIN) && e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE) {
+      /* the kernel accepts connections, test for collected connections */
+      e->stale &= ~POLLIN;
+      if (e->accepted_count)
+        e->ready |= POLLIN;
+      flags &= ~POLLIN;
+    }
+#endif
+    if (!flags)
+      continue;
+    tests[test_count++] = (struct pollfd){
+        .fd = p->pending[i],
+        .events = (short)(flags | FIO___POLL_EDGE_RDHUP),
+    };
+  }
+  if (test_count) {
+    FIO___LOCK_UNLOCK(p->lock);
+    const int tested = poll(tests, (nfds_t)test_count, 0);
+    FIO___LOCK_LOCK(p->lock);
+    for (size_t i = 0; tested >= 0 && i < test_count; ++i) {
+      const int fd = tests[i].fd;
+      const unsigned short flags = fio___poll_edge_flags(
+          (uint32_t)tests[i].revents,
+          POLLIN,
+          POLLOUT,
+          (FIO___POLL_EDGE_RDHUP | POLLHUP | POLLERR | POLLNVAL));
+      if ((size_t)fd >= p->capa)
+        continue;
+      p->fds[fd].stale &= ~((unsigned short)tests[i].events);
+      p->fds[fd].ready |= flags;
+    }
+  }
+  /* fire armed ready events (one-shot), keep fds that may still have some */
+  for (size_t i = 0; i < p->pending_count; ++i) {
+    const int fd = p->pending[i];
+    fio___poll_edge_fd_s *e = p->fds + fd;
+    unsigned short flags = e->armed & e->ready;
+    if (flags && fired_count < FIO_POLL_MAX_EVENTS) {
+      if ((e->ready & POLLHUP) && (e->armed & POLLIN)) {
+        flags = POLLHUP;
+        e->armed = 0;
+      } else {
+        e->armed &= ~flags;
+        e->ready &= ~flags;
+        e->stale |= flags;
+      }
+      fired[fired_count].udata = e->udata;
+      fired[fired_count++].flags = flags;
+    }
+    if ((e->armed & (e->ready | e->stale))) {
+      p->pending[kept++] = fd;
+      continue;
+    }
+    e->pending = 0;
+  }
+  p->pending_count = kept;
+  FIO___LOCK_UNLOCK(p->lock);
+  for (size_t i = 0; i < fired_count; ++i) {
+    if ((fired[i].flags & POLLHUP)) {
+      p->settings.on_close(fired[i].udata);
+      continue;
+    }
+    if ((fired[i].flags & POLLOUT))
+      p->settings.on_ready(fired[i].udata);
+    if ((fired[i].flags & POLLIN))
+      p->settings.on_data(fired[i].udata);
+  }
+  return (int)fired_count;
+}
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO___POLL_EDGE_RDHUP
+#endif /* FIO_POLL_ENGINE_EPOLL_ET || FIO_POLL_ENGINE_IO_URING */
+/* ************************************************************************* */
 #if !defined(FIO_INCLUDE_FILE)                /* Dev test - ignore line */
 #define FIO_POLL_ENGINE FIO_POLL_ENGINE_EPOLL /* Dev */
 #define FIO___DEV___    /* Development inclusion - ignore line */
@@ -15416,6 +20767,72 @@ Queue Type(s)
 #endif
 #endif
 
+#ifndef FIO_QUEUE_LOCKFREE
+/**
+ * If true, tasks are exchanged using a lock-free (MPMC) ring buffer.
+ *
+ * The locked ring buffers are only used for urgent tasks and when the lock-free
+ * ring is full.
+ */
+#define FIO_QUEUE_LOCKFREE 0
+#endif
+
+#ifndef FIO_QUEUE_LOCKFREE_SLOTS
+/** The number of slots in the lock-free ring. Must be a power of 2. */
+#define FIO_QUEUE_LOCKFREE_SLOTS 512
+#endif
+
+#if (FIO_QUEUE_LOCKFREE_SLOTS & (FIO_QUEUE_LOCKFREE_SLOTS - 1))
+#error FIO_QUEUE_LOCKFREE_SLOTS must be a power of 2
+#endif
+
+#ifndef FIO_QUEUE_WORKER_DEQUE
+/** The number of tasks a work-stealing worker keeps locally (power of 2). */
+#define FIO_QUEUE_WORKER_DEQUE 256
+#endif
+
+#if (FIO_QUEUE_WORKER_DEQUE & (FIO_QUEUE_WORKER_DEQUE - 1))
+#error FIO_QUEUE_WORKER_DEQUE must be a power of 2
+#endif
+
+#ifndef FIO_QUEUE_BATCH
+/** The number of tasks `fio_queue_perform_batch` pops at once (on the stack). */
+#define FIO_QUEUE_BATCH 32
+#endif
+
+#ifndef FIO_QUEUE_SPIN
+/**
+ * The number of times an idle worker thread polls for new tasks (pausing the
+ * CPU between polls) before it parks (sleeps until woken). `0` == never spin.
+ *
+ * The budget adapts: it shrinks when spinning fails and resets when it works.
+ */
+#define FIO_QUEUE_SPIN 256
+#endif
+
+#ifndef FIO_QUEUE_STATS
+/**
+ * If true, queues collect statistics (see `fio_queue_stats`): the time tasks
+ * wait in the queue, the time each callback runs and the queue's depth
+ * high-water mark.
+ *
+ * Tasks are timestamped when pushed, performed and done (adds a small cost).
+ */
+#define FIO_QUEUE_STATS 0
+#endif
+
+#ifndef FIO_QUEUE_STATS_FUNCTIONS
+/** The number of callbacks a queue collects statistics for (power of 2). */
+#define FIO_QUEUE_STATS_FUNCTIONS 32
+#endif
+
+#if (FIO_QUEUE_STATS_FUNCTIONS & (FIO_QUEUE_STATS_FUNCTIONS - 1))
+#error FIO_QUEUE_STATS_FUNCTIONS must be a power of 2
+#endif
+
+/** Histogram bins: `[0]` < 1us, `[i]` < 2^i us, the last bin holds the rest. */
+#define FIO_QUEUE_STATS_BINS 24
+
 /** Task information */
 typedef struct {
   /** The function to call */
@@ -15424,8 +20841,48 @@ typedef struct {
   void *udata1;
   /** User opaque data */
   void *udata2;
+#if FIO_QUEUE_STATS
+  /** The time the task was pushed, in nanoseconds (set by the queue). */
+  int64_t queued_at;
+#endif
 } fio_queue_task_s;
 
+#if FIO_QUEUE_STATS
+/** Callback statistics (see `fio_queue_stats_s`). */
+typedef struct {
+  /** The callback (NULL for unused entries). */
+  void (*fn)(void *, void *);
+  /** The number of times the callback was performed. */
+  uint64_t count;
+  /** The callback's total run time, in nanoseconds. */
+  uint64_t total;
+  /** The callback's longest run time, in nanoseconds. */
+  uint64_t max;
+  /** Run time histogram (see `FIO_QUEUE_STATS_BINS`). */
+  uint64_t hist[FIO_QUEUE_STATS_BINS];
+} fio_queue_fn_stats_s;
+
+/** Queue statistics, collected when `FIO_QUEUE_STATS` is true. */
+typedef struct {
+  /** The number of tasks pushed to the queue. */
+  uint64_t pushed;
+  /** The number of tasks performed by the queue. */
+  uint64_t performed;
+  /** Tasks performed by callbacks that didn't fit the callback table. */
+  uint64_t untracked;
+  /** The queue's depth high-water mark (the most tasks waiting at once). */
+  uint64_t depth_max;
+  /** The total time tasks waited in the queue, in nanoseconds. */
+  uint64_t wait_total;
+  /** The longest time a task waited in the queue, in nanoseconds. */
+  uint64_t wait_max;
+  /** Wait time histogram (see `FIO_QUEUE_STATS_BINS`). */
+  uint64_t wait[FIO_QUEUE_STATS_BINS];
+  /** Per callback run time statistics (a hash table). */
+  fio_queue_fn_stats_s fn[FIO_QUEUE_STATS_FUNCTIONS];
+} fio_queue_stats_s;
+#endif
+
 /* internal use */
 typedef struct fio___task_ring_s {
   uint16_t r;   /* reader position */
@@ -15435,6 +20892,15 @@ typedef struct fio___task_ring_s {
   fio_queue_task_s buf[FIO_QUEUE_TASKS_PER_ALLOC];
 } fio___task_ring_s;
 
+#if FIO_QUEUE_LOCKFREE
+/* internal use - a lock-free ring slot */
+typedef struct {
+  /* the slot's sequence number, relative to the slot's index */
+  size_t seq;
+  fio_queue_task_s task;
+} fio___task_slot_s;
+#endif
+
 /** The queue object - should be considered opaque (or, at least, read only). */
 typedef struct {
   /** task read pointer. */
@@ -15449,6 +20915,28 @@ typedef struct {
   FIO_LIST_NODE consumers;
   /** main ring buffer associated with the queue. */
   fio___task_ring_s mem;
+  /** the number of worker threads that are parked (or about to park). */
+  volatile uint32_t idle;
+  /** wake-up sequence (futex word), incremented before waking workers. */
+  volatile uint32_t wake;
+#if FIO_QUEUE_LOCKFREE
+  /** urgent tasks waiting in the locked ring buffers. */
+  volatile uint32_t urgent;
+  /** tasks waiting in the locked ring buffers after the lock-free ring. */
+  volatile uint32_t overflow;
+  /** lock-free ring reader position (and cache line padding). */
+  size_t head;
+  char pad0_[64 - sizeof(size_t)];
+  /** lock-free ring writer position (and cache line padding). */
+  size_t tail;
+  char pad1_[64 - sizeof(size_t)];
+  /** lock-free ring slots (zero initialized). */
+  fio___task_slot_s slots[FIO_QUEUE_LOCKFREE_SLOTS];
+#endif
+#if FIO_QUEUE_STATS
+  /** task statistics. */
+  fio_queue_stats_s stats;
+#endif
 } fio_queue_s;
 
 typedef struct {
@@ -15459,8 +20947,22 @@ typedef struct {
   fio_thread_cond_t cond;
   size_t workers;
   volatile int stop;
+  /** work-stealing worker deques (NULL unless work-stealing). */
+  struct fio___queue_worker_s *deques;
 } fio___thread_group_s;
 
+/* internal use - a work-stealing worker and its local deque */
+typedef struct fio___queue_worker_s {
+  fio___thread_group_s *grp;
+  size_t index;
+  fio_lock_i lock;
+  /* thieves take the oldest task, at the top */
+  volatile uint32_t top;
+  /* the owner pushes and pops the newest task, at the bottom */
+  volatile uint32_t bottom;
+  fio_queue_task_s buf[FIO_QUEUE_WORKER_DEQUE];
+} fio___queue_worker_s;
+
 /* *****************************************************************************
 Queue API
 ***************************************************************************** */
@@ -15523,12 +21025,49 @@ SFUNC int fio_queue_perform(fio_queue_s *q);
 /** Performs all tasks in the queue. */
 SFUNC void fio_queue_perform_all(fio_queue_s *q);
 
+/**
+ * Pushes `count` tasks to the queue, acquiring the queue's lock only once.
+ *
+ * Returns the number of tasks pushed (less than `count` on error).
+ */
+SFUNC size_t fio_queue_push_many(fio_queue_s *q,
+                                 fio_queue_task_s *tasks,
+                                 size_t count);
+
+/**
+ * Pops up to `max` tasks from the queue (FIFO), acquiring the queue's lock only
+ * once.
+ *
+ * Returns the number of tasks placed in the `tasks` array.
+ */
+SFUNC size_t fio_queue_pop_many(fio_queue_s *q,
+                                fio_queue_task_s *tasks,
+                                size_t max);
+
+/**
+ * Performs up to `max` tasks from the queue, popping tasks in batches (see
+ * `FIO_QUEUE_BATCH`).
+ *
+ * Returns the number of tasks performed.
+ */
+SFUNC size_t fio_queue_perform_batch(fio_queue_s *q, size_t max);
+
 /** returns the number of tasks in the queue. */
 FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q);
 
 /** Adds worker / consumer threads to perform the jobs in the queue. */
 SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t count);
 
+/**
+ * Adds work-stealing worker threads to perform the jobs in the queue.
+ *
+ * Tasks pushed by these workers (except urgent tasks) are kept in the worker's
+ * local deque and performed LIFO. Idle workers steal tasks from other workers.
+ *
+ * Note: tasks in local deques aren't counted by `fio_queue_count`.
+ */
+SFUNC int fio_queue_workers_add_stealing(fio_queue_s *q, size_t count);
+
 /** Signals all worker threads to stop performing tasks and terminate. */
 SFUNC void fio_queue_workers_stop(fio_queue_s *q);
 
@@ -15538,15 +21077,54 @@ SFUNC void fio_queue_workers_join(fio_queue_s *q);
 /** Signals all worker threads to go back to work (new tasks added). */
 SFUNC void fio_queue_workers_wake(fio_queue_s *q);
 
+#if FIO_QUEUE_STATS
+/** Returns the queue's statistics (live counters, read only). */
+FIO_IFUNC fio_queue_stats_s *fio_queue_stats(fio_queue_s *q);
+
+/** Resets the queue's statistics (concurrent updates may be lost). */
+SFUNC void fio_queue_stats_reset(fio_queue_s *q);
+
+/**
+ * Returns the upper bound (in microseconds) of the histogram bin holding the
+ * `percentile` (0.0-1.0) sample, `(uint64_t)-1` for the last bin.
+ *
+ * Returns 0 if the histogram is empty.
+ */
+SFUNC uint64_t fio_queue_stats_percentile(const uint64_t *histogram,
+                                          double percentile);
+
+/**
+ * Prints the queue's statistics to `stderr`, busiest callbacks first.
+ *
+ * May be used as a state callback, i.e.:
+ *
+ *     fio_state_callback_add(FIO_CALL_AT_EXIT, fio_queue_stats_print, q);
+ */
+SFUNC void fio_queue_stats_print(void *q);
+#endif
+
 /* *****************************************************************************
 Timer Queue Types and API
 ***************************************************************************** */
 
 typedef struct fio___timer_event_s fio___timer_event_s;
 
+/* timing wheel levels, each level has 64 slots (covers 2^36 milliseconds) */
+#define FIO___TIMER_LEVELS 6
+
+/** A hierarchical timing wheel (millisecond resolution). */
 typedef struct {
-  fio___timer_event_s *next;
+  /** the wheel's position (the last millisecond pushed to a queue). */
+  int64_t at;
+  /** the number of scheduled events. */
+  size_t count;
   FIO___LOCK_TYPE lock;
+  /** occupied slots bitmap, per level. */
+  uint64_t map[FIO___TIMER_LEVELS];
+  /** events too far in the future for the wheel (rare). */
+  fio___timer_event_s *overflow;
+  /** event lists, per level and slot. */
+  fio___timer_event_s *slots[FIO___TIMER_LEVELS][64];
 } fio_timer_queue_s;
 
 #if FIO_USE_THREAD_MUTEX_TMP
@@ -15596,7 +21174,7 @@ SFUNC size_t fio_timer_push2queue(fio_queue_s *queue,
  * NOTE: unless manually specified, millisecond timers are relative to
  * `fio_time_milli()`.
  */
-FIO_IFUNC int64_t fio_timer_next_at(fio_timer_queue_s *timer_queue);
+SFUNC int64_t fio_timer_next_at(fio_timer_queue_s *timer_queue);
 
 /**
  * Clears any waiting timer bound tasks.
@@ -15618,6 +21196,13 @@ Queue Inline Helpers
 /** returns the number of tasks in the queue. */
 FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q) { return q->count; }
 
+#if FIO_QUEUE_STATS
+/** Returns the queue's statistics (live counters, read only). */
+FIO_IFUNC fio_queue_stats_s *fio_queue_stats(fio_queue_s *q) {
+  return &q->stats;
+}
+#endif
+
 /** Initializes a fio_queue_s object. */
 FIO_IFUNC void fio_queue_init(fio_queue_s *q) {
   /* do this manually, we don't want to reset a whole page */
@@ -15628,6 +21213,15 @@ FIO_IFUNC void fio_queue_init(fio_queue_s *q) {
   q->lock = FIO___LOCK_INIT;
   q->mem.next = NULL;
   q->mem.r = q->mem.w = q->mem.dir = 0;
+  q->idle = q->wake = 0;
+#if FIO_QUEUE_LOCKFREE
+  q->urgent = q->overflow = 0;
+  q->head = q->tail = 0;
+  FIO_MEMSET(q->slots, 0, sizeof(q->slots));
+#endif
+#if FIO_QUEUE_STATS
+  FIO_MEMSET(&q->stats, 0, sizeof(q->stats));
+#endif
 }
 
 /* *****************************************************************************
@@ -15645,36 +21239,72 @@ struct fio___timer_event_s {
   struct fio___timer_event_s *next;
 };
 
-/*
- * Returns the millisecond at which the next event should occur.
- *
- * If no timer is due (list is empty), returns `-1`.
- *
- * NOTE: unless manually specified, millisecond timers are relative to
- * `fio_time_milli()`.
- */
-FIO_IFUNC int64_t fio_timer_next_at(fio_timer_queue_s *tq) {
-  int64_t v = -1;
-  if (!tq)
-    goto missing_tq;
-  if (!tq || !tq->next)
-    return v;
-  FIO___LOCK_LOCK(tq->lock);
-  if (tq->next)
-    v = tq->next->due;
-  FIO___LOCK_UNLOCK(tq->lock);
-  return v;
-
-missing_tq:
-  FIO_LOG_ERROR("`fio_timer_next_at` called with a NULL timer queue!");
-  return v;
-}
-
 /* *****************************************************************************
 Queue Implementation
 ***************************************************************************** */
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 
+/* *****************************************************************************
+Worker Parking (futex on Linux, a condition variable elsewhere)
+***************************************************************************** */
+#if defined(__linux__)
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FIO___QUEUE_PAUSE() __asm__ volatile("pause" ::: "memory")
+#elif defined(__aarch64__)
+#define FIO___QUEUE_PAUSE() __asm__ volatile("yield" ::: "memory")
+#else
+#define FIO___QUEUE_PAUSE() FIO_COMPILER_GUARD
+#endif
+
+/* parks the calling worker unless the queue's wake sequence moved on. */
+FIO_SFUNC void fio___queue_park(fio___thread_group_s *grp, uint32_t seq) {
+#if defined(__linux__)
+  syscall(SYS_futex, &grp->queue->wake, FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+  fio_thread_mutex_lock(&grp->mutex);
+  if (grp->queue->wake == seq && !grp->stop)
+    fio_thread_cond_wait(&grp->cond, &grp->mutex);
+  fio_thread_mutex_unlock(&grp->mutex);
+#endif
+}
+
+/* wakes up to `count` parked workers (call outside the queue's lock). */
+FIO_SFUNC void fio___queue_wake(fio_queue_s *q, uint32_t count) {
+  fio_atomic_add(&q->wake, 1);
+#if defined(__linux__)
+  syscall(SYS_futex,
+          &q->wake,
+          FUTEX_WAKE_PRIVATE,
+          (count > INT_MAX ? INT_MAX : (int)count),
+          NULL,
+          NULL,
+          0);
+#else
+  FIO___LOCK_LOCK(q->lock);
+  FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
+    fio_thread_mutex_lock(&pos->mutex);
+    for (size_t i = 0; i < count && i < pos->workers; ++i)
+      fio_thread_cond_signal(&pos->cond);
+    fio_thread_mutex_unlock(&pos->mutex);
+  }
+  FIO___LOCK_UNLOCK(q->lock);
+#endif
+}
+
+/* wakes parked workers, if any (call after the new tasks were counted). */
+FIO_IFUNC void fio___queue_wake_idle(fio_queue_s *q, uint32_t count) {
+  uint32_t idle;
+  fio_atomic_load(idle, &q->idle);
+  if (idle)
+    fio___queue_wake(q, (count < idle ? count : idle));
+}
+
 /* task queue leak detection */
 FIO___LEAK_COUNTER_DEF(fio_queue)
 FIO___LEAK_COUNTER_DEF(fio_queue_task_rings)
@@ -15694,9 +21324,10 @@ SFUNC void fio_queue_destroy(fio_queue_s *q) {
     }
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       pos->stop = 1;
-      for (size_t i = 0; i < pos->workers; ++i)
-        fio_thread_cond_signal(&pos->cond);
     }
+    FIO___LOCK_UNLOCK(q->lock);
+    fio___queue_wake(q, (uint32_t)-1);
+    FIO___LOCK_LOCK(q->lock);
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       FIO___LOCK_UNLOCK(q->lock);
       fio_thread_join(&pos->thread);
@@ -15771,12 +21402,334 @@ FIO_IFUNC fio_queue_task_s fio___task_ring_pop(fio___task_ring_s *r) {
   return t;
 }
 
-int fio_queue_push___(void); /* sublime text marker */
-/** Pushes a task to the queue. Returns -1 on error. */
-SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
-  if (!task.fn)
+#if FIO_QUEUE_LOCKFREE
+/* *****************************************************************************
+Lock-Free Ring (MPMC, sequence numbered slots)
+
+Slot sequence numbers are stored relative to the slot's index, so a zeroed ring
+is a valid (empty) ring and FIO_QUEUE_STATIC_INIT still works.
+***************************************************************************** */
+
+#define FIO___QUEUE_LAP(pos) ((pos) & (~(size_t)(FIO_QUEUE_LOCKFREE_SLOTS - 1)))
+
+FIO_IFUNC int fio___queue_ring_push(fio_queue_s *q, fio_queue_task_s task) {
+  fio___task_slot_s *slot;
+  size_t pos, seq, next;
+  fio_atomic_load(pos, &q->tail);
+  for (;;) {
+    slot = q->slots + (pos & (FIO_QUEUE_LOCKFREE_SLOTS - 1));
+    fio_atomic_load(seq, &slot->seq);
+    intptr_t dif = (intptr_t)(seq - FIO___QUEUE_LAP(pos));
+    if (!dif) {
+      next = pos + 1;
+      if (fio_atomic_compare_exchange_p(&q->tail, &pos, &next))
+        break;
+      continue; /* `pos` was updated */
+    }
+    if (dif < 0)
+      return -1; /* ring is full */
+    fio_atomic_load(pos, &q->tail);
+  }
+  slot->task = task;
+  fio_atomic_exchange(&slot->seq, FIO___QUEUE_LAP(pos) + 1);
+  return 0;
+}
+
+FIO_IFUNC fio_queue_task_s fio___queue_ring_pop(fio_queue_s *q) {
+  fio_queue_task_s t = {.fn = NULL};
+  fio___task_slot_s *slot;
+  size_t pos, seq, next;
+  fio_atomic_load(pos, &q->head);
+  for (;;) {
+    slot = q->slots + (pos & (FIO_QUEUE_LOCKFREE_SLOTS - 1));
+    fio_atomic_load(seq, &slot->seq);
+    intptr_t dif = (intptr_t)(seq - (FIO___QUEUE_LAP(pos) + 1));
+    if (!dif) {
+      next = pos + 1;
+      if (fio_atomic_compare_exchange_p(&q->head, &pos, &next))
+        break;
+      continue; /* `pos` was updated */
+    }
+    if (dif < 0)
+      return t; /* ring is empty */
+    fio_atomic_load(pos, &q->head);
+  }
+  t = slot->task;
+  fio_atomic_exchange(&slot->seq,
+                      FIO___QUEUE_LAP(pos) + FIO_QUEUE_LOCKFREE_SLOTS);
+  return t;
+}
+
+#undef FIO___QUEUE_LAP
+
+/* counts a task added to the locked ring buffers (call within the lock). */
+FIO_IFUNC void fio___queue_count_add(fio_queue_s *q, int urgent) {
+  if (urgent)
+    ++q->urgent;
+  else
+    ++q->overflow;
+  fio_atomic_add(&q->count, 1);
+}
+
+/* counts a task taken from the locked ring buffers, returns remaining. */
+FIO_IFUNC uint32_t fio___queue_count_sub(fio_queue_s *q) {
+  if (q->urgent)
+    --q->urgent;
+  else
+    --q->overflow;
+  fio_atomic_sub(&q->count, 1);
+  return q->urgent + q->overflow;
+}
+
+#else /* FIO_QUEUE_LOCKFREE */
+
+/* the atomic operation orders the count before testing for idle workers. */
+FIO_IFUNC void fio___queue_count_add(fio_queue_s *q, int urgent) {
+  fio_atomic_add(&q->count, 1);
+  (void)urgent;
+}
+
+FIO_IFUNC uint32_t fio___queue_count_sub(fio_queue_s *q) { return --q->count; }
+#endif /* FIO_QUEUE_LOCKFREE */
+
+/* *****************************************************************************
+Queue Statistics
+***************************************************************************** */
+
+FIO_SFUNC void fio___timer_perform(void *timer_, void *t_);
+
+#if FIO_QUEUE_STATS
+
+/* timestamps a task as it's pushed */
+#define FIO___QUEUE_STATS_STAMP(task) ((task).queued_at = fio_time_nano())
+/* counts pushed tasks */
+#define FIO___QUEUE_STATS_PUSH(q, n) fio___queue_stats_push((q), (n))
+
+/* the histogram bin for a duration in nanoseconds. */
+FIO_IFUNC size_t fio___queue_stats_bin(uint64_t ns) {
+  const uint64_t us = ns / 1000;
+  const size_t bin = us ? fio_bits_msb_index(us) + 1 : 0;
+  return bin < FIO_QUEUE_STATS_BINS ? bin : FIO_QUEUE_STATS_BINS - 1;
+}
+
+/* sets `*dest` to `value` if `value` is bigger. */
+FIO_IFUNC void fio___queue_stats_max(uint64_t *dest, uint64_t value) {
+  uint64_t old;
+  for (;;) {
+    fio_atomic_load(old, dest);
+    if (old >= value || fio_atomic_compare_exchange_p(dest, &old, &value))
+      return;
+  }
+}
+
+/* counts pushed tasks and updates the queue's depth high-water mark. */
+FIO_IFUNC void fio___queue_stats_push(fio_queue_s *q, size_t count) {
+  uint32_t depth;
+  if (!count)
+    return;
+  fio_atomic_add(&q->stats.pushed, (uint64_t)count);
+  fio_atomic_load(depth, &q->count);
+  fio___queue_stats_max(&q->stats.depth_max, (uint64_t)depth);
+}
+
+/* finds (or adds) a callback's entry, returns NULL if the table is full. */
+FIO_IFUNC fio_queue_fn_stats_s *fio___queue_stats_fn(
+    fio_queue_s *q,
+    void (*fn)(void *, void *)) {
+  const size_t mask = FIO_QUEUE_STATS_FUNCTIONS - 1;
+  const size_t pos =
+      (size_t)(((uint64_t)(uintptr_t)fn * 0x9E3779B97F4A7C15ULL) >> 32);
+  for (size_t i = 0; i < FIO_QUEUE_STATS_FUNCTIONS; ++i) {
+    fio_queue_fn_stats_s *e = q->stats.fn + ((pos + i) & mask);
+    void (*existing)(void *, void *);
+    fio_atomic_load(existing, &e->fn);
+    if (!existing) {
+      fio_atomic_compare_exchange_p(&e->fn, &existing, &fn);
+      fio_atomic_load(existing, &e->fn);
+    }
+    if (existing == fn)
+      return e;
+  }
+  return NULL;
+}
+
+/* records a task's wait time (before it's performed). */
+FIO_IFUNC void fio___queue_stats_wait(fio_queue_s *q, uint64_t ns) {
+  fio_atomic_add(&q->stats.wait_total, ns);
+  fio_atomic_add(q->stats.wait + fio___queue_stats_bin(ns), 1);
+  fio___queue_stats_max(&q->stats.wait_max, ns);
+}
+
+/* records a callback's run time. */
+FIO_SFUNC void fio___queue_stats_run(fio_queue_s *q,
+                                     void (*fn)(void *, void *),
+                                     uint64_t ns) {
+  fio_queue_fn_stats_s *e = fio___queue_stats_fn(q, fn);
+  fio_atomic_add(&q->stats.performed, 1);
+  if (!e) {
+    fio_atomic_add(&q->stats.untracked, 1);
+    return;
+  }
+  fio_atomic_add(&e->count, 1);
+  fio_atomic_add(&e->total, ns);
+  fio_atomic_add(e->hist + fio___queue_stats_bin(ns), 1);
+  fio___queue_stats_max(&e->max, ns);
+}
+
+/* performs a task, recording its wait time and its callback's run time. */
+FIO_IFUNC void fio___queue_task_perform(fio_queue_s *q, fio_queue_task_s t) {
+  const int64_t start = fio_time_nano();
+  void (*fn)(void *, void *) = t.fn;
+  /* timer tasks are recorded using the timer's callback */
+  if (fn == fio___timer_perform)
+    fn = (void (*)(void *, void *))(uintptr_t)(
+        (fio___timer_event_s *)t.udata2)->fn;
+  fio___queue_stats_wait(q,
+                         (uint64_t)(start > t.queued_at ? start - t.queued_at
+                                                        : 0));
+  t.fn(t.udata1, t.udata2);
+  fio___queue_stats_run(q, fn, (uint64_t)(fio_time_nano() - start));
+}
+
+/** Resets the queue's statistics (concurrent updates may be lost). */
+SFUNC void fio_queue_stats_reset(fio_queue_s *q) {
+  FIO_MEMSET(&q->stats, 0, sizeof(q->stats));
+}
+
+/** Returns the upper bound (in microseconds) of a percentile's bin. */
+SFUNC uint64_t fio_queue_stats_percentile(const uint64_t *histogram,
+                                          double percentile) {
+  uint64_t total = 0, seen = 0;
+  for (size_t i = 0; i < FIO_QUEUE_STATS_BINS; ++i)
+    total += histogram[i];
+  if (!total)
     return 0;
-  FIO___LOCK_LOCK(q->lock);
+  const uint64_t target = (uint64_t)(percentile * (double)total);
+  for (size_t i = 0; i < FIO_QUEUE_STATS_BINS - 1; ++i) {
+    seen += histogram[i];
+    if (seen > target || seen == total)
+      return (uint64_t)1 << i;
+  }
+  return (uint64_t)-1;
+}
+
+/** Prints the queue's statistics to `stderr`, busiest callbacks first. */
+SFUNC void fio_queue_stats_print(void *q_) {
+  fio_queue_s *q = (fio_queue_s *)q_;
+  fio_queue_stats_s *st = &q->stats;
+  fio_queue_fn_stats_s *order[FIO_QUEUE_STATS_FUNCTIONS];
+  size_t count = 0;
+  /* order callbacks by their total run time (insertion sort) */
+  for (size_t i = 0; i < FIO_QUEUE_STATS_FUNCTIONS; ++i) {
+    size_t pos = count;
+    if (!st->fn[i].fn)
+      continue;
+    for (; pos && order[pos - 1]->total < st->fn[i].total; --pos)
+      order[pos] = order[pos - 1];
+    order[pos] = st->fn + i;
+    ++count;
+  }
+  fprintf(stderr,
+          "Queue %p statistics:\n"
+          "\t* tasks: %llu pushed, %llu performed (%llu untracked)\n"
+          "\t* depth high-water mark: %llu\n"
+          "\t* wait: avg %llu us, p50 < %llu us, p99 < %llu us, max %llu us\n",
+          q_,
+          (unsigned long long)st->pushed,
+          (unsigned long long)st->performed,
+          (unsigned long long)st->untracked,
+          (unsigned long long)st->depth_max,
+          (unsigned long long)(st->performed
+                                   ? st->wait_total / st->performed / 1000
+                                   : 0),
+          (unsigned long long)fio_queue_stats_percentile(st->wait, 0.5),
+          (unsigned long long)fio_queue_stats_percentile(st->wait, 0.99),
+          (unsigned long long)(st->wait_max / 1000));
+  for (size_t i = 0; i < count; ++i) {
+    fprintf(stderr,
+            "\t* callback %p: %llu tasks, %llu us total, avg %llu us, "
+            "p99 < %llu us, max %llu us\n",
+            (void *)(uintptr_t)order[i]->fn,
+            (unsigned long long)order[i]->count,
+            (unsigned long long)(order[i]->total / 1000),
+            (unsigned long long)(order[i]->count
+                                     ? order[i]->total / order[i]->count / 1000
+                                     : 0),
+            (unsigned long long)fio_queue_stats_percentile(order[i]->hist,
+                                                           0.99),
+            (unsigned long long)(order[i]->max / 1000));
+  }
+}
+
+#else /* FIO_QUEUE_STATS */
+
+#define FIO___QUEUE_STATS_STAMP(task) ((void)0)
+#define FIO___QUEUE_STATS_PUSH(q, n)  ((void)(n))
+
+/* performs a task. */
+FIO_IFUNC void fio___queue_task_perform(fio_queue_s *q, fio_queue_task_s t) {
+  t.fn(t.udata1, t.udata2);
+  (void)q;
+}
+#endif /* FIO_QUEUE_STATS */
+
+/* *****************************************************************************
+Work-Stealing Worker Deques
+***************************************************************************** */
+
+/* the work-stealing worker running on the current thread (if any) */
+static __thread fio___queue_worker_s *fio___queue_worker_current;
+
+/* pushes a task to the bottom of the worker's deque (owner only). */
+FIO_IFUNC int fio___queue_worker_push(fio___queue_worker_s *w,
+                                      fio_queue_task_s task) {
+  uint32_t count;
+  fio_lock(&w->lock);
+  count = w->bottom - w->top;
+  if (count == FIO_QUEUE_WORKER_DEQUE) {
+    fio_unlock(&w->lock);
+    return -1;
+  }
+  w->buf[w->bottom & (FIO_QUEUE_WORKER_DEQUE - 1)] = task;
+  /* the atomic operation orders the task before testing for idle workers */
+  fio_atomic_add(&w->bottom, 1);
+  fio_unlock(&w->lock);
+  /* wake an idle worker whenever the surplus doubles (2, 4, 8... tasks) */
+  if (!count || (count & (count + 1)))
+    return 0;
+  fio___queue_wake_idle(w->grp->queue, 1);
+  return 0;
+}
+
+/* pops the newest task from the bottom of the worker's deque (owner only). */
+FIO_IFUNC fio_queue_task_s fio___queue_worker_pop(fio___queue_worker_s *w) {
+  fio_queue_task_s t = {.fn = NULL};
+  if (w->bottom == w->top)
+    return t;
+  fio_lock(&w->lock);
+  if (w->bottom != w->top) {
+    --w->bottom;
+    t = w->buf[w->bottom & (FIO_QUEUE_WORKER_DEQUE - 1)];
+  }
+  fio_unlock(&w->lock);
+  return t;
+}
+
+/* steals the oldest task from the top of a worker's deque. */
+FIO_IFUNC fio_queue_task_s fio___queue_worker_steal(fio___queue_worker_s *w) {
+  fio_queue_task_s t = {.fn = NULL};
+  if (w->bottom == w->top || fio_trylock(&w->lock))
+    return t;
+  if (w->bottom != w->top) {
+    t = w->buf[w->top & (FIO_QUEUE_WORKER_DEQUE - 1)];
+    ++w->top;
+  }
+  fio_unlock(&w->lock);
+  return t;
+}
+
+/* pushes a task to the locked ring buffers (call within the lock). */
+FIO_IFUNC int fio___queue_push_locked(fio_queue_s *q, fio_queue_task_s task) {
   if (fio___task_ring_push(q->w, task)) {
     if (q->w != &q->mem && q->mem.next == NULL) {
       q->w->next = &q->mem;
@@ -15785,7 +21738,7 @@ SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
       void *tmp = (fio___task_ring_s *)
           FIO_MEM_REALLOC_(NULL, 0, sizeof(*q->w->next), 0);
       if (!tmp)
-        goto no_mem;
+        return -1;
       FIO___LEAK_COUNTER_ON_ALLOC(fio_queue_task_rings);
       q->w->next = (fio___task_ring_s *)tmp;
       if (!FIO_MEM_REALLOC_IS_SAFE_) {
@@ -15797,13 +21750,38 @@ SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
     q->w = q->w->next;
     fio___task_ring_push(q->w, task);
   }
-  ++q->count;
-  if (!FIO_LIST_IS_EMPTY(&q->consumers)) {
-    FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
-      fio_thread_cond_signal(&pos->cond);
-    }
+  fio___queue_count_add(q, 0);
+  return 0;
+}
+
+int fio_queue_push___(void); /* sublime text marker */
+/** Pushes a task to the queue. Returns -1 on error. */
+SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
+  if (!task.fn)
+    return 0;
+  FIO___QUEUE_STATS_STAMP(task);
+  /* tasks pushed by a work-stealing worker stay local (unless it's full) */
+  if (fio___queue_worker_current &&
+      fio___queue_worker_current->grp->queue == q &&
+      !fio___queue_worker_push(fio___queue_worker_current, task)) {
+    FIO___QUEUE_STATS_PUSH(q, 1);
+    return 0;
+  }
+#if FIO_QUEUE_LOCKFREE
+  /* tasks overflow to the locked ring buffers only when the ring is full */
+  if (!q->overflow && !fio___queue_ring_push(q, task)) {
+    fio_atomic_add(&q->count, 1);
+    FIO___QUEUE_STATS_PUSH(q, 1);
+    fio___queue_wake_idle(q, 1);
+    return 0;
   }
+#endif
+  FIO___LOCK_LOCK(q->lock);
+  if (fio___queue_push_locked(q, task))
+    goto no_mem;
   FIO___LOCK_UNLOCK(q->lock);
+  FIO___QUEUE_STATS_PUSH(q, 1);
+  fio___queue_wake_idle(q, 1);
   return 0;
 no_mem:
   FIO___LOCK_UNLOCK(q->lock);
@@ -15812,12 +21790,74 @@ no_mem:
   return -1;
 }
 
+/**
+ * Pushes `count` tasks to the queue, acquiring the queue's lock only once.
+ *
+ * Returns the number of tasks pushed (less than `count` on error).
+ */
+SFUNC size_t fio_queue_push_many(fio_queue_s *q,
+                                 fio_queue_task_s *tasks,
+                                 size_t count) {
+  size_t i = 0;
+  if (!count)
+    return 0;
+  /* work-stealing workers keep their tasks local */
+  if (fio___queue_worker_current &&
+      fio___queue_worker_current->grp->queue == q) {
+    for (; i < count; ++i)
+      if (fio_queue_push FIO_NOOP(q, tasks[i]))
+        break;
+    return i;
+  }
+#if FIO_QUEUE_STATS
+  {
+    const int64_t now = fio_time_nano();
+    for (size_t j = 0; j < count; ++j)
+      tasks[j].queued_at = now;
+  }
+#endif
+#if FIO_QUEUE_LOCKFREE
+  if (!q->overflow) {
+    size_t added = 0;
+    for (; i < count; ++i) {
+      if (!tasks[i].fn)
+        continue;
+      if (fio___queue_ring_push(q, tasks[i]))
+        break;
+      ++added;
+    }
+    if (added)
+      fio_atomic_add(&q->count, (uint32_t)added);
+    FIO___QUEUE_STATS_PUSH(q, added);
+    if (i == count) {
+      fio___queue_wake_idle(q, (uint32_t)added);
+      return i;
+    }
+  }
+#endif
+  const size_t first = i;
+  FIO___LOCK_LOCK(q->lock);
+  for (; i < count; ++i) {
+    if (tasks[i].fn && fio___queue_push_locked(q, tasks[i]))
+      break;
+  }
+  FIO___LOCK_UNLOCK(q->lock);
+  FIO___QUEUE_STATS_PUSH(q, i - first);
+  /* wake (up to) as many parked workers as there are new tasks */
+  fio___queue_wake_idle(q, (uint32_t)i);
+  if (i < count)
+    FIO_LOG_ERROR("No memory for Queue %p to increase task ring buffer.",
+                  (void *)q);
+  return i;
+}
+
 int fio_queue_push_urgent___(void); /* IDE marker */
 /** Pushes a task to the head of the queue. Returns -1 on error (no memory). */
 SFUNC int fio_queue_push_urgent FIO_NOOP(fio_queue_s *q,
                                          fio_queue_task_s task) {
   if (!task.fn)
     return 0;
+  FIO___QUEUE_STATS_STAMP(task);
   FIO___LOCK_LOCK(q->lock);
   if (fio___task_ring_unpop(q->r, task)) {
     /* such a shame... but we must allocate a while task block for one task */
@@ -15832,13 +21872,10 @@ SFUNC int fio_queue_push_urgent FIO_NOOP(fio_queue_s *q,
     tmp->dir = tmp->r = 0;
     tmp->buf[0] = task;
   }
-  ++q->count;
-  if (!FIO_LIST_IS_EMPTY(&q->consumers)) {
-    FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
-      fio_thread_cond_signal(&pos->cond);
-    }
-  }
+  fio___queue_count_add(q, 1);
   FIO___LOCK_UNLOCK(q->lock);
+  FIO___QUEUE_STATS_PUSH(q, 1);
+  fio___queue_wake_idle(q, 1);
   return 0;
 no_mem:
   FIO___LOCK_UNLOCK(q->lock);
@@ -15847,37 +21884,92 @@ no_mem:
   return -1;
 }
 
+/*
+ * Pops a task from the locked ring buffers (call within the lock).
+ *
+ * Task rings that are no longer used are added to the `to_free` list.
+ */
+FIO_IFUNC fio_queue_task_s fio___queue_pop_locked(fio_queue_s *q,
+                                                  fio___task_ring_s **to_free) {
+  fio_queue_task_s t;
+  if (!(t = fio___task_ring_pop(q->r)).fn) {
+    fio___task_ring_s *done = q->r;
+    q->r = done->next;
+    done->next = NULL;
+    if (done != &q->mem) {
+      done->next = *to_free;
+      *to_free = done;
+    }
+    t = fio___task_ring_pop(q->r);
+  }
+  if (t.fn && !fio___queue_count_sub(q) && q->r != &q->mem) {
+    q->r->next = *to_free;
+    *to_free = q->r;
+    q->r = q->w = &q->mem;
+    q->mem.w = q->mem.r = q->mem.dir = 0;
+  }
+  return t;
+}
+
 /** Pops a task from the queue (FIFO). Returns a NULL task on error. */
 SFUNC fio_queue_task_s fio_queue_pop(fio_queue_s *q) {
   fio_queue_task_s t = {.fn = NULL};
+  fio_queue_pop_many(q, &t, 1);
+  return t;
+}
+
+/**
+ * Pops up to `max` tasks from the queue (FIFO), acquiring the queue's lock only
+ * once.
+ *
+ * Returns the number of tasks placed in the `tasks` array.
+ */
+SFUNC size_t fio_queue_pop_many(fio_queue_s *q,
+                                fio_queue_task_s *tasks,
+                                size_t max) {
+  size_t i = 0;
   fio___task_ring_s *to_free = NULL;
-  if (!q->count)
-    return t;
-  FIO___LOCK_LOCK(q->lock);
-  if (!q->count)
-    goto finish;
-  if (!(t = fio___task_ring_pop(q->r)).fn) {
-    to_free = q->r;
-    q->r = to_free->next;
-    to_free->next = NULL;
-    t = fio___task_ring_pop(q->r);
+  if (!q->count || !max)
+    return 0;
+#if FIO_QUEUE_LOCKFREE
+  if (!q->urgent) {
+    while (i < max && (tasks[i] = fio___queue_ring_pop(q)).fn)
+      ++i;
+    if (i)
+      fio_atomic_sub(&q->count, (uint32_t)i);
+    if (i == max || !q->overflow)
+      return i;
   }
-  if (t.fn && !(--q->count) && q->r != &q->mem) {
-    if (to_free && to_free != &q->mem) { // edge case
-      FIO___LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
-      FIO_MEM_FREE_(to_free, sizeof(*to_free));
+#endif
+  FIO___LOCK_LOCK(q->lock);
+  while (i < max) {
+#if FIO_QUEUE_LOCKFREE
+    if (!q->urgent) {
+      /* overflow tasks were pushed after the tasks in the lock-free ring */
+      if ((tasks[i] = fio___queue_ring_pop(q)).fn) {
+        fio_atomic_sub(&q->count, 1);
+        ++i;
+        continue;
+      }
+      if (!q->overflow)
+        break;
     }
-    to_free = q->r;
-    q->r = q->w = &q->mem;
-    q->mem.w = q->mem.r = q->mem.dir = 0;
+#else
+    if (!q->count)
+      break;
+#endif
+    if (!(tasks[i] = fio___queue_pop_locked(q, &to_free)).fn)
+      break;
+    ++i;
   }
-finish:
   FIO___LOCK_UNLOCK(q->lock);
-  if (to_free && to_free != &q->mem) {
+  while (to_free) {
+    fio___task_ring_s *tmp = to_free;
+    to_free = to_free->next;
     FIO___LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
-    FIO_MEM_FREE_(to_free, sizeof(*to_free));
+    FIO_MEM_FREE_(tmp, sizeof(*tmp));
   }
-  return t;
+  return i;
 }
 
 /** Performs a task from the queue. Returns -1 on error (queue empty). */
@@ -15885,7 +21977,7 @@ SFUNC int fio_queue_perform(fio_queue_s *q) {
   fio_queue_task_s t = fio_queue_pop(q);
   if (!t.fn)
     return -1;
-  t.fn(t.udata1, t.udata2);
+  fio___queue_task_perform(q, t);
   return 0;
 }
 
@@ -15893,25 +21985,116 @@ SFUNC int fio_queue_perform(fio_queue_s *q) {
 SFUNC void fio_queue_perform_all(fio_queue_s *q) {
   fio_queue_task_s t;
   while ((t = fio_queue_pop(q)).fn)
-    t.fn(t.udata1, t.udata2);
+    fio___queue_task_perform(q, t);
+}
+
+/** Performs up to `max` tasks from the queue, popping tasks in batches. */
+SFUNC size_t fio_queue_perform_batch(fio_queue_s *q, size_t max) {
+  fio_queue_task_s tasks[FIO_QUEUE_BATCH];
+  size_t r = 0;
+  while (r < max) {
+    const size_t limit = (max - r) > FIO_QUEUE_BATCH ? FIO_QUEUE_BATCH : max - r;
+    const size_t count = fio_queue_pop_many(q, tasks, limit);
+    for (size_t i = 0; i < count; ++i)
+      fio___queue_task_perform(q, tasks[i]);
+    r += count;
+    if (count < limit)
+      break;
+  }
+  return r;
 }
 
 /* *****************************************************************************
 Queue Consumer Threads
 ***************************************************************************** */
 
+/* returns true if any of the group's worker deques has tasks. */
+FIO_SFUNC int fio___queue_worker_stealable(fio___thread_group_s *grp) {
+  for (size_t i = 0; i < grp->workers; ++i) {
+    if (grp->deques[i].bottom != grp->deques[i].top)
+      return 1;
+  }
+  return 0;
+}
+
+/* returns true if the group's workers have tasks to perform (or should stop) */
+FIO_IFUNC int fio___queue_worker_has_tasks(fio___thread_group_s *grp) {
+  uint32_t count;
+  fio_atomic_load(count, &grp->queue->count);
+  return grp->stop || count ||
+         (grp->deques && fio___queue_worker_stealable(grp));
+}
+
+/*
+ * Waits for new tasks: spins (up to `*spin` times), then parks.
+ *
+ * The spin budget resets when spinning finds a task and halves when it doesn't,
+ * so workers stop spinning when tasks arrive slower than the spin lasts.
+ */
+FIO_SFUNC void fio___queue_worker_idle(fio___thread_group_s *grp,
+                                       size_t *spin) {
+  uint32_t seq;
+  for (size_t i = 0; i < *spin; ++i) {
+    FIO___QUEUE_PAUSE();
+    if (fio___queue_worker_has_tasks(grp)) {
+      *spin = FIO_QUEUE_SPIN;
+      return;
+    }
+  }
+  const size_t spin_min = (FIO_QUEUE_SPIN >> 4);
+  *spin >>= 1;
+  if (*spin < spin_min)
+    *spin = spin_min;
+  /* producers test `idle` after the task was counted (no lost wake-ups) */
+  fio_atomic_load(seq, &grp->queue->wake);
+  fio_atomic_add(&grp->queue->idle, 1);
+  if (!fio___queue_worker_has_tasks(grp))
+    fio___queue_park(grp, seq);
+  fio_atomic_sub(&grp->queue->idle, 1);
+}
+
 FIO_SFUNC void *fio___queue_worker_task(void *g_) {
   fio___thread_group_s *grp = (fio___thread_group_s *)g_;
+  size_t spin = FIO_QUEUE_SPIN;
   while (!grp->stop) {
     fio_queue_perform_all(grp->queue);
-    fio_thread_mutex_lock(&grp->mutex);
-    if (!grp->stop)
-      fio_thread_cond_wait(&grp->cond, &grp->mutex);
-    fio_thread_mutex_unlock(&grp->mutex);
-    fio_queue_perform_all(grp->queue);
+    fio___queue_worker_idle(grp, &spin);
+  }
+  return NULL;
+}
+
+/* the next task: local (LIFO), then the shared queue, then stolen (FIFO). */
+FIO_SFUNC fio_queue_task_s fio___queue_worker_next(fio___queue_worker_s *w) {
+  fio___thread_group_s *grp = w->grp;
+  fio_queue_task_s t = fio___queue_worker_pop(w);
+  if (t.fn)
+    return t;
+  t = fio_queue_pop(grp->queue);
+  for (size_t i = 1; !t.fn && i < grp->workers; ++i)
+    t = fio___queue_worker_steal(grp->deques + ((w->index + i) % grp->workers));
+  return t;
+}
+
+FIO_SFUNC void *fio___queue_worker_steal_task(void *w_) {
+  fio___queue_worker_s *w = (fio___queue_worker_s *)w_;
+  fio___thread_group_s *grp = w->grp;
+  fio_queue_task_s t;
+  size_t spin = FIO_QUEUE_SPIN;
+  fio___queue_worker_current = w;
+  while (!grp->stop) {
+    if ((t = fio___queue_worker_next(w)).fn) {
+      fio___queue_task_perform(grp->queue, t);
+      continue;
+    }
+    fio___queue_worker_idle(grp, &spin);
   }
+  /* local tasks are never lost (these may push more local tasks) */
+  while ((t = fio___queue_worker_pop(w)).fn)
+    fio___queue_task_perform(grp->queue, t);
+  fio___queue_worker_current = NULL;
   return NULL;
 }
+
 FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   fio_thread_t threads_buf[256];
   fio___thread_group_s grp = *(fio___thread_group_s *)g_;
@@ -15924,7 +22107,21 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
           : threads_buf;
   fio_thread_mutex_init(&grp.mutex);
   fio_thread_cond_init(&grp.cond);
+  if (grp.deques) {
+    grp.deques = (fio___queue_worker_s *)
+        FIO_MEM_REALLOC_(NULL, 0, sizeof(*grp.deques) * grp.workers, 0);
+    if (!grp.deques)
+      FIO_LOG_ERROR("No memory for work-stealing deques, using a shared queue");
+    for (size_t i = 0; grp.deques && i < grp.workers; ++i)
+      grp.deques[i] = (fio___queue_worker_s){.grp = &grp, .index = i};
+  }
   for (size_t i = 0; i < grp.workers; ++i) {
+    if (grp.deques) {
+      fio_thread_create(threads + i,
+                        fio___queue_worker_steal_task,
+                        (void *)(grp.deques + i));
+      continue;
+    }
     fio_thread_create(threads + i, fio___queue_worker_task, (void *)&grp);
   }
   ((fio___thread_group_s *)g_)->stop = 0;
@@ -15934,6 +22131,8 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   }
   if (threads != threads_buf)
     FIO_MEM_FREE_(threads, sizeof(*threads) * grp.workers);
+  if (grp.deques)
+    FIO_MEM_FREE_(grp.deques, sizeof(*grp.deques) * grp.workers);
   FIO___LOCK_LOCK(grp.queue->lock);
   FIO_LIST_REMOVE(&grp.node);
   FIO___LOCK_UNLOCK(grp.queue->lock);
@@ -15941,41 +22140,51 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   return NULL;
 }
 
-SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
+FIO_SFUNC int fio___queue_workers_add(fio_queue_s *q,
+                                      size_t workers,
+                                      int stealing) {
   FIO___LOCK_LOCK(q->lock);
   if (!q->consumers.next || !q->consumers.prev) {
     q->consumers = FIO_LIST_INIT(q->consumers);
   }
   fio___thread_group_s grp = {.queue = q, .workers = workers, .stop = 1};
-  if (fio_thread_create(&grp.thread, fio___queue_worker_manager, &grp))
+  /* a non-NULL value marks the group, the manager allocates the deques */
+  if (stealing)
+    grp.deques = (fio___queue_worker_s *)&grp;
+  if (fio_thread_create(&grp.thread, fio___queue_worker_manager, &grp)) {
+    FIO___LOCK_UNLOCK(q->lock);
     return -1;
+  }
   while (grp.stop)
     FIO_THREAD_RESCHEDULE();
   FIO___LOCK_UNLOCK(q->lock);
   return 0;
 }
 
+SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
+  return fio___queue_workers_add(q, workers, 0);
+}
+
+SFUNC int fio_queue_workers_add_stealing(fio_queue_s *q, size_t workers) {
+  return fio___queue_workers_add(q, workers, 1);
+}
+
 SFUNC void fio_queue_workers_stop(fio_queue_s *q) {
   if (FIO_LIST_IS_EMPTY(&q->consumers))
     return;
   FIO___LOCK_LOCK(q->lock);
   FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
     pos->stop = 1;
-    for (size_t i = 0; i < pos->workers * 2; ++i)
-      fio_thread_cond_signal(&pos->cond);
   }
   FIO___LOCK_UNLOCK(q->lock);
+  fio___queue_wake(q, (uint32_t)-1);
 }
 
 /** Signals all worker threads to go back to work (new tasks were). */
 SFUNC void fio_queue_workers_wake(fio_queue_s *q) {
   if (FIO_LIST_IS_EMPTY(&q->consumers))
     return;
-  FIO___LOCK_LOCK(q->lock);
-  FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
-    fio_thread_cond_signal(&pos->cond);
-  }
-  FIO___LOCK_UNLOCK(q->lock);
+  fio___queue_wake(q, (uint32_t)-1);
 }
 
 /** Signals all worker threads to stop, waiting for them to complete. */
@@ -15995,27 +22204,90 @@ Timer Queue Implementation
 ***************************************************************************** */
 FIO___LEAK_COUNTER_DEF(fio___timer_event_s)
 
-FIO_IFUNC void fio___timer_insert(fio___timer_event_s **pos,
-                                  fio___timer_event_s *e) {
-  while (*pos && e->due >= (*pos)->due)
-    pos = &((*pos)->next);
-  e->next = *pos;
-  *pos = e;
+#if FIO_USE_POOL
+/* timer events are allocated from an object pool */
+FIO___POOL_DEF(fio___timer_pool, sizeof(fio___timer_event_s), 32)
+#endif
+
+/* *****************************************************************************
+Hierarchical Timing Wheel
+
+Level `n` slots hold events whose due time shares all bits above bit `6n + 6`
+with the wheel's position (`at`), indexed by bits `6n` to `6n + 5` of the due
+time. Overdue events are placed in the current level 0 slot.
+
+When the wheel's position enters a slot of a higher level, its events are
+cascaded (re-added) to lower levels. Insertion and cascading are O(1) per event.
+***************************************************************************** */
+
+/* adds an event to the wheel (call within the lock). */
+FIO_IFUNC void fio___timer_add(fio_timer_queue_s *tq, fio___timer_event_s *e) {
+  uint64_t due = (uint64_t)(e->due < tq->at ? tq->at : e->due);
+  uint64_t dif = due ^ (uint64_t)tq->at;
+  size_t level = dif ? (fio_msb_index_unsafe(dif) / 6) : 0;
+  if (level >= FIO___TIMER_LEVELS) {
+    e->next = tq->overflow;
+    tq->overflow = e;
+    return;
+  }
+  const size_t slot = (size_t)(due >> (level * 6)) & 63;
+  e->next = tq->slots[level][slot];
+  tq->slots[level][slot] = e;
+  tq->map[level] |= (uint64_t)1 << slot;
 }
 
-FIO_IFUNC fio___timer_event_s *fio___timer_pop(fio___timer_event_s **pos,
-                                               int64_t due) {
-  if (!*pos || (*pos)->due > due)
-    return NULL;
-  fio___timer_event_s *t = *pos;
-  *pos = t->next;
-  return t;
+/* detaches the events in a slot (call within the lock). */
+FIO_IFUNC fio___timer_event_s *fio___timer_take(fio_timer_queue_s *tq,
+                                                size_t level,
+                                                size_t slot) {
+  fio___timer_event_s *list = tq->slots[level][slot];
+  tq->slots[level][slot] = NULL;
+  tq->map[level] &= ~((uint64_t)1 << slot);
+  return list;
+}
+
+/* re-adds a list of events (call within the lock). */
+FIO_IFUNC void fio___timer_readd(fio_timer_queue_s *tq,
+                                 fio___timer_event_s *list) {
+  while (list) {
+    fio___timer_event_s *e = list;
+    list = list->next;
+    fio___timer_add(tq, e);
+  }
+}
+
+/* moves the wheel's position forward (call within the lock). */
+FIO_IFUNC void fio___timer_move(fio_timer_queue_s *tq, int64_t to) {
+  const uint64_t old = (uint64_t)tq->at;
+  if (to <= tq->at)
+    return;
+  tq->at = to;
+  /* events in the overflow list may now fit in the wheel */
+  if (tq->overflow && ((old ^ (uint64_t)to) >> (FIO___TIMER_LEVELS * 6))) {
+    fio___timer_event_s *list = tq->overflow;
+    tq->overflow = NULL;
+    fio___timer_readd(tq, list);
+  }
+}
+
+/* returns the earliest due time in a list of events. */
+FIO_IFUNC int64_t fio___timer_list_min(fio___timer_event_s *list) {
+  int64_t r = list->due;
+  for (list = list->next; list; list = list->next)
+    if (list->due < r)
+      r = list->due;
+  return r;
 }
 
 FIO_IFUNC fio___timer_event_s *fio___timer_event_new(
     fio_timer_schedule_args_s args) {
   fio___timer_event_s *t = NULL;
+#if FIO_USE_POOL
+  t = (fio___timer_event_s *)fio___pool_alloc(&fio___timer_pool,
+                                              &fio___timer_pool___mag);
+#else
   t = (fio___timer_event_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*t), 0);
+#endif
   if (!t)
     goto init_error;
   FIO___LEAK_COUNTER_ON_ALLOC(fio___timer_event_s);
@@ -16041,14 +22313,19 @@ FIO_IFUNC void fio___timer_event_free(fio_timer_queue_s *tq,
                                       fio___timer_event_s *t) {
   if (tq && (t->repetitions < 0 || fio_atomic_sub_fetch(&t->repetitions, 1))) {
     FIO___LOCK_LOCK(tq->lock);
-    fio___timer_insert(&tq->next, t);
+    ++tq->count;
+    fio___timer_add(tq, t);
     FIO___LOCK_UNLOCK(tq->lock);
     return;
   }
   if (t->on_finish)
     t->on_finish(t->udata1, t->udata2);
   FIO___LEAK_COUNTER_ON_FREE(fio___timer_event_s);
+#if FIO_USE_POOL
+  fio___pool_free(&fio___timer_pool, &fio___timer_pool___mag, (void *)t);
+#else
   FIO_MEM_FREE_(t, sizeof(*t));
+#endif
 }
 
 FIO_SFUNC void fio___timer_perform(void *timer_, void *t_) {
@@ -16067,16 +22344,62 @@ SFUNC size_t fio_timer_push2queue(fio_queue_s *queue,
   size_t r = 0;
   if (!start_at)
     start_at = fio_time_milli();
-  if (FIO___LOCK_TRYLOCK(timer->lock))
+  if (!timer->count || FIO___LOCK_TRYLOCK(timer->lock))
     return 0;
-  fio___timer_event_s *t;
-  while ((t = fio___timer_pop(&timer->next, start_at))) {
-    fio_queue_push(queue,
-                   .fn = fio___timer_perform,
-                   .udata1 = timer,
-                   .udata2 = t);
-    ++r;
+  while (timer->count) {
+    const uint64_t at = (uint64_t)timer->at;
+    size_t level;
+    /* cascade the slots the wheel's position entered (top down) */
+    for (level = FIO___TIMER_LEVELS - 1; level; --level) {
+      const size_t slot = (size_t)(at >> (level * 6)) & 63;
+      if ((timer->map[level] >> slot) & 1)
+        fio___timer_readd(timer, fio___timer_take(timer, level, slot));
+    }
+    /* perform due events in the current level 0 block */
+    uint64_t map = timer->map[0] & (~(uint64_t)0 << (at & 63));
+    if (map) {
+      const size_t slot = fio_lsb_index_unsafe(map);
+      const int64_t due = (int64_t)((at & ~(uint64_t)63) | slot);
+      if (due > start_at)
+        break;
+      fio___timer_move(timer, due);
+      fio___timer_event_s *t = fio___timer_take(timer, 0, slot), *tmp = NULL;
+      while (t) { /* reverse the list, events are performed FIFO */
+        fio___timer_event_s *next = t->next;
+        t->next = tmp;
+        tmp = t;
+        t = next;
+      }
+      for (t = tmp; t; t = tmp) {
+        tmp = t->next;
+        fio_queue_push(queue,
+                       .fn = fio___timer_perform,
+                       .udata1 = timer,
+                       .udata2 = t);
+        --timer->count;
+        ++r;
+      }
+      continue;
+    }
+    /* jump to the next occupied slot (or to the next overflow block) */
+    int64_t next = -1;
+    for (level = 1; level < FIO___TIMER_LEVELS; ++level) {
+      const size_t shift = level * 6;
+      map = timer->map[level] & (~(uint64_t)0 << ((at >> shift) & 63));
+      if (!map)
+        continue;
+      next = (int64_t)(((at >> (shift + 6)) << (shift + 6)) |
+                       ((uint64_t)fio_lsb_index_unsafe(map) << shift));
+      break;
+    }
+    if (next == -1)
+      next = (int64_t)(((at >> (FIO___TIMER_LEVELS * 6)) + 1)
+                       << (FIO___TIMER_LEVELS * 6));
+    if (next > start_at)
+      break;
+    fio___timer_move(timer, next);
   }
+  fio___timer_move(timer, start_at);
   FIO___LOCK_UNLOCK(timer->lock);
   return r;
 }
@@ -16094,7 +22417,11 @@ SFUNC void fio_timer_schedule FIO_NOOP(fio_timer_queue_s *timer,
   if (!t)
     return;
   FIO___LOCK_LOCK(timer->lock);
-  fio___timer_insert(&timer->next, t);
+  /* a new (or empty) wheel may start earlier, when the timer starts */
+  if (!timer->at || (!timer->count && args.start_at < timer->at))
+    timer->at = args.start_at;
+  ++timer->count;
+  fio___timer_add(timer, t);
   FIO___LOCK_UNLOCK(timer->lock);
   return;
 no_timer_queue:
@@ -16115,10 +22442,32 @@ no_timer_queue:
  * they repeat).
  */
 SFUNC void fio_timer_destroy(fio_timer_queue_s *tq) {
-  fio___timer_event_s *next;
+  fio___timer_event_s *next = NULL;
   FIO___LOCK_LOCK(tq->lock);
-  next = tq->next;
-  tq->next = NULL;
+  /* collect all events into a single list */
+  for (size_t level = 0; level < FIO___TIMER_LEVELS; ++level) {
+    while (tq->map[level]) {
+      fio___timer_event_s *list = fio___timer_take(
+          tq,
+          level,
+          fio_lsb_index_unsafe(tq->map[level]));
+      fio___timer_event_s *last = list;
+      while (last->next)
+        last = last->next;
+      last->next = next;
+      next = list;
+    }
+  }
+  if (tq->overflow) {
+    fio___timer_event_s *last = tq->overflow;
+    while (last->next)
+      last = last->next;
+    last->next = next;
+    next = tq->overflow;
+    tq->overflow = NULL;
+  }
+  tq->count = 0;
+  tq->at = 0;
   FIO___LOCK_UNLOCK(tq->lock);
   FIO___LOCK_DESTROY(tq->lock);
   while (next) {
@@ -16128,6 +22477,44 @@ SFUNC void fio_timer_destroy(fio_timer_queue_s *tq) {
     fio___timer_event_free(NULL, tmp);
   }
 }
+
+/*
+ * Returns the millisecond at which the next event should occur.
+ *
+ * If no timer is due (list is empty), returns `-1`.
+ *
+ * NOTE: unless manually specified, millisecond timers are relative to
+ * `fio_time_milli()`.
+ */
+SFUNC int64_t fio_timer_next_at(fio_timer_queue_s *tq) {
+  int64_t v = -1;
+  if (!tq)
+    goto missing_tq;
+  if (!tq->count)
+    return v;
+  FIO___LOCK_LOCK(tq->lock);
+  /* the first occupied slot of each level holds that level's earliest event */
+  for (size_t level = 0; level < FIO___TIMER_LEVELS; ++level) {
+    const size_t shift = level * 6;
+    const uint64_t map =
+        tq->map[level] & (~(uint64_t)0 << (((uint64_t)tq->at >> shift) & 63));
+    if (!map)
+      continue;
+    const int64_t due = fio___timer_list_min(
+        tq->slots[level][fio_lsb_index_unsafe(map)]);
+    if (v == -1 || due < v)
+      v = due;
+  }
+  /* overflow events are always later than events in the wheel */
+  if (v == -1 && tq->overflow)
+    v = fio___timer_list_min(tq->overflow);
+  FIO___LOCK_UNLOCK(tq->lock);
+  return v;
+
+missing_tq:
+  FIO_LOG_ERROR("`fio_timer_next_at` called with a NULL timer queue!");
+  return v;
+}
 /* *****************************************************************************
 Queue/Timer Cleanup
 ***************************************************************************** */
@@ -16154,6 +22541,15 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #if defined(FIO_STREAM) && !defined(H___FIO_STREAM___H)
 #define H___FIO_STREAM___H
 #include <sys/stat.h>
+#if FIO_OS_POSIX
+#include <sys/uio.h>
+#else
+/** A POSIX style `iovec` (used by `fio_stream_read_iov`). */
+struct iovec {
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
 
 #ifndef FIO_STREAM_COPY_PER_PACKET
 /** Break apart large memory blocks into smaller pieces. by default 96Kb */
@@ -16251,6 +22647,23 @@ Stream API - Consuming the stream
  */
 SFUNC void fio_stream_read(fio_stream_s *stream, char **buf, size_t *len);
 
+/**
+ * Exports the stream's leading data as an `iovec` array, leaving it in the
+ * stream.
+ *
+ * The `iovec` entries point directly to the packets' memory (no copy), so they
+ * are only valid until the stream is advanced or destroyed.
+ *
+ * Sets up to `max` entries and returns the number of entries set. File packets
+ * can't be exported, so the export stops at the first file packet (use
+ * `fio_stream_read` when 0 is returned for a non-empty stream).
+ *
+ * Note: this isn't thread safe.
+ */
+SFUNC size_t fio_stream_read_iov(fio_stream_s *stream,
+                                 struct iovec *iov,
+                                 size_t max);
+
 /**
  * Advances the Stream, so the first `len` bytes are marked as consumed.
  *
@@ -16375,6 +22788,33 @@ typedef struct {
   int fd;
 } fio_stream_packet_fd_s;
 
+#if FIO_USE_POOL
+/* fixed size packets and small embedded packets are allocated from a pool */
+#define FIO___STREAM_POOL_SLOT 128
+FIO___POOL_DEF(fio___stream_pool, FIO___STREAM_POOL_SLOT, 32)
+#endif
+
+FIO_IFUNC fio_stream_packet_s *fio___stream_packet_alloc(size_t size) {
+#if FIO_USE_POOL
+  if (size <= FIO___STREAM_POOL_SLOT)
+    return (fio_stream_packet_s *)fio___pool_alloc(&fio___stream_pool,
+                                                   &fio___stream_pool___mag);
+#endif
+  return (fio_stream_packet_s *)FIO_MEM_REALLOC_(NULL, 0, size, 0);
+}
+
+FIO_IFUNC void fio___stream_packet_dealloc(fio_stream_packet_s *p,
+                                           size_t size) {
+#if FIO_USE_POOL
+  if (size <= FIO___STREAM_POOL_SLOT) {
+    fio___pool_free(&fio___stream_pool, &fio___stream_pool___mag, (void *)p);
+    return;
+  }
+#endif
+  FIO_MEM_FREE_(p, size);
+  (void)size;
+}
+
 FIO_SFUNC void fio_stream_packet_free(fio_stream_packet_s *p) {
   if (!p)
     return;
@@ -16386,12 +22826,12 @@ FIO_SFUNC void fio_stream_packet_free(fio_stream_packet_s *p) {
   } const u = {.em = (fio_stream_packet_embd_s *)(p + 1)};
   switch (u.em->type) {
   case FIO_PACKET_TYPE_EMBEDDED:
-    FIO_MEM_FREE_(p, sizeof(*p) + sizeof(*u.em) + u.em->length);
+    fio___stream_packet_dealloc(p, sizeof(*p) + sizeof(*u.em) + u.em->length);
     break;
   case FIO_PACKET_TYPE_EXTERNAL:
     if (u.ext->dealloc)
       u.ext->dealloc(u.ext->buf);
-    FIO_MEM_FREE_(p, sizeof(*p) + sizeof(*u.ext));
+    fio___stream_packet_dealloc(p, sizeof(*p) + sizeof(*u.ext));
     break;
   case FIO_PACKET_TYPE_FILE: close(u.f->fd);
 #ifdef DEBUG
@@ -16399,7 +22839,7 @@ FIO_SFUNC void fio_stream_packet_free(fio_stream_packet_s *p) {
 #endif
     /* fall through */
   case FIO_PACKET_TYPE_FILE_NO_CLOSE:
-    FIO_MEM_FREE_(p, sizeof(*p) + sizeof(*u.f));
+    fio___stream_packet_dealloc(p, sizeof(*p) + sizeof(*u.f));
     break;
   }
 }
@@ -16447,11 +22887,8 @@ SFUNC fio_stream_packet_s *fio_stream_pack_data(void *buf,
       const size_t slice =
           (len > FIO_STREAM_COPY_PER_PACKET) ? FIO_STREAM_COPY_PER_PACKET : len;
       fio_stream_packet_embd_s *em;
-      fio_stream_packet_s *tmp = (fio_stream_packet_s *)FIO_MEM_REALLOC_(
-          NULL,
-          0,
-          sizeof(*p) + sizeof(*em) + (sizeof(char) * slice),
-          0);
+      fio_stream_packet_s *tmp = fio___stream_packet_alloc(
+          sizeof(*p) + sizeof(*em) + (sizeof(char) * slice));
       if (!tmp)
         goto error;
       FIO___LEAK_COUNTER_ON_ALLOC(fio_stream_packet_s);
@@ -16467,8 +22904,7 @@ SFUNC fio_stream_packet_s *fio_stream_pack_data(void *buf,
       dealloc_func(buf);
   } else {
     fio_stream_packet_extrn_s *ext;
-    p = (fio_stream_packet_s *)
-        FIO_MEM_REALLOC_(NULL, 0, sizeof(*p) + sizeof(*ext), 0);
+    p = fio___stream_packet_alloc(sizeof(*p) + sizeof(*ext));
     if (!p)
       goto error;
     FIO___LEAK_COUNTER_ON_ALLOC(fio_stream_packet_s);
@@ -16509,8 +22945,7 @@ SFUNC fio_stream_packet_s *fio_stream_pack_fd(int fd,
     len -= offset;
   }
 
-  p = (fio_stream_packet_s *)
-      FIO_MEM_REALLOC_(NULL, 0, sizeof(*p) + sizeof(*f), 0);
+  p = fio___stream_packet_alloc(sizeof(*p) + sizeof(*f));
   if (!p)
     goto error;
   FIO___LEAK_COUNTER_ON_ALLOC(fio_stream_packet_s);
@@ -16698,6 +23133,37 @@ none:
   *len = 0;
 }
 
+/** Exports the stream's leading data as an `iovec` array (no copy). */
+SFUNC size_t fio_stream_read_iov(fio_stream_s *s,
+                                 struct iovec *iov,
+                                 size_t max) {
+  size_t count = 0;
+  if (!s || !iov)
+    return count;
+  size_t offset = s->consumed;
+  for (fio_stream_packet_s *p = s->next; p && count < max; p = p->next) {
+    union {
+      fio_stream_packet_embd_s *em;
+      fio_stream_packet_extrn_s *ext;
+    } const u = {.em = (fio_stream_packet_embd_s *)(p + 1)};
+    switch (u.em->type) {
+    case FIO_PACKET_TYPE_EMBEDDED:
+      iov[count].iov_base = (void *)(u.em->buf + offset);
+      iov[count].iov_len = (size_t)u.em->length - offset;
+      break;
+    case FIO_PACKET_TYPE_EXTERNAL:
+      iov[count].iov_base = (void *)(u.ext->buf + u.ext->offset + offset);
+      iov[count].iov_len = u.ext->length - offset;
+      break;
+    case FIO_PACKET_TYPE_FILE: /* fall through */
+    case FIO_PACKET_TYPE_FILE_NO_CLOSE: return count; /* requires a copy */
+    }
+    ++count;
+    offset = 0;
+  }
+  return count;
+}
+
 /**
  * Advances the Stream, so the first `len` bytes are marked as consumed.
  *
@@ -16734,6 +23200,7 @@ Cleanup
 ***************************************************************************** */
 #endif /* FIO_EXTERN_COMPLETE */
 #undef FIO_STREAM___TYPE_BITS
+#undef FIO___STREAM_POOL_SLOT
 #endif /* FIO_STREAM */
 #undef FIO_STREAM
 /* ************************************************************************* */
@@ -26516,10 +32983,27 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #define FIO_REF_TYPE FIO_NAME(FIO_REF_NAME, s)
 #endif
 
+/*
+ * FIO_REF_POOL allocates objects from an object pool (see FIO_POOL_NAME). Set
+ * it to the number of objects to allocate when the program starts (or 0).
+ *
+ * For flexible types, objects with up to FIO_REF_POOL_FLEX members are pooled,
+ * larger objects are allocated normally.
+ */
+#ifdef FIO_REF_POOL
+#ifndef FIO_REF_POOL_FLEX
+#define FIO_REF_POOL_FLEX 0
+#endif
+/* pooled objects are never initialized by the allocator */
+#define FIO___REF_MEM_IS_SAFE 0
+#else
+#define FIO___REF_MEM_IS_SAFE FIO_MEM_REALLOC_IS_SAFE_
+#endif
+
 #ifndef FIO_REF_INIT
 #define FIO_REF_INIT(obj)                                                      \
   do {                                                                         \
-    if (!FIO_MEM_REALLOC_IS_SAFE_)                                             \
+    if (!FIO___REF_MEM_IS_SAFE)                                                \
       (obj) = (FIO_REF_TYPE){0};                                               \
   } while (0)
 #endif
@@ -26532,7 +33016,7 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #ifdef FIO_REF_METADATA
 #define FIO_REF_METADATA_INIT(meta)                                            \
   do {                                                                         \
-    if (!FIO_MEM_REALLOC_IS_SAFE_)                                             \
+    if (!FIO___REF_MEM_IS_SAFE)                                                \
       (meta) = (FIO_REF_METADATA){0};                                          \
   } while (0)
 #else
@@ -26564,6 +33048,9 @@ Copyright and License: see header file (000 copyright.h) or top of file
 
 typedef struct {
   volatile size_t ref;
+#if defined(FIO_REF_POOL) && defined(FIO_REF_FLEX_TYPE)
+  size_t pooled;
+#endif
 #ifdef FIO_REF_METADATA
   FIO_REF_METADATA metadata;
 #endif
@@ -26632,10 +33119,49 @@ Reference Counter (Wrapper) Implementation
 
 FIO___LEAK_COUNTER_DEF(FIO_REF_NAME)
 
+#ifdef FIO_REF_POOL
+#ifdef FIO_REF_FLEX_TYPE
+FIO___POOL_DEF(FIO_NAME(FIO_REF_NAME, __pool),
+               (sizeof(FIO_NAME(FIO_REF_NAME, _wrapper_s)) +
+                sizeof(FIO_REF_TYPE) +
+                (sizeof(FIO_REF_FLEX_TYPE) * FIO_REF_POOL_FLEX)),
+               32)
+#else
+FIO___POOL_DEF(FIO_NAME(FIO_REF_NAME, __pool),
+               (sizeof(FIO_NAME(FIO_REF_NAME, _wrapper_s)) +
+                sizeof(FIO_REF_TYPE)),
+               32)
+#endif /* FIO_REF_FLEX_TYPE */
+#if (FIO_REF_POOL + 0) > 0
+/* pre-warms the object pool when the program starts */
+FIO_CONSTRUCTOR(FIO_NAME(FIO_REF_NAME, __pool_warmup)) {
+  fio___pool_warmup(&FIO_NAME(FIO_REF_NAME, __pool), FIO_REF_POOL);
+}
+#endif
+#define FIO___REF_POOL_ALLOC()                                                 \
+  fio___pool_alloc(&FIO_NAME(FIO_REF_NAME, __pool),                            \
+                   &FIO_NAME(FIO_NAME(FIO_REF_NAME, __pool), __mag))
+#define FIO___REF_POOL_FREE(o)                                                 \
+  fio___pool_free(&FIO_NAME(FIO_REF_NAME, __pool),                             \
+                  &FIO_NAME(FIO_NAME(FIO_REF_NAME, __pool), __mag),            \
+                  (void *)(o))
+#endif /* FIO_REF_POOL */
+
 /** Allocates a reference counted object. */
 #ifdef FIO_REF_FLEX_TYPE
 IFUNC FIO_REF_TYPE_PTR FIO_NAME(FIO_REF_NAME,
                                 FIO_REF_CONSTRUCTOR)(size_t members) {
+#ifdef FIO_REF_POOL
+  FIO_NAME(FIO_REF_NAME, _wrapper_s) *o =
+      (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)(
+          (members <= FIO_REF_POOL_FLEX)
+              ? FIO___REF_POOL_ALLOC()
+              : FIO_MEM_REALLOC_(NULL,
+                                 0,
+                                 sizeof(*o) + sizeof(FIO_REF_TYPE) +
+                                     (sizeof(FIO_REF_FLEX_TYPE) * members),
+                                 0));
+#else
   FIO_NAME(FIO_REF_NAME, _wrapper_s) *o =
       (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)FIO_MEM_REALLOC_(
           NULL,
@@ -26643,14 +33169,23 @@ IFUNC FIO_REF_TYPE_PTR FIO_NAME(FIO_REF_NAME,
           sizeof(*o) + sizeof(FIO_REF_TYPE) +
               (sizeof(FIO_REF_FLEX_TYPE) * members),
           0);
+#endif /* FIO_REF_POOL */
 #else
 IFUNC FIO_REF_TYPE_PTR FIO_NAME(FIO_REF_NAME, FIO_REF_CONSTRUCTOR)(void) {
+#ifdef FIO_REF_POOL
+  FIO_NAME(FIO_REF_NAME, _wrapper_s) *o =
+      (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)FIO___REF_POOL_ALLOC();
+#else
   FIO_NAME(FIO_REF_NAME, _wrapper_s) *o = (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)
       FIO_MEM_REALLOC_(NULL, 0, sizeof(*o) + sizeof(FIO_REF_TYPE), 0);
+#endif /* FIO_REF_POOL */
 #endif /* FIO_REF_FLEX_TYPE */
   if (!o)
     return (FIO_REF_TYPE_PTR)(o);
   FIO___LEAK_COUNTER_ON_ALLOC(FIO_REF_NAME);
+#if defined(FIO_REF_POOL) && defined(FIO_REF_FLEX_TYPE)
+  o->pooled = (members <= FIO_REF_POOL_FLEX);
+#endif
   o->ref = 1;
   FIO_REF_METADATA_INIT((o->metadata));
   FIO_REF_TYPE *ret = (FIO_REF_TYPE *)(o + 1);
@@ -26675,7 +33210,17 @@ IFUNC void FIO_NAME(FIO_REF_NAME,
   FIO_REF_DESTROY((wrapped[0]));
   FIO_REF_METADATA_DESTROY((o->metadata));
   FIO___LEAK_COUNTER_ON_FREE(FIO_REF_NAME);
+#ifdef FIO_REF_POOL
+#ifdef FIO_REF_FLEX_TYPE
+  if (!o->pooled) {
+    FIO_MEM_FREE_(o, sizeof(*o) + sizeof(FIO_REF_TYPE));
+    return;
+  }
+#endif /* FIO_REF_FLEX_TYPE */
+  FIO___REF_POOL_FREE(o);
+#else
   FIO_MEM_FREE_(o, sizeof(*o) + sizeof(FIO_REF_TYPE));
+#endif /* FIO_REF_POOL */
 }
 
 #ifdef FIO_REF_METADATA
@@ -26693,8 +33238,13 @@ IFUNC FIO_REF_METADATA *FIO_NAME(FIO_REF_NAME,
 Reference Counter (Wrapper) Cleanup
 ***************************************************************************** */
 
+#undef FIO___REF_POOL_ALLOC
+#undef FIO___REF_POOL_FREE
 #endif /* FIO_EXTERN_COMPLETE */
 #undef FIO_REF_NAME
+#undef FIO_REF_POOL
+#undef FIO_REF_POOL_FLEX
+#undef FIO___REF_MEM_IS_SAFE
 #undef FIO_REF_FLEX_TYPE
 #undef FIO_REF_TYPE
 #undef FIO_REF_INIT
@@ -28110,6 +34660,11 @@ developer.
 #define FIO_SRV_BUFFER_PER_WRITE 65536U
 #endif
 
+#ifndef FIO_SRV_IOV_PER_WRITE
+/** The maximum number of buffers sent by a single vectored (`writev`) call. */
+#define FIO_SRV_IOV_PER_WRITE 64
+#endif
+
 #ifndef FIO_SRV_THROTTLE_LIMIT
 /** IO will be throttled (no `on_data` events) if outgoing buffer is large. */
 #define FIO_SRV_THROTTLE_LIMIT 2097152U
@@ -28125,6 +34680,26 @@ developer.
 #define FIO_SRV_SHUTDOWN_TIMEOUT 10000
 #endif
 
+#ifndef FIO_SRV_TICK_BUDGET
+/** The time (in microseconds) a reactor cycle may spend performing tasks. */
+#define FIO_SRV_TICK_BUDGET 4000
+#endif
+
+#ifndef FIO_SRV_LANE_WEIGHTS
+/** Tasks performed per scheduling round: IO, timers, user, background. */
+#define FIO_SRV_LANE_WEIGHTS {16, 8, 8, 1}
+#endif
+
+#ifndef FIO_SRV_BUSY_POLL
+/** The time (in microseconds) the reactor polls before blocking (0 = off). */
+#define FIO_SRV_BUSY_POLL 0
+#endif
+
+#ifndef FIO_SRV_THREADS
+/** The number of reactor threads per process (see `fio_srv_threads_set`). */
+#define FIO_SRV_THREADS 1
+#endif
+
 /* *****************************************************************************
 IO Types
 ***************************************************************************** */
@@ -28172,6 +34747,37 @@ SFUNC int fio_srv_pid(void);
 /** Returns the root / master process id. */
 SFUNC int fio_srv_root_pid(void);
 
+/**
+ * Sets the busy-poll window (in microseconds), 0 disables busy polling.
+ *
+ * The reactor keeps polling for IO events (without blocking) until the window
+ * passes since the last IO event or task, trading CPU time for latency.
+ *
+ * Accepted sockets are marked with `SO_BUSY_POLL` / `SO_PREFER_BUSY_POLL`.
+ */
+SFUNC void fio_srv_busy_poll_set(uint32_t window_us);
+
+/** Returns the busy-poll window (in microseconds), 0 if disabled. */
+SFUNC uint32_t fio_srv_busy_poll_get(void);
+
+/**
+ * Sets the number of reactor threads each (worker) process runs.
+ *
+ * Each reactor thread polls its own IO, performs its own task lanes and runs
+ * its own timers. Negative values are a fraction of the CPU cores (as with
+ * `fio_srv_workers`).
+ *
+ * Must be called before `fio_srv_start` (and before `fio_srv_listen`, so
+ * listening sockets could use `SO_REUSEPORT`).
+ */
+SFUNC void fio_srv_threads_set(int threads);
+
+/** Returns the number of reactor threads each (worker) process runs. */
+SFUNC uint16_t fio_srv_threads(void);
+
+/** Returns the calling reactor thread's index (0 = main) or -1 if none. */
+SFUNC int fio_srv_thread(void);
+
 /* *****************************************************************************
 Listening to Incoming Connections
 ***************************************************************************** */
@@ -28462,11 +35068,50 @@ SFUNC int fio_srv_is_open(fio_s *io);
 Task Scheduling
 ***************************************************************************** */
 
-/** Schedules a task for delayed execution. This function is thread-safe. */
+/** Server task lanes, performed using weighted fair scheduling. */
+typedef enum {
+  /** IO events (`on_data`, `on_ready`, `on_close`). */
+  FIO_SRV_LANE_IO = 0,
+  /** Timer bound tasks (`fio_srv_run_every`). */
+  FIO_SRV_LANE_TIMER = 1,
+  /** Deferred tasks (`fio_srv_defer`), the default lane. */
+  FIO_SRV_LANE_USER = 2,
+  /** Background / maintenance tasks (i.e., IO timeout reviews). */
+  FIO_SRV_LANE_BACKGROUND = 3,
+} fio_srv_lane_e;
+
+/**
+ * Schedules a task for delayed execution by the calling reactor thread (or the
+ * main reactor thread, if called from any other thread).
+ *
+ * This function is thread-safe.
+ */
 SFUNC void fio_srv_defer(void (*task)(void *, void *),
                          void *udata1,
                          void *udata2);
 
+/**
+ * Schedules a task for delayed execution by the main reactor thread.
+ *
+ * Tasks that manage state shared by all the reactor threads should be
+ * performed by the main reactor thread.
+ *
+ * This function is thread-safe.
+ */
+SFUNC void fio_srv_defer_main(void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2);
+
+/**
+ * Schedules a task for delayed execution in a specific task lane.
+ *
+ * This function is thread-safe.
+ */
+SFUNC void fio_srv_defer_lane(fio_srv_lane_e lane,
+                              void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2);
+
 /** Schedules a timer bound task, see `fio_timer_schedule`. */
 SFUNC void fio_srv_run_every(fio_timer_schedule_args_s args);
 /**
@@ -28493,9 +35138,12 @@ SFUNC void fio_srv_run_every(fio_timer_schedule_args_s args);
 /** Returns the last millisecond when the server reviewed pending IO events. */
 SFUNC int64_t fio_srv_last_tick(void);
 
-/** Returns a pointer for the server's queue. */
+/** Returns a pointer for the reactor's queue (the user lane). */
 SFUNC fio_queue_s *fio_srv_queue(void);
 
+/** Returns a pointer for the queue of a reactor's task lane. */
+SFUNC fio_queue_s *fio_srv_lane(fio_srv_lane_e lane);
+
 /**************************************************************************/ /**
 Protocol IO Functions
 ============
@@ -28518,6 +35166,15 @@ struct fio_io_functions_s {
   ssize_t (*read)(int fd, void *buf, size_t len, void *context);
   /** Called to perform a non-blocking `write`, same as the system call. */
   ssize_t (*write)(int fd, const void *buf, size_t len, void *context);
+  /**
+   * Called to perform a non-blocking `writev`, same as the system call.
+   *
+   * Optional: if missing and `write` isn't the default, `write` is used.
+   */
+  ssize_t (*writev)(int fd,
+                    const struct iovec *iov,
+                    size_t count,
+                    void *context);
   /** Sends any unsent internal data. Returns 0 only if all data was sent. */
   int (*flush)(int fd, void *context);
   /** Called when the IO object has closed . */
@@ -28597,7 +35254,12 @@ struct fio_protocol_s {
   uint32_t timeout;
 };
 
-/** Performs a task for each IO in the stated protocol. */
+/**
+ * Performs a task for each IO in the stated protocol.
+ *
+ * Note: the protocol's IO list is shared by all reactor threads, so this should
+ * only be used for protocols attached by a single reactor thread.
+ */
 FIO_SFUNC size_t fio_protocol_each(fio_protocol_s *protocol,
                                    void (*task)(fio_s *, void *udata2),
                                    void *udata2);
@@ -28903,6 +35565,19 @@ static ssize_t fio___io_func_default_write(int fd,
   return fio_sock_write(fd, buf, len);
   (void)tls;
 }
+/** Called to perform a non-blocking `writev`, same as the system call. */
+static ssize_t fio___io_func_default_writev(int fd,
+                                            const struct iovec *iov,
+                                            size_t count,
+                                            void *tls) {
+#if FIO_OS_POSIX
+  return writev(fd, iov, (int)count);
+#else
+  return fio_sock_write(fd, iov[0].iov_base, iov[0].iov_len);
+  (void)count;
+#endif
+  (void)tls;
+}
 /** Sends any unsent internal data. Returns 0 only if all data was sent. */
 static int fio___io_func_default_flush(int fd, void *tls) {
   return 0;
@@ -28974,6 +35649,7 @@ FIO_SFUNC void fio___srv_init_protocol(fio_protocol_s *pr, _Bool has_tls) {
       .start = fio___srv_on_ev_mock,
       .read = fio___io_func_default_read,
       .write = fio___io_func_default_write,
+      .writev = fio___io_func_default_writev,
       .flush = fio___io_func_default_flush,
       .finish = fio___io_func_default_finish,
       .cleanup = fio___srv_on_close_mock,
@@ -29012,6 +35688,8 @@ FIO_SFUNC void fio___srv_init_protocol(fio_protocol_s *pr, _Bool has_tls) {
     pr->io_functions.read = io_fn.read;
   if (!pr->io_functions.write)
     pr->io_functions.write = io_fn.write;
+  if (!pr->io_functions.writev && pr->io_functions.write == io_fn.write)
+    pr->io_functions.writev = io_fn.writev; /* may be NULL (use `write`) */
   if (!pr->io_functions.flush)
     pr->io_functions.flush = io_fn.flush;
   if (!pr->io_functions.finish)
@@ -29151,6 +35829,42 @@ static void fio___srv_poll_on_data_schd(void *udata);
 static void fio___srv_poll_on_ready_schd(void *udata);
 static void fio___srv_poll_on_close_schd(void *udata);
 
+/* poll events are pushed to the task queue in batches of this size */
+#define FIO___SRV_EVENT_BATCH 64
+
+#define FIO___SRV_LANES 4
+
+/* a reactor polls its own IO, performs its own task lanes and timers */
+typedef struct {
+  fio_poll_s poll_data;
+  fio_queue_s lanes[FIO___SRV_LANES];
+  fio_timer_queue_s timer;
+  fio_s *wakeup;
+  int wakeup_fd;
+  int wakeup_wait;
+  /* busy polling: the last activity and if the reactor spins */
+  int64_t busy_since;
+  volatile uint8_t busy_spinning;
+  uint8_t performed_idle;
+  /* the reactor's index (0 == main reactor) */
+  uint16_t id;
+  /* the number of IO objects attached to the reactor */
+  size_t ios;
+  int64_t last_to_review;
+  fio_thread_t thread;
+  /* poll events waiting to be pushed to the task queue */
+  size_t events;
+  fio_queue_task_s event_tasks[FIO___SRV_EVENT_BATCH];
+} fio___srv_reactor_s;
+
+static fio___srv_reactor_s fio___srv_main_reactor[1] = {{
+    .timer = FIO_TIMER_QUEUE_INIT,
+    .wakeup_fd = -1,
+}};
+
+/* the reactor owned by the calling thread (NULL for non-reactor threads) */
+static __thread fio___srv_reactor_s *fio___srv_current_reactor;
+
 static struct {
   FIO_LIST_HEAD protocols;
 #if FIO_VALIDITY_MAP_USE
@@ -29160,16 +35874,20 @@ static struct {
 #endif
 #endif /* FIO_VALIDITY_MAP_USE */
   fio___srv_env_safe_s env;
-  fio_poll_s poll_data;
   int64_t tick;
   fio_thread_pid_t root_pid;
   fio_thread_pid_t pid;
-  fio_s *wakeup;
-  int wakeup_fd;
-  int wakeup_wait;
   uint16_t workers;
   uint8_t is_worker;
   volatile uint8_t stop;
+  /* the busy-poll window */
+  uint32_t busy_poll;
+  /* reactor threads: configured, running and the non-main reactors */
+  uint16_t threads;
+  uint16_t reactor_count;
+  fio___srv_reactor_s *reactors;
+  /* protects the protocol / IO lists while more than one reactor runs */
+  FIO___LOCK_TYPE ios_lock;
   FIO_LIST_HEAD async;
 } fio___srvdata = {
 #if FIO_VALIDATE_IO_MUTEX && FIO_VALIDITY_MAP_USE
@@ -29179,44 +35897,112 @@ static struct {
     .env = FIO___SRV_ENV_SAFE_INIT,
 #endif
     .tick = 0,
-    .wakeup_fd = -1,
     .stop = 1,
+    .busy_poll = FIO_SRV_BUSY_POLL,
+    .reactor_count = 1,
+    .ios_lock = FIO___LOCK_INIT,
 };
 
+/* returns the calling thread's reactor (or the main reactor). */
+FIO_IFUNC fio___srv_reactor_s *fio___srv_reactor(void) {
+  fio___srv_reactor_s *r = fio___srv_current_reactor;
+  return r ? r : fio___srv_main_reactor;
+}
+
+/* the tick is written by every reactor, so it's accessed atomically. */
+FIO_IFUNC int64_t fio___srv_tick_get(void) {
+  int64_t t;
+  fio_atomic_load(t, &fio___srvdata.tick);
+  return t;
+}
+FIO_IFUNC int64_t fio___srv_tick_update(void) {
+  int64_t t = FIO___SRV_GET_TIME_MILLI();
+  fio_atomic_exchange(&fio___srvdata.tick, t);
+  return t;
+}
+
+#define FIO___SRV_IOS_LOCK()                                                   \
+  do {                                                                         \
+    if (fio___srvdata.reactor_count > 1)                                       \
+      FIO___LOCK_LOCK(fio___srvdata.ios_lock);                                 \
+  } while (0)
+#define FIO___SRV_IOS_UNLOCK()                                                 \
+  do {                                                                         \
+    if (fio___srvdata.reactor_count > 1)                                       \
+      FIO___LOCK_UNLOCK(fio___srvdata.ios_lock);                               \
+  } while (0)
+
 /** Returns current process id. */
 SFUNC int fio_srv_pid(void) { return fio___srvdata.pid; }
 
 /** Returns the root / master process id. */
 SFUNC int fio_srv_root_pid(void) { return fio___srvdata.root_pid; }
 
+/** Sets the busy-poll window (in microseconds), 0 disables busy polling. */
+SFUNC void fio_srv_busy_poll_set(uint32_t window_us) {
+  fio___srvdata.busy_poll = window_us;
+}
+
+/** Returns the busy-poll window (in microseconds), 0 if disabled. */
+SFUNC uint32_t fio_srv_busy_poll_get(void) { return fio___srvdata.busy_poll; }
+
+/* marks an accepted socket for busy polling (if the system allows it). */
+FIO_SFUNC void fio___srv_busy_poll_sock(int fd) {
+#if defined(SO_BUSY_POLL)
+  static int reported;
+  int value = (int)fio___srvdata.busy_poll;
+  if (!value)
+    return;
+  if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, (void *)&value, sizeof(value)) &&
+      !reported) {
+    reported = 1; /* usually requires CAP_NET_ADMIN */
+    FIO_LOG_DEBUG("%d SO_BUSY_POLL unavailable: %s",
+                  fio___srvdata.pid,
+                  strerror(errno));
+  }
+#if defined(SO_PREFER_BUSY_POLL)
+  value = 1;
+  setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, (void *)&value, sizeof(value));
+#endif
+#endif /* SO_BUSY_POLL */
+  (void)fd;
+}
+
 /* *****************************************************************************
 Wakeup Protocol
 ***************************************************************************** */
 
 FIO_SFUNC void fio___srv_wakeup_cb(fio_s *io) {
+  fio___srv_reactor_s *r = (fio___srv_reactor_s *)fio_udata_get(io);
   char buf[512];
-  ssize_t r = fio_sock_read(fio_fd_get(io), buf, 512);
-  (void)r;
-  fio___srvdata.wakeup_wait = 0;
+  ssize_t rd = fio_sock_read(fio_fd_get(io), buf, 512);
+  if (rd < 512) /* drained, skip the edge triggered engine's readiness test */
+    fio_poll_would_block(&r->poll_data, fio_fd_get(io), POLLIN);
+  r->wakeup_wait = 0;
 #if DEBUG
-  FIO_LOG_DEBUG2("%d fio___srv_wakeup called", fio___srvdata.pid);
+  FIO_LOG_DEBUG2("%d fio___srv_wakeup called (reactor %d)",
+                 fio___srvdata.pid,
+                 (int)r->id);
 #endif
 }
-FIO_SFUNC void fio___srv_wakeup_on_close(void *ignr_) {
-  (void)ignr_;
-  fio_sock_close(fio___srvdata.wakeup_fd);
-  fio___srvdata.wakeup = NULL;
-  fio___srvdata.wakeup_fd = -1;
-  FIO_LOG_DEBUG2("%d fio___srv_wakeup destroyed", fio___srvdata.pid);
+FIO_SFUNC void fio___srv_wakeup_on_close(void *r_) {
+  fio___srv_reactor_s *r = (fio___srv_reactor_s *)r_;
+  fio_sock_close(r->wakeup_fd);
+  r->wakeup = NULL;
+  r->wakeup_fd = -1;
+  FIO_LOG_DEBUG2("%d fio___srv_wakeup destroyed (reactor %d)",
+                 fio___srvdata.pid,
+                 (int)r->id);
 }
 
-FIO_SFUNC void fio___srv_wakeup(void) {
-  if (!fio___srvdata.wakeup || fio_queue_count(fio_srv_queue()) > 3 ||
-      fio_atomic_or(&fio___srvdata.wakeup_wait, 1))
+FIO_SFUNC void fio___srv_wakeup(fio___srv_reactor_s *r) {
+  if (!r->wakeup || r->busy_spinning ||
+      fio_queue_count(r->lanes + FIO_SRV_LANE_USER) > 3 ||
+      fio_atomic_or(&r->wakeup_wait, 1))
     return;
-  fio___srvdata.wakeup_wait = 1;
+  r->wakeup_wait = 1;
   char buf[1] = {~0};
-  ssize_t ignr = fio_sock_write(fio___srvdata.wakeup_fd, buf, 1);
+  ssize_t ignr = fio_sock_write(r->wakeup_fd, buf, 1);
   (void)ignr;
 }
 
@@ -29226,8 +36012,10 @@ static fio_protocol_s FIO___SRV_WAKEUP_PROTOCOL = {
     .on_timeout = fio___srv_on_timeout_never,
 };
 
+/* initializes the calling reactor's wakeup pipe. */
 FIO_SFUNC void fio___srv_wakeup_init(void) {
-  if (fio___srvdata.wakeup)
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  if (r->wakeup)
     return;
   int fds[2];
   if (pipe(fds)) {
@@ -29237,40 +36025,121 @@ FIO_SFUNC void fio___srv_wakeup_init(void) {
   }
   fio_sock_set_non_block(fds[0]);
   fio_sock_set_non_block(fds[1]);
-  fio___srvdata.wakeup_fd = fds[1];
-  fio___srvdata.wakeup = fio_srv_attach_fd(fds[0],
-                                           &FIO___SRV_WAKEUP_PROTOCOL,
-                                           (void *)(uintptr_t)fds[1],
-                                           NULL);
-  FIO_LOG_DEBUG2("%d fio___srv_wakeup initialized", fio___srvdata.pid);
+  r->wakeup_fd = fds[1];
+  r->wakeup =
+      fio_srv_attach_fd(fds[0], &FIO___SRV_WAKEUP_PROTOCOL, (void *)r, NULL);
+  FIO_LOG_DEBUG2("%d fio___srv_wakeup initialized (reactor %d)",
+                 fio___srvdata.pid,
+                 (int)r->id);
 }
 
 /* *****************************************************************************
 Server Timers and Task Queues
 ***************************************************************************** */
 
-static fio_timer_queue_s fio___srv_timer[1] = {FIO_TIMER_QUEUE_INIT};
-static fio_queue_s fio___srv_tasks[1];
+/* returns the number of tasks waiting in all of the reactor's lanes. */
+FIO_SFUNC size_t fio___srv_lanes_count(void) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  size_t count = 0;
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    count += fio_queue_count(r->lanes + i);
+  return count;
+}
+
+/* performs all tasks in all lanes, in lane order (no time budget). */
+FIO_SFUNC void fio___srv_lanes_perform_all(void) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  for (size_t performed = 1; performed;) {
+    performed = 0;
+    for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+      while (!fio_queue_perform(r->lanes + i))
+        ++performed;
+  }
+}
+
+/*
+ * Performs tasks from all lanes until the lanes are empty or the time budget
+ * (in microseconds) is spent.
+ *
+ * Each round performs up to a lane's weight in tasks from each lane (weighted
+ * round robin), so busy lanes can't starve the others.
+ */
+FIO_SFUNC void fio___srv_lanes_perform(int64_t budget) {
+  static const size_t weights[FIO___SRV_LANES] = FIO_SRV_LANE_WEIGHTS;
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  const int64_t deadline = fio_time_micro() + budget;
+  for (;;) {
+    size_t performed = 0;
+    for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+      performed += fio_queue_perform_batch(r->lanes + i, weights[i]);
+    if (!performed || fio_time_micro() >= deadline)
+      return;
+  }
+}
+
+/* schedules a task in a reactor's lane, waking the reactor if required. */
+FIO_IFUNC void fio___srv_defer_to(fio___srv_reactor_s *r,
+                                  fio_srv_lane_e lane,
+                                  void (*task)(void *, void *),
+                                  void *udata1,
+                                  void *udata2) {
+  fio_queue_push(r->lanes + lane, task, udata1, udata2);
+  if (r != fio___srv_current_reactor) /* a reactor reviews its own lanes */
+    fio___srv_wakeup(r);
+}
 
 /** Returns the last millisecond when the server reviewed pending IO events. */
-SFUNC int64_t fio_srv_last_tick(void) { return fio___srvdata.tick; }
+SFUNC int64_t fio_srv_last_tick(void) { return fio___srv_tick_get(); }
 
 /** Schedules a task for delayed execution. This function is thread-safe. */
 SFUNC void fio_srv_defer(void (*task)(void *, void *),
                          void *udata1,
                          void *udata2) {
-  fio_queue_push(fio___srv_tasks, task, udata1, udata2);
-  fio___srv_wakeup();
+  fio___srv_defer_to(fio___srv_reactor(),
+                     FIO_SRV_LANE_USER,
+                     task,
+                     udata1,
+                     udata2);
+}
+
+/** Schedules a task for delayed execution by the main reactor thread. */
+SFUNC void fio_srv_defer_main(void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2) {
+  fio___srv_defer_to(fio___srv_main_reactor,
+                     FIO_SRV_LANE_USER,
+                     task,
+                     udata1,
+                     udata2);
+}
+
+/** Schedules a task for delayed execution in a specific task lane. */
+SFUNC void fio_srv_defer_lane(fio_srv_lane_e lane,
+                              void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2) {
+  if ((unsigned)lane >= FIO___SRV_LANES)
+    lane = FIO_SRV_LANE_USER;
+  fio___srv_defer_to(fio___srv_reactor(), lane, task, udata1, udata2);
 }
 
 /** Schedules a timer bound task, see `fio_timer_schedule` in the CSTL. */
 SFUNC void fio_srv_run_every FIO_NOOP(fio_timer_schedule_args_s args) {
-  args.start_at += ((uint64_t)0 - !args.start_at) & fio___srvdata.tick;
-  fio_timer_schedule FIO_NOOP(fio___srv_timer, args);
+  args.start_at += ((uint64_t)0 - !args.start_at) & fio___srv_tick_get();
+  fio_timer_schedule FIO_NOOP(&fio___srv_reactor()->timer, args);
 }
 
-/** Returns a pointer for the server's queue. */
-SFUNC fio_queue_s *fio_srv_queue(void) { return fio___srv_tasks; }
+/** Returns a pointer for the reactor's queue (the user lane). */
+SFUNC fio_queue_s *fio_srv_queue(void) {
+  return fio___srv_reactor()->lanes + FIO_SRV_LANE_USER;
+}
+
+/** Returns a pointer for the queue of a reactor's task lane. */
+SFUNC fio_queue_s *fio_srv_lane(fio_srv_lane_e lane) {
+  if ((unsigned)lane >= FIO___SRV_LANES)
+    lane = FIO_SRV_LANE_USER;
+  return fio___srv_reactor()->lanes + lane;
+}
 
 /* *****************************************************************************
 IO Validity Map - Implementation
@@ -29352,6 +36221,7 @@ struct fio_s {
   void *udata;
   void *tls;
   fio_protocol_s *pr;
+  fio___srv_reactor_s *reactor;
   FIO_LIST_NODE node;
   fio_stream_s stream;
   fio___srv_env_safe_s env;
@@ -29375,22 +36245,27 @@ struct fio_s {
 FIO_SFUNC void fio_s_init(fio_s *io) {
   *io = (fio_s){
       .pr = &FIO___MOCK_PROTOCOL,
+      .reactor = fio___srv_reactor(),
       .node = FIO_LIST_INIT(io->node),
       .stream = FIO_STREAM_INIT(io->stream),
       .env = FIO___SRV_ENV_SAFE_INIT,
-      .active = fio___srvdata.tick,
+      .active = fio___srv_tick_get(),
       .state = FIO_STATE_OPEN,
       .fd = -1,
   };
+  fio_atomic_add(&io->reactor->ios, 1);
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
   FIO_LIST_REMOVE(&FIO___MOCK_PROTOCOL.reserved.protocols);
   FIO_LIST_PUSH(&fio___srvdata.protocols,
                 &FIO___MOCK_PROTOCOL.reserved.protocols);
+  FIO___SRV_IOS_UNLOCK();
   fio_set_valid(io);
 }
 
 FIO_SFUNC void fio_s_destroy(fio_s *io) {
   fio_set_invalid(io);
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_REMOVE(&io->node);
 #ifdef DEBUG
   FIO_LOG_DDEBUG2("detaching and destroying %p (fd %d): %zu bytes total",
@@ -29403,17 +36278,22 @@ FIO_SFUNC void fio_s_destroy(fio_s *io) {
   /* store info, as it might be freed if the protocol is freed. */
   if (FIO_LIST_IS_EMPTY(&io->pr->reserved.ios))
     FIO_LIST_REMOVE_RESET(&io->pr->reserved.protocols);
+  FIO___SRV_IOS_UNLOCK();
   /* call on_finish / free callbacks . */
   io->pr->io_functions.cleanup(io->tls);
   io->pr->on_close(io->udata); /* may destroy protocol object! */
   fio___srv_env_safe_destroy(&io->env);
   fio_sock_close(io->fd);
   fio_stream_destroy(&io->stream);
-  fio_poll_forget(&fio___srvdata.poll_data, io->fd);
+  fio_poll_forget(&io->reactor->poll_data, io->fd);
+  fio_atomic_sub(&io->reactor->ios, 1);
 }
 #define FIO_REF_NAME            fio
 #define FIO_REF_INIT(o)         fio_s_init(&(o))
 #define FIO_REF_DESTROY(o)      fio_s_destroy(&(o))
+#if FIO_USE_POOL
+#define FIO_REF_POOL 0
+#endif
 #define FIO___RECURSIVE_INCLUDE 1
 #include FIO_INCLUDE_FILE
 #undef FIO___RECURSIVE_INCLUDE
@@ -29421,14 +36301,16 @@ FIO_SFUNC void fio_s_destroy(fio_s *io) {
 static void fio___protocol_set_task(void *io_, void *old_) {
   fio_s *io = (fio_s *)io_;
   fio_protocol_s *old = (fio_protocol_s *)old_;
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_REMOVE(&io->node);
   if (FIO_LIST_IS_EMPTY(&old->reserved.ios))
     FIO_LIST_REMOVE_RESET(&old->reserved.protocols);
   FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
   if (io->node.next == io->node.prev) /* list was empty before IO was added */
     FIO_LIST_PUSH(&fio___srvdata.protocols, &io->pr->reserved.protocols);
+  FIO___SRV_IOS_UNLOCK();
   io->pr->on_attach(io);
-  fio_poll_monitor(&fio___srvdata.poll_data,
+  fio_poll_monitor(&io->reactor->poll_data,
                    io->fd,
                    (void *)io,
                    POLLIN | POLLOUT);
@@ -29445,7 +36327,7 @@ SFUNC fio_protocol_s *fio_protocol_set(fio_s *io, fio_protocol_s *pr) {
   if (pr == old)
     return NULL;
   io->pr = pr;
-  // fio_queue_push(fio___srv_tasks, fio___protocol_set_task, io, old);
+  // fio_srv_defer(fio___protocol_set_task, io, old);
   fio___protocol_set_task((void *)io, (void *)old);
   return old;
 }
@@ -29477,7 +36359,11 @@ SFUNC fio_s *fio_srv_attach_fd(int fd,
   io->pr = protocol;
   io->udata = udata;
   io->tls = tls;
-  fio_queue_push(fio___srv_tasks, fio___protocol_set_task, io, old);
+  fio___srv_defer_to(io->reactor,
+                     FIO_SRV_LANE_USER,
+                     fio___protocol_set_task,
+                     io,
+                     old);
   return io;
 error:
   protocol->on_close(udata);
@@ -29500,7 +36386,7 @@ static void fio_undup_task(void *io, void *ignr_) {
  * when all other tasks have completed.
  */
 SFUNC void fio_undup(fio_s *io) {
-  fio_queue_push(fio___srv_tasks, fio_undup_task, io);
+  fio___srv_defer_to(io->reactor, FIO_SRV_LANE_USER, fio_undup_task, io, NULL);
 }
 
 /** Performs a task for each IO in the stated protocol. */
@@ -29583,10 +36469,10 @@ static void fio___srv_poll_on_data(void *io_, void *ignr_) {
     /* this also tests for the suspended / throttled / closing flags */
     io->pr->on_data(io);
     if (io->state == FIO_STATE_OPEN) {
-      fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLIN);
+      fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLIN);
     }
   } else if ((io->state & FIO_STATE_OPEN)) {
-    fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLOUT);
+    fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLOUT);
   }
   fio_free2(io);
   return;
@@ -29599,22 +36485,33 @@ static void fio___srv_poll_on_ready(void *io_, void *ignr_) {
 #endif
   fio_s *io = (fio_s *)io_;
   char buf_mem[FIO_SRV_BUFFER_PER_WRITE];
+  struct iovec iov[FIO_SRV_IOV_PER_WRITE];
   size_t total = 0;
   if (!(io->state & FIO_STATE_OPEN))
     goto finish;
   for (;;) {
-    size_t len = FIO_SRV_BUFFER_PER_WRITE;
-    char *buf = buf_mem;
-    fio_stream_read(&io->stream, &buf, &len);
-    if (!len)
-      break;
-    ssize_t r = io->pr->io_functions.write(io->fd, buf, len, io->tls);
+    ssize_t r;
+    size_t count = 0;
+    if (io->pr->io_functions.writev) /* send queued packets without copying */
+      count = fio_stream_read_iov(&io->stream, iov, FIO_SRV_IOV_PER_WRITE);
+    if (count > 1) {
+      r = io->pr->io_functions.writev(io->fd, iov, count, io->tls);
+    } else {
+      size_t len = FIO_SRV_BUFFER_PER_WRITE;
+      char *buf = buf_mem;
+      fio_stream_read(&io->stream, &buf, &len);
+      if (!len)
+        break;
+      r = io->pr->io_functions.write(io->fd, buf, len, io->tls);
+    }
     if (r > 0) {
       total += r;
       fio_stream_advance(&io->stream, r);
       continue;
     } else if ((r == -1) & ((errno == EWOULDBLOCK) || (errno == EAGAIN) ||
                             (errno == EINTR))) {
+      if (errno != EINTR)
+        fio_poll_would_block(&io->reactor->poll_data, io->fd, POLLOUT);
       break;
     } else {
 #if DEBUG
@@ -29644,7 +36541,7 @@ static void fio___srv_poll_on_ready(void *io_, void *ignr_) {
     } else {
       if ((io->state & FIO_STATE_THROTTLED)) {
         fio_atomic_and(&io->state, ~FIO_STATE_THROTTLED);
-        fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLIN);
+        fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLIN);
       }
       FIO_LOG_DDEBUG2("calling on_ready for %p (fd %d)", (void *)io, io->fd);
       io->pr->on_ready(io);
@@ -29655,7 +36552,7 @@ static void fio___srv_poll_on_ready(void *io_, void *ignr_) {
         FIO_LOG_DDEBUG2("throttled IO %p (fd %d)", (void *)io, io->fd);
       fio_atomic_or(&io->state, FIO_STATE_THROTTLED);
     }
-    fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLOUT);
+    fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLOUT);
   }
 finish:
   fio_free2(io);
@@ -29680,42 +36577,54 @@ static void fio___srv_poll_on_timeout(void *io_, void *ignr_) {
 Event scheduling
 ***************************************************************************** */
 
+/* pushes the collected poll events to the task queue (one lock round-trip). */
+FIO_SFUNC void fio___srv_poll_events_push(fio___srv_reactor_s *r) {
+  if (!r->events)
+    return;
+  fio_queue_push_many(r->lanes + FIO_SRV_LANE_IO, r->event_tasks, r->events);
+  r->events = 0;
+}
+
+/* collects a poll event task, pushing the tasks when the batch is full. */
+FIO_IFUNC void fio___srv_poll_event_add(void (*fn)(void *, void *), void *io) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  r->event_tasks[r->events++] =
+      (fio_queue_task_s){.fn = fn, .udata1 = fio_dup2((fio_s *)io)};
+  if (r->events == FIO___SRV_EVENT_BATCH)
+    fio___srv_poll_events_push(r);
+}
+
 static void fio___srv_poll_on_data_schd(void *io) {
   if (!fio_is_valid(io))
     return;
-  fio_queue_push(fio___srv_tasks,
-                 fio___srv_poll_on_data,
-                 fio_dup2((fio_s *)io));
+  fio___srv_poll_event_add(fio___srv_poll_on_data, io);
 }
 static void fio___srv_poll_on_ready_schd(void *io) {
   if (!fio_is_valid(io))
     return;
-  fio_queue_push(fio___srv_tasks,
-                 fio___srv_poll_on_ready,
-                 fio_dup2((fio_s *)io));
+  fio___srv_poll_event_add(fio___srv_poll_on_ready, io);
 }
 static void fio___srv_poll_on_close_schd(void *io) {
   if (!fio_is_valid(io))
     return;
-  fio_queue_push(fio___srv_tasks,
-                 fio___srv_poll_on_close,
-                 fio_dup2((fio_s *)io));
+  fio___srv_poll_event_add(fio___srv_poll_on_close, io);
 }
 
 /* *****************************************************************************
 Timeout Review
 ***************************************************************************** */
 
-/** Schedules the timeout event for any timed out IO object */
+/** Schedules the timeout event for the reactor's timed out IO objects */
 static int fio___srv_review_timeouts(void) {
   int c = 0;
-  static time_t last_to_review = 0;
+  fio___srv_reactor_s *r = fio___srv_reactor();
   /* test timeouts at whole second intervals */
-  if (last_to_review + 1000 > fio___srvdata.tick)
+  const int64_t now_milli = fio___srv_tick_get();
+  if (r->last_to_review + 1000 > now_milli)
     return c;
-  last_to_review = fio___srvdata.tick;
-  const int64_t now_milli = fio___srvdata.tick;
+  r->last_to_review = now_milli;
 
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_EACH(fio_protocol_s,
                 reserved.protocols,
                 &fio___srvdata.protocols,
@@ -29725,17 +36634,46 @@ static int fio___srv_review_timeouts(void) {
       pr->timeout = FIO_SRV_TIMEOUT_MAX;
     int64_t limit = now_milli - ((int64_t)pr->timeout);
     FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
-      FIO_ASSERT_DEBUG(io->pr == pr, "IO protocol ownership error");
       if (io->active >= limit)
         break;
+      if (io->reactor != r) /* reviewed by the IO's reactor thread */
+        continue;
+      FIO_ASSERT_DEBUG(io->pr == pr, "IO protocol ownership error");
       FIO_LOG_DDEBUG2("scheduling timeout for %p (fd %d)", (void *)io, io->fd);
-      fio_queue_push(fio___srv_tasks, fio___srv_poll_on_timeout, fio_dup2(io));
+      fio_queue_push(r->lanes + FIO_SRV_LANE_BACKGROUND,
+                     fio___srv_poll_on_timeout,
+                     fio_dup2(io));
       ++c;
     }
   }
+  FIO___SRV_IOS_UNLOCK();
   return c;
 }
 
+/* performs a task for each of the reactor's IO objects (outside the lock). */
+FIO_SFUNC size_t fio___srv_reactor_ios_each(void (*task)(void *io, void *)) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  fio_queue_s tasks;
+  size_t count = 0;
+  fio_queue_init(&tasks);
+  FIO___SRV_IOS_LOCK();
+  FIO_LIST_EACH(fio_protocol_s,
+                reserved.protocols,
+                &fio___srvdata.protocols,
+                pr) {
+    FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
+      if (io->reactor != r)
+        continue;
+      fio_queue_push(&tasks, task, fio_dup2(io));
+      ++count;
+    }
+  }
+  FIO___SRV_IOS_UNLOCK();
+  fio_queue_perform_all(&tasks);
+  fio_queue_destroy(&tasks);
+  return count;
+}
+
 /* *****************************************************************************
 Reactor cycling
 ***************************************************************************** */
@@ -29745,23 +36683,35 @@ static void fio___srv_signal_handle(int sig, void *flg) {
 }
 
 FIO_SFUNC void fio___srv_tick(int timeout) {
-  static size_t performed_idle = 0;
-  if (fio_poll_review(&fio___srvdata.poll_data, timeout) > 0) {
-    performed_idle = 0;
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  int64_t now = 0;
+  if (fio___srvdata.busy_poll) {
+    now = fio_time_micro();
+    if (!timeout) {
+      r->busy_since = now;
+    } else if (now - r->busy_since < (int64_t)fio___srvdata.busy_poll) {
+      timeout = 0;
+      fio_atomic_exchange(&r->busy_spinning, 1);
+    } else if (fio_atomic_exchange(&r->busy_spinning, 0)) {
+      timeout = 0; /* tasks deferred while spinning didn't wake the reactor */
+    }
+  }
+  if (fio_poll_review(&r->poll_data, timeout) > 0) {
+    r->performed_idle = 0;
+    r->busy_since = now;
   } else if (timeout) {
-    if (!performed_idle)
+    if (!r->performed_idle && !r->id)
       fio_state_callback_force(FIO_CALL_ON_IDLE);
-    performed_idle = 1;
+    r->performed_idle = 1;
   }
-  fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
-  fio_timer_push2queue(fio___srv_tasks, fio___srv_timer, fio___srvdata.tick);
-  for (size_t i = 0; i < 2048; ++i)
-    if (fio_queue_perform(fio___srv_tasks))
-      break;
-  // fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_poll_events_push(r);
+  fio_timer_push2queue(r->lanes + FIO_SRV_LANE_TIMER,
+                       &r->timer,
+                       fio___srv_tick_update());
+  fio___srv_lanes_perform(FIO_SRV_TICK_BUDGET);
   fio___srv_review_timeouts();
-  // fio_queue_perform_all(fio___srv_tasks);
-  fio_signal_review();
+  if (!r->id)
+    fio_signal_review();
 }
 
 FIO_SFUNC void fio___srv_run_async_as_sync(void *ignr_1, void *ignr_2) {
@@ -29775,80 +36725,208 @@ FIO_SFUNC void fio___srv_run_async_as_sync(void *ignr_1, void *ignr_2) {
     repeat = 1;
   }
   if (repeat)
-    fio_queue_push(fio___srv_tasks, fio___srv_run_async_as_sync);
+    fio_queue_push(fio_srv_queue(), fio___srv_run_async_as_sync);
 }
 
 FIO_SFUNC void fio___srv_shutdown_task(void *shutdown_start_, void *a2) {
   intptr_t shutdown_start = (intptr_t)shutdown_start_;
-  if (shutdown_start + FIO_SRV_SHUTDOWN_TIMEOUT < fio___srvdata.tick ||
-      FIO_LIST_IS_EMPTY(&fio___srvdata.protocols))
+  if (shutdown_start + FIO_SRV_SHUTDOWN_TIMEOUT < fio___srv_tick_get() ||
+      !fio___srv_reactor()->ios)
     return;
-  fio___srv_tick(fio_queue_count(fio___srv_tasks) ? 0 : 100);
-  fio_queue_push(fio___srv_tasks, fio___srv_run_async_as_sync);
-  fio_queue_push(fio___srv_tasks, fio___srv_shutdown_task, shutdown_start_, a2);
+  fio___srv_tick(fio___srv_lanes_count() ? 0 : 100);
+  fio_queue_push(fio_srv_queue(), fio___srv_run_async_as_sync);
+  fio_queue_push(fio_srv_queue(), fio___srv_shutdown_task, shutdown_start_, a2);
+}
+
+FIO_SFUNC void fio___srv_shutdown_io_task(void *io_, void *ignr_) {
+  fio_s *io = (fio_s *)io_;
+  io->pr->on_shutdown(io); /* TODO / FIX: skip close on return value? */
+  fio_close(io);
+  fio_free2(io);
+  (void)ignr_;
+}
+
+FIO_SFUNC void fio___srv_close_now_task(void *io_, void *ignr_) {
+  fio_close_now((fio_s *)io_);
+  fio_free2((fio_s *)io_);
+  (void)ignr_;
 }
 
 FIO_SFUNC void fio___srv_shutdown(void) {
   /* collect tick for shutdown start, to monitor for possible timeout */
-  int64_t shutdown_start = fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
+  int64_t shutdown_start = fio___srv_tick_update();
   size_t connected = 0;
   /* first notify that shutdown is starting */
-  fio_state_callback_force(FIO_CALL_ON_SHUTDOWN);
+  if (!fio___srv_reactor()->id)
+    fio_state_callback_force(FIO_CALL_ON_SHUTDOWN);
   /* preform on_shutdown callback for each connection and close */
-  FIO_LIST_EACH(fio_protocol_s,
-                reserved.protocols,
-                &fio___srvdata.protocols,
-                pr) {
-    FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
-      pr->on_shutdown(io); /* TODO / FIX: move callback to task? */
-      fio_close(io);       /* TODO / FIX: skip close on return value? */
-      ++connected;
-    }
-  }
+  connected = fio___srv_reactor_ios_each(fio___srv_shutdown_io_task);
   FIO_LOG_DEBUG2("Server shutting down with %zu connected clients", connected);
   /* cycle while connections exist. */
-  fio_queue_push(fio___srv_tasks,
+  fio_queue_push(fio_srv_queue(),
                  fio___srv_shutdown_task,
                  (void *)(intptr_t)shutdown_start,
                  NULL);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   /* in case of timeout, force close remaining connections. */
-  connected = 0;
-  FIO_LIST_EACH(fio_protocol_s,
-                reserved.protocols,
-                &fio___srvdata.protocols,
-                pr) {
-    FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
-      fio_close_now(io);
-      ++connected;
-    }
-  }
+  connected = fio___srv_reactor_ios_each(fio___srv_close_now_task);
   FIO_LOG_DEBUG("Server shutdown timed out with %zu clients", connected);
   /* perform remaining tasks. */
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
 }
 
 FIO_SFUNC void fio___srv_work_task(void *ignr_1, void *ignr_2) {
   if (fio___srvdata.stop)
     return;
-  fio___srv_tick(fio_queue_count(fio___srv_tasks) ? 0 : 500);
-  fio_queue_push(fio___srv_tasks, fio___srv_work_task, ignr_1, ignr_2);
+  fio___srv_tick(fio___srv_lanes_count() ? 0 : 500);
+  fio_queue_push(fio_srv_queue(), fio___srv_work_task, ignr_1, ignr_2);
+}
+
+/* runs the calling thread's reactor until the server stops. */
+FIO_SFUNC void fio___srv_reactor_run(void) {
+  fio___srv_wakeup_init();
+  fio_queue_push(fio_srv_queue(), fio___srv_work_task);
+  fio___srv_lanes_perform_all();
+  fio___srv_shutdown();
+  fio___srv_lanes_perform_all();
+}
+
+/* *****************************************************************************
+Reactor Threads
+***************************************************************************** */
+
+FIO_SFUNC void fio___srv_reactor_init(fio___srv_reactor_s *r, uint16_t id) {
+  *r = (fio___srv_reactor_s){
+      .timer = FIO_TIMER_QUEUE_INIT,
+      .wakeup_fd = -1,
+      .id = id,
+  };
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    fio_queue_init(r->lanes + i);
+  fio_poll_init(&r->poll_data,
+                .on_data = fio___srv_poll_on_data_schd,
+                .on_ready = fio___srv_poll_on_ready_schd,
+                .on_close = fio___srv_poll_on_close_schd);
+}
+
+FIO_SFUNC void fio___srv_reactor_destroy(fio___srv_reactor_s *r) {
+  /* perform tasks other threads scheduled after the reactor stopped */
+  fio___srv_reactor_s *caller = fio___srv_current_reactor;
+  fio___srv_current_reactor = r;
+  fio___srv_lanes_perform_all();
+  fio_timer_destroy(&r->timer);
+  fio___srv_lanes_perform_all();
+  fio___srv_current_reactor = caller;
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    fio_queue_destroy(r->lanes + i);
+  fio_poll_destroy(&r->poll_data);
 }
 
+static void *fio___srv_reactor_thread(void *r_) {
+  fio___srv_current_reactor = (fio___srv_reactor_s *)r_;
+  FIO_LOG_DEBUG2("%d reactor thread %d starting.",
+                 (int)fio___srvdata.pid,
+                 (int)fio___srv_current_reactor->id);
+  fio___srv_reactor_run();
+  FIO_LOG_DEBUG2("%d reactor thread %d exiting.",
+                 (int)fio___srvdata.pid,
+                 (int)fio___srv_current_reactor->id);
+  return NULL;
+}
+
+/* starts the reactor threads (the calling thread runs the main reactor). */
+FIO_SFUNC void fio___srv_threads_start(void) {
+  const uint16_t count = fio___srvdata.threads;
+  if (count < 2)
+    return;
+  fio___srvdata.reactors = (fio___srv_reactor_s *)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*fio___srvdata.reactors) * (count - 1), 0);
+  FIO_ASSERT_ALLOC(fio___srvdata.reactors);
+  for (uint16_t i = 1; i < count; ++i)
+    fio___srv_reactor_init(fio___srvdata.reactors + (i - 1), i);
+  fio___srvdata.reactor_count = count;
+  for (uint16_t i = 1; i < count; ++i) {
+    if (!fio_thread_create(&fio___srvdata.reactors[i - 1].thread,
+                           fio___srv_reactor_thread,
+                           (void *)(fio___srvdata.reactors + (i - 1))))
+      continue;
+    FIO_LOG_ERROR("%d couldn't spawn reactor thread, running %d threads.",
+                  (int)fio___srvdata.pid,
+                  (int)i);
+    fio___srvdata.reactor_count = i;
+    break;
+  }
+  FIO_LOG_DEBUG2("%d running %d reactor threads.",
+                 (int)fio___srvdata.pid,
+                 (int)fio___srvdata.reactor_count);
+}
+
+/* joins the reactor threads once they stopped. */
+FIO_SFUNC void fio___srv_threads_join(void) {
+  if (!fio___srvdata.reactors)
+    return;
+  for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+    fio_thread_join(&fio___srvdata.reactors[i - 1].thread);
+  fio___srvdata.reactor_count = 1;
+  for (uint16_t i = 1; i < fio___srvdata.threads; ++i)
+    fio___srv_reactor_destroy(fio___srvdata.reactors + (i - 1));
+  FIO_MEM_FREE_(fio___srvdata.reactors,
+                sizeof(*fio___srvdata.reactors) * (fio___srvdata.threads - 1));
+  fio___srvdata.reactors = NULL;
+}
+
+/** Sets the number of reactor threads each (worker) process runs. */
+SFUNC void fio_srv_threads_set(int threads) {
+  if (fio_srv_is_running()) {
+    FIO_LOG_WARNING("fio_srv_threads_set called while the server is running.");
+    return;
+  }
+  threads = (int)fio_srv_workers(threads);
+  fio___srvdata.threads = (uint16_t)(threads + !threads);
+}
+
+/** Returns the number of reactor threads each (worker) process runs. */
+SFUNC uint16_t fio_srv_threads(void) { return fio___srvdata.threads; }
+
+/** Returns the calling reactor thread's index (0 = main) or -1 if none. */
+SFUNC int fio_srv_thread(void) {
+  return fio___srv_current_reactor ? (int)fio___srv_current_reactor->id : -1;
+}
+
+/* *****************************************************************************
+Starting a Worker
+***************************************************************************** */
+
+#if defined(H___FIO_MALLOC___H)
+/* returns idle cached memory to the system, even if the server stays idle */
+FIO_SFUNC int fio___srv_malloc_cache_decay(void *ignr_1, void *ignr_2) {
+  fio_malloc_cache_decay();
+  return 0;
+  (void)ignr_1, (void)ignr_2;
+}
+#endif /* H___FIO_MALLOC___H */
+
 FIO_SFUNC void fio___srv_work(int is_worker) {
+  fio___srv_current_reactor = fio___srv_main_reactor;
   fio___srvdata.is_worker = is_worker;
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   if (is_worker) {
+    fio___srv_threads_start();
     fio_state_callback_force(FIO_CALL_ON_START);
   }
-  fio___srv_wakeup_init();
-  fio_queue_push(fio___srv_tasks, fio___srv_work_task);
-  fio_queue_perform_all(fio___srv_tasks);
-  fio___srv_shutdown();
-  fio_queue_perform_all(fio___srv_tasks);
+#if defined(H___FIO_MALLOC___H)
+  if (fio_malloc_cache_decay_time())
+    fio_srv_run_every(.fn = fio___srv_malloc_cache_decay,
+                      .every = (uint32_t)(fio_malloc_cache_decay_time() >> 1) |
+                               1,
+                      .repetitions = -1);
+#endif /* H___FIO_MALLOC___H */
+  fio___srv_reactor_run();
+  fio___srv_threads_join();
   fio_state_callback_force(FIO_CALL_ON_FINISH);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   fio___srvdata.workers = 0;
+  fio___srv_current_reactor = NULL;
 }
 
 /* *****************************************************************************
@@ -29885,7 +36963,7 @@ static void *fio___srv_worker_sentinel(void *pid_data) {
                               fio___srv_wait_for_worker,
                               (void *)thr);
     fio_thread_detach(&thr);
-    fio_queue_push(fio___srv_tasks, fio___srv_spawn_worker, (void *)thr);
+    fio_queue_push(fio_srv_queue(), fio___srv_spawn_worker, (void *)thr);
   }
 #else /* Non POSIX? no `fork`? no fio_thread_waitpid? */
   FIO_ASSERT(
@@ -29907,7 +36985,7 @@ static void fio___srv_spawn_worker(void *ignr_1, void *ignr_2) {
 
   fio_state_callback_force(FIO_CALL_BEFORE_FORK);
   /* do not allow master tasks to run in worker */
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   /* perform actual fork */
   fio_thread_pid_t pid = fio_thread_fork();
   FIO_ASSERT(pid != (fio_thread_pid_t)-1, "system call `fork` failed.");
@@ -29923,7 +37001,7 @@ static void fio___srv_spawn_worker(void *ignr_1, void *ignr_2) {
     fio_srv_stop();
   }
   if (!fio_atomic_xor_fetch(&fio___srvdata.stop, 2))
-    fio_queue_push(fio___srv_tasks, fio___srv_work_task);
+    fio_queue_push(fio_srv_queue(), fio___srv_work_task);
   return;
 
 is_worker_process:
@@ -29983,7 +37061,7 @@ SFUNC void fio_srv_start(int workers) {
   fio___srvdata.is_worker = !workers;
   fio_sock_maximize_limits(0);
   fio_state_callback_force(FIO_CALL_PRE_START);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   fio_signal_monitor(SIGINT,
                      fio___srv_signal_handle,
                      (void *)&fio___srvdata.stop);
@@ -29993,7 +37071,7 @@ SFUNC void fio_srv_start(int workers) {
 #ifdef SIGPIPE
   fio_signal_monitor(SIGPIPE, NULL, NULL);
 #endif
-  fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
+  fio___srv_tick_update();
   if (workers) {
     FIO_LOG_INFO("%d spawning %d workers.", fio___srvdata.root_pid, workers);
     for (int i = 0; i < workers; ++i) {
@@ -30009,7 +37087,7 @@ SFUNC void fio_srv_start(int workers) {
 #ifdef SIGPIPE
   fio_signal_forget(SIGPIPE);
 #endif
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
 }
 
 /* *****************************************************************************
@@ -30022,15 +37100,19 @@ SFUNC int fio_fd_get(fio_s *io) { return io->fd; }
 FIO_SFUNC void fio_touch___task(void *io_, void *ignr_) {
   (void)ignr_;
   fio_s *io = (fio_s *)io_;
-  io->active = fio___srvdata.tick;
+  FIO___SRV_IOS_LOCK();
+  io->active = fio___srv_tick_get();
   FIO_LIST_REMOVE(&io->node);
   FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
+  FIO___SRV_IOS_UNLOCK();
   fio_free2(io);
 }
 
 /* Resets a socket's timeout counter. */
 SFUNC void fio_touch(fio_s *io) {
-  fio_queue_push_urgent(fio___srv_tasks, fio_touch___task, fio_dup(io));
+  fio_queue_push_urgent(io->reactor->lanes + FIO_SRV_LANE_USER,
+                        fio_touch___task,
+                        fio_dup(io));
 }
 
 /**
@@ -30042,9 +37124,15 @@ SFUNC void fio_touch(fio_s *io) {
 SFUNC size_t fio_read(fio_s *io, void *buf, size_t len) {
   ssize_t r = io->pr->io_functions.read(io->fd, buf, len, io->tls);
   if (r > 0) {
+    /* a short socket read drained the socket (TLS may buffer more data) */
+    if ((size_t)r < len &&
+        io->pr->io_functions.read == fio___io_func_default_read)
+      fio_poll_would_block(&io->reactor->poll_data, io->fd, POLLIN);
     fio_touch(io);
     return r;
   }
+  if ((r == -1) & ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    fio_poll_would_block(&io->reactor->poll_data, io->fd, POLLIN);
   if ((!len) | ((r == -1) & ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
                              (errno == EINTR))))
     return 0;
@@ -30066,7 +37154,7 @@ FIO_SFUNC void fio_write2___task(void *io_, void *packet_) {
   if (!(io->state & FIO_STATE_OPEN))
     goto io_error;
   fio_stream_add(&io->stream, packet);
-  fio_queue_push(fio___srv_tasks,
+  fio_queue_push(io->reactor->lanes + FIO_SRV_LANE_USER,
                  fio___srv_poll_on_ready,
                  io); /* no dup/undup, already done.*/
   return;
@@ -30096,7 +37184,11 @@ SFUNC void fio_write2 FIO_NOOP(fio_s *io, fio_write_args_s args) {
     goto error;
   if ((io->state & FIO_STATE_CLOSING))
     goto write_called_after_close;
-  fio_srv_defer(fio_write2___task, fio_dup2(io), packet);
+  fio___srv_defer_to(io->reactor,
+                     FIO_SRV_LANE_USER,
+                     fio_write2___task,
+                     fio_dup2(io),
+                     packet);
   return;
 error: /* note: `dealloc` is called by the `fio_stream` API error handler. */
   FIO_LOG_ERROR("couldn't create %zu bytes long user-packet for IO %p (%d)",
@@ -30112,7 +37204,7 @@ write_called_after_close:
       void (*fn)(fio_stream_packet_s *);
     } u = {.fn = fio_stream_pack_free};
     // u.fn(packet);
-    fio_queue_push(fio___srv_tasks, fio_write2___dealloc_task, u.ptr, packet);
+    fio_queue_push(fio_srv_queue(), fio_write2___dealloc_task, u.ptr, packet);
   }
   return;
 io_error_null:
@@ -30124,7 +37216,7 @@ io_error_null:
       void (*fn)(void *);
     } u = {.fn = args.dealloc};
     // u.fn(args.buf);
-    fio_queue_push(fio___srv_tasks, fio_write2___dealloc_task, u.ptr, args.buf);
+    fio_queue_push(fio_srv_queue(), fio_write2___dealloc_task, u.ptr, args.buf);
   }
 }
 
@@ -30134,9 +37226,11 @@ SFUNC void fio_close(fio_s *io) {
       !(fio_atomic_or(&io->state, (FIO_STATE_CLOSING | FIO_STATE_CLOSE_LOCAL)) &
         FIO_STATE_CLOSING)) {
     FIO_LOG_DDEBUG2("scheduling IO %p (fd %d) for closure", (void *)io, io->fd);
-    fio_queue_push(fio___srv_tasks,
-                   fio___srv_poll_on_ready,
-                   fio_dup2((fio_s *)io));
+    fio___srv_defer_to(io->reactor,
+                       FIO_SRV_LANE_USER,
+                       fio___srv_poll_on_ready,
+                       fio_dup2((fio_s *)io),
+                       NULL);
   }
 }
 
@@ -30154,7 +37248,7 @@ SFUNC void fio_srv_suspend(fio_s *io) { io->state |= FIO_STATE_SUSPENDED; }
 SFUNC void fio_srv_unsuspend(fio_s *io) {
   if ((fio_atomic_and(&io->state, ~FIO_STATE_SUSPENDED) &
        FIO_STATE_SUSPENDED)) {
-    fio_poll_monitor(&fio___srvdata.poll_data, io->fd, (void *)io, POLLIN);
+    fio_poll_monitor(&io->reactor->poll_data, io->fd, (void *)io, POLLIN);
   }
 }
 
@@ -30183,7 +37277,7 @@ static void fio___srv_listen2_on_data_task(void *io_, void *ignr_) {
   fio_free2(io);
 }
 static void fio___srv_listen_on_data_task_reschd(void *io_, void *ignr_) {
-  fio_queue_push(fio___srv_tasks, fio___srv_listen2_on_data_task, io_, ignr_);
+  fio_queue_push(fio_srv_queue(), fio___srv_listen2_on_data_task, io_, ignr_);
 }
 
 static void fio___srv_listen2_on_data(fio_s *io) {
@@ -30339,6 +37433,8 @@ typedef struct {
   size_t ref_count;
   size_t url_len;
   uint8_t hide_from_log;
+  uint8_t on_root;
+  uint8_t reuseport;
   char url[];
 } fio___srv_listen_s;
 
@@ -30349,18 +37445,20 @@ static fio___srv_listen_s *fio___srv_listen_dup(fio___srv_listen_s *l) {
   return l;
 }
 
-static void fio___srv_listen_free(void *l_) {
-  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
-  fio_close(l->io);
+static void fio___srv_listen_free(void *l_);
+FIO_SFUNC void fio___srv_listen_attach_task(void *l_);
+
+/* drops a reference, cleaning up once the last reference was dropped. */
+static void fio___srv_listen_unref(fio___srv_listen_s *l) {
   if (fio_atomic_sub(&l->ref_count, 1))
     return;
 
   fio_state_callback_remove(FIO_CALL_AT_EXIT, fio___srv_listen_free, (void *)l);
   fio_state_callback_remove(FIO_CALL_ON_START,
-                            fio___srv_listen_free,
+                            fio___srv_listen_attach_task,
                             (void *)l);
   fio_state_callback_remove(FIO_CALL_PRE_START,
-                            fio___srv_listen_free,
+                            fio___srv_listen_attach_task,
                             (void *)l);
   fio___io_func_free_context_caller(l->protocol->io_functions.free_context,
                                     l->tls_ctx);
@@ -30388,11 +37486,54 @@ static void fio___srv_listen_free(void *l_) {
                  getpid(),
                  (int)l->url_len,
                  l->url);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   FIO___LEAK_COUNTER_ON_FREE(fio_srv_listen);
   FIO_MEM_FREE_(l, sizeof(*l) + l->url_len + 1);
 }
 
+static void fio___srv_listen_on_data(fio_s *io);
+
+static void fio___srv_listen_thread_on_close(void *l) {
+  fio___srv_listen_unref((fio___srv_listen_s *)l);
+}
+
+static fio_protocol_s FIO___LISTEN_THREAD_PROTOCOL = {
+    .on_data = fio___srv_listen_on_data,
+    .on_close = fio___srv_listen_thread_on_close,
+    .on_timeout = fio___srv_on_timeout_never,
+};
+
+/* closes the calling reactor's listening IO(s) for the listener. */
+FIO_SFUNC void fio___srv_listen_thread_stop_task(void *l_, void *ignr_) {
+  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  FIO___SRV_IOS_LOCK();
+  if (FIO___LISTEN_THREAD_PROTOCOL.reserved.ios.next) {
+    FIO_LIST_EACH(fio_s,
+                  node,
+                  &FIO___LISTEN_THREAD_PROTOCOL.reserved.ios,
+                  io) {
+      if (io->reactor == r && io->udata == l)
+        fio_close(io);
+    }
+  }
+  FIO___SRV_IOS_UNLOCK();
+  fio___srv_listen_unref(l);
+  (void)ignr_;
+}
+
+static void fio___srv_listen_free(void *l_) {
+  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
+  fio_close(l->io);
+  for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+    fio___srv_defer_to(fio___srvdata.reactors + (i - 1),
+                       FIO_SRV_LANE_USER,
+                       fio___srv_listen_thread_stop_task,
+                       fio___srv_listen_dup(l),
+                       NULL);
+  fio___srv_listen_unref(l);
+}
+
 SFUNC void fio_srv_listen_stop(void *listener) {
   if (listener)
     fio___srv_listen_free(listener);
@@ -30403,13 +37544,19 @@ static void fio___srv_listen_on_data_task(void *io_, void *ignr_) {
   fio_s *io = (fio_s *)io_;
   int fd;
   fio___srv_listen_s *l = (fio___srv_listen_s *)(io->udata);
-  while ((fd = accept(fio_fd_get(io), NULL, NULL)) != -1) {
+  while ((fd = fio_poll_accept(&io->reactor->poll_data, fio_fd_get(io))) !=
+         -1) {
+    fio___srv_busy_poll_sock(fd);
     fio_srv_attach_fd(fd, l->protocol, l->udata, l->tls_ctx);
   }
   fio_free2(io);
 }
 static void fio___srv_listen_on_data_task_reschd(void *io_, void *ignr_) {
-  fio_srv_defer(fio___srv_listen_on_data_task, io_, ignr_);
+  fio___srv_defer_to(((fio_s *)io_)->reactor,
+                     FIO_SRV_LANE_USER,
+                     fio___srv_listen_on_data_task,
+                     io_,
+                     ignr_);
 }
 
 static void fio___srv_listen_on_data(fio_s *io) {
@@ -30433,6 +37580,30 @@ static fio_protocol_s FIO___LISTEN_PROTOCOL = {
     .on_timeout = fio___srv_on_timeout_never,
 };
 
+/* attaches a listening socket to the calling (non-main) reactor thread. */
+FIO_SFUNC void fio___srv_listen_thread_attach_task(void *l_, void *ignr_) {
+  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
+  int fd = -1;
+  if (l->reuseport) /* the kernel balances connections between the sockets */
+    fd = fio_sock_open2(l->url,
+                        FIO_SOCK_SERVER | FIO_SOCK_TCP | FIO_SOCK_REUSEPORT);
+  if (fd == -1) /* no SO_REUSEPORT - threads share the same socket */
+    fd = fio_sock_dup(l->fd);
+  if (fd == -1)
+    FIO_LOG_ERROR("%d reactor thread %d couldn't listen @ %s",
+                  (int)fio___srvdata.pid,
+                  fio_srv_thread(),
+                  l->url);
+  else
+    FIO_LOG_DEBUG2("%d reactor thread %d listening @ %s (fd %d)",
+                   (int)fio___srvdata.pid,
+                   fio_srv_thread(),
+                   l->url,
+                   fd);
+  fio_srv_attach_fd(fd, &FIO___LISTEN_THREAD_PROTOCOL, l, NULL);
+  (void)ignr_;
+}
+
 FIO_SFUNC void fio___srv_listen_attach_task_deferred(void *l_, void *ignr_) {
   fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
   l = fio___srv_listen_dup(l);
@@ -30443,6 +37614,13 @@ FIO_SFUNC void fio___srv_listen_attach_task_deferred(void *l_, void *ignr_) {
                  l->fd,
                  fd);
   l->io = fio_srv_attach_fd(fd, &FIO___LISTEN_PROTOCOL, l, NULL);
+  if (!l->on_root)
+    for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+      fio___srv_defer_to(fio___srvdata.reactors + (i - 1),
+                         FIO_SRV_LANE_USER,
+                         fio___srv_listen_thread_attach_task,
+                         fio___srv_listen_dup(l),
+                         NULL);
   if (l->on_start)
     l->on_start(l->protocol, l->udata);
   if (l->hide_from_log)
@@ -30453,8 +37631,8 @@ FIO_SFUNC void fio___srv_listen_attach_task_deferred(void *l_, void *ignr_) {
 }
 
 FIO_SFUNC void fio___srv_listen_attach_task(void *l_) {
-  /* make sure to run in server thread */
-  fio_srv_defer(fio___srv_listen_attach_task_deferred, l_, NULL);
+  /* make sure to run in the main reactor thread */
+  fio_srv_defer_main(fio___srv_listen_attach_task_deferred, l_, NULL);
 }
 
 int fio_srv_listen___(void); /* IDE marker */
@@ -30529,19 +37707,24 @@ SFUNC void *fio_srv_listen FIO_NOOP(struct fio_srv_listen_args args) {
       .owner = fio___srvdata.pid,
       .url_len = url_buf.len,
       .hide_from_log = args.hide_from_log,
+      .on_root = !!args.on_root,
+      .reuseport = (fio___srvdata.threads > 1 && !args.on_root &&
+                    url.port.len),
   };
   FIO_MEMCPY(l->url, url_buf.buf, url_buf.len);
   l->url[l->url_len] = 0;
   if (should_free_tls)
     fio_tls_free(args.tls);
 
-  l->fd = fio_sock_open2(l->url, FIO_SOCK_SERVER | FIO_SOCK_TCP);
+  l->fd = fio_sock_open2(l->url,
+                         FIO_SOCK_SERVER | FIO_SOCK_TCP |
+                             (l->reuseport ? FIO_SOCK_REUSEPORT : 0));
   if (l->fd == -1) {
     fio___srv_listen_free(l);
     return (l = NULL);
   }
   if (fio_srv_is_running()) {
-    fio_srv_defer(fio___srv_listen_attach_task_deferred, l, NULL);
+    fio_srv_defer_main(fio___srv_listen_attach_task_deferred, l, NULL);
   } else {
     fio_state_callback_add(
         (args.on_root ? FIO_CALL_PRE_START : FIO_CALL_ON_START),
@@ -30645,22 +37828,23 @@ Managing data after a fork
 FIO_SFUNC void fio___srv_after_fork(void *ignr_) {
   (void)ignr_;
   fio___srvdata.pid = fio_thread_getpid();
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   FIO_LIST_EACH(fio_protocol_s,
                 reserved.protocols,
                 &fio___srvdata.protocols,
                 pr) {
     FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) { fio_close_now(io); }
   }
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   fio_invalidate_all();
-  fio_queue_perform_all(fio___srv_tasks);
-  fio_queue_destroy(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    fio_queue_destroy(fio___srv_main_reactor->lanes + i);
 }
 
 FIO_SFUNC void fio___srv_cleanup_at_exit(void *ignr_) {
   fio___srv_after_fork(ignr_);
-  fio_poll_destroy(&fio___srvdata.poll_data);
+  fio_poll_destroy(&fio___srv_main_reactor->poll_data);
   fio___srv_env_safe_destroy(&fio___srvdata.env);
 }
 
@@ -30668,17 +37852,15 @@ FIO_SFUNC void fio___srv_cleanup_at_exit(void *ignr_) {
 Initializing Server State
 ***************************************************************************** */
 FIO_CONSTRUCTOR(fio___srv) {
-  fio_queue_init(fio___srv_tasks);
+  fio___srv_reactor_init(fio___srv_main_reactor, 0);
   fio___srvdata.protocols = FIO_LIST_INIT(fio___srvdata.protocols);
-  fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
+  fio___srv_tick_update();
   fio___srvdata.root_pid = fio___srvdata.pid = fio_thread_getpid();
   fio___srvdata.async = FIO_LIST_INIT(fio___srvdata.async);
-  fio_poll_init(&fio___srvdata.poll_data,
-                .on_data = fio___srv_poll_on_data_schd,
-                .on_ready = fio___srv_poll_on_ready_schd,
-                .on_close = fio___srv_poll_on_close_schd);
+  fio_srv_threads_set(FIO_SRV_THREADS);
   fio___srv_init_protocol_test(&FIO___MOCK_PROTOCOL, 0);
   fio___srv_init_protocol_test(&FIO___LISTEN_PROTOCOL, 0);
+  fio___srv_init_protocol_test(&FIO___LISTEN_THREAD_PROTOCOL, 0);
   fio_state_callback_add(FIO_CALL_IN_CHILD, fio___srv_after_fork, NULL);
   fio_state_callback_add(FIO_CALL_AT_EXIT, fio___srv_cleanup_at_exit, NULL);
 }
@@ -31094,6 +38276,7 @@ SFUNC fio_io_functions_s fio_tls_default_io_functions(fio_io_functions_s *f) {
       .start = fio___srv_on_ev_mock,
       .read = fio___io_func_default_read,
       .write = fio___io_func_default_write,
+      .writev = fio___io_func_default_writev,
       .flush = fio___io_func_default_flush,
       .finish = fio___io_func_default_finish,
       .cleanup = fio___srv_on_close_mock,
@@ -31108,6 +38291,8 @@ SFUNC fio_io_functions_s fio_tls_default_io_functions(fio_io_functions_s *f) {
     f->read = fio___io_func_default_read;
   if (!f->write)
     f->write = fio___io_func_default_write;
+  if (!f->writev && f->write == fio___io_func_default_write)
+    f->writev = fio___io_func_default_writev;
   if (!f->flush)
     f->flush = fio___io_func_default_flush;
   if (!f->finish)
@@ -31135,7 +38320,7 @@ failed:
 }
 FIO_SFUNC void fio___srv_async_finish(void *q_) {
   fio_srv_async_s *q = (fio_srv_async_s *)q_;
-  q->q = fio___srv_tasks;
+  q->q = fio___srv_main_reactor->lanes + FIO_SRV_LANE_USER;
   fio_queue_workers_stop(&q->queue);
   fio_queue_perform_all(&q->queue);
   fio_queue_destroy(&q->queue);
@@ -32269,6 +39454,10 @@ FIO_SFUNC void fio___pubsub_message_on_destroy(fio___pubsub_message_s *m);
 #define FIO_REF_NAME             fio___pubsub_message
 #define FIO_REF_DESTROY(obj)     fio___pubsub_message_on_destroy(&(obj))
 #define FIO_REF_FLEX_TYPE        char
+#if FIO_USE_POOL
+#define FIO_REF_POOL      0
+#define FIO_REF_POOL_FLEX 512 /* small messages are pooled */
+#endif
 #define FIO_REF_CONSTRUCTOR_ONLY 1
 #define FIO___RECURSIVE_INCLUDE  1
 #include FIO_INCLUDE_FILE
@@ -32803,10 +39992,7 @@ FIO_IFUNC void fio___pubsub_subscription_unsubscribe(fio_subscription_s *s) {
   if (!s)
     return;
   s->on_message = fio___subscription_mock_cb;
-  fio_queue_push(fio_srv_queue(),
-                 fio___pubsub_unsubscribe_task,
-                 (void *)s,
-                 NULL);
+  fio_srv_defer_main(fio___pubsub_unsubscribe_task, (void *)s, NULL);
 }
 
 /** Subscribes to a named channel in the numerical filter's namespace. */
@@ -32842,7 +40028,7 @@ SFUNC void fio_subscribe FIO_NOOP(fio_subscribe_args_s args) {
       args.channel.len,
       FIO___PUBSUB_CHANNEL_ENCODE_CAPA(args.filter, args.is_pattern));
 
-  fio_srv_defer(fio___pubsub_subscribe_task, (void *)s, NULL);
+  fio_srv_defer_main(fio___pubsub_subscribe_task, (void *)s, NULL);
 
   if (args.master_only && !args.io)
     goto is_master_only;
@@ -32950,6 +40136,14 @@ FIO_IFUNC void fio___subscription_on_message_task(void *s_, void *m_) {
   fio___pubsub_message_free(m);
   return;
 reschedule:
+  if (s->io) { /* IO bound callbacks are performed by the IO's reactor */
+    fio___srv_defer_to(s->io->reactor,
+                       FIO_SRV_LANE_USER,
+                       fio___subscription_on_message_task,
+                       s_,
+                       m_);
+    return;
+  }
   fio_queue_push(fio_srv_queue(), fio___subscription_on_message_task, s_, m_);
 }
 
@@ -32963,53 +40157,77 @@ SFUNC void fio_pubsub_message_defer(fio_msg_s *msg) {
   ((uintptr_t *)(msg + 1))[1] = 1;
 }
 
+/* subscription tasks are pushed to the queue in batches of this size */
+#define FIO___PUBSUB_DELIVERY_BATCH 32
+
+typedef struct {
+  size_t count;
+  fio_queue_task_s tasks[FIO___PUBSUB_DELIVERY_BATCH];
+} fio___pubsub_delivery_s;
+
+/* pushes the collected subscription tasks to the queue. */
+FIO_IFUNC void fio___pubsub_delivery_push(fio___pubsub_delivery_s *d) {
+  if (!d->count)
+    return;
+  fio_queue_push_many(fio_srv_queue(), d->tasks, d->count);
+  d->count = 0;
+}
+
+/* collects a subscription task, pushing the tasks when the batch is full. */
+FIO_IFUNC void fio___pubsub_delivery_add(fio___pubsub_delivery_s *d,
+                                         fio_subscription_s *s,
+                                         fio___pubsub_message_s *m) {
+  if (s->io && s->io->reactor != fio___srv_reactor()) {
+    /* IO bound callbacks are performed by the IO's reactor (thread) */
+    fio___srv_defer_to(s->io->reactor,
+                       FIO_SRV_LANE_USER,
+                       fio___subscription_on_message_task,
+                       fio_subscription_dup(s),
+                       fio___pubsub_message_dup(m));
+    return;
+  }
+  d->tasks[d->count++] = (fio_queue_task_s){
+      .fn = (void (*)(void *, void *))fio___subscription_on_message_task,
+      .udata1 = fio_subscription_dup(s),
+      .udata2 = fio___pubsub_message_dup(m)};
+  if (d->count == FIO___PUBSUB_DELIVERY_BATCH)
+    fio___pubsub_delivery_push(d);
+}
+
 /* distributes a message to all of a channel's subscribers */
 FIO_SFUNC void fio___pubsub_channel_deliver_task(void *ch_, void *m_) {
   fio_channel_s *ch = (fio_channel_s *)ch_;
   fio___pubsub_message_s *m = (fio___pubsub_message_s *)m_;
+  fio___pubsub_delivery_s d;
   FIO_LIST_HEAD *head = (&ch->subscriptions);
   _Bool is_history = !!(m->data.is_json & FIO___PUBSUB_REPLAY);
   head += is_history;
+  d.count = 0;
   if (m->data.io) { /* move as many `if` statements as possible out of loops. */
     if (is_history) {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
         if (m->data.io != s->io && m->data.published >= s->replay_since)
-          fio_queue_push(
-              fio_srv_queue(),
-              (void (*)(void *, void *))fio___subscription_on_message_task,
-              fio_subscription_dup(s),
-              fio___pubsub_message_dup(m));
+          fio___pubsub_delivery_add(&d, s, m);
       }
     } else {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
         if (m->data.io != s->io)
-          fio_queue_push(
-              fio_srv_queue(),
-              (void (*)(void *, void *))fio___subscription_on_message_task,
-              fio_subscription_dup(s),
-              fio___pubsub_message_dup(m));
+          fio___pubsub_delivery_add(&d, s, m);
       }
     }
   } else {
     if (is_history) {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
         if (m->data.published >= s->replay_since)
-          fio_queue_push(
-              fio_srv_queue(),
-              (void (*)(void *, void *))fio___subscription_on_message_task,
-              fio_subscription_dup(s),
-              fio___pubsub_message_dup(m));
+          fio___pubsub_delivery_add(&d, s, m);
       }
     } else {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
-        fio_queue_push(
-            fio_srv_queue(),
-            (void (*)(void *, void *))fio___subscription_on_message_task,
-            fio_subscription_dup(s),
-            fio___pubsub_message_dup(m));
+        fio___pubsub_delivery_add(&d, s, m);
       }
     }
   }
+  fio___pubsub_delivery_push(&d);
   fio___pubsub_message_free(m);
   fio_channel_free(ch);
 }
@@ -33356,7 +40574,7 @@ void fio_publish FIO_NOOP(fio_publish_args_s args) {
   m = fio___pubsub_message_author(args);
   m->data.is_json = ((!!args.is_json) | ((uint8_t)(uintptr_t)args.engine));
 
-  fio_srv_defer(fio___publish_message_task, m, NULL);
+  fio_srv_defer_main(fio___publish_message_task, m, NULL);
   return;
 
 external_engine:
@@ -33369,7 +40587,7 @@ external_engine:
   m->data.is_json = ((!!args.is_json) | ((uint8_t)FIO___PUBSUB_FORWARDER));
   FIO_MEMCPY(m->data.message.buf, msg.message.buf, msg.message.len);
   fio_u2buf64u(m->data.message.buf + msg.message.len, (uintptr_t)args.engine);
-  fio_srv_defer(fio___publish_message_task, m, NULL);
+  fio_srv_defer_main(fio___publish_message_task, m, NULL);
 }
 
 /* *****************************************************************************
@@ -33537,12 +40755,12 @@ FIO_SFUNC void fio___pubsub_detach_task(void *engine, void *ignr_) {
 SFUNC void fio_pubsub_attach(fio_pubsub_engine_s *engine) {
   if (!engine)
     return;
-  fio_srv_defer(fio___pubsub_attach_task, engine, NULL);
+  fio_srv_defer_main(fio___pubsub_attach_task, engine, NULL);
 }
 
 /** Schedules an engine for Detachment, so it could be safely destroyed. */
 SFUNC void fio_pubsub_detach(fio_pubsub_engine_s *engine) {
-  fio_queue_push(fio_srv_queue(), fio___pubsub_detach_task, engine, NULL);
+  fio_srv_defer_main(fio___pubsub_detach_task, engine, NULL);
 }
 
 /* *****************************************************************************
@@ -35093,6 +42311,9 @@ struct fio_http_s {
     .received_at = fio_http_get_timestump(), .body.fd = -1                     \
   }
 #define FIO_REF_DESTROY(h) fio_http_destroy(&(h))
+#if FIO_USE_POOL
+#define FIO_REF_POOL 0
+#endif
 SFUNC fio_http_s *fio_http_destroy(fio_http_s *h) {
   if (!h)
     return h;
@@ -38651,7 +45872,7 @@ SFUNC void *fio_http_listen FIO_NOOP(const char *url, fio_http_settings_s s) {
                             ? fio___http_on_http_with_public_folder
                             : fio___http_on_http_direct;
   p->settings.public_folder.buf = p->public_folder_buf;
-  p->queue = p->settings.queue ? p->settings.queue->q : fio_srv_queue();
+  p->queue = p->settings.queue ? p->settings.queue->q : NULL;
   if (s.public_folder.len)
     FIO_MEMCPY(p->public_folder_buf, s.public_folder.buf, s.public_folder.len);
   void *listener =
@@ -38660,7 +45881,7 @@ SFUNC void *fio_http_listen FIO_NOOP(const char *url, fio_http_settings_s s) {
                      .tls = s.tls,
                      // .on_open = fio___http_on_open,
                      .on_finish = fio___http_listen_on_finished,
-                     .queue_for_accept = p->queue ? p->queue : NULL);
+                     .queue_for_accept = p->queue);
   return listener;
 }
 
@@ -38743,7 +45964,7 @@ SFUNC fio_s *fio_http_connect FIO_NOOP(const char *url,
   p->settings.public_folder.buf = p->public_folder_buf;
   p->settings.public_folder.len = 0;
   p->settings.public_folder.buf[0] = 0;
-  p->queue = p->settings.queue ? p->settings.queue->q : fio_srv_queue();
+  p->queue = p->settings.queue ? p->settings.queue->q : NULL;
   p->on_http_callback = fio___http_on_http_client;
   fio___http_connection_s *c =
       fio___http_connection_new(p->settings.max_line_len);
@@ -38752,7 +45973,7 @@ SFUNC fio_s *fio_http_connect FIO_NOOP(const char *url,
       .io = NULL,
       .h = h,
       .settings = &(p->settings),
-      .queue = p->queue,
+      .queue = (p->queue ? p->queue : fio_srv_queue()),
       .udata = p->settings.udata,
       .state.http =
           {
@@ -38949,7 +46170,7 @@ FIO_SFUNC void fio___http_on_attach_accept(fio_s *io) {
   FIO_ASSERT_ALLOC(c);
   *c = (fio___http_connection_s){
       .settings = &(p->settings),
-      .queue = p->queue,
+      .queue = (p->queue ? p->queue : fio_srv_queue()),
       .udata = p->settings.udata,
       .io = io,
       .state.http =
@@ -42337,6 +49558,7 @@ Common cleanup
 #undef FIO_MEM_FREE_
 #undef FIO_MEM_REALLOC_IS_SAFE_
 #undef FIO_MEMORY_NAME /* postponed due to possible use in macros */
+#undef FIO_REGION_NAME /* postponed due to possible use in macros */
 
 #undef FIO___LOCK_TYPE
 #undef FIO___LOCK_INIT
@@ -42431,6 +49653,7 @@ Memory Allocator Tests
 #undef FIO_MEMORY_USE_THREAD_MUTEX
 #define FIO_MEMORY_USE_THREAD_MUTEX 0
 #define FIO_MEMORY_ARENA_COUNT      4
+#define FIO_MEMORY_CACHE_DECAY      1000
 #include FIO_INCLUDE_FILE
 
 #define FIO_MEMORY_NAME                   fio_mem_test_unsafe
@@ -42438,6 +49661,25 @@ Memory Allocator Tests
 #undef FIO_MEMORY_USE_THREAD_MUTEX
 #define FIO_MEMORY_USE_THREAD_MUTEX 0
 #define FIO_MEMORY_ARENA_COUNT      4
+#define FIO_MEMORY_NUMA             1
+#include FIO_INCLUDE_FILE
+
+#define FIO_MEMORY_NAME                   fio_mem_test_tcache
+#define FIO_MEMORY_INITIALIZE_ALLOCATIONS 1
+#undef FIO_MEMORY_USE_THREAD_MUTEX
+#define FIO_MEMORY_USE_THREAD_MUTEX 0
+#define FIO_MEMORY_ARENA_COUNT      2
+#define FIO_MEMORY_THREAD_CACHE     1
+#define FIO_MEMORY_HUGE_PAGES       1
+#include FIO_INCLUDE_FILE
+
+#define FIO_MEMORY_NAME                   fio_mem_test_slab
+#define FIO_MEMORY_INITIALIZE_ALLOCATIONS 1
+#undef FIO_MEMORY_USE_THREAD_MUTEX
+#define FIO_MEMORY_USE_THREAD_MUTEX 0
+#define FIO_MEMORY_ARENA_COUNT      2
+#define FIO_MEMORY_SLAB_LIMIT       256
+#define FIO_MEMORY_PROFILE          4096
 #include FIO_INCLUDE_FILE
 
 #undef FIO___TEST_REINCLUDE
@@ -45042,6 +52284,106 @@ FIO_SFUNC void FIO_NAME_TEST(stl, memalt)(void) {
       FIO_ASSERT(len == i, "fio_strlen failed.");
     }
   }
+  { /* test all alignments and tail lengths (SIMD kernels) against libc */
+    char a[1024 + 64], b[1024 + 64];
+    memset(a, 0x80, sizeof(a));
+    for (size_t offset = 0; offset < 64; ++offset) {
+      for (size_t len = 0; len < 1024 - offset; len += 1 + (len > 300) * 7) {
+        char *s = a + offset;
+        s[len] = 0;
+        FIO_ASSERT(fio_strlen(s) == len,
+                   "fio_strlen failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        FIO_ASSERT(fio_memchr(s, 0, len + 1) == s + len &&
+                       !fio_memchr(s, 0, len),
+                   "fio_memchr failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        s[len] = (char)0x80;
+        fio_memcpy(b + (offset ^ 63), s, len);
+        FIO_ASSERT(!memcmp(b + (offset ^ 63), s, len) &&
+                       !fio_memcmp(b + (offset ^ 63), s, len),
+                   "fio_memcpy / fio_memcmp failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        if (!len)
+          continue;
+        b[(offset ^ 63) + (len >> 1)] = 1;
+        FIO_ASSERT(fio_memcmp(b + (offset ^ 63), s, len) < 0 &&
+                       fio_memcmp(s, b + (offset ^ 63), len) > 0,
+                   "fio_memcmp order failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        b[(offset ^ 63) + (len >> 1)] = (char)0x80;
+      }
+    }
+  }
+  { /* test fio_memchr2, fio_memchr3, fio_memchr_class and fio_memmem */
+    fprintf(stderr, "* Testing multi-token seeking (memchr2/3, class, memmem).\n");
+    char buf[640];
+    uint8_t table[256] = {0};
+    fio_byte_class_s cls, wide;
+    table[' '] = table['\r'] = table['\n'] = table[':'] = table[0xF1] = 1;
+    fio_byte_class_init(&cls, table);
+    FIO_ASSERT(cls.nibbles, "a small byte class should use nibble tables");
+    for (size_t i = 0; i < 256; i += 15)
+      table[i] = 1; /* too many distinct rows for nibble tables */
+    fio_byte_class_init(&wide, table);
+    FIO_ASSERT(!wide.nibbles, "a wide byte class can't use nibble tables");
+    for (size_t round = 0; round < 512; ++round) {
+      const size_t len = (size_t)(fio_rand64() % (sizeof(buf) - 64));
+      const size_t offset = round & 63;
+      char *s = buf + offset;
+      for (size_t i = 0; i < len; ++i) /* lower case letters, few matches */
+        s[i] = (char)('a' + (fio_rand64() % 26));
+      if (len && (round & 1))
+        s[fio_rand64() % len] = (round & 2) ? '\n' : ':';
+      if (len && (round & 4))
+        s[fio_rand64() % len] = (char)(fio_rand64() & 0xFF);
+      char *e2 = NULL, *e3 = NULL, *ec = NULL, *ew = NULL;
+      for (size_t i = len; i--;) { /* naive first occurrences */
+        if (s[i] == '\n' || s[i] == ':')
+          e2 = s + i;
+        if (s[i] == '\n' || s[i] == ':' || s[i] == 'z')
+          e3 = s + i;
+        if (cls.map[(uint8_t)s[i]])
+          ec = s + i;
+        if (wide.map[(uint8_t)s[i]])
+          ew = s + i;
+      }
+      FIO_ASSERT(fio_memchr2(s, '\n', ':', len) == e2,
+                 "fio_memchr2 failed (round %zu, len %zu)",
+                 round,
+                 len);
+      FIO_ASSERT(fio_memchr3(s, '\n', ':', 'z', len) == e3,
+                 "fio_memchr3 failed (round %zu, len %zu)",
+                 round,
+                 len);
+      FIO_ASSERT(fio_memchr_class(s, &cls, len) == ec &&
+                     fio_memchr_class(s, &wide, len) == ew,
+                 "fio_memchr_class failed (round %zu, len %zu)",
+                 round,
+                 len);
+      const size_t nlen = 1 + (round % 24);
+      if (len < nlen)
+        continue;
+      const size_t at = (size_t)(fio_rand64() % (len - nlen + 1));
+      char *found = (char *)fio_memmem(s, len, s + at, nlen);
+      FIO_ASSERT(found && found <= s + at && !memcmp(found, s + at, nlen),
+                 "fio_memmem failed (round %zu, len %zu, needle %zu)",
+                 round,
+                 len,
+                 nlen);
+      for (char *p = s; p < found; ++p)
+        FIO_ASSERT(memcmp(p, s + at, nlen),
+                   "fio_memmem missed an earlier match (round %zu)",
+                   round);
+      FIO_ASSERT(!fio_memmem(s, len, "0123", 4) &&
+                     fio_memmem(s, len, "", 0) == s,
+                 "fio_memmem edge cases failed");
+    }
+  }
 #ifndef DEBUG
   const size_t base_repetitions = 8192;
   fprintf(stderr, "* Speed testing core memcpy primitives:\n");
@@ -45571,6 +52913,101 @@ FIO_SFUNC void FIO_NAME_TEST(stl, poll)(void) {
           "* SKIPPED testing file descriptor polling (engine: kqueue).\n");
 }
 
+#elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_EPOLL_ET ||                          \
+    FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+/* counters: [0] on_data, [1] on_ready, [2] on_close */
+FIO_SFUNC void fio___poll_test_on_data(void *c) { ((size_t *)c)[0] += 1; }
+FIO_SFUNC void fio___poll_test_on_ready(void *c) { ((size_t *)c)[1] += 1; }
+FIO_SFUNC void fio___poll_test_on_close(void *c) { ((size_t *)c)[2] += 1; }
+
+FIO_SFUNC void FIO_NAME_TEST(stl, poll)(void) {
+  fprintf(stderr,
+          "* Testing file descriptor monitoring (engine: %s).\n",
+          fio_poll_engine());
+  fio_poll_s p;
+  size_t in[3] = {0}, out[3] = {0};
+  int fds[2];
+  char buf[16];
+  fio_poll_init(&p,
+                .on_data = fio___poll_test_on_data,
+                .on_ready = fio___poll_test_on_ready,
+                .on_close = fio___poll_test_on_close);
+  FIO_ASSERT(!pipe(fds), "couldn't open pipe for polling test");
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], in, POLLIN) &&
+                 !fio_poll_monitor(&p, fds[1], out, POLLOUT),
+             "fio_poll_monitor failed");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(!in[0] && out[1] == 1, "only the pipe's writing end is ready");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(out[1] == 1, "monitoring should be one-shot");
+  fio_poll_monitor(&p, fds[1], out, POLLOUT);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(out[1] == 2, "stale events that are still ready should fire");
+  FIO_ASSERT(write(fds[1], "hello", 5) == 5, "pipe write failed");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 1, "on_data should be called for new data");
+  fio_poll_monitor(&p, fds[0], in, POLLIN);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 2, "unread data should fire when monitored again");
+  FIO_ASSERT(read(fds[0], buf, 16) == 5, "pipe read failed");
+  fio_poll_monitor(&p, fds[0], in, POLLIN);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 2, "drained file descriptors shouldn't fire");
+  FIO_ASSERT(write(fds[1], "hello", 5) == 5, "pipe write failed");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 3, "new data should fire (new edge)");
+  FIO_ASSERT(read(fds[0], buf, 16) == 5, "pipe read failed");
+  fio_poll_would_block(&p, fds[0], POLLIN);
+  fio_poll_monitor(&p, fds[0], in, POLLIN);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 3, "fio_poll_would_block hint ignored");
+  FIO_ASSERT(!fio_poll_forget(&p, fds[1]) && fio_poll_forget(&p, fds[1]),
+             "fio_poll_forget error");
+  close(fds[1]);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[2] == 1 && in[0] == 3 && !out[2],
+             "on_close should be called when the pipe is closed");
+  FIO_ASSERT(!fio_poll_forget(&p, fds[0]), "fio_poll_forget error");
+  close(fds[0]);
+  { /* listening sockets (connections might be accepted by the kernel) */
+    size_t lc[3] = {0};
+    int cl[3], acc[3];
+    int srv = fio_sock_open("127.0.0.1", "9437", FIO_SOCK_TCP | FIO_SOCK_SERVER);
+    FIO_ASSERT(srv != -1, "couldn't open listening socket for polling test");
+    fio_sock_set_non_block(srv);
+    for (size_t i = 0; i < 3; ++i) {
+      cl[i] = fio_sock_open("127.0.0.1",
+                            "9437",
+                            FIO_SOCK_TCP | FIO_SOCK_CLIENT);
+      FIO_ASSERT(cl[i] != -1, "couldn't connect for polling test");
+      acc[i] = -1;
+      for (size_t j = 0; acc[i] == -1 && j < 100; ++j) {
+        fio_poll_monitor(&p, srv, lc, POLLIN);
+        fio_poll_review(&p, 10);
+        acc[i] = fio_poll_accept(&p, srv);
+      }
+      FIO_ASSERT(acc[i] != -1, "fio_poll_accept failed (%zu)", i);
+    }
+    FIO_ASSERT(lc[0] >= 1, "on_data should be called for new connections");
+    FIO_ASSERT(fio_poll_accept(&p, srv) == -1 &&
+                   (errno == EAGAIN || errno == EWOULDBLOCK),
+               "fio_poll_accept should return -1 (EAGAIN) when no connections "
+               "are waiting");
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+    if (p.fd == -1)
+      FIO_ASSERT(p.fds[srv].accepting == FIO___POLL_URING_ACCEPT_ACTIVE,
+                 "io_uring should accept connections in the kernel");
+#endif
+    FIO_ASSERT(!fio_poll_forget(&p, srv), "fio_poll_forget error");
+    fio_sock_close(srv);
+    for (size_t i = 0; i < 3; ++i) {
+      fio_sock_close(cl[i]);
+      fio_sock_close(acc[i]);
+    }
+  }
+  fio_poll_destroy(&p);
+}
+
 #elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_POLL
 FIO_SFUNC void FIO_NAME_TEST(stl, poll)(void) {
   fprintf(
@@ -45611,6 +53048,142 @@ Cleanup
 
 
 
+                          FIO_POOL_NAME Test Helper
+
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_TEST_ALL) && !defined(FIO___TEST_REINCLUDE) &&                 \
+    !defined(H___FIO_POOL_TEST___H)
+#define H___FIO_POOL_TEST___H
+
+typedef struct {
+  size_t index;
+  char junk[40];
+} fio___pool_test_s;
+
+/* a small magazine makes threads exchange chains with the depot often */
+#define FIO_POOL_NAME     fio___pool_test
+#define FIO_POOL_TYPE     fio___pool_test_s
+#define FIO_POOL_MAGAZINE 4
+#define FIO_POOL_WARMUP   100
+#define FIO___TEST_REINCLUDE
+#include FIO_INCLUDE_FILE
+#undef FIO___TEST_REINCLUDE
+
+/* a reference counted flexible type, small objects are pooled */
+#define FIO_REF_NAME             fio___pool_test_ref
+#define FIO_REF_TYPE             fio___pool_test_s
+#define FIO_REF_FLEX_TYPE        char
+#define FIO_REF_CONSTRUCTOR_ONLY 1
+#define FIO_REF_POOL             0
+#define FIO_REF_POOL_FLEX        32
+#define FIO___TEST_REINCLUDE
+#include FIO_INCLUDE_FILE
+#undef FIO___TEST_REINCLUDE
+
+#define FIO___POOL_TEST_OBJECTS 4096
+
+FIO_SFUNC void *fio___pool_test_task(void *ignr_) {
+  fio___pool_test_s **objs = (fio___pool_test_s **)FIO_MEM_REALLOC(
+      NULL,
+      0,
+      sizeof(*objs) * FIO___POOL_TEST_OBJECTS,
+      0);
+  FIO_ASSERT_ALLOC(objs);
+  for (size_t round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < FIO___POOL_TEST_OBJECTS; ++i) {
+      objs[i] = fio___pool_test_alloc();
+      FIO_ASSERT(objs[i], "pool allocation failed (%zu)!", i);
+      FIO_ASSERT(!((uintptr_t)objs[i] & 15), "pool objects should be aligned");
+      objs[i]->index = i;
+    }
+    for (size_t i = 0; i < FIO___POOL_TEST_OBJECTS; ++i) {
+      FIO_ASSERT(objs[i]->index == i,
+                 "pool object overwritten (shared by two owners?)");
+      /* free in a different order than allocated */
+      if ((i & 1))
+        fio___pool_test_free(objs[i]);
+    }
+    for (size_t i = 0; i < FIO___POOL_TEST_OBJECTS; i += 2)
+      fio___pool_test_free(objs[i]);
+  }
+  FIO_MEM_FREE(objs, sizeof(*objs) * FIO___POOL_TEST_OBJECTS);
+  return ignr_;
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, pool)(void) {
+  fprintf(stderr, "* Testing fixed size object pool (magazines + depot).\n");
+  FIO_ASSERT(fio___pool_test___pool.objects >= 100,
+             "the pool should have been pre-warmed on startup");
+  { /* single thread - freed objects are reused */
+    fio___pool_test_s *a = fio___pool_test_alloc();
+    FIO_ASSERT(a, "pool allocation failed!");
+    fio___pool_test_free(a);
+    FIO_ASSERT(fio___pool_test_alloc() == a,
+               "the last freed object should be reused first");
+    fio___pool_test_free(a);
+    fio___pool_test_task(NULL);
+    const size_t carved = fio___pool_test___pool.objects;
+    fio___pool_test_task(NULL);
+    FIO_ASSERT(fio___pool_test___pool.objects == carved,
+               "freed objects should be reused (no new slabs)");
+  }
+#if FIO_OS_POSIX
+  { /* threads - objects move between threads through the depot */
+    fio_thread_t threads[4];
+    for (size_t i = 0; i < 4; ++i)
+      FIO_ASSERT(!fio_thread_create(threads + i, fio___pool_test_task, NULL),
+                 "couldn't start pool test thread");
+    for (size_t i = 0; i < 4; ++i)
+      fio_thread_join(threads + i);
+    FIO_ASSERT(!fio___pool_test_destroy(),
+               "all objects were returned, pool memory should be released");
+    FIO_ASSERT(!fio___pool_test___pool.objects && !fio___pool_test___pool.slabs,
+               "pool destruction should release all slabs");
+    fio___pool_test_s *a = fio___pool_test_alloc();
+    FIO_ASSERT(a, "pool allocation failed after pool was destroyed!");
+    FIO_ASSERT(fio___pool_test_destroy() == -1,
+               "pool memory should be retained while objects are in use");
+    fio___pool_test_free(a);
+  }
+#endif
+  { /* reference counted objects */
+    fio___pool_test_s *small = fio___pool_test_ref_new(16);
+    fio___pool_test_s *big = fio___pool_test_ref_new(128);
+    FIO_ASSERT(small && big, "pooled reference allocation failed!");
+    FIO_ASSERT(fio___pool_test_ref___pool.objects,
+               "small flexible objects should be pooled");
+    FIO_ASSERT(!small->index && !big->index,
+               "pooled reference objects should be initialized");
+    fio___pool_test_ref_dup(small);
+    fio___pool_test_ref_free(small);
+    fio___pool_test_ref_free(small);
+    fio___pool_test_ref_free(big);
+    FIO_ASSERT(fio___pool_test_ref_new(16) == small,
+               "freed pooled reference objects should be reused");
+    fio___pool_test_ref_free(small);
+  }
+}
+#undef FIO___POOL_TEST_OBJECTS
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_TEST_ALL */
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_TEST_ALL           /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
                         FIO_PUBSUB Test Helper
 
 
@@ -45732,7 +53305,7 @@ FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_roundtrip)(void) {
     fio_unsubscribe FIO_NOOP(sub[i]);
     --delta;
     --expected;
-    fio_queue_perform_all(fio___srv_tasks);
+    fio_queue_perform_all(fio_srv_queue());
     FIO_ASSERT(state == expected, "unsubscribe should call callback");
     FIO___PUBLISH2TEST();
     FIO_ASSERT(state == expected, "pub/sub test state incorrect (3-%d)", i);
@@ -45742,6 +53315,68 @@ FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_roundtrip)(void) {
 #undef FIO___PUBLISH2TEST
 }
 
+/* *****************************************************************************
+IO Bound Subscriptions (reactor threads)
+***************************************************************************** */
+#if FIO_OS_POSIX
+
+/* state: [0] the IO's reactor thread, [1] on_message's thread, [2] peer fd */
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_thread_on_message)(fio_msg_s *msg) {
+  int *state = (int *)msg->udata;
+  state[1] = fio_srv_thread();
+  fio_srv_stop();
+}
+
+/* attaches an IO to the calling (non-main) reactor, subscribes and publishes */
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_thread_task)(void *state_,
+                                                      void *ignr_) {
+  int *state = (int *)state_;
+  int fds[2];
+  FIO_ASSERT(!socketpair(AF_UNIX, SOCK_STREAM, 0, fds), "socketpair failed");
+  state[0] = fio_srv_thread();
+  state[2] = fds[1];
+  fio_s *io = fio_srv_attach_fd(fds[0], NULL, NULL, NULL);
+  fio_subscribe(.io = io,
+                .channel = FIO_BUF_INFO1((char *)"pubsub_thread_channel"),
+                .on_message = FIO_NAME_TEST(stl, pubsub_thread_on_message),
+                .udata = state_,
+                .filter = -127);
+  fio_publish(.channel = FIO_BUF_INFO1((char *)"pubsub_thread_channel"),
+              .filter = -127);
+  (void)ignr_;
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_thread_on_start)(void *state_) {
+  fio___srv_defer_to(fio___srvdata.reactors,
+                     FIO_SRV_LANE_USER,
+                     FIO_NAME_TEST(stl, pubsub_thread_task),
+                     state_,
+                     NULL);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_threads)(void) {
+  fprintf(stderr, "* Testing pub/sub IO bound subscriptions (threads).\n");
+  int state[3] = {-1, -1, -1};
+  const uint16_t old = fio_srv_threads();
+  fio_srv_threads_set(2);
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         FIO_NAME_TEST(stl, pubsub_thread_on_start),
+                         state);
+  fio_srv_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            FIO_NAME_TEST(stl, pubsub_thread_on_start),
+                            state);
+  fio_srv_threads_set(old);
+  if (state[2] != -1)
+    fio_sock_close(state[2]);
+  FIO_ASSERT(state[0] == 1, "the IO should be attached by reactor thread 1");
+  FIO_ASSERT(state[1] == state[0],
+             "on_message should be performed by the IO's reactor (%d != %d)",
+             state[1],
+             state[0]);
+}
+#endif /* FIO_OS_POSIX */
+
 /* *****************************************************************************
 
 ***************************************************************************** */
@@ -45749,6 +53384,9 @@ FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_roundtrip)(void) {
 FIO_SFUNC void FIO_NAME_TEST(stl, pubsub)(void) {
   FIO_NAME_TEST(stl, pubsub_encryption)();
   FIO_NAME_TEST(stl, pubsub_roundtrip)();
+#if FIO_OS_POSIX
+  FIO_NAME_TEST(stl, pubsub_threads)();
+#endif /* FIO_OS_POSIX */
   fio___srv_cleanup_at_exit(NULL);
 }
 
@@ -45837,11 +53475,97 @@ FIO_SFUNC void fio___queue_test_sched_sample_task(void *t_, void *i_count) {
   }
 }
 
+typedef struct {
+  fio_queue_s *q;
+  size_t count;
+  size_t total;
+  uintptr_t *counter;
+} fio___queue_test_mpmc_s;
+
+FIO_SFUNC void *fio___queue_test_mpmc_producer(void *info_) {
+  fio___queue_test_mpmc_s *info = (fio___queue_test_mpmc_s *)info_;
+  for (size_t i = 0; i < info->count; ++i) {
+    FIO_ASSERT(!fio_queue_push(info->q,
+                               .fn = fio___queue_test_sample_task,
+                               .udata1 = info->counter),
+               "Couldn't push task!");
+  }
+  return NULL;
+}
+
+FIO_SFUNC void *fio___queue_test_mpmc_consumer(void *info_) {
+  fio___queue_test_mpmc_s *info = (fio___queue_test_mpmc_s *)info_;
+  for (;;) {
+    uintptr_t performed;
+    fio_atomic_load(performed, info->counter);
+    if (performed >= info->total)
+      break;
+    if (fio_queue_perform(info->q))
+      FIO_THREAD_RESCHEDULE();
+  }
+  return NULL;
+}
+
+#define FIO___QUEUE_TEST_FANOUT_DEPTH 8 /* 4^8 leaves */
+
+FIO_SFUNC void fio___queue_test_fanout_task(void *t_, void *depth_) {
+  fio___queue_test_s *t = (fio___queue_test_s *)t_;
+  size_t depth = (size_t)(uintptr_t)depth_;
+  if (!depth) {
+    fio_atomic_add(t->counter, 1);
+    return;
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    FIO_ASSERT(!fio_queue_push(t->q,
+                               fio___queue_test_fanout_task,
+                               t,
+                               (void *)(uintptr_t)(depth - 1)),
+               "Couldn't push task!");
+  }
+  /* `t->count` marks work-stealing workers, where pushed tasks stay local */
+  if (t->count && depth == FIO___QUEUE_TEST_FANOUT_DEPTH)
+    FIO_ASSERT(!fio_queue_count(t->q),
+               "tasks pushed by work-stealing workers should stay local");
+}
+
+/* replaces the task's push time with the time it waited in the queue */
+FIO_SFUNC void fio___queue_test_latency_task(void *sample_, void *counter_) {
+  int64_t *sample = (int64_t *)sample_;
+  sample[0] = fio_time_nano() - sample[0];
+  fio_atomic_add((uintptr_t *)counter_, 1);
+}
+
+FIO_SFUNC int fio___queue_test_latency_cmp(const void *a_, const void *b_) {
+  const int64_t a = ((const int64_t *)a_)[0], b = ((const int64_t *)b_)[0];
+  return (a > b) - (a < b);
+}
+
 FIO_SFUNC int fio___queue_test_timer_task(void *i_count, void *unused2) {
   fio_atomic_add((uintptr_t *)i_count, 1);
   return (unused2 ? -1 : 0);
 }
 
+/* tests that timers are performed in order, `due_` is the timer's due time */
+FIO_SFUNC int fio___queue_test_timer_order(void *last_, void *due_) {
+  int64_t *last = (int64_t *)last_;
+  FIO_ASSERT((int64_t)(intptr_t)due_ >= *last,
+             "timers performed out of order (%zd < %zd)",
+             (ssize_t)(intptr_t)due_,
+             (ssize_t)*last);
+  *last = (int64_t)(intptr_t)due_;
+  return 0;
+}
+
+#if FIO_QUEUE_STATS
+/* busy-waits for `us_` microseconds. */
+FIO_SFUNC void fio___queue_test_slow_task(void *us_, void *unused2) {
+  const int64_t until = fio_time_micro() + (int64_t)(uintptr_t)us_;
+  while (fio_time_micro() < until)
+    ;
+  (void)unused2;
+}
+#endif
+
 FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
   fprintf(stderr, "* Testing facil.io task scheduling (fio_queue)\n");
   /* ************** testing queue ************** */
@@ -45914,6 +53638,60 @@ FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
   }
   FIO_ASSERT(i_count == i_count_should_be, "ERROR: queue count invalid\n");
 
+  { /* batch push / pop / perform - order and data integrity */
+    fio_queue_task_s tasks[100];
+    size_t pushed = 0;
+    fio___queue_test_counter_task(NULL, NULL);
+    for (size_t round = 0; round < (FIO_QUEUE_TASKS_PER_ALLOC >> 2); ++round) {
+      for (size_t i = 0; i < 100; ++i, ++pushed)
+        tasks[i] = (fio_queue_task_s){.fn = fio___queue_test_counter_task,
+                                      .udata1 = (void *)(pushed + 1),
+                                      .udata2 = (void *)(pushed + 2)};
+      FIO_ASSERT(fio_queue_push_many(q, tasks, 100) == 100,
+                 "fio_queue_push_many didn't push all the tasks");
+      fio_queue_push(q,
+                     .fn = fio___queue_test_counter_task,
+                     .udata1 = (void *)(pushed + 1),
+                     .udata2 = (void *)(pushed + 2));
+      ++pushed;
+    }
+    FIO_ASSERT(fio_queue_count(q) == pushed,
+               "fio_queue_push_many count error (%zu != %zu)",
+               (size_t)fio_queue_count(q),
+               pushed);
+    FIO_ASSERT(fio_queue_pop_many(q, tasks, 7) == 7,
+               "fio_queue_pop_many should pop the requested number of tasks");
+    for (size_t i = 0; i < 7; ++i)
+      tasks[i].fn(tasks[i].udata1, tasks[i].udata2);
+    FIO_ASSERT(fio_queue_perform_batch(q, 1000) == 1000,
+               "fio_queue_perform_batch should stop at `max`");
+    FIO_ASSERT(fio_queue_perform_batch(q, (size_t)-1) == pushed - 1007,
+               "fio_queue_perform_batch should perform all remaining tasks");
+    FIO_ASSERT(!fio_queue_count(q) && !fio_queue_pop_many(q, tasks, 100),
+               "fio_queue_perform_batch didn't perform all");
+  }
+
+  i_count = 0;
+  start = fio_time_milli();
+  {
+    fio_queue_task_s tasks[FIO_QUEUE_BATCH];
+    for (size_t i = 0; i < FIO_QUEUE_BATCH; ++i)
+      tasks[i] = (fio_queue_task_s){.fn = fio___queue_test_sample_task,
+                                    .udata1 = (void *)&i_count};
+    for (size_t i = 0; i < FIO___QUEUE_TOTAL_COUNT; i += FIO_QUEUE_BATCH)
+      fio_queue_push_many(q, tasks, FIO_QUEUE_BATCH);
+    fio_queue_perform_batch(q, (size_t)-1);
+  }
+  end = fio_time_milli();
+  if (FIO___QUEUE_TEST_PRINT) {
+    fprintf(stderr,
+            "\t- batched (%zu) task counter: %lu ms with i_count = %lu\n",
+            (size_t)FIO_QUEUE_BATCH,
+            (unsigned long)(end - start),
+            (unsigned long)i_count);
+  }
+  FIO_ASSERT(i_count == i_count_should_be, "ERROR: queue count invalid\n");
+
   if (FIO___QUEUE_TEST_PRINT) {
     fprintf(stderr, "\n");
   }
@@ -45982,6 +53760,191 @@ FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
   FIO_ASSERT(q->w == &q->mem,
              "queue library didn't release dynamic queue (should be static)");
   fio_queue_free(q);
+  {
+    fprintf(stderr,
+            "* Testing queue contention (%s, producers == consumers)\n",
+            (FIO_QUEUE_LOCKFREE ? "lock-free ring" : "locked ring"));
+    fio_queue_init(&q2);
+    for (size_t threads = 1; threads <= 16; threads <<= 1) {
+      fio_thread_t producers[16], consumers[16];
+      fio___queue_test_mpmc_s info = {
+          .q = &q2,
+          .count = (FIO___QUEUE_TOTAL_COUNT >> 1) / threads,
+          .counter = &i_count,
+      };
+      info.total = info.count * threads;
+      i_count = 0;
+      start = fio_time_milli();
+      for (size_t i = 0; i < threads; ++i) {
+        FIO_ASSERT(!fio_thread_create(consumers + i,
+                                      fio___queue_test_mpmc_consumer,
+                                      &info),
+                   "couldn't start consumer thread");
+        FIO_ASSERT(!fio_thread_create(producers + i,
+                                      fio___queue_test_mpmc_producer,
+                                      &info),
+                   "couldn't start producer thread");
+      }
+      for (size_t i = 0; i < threads; ++i) {
+        fio_thread_join(producers + i);
+        fio_thread_join(consumers + i);
+      }
+      end = fio_time_milli();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- %zu producers / %zu consumers: %lu ms for %zu tasks\n",
+                threads,
+                threads,
+                (unsigned long)(end - start),
+                info.total);
+      }
+      FIO_ASSERT(i_count == info.total && !fio_queue_count(&q2),
+                 "ERROR: queue contention count invalid (%zu != %zu)\n",
+                 (size_t)i_count,
+                 info.total);
+    }
+    FIO_ASSERT(q2.w == &q2.mem,
+               "queue didn't release dynamic ring buffers after contention");
+    fio_queue_destroy(&q2);
+  }
+  {
+    fprintf(stderr, "* Testing worker threads (recursive fan-out)\n");
+    const uintptr_t leaves = (uintptr_t)1 << (FIO___QUEUE_TEST_FANOUT_DEPTH * 2);
+    fio_queue_init(&q2);
+    for (size_t stealing = 0; stealing < 2; ++stealing) {
+      fio___queue_test_s info = {
+          .q = &q2,
+          .count = stealing,
+          .counter = &i_count,
+      };
+      i_count = 0;
+      start = fio_time_milli();
+      FIO_ASSERT(!(stealing ? fio_queue_workers_add_stealing(&q2, 4)
+                            : fio_queue_workers_add(&q2, 4)),
+                 "couldn't start worker threads");
+      fio_queue_push(&q2,
+                     fio___queue_test_fanout_task,
+                     &info,
+                     (void *)(uintptr_t)FIO___QUEUE_TEST_FANOUT_DEPTH);
+      for (;;) {
+        uintptr_t performed;
+        fio_atomic_load(performed, &i_count);
+        if (performed >= leaves)
+          break;
+        FIO_THREAD_RESCHEDULE();
+      }
+      fio_queue_workers_join(&q2);
+      end = fio_time_milli();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- 4 %s workers: %lu ms for %zu leaf tasks\n",
+                (stealing ? "work-stealing" : "shared queue"),
+                (unsigned long)(end - start),
+                (size_t)leaves);
+      }
+      FIO_ASSERT(i_count == leaves && !fio_queue_count(&q2),
+                 "ERROR: fan-out count invalid (%zu != %zu)\n",
+                 (size_t)i_count,
+                 (size_t)leaves);
+    }
+    fio_queue_destroy(&q2);
+  }
+  {
+    /* tasks arrive slower than they are performed, so workers are idle */
+    const size_t samples = 4096;
+    fprintf(stderr,
+            "* Testing worker wake-up latency (spin budget: %zu)\n",
+            (size_t)FIO_QUEUE_SPIN);
+    int64_t *lat =
+        (int64_t *)FIO_MEM_REALLOC(NULL, 0, sizeof(*lat) * samples, 0);
+    FIO_ASSERT_ALLOC(lat);
+    fio_queue_init(&q2);
+    FIO_ASSERT(!fio_queue_workers_add(&q2, 2), "couldn't start worker threads");
+    i_count = 0;
+    for (size_t i = 0; i < samples; ++i) {
+      lat[i] = fio_time_nano();
+      fio_queue_push(&q2, fio___queue_test_latency_task, lat + i, &i_count);
+      for (;;) {
+        uintptr_t performed;
+        fio_atomic_load(performed, &i_count);
+        if (performed > i)
+          break;
+        fio_thread_yield();
+      }
+      if ((i & 3) == 3)
+        FIO_THREAD_WAIT(50000); /* long enough for workers to park */
+    }
+    fio_queue_workers_join(&q2);
+    fio_queue_destroy(&q2);
+    FIO_ASSERT(i_count == samples, "wake-up latency tasks weren't performed");
+    qsort(lat, samples, sizeof(*lat), fio___queue_test_latency_cmp);
+    if (FIO___QUEUE_TEST_PRINT) {
+      fprintf(stderr,
+              "\t- push to perform: p50 %zu ns, p99 %zu ns, max %zu ns\n",
+              (size_t)lat[samples >> 1],
+              (size_t)lat[samples - 1 - (samples / 100)],
+              (size_t)lat[samples - 1]);
+    }
+    FIO_MEM_FREE(lat, sizeof(*lat) * samples);
+  }
+#if FIO_QUEUE_STATS
+  {
+    fprintf(stderr, "* Testing queue statistics (FIO_QUEUE_STATS)\n");
+    fio_timer_queue_s tq = FIO_TIMER_QUEUE_INIT;
+    fio_queue_stats_s *st;
+    fio_queue_fn_stats_s *fast = NULL, *slow = NULL, *timer = NULL;
+    fio_queue_init(&q2);
+    i_count = 0;
+    for (size_t i = 0; i < 100; ++i)
+      fio_queue_push(&q2, fio___queue_test_sample_task, (void *)&i_count);
+    fio_queue_push(&q2, fio___queue_test_slow_task, (void *)(uintptr_t)2000);
+    fio_timer_schedule(&tq,
+                       .fn = fio___queue_test_timer_task,
+                       .udata1 = (void *)&i_count,
+                       .every = 1,
+                       .repetitions = 1,
+                       .start_at = fio_time_milli() - 10);
+    fio_timer_push2queue(&q2, &tq, 0);
+    FIO_THREAD_WAIT(1000000); /* tasks wait (at least) a millisecond */
+    fio_queue_perform_all(&q2);
+    st = fio_queue_stats(&q2);
+    for (size_t i = 0; i < FIO_QUEUE_STATS_FUNCTIONS; ++i) {
+      if (st->fn[i].fn == fio___queue_test_sample_task)
+        fast = st->fn + i;
+      if (st->fn[i].fn == fio___queue_test_slow_task)
+        slow = st->fn + i;
+      if ((uintptr_t)st->fn[i].fn == (uintptr_t)fio___queue_test_timer_task)
+        timer = st->fn + i;
+    }
+    if (FIO___QUEUE_TEST_PRINT)
+      fio_queue_stats_print(&q2);
+    FIO_ASSERT(i_count == 101, "statistics test tasks weren't performed");
+    FIO_ASSERT(st->pushed == 102 && st->performed == 102 && !st->untracked,
+               "queue statistics task counts error (%zu, %zu)",
+               (size_t)st->pushed,
+               (size_t)st->performed);
+    FIO_ASSERT(st->depth_max == 102,
+               "queue depth high-water mark error (%zu)",
+               (size_t)st->depth_max);
+    FIO_ASSERT(st->wait_max >= 1000000 &&
+                   fio_queue_stats_percentile(st->wait, 0.5) >= 1024,
+               "queue wait time wasn't recorded");
+    FIO_ASSERT(fast && fast->count == 100 && slow && slow->count == 1,
+               "callback statistics missing");
+    FIO_ASSERT(timer && timer->count == 1,
+               "timer tasks should be recorded using the timer's callback");
+    FIO_ASSERT(slow->max >= 1900000 && slow->total == slow->max &&
+                   fio_queue_stats_percentile(slow->hist, 0.99) >= 1024 &&
+                   fio_queue_stats_percentile(fast->hist, 0.5) <
+                       fio_queue_stats_percentile(slow->hist, 0.5),
+               "callback run time wasn't recorded");
+    fio_queue_stats_reset(&q2);
+    FIO_ASSERT(!st->pushed && !st->fn[0].fn && !st->wait_max,
+               "fio_queue_stats_reset failed");
+    fio_timer_destroy(&tq);
+    fio_queue_destroy(&q2);
+  }
+#endif
   {
     fprintf(stderr, "* Testing urgent insertion\n");
     fio_queue_init(&q2);
@@ -46111,11 +54074,81 @@ FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
         tester == 3,
         "fio_timer_destroy should have called on_finish of future task (%zu).",
         (size_t)tester);
-    FIO_ASSERT(!tq.next, "timer queue should be empty.");
+    FIO_ASSERT(fio_timer_next_at(&tq) == -1, "timer queue should be empty.");
+
+    /* test timers far in the future (beyond the timing wheel) */
+    tester = 0;
+    for (size_t i = 0; i < 3; ++i) {
+      fio_timer_schedule(&tq,
+                         .fn = fio___queue_test_timer_task,
+                         .udata1 = (void *)&tester,
+                         .every = 1,
+                         .start_at = milli_now + (int64_t)(i ? (1LL << 37) : 0) +
+                                     (int64_t)(i << 2));
+    }
+    FIO_ASSERT(fio_timer_push2queue(&q2, &tq, milli_now + 1) == 1,
+               "only the first timer should be due");
+    FIO_ASSERT(fio_timer_next_at(&tq) == milli_now + (1LL << 37) + 5,
+               "fio_timer_next_at value error for a distant timer.");
+    FIO_ASSERT(!fio_timer_push2queue(&q2, &tq, milli_now + (1LL << 37) + 4),
+               "distant timers shouldn't be due");
+    FIO_ASSERT(fio_timer_push2queue(&q2, &tq, milli_now + (1LL << 37) + 9) == 2,
+               "distant timers should be due");
+    fio_queue_perform_all(&q2);
+    FIO_ASSERT(tester == 3 && fio_timer_next_at(&tq) == -1,
+               "all timers should have been performed (%zu)",
+               (size_t)tester);
+
+    /* test timer ordering and the timing wheel's cost (1M timers) */
+    {
+      const size_t timer_count = 1024 * 1024;
+      int64_t last = 0;
+      milli_now = fio_time_milli();
+      start = fio_time_micro();
+      for (size_t i = 0; i < timer_count; ++i) {
+        /* spread over a minute (cascades through several wheel levels) */
+        const uint32_t every = 1 + (uint32_t)((i * 7919) % 60000);
+        fio_timer_schedule(&tq,
+                           .fn = fio___queue_test_timer_order,
+                           .udata1 = (void *)&last,
+                           .udata2 = (void *)(intptr_t)(milli_now + every),
+                           .every = every,
+                           .start_at = milli_now);
+      }
+      end = fio_time_micro();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- scheduled %zu timers in %lu us\n",
+                timer_count,
+                (unsigned long)(end - start));
+      }
+      size_t performed = 0;
+      start = fio_time_micro();
+      for (int64_t now = milli_now; now <= milli_now + 60000; now += 250) {
+        performed += fio_timer_push2queue(&q2, &tq, now);
+        fio_queue_perform_all(&q2);
+        FIO_ASSERT(fio_timer_next_at(&tq) > now ||
+                       fio_timer_next_at(&tq) == -1,
+                   "a due timer wasn't pushed to the queue");
+      }
+      end = fio_time_micro();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- expired and performed %zu timers in %lu us\n",
+                performed,
+                (unsigned long)(end - start));
+      }
+      FIO_ASSERT(performed == timer_count && fio_timer_next_at(&tq) == -1,
+                 "all timers should have been performed (%zu / %zu)",
+                 performed,
+                 timer_count);
+    }
+    fio_timer_destroy(&tq);
     fio_queue_destroy(&q2);
   }
   fprintf(stderr, "* passed.\n");
 }
+#undef FIO___QUEUE_TEST_FANOUT_DEPTH
 /* *****************************************************************************
 Cleanup
 ***************************************************************************** */
@@ -46702,6 +54735,107 @@ Cleanup
 
 
 
+                        FIO_REGION_NAME Test Helper
+
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_TEST_ALL) && !defined(FIO___TEST_REINCLUDE) &&                 \
+    !defined(H___FIO_REGION_TEST___H)
+#define H___FIO_REGION_TEST___H
+
+/* types defined with the region allocate from the thread's current region */
+#define FIO_REGION_NAME      fio___region_test
+#define FIO_REGION_PAGE_SIZE 1024
+#define FIO_STR_NAME         fio___region_test_str
+#define FIO_ARRAY_NAME       fio___region_test_ary
+#define FIO_ARRAY_TYPE       size_t
+#define FIO___TEST_REINCLUDE
+#include FIO_INCLUDE_FILE
+#undef FIO___TEST_REINCLUDE
+
+FIO_SFUNC void FIO_NAME_TEST(stl, region)(void) {
+  fprintf(stderr, "* Testing region allocator (bump allocation + reset).\n");
+  fio___region_test_s *r = fio___region_test_new();
+  FIO_ASSERT(r, "region allocation failed!");
+  { /* bump allocation */
+    char *a = (char *)fio___region_test_malloc(r, 1);
+    char *b = (char *)fio___region_test_malloc(r, 24);
+    FIO_ASSERT(a && b, "region allocation failed!");
+    FIO_ASSERT(!((uintptr_t)a & 15) && !((uintptr_t)b & 15),
+               "region allocations should be aligned");
+    FIO_ASSERT(b == a + 16, "region allocations should be consecutive");
+    FIO_ASSERT(fio___region_test_realloc2(r, b, 64, 24) == b,
+               "the last allocation should grow in place");
+    FIO_ASSERT(fio___region_test_realloc2(r, a, 64, 1) != a,
+               "an older allocation can't grow in place");
+    char *c = (char *)fio___region_test_malloc(r, 16);
+    fio___region_test_dealloc(r, c);
+    FIO_ASSERT(fio___region_test_malloc(r, 16) == c,
+               "freeing the last allocation should allow its reuse");
+    /* fill a few pages (and a dedicated page for a large allocation) */
+    for (size_t i = 0; i < 256; ++i) {
+      char *tmp = (char *)fio___region_test_malloc(r, 48);
+      FIO_ASSERT(tmp, "region allocation failed (%zu)!", i);
+      FIO_MEMSET(tmp, (int)i, 48);
+    }
+    char *big = (char *)fio___region_test_malloc(r, 4096);
+    FIO_ASSERT(big, "large region allocation failed!");
+    FIO_MEMSET(big, 1, 4096);
+    big = (char *)fio___region_test_realloc2(r, big, 8192, 4096);
+    FIO_ASSERT(big && big[4095] == 1,
+               "large region reallocation should copy data");
+    fio___region_test_reset(r);
+    FIO_ASSERT(fio___region_test_malloc(r, 1) == a,
+               "reset should reuse the region's first page");
+  }
+  { /* types instantiated on top of the region */
+    fio___region_test_reset(r);
+    fio___region_test_s *old = fio___region_test_use(r);
+    FIO_ASSERT(fio___region_test_current() == r,
+               "the thread's current region should be set");
+    fio___region_test_str_s *s = fio___region_test_str_new();
+    FIO_ASSERT(s, "string allocation on the region failed!");
+    for (size_t i = 0; i < 128; ++i)
+      fio___region_test_str_write(s, "Hello World! ", 13);
+    FIO_ASSERT(fio___region_test_str_len(s) == 128 * 13,
+               "string written to the region has the wrong length");
+    FIO_ASSERT(!FIO_MEMCMP(fio___region_test_str_ptr(s) + (127 * 13),
+                           "Hello World! ",
+                           13),
+               "string written to the region has the wrong data");
+    fio___region_test_ary_s ary = FIO_ARRAY_INIT;
+    for (size_t i = 0; i < 1024; ++i)
+      fio___region_test_ary_push(&ary, i);
+    for (size_t i = 0; i < 1024; ++i)
+      FIO_ASSERT(fio___region_test_ary_get(&ary, (int32_t)i) == i,
+                 "array allocated on the region has the wrong data");
+    fio___region_test_ary_destroy(&ary);
+    fio___region_test_str_free(s);
+    fio___region_test_reset(r);
+    FIO_ASSERT(fio___region_test_use(old) == r,
+               "the previous current region should be returned");
+  }
+  fio___region_test_free(r);
+}
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_TEST_ALL */
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_TEST_ALL           /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
                             Server Test Helper
 
 
@@ -46983,12 +55117,226 @@ FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), env)(void) {
   FIO_ASSERT(a == 2 && b == 1 && c == 1, "destroy should call callbacks.");
 }
 
+/* *****************************************************************************
+Test Task Lanes
+***************************************************************************** */
+
+/* logs the task's lane, slow tasks busy-wait for 200 microseconds */
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             lane_task)(void *log_, void *lane_) {
+  size_t *log = (size_t *)log_;
+  if ((uintptr_t)lane_ & 256) {
+    const int64_t until = fio_time_micro() + 200;
+    while (fio_time_micro() < until)
+      ;
+  }
+  log[++log[0]] = (uintptr_t)lane_ & 255;
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lanes)(void) {
+  fprintf(stderr, "   * Testing server task lanes.\n");
+  size_t log[128] = {0};
+  const size_t weights[FIO___SRV_LANES] = FIO_SRV_LANE_WEIGHTS;
+  FIO_ASSERT(fio_srv_queue() == fio_srv_lane(FIO_SRV_LANE_USER),
+             "the server's queue should be the user lane");
+  FIO_ASSERT(!fio___srv_lanes_count(), "server lanes should start empty");
+  for (size_t i = 0; i < 40; ++i) {
+    fio_queue_push(fio_srv_lane(FIO_SRV_LANE_BACKGROUND),
+                   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lane_task),
+                   log,
+                   (void *)(uintptr_t)FIO_SRV_LANE_BACKGROUND);
+    fio_queue_push(fio_srv_lane(FIO_SRV_LANE_IO),
+                   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lane_task),
+                   log,
+                   (void *)(uintptr_t)FIO_SRV_LANE_IO);
+  }
+  fio___srv_lanes_perform(1000000);
+  FIO_ASSERT(log[0] == 80 && !fio___srv_lanes_count(),
+             "all lane tasks should have been performed (%zu)",
+             log[0]);
+  /* the first round performs a lane's weight of tasks from each lane */
+  for (size_t i = 1; i <= weights[FIO_SRV_LANE_IO]; ++i)
+    FIO_ASSERT(log[i] == FIO_SRV_LANE_IO, "IO lane should be performed first");
+  FIO_ASSERT(log[weights[FIO_SRV_LANE_IO] + 1] == FIO_SRV_LANE_BACKGROUND,
+             "background lane should be performed each round (weighted)");
+  /* the time budget limits the work performed in each cycle */
+  log[0] = 0;
+  for (size_t i = 0; i < 100; ++i)
+    fio_queue_push(fio_srv_lane(FIO_SRV_LANE_BACKGROUND),
+                   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lane_task),
+                   log,
+                   (void *)(uintptr_t)(FIO_SRV_LANE_BACKGROUND | 256));
+  fio___srv_lanes_perform(1000);
+  FIO_ASSERT(log[0] && log[0] < 100 && fio___srv_lanes_count() == 100 - log[0],
+             "the lanes' time budget should have been honored (%zu)",
+             log[0]);
+  fio___srv_lanes_perform_all();
+  FIO_ASSERT(log[0] == 100 && !fio___srv_lanes_count(),
+             "fio___srv_lanes_perform_all should perform all tasks");
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), busy_poll)(void) {
+  fprintf(stderr, "   * Testing server busy polling.\n");
+  const uint32_t old = fio_srv_busy_poll_get();
+  int64_t start;
+  fio_srv_busy_poll_set(1000000);
+  FIO_ASSERT(fio_srv_busy_poll_get() == 1000000, "busy-poll window not set");
+  fio___srv_main_reactor->busy_since = fio_time_micro();
+  start = fio_time_milli();
+  fio___srv_tick(200);
+  FIO_ASSERT(fio_time_milli() - start < 100 &&
+                 fio___srv_main_reactor->busy_spinning,
+             "the reactor shouldn't block within the busy-poll window");
+  fio___srv_main_reactor->busy_since -= 2000000;
+  fio___srv_tick(200);
+  FIO_ASSERT(!fio___srv_main_reactor->busy_spinning,
+             "the reactor should stop spinning once the window passed");
+  fio_srv_busy_poll_set(old);
+}
+
+FIO_SFUNC ssize_t FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                                write_mock)(int fd,
+                                            const void *buf,
+                                            size_t len,
+                                            void *tls) {
+  return fio_sock_write(fd, buf, len);
+  (void)tls;
+}
+
+/* counts the `writev` calls that send more than a single buffer. */
+static size_t FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_multi);
+
+FIO_SFUNC ssize_t FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                                writev_mock)(int fd,
+                                             const struct iovec *iov,
+                                             size_t count,
+                                             void *tls) {
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_multi) += (count > 1);
+  return fio___io_func_default_writev(fd, iov, count, tls);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev)(void) {
+  fprintf(stderr, "   * Testing server vectored writes.\n");
+  fio_protocol_s pr = {0}, custom = {0}, counted = {0};
+  custom.io_functions.write =
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), write_mock);
+  counted.io_functions.writev =
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_mock);
+  fio___srv_init_protocol_test(&pr, 0);
+  fio___srv_init_protocol_test(&custom, 0);
+  fio___srv_init_protocol_test(&counted, 0);
+  FIO_ASSERT(pr.io_functions.writev == fio___io_func_default_writev,
+             "the default IO functions should offer a vectored write");
+  FIO_ASSERT(!custom.io_functions.writev,
+             "a custom `write` shouldn't be bypassed by the default `writev`");
+#if FIO_OS_POSIX
+  static char data[4][256];
+  char buf[1024 + 1];
+  size_t got = 0;
+  int fds[2];
+  FIO_ASSERT(!socketpair(AF_UNIX, SOCK_STREAM, 0, fds), "socketpair failed");
+  fio_s *io = fio_srv_attach_fd(fds[0], &counted, NULL, NULL);
+  fio___srv_lanes_perform_all();
+  for (size_t i = 0; i < 4; ++i) {
+    FIO_MEMSET(data[i], (int)('a' + i), 256);
+    fio_write2(io, .buf = data[i], .len = 256); /* no copy, packet per write */
+  }
+  fio___srv_lanes_perform_all();
+  while (got < 1024 && fio_sock_wait_io(fds[1], POLLIN, 100) > 0) {
+    ssize_t r = fio_sock_read(fds[1], buf + got, 1024 - got);
+    if (r <= 0)
+      break;
+    got += (size_t)r;
+  }
+  FIO_ASSERT(got == 1024, "vectored write data missing (%zu / 1024)", got);
+  FIO_ASSERT(FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_multi),
+             "queued packets should be sent by a single `writev` call");
+  for (size_t i = 0; i < 1024; ++i)
+    FIO_ASSERT(buf[i] == (char)('a' + (i >> 8)),
+               "vectored write data / order error @ %zu",
+               i);
+  fio_close(io);
+  fio___srv_lanes_perform_all();
+  fio_sock_close(fds[1]);
+#endif
+}
+
+/* state: [0] expected, [1] performed, [2] misplaced tasks */
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             thread_task2)(void *state_, void *id_) {
+  size_t *state = (size_t *)state_;
+  if (fio_srv_thread() != (int)(uintptr_t)id_)
+    fio_atomic_add(state + 2, 1);
+  if (fio_atomic_add(state + 1, 1) + 1 == state[0])
+    fio_srv_stop();
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             thread_task)(void *state_, void *id_) {
+  if (fio_srv_thread() != (int)(uintptr_t)id_)
+    fio_atomic_add((size_t *)state_ + 2, 1);
+  /* deferred tasks should be performed by the same reactor thread */
+  fio_srv_defer(FIO_NAME_TEST(FIO_NAME_TEST(stl, server), thread_task2),
+                state_,
+                id_);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             threads_on_start)(void *state_) {
+  size_t *state = (size_t *)state_;
+  state[0] = fio___srvdata.reactor_count;
+  fio_srv_defer_main(FIO_NAME_TEST(FIO_NAME_TEST(stl, server), thread_task),
+                     state_,
+                     NULL);
+  for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+    fio___srv_defer_to(fio___srvdata.reactors + (i - 1),
+                       FIO_SRV_LANE_USER,
+                       FIO_NAME_TEST(FIO_NAME_TEST(stl, server), thread_task),
+                       state_,
+                       (void *)(uintptr_t)i);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads)(void) {
+  fprintf(stderr, "   * Testing server reactor threads.\n");
+  size_t state[3] = {0};
+  const uint16_t old = fio_srv_threads();
+  fio_srv_threads_set(3);
+  FIO_ASSERT(fio_srv_threads() == 3, "reactor thread count not set");
+  FIO_ASSERT(fio_srv_thread() == -1, "not a reactor thread (yet)");
+  void *listener = fio_srv_listen(.url = "tcp://127.0.0.1:9441",
+                                  .protocol = &FIO___MOCK_PROTOCOL,
+                                  .hide_from_log = 1);
+  FIO_ASSERT(listener, "couldn't listen (with reactor threads)");
+  fio_state_callback_add(
+      FIO_CALL_ON_START,
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads_on_start),
+      state);
+  fio_srv_start(0);
+  fio_state_callback_remove(
+      FIO_CALL_ON_START,
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads_on_start),
+      state);
+  fio_srv_listen_stop(listener);
+  FIO_ASSERT(state[0] == 3 && state[1] == 3,
+             "each reactor thread should perform its tasks (%zu/%zu)",
+             state[1],
+             state[0]);
+  FIO_ASSERT(!state[2], "tasks should be performed by their reactor thread");
+  FIO_ASSERT(fio_srv_thread() == -1 && !fio___srvdata.reactors,
+             "reactor threads should be joined once the server stops");
+  fio_srv_threads_set(old);
+}
+
 /* *****************************************************************************
 Test Server Modules
 ***************************************************************************** */
 
 FIO_SFUNC void FIO_NAME_TEST(stl, server)(void) {
   fprintf(stderr, "* Testing fio_srv units (TODO).\n");
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lanes)();
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), busy_poll)();
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev)();
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads)();
   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), env)();
   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), tls_helpers)();
 }
@@ -47535,6 +55883,21 @@ FIO_SFUNC void FIO_NAME_TEST(stl, stream)(void) {
 
   fio_stream_add(&s, fio_stream_pack_fd(open(__FILE__, O_RDONLY), 20, 0, 0));
   FIO_ASSERT(fio_stream_length(&s) == 80, "stream length error (3).");
+  {
+    struct iovec iov[8];
+    size_t count = fio_stream_read_iov(&s, iov, 8);
+    FIO_ASSERT(count == 2,
+               "fio_stream_read_iov should stop at file packets (%zu)",
+               count);
+    FIO_ASSERT(iov[0].iov_len == 40 && iov[1].iov_len == 20 &&
+                   !memcmp(str + 20, iov[0].iov_base, 40) &&
+                   !memcmp(str + 60, iov[1].iov_base, 20),
+               "fio_stream_read_iov data error");
+    FIO_ASSERT(fio_stream_read_iov(&s, iov, 1) == 1 && iov[0].iov_len == 40,
+               "fio_stream_read_iov should honor the `max` limit");
+    FIO_ASSERT(fio_stream_length(&s) == 80,
+               "fio_stream_read_iov shouldn't consume the stream");
+  }
   buf = mem;
   len = 4000;
   fio_stream_read(&s, &buf, &len);
@@ -49771,6 +58134,16 @@ FIO_SFUNC void fio_test_dynamic_types(void) {
   /* test memory allocator that allows junk data in allocations */
   FIO_NAME_TEST(FIO_NAME(stl, fio_mem_test_unsafe), mem)();
   fprintf(stderr, "===============\n");
+  /* test memory allocator that uses a per-thread cache and huge pages */
+  FIO_NAME_TEST(FIO_NAME(stl, fio_mem_test_tcache), mem)();
+  fprintf(stderr, "===============\n");
+  /* test memory allocator that uses size-class slabs for small objects */
+  FIO_NAME_TEST(FIO_NAME(stl, fio_mem_test_slab), mem)();
+  fprintf(stderr, "===============\n");
+  FIO_NAME_TEST(stl, region)();
+  fprintf(stderr, "===============\n");
+  FIO_NAME_TEST(stl, pool)();
+  fprintf(stderr, "===============\n");
   FIO_NAME_TEST(stl, sock)();
   fprintf(stderr, "===============\n");
   FIO_NAME_TEST(stl, fiobj)();
@@ -49910,9 +58283,17 @@ Finish testing segment
 #if defined(FIO_MEMORY_NAME) || defined(FIO_MALLOC) || defined(FIOBJ_MALLOC)
 #include "010 mem.h"
 #endif
+#if defined(FIO_REGION_NAME) && !defined(FIO___RECURSIVE_INCLUDE)
+#include "011 region.h"
+#endif
+#if defined(FIO_POOL_NAME) || defined(FIO_REF_POOL) ||                         \
+    (FIO_USE_POOL && (defined(FIO_QUEUE) || defined(FIO_STREAM)))
+#include "012 pool.h"
+#endif
 
 #if defined(FIO_POLL) && !defined(FIO___RECURSIVE_INCLUDE)
 #include "102 poll api.h"
+#include "102 poll edge.h"
 #include "102 poll epoll.h"
 #include "102 poll kqueue.h"
 #include "102 poll poll.h"
@@ -50008,7 +58389,9 @@ Finish testing segment
 #include "902 poll.h"
 #include "902 pubsub.h"
 #include "902 queue.h"
+#include "902 pool.h"
 #include "902 random.h"
+#include "902 region.h"
 #include "902 server.h"
 #include "902 sock.h"
 #include "902 sort.h"
@@ -56,6 +56,15 @@ Settings - Behavioral defaults
 #define FIO_USE_THREAD_MUTEX 0
 #endif
 
+#ifndef FIO_USE_POOL
+/**
+ * Selects between the memory allocator (false) and object pools (true) for the
+ * fixed size objects the server allocates most (IO handles, HTTP handles,
+ * timers, stream packets and small pub/sub messages).
+ */
+#define FIO_USE_POOL 0
+#endif
+
 #ifndef FIO_UNALIGNED_ACCESS
 /** Allows facil.io to attempt unaligned memory access on *some* CPU systems. */
 #define FIO_UNALIGNED_ACCESS 1
@@ -540,6 +549,8 @@ Static Assertions
 ***************************************************************************** */
 #if __STDC_VERSION__ >= 201112L
 #define FIO_ASSERT_STATIC(cond, msg) _Static_assert((cond), msg)
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#define FIO_ASSERT_STATIC(cond, msg) static_assert((cond), msg)
 #else
 #define FIO_ASSERT_STATIC(cond, msg)                                           \
   static const char *FIO_NAME(fio_static_assertion_failed,                     \
@@ -341,6 +341,12 @@ FIO_MAP Ordering & Naming Shortcut
 #define FIO_QUEUE
 #endif
 
+#if defined(FIO_POOL_NAME) || defined(FIO_REF_POOL) ||                         \
+    (FIO_USE_POOL && (defined(FIO_QUEUE) || defined(FIO_STREAM)))
+#undef FIO_STATE
+#define FIO_STATE
+#endif
+
 /* *****************************************************************************
 
 
@@ -415,7 +421,8 @@ FIO_MAP Ordering & Naming Shortcut
 #define FIO_RAND
 #endif
 
-#if defined(FIO_SERVER)
+#if defined(FIO_SERVER) ||                                                     \
+    (defined(FIO_MEMORY_NAME) && defined(FIO_MEMORY_PROFILE))
 #undef FIO_SIGNAL
 #define FIO_SIGNAL
 #endif
@@ -19,6 +19,41 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #if defined(FIO_MEMALT) && !defined(H___FIO_MEMALT___H)
 #define H___FIO_MEMALT___H 1
 
+/* *****************************************************************************
+Memory Helpers - Settings
+***************************************************************************** */
+
+#ifndef FIO_MEMALT_SIMD
+/**
+ * If true, the memory seeking, comparison and copying functions route longer
+ * buffers to SIMD kernels (SSE2 / AVX2 on x86-64, NEON on aarch64).
+ *
+ * On x86-64 the AVX2 kernels are selected once, at startup, using `cpuid`.
+ */
+#define FIO_MEMALT_SIMD 1
+#endif
+
+#ifndef FIO_MEMALT_SIMD_NEON
+/**
+ * If true (and `FIO_MEMALT_SIMD` is true), the NEON kernels are used on
+ * aarch64.
+ *
+ * The NEON kernels are experimental (untested on aarch64 hardware) and must be
+ * opted into. Otherwise aarch64 uses the portable 64 bit word implementations.
+ */
+#define FIO_MEMALT_SIMD_NEON 0
+#endif
+
+#if FIO_MEMALT_SIMD && (defined(__GNUC__) || defined(__clang__)) &&           \
+    (defined(__x86_64__) || defined(__amd64__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define FIO___MEMALT_SIMD_X86 1
+#elif FIO_MEMALT_SIMD && FIO_MEMALT_SIMD_NEON && defined(__aarch64__) &&       \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define FIO___MEMALT_SIMD_NEON 1
+#endif
+
 /* *****************************************************************************
 Memory Helpers - API
 ***************************************************************************** */
@@ -31,32 +66,767 @@ Memory Helpers - API
 SFUNC void *fio_memset(void *restrict dest, uint64_t data, size_t bytes);
 
 /**
- * A somewhat naive implementation of `memcpy`.
+ * A somewhat naive implementation of `memcpy` (and `memmove`).
  *
- * Probably slower than the one included with your compiler's C library.
+ * Longer copies use AVX2 when available (see `FIO_MEMALT_SIMD`).
  */
 SFUNC void *fio_memcpy(void *dest_, const void *src_, size_t bytes);
 
 /**
- * A token seeking function. This is a fallback for `memchr`, but `memchr`
- * should be faster.
+ * A token seeking function. This is a fallback for `memchr`.
+ *
+ * Longer buffers use SIMD kernels when available (see `FIO_MEMALT_SIMD`).
  */
 SFUNC void *fio_memchr(const void *buffer, const char token, size_t len);
 
 /**
- * A comparison function. This is a fallback for `memcmp`, but `memcmp`
- * should be faster.
+ * A comparison function. This is a fallback for `memcmp`.
+ *
+ * Longer buffers use SIMD kernels when available (see `FIO_MEMALT_SIMD`).
  */
 SFUNC int fio_memcmp(const void *a_, const void *b_, size_t len);
 
 /** An alternative to `strlen` - may raise Address Sanitation errors. */
 SFUNC size_t fio_strlen(const char *str);
 
+/** Returns the first occurrence of either `a` or `b` in `buffer` (or NULL). */
+SFUNC void *fio_memchr2(const void *buffer,
+                        const char a,
+                        const char b,
+                        size_t len);
+
+/** Returns the first occurrence of `a`, `b` or `c` in `buffer` (or NULL). */
+SFUNC void *fio_memchr3(const void *buffer,
+                        const char a,
+                        const char b,
+                        const char c,
+                        size_t len);
+
+/** A set of byte values (a byte class), see `fio_byte_class_init`. */
+typedef struct {
+  /** Non-zero for every byte value that belongs to the class. */
+  uint8_t map[256];
+  /* SIMD nibble lookup tables (valid only if `nibbles` is set) */
+  uint8_t lo[16];
+  uint8_t hi[16];
+  uint8_t nibbles;
+} fio_byte_class_s;
+
+/**
+ * Initializes a byte class from a 256 entry table (non-zero entries are
+ * members).
+ */
+SFUNC void fio_byte_class_init(fio_byte_class_s *dest,
+                               const uint8_t table[256]);
+
+/** Returns the first byte in `buffer` that belongs to the class (or NULL). */
+SFUNC void *fio_memchr_class(const void *buffer,
+                             const fio_byte_class_s *c,
+                             size_t len);
+
+/** Finds the first occurrence of `needle` in `haystack` (or NULL). */
+SFUNC void *fio_memmem(const void *haystack,
+                       size_t haystack_len,
+                       const void *needle,
+                       size_t needle_len);
+
 /* *****************************************************************************
 Alternatives - Implementation
 ***************************************************************************** */
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 
+/* *****************************************************************************
+SIMD kernels - shared helpers
+***************************************************************************** */
+
+/** Tests the remaining `memmem` candidates in [h, e), one at a time. */
+FIO_SFUNC void *fio___memmem_tail(const char *h,
+                                  const char *e,
+                                  const char *n,
+                                  size_t nl) {
+  for (; h < e; ++h)
+    if (h[0] == n[0] && h[nl - 1] == n[nl - 1] &&
+        !fio_memcmp(h + 1, n + 1, nl - 2))
+      return (void *)h;
+  return NULL;
+}
+
+/** Portable byte class scan (table lookup). */
+FIO_SFUNC void *fio___memchr_class_map(const char *r,
+                                       const fio_byte_class_s *c,
+                                       size_t len) {
+  const uint8_t *u = (const uint8_t *)r;
+  for (; len > 3; (u += 4), (len -= 4)) {
+    if (!(c->map[u[0]] | c->map[u[1]] | c->map[u[2]] | c->map[u[3]]))
+      continue;
+    len = 4; /* the member is in the next 4 bytes */
+    break;
+  }
+  for (; len; (++u), (--len))
+    if (c->map[*u])
+      return (void *)u;
+  return NULL;
+}
+
+/* *****************************************************************************
+SIMD kernels - x86-64 (SSE2 is part of the ABI, AVX2 is selected at startup)
+***************************************************************************** */
+#if FIO___MEMALT_SIMD_X86
+
+#define FIO___MEMALT_AVX2 __attribute__((target("avx2")))
+
+/** SSE2 `memchr` for buffers of 16 bytes or more. */
+FIO_SFUNC void *fio___memchr_sse2(const char *r, const char token, size_t len) {
+  const __m128i t = _mm_set1_epi8(token);
+  const char *const e = r + len;
+  uint32_t m;
+  for (; r + 64 <= e; r += 64) { /* test 64 bytes at a time */
+    const __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)r), t);
+    const __m128i b =
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(r + 16)), t);
+    const __m128i c =
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(r + 32)), t);
+    const __m128i d =
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(r + 48)), t);
+    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)r), t));
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)r), t));
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** AVX2 `memchr` for buffers of 16 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memchr_avx2(const char *r,
+                                                    const char token,
+                                                    size_t len) {
+  if (len < 32)
+    return fio___memchr_sse2(r, token, len);
+  const __m256i t = _mm256_set1_epi8(token);
+  const char *const e = r + len;
+  uint32_t m;
+  for (; r + 128 <= e; r += 128) { /* test 128 bytes at a time */
+    const __m256i a =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)r), t);
+    const __m256i b =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(r + 32)), t);
+    const __m256i c =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(r + 64)), t);
+    const __m256i d =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(r + 96)), t);
+    if (_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d))))
+      break;
+  }
+  for (; r + 32 <= e; r += 32) {
+    m = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)r), t));
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)r), t));
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** SSE2 `memcmp` for buffers of 16 bytes or more. */
+FIO_SFUNC int fio___memcmp_sse2(const char *a, const char *b, size_t len) {
+  size_t i = 0;
+  uint32_t m;
+  for (; i + 64 <= len; i += 64) { /* skip equal 64 byte groups */
+    __m128i eq = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                       _mm_loadu_si128((const __m128i *)(b + i))),
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i + 16)),
+                       _mm_loadu_si128((const __m128i *)(b + i + 16))));
+    eq = _mm_and_si128(
+        eq,
+        _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i + 32)),
+                           _mm_loadu_si128((const __m128i *)(b + i + 32))),
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i + 48)),
+                           _mm_loadu_si128((const __m128i *)(b + i + 48)))));
+    if (_mm_movemask_epi8(eq) != 0xFFFF)
+      break;
+  }
+  for (; i + 16 <= len; i += 16) {
+    m = 0xFFFFU ^ (uint32_t)_mm_movemask_epi8(
+                      _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                     _mm_loadu_si128((const __m128i *)(b + i))));
+    if (m)
+      goto found_diff;
+  }
+  if (i == len)
+    return 0;
+  i = len - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = 0xFFFFU ^ (uint32_t)_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                   _mm_loadu_si128((const __m128i *)(b + i))));
+  if (!m)
+    return 0;
+found_diff:
+  i += fio_lsb_index_unsafe(m);
+  return (int)1 - (int)(((uint8_t)b[i] > (uint8_t)a[i]) << 1);
+}
+
+/** AVX2 `memcmp` for buffers of 16 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 int fio___memcmp_avx2(const char *a,
+                                                  const char *b,
+                                                  size_t len) {
+  if (len < 32)
+    return fio___memcmp_sse2(a, b, len);
+  size_t i = 0;
+  uint32_t m;
+  for (; i + 128 <= len; i += 128) { /* skip equal 128 byte groups */
+    __m256i eq = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                          _mm256_loadu_si256((const __m256i *)(b + i))),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 32)),
+                          _mm256_loadu_si256((const __m256i *)(b + i + 32))));
+    eq = _mm256_and_si256(
+        eq,
+        _mm256_and_si256(
+            _mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i + 64)),
+                _mm256_loadu_si256((const __m256i *)(b + i + 64))),
+            _mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i + 96)),
+                _mm256_loadu_si256((const __m256i *)(b + i + 96)))));
+    if ((uint32_t)_mm256_movemask_epi8(eq) != 0xFFFFFFFFU)
+      break;
+  }
+  for (; i + 32 <= len; i += 32) {
+    m = ~(uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                          _mm256_loadu_si256((const __m256i *)(b + i))));
+    if (m)
+      goto found_diff;
+  }
+  if (i == len)
+    return 0;
+  i = len - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = ~(uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                        _mm256_loadu_si256((const __m256i *)(b + i))));
+  if (!m)
+    return 0;
+found_diff:
+  i += fio_lsb_index_unsafe(m);
+  return (int)1 - (int)(((uint8_t)b[i] > (uint8_t)a[i]) << 1);
+}
+
+/**
+ * SSE2 `strlen` - reads are aligned, so they never cross a page boundary (but
+ * may read before / after the string, which Address Sanitizer reports).
+ */
+FIO_SFUNC FIO___ASAN_AVOID size_t fio___strlen_sse2(const char *str) {
+  const __m128i z = _mm_setzero_si128();
+  const char *p = FIO_PTR_MATH_RMASK(const char, str, 4);
+  uint32_t m = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), z));
+  m >>= (uintptr_t)str & 15;
+  if (m)
+    return fio_lsb_index_unsafe(m);
+  for (p += 16; ((uintptr_t)p & 63); p += 16) { /* align to 64 bytes */
+    m = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+  for (;; p += 64) { /* the minimum of 64 bytes is zero if any byte is zero */
+    const __m128i mn = _mm_min_epu8(
+        _mm_min_epu8(_mm_load_si128((const __m128i *)p),
+                     _mm_load_si128((const __m128i *)(p + 16))),
+        _mm_min_epu8(_mm_load_si128((const __m128i *)(p + 32)),
+                     _mm_load_si128((const __m128i *)(p + 48))));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(mn, z)))
+      break;
+  }
+  for (;; p += 16) {
+    m = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+}
+
+/** AVX2 `strlen` (see `fio___strlen_sse2`). */
+FIO_SFUNC FIO___ASAN_AVOID FIO___MEMALT_AVX2 size_t
+fio___strlen_avx2(const char *str) {
+  const __m256i z = _mm256_setzero_si256();
+  const char *p = FIO_PTR_MATH_RMASK(const char, str, 5);
+  uint32_t m = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), z));
+  m >>= (uintptr_t)str & 31;
+  if (m)
+    return fio_lsb_index_unsafe(m);
+  for (p += 32; ((uintptr_t)p & 127); p += 32) { /* align to 128 bytes */
+    m = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+  for (;; p += 128) { /* the minimum of 128 bytes is zero if any byte is zero */
+    const __m256i mn = _mm256_min_epu8(
+        _mm256_min_epu8(_mm256_load_si256((const __m256i *)p),
+                        _mm256_load_si256((const __m256i *)(p + 32))),
+        _mm256_min_epu8(_mm256_load_si256((const __m256i *)(p + 64)),
+                        _mm256_load_si256((const __m256i *)(p + 96))));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(mn, z)))
+      break;
+  }
+  for (;; p += 32) {
+    m = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), z));
+    if (m)
+      return (size_t)(p - str) + fio_lsb_index_unsafe(m);
+  }
+}
+
+/**
+ * AVX2 forward copy for 64 bytes or more, returns the end of `dest`.
+ *
+ * Buffers may overlap only if `d` is more than 128 bytes before `s`.
+ */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memcpy_avx2(void *restrict d_,
+                                                    const void *restrict s_,
+                                                    size_t l) {
+  char *d = (char *)d_;
+  const char *s = (const char *)s_;
+  char *const end = d + l;
+  const __m256i head = _mm256_loadu_si256((const __m256i *)s);
+  const __m256i tail = _mm256_loadu_si256((const __m256i *)(s + l - 32));
+  const size_t skip = 32 - ((uintptr_t)d & 31); /* align stores */
+  _mm256_storeu_si256((__m256i *)d, head);
+  (d += skip), (s += skip), (l -= skip);
+  for (; l >= 128; (d += 128), (s += 128), (l -= 128)) {
+    const __m256i a = _mm256_loadu_si256((const __m256i *)s);
+    const __m256i b = _mm256_loadu_si256((const __m256i *)(s + 32));
+    const __m256i c = _mm256_loadu_si256((const __m256i *)(s + 64));
+    const __m256i e = _mm256_loadu_si256((const __m256i *)(s + 96));
+    _mm256_store_si256((__m256i *)d, a);
+    _mm256_store_si256((__m256i *)(d + 32), b);
+    _mm256_store_si256((__m256i *)(d + 64), c);
+    _mm256_store_si256((__m256i *)(d + 96), e);
+  }
+  if ((l & 64)) { /* no loop, compilers might replace it with `rep movs` */
+    const __m256i a = _mm256_loadu_si256((const __m256i *)s);
+    const __m256i b = _mm256_loadu_si256((const __m256i *)(s + 32));
+    _mm256_store_si256((__m256i *)d, a);
+    _mm256_store_si256((__m256i *)(d + 32), b);
+    (d += 64), (s += 64);
+  }
+  if ((l & 32))
+    _mm256_store_si256((__m256i *)d, _mm256_loadu_si256((const __m256i *)s));
+  _mm256_storeu_si256((__m256i *)(end - 32), tail);
+  return (void *)end;
+}
+
+/** SSE2 multi-token `memchr` (any of `a`, `b` or `c`), 16 bytes or more. */
+FIO_SFUNC void *fio___memchr3_sse2(const char *r,
+                                   const char a,
+                                   const char b,
+                                   const char c,
+                                   size_t len) {
+  const __m128i ta = _mm_set1_epi8(a);
+  const __m128i tb = _mm_set1_epi8(b);
+  const __m128i tc = _mm_set1_epi8(c);
+  const char *const e = r + len;
+  uint32_t m;
+#define FIO___MEMCHR3_TEST(ptr)                                                \
+  (uint32_t) _mm_movemask_epi8(_mm_or_si128(                                   \
+      _mm_or_si128(                                                            \
+          _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(ptr)), ta),         \
+          _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(ptr)), tb)),        \
+      _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(ptr)), tc)))
+  for (; r + 32 <= e; r += 32) { /* test 32 bytes at a time */
+    if ((FIO___MEMCHR3_TEST(r) | FIO___MEMCHR3_TEST(r + 16)))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = FIO___MEMCHR3_TEST(r);
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR3_TEST(r);
+#undef FIO___MEMCHR3_TEST
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** AVX2 multi-token `memchr` (any of `a`, `b` or `c`), 16 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memchr3_avx2(const char *r,
+                                                     const char a,
+                                                     const char b,
+                                                     const char c,
+                                                     size_t len) {
+  if (len < 32)
+    return fio___memchr3_sse2(r, a, b, c, len);
+  const __m256i ta = _mm256_set1_epi8(a);
+  const __m256i tb = _mm256_set1_epi8(b);
+  const __m256i tc = _mm256_set1_epi8(c);
+  const char *const e = r + len;
+  uint32_t m;
+#define FIO___MEMCHR3_TEST(ptr)                                                \
+  (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(                             \
+      _mm256_or_si256(                                                         \
+          _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(ptr)), ta),   \
+          _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(ptr)), tb)),  \
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(ptr)), tc)))
+  for (; r + 64 <= e; r += 64) { /* test 64 bytes at a time */
+    if ((FIO___MEMCHR3_TEST(r) | FIO___MEMCHR3_TEST(r + 32)))
+      break;
+  }
+  for (; r + 32 <= e; r += 32) {
+    m = FIO___MEMCHR3_TEST(r);
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR3_TEST(r);
+#undef FIO___MEMCHR3_TEST
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/** AVX2 byte class scan (nibble lookup, `pshufb`), 32 bytes or more. */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memchr_class_avx2(
+    const char *r,
+    const fio_byte_class_s *c,
+    size_t len) {
+  const __m256i lo =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)c->lo));
+  const __m256i hi =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)c->hi));
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i z = _mm256_setzero_si256();
+  const char *const e = r + len;
+  uint32_t m;
+#define FIO___MEMCHR_CLASS_TEST(ptr)                                           \
+  ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(                           \
+      _mm256_and_si256(                                                        \
+          _mm256_shuffle_epi8(                                                 \
+              lo,                                                              \
+              _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(ptr)),     \
+                               nibble)),                                       \
+          _mm256_shuffle_epi8(                                                 \
+              hi,                                                              \
+              _mm256_and_si256(                                                \
+                  _mm256_srli_epi16(                                           \
+                      _mm256_loadu_si256((const __m256i *)(ptr)),              \
+                      4),                                                      \
+                  nibble))),                                                   \
+      z))
+  for (; r + 32 <= e; r += 32) {
+    m = FIO___MEMCHR_CLASS_TEST(r);
+    if (m)
+      return (void *)(r + fio_lsb_index_unsafe(m));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 32; /* the last 32 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR_CLASS_TEST(r);
+#undef FIO___MEMCHR_CLASS_TEST
+  if (m)
+    return (void *)(r + fio_lsb_index_unsafe(m));
+  return NULL;
+}
+
+/**
+ * SSE2 `memmem` - tests the needle's first and last bytes for 16 positions at a
+ * time. Requires `2 <= nl <= hl`.
+ */
+FIO_SFUNC void *fio___memmem_sse2(const char *h,
+                                  size_t hl,
+                                  const char *n,
+                                  size_t nl) {
+  const __m128i first = _mm_set1_epi8(n[0]);
+  const __m128i last = _mm_set1_epi8(n[nl - 1]);
+  const char *const e = h + (hl - nl) + 1; /* candidates are in [h, e) */
+  for (; h + 16 <= e; h += 16) {
+    uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)h), first),
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(h + nl - 1)), last)));
+    for (; m; m &= m - 1) {
+      const char *p = h + fio_lsb_index_unsafe(m);
+      if (!fio_memcmp(p + 1, n + 1, nl - 2))
+        return (void *)p;
+    }
+  }
+  return fio___memmem_tail(h, e, n, nl);
+}
+
+/** AVX2 `memmem` (see `fio___memmem_sse2`). */
+FIO_SFUNC FIO___MEMALT_AVX2 void *fio___memmem_avx2(const char *h,
+                                                    size_t hl,
+                                                    const char *n,
+                                                    size_t nl) {
+  const __m256i first = _mm256_set1_epi8(n[0]);
+  const __m256i last = _mm256_set1_epi8(n[nl - 1]);
+  const char *const e = h + (hl - nl) + 1; /* candidates are in [h, e) */
+  for (; h + 32 <= e; h += 32) {
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)h), first),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(h + nl - 1)),
+                          last)));
+    for (; m; m &= m - 1) {
+      const char *p = h + fio_lsb_index_unsafe(m);
+      if (!fio_memcmp(p + 1, n + 1, nl - 2))
+        return (void *)p;
+    }
+  }
+  return fio___memmem_tail(h, e, n, nl);
+}
+
+/* the kernels in use - SSE2 until AVX2 support is detected (at startup) */
+static struct {
+  void *(*chr)(const char *, const char, size_t);
+  int (*cmp)(const char *, const char *, size_t);
+  size_t (*len)(const char *);
+  void *(*cpy)(void *restrict, const void *restrict, size_t);
+  void *(*chr3)(const char *, const char, const char, const char, size_t);
+  void *(*cls)(const char *, const fio_byte_class_s *, size_t);
+  void *(*mem)(const char *, size_t, const char *, size_t);
+} fio___memalt_simd = {
+    fio___memchr_sse2,
+    fio___memcmp_sse2,
+    fio___strlen_sse2,
+    fio___memcpy_unsafe_x,
+    fio___memchr3_sse2,
+    fio___memchr_class_map, /* SSE2 has no byte shuffle (pshufb) */
+    fio___memmem_sse2,
+};
+
+/* selects the best kernels supported by the CPU (cpuid) */
+FIO_CONSTRUCTOR(fio___memalt_simd_select) {
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("avx2"))
+    return;
+  fio___memalt_simd.chr = fio___memchr_avx2;
+  fio___memalt_simd.cmp = fio___memcmp_avx2;
+  fio___memalt_simd.len = fio___strlen_avx2;
+  fio___memalt_simd.cpy = fio___memcpy_avx2;
+  fio___memalt_simd.chr3 = fio___memchr3_avx2;
+  fio___memalt_simd.cls = fio___memchr_class_avx2;
+  fio___memalt_simd.mem = fio___memmem_avx2;
+}
+
+#undef FIO___MEMALT_AVX2
+
+/* *****************************************************************************
+SIMD kernels - aarch64 (NEON is part of the ABI)
+***************************************************************************** */
+#elif FIO___MEMALT_SIMD_NEON
+
+/** Packs a NEON byte comparison into a 64 bit map (4 bits per byte). */
+FIO_IFUNC uint64_t fio___memalt_neon_map(uint8x16_t eq) {
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)),
+      0);
+}
+
+/** NEON `memchr` for buffers of 16 bytes or more. */
+FIO_SFUNC void *fio___memchr_neon(const char *r, const char token, size_t len) {
+  const uint8x16_t t = vdupq_n_u8((uint8_t)token);
+  const char *const e = r + len;
+  uint64_t m;
+  for (; r + 64 <= e; r += 64) { /* test 64 bytes at a time */
+    const uint8x16_t a = vceqq_u8(vld1q_u8((const uint8_t *)r), t);
+    const uint8x16_t b = vceqq_u8(vld1q_u8((const uint8_t *)(r + 16)), t);
+    const uint8x16_t c = vceqq_u8(vld1q_u8((const uint8_t *)(r + 32)), t);
+    const uint8x16_t d = vceqq_u8(vld1q_u8((const uint8_t *)(r + 48)), t);
+    if (vmaxvq_u8(vorrq_u8(vorrq_u8(a, b), vorrq_u8(c, d))))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)r), t));
+    if (m)
+      return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)r), t));
+  if (m)
+    return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  return NULL;
+}
+
+/** NEON `memcmp` for buffers of 16 bytes or more. */
+FIO_SFUNC int fio___memcmp_neon(const char *a, const char *b, size_t len) {
+  size_t i = 0;
+  uint64_t m;
+  for (; i + 64 <= len; i += 64) { /* skip equal 64 byte groups */
+    uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(a + i)),
+                                      vld1q_u8((const uint8_t *)(b + i))),
+                             vceqq_u8(vld1q_u8((const uint8_t *)(a + i + 16)),
+                                      vld1q_u8((const uint8_t *)(b + i + 16))));
+    eq = vandq_u8(eq,
+                  vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(a + i + 32)),
+                                    vld1q_u8((const uint8_t *)(b + i + 32))),
+                           vceqq_u8(vld1q_u8((const uint8_t *)(a + i + 48)),
+                                    vld1q_u8((const uint8_t *)(b + i + 48)))));
+    if (vminvq_u8(eq) != 0xFF)
+      break;
+  }
+  for (; i + 16 <= len; i += 16) {
+    m = fio___memalt_neon_map(
+        vmvnq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(a + i)),
+                          vld1q_u8((const uint8_t *)(b + i)))));
+    if (m)
+      goto found_diff;
+  }
+  if (i == len)
+    return 0;
+  i = len - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = fio___memalt_neon_map(vmvnq_u8(vceqq_u8(
+      vld1q_u8((const uint8_t *)(a + i)), vld1q_u8((const uint8_t *)(b + i)))));
+  if (!m)
+    return 0;
+found_diff:
+  i += fio_lsb_index_unsafe(m) >> 2;
+  return (int)1 - (int)(((uint8_t)b[i] > (uint8_t)a[i]) << 1);
+}
+
+/** NEON `strlen` (aligned reads, see `fio_strlen`). */
+FIO_SFUNC FIO___ASAN_AVOID size_t fio___strlen_neon(const char *str) {
+  const uint8x16_t z = vdupq_n_u8(0);
+  const char *p = FIO_PTR_MATH_RMASK(const char, str, 4);
+  uint64_t m =
+      fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)p), z));
+  m >>= ((uintptr_t)str & 15) << 2;
+  if (m)
+    return fio_lsb_index_unsafe(m) >> 2;
+  for (p += 16; ((uintptr_t)p & 63); p += 16) { /* align to 64 bytes */
+    m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)p), z));
+    if (m)
+      return (size_t)(p - str) + (fio_lsb_index_unsafe(m) >> 2);
+  }
+  for (;; p += 64) { /* the minimum of 64 bytes is zero if any byte is zero */
+    const uint8x16_t mn =
+        vminq_u8(vminq_u8(vld1q_u8((const uint8_t *)p),
+                          vld1q_u8((const uint8_t *)(p + 16))),
+                 vminq_u8(vld1q_u8((const uint8_t *)(p + 32)),
+                          vld1q_u8((const uint8_t *)(p + 48))));
+    if (!vminvq_u8(mn))
+      break;
+  }
+  for (;; p += 16) {
+    m = fio___memalt_neon_map(vceqq_u8(vld1q_u8((const uint8_t *)p), z));
+    if (m)
+      return (size_t)(p - str) + (fio_lsb_index_unsafe(m) >> 2);
+  }
+}
+
+/** NEON multi-token `memchr` (any of `a`, `b` or `c`), 16 bytes or more. */
+FIO_SFUNC void *fio___memchr3_neon(const char *r,
+                                   const char a,
+                                   const char b,
+                                   const char c,
+                                   size_t len) {
+  const uint8x16_t ta = vdupq_n_u8((uint8_t)a);
+  const uint8x16_t tb = vdupq_n_u8((uint8_t)b);
+  const uint8x16_t tc = vdupq_n_u8((uint8_t)c);
+  const char *const e = r + len;
+  uint64_t m;
+#define FIO___MEMCHR3_TEST(ptr)                                                \
+  vorrq_u8(vorrq_u8(vceqq_u8(vld1q_u8((const uint8_t *)(ptr)), ta),            \
+                    vceqq_u8(vld1q_u8((const uint8_t *)(ptr)), tb)),           \
+           vceqq_u8(vld1q_u8((const uint8_t *)(ptr)), tc))
+  for (; r + 32 <= e; r += 32) { /* test 32 bytes at a time */
+    if (vmaxvq_u8(vorrq_u8(FIO___MEMCHR3_TEST(r), FIO___MEMCHR3_TEST(r + 16))))
+      break;
+  }
+  for (; r + 16 <= e; r += 16) {
+    m = fio___memalt_neon_map(FIO___MEMCHR3_TEST(r));
+    if (m)
+      return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = fio___memalt_neon_map(FIO___MEMCHR3_TEST(r));
+#undef FIO___MEMCHR3_TEST
+  if (m)
+    return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  return NULL;
+}
+
+/** NEON byte class scan (nibble lookup, `tbl`), 16 bytes or more. */
+FIO_SFUNC void *fio___memchr_class_neon(const char *r,
+                                        const fio_byte_class_s *c,
+                                        size_t len) {
+  const uint8x16_t lo = vld1q_u8(c->lo);
+  const uint8x16_t hi = vld1q_u8(c->hi);
+  const uint8x16_t nibble = vdupq_n_u8(0x0F);
+  const char *const e = r + len;
+  uint64_t m;
+#define FIO___MEMCHR_CLASS_TEST(ptr)                                           \
+  fio___memalt_neon_map(                                                       \
+      vtstq_u8(vqtbl1q_u8(lo,                                                  \
+                          vandq_u8(vld1q_u8((const uint8_t *)(ptr)), nibble)), \
+               vqtbl1q_u8(hi, vshrq_n_u8(vld1q_u8((const uint8_t *)(ptr)), 4))))
+  for (; r + 16 <= e; r += 16) {
+    m = FIO___MEMCHR_CLASS_TEST(r);
+    if (m)
+      return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  }
+  if (r == e)
+    return NULL;
+  r = e - 16; /* the last 16 bytes overlap bytes that were already tested */
+  m = FIO___MEMCHR_CLASS_TEST(r);
+#undef FIO___MEMCHR_CLASS_TEST
+  if (m)
+    return (void *)(r + (fio_lsb_index_unsafe(m) >> 2));
+  return NULL;
+}
+
+/** NEON `memmem` - tests the needle's first and last bytes (`2 <= nl <= hl`). */
+FIO_SFUNC void *fio___memmem_neon(const char *h,
+                                  size_t hl,
+                                  const char *n,
+                                  size_t nl) {
+  const uint8x16_t first = vdupq_n_u8((uint8_t)n[0]);
+  const uint8x16_t last = vdupq_n_u8((uint8_t)n[nl - 1]);
+  const char *const e = h + (hl - nl) + 1; /* candidates are in [h, e) */
+  for (; h + 16 <= e; h += 16) {
+    uint64_t m = fio___memalt_neon_map(
+        vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)h), first),
+                 vceqq_u8(vld1q_u8((const uint8_t *)(h + nl - 1)), last)));
+    for (m &= UINT64_C(0x1111111111111111); m; m &= m - 1) {
+      const char *p = h + (fio_lsb_index_unsafe(m) >> 2);
+      if (!fio_memcmp(p + 1, n + 1, nl - 2))
+        return (void *)p;
+    }
+  }
+  return fio___memmem_tail(h, e, n, nl);
+}
+
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+
 /* *****************************************************************************
 FIO_MEMCPY / fio_memcpy - memcpy fallback
 ***************************************************************************** */
@@ -160,6 +930,10 @@ SFUNC void *fio_memcpy(void *dest_, const void *src_, size_t bytes) {
 
   if (s + bytes <= d || d + bytes <= s ||
       (uintptr_t)d + FIO___MEMCPY_BLOCKx_NUM < (uintptr_t)s) {
+#if FIO___MEMALT_SIMD_X86
+    if (bytes > 127)
+      return fio___memalt_simd.cpy(d, s, bytes);
+#endif /* FIO___MEMALT_SIMD_X86 */
     return fio___memcpy_unsafe_x(d, s, bytes);
   } else if (d < s) { /* memory overlaps at end (copy forward, use buffer) */
     return fio___memcpy_buffered_x(d, s, bytes);
@@ -295,6 +1069,13 @@ FIO_SFUNC void *fio_memchr_small(const void *buffer,
 SFUNC void *fio_memchr(const void *buffer, const char token, size_t len) {
   if (!buffer || !len)
     return NULL;
+#if FIO___MEMALT_SIMD_X86
+  if (len > 15)
+    return fio___memalt_simd.chr((const char *)buffer, token, len);
+#elif FIO___MEMALT_SIMD_NEON
+  if (len > 15)
+    return fio___memchr_neon((const char *)buffer, token, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
   if (len < 64)
     return fio_memchr_small(buffer, token, len);
   const char *r = (const char *)buffer;
@@ -410,6 +1191,11 @@ SFUNC FIO___ASAN_AVOID size_t fio_strlen(const char *str) {
   // return (size_t)(nul - str);
   if (!str)
     return 0;
+#if FIO___MEMALT_SIMD_X86
+  return fio___memalt_simd.len(str);
+#elif FIO___MEMALT_SIMD_NEON
+  return fio___strlen_neon(str);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
   uintptr_t start = (uintptr_t)str;
   /* we must align memory, to avoid crushing when nearing last page boundary */
   switch ((start & 7)) {
@@ -551,6 +1337,11 @@ SFUNC int fio_memcmp(const void *a_, const void *b_, size_t len) {
     return fio___memcmp_mini(a, b, len);
   if (len < 16)
     return fio___memcmp8(a, b, len);
+#if FIO___MEMALT_SIMD_X86
+  return fio___memalt_simd.cmp(a, b, len);
+#elif FIO___MEMALT_SIMD_NEON
+  return fio___memcmp_neon(a, b, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
   if (len < 32)
     return fio___memcmp16(a, b, len);
   if (len < 1024)
@@ -566,6 +1357,163 @@ SFUNC int fio_memcmp(const void *a_, const void *b_, size_t len) {
 #endif /* FIO_LIMIT_INTRINSIC_BUFFER */
 }
 
+/* *****************************************************************************
+fio_memchr2 / fio_memchr3
+***************************************************************************** */
+
+/** Portable multi-token `memchr` - tests 8 bytes at a time. */
+FIO_SFUNC void *fio___memchr3_word(const char *r,
+                                   const char a,
+                                   const char b,
+                                   const char c,
+                                   size_t len) {
+  const uint64_t ma = UINT64_C(0x0101010101010101) * (uint8_t)a;
+  const uint64_t mb = UINT64_C(0x0101010101010101) * (uint8_t)b;
+  const uint64_t mc = UINT64_C(0x0101010101010101) * (uint8_t)c;
+  for (; len > 7; (r += 8), (len -= 8)) {
+    uint64_t w, f = 0;
+    fio_memcpy8(&w, r);
+#define FIO___MEMCHR3_HAS_ZERO(u)                                              \
+  (((u)-UINT64_C(0x0101010101010101)) & (~(u)) & UINT64_C(0x8080808080808080))
+    f |= FIO___MEMCHR3_HAS_ZERO(w ^ ma);
+    f |= FIO___MEMCHR3_HAS_ZERO(w ^ mb);
+    f |= FIO___MEMCHR3_HAS_ZERO(w ^ mc);
+#undef FIO___MEMCHR3_HAS_ZERO
+    if (f)
+      break; /* the token is in the next 8 bytes */
+  }
+  for (; len; (++r), (--len))
+    if (*r == a || *r == b || *r == c)
+      return (void *)r;
+  return NULL;
+}
+
+/** Returns the first occurrence of either `a` or `b` in `buffer` (or NULL). */
+SFUNC void *fio_memchr2(const void *buffer,
+                        const char a,
+                        const char b,
+                        size_t len) {
+  return fio_memchr3(buffer, a, b, b, len);
+}
+
+/** Returns the first occurrence of `a`, `b` or `c` in `buffer` (or NULL). */
+SFUNC void *fio_memchr3(const void *buffer,
+                        const char a,
+                        const char b,
+                        const char c,
+                        size_t len) {
+  if (!buffer || !len)
+    return NULL;
+#if FIO___MEMALT_SIMD_X86
+  if (len > 15)
+    return fio___memalt_simd.chr3((const char *)buffer, a, b, c, len);
+#elif FIO___MEMALT_SIMD_NEON
+  if (len > 15)
+    return fio___memchr3_neon((const char *)buffer, a, b, c, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+  return fio___memchr3_word((const char *)buffer, a, b, c, len);
+}
+
+/* *****************************************************************************
+Byte classes (fio_memchr_class)
+***************************************************************************** */
+
+/**
+ * Initializes a byte class from a 256 entry table (non-zero entries are
+ * members).
+ *
+ * SIMD lookups split each byte into two nibbles and test
+ * `lo[byte & 15] & hi[byte >> 4]`. This is exact as long as the table holds no
+ * more than 8 distinct (non-empty) rows of 16 bytes - which covers most
+ * delimiter sets. Otherwise the class is scanned one byte at a time.
+ */
+SFUNC void fio_byte_class_init(fio_byte_class_s *dest,
+                               const uint8_t table[256]) {
+  uint16_t rows[8];
+  size_t count = 0;
+  FIO_MEMSET(dest, 0, sizeof(*dest));
+  dest->nibbles = 1;
+  for (size_t h = 0; h < 16; ++h) {
+    uint16_t row = 0;
+    for (size_t l = 0; l < 16; ++l) {
+      dest->map[(h << 4) | l] = !!table[(h << 4) | l];
+      row |= (uint16_t)(dest->map[(h << 4) | l] << l);
+    }
+    if (!row)
+      continue;
+    size_t k = 0;
+    while (k < count && rows[k] != row)
+      ++k;
+    if (k == count) {
+      if (count == 8) { /* too many distinct rows for 8 bit nibble tables */
+        dest->nibbles = 0;
+        continue;
+      }
+      rows[count++] = row;
+    }
+    dest->hi[h] |= (uint8_t)(1U << k);
+  }
+  if (!dest->nibbles) {
+    FIO_MEMSET(dest->lo, 0, sizeof(dest->lo));
+    FIO_MEMSET(dest->hi, 0, sizeof(dest->hi));
+    return;
+  }
+  for (size_t k = 0; k < count; ++k)
+    for (size_t l = 0; l < 16; ++l)
+      if ((rows[k] >> l) & 1)
+        dest->lo[l] |= (uint8_t)(1U << k);
+}
+
+/** Returns the first byte in `buffer` that belongs to the class (or NULL). */
+SFUNC void *fio_memchr_class(const void *buffer,
+                             const fio_byte_class_s *c,
+                             size_t len) {
+  if (!buffer || !len || !c)
+    return NULL;
+#if FIO___MEMALT_SIMD_X86
+  if (c->nibbles && len > 31)
+    return fio___memalt_simd.cls((const char *)buffer, c, len);
+#elif FIO___MEMALT_SIMD_NEON
+  if (c->nibbles && len > 15)
+    return fio___memchr_class_neon((const char *)buffer, c, len);
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+  return fio___memchr_class_map((const char *)buffer, c, len);
+}
+
+/* *****************************************************************************
+fio_memmem
+***************************************************************************** */
+
+/** Finds the first occurrence of `needle` in `haystack` (or NULL). */
+SFUNC void *fio_memmem(const void *haystack,
+                       size_t haystack_len,
+                       const void *needle,
+                       size_t needle_len) {
+  const char *h = (const char *)haystack;
+  const char *n = (const char *)needle;
+  if (!needle_len)
+    return (void *)h;
+  if (!h || !n || needle_len > haystack_len)
+    return NULL;
+  if (needle_len == 1)
+    return fio_memchr(h, n[0], haystack_len);
+#if FIO___MEMALT_SIMD_X86
+  return fio___memalt_simd.mem(h, haystack_len, n, needle_len);
+#elif FIO___MEMALT_SIMD_NEON
+  return fio___memmem_neon(h, haystack_len, n, needle_len);
+#else
+  /* seek the first byte, test the last byte, then compare the rest */
+  const char *const e = h + (haystack_len - needle_len) + 1;
+  while ((h = (const char *)fio_memchr(h, n[0], (size_t)(e - h)))) {
+    if (h[needle_len - 1] == n[needle_len - 1] &&
+        !fio_memcmp(h + 1, n + 1, needle_len - 2))
+      return (void *)h;
+    ++h;
+  }
+  return NULL;
+#endif /* FIO___MEMALT_SIMD_X86 / FIO___MEMALT_SIMD_NEON */
+}
+
 /* *****************************************************************************
 Alternatives - cleanup
 ***************************************************************************** */
@@ -123,6 +123,7 @@ typedef enum {
 #define FIO_SOCK_UNIX         0
 #define FIO_SOCK_UNIX_PRIVATE 0
 #endif
+  FIO_SOCK_REUSEPORT = 64,
 } fio_sock_open_flags_e;
 
 /**
@@ -152,8 +153,13 @@ FIO_IFUNC struct addrinfo *fio_sock_address_new(const char *restrict address,
 /** Frees the pointer returned by `fio_sock_address_new`. */
 FIO_IFUNC void fio_sock_address_free(struct addrinfo *a);
 
-/** Creates a new network socket and binds it to a local address. */
-SFUNC int fio_sock_open_local(struct addrinfo *addr, int nonblock);
+/**
+ * Creates a new network socket and binds it to a local address.
+ *
+ * `flags` may be a boolean (non-blocking) or a combination of
+ * `FIO_SOCK_NONBLOCK` and `FIO_SOCK_REUSEPORT`.
+ */
+SFUNC int fio_sock_open_local(struct addrinfo *addr, int flags);
 
 /** Creates a new network socket and connects it to a remote address. */
 SFUNC int fio_sock_open_remote(struct addrinfo *addr, int nonblock);
@@ -214,7 +220,9 @@ FIO_IFUNC int fio_sock_open(const char *restrict address,
     if ((flags & FIO_SOCK_CLIENT)) {
       fd = fio_sock_open_remote(addr, (flags & FIO_SOCK_NONBLOCK));
     } else {
-      fd = fio_sock_open_local(addr, (flags & FIO_SOCK_NONBLOCK));
+      fd = fio_sock_open_local(
+          addr,
+          (flags & ((int)FIO_SOCK_NONBLOCK | (int)FIO_SOCK_REUSEPORT)));
       if (fd != -1 && listen(fd, SOMAXCONN) == -1) {
         FIO_LOG_ERROR("(fio_sock_open) failed on call to listen: %s",
                       strerror(errno));
@@ -233,7 +241,9 @@ FIO_IFUNC int fio_sock_open(const char *restrict address,
     if ((flags & FIO_SOCK_CLIENT)) {
       fd = fio_sock_open_remote(addr, (flags & FIO_SOCK_NONBLOCK));
     } else {
-      fd = fio_sock_open_local(addr, (flags & FIO_SOCK_NONBLOCK));
+      fd = fio_sock_open_local(
+          addr,
+          (flags & ((int)FIO_SOCK_NONBLOCK | (int)FIO_SOCK_REUSEPORT)));
     }
     fio_sock_address_free(addr);
     return fd;
@@ -392,7 +402,7 @@ SFUNC int fio_sock_set_non_block(int fd) {
 }
 
 /** Creates a new network socket and binds it to a local address. */
-SFUNC int fio_sock_open_local(struct addrinfo *addr, int nonblock) {
+SFUNC int fio_sock_open_local(struct addrinfo *addr, int flags) {
   int fd = -1;
   for (struct addrinfo *p = addr; p != NULL; p = p->ai_next) {
 #if FIO_OS_WIN
@@ -417,8 +427,18 @@ SFUNC int fio_sock_open_local(struct addrinfo *addr, int nonblock) {
       // avoid the "address taken"
       int optval = 1;
       setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (void *)&optval, sizeof(optval));
+#ifdef SO_REUSEPORT
+      // share the port with other sockets (the kernel load-balances them)
+      if ((flags & FIO_SOCK_REUSEPORT))
+        setsockopt(fd,
+                   SOL_SOCKET,
+                   SO_REUSEPORT,
+                   (void *)&optval,
+                   sizeof(optval));
+#endif
     }
-    if (nonblock && fio_sock_set_non_block(fd) == -1) {
+    if ((flags & ~(int)FIO_SOCK_REUSEPORT) &&
+        fio_sock_set_non_block(fd) == -1) {
       FIO_LOG_DEBUG("Couldn't set socket (%d) to non-blocking mode %s",
                     fd,
                     strerror(errno));
@@ -114,9 +114,9 @@ typedef struct {
 } fio___state_task_s;
 
 FIO_IFUNC uint64_t fio___state_callback_hash_fn(fio___state_task_s *t) {
-  uint64_t hash = fio_risky_ptr((void *)(uintptr_t)(t->func));
-  hash ^= hash + fio_risky_ptr(t->arg);
-  return hash;
+  /* note: `h ^ (h + x)` collides for most `h` values when `x` is constant */
+  return fio_risky_num((uint64_t)(uintptr_t)t->arg,
+                       fio_risky_ptr((void *)(uintptr_t)(t->func)));
 }
 
 #define FIO_STATE_CALLBACK_IS_VALID(pobj) ((pobj)->func)
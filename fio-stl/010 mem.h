@@ -80,15 +80,19 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, free)(void *ptr);
 
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  */
 SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc)(void *ptr,
                                                              size_t new_size);
 
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  *
  * This variation is slightly faster as it might copy less data.
  */
@@ -113,6 +117,15 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size);
  */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void);
 
+/**
+ * Returns idle cached system allocations to the system, according to the
+ * FIO_MEMORY_CACHE_DECAY policy (does nothing if the policy is disabled).
+ *
+ * Called automatically by the `FIO_CALL_ON_IDLE` state callback. Could also be
+ * called by a timer, so memory is released while the process is idle.
+ */
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)(void);
+
 /* *****************************************************************************
 Memory Allocation - configuration macros
 
@@ -145,6 +158,18 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_CACHE_SLOTS 4
 #endif
 
+#ifndef FIO_MEMORY_CACHE_DECAY
+/**
+ * The number of milliseconds after which an idle cached system allocation is
+ * released to the system (using `madvise`, the mapping is kept).
+ *
+ * After twice this time, the idle cached allocation is unmapped.
+ *
+ * Zero (the default) disables the decay (cached allocations are kept).
+ */
+#define FIO_MEMORY_CACHE_DECAY 0
+#endif
+
 #ifndef FIO_MEMORY_INITIALIZE_ALLOCATIONS
 /**
  * Forces the allocator to zero out memory early and often, so allocations
@@ -183,6 +208,17 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_ENABLE_BIG_ALLOC 1
 #endif
 
+#ifndef FIO_MEMORY_SLAB_LIMIT
+/**
+ * Allocations of up to this many bytes are served from size-class slabs
+ * (blocks dedicated to a single allocation size, tracked by a bitmap).
+ *
+ * Freed slab slots are reused right away, so a long lived allocation doesn't
+ * pin a whole block. Zero (the default) disables slabs. Limited to 1024 bytes.
+ */
+#define FIO_MEMORY_SLAB_LIMIT 0
+#endif
+
 #ifndef FIO_MEMORY_ARENA_COUNT
 /**
  * Memory arenas mitigate thread contention while using more memory.
@@ -195,6 +231,23 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_ARENA_COUNT -1
 #endif
 
+#ifndef FIO_MEMORY_THREAD_CACHE
+/**
+ * If true, each thread slices a private block before falling back to the
+ * (locked) arenas, so most allocations never touch an arena lock.
+ *
+ * The block is returned to the allocator when the thread exits.
+ *
+ * Requires POSIX threads (`pthread_key_create`), ignored otherwise.
+ */
+#define FIO_MEMORY_THREAD_CACHE 0
+#endif
+
+#if FIO_MEMORY_THREAD_CACHE && !FIO_OS_POSIX
+#undef FIO_MEMORY_THREAD_CACHE
+#define FIO_MEMORY_THREAD_CACHE 0
+#endif
+
 #ifndef FIO_MEMORY_ARENA_COUNT_FALLBACK
 /*
  * Used when dynamic arena count calculations fail.
@@ -219,6 +272,73 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_WARMUP 0
 #endif
 
+#ifndef FIO_MEMORY_HUGE_PAGES
+/**
+ * Backs allocator chunks with 2MB huge pages, reducing TLB misses.
+ *
+ * - 0: disabled (default).
+ * - 1: transparent huge pages (`madvise(MADV_HUGEPAGE)`).
+ * - 2: explicit huge pages (`MAP_HUGETLB`), falling back to transparent huge
+ *      pages when the system has no huge pages reserved.
+ *
+ * Chunks are aligned to 2MB, so FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG should be
+ * 21 or more (otherwise the setting is ignored). POSIX only.
+ */
+#define FIO_MEMORY_HUGE_PAGES 0
+#endif
+
+#ifndef FIO_MEMORY_NUMA
+/**
+ * If true, arenas are grouped by NUMA node. Threads use the arenas of the node
+ * they are running on and new chunks are bound (`mbind`) to that node.
+ *
+ * On single node machines the allocator behaves as if NUMA mode was disabled.
+ * Linux only, ignored otherwise.
+ */
+#define FIO_MEMORY_NUMA 0
+#endif
+
+#ifndef FIO_MEMORY_NUMA_MAX_NODES
+/**
+ * The maximum number of NUMA nodes (when FIO_MEMORY_NUMA is true). Nodes above
+ * the limit share arenas with lower nodes and their chunks aren't bound.
+ *
+ * Limited to 64 nodes.
+ */
+#define FIO_MEMORY_NUMA_MAX_NODES 8
+#endif
+
+#if FIO_MEMORY_NUMA && !defined(__linux__)
+#undef FIO_MEMORY_NUMA
+#define FIO_MEMORY_NUMA 0
+#endif
+
+#ifndef FIO_MEMORY_PROFILE
+/**
+ * Enables the sampling heap profiler when set to the average number of bytes
+ * between samples (i.e., 524288 samples about once every 512Kb allocated).
+ *
+ * Sampled allocations record a backtrace and are tracked until freed, so the
+ * live heap can be dumped using `malloc_profile_dump`.
+ *
+ * Defaults to 0 (disabled, no profiling code is compiled).
+ */
+#define FIO_MEMORY_PROFILE 0
+#endif
+
+#ifndef FIO_MEMORY_PROFILE_DEPTH
+/** The maximum number of stack frames recorded for each sample. */
+#define FIO_MEMORY_PROFILE_DEPTH 32
+#endif
+
+#ifndef FIO_MEMORY_PROFILE_SLOTS
+/**
+ * The maximum number of live samples tracked by the heap profiler (rounded up
+ * to a power of 2). When the table is full, new samples are dropped.
+ */
+#define FIO_MEMORY_PROFILE_SLOTS 1024
+#endif
+
 #ifndef FIO_MEMORY_USE_THREAD_MUTEX
 #if FIO_USE_THREAD_MUTEX_TMP
 #define FIO_MEMORY_USE_THREAD_MUTEX 1
@@ -266,6 +386,46 @@ Memory Allocation - configuration value - results and constants
 #undef FIO_MEMORY_SYS_ALLOCATION_SIZE
 #undef FIO_MEMORY_BLOCK_ALLOC_LIMIT
 
+#if FIO_MEMORY_HUGE_PAGES &&                                                   \
+    (!FIO_OS_POSIX || FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG < 21)
+#undef FIO_MEMORY_HUGE_PAGES
+#define FIO_MEMORY_HUGE_PAGES 0
+#endif
+
+/* the heap profiler collects backtraces using `execinfo.h` */
+#if FIO_MEMORY_PROFILE && defined(__has_include)
+#if !__has_include(<execinfo.h>)
+#undef FIO_MEMORY_PROFILE
+#define FIO_MEMORY_PROFILE 0
+#endif
+#elif FIO_MEMORY_PROFILE && !FIO_OS_POSIX
+#undef FIO_MEMORY_PROFILE
+#define FIO_MEMORY_PROFILE 0
+#endif
+
+#if FIO_MEMORY_PROFILE
+#if FIO_MEMORY_PROFILE < 0
+#undef FIO_MEMORY_PROFILE
+#define FIO_MEMORY_PROFILE 524288
+#endif
+#if FIO_MEMORY_PROFILE_DEPTH < 2
+#undef FIO_MEMORY_PROFILE_DEPTH
+#define FIO_MEMORY_PROFILE_DEPTH 2
+#endif
+#undef FIO_MEMORY_PROFILE_SLOTS_LOG
+#if FIO_MEMORY_PROFILE_SLOTS <= 64
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 6
+#elif FIO_MEMORY_PROFILE_SLOTS <= 256
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 8
+#elif FIO_MEMORY_PROFILE_SLOTS <= 1024
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 10
+#elif FIO_MEMORY_PROFILE_SLOTS <= 4096
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 12
+#else
+#define FIO_MEMORY_PROFILE_SLOTS_LOG 14
+#endif
+#endif /* FIO_MEMORY_PROFILE */
+
 #if FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG < 0 ||                                \
     FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG > 5
 #undef FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG
@@ -298,6 +458,28 @@ Memory Allocation - configuration value - results and constants
 #define FIO_MEMORY_ALLOC_LIMIT FIO_MEMORY_BLOCK_ALLOC_LIMIT
 #endif
 
+#undef FIO_MEMORY_SLAB_CLASSES
+#if FIO_MEMORY_SLAB_LIMIT > 1024
+#undef FIO_MEMORY_SLAB_LIMIT
+#define FIO_MEMORY_SLAB_LIMIT 1024
+#endif
+/** the number of slab size classes (one class per allocation unit count) */
+#define FIO_MEMORY_SLAB_CLASSES (FIO_MEMORY_SLAB_LIMIT >> FIO_MEMORY_ALIGN_LOG)
+
+/** the number of free block lists (one per NUMA node) */
+#if FIO_MEMORY_NUMA
+#if FIO_MEMORY_NUMA_MAX_NODES > 64
+#undef FIO_MEMORY_NUMA_MAX_NODES
+#define FIO_MEMORY_NUMA_MAX_NODES 64
+#elif FIO_MEMORY_NUMA_MAX_NODES < 1
+#undef FIO_MEMORY_NUMA_MAX_NODES
+#define FIO_MEMORY_NUMA_MAX_NODES 1
+#endif
+#define FIO_MEMORY_NUMA_LISTS FIO_MEMORY_NUMA_MAX_NODES
+#else
+#define FIO_MEMORY_NUMA_LISTS 1
+#endif
+
 /* *****************************************************************************
 Memory Allocation - configuration access - UNSTABLE API!!!
 ***************************************************************************** */
@@ -309,6 +491,9 @@ FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_sys_alloc_size)(void) {
 FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_cache_slots)(void) {
   return FIO_MEMORY_CACHE_SLOTS;
 }
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay_time)(void) {
+  return (FIO_MEMORY_CACHE_SLOTS ? FIO_MEMORY_CACHE_DECAY : 0);
+}
 FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_alignment)(void) {
   return FIO_MEMORY_ALIGN_SIZE;
 }
@@ -343,6 +528,125 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_free_block_list)(void);
 /** Prints the settings used to define the allocator. */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void);
 
+/* *****************************************************************************
+Memory Allocation - statistics
+***************************************************************************** */
+
+/** Allocator wide statistics, see `malloc_stats`. */
+typedef struct {
+  /** the number of arenas. */
+  size_t arenas;
+  /** system allocations (chunks) currently held, including cached chunks. */
+  size_t chunks_mapped;
+  /** system allocations (chunks) in the cache, waiting to be reused. */
+  size_t chunks_cached;
+  /** mapped blocks in the free block list (available for arenas / slabs). */
+  size_t blocks_free;
+  /** bytes sliced from the current big-block. */
+  size_t big_block_bytes;
+  /** live allocations in the current big-block. */
+  size_t big_block_allocations;
+  /** slab slots (all size classes). */
+  size_t slab_slots;
+  /** slab slots in use (all size classes). */
+  size_t slab_slots_used;
+  /** the number of times a thread found its arena locked and switched. */
+  size_t arena_switches;
+  /** allocations redirected to `mmap` because of their size (total). */
+  size_t mmap_redirects;
+  /** live allocations made using `mmap`. */
+  size_t mmap_allocations;
+  /** bytes mapped by live `mmap` allocations. */
+  size_t mmap_bytes;
+} FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s);
+
+/** Arena statistics, see `malloc_arena_stats`. */
+typedef struct {
+  /** bytes sliced from the arena's current block (still in the block). */
+  size_t block_bytes;
+  /** bytes allocated using the arena (total). */
+  size_t bytes;
+  /** allocations made using the arena (total). */
+  size_t allocations;
+  /** the number of times the arena was found locked (contention). */
+  size_t contended;
+  /** blocks emptied by other threads and reclaimed by the arena (total). */
+  size_t reclaimed;
+} FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s);
+
+/**
+ * Returns a snapshot of the allocator's statistics.
+ *
+ * The snapshot is collected without stopping other threads, so values might be
+ * slightly out of sync with each other.
+ */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void);
+
+/**
+ * Returns a snapshot of an arena's statistics.
+ *
+ * Valid indexes are smaller than the `arenas` value reported by
+ * `malloc_stats`. Returns an all zero snapshot if the arena doesn't exist.
+ */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(size_t index);
+
+/* *****************************************************************************
+Memory Allocation - heap profiler
+***************************************************************************** */
+
+/**
+ * Writes the sampled live allocations (the heap profile) to `fd`.
+ *
+ * If `folded` is zero, the (legacy) pprof heap profile text format is used.
+ * Otherwise, the folded stack format used by flame graph tools is used.
+ *
+ * Returns -1 on error. If the allocator wasn't compiled with
+ * FIO_MEMORY_PROFILE, -1 is returned and `errno` is set to `ENOTSUP`.
+ */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded);
+
+/**
+ * Writes the heap profile (pprof format) to `filename` whenever the process
+ * receives `sig`. The file is overwritten by each dump.
+ *
+ * The dump is deferred until `fio_signal_review` is called (the server does so
+ * automatically), so it never runs within a signal handler.
+ *
+ * Returns -1 on error. If the allocator wasn't compiled with
+ * FIO_MEMORY_PROFILE, -1 is returned and `errno` is set to `ENOTSUP`.
+ */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename);
+
+/* *****************************************************************************
+Memory Allocation - NUMA topology
+***************************************************************************** */
+
+/**
+ * Returns the number of NUMA nodes the allocator's arenas are grouped by.
+ *
+ * Returns 1 on single node machines or if the allocator wasn't compiled with
+ * FIO_MEMORY_NUMA.
+ */
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void);
+
+/**
+ * Overrides the detected NUMA topology (i.e., for testing).
+ *
+ * `nodes` is the number of nodes and `node` returns the calling thread's node.
+ * Chunks aren't bound to faked nodes. If `nodes` is zero, the detected topology
+ * is restored.
+ *
+ * Should be called before starting any threads. Returns -1 on error. If the
+ * allocator wasn't compiled with FIO_MEMORY_NUMA, -1 is returned and `errno` is
+ * set to `ENOTSUP`.
+ */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void));
+
 /* *****************************************************************************
 Set global macros to use this allocator if FIO_MALLOC
 ***************************************************************************** */
@@ -546,6 +850,76 @@ FIO_IFUNC void FIO_MEM_SYS_FREE_def_func(void *mem, size_t bytes) {
   munmap(mem, bytes);
 }
 
+/* the logarithmic size of a (2MB) huge page */
+#define FIO_MEM_HUGE_PAGE_SIZE_LOG 21
+
+/*
+ * allocates memory backed by huge pages, aligned to (at least) 2MB.
+ *
+ * Explicit huge pages (`MAP_HUGETLB`) are attempted only if `hugetlb` is set.
+ * Once the attempt fails, transparent huge pages are used instead.
+ */
+FIO_SFUNC void *FIO_MEM_SYS_ALLOC_HUGE_def_func(size_t bytes,
+                                                uint8_t alignment_log,
+                                                int hugetlb) {
+  void *result;
+  const size_t huge_mask = (1ULL << FIO_MEM_HUGE_PAGE_SIZE_LOG) - 1;
+  if (alignment_log < FIO_MEM_HUGE_PAGE_SIZE_LOG)
+    alignment_log = FIO_MEM_HUGE_PAGE_SIZE_LOG;
+  bytes = (bytes + huge_mask) & (~huge_mask);
+#if defined(MAP_HUGETLB)
+  static volatile uint8_t explicit_failed;
+  if (hugetlb && !explicit_failed) {
+    /* huge page mappings are 2MB aligned, stricter alignment requires trim */
+    const size_t alignment_size = (1ULL << alignment_log);
+    const size_t extra =
+        (alignment_log > FIO_MEM_HUGE_PAGE_SIZE_LOG) ? alignment_size : 0;
+    result = mmap(NULL,
+                  bytes + extra,
+                  PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                  -1,
+                  0);
+    if (result != MAP_FAILED) {
+      if (extra) {
+        const uintptr_t offset =
+            (alignment_size - ((uintptr_t)result & (alignment_size - 1))) &
+            (alignment_size - 1);
+        if (offset)
+          munmap(result, offset);
+        result = (void *)((uintptr_t)result + offset);
+        munmap((void *)((uintptr_t)result + bytes), extra - offset);
+      }
+      return result;
+    }
+    explicit_failed = 1;
+    FIO_LOG_DEBUG2("explicit huge pages unavailable (MAP_HUGETLB failed), "
+                   "using transparent huge pages.");
+  }
+#endif /* MAP_HUGETLB */
+  result = FIO_MEM_SYS_ALLOC_def_func(bytes, alignment_log);
+#if defined(MADV_HUGEPAGE)
+  if (result)
+    madvise(result, bytes, MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+  return result;
+  (void)hugetlb;
+}
+
+/* returns the memory's physical pages to the system, keeping the mapping. */
+FIO_SFUNC void FIO_MEM_SYS_PURGE_def_func(void *mem, size_t bytes) {
+  bytes = FIO_MEM_BYTES2PAGES(bytes);
+#if defined(MADV_FREE)
+  if (!madvise(mem, bytes, MADV_FREE))
+    return;
+#endif /* MADV_FREE */
+#if defined(MADV_DONTNEED)
+  madvise(mem, bytes, MADV_DONTNEED);
+#endif /* MADV_DONTNEED */
+  (void)mem;
+  (void)bytes;
+}
+
 /* *****************************************************************************
 
 
@@ -679,8 +1053,31 @@ Overridable system allocation macros
 #define FIO_MEM_SYS_REALLOC(ptr, old_pages, new_pages, alignment_log)          \
   FIO_MEM_SYS_REALLOC_def_func((ptr), (old_pages), (new_pages), (alignment_log))
 #define FIO_MEM_SYS_FREE(ptr, pages) FIO_MEM_SYS_FREE_def_func((ptr), (pages))
+#if FIO_OS_POSIX || __has_include("sys/mman.h")
+#define FIO_MEM_SYS_ALLOC_HUGE(pages, alignment_log, hugetlb)                  \
+  FIO_MEM_SYS_ALLOC_HUGE_def_func((pages), (alignment_log), (hugetlb))
+#define FIO_MEM_SYS_PURGE(ptr, pages) FIO_MEM_SYS_PURGE_def_func((ptr), (pages))
+#endif
 #endif /* FIO_MEM_SYS_ALLOC */
 
+#ifndef FIO_MEM_SYS_PURGE
+/* custom (or non-POSIX) system allocators keep the memory until it's freed */
+#define FIO_MEM_SYS_PURGE(ptr, pages) ((void)(ptr), (void)(pages))
+#endif /* FIO_MEM_SYS_PURGE */
+
+/* monotonic milliseconds, for the allocator's cache decay */
+FIO_IFUNC int64_t fio___mem_time_milli(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return ((int64_t)t.tv_sec * 1000) + ((int64_t)t.tv_nsec / 1000000);
+}
+
+#ifndef FIO_MEM_SYS_ALLOC_HUGE
+/* custom (or non-POSIX) system allocators ignore huge page requests */
+#define FIO_MEM_SYS_ALLOC_HUGE(pages, alignment_log, hugetlb)                  \
+  FIO_MEM_SYS_ALLOC((pages), (alignment_log))
+#endif /* FIO_MEM_SYS_ALLOC_HUGE */
+
 #endif /* H___FIO_MEM_INCLUDE_ONCE___H */
 
 /* *****************************************************************************
@@ -721,6 +1118,37 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size) {
 }
 
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {}
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)(void) {}
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s) r = {0};
+  return r;
+}
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(size_t index) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s) r = {0};
+  return r;
+  (void)index;
+}
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded) {
+  errno = ENOTSUP;
+  return -1;
+  (void)fd, (void)folded;
+}
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename) {
+  errno = ENOTSUP;
+  return -1;
+  (void)sig, (void)filename;
+}
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void) { return 1; }
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void)) {
+  errno = ENOTSUP;
+  return -1;
+  (void)nodes, (void)node;
+}
 /** Prints the allocator's data structure. May be used for debugging. */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {}
 /** Prints the allocator's free block list. May be used for debugging. */
@@ -877,6 +1305,8 @@ Chunk and Block data / header
 typedef struct {
   volatile int32_t ref;
   volatile int32_t pos;
+  /* the arena slicing the block (index + 1), or 0 */
+  int32_t arena;
 } FIO_NAME(FIO_MEMORY_NAME, __mem_block_s);
 
 typedef struct {
@@ -885,6 +1315,10 @@ typedef struct {
   volatile int32_t ref;
   FIO_NAME(FIO_MEMORY_NAME, __mem_block_s)
   blocks[FIO_MEMORY_BLOCKS_PER_ALLOCATION];
+#if FIO_MEMORY_NUMA
+  /* the NUMA node the chunk was allocated for (after the big-block header) */
+  uint32_t node;
+#endif /* FIO_MEMORY_NUMA */
 } FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s);
 
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
@@ -900,12 +1334,443 @@ typedef struct {
 /* *****************************************************************************
 Arena type
 ***************************************************************************** */
+/* arenas are padded to a multiple of this size to prevent false sharing */
+#define FIO___MEM_ARENA_ALIGN 128
+/* remote-free lists are returned to the free list once they reach this size */
+#define FIO___MEM_REMOTE_FREE_LIMIT                                            \
+  (FIO_MEMORY_BLOCKS_PER_ALLOCATION < 4 ? 4 : FIO_MEMORY_BLOCKS_PER_ALLOCATION)
+
+#define FIO___MEM_ARENA_FIELDS                                                 \
+  void *block;                                                                 \
+  int32_t last_pos;                                                            \
+  FIO_MEMORY_LOCK_TYPE lock;                                                   \
+  /* statistics (allocations / bytes are updated by the arena's owner) */      \
+  size_t allocations;                                                          \
+  size_t bytes;                                                                \
+  volatile size_t contended;                                                   \
+  /* the thread that last locked the arena (see `__mem_thread_token`) */      \
+  void *volatile owner;                                                        \
+  /* blocks emptied by other threads, reclaimed by the arena (lock free) */    \
+  FIO_LIST_NODE *volatile remote;                                              \
+  volatile size_t remote_count; /* approximate */                              \
+  size_t reclaimed;
+
+/* the unpadded arena, used only to compute the padding */
 typedef struct {
-  void *block;
-  int32_t last_pos;
-  FIO_MEMORY_LOCK_TYPE lock;
-  uint8_t pad_for_cache___[115]; /* cache line padding */
+  FIO___MEM_ARENA_FIELDS
+} FIO_NAME(FIO_MEMORY_NAME, __mem_arena_fields_s);
+
+typedef struct {
+  FIO___MEM_ARENA_FIELDS
+  uint8_t pad_for_cache___[FIO___MEM_ARENA_ALIGN -
+                           (sizeof(FIO_NAME(FIO_MEMORY_NAME,
+                                            __mem_arena_fields_s)) &
+                            (FIO___MEM_ARENA_ALIGN - 1))];
 } FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s);
+#undef FIO___MEM_ARENA_FIELDS
+
+FIO_ASSERT_STATIC(!(sizeof(FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s)) &
+                    (FIO___MEM_ARENA_ALIGN - 1)),
+                  "arena size must be a multiple of the cache line padding");
+
+/* the address of this thread local byte identifies the arena's owner */
+static __thread uint8_t FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token);
+
+/* *****************************************************************************
+Slab types - a block dedicated to a single size class
+***************************************************************************** */
+#if FIO_MEMORY_SLAB_CLASSES
+typedef struct FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s);
+
+/* the slab header is placed at the beginning of the block */
+struct FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) {
+  /* partial slab list (class lock) */
+  FIO_LIST_NODE node;
+  /* all the slabs in the class (class lock) */
+  FIO_LIST_NODE all;
+  /* pending stack, slabs that were full when a slot was freed (lock free) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * next;
+  /* slots in use */
+  volatile uint32_t used;
+  /* set while the slab is the class's current, partial or pending slab */
+  volatile uint32_t listed;
+  /* the number of slots in the slab */
+  uint32_t slots;
+  /* slot size in allocation units */
+  uint32_t units;
+  /* the offset of the first slot in allocation units */
+  uint32_t offset;
+  /* the bitmap word where the next search starts */
+  uint32_t hint;
+  /* slot bitmap, a set bit marks a slot that's in use */
+  volatile uint64_t map[];
+};
+
+/* size class data */
+typedef struct {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * current;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * volatile pending;
+  FIO_LIST_HEAD partial;
+  FIO_LIST_HEAD all;
+  FIO_MEMORY_LOCK_TYPE lock;
+  uint8_t pad_for_cache___[63]; /* cache line padding */
+} FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s);
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
+/* *****************************************************************************
+Thread cache - a private arena per thread (the lock is never used)
+***************************************************************************** */
+#if FIO_MEMORY_THREAD_CACHE
+static __thread FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+/* the key's destructor returns the thread's block when the thread exits */
+static pthread_key_t FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key);
+static volatile uint8_t FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+/* *****************************************************************************
+Statistics counters (survive state cleanup, `mmap` may be used before setup)
+***************************************************************************** */
+static struct {
+  /* system allocations (chunks) held, including cached chunks */
+  volatile size_t chunks;
+  /* the number of times a thread had to switch arena */
+  volatile size_t arena_switches;
+  /* allocations redirected to `mmap` because of their size */
+  volatile size_t mmap_redirects;
+  /* live `mmap` allocations and the number of bytes they mapped */
+  volatile size_t mmap_allocations;
+  volatile size_t mmap_bytes;
+} FIO_NAME(FIO_MEMORY_NAME, __mem_counters);
+
+/* *****************************************************************************
+NUMA topology (survives state cleanup)
+***************************************************************************** */
+#if FIO_MEMORY_NUMA
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* CPUs above this limit are assumed to be on node 0 */
+#define FIO_MEMORY_NUMA_MAX_CPUS 1024
+
+static struct {
+  /* the node count arenas are grouped by (0 or 1 == single node) */
+  volatile size_t nodes;
+  /* the detected node count */
+  size_t detected;
+  /* returns the calling thread's node when the topology is faked */
+  size_t (*volatile fake)(void);
+  /* set if chunks can be bound to their node (`mbind`) */
+  uint8_t bind;
+  /* set once the topology was detected */
+  uint8_t ready;
+  /* maps CPUs to nodes (detected topology) */
+  uint8_t cpu2node[FIO_MEMORY_NUMA_MAX_CPUS];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_numa);
+
+/**
+ * Reads a sysfs list file (i.e., "0-3,8"), setting `map[i] = value` for every
+ * listed index `i` (if `map` isn't NULL). Returns the highest index + 1.
+ */
+FIO_SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_numa_list)(const char *path,
+                                                            uint8_t *map,
+                                                            size_t map_len,
+                                                            uint8_t value) {
+  char buf[1024];
+  size_t r = 0;
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+    return r;
+  ssize_t len = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (len <= 0)
+    return r;
+  buf[len] = 0;
+  for (char *pos = buf; *pos >= '0' && *pos <= '9';) {
+    size_t from = 0, to;
+    while (*pos >= '0' && *pos <= '9')
+      from = (from * 10) + (size_t)(*pos++ - '0');
+    to = from;
+    if (*pos == '-') {
+      to = 0;
+      ++pos;
+      while (*pos >= '0' && *pos <= '9')
+        to = (to * 10) + (size_t)(*pos++ - '0');
+    }
+    for (size_t i = from; map && i <= to && i < map_len; ++i)
+      map[i] = value;
+    if (r <= to)
+      r = to + 1;
+    if (*pos == ',')
+      ++pos;
+  }
+  return r;
+}
+
+/* detects the machine's NUMA topology (once) */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_numa_detect)(void) {
+  char path[64];
+  size_t nodes;
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_numa).ready)
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).ready = 1;
+  nodes = FIO_NAME(FIO_MEMORY_NAME, __mem_numa_list)(
+      "/sys/devices/system/node/online",
+      NULL,
+      0,
+      0);
+  for (size_t i = 0; nodes > 1 && i < nodes; ++i) {
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", i);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa_list)
+    (path,
+     FIO_NAME(FIO_MEMORY_NAME, __mem_numa).cpu2node,
+     FIO_MEMORY_NUMA_MAX_CPUS,
+     (uint8_t)(i % FIO_MEMORY_NUMA_MAX_NODES));
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).bind =
+      (nodes > 1 && nodes <= FIO_MEMORY_NUMA_MAX_NODES);
+  if (nodes > FIO_MEMORY_NUMA_MAX_NODES)
+    nodes = FIO_MEMORY_NUMA_MAX_NODES;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected = (nodes ? nodes : 1);
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected;
+}
+
+/* returns the calling thread's NUMA node */
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)(void) {
+  const size_t nodes = FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes;
+  if (nodes < 2)
+    return 0;
+  size_t (*fake)(void) = FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake;
+  if (fake)
+    return fake() % nodes;
+  const int cpu = sched_getcpu();
+  if ((unsigned)cpu >= FIO_MEMORY_NUMA_MAX_CPUS)
+    return 0;
+  return FIO_NAME(FIO_MEMORY_NAME, __mem_numa).cpu2node[cpu];
+}
+
+/* prefers the node for the (untouched) chunk's memory, errors are ignored */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_numa_bind)(void *mem,
+                                                          size_t node) {
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_numa).bind ||
+      FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake)
+    return;
+  unsigned long mask = 1UL << node;
+  /* MPOL_PREFERRED == 1, falls back to other nodes instead of failing */
+  syscall(SYS_mbind,
+          mem,
+          (unsigned long)FIO_MEMORY_SYS_ALLOCATION_SIZE,
+          1,
+          &mask,
+          (unsigned long)((sizeof(mask) << 3) + 1),
+          0);
+}
+
+/* returns the chunk's NUMA node */
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c) {
+  return c->node;
+}
+
+#else /* FIO_MEMORY_NUMA */
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)(void) { return 0; }
+FIO_IFUNC size_t FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c) {
+  return 0;
+  (void)c;
+}
+#endif /* FIO_MEMORY_NUMA */
+
+/* *****************************************************************************
+Heap profiler - sampled live allocations (survives state cleanup)
+***************************************************************************** */
+#if FIO_MEMORY_PROFILE
+#include <execinfo.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define FIO_MEMORY_PROFILE_MASK                                                \
+  (((size_t)1 << FIO_MEMORY_PROFILE_SLOTS_LOG) - 1)
+/* the counting filter has 64 counters per sample slot */
+#define FIO_MEMORY_PROFILE_FILTER_MASK                                         \
+  (((size_t)1 << (FIO_MEMORY_PROFILE_SLOTS_LOG + 6)) - 1)
+
+/* a sampled live allocation */
+typedef struct {
+  void *ptr;
+  size_t size;
+  size_t depth;
+  void *stack[FIO_MEMORY_PROFILE_DEPTH];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s);
+
+static struct {
+  /* a counting filter, so `free` rarely needs to lock and search the table */
+  volatile uint8_t filter[FIO_MEMORY_PROFILE_FILTER_MASK + 1];
+  fio_lock_i lock;
+  /* live samples in the table */
+  size_t count;
+  /* samples dropped because the table was (almost) full */
+  size_t dropped;
+  /* an open addressing (linear probing) table of samples */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s)
+  table[FIO_MEMORY_PROFILE_MASK + 1];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_prof);
+
+/* bytes left until the thread's next sample */
+static __thread int64_t FIO_NAME(FIO_MEMORY_NAME, __mem_prof_countdown);
+
+FIO_IFUNC uint64_t FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(void *ptr) {
+  return fio_risky_ptr(ptr);
+}
+
+FIO_IFUNC volatile uint8_t *FIO_NAME(FIO_MEMORY_NAME,
+                                     __mem_prof_filter)(uint64_t hash) {
+  return FIO_NAME(FIO_MEMORY_NAME, __mem_prof).filter +
+         ((hash >> 32) & FIO_MEMORY_PROFILE_FILTER_MASK);
+}
+
+/* adds a sample to the table, call only within the lock */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_insert)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) * s,
+    uint64_t hash) {
+  /* keep the load factor low enough for short probe sequences */
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count >=
+      (FIO_MEMORY_PROFILE_MASK - (FIO_MEMORY_PROFILE_MASK >> 3))) {
+    ++FIO_NAME(FIO_MEMORY_NAME, __mem_prof).dropped;
+    return;
+  }
+  size_t i = (size_t)hash & FIO_MEMORY_PROFILE_MASK;
+  while (FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr)
+    i = (i + 1) & FIO_MEMORY_PROFILE_MASK;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i] = *s;
+  ++FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count;
+  volatile uint8_t *f = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash);
+  if (*f != 255) /* saturated counters are never decremented */
+    ++*f;
+}
+
+/* removes a sample from the table (if found), call only within the lock */
+FIO_SFUNC int FIO_NAME(FIO_MEMORY_NAME, __mem_prof_remove)(
+    void *ptr,
+    uint64_t hash,
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) * dest) {
+  size_t i = (size_t)hash & FIO_MEMORY_PROFILE_MASK;
+  while (FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr != ptr) {
+    if (!FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr)
+      return -1;
+    i = (i + 1) & FIO_MEMORY_PROFILE_MASK;
+  }
+  if (dest)
+    *dest = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i];
+  --FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count;
+  volatile uint8_t *f = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash);
+  if (*f != 255)
+    --*f;
+  /* backward shift deletion (no tombstones) */
+  for (size_t j = i;;) {
+    j = (j + 1) & FIO_MEMORY_PROFILE_MASK;
+    void *tmp = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[j].ptr;
+    if (!tmp)
+      break;
+    const size_t home =
+        (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(tmp) &
+        FIO_MEMORY_PROFILE_MASK;
+    /* move the entry unless its home is cyclically within (i, j] */
+    if ((i < j) ? (home <= i || home > j) : (home <= i && home > j)) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[j];
+      i = j;
+    }
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr = NULL;
+  return 0;
+}
+
+/* the slow path, called when the thread's sampling countdown expires */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample)(void *ptr,
+                                                            size_t size) {
+  /* `backtrace` might allocate memory (i.e., when it's first called) */
+  static __thread uint8_t busy;
+  static __thread uint8_t started;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) s;
+  uint64_t hash;
+  if (busy)
+    return;
+  /* a randomized interval prevents sampling bias with periodic allocations */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_countdown) =
+      (int64_t)(((size_t)FIO_MEMORY_PROFILE >> 1) +
+                (size_t)(fio_rand64() % (size_t)FIO_MEMORY_PROFILE));
+  if (!started) { /* the first expiry only initializes the countdown */
+    started = 1;
+    return;
+  }
+  busy = 1;
+  int depth = backtrace(s.stack, FIO_MEMORY_PROFILE_DEPTH);
+  busy = 0;
+  s.ptr = ptr;
+  s.size = size;
+  s.depth = (depth > 0) ? (size_t)depth : 0;
+  hash = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(ptr);
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_insert)(&s, hash);
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+}
+
+/* counts down the allocated bytes, sampling when the countdown expires */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(void *ptr,
+                                                           size_t size) {
+  if ((FIO_NAME(FIO_MEMORY_NAME, __mem_prof_countdown) -= (int64_t)size) > 0)
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample)(ptr, size);
+}
+
+/* removes a freed allocation from the table if it was sampled */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_free)(void *ptr) {
+  const uint64_t hash = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(ptr);
+  if (!*FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash))
+    return;
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_remove)(ptr, hash, NULL);
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+}
+
+/* updates a sampled allocation that was moved by the system (`mremap`) */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_move)(void *from,
+                                                          void *to,
+                                                          size_t size) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) s;
+  const uint64_t hash = FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(from);
+  if (!*FIO_NAME(FIO_MEMORY_NAME, __mem_prof_filter)(hash))
+    return;
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_prof_remove)(from, hash, &s)) {
+    s.ptr = to;
+    s.size = size;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_insert)
+    (&s, FIO_NAME(FIO_MEMORY_NAME, __mem_prof_hash)(to));
+  }
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+}
+
+#else /* FIO_MEMORY_PROFILE */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(void *ptr,
+                                                           size_t size) {
+  (void)ptr, (void)size;
+}
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_free)(void *ptr) {
+  (void)ptr;
+}
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_move)(void *from,
+                                                          void *to,
+                                                          size_t size) {
+  (void)from, (void)to, (void)size;
+}
+#endif /* FIO_MEMORY_PROFILE */
 
 /* *****************************************************************************
 Allocator State
@@ -921,6 +1786,16 @@ static struct FIO_NAME(FIO_MEMORY_NAME, __mem_state_s) {
     /* chunk slot array */
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * a[FIO_MEMORY_CACHE_SLOTS];
     size_t pos;
+#if FIO_MEMORY_CACHE_DECAY
+    /* the time (in milliseconds) each chunk was cached */
+    int64_t at[FIO_MEMORY_CACHE_SLOTS];
+    /* set once a chunk's memory was released to the system */
+    uint8_t purged[FIO_MEMORY_CACHE_SLOTS];
+#endif /* FIO_MEMORY_CACHE_DECAY */
+#if FIO_MEMORY_NUMA
+    /* each chunk's node (purged chunk headers are lost) */
+    uint8_t node[FIO_MEMORY_CACHE_SLOTS];
+#endif /* FIO_MEMORY_NUMA */
   } cache;
 #endif /* FIO_MEMORY_CACHE_SLOTS */
 
@@ -932,10 +1807,14 @@ static struct FIO_NAME(FIO_MEMORY_NAME, __mem_state_s) {
   FIO_MEMORY_LOCK_TYPE big_lock;
   uint8_t pad_for_cache___[115]; /* cache line padding */
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
+#if FIO_MEMORY_SLAB_CLASSES
+  /** size-class slabs (one class per allocation unit count) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) slab[FIO_MEMORY_SLAB_CLASSES];
+#endif /* FIO_MEMORY_SLAB_CLASSES */
   /** main memory state lock */
   FIO_MEMORY_LOCK_TYPE lock;
-  /** free list for available blocks */
-  FIO_LIST_HEAD blocks;
+  /** free lists for available blocks (one per NUMA node) */
+  FIO_LIST_HEAD blocks[FIO_MEMORY_NUMA_LISTS];
   /** the arena count for the allocator */
   uint8_t pad_for_cache2___[111]; /* cache line padding */
   size_t arena_count;
@@ -962,7 +1841,12 @@ void fio___mem_arena_lock___(void);
 FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
     FIO_NAME(FIO_MEMORY_NAME, __mem_arena_lock)(void) {
 #if FIO_MEMORY_ARENA_COUNT == 1
-  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].lock);
+  if (FIO_MEMORY_TRYLOCK(
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].lock)) {
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].contended,
+                   1);
+    FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[0].lock);
+  }
   return FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena;
 
 #else /* FIO_MEMORY_ARENA_COUNT != 1 */
@@ -984,14 +1868,25 @@ FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
   /** thread arena value */
   size_t arena_index;
   size_t loop_count = 0;
+  /** the arenas the thread may use (the arenas of the thread's NUMA node) */
+  size_t group_start = 0;
+  size_t group_count = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+#if FIO_MEMORY_NUMA
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes > 1) {
+    group_count /= FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes;
+    if (!group_count)
+      group_count = 1;
+    group_start = (FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)() * group_count) %
+                  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+  }
+#endif /* FIO_MEMORY_NUMA */
   {
     /* select the default arena selection using a thread ID. */
     union {
       void *p;
       fio_thread_t t;
     } u = {.t = fio_thread_current()};
-    arena_index = fio_risky_ptr(u.p) %
-                  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+    arena_index = group_start + (fio_risky_ptr(u.p) % group_count);
 #if defined(DEBUG) && 0
     static void *pthread_last = NULL;
     if (pthread_last != u.p) {
@@ -1010,15 +1905,19 @@ FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
     if (!FIO_MEMORY_TRYLOCK(
             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].lock))
       return (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena + arena_index);
+    fio_atomic_add(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].contended,
+        1);
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).arena_switches,
+                   1);
     FIO_LOG_DDEBUG("thread %p had to switch arena from %zu / %zu",
                    fio_thread_current(),
                    arena_index,
                    (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count);
     ++arena_index;
-    if (arena_index == FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
-      arena_index = 0;
-    if (++loop_count <
-        (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count << 1))
+    if (arena_index == group_start + group_count)
+      arena_index = group_start;
+    if (++loop_count < (group_count << 1))
       continue;
     FIO___MEMORY_ARENA_LOCK_WARNING();
 #undef FIO___MEMORY_ARENA_LOCK_WARNING
@@ -1105,6 +2004,15 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *ptr);
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_big_block_free)(void *ptr);
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c);
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)(
+    FIO_LIST_NODE *n);
+#if FIO_MEMORY_THREAD_CACHE
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)(void *tc);
+#endif
+#if FIO_MEMORY_SLAB_CLASSES
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s);
+#endif
 
 /* IDE marker */
 void fio___mem_state_cleanup___(void);
@@ -1119,6 +2027,11 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
   FIO_LOG_DDEBUG2(
       "starting facil.io memory allocator cleanup for " FIO_MACRO2STR(
           FIO_NAME(FIO_MEMORY_NAME, malloc)) ".");
+#if FIO_MEMORY_THREAD_CACHE
+  /* free the calling thread's block (other threads free theirs on exit) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)
+  (&FIO_NAME(FIO_MEMORY_NAME, __mem_tcache));
+#endif
   /* free arena blocks */
   for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
        ++i) {
@@ -1133,10 +2046,32 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
     FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)
     (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block = NULL;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote_count = 0;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)
+    (fio_atomic_exchange(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote,
+        (FIO_LIST_NODE *)NULL));
     FIO_MEMORY_LOCK_TYPE_INIT(
         FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].lock);
   }
 
+#if FIO_MEMORY_SLAB_CLASSES
+  /* release empty slabs (slabs with leaked slots are reported below) */
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *cls =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + i;
+    cls->current = NULL;
+    cls->pending = NULL;
+    cls->partial = FIO_LIST_INIT(cls->partial);
+    FIO_LIST_EACH(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s), all, &cls->all, s) {
+      if (s->used)
+        continue;
+      FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(s);
+    }
+    FIO_MEMORY_LOCK_TYPE_INIT(cls->lock);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   /* cleanup big-alloc chunk */
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block) {
@@ -1166,8 +2101,10 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
 #endif /* FIO_MEMORY_CACHE_SLOTS */
 
   /* report any blocks in the allocation list - even if not in DEBUG mode */
-  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.next !=
-      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks) {
+  for (size_t i = 0; i < FIO_MEMORY_NUMA_LISTS; ++i) {
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i].next ==
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i])
+      continue;
     struct t_s {
       FIO_LIST_NODE node;
     };
@@ -1177,7 +2114,7 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
                  malloc)) ") blocks left after cleanup - memory leaks?");
     FIO_LIST_EACH(struct t_s,
                   node,
-                  &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks,
+                  &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i],
                   pos) {
       if (last_chunk == (void *)FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(pos))
         continue;
@@ -1209,6 +2146,11 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME,
   FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)();
 }
 
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_cache_decay_task)(void *ignr_) {
+  (void)ignr_;
+  FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+}
+
 /* initializes (allocates) the arenas and state machine */
 FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state))
@@ -1219,6 +2161,20 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
   fio_state_callback_add(FIO_CALL_AT_EXIT,
                          FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup),
                          NULL);
+#if FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY
+  fio_state_callback_add(FIO_CALL_ON_IDLE,
+                         FIO_NAME(FIO_MEMORY_NAME, __mem_cache_decay_task),
+                         NULL);
+#endif /* FIO_MEMORY_CACHE_DECAY */
+#if FIO_MEMORY_THREAD_CACHE
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid) &&
+      !pthread_key_create(&FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key),
+                          FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)))
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid) = 1;
+#endif
+#if FIO_MEMORY_NUMA
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa_detect)();
+#endif /* FIO_MEMORY_NUMA */
   /* allocate the state machine */
   {
 #if FIO_MEMORY_ARENA_COUNT > 0
@@ -1246,6 +2202,13 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
     if (arean_count >= FIO_MEMORY_ARENA_COUNT_MAX)
       arean_count = FIO_MEMORY_ARENA_COUNT_MAX;
 
+#if FIO_MEMORY_NUMA
+    /* an equal number of arenas per node */
+    if (arean_count >= FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected)
+      arean_count -=
+          arean_count % FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected;
+#endif /* FIO_MEMORY_NUMA */
+
 #endif /* FIO_MEMORY_ARENA_COUNT > 0 */
 
     const size_t s = FIO_MEMORY_STATE_SIZE(arean_count);
@@ -1254,8 +2217,17 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
     FIO_ASSERT_ALLOC(FIO_NAME(FIO_MEMORY_NAME, __mem_state));
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count = arean_count;
   }
-  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks =
-      FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks);
+  for (size_t i = 0; i < FIO_MEMORY_NUMA_LISTS; ++i)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i] =
+        FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i]);
+#if FIO_MEMORY_SLAB_CLASSES
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].partial =
+        FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].partial);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].all =
+        FIO_LIST_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].all);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
   FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)();
 
 #if defined(FIO_MEMORY_WARMUP) && FIO_MEMORY_WARMUP
@@ -1281,6 +2253,9 @@ void fio_after_fork___(void);
  * memory allocator's locks.
  */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
+#if FIO_MEMORY_PROFILE
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock = FIO_LOCK_INIT;
+#endif /* FIO_MEMORY_PROFILE */
   if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state)) {
     FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)();
     return;
@@ -1291,6 +2266,12 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   FIO_MEMORY_LOCK_TYPE_INIT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
+#if FIO_MEMORY_SLAB_CLASSES
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_MEMORY_LOCK_TYPE_INIT(
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab[i].lock);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
   for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
        ++i) {
     FIO_MEMORY_LOCK_TYPE_INIT(
@@ -1299,26 +2280,488 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
 }
 
 /* *****************************************************************************
-Memory Allocation - state printing (debug helper)
+Chunk cache decay - returning idle cached chunks to the system
 ***************************************************************************** */
 
 /* SublimeText marker */
-void fio_malloc_print_state___(void);
-/** Prints the allocator's data structure. May be used for debugging. */
-SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {
-  fprintf(
-      stderr,
-      FIO_MACRO2STR(FIO_NAME(FIO_MEMORY_NAME, malloc)) " allocator state:\n");
+void fio_malloc_cache_decay___(void);
+/**
+ * Returns the blocks waiting in the arenas' remote-free lists, releases the
+ * memory of chunks cached for FIO_MEMORY_CACHE_DECAY milliseconds and unmaps
+ * chunks cached for twice as long.
+ */
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)(void) {
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return;
+  /* idle arenas might hold on to blocks (and chunks) freed by other threads */
   for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
        ++i) {
-    fprintf(stderr,
-            "\t* arena[%zu] block: %p\n",
-            i,
-            (void *)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
-    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block) {
-      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
-          FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(
-              FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
+    if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote)
+      continue;
+    fio_atomic_exchange(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote_count,
+        0);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)
+    (fio_atomic_exchange(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote,
+        (FIO_LIST_NODE *)NULL));
+  }
+#if FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * unmap[FIO_MEMORY_CACHE_SLOTS];
+  size_t count = 0;
+  const int64_t now = fio___mem_time_milli();
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  /* the cache is a stack, so the oldest chunks are at the bottom */
+  while (count < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos &&
+         now - FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[count] >=
+             ((int64_t)FIO_MEMORY_CACHE_DECAY << 1)) {
+    unmap[count] = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[count];
+    ++count;
+  }
+  if (count) {
+    const size_t remain =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos - count;
+    for (size_t i = 0; i < remain; ++i) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i + count];
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i + count];
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i + count];
+#if FIO_MEMORY_NUMA
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i + count];
+#endif /* FIO_MEMORY_NUMA */
+    }
+    for (size_t i = remain; i < remain + count; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i] = NULL;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos = remain;
+  }
+  for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos &&
+                     now - FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] >=
+                         (int64_t)FIO_MEMORY_CACHE_DECAY;
+       ++i) {
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i])
+      continue;
+    FIO_MEM_SYS_PURGE(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i],
+                      FIO_MEMORY_SYS_ALLOCATION_SIZE);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i] = 1;
+  }
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  /* unmap outside the lock */
+  for (size_t i = 0; i < count; ++i) {
+    FIO_MEMORY_ON_CHUNK_UNCACHE(unmap[i]);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_dealloc)(unmap[i]);
+  }
+#endif /* FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY */
+}
+
+/* *****************************************************************************
+Memory Allocation - statistics
+***************************************************************************** */
+
+/* SublimeText marker */
+void fio_malloc_stats___(void);
+/** Returns a snapshot of the allocator's statistics. */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+  r = {
+      .chunks_mapped = FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks,
+      .arena_switches =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_counters).arena_switches,
+      .mmap_redirects =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_redirects,
+      .mmap_allocations =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_allocations,
+      .mmap_bytes = FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes,
+  };
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return r;
+  r.arenas = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+#if FIO_MEMORY_CACHE_SLOTS
+  r.chunks_cached = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos;
+#endif /* FIO_MEMORY_CACHE_SLOTS */
+  for (size_t i = 0; i < FIO_MEMORY_NUMA_LISTS; ++i)
+    for (FIO_LIST_NODE *n =
+             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i].next;
+         n != &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks[i];
+         n = n->next)
+      ++r.blocks_free;
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+
+#if FIO_MEMORY_ENABLE_BIG_ALLOC
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block) {
+    r.big_block_bytes =
+        (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block->pos
+        << FIO_MEMORY_ALIGN_LOG;
+    /* the allocator holds a reference to its current big-block */
+    r.big_block_allocations =
+        (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block->ref - 1;
+  }
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
+#endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
+
+#if FIO_MEMORY_SLAB_CLASSES
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *cls =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + i;
+    FIO_MEMORY_LOCK(cls->lock);
+    FIO_LIST_EACH(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s), all, &cls->all, s) {
+      r.slab_slots += s->slots;
+      r.slab_slots_used += s->used;
+    }
+    FIO_MEMORY_UNLOCK(cls->lock);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+  return r;
+}
+
+/* SublimeText marker */
+void fio_malloc_arena_stats___(void);
+/** Returns a snapshot of an arena's statistics. */
+SFUNC FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s)
+    FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(size_t index) {
+  FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats_s) r = {0};
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state) ||
+      index >= FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
+    return r;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena + index;
+  FIO_MEMORY_LOCK(a->lock);
+  if (a->block) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(a->block);
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, a->block);
+    r.block_bytes = (size_t)c->blocks[b].pos << FIO_MEMORY_ALIGN_LOG;
+  }
+  r.bytes = a->bytes;
+  r.allocations = a->allocations;
+  r.reclaimed = a->reclaimed;
+  FIO_MEMORY_UNLOCK(a->lock);
+  r.contended = a->contended;
+  return r;
+}
+
+/* *****************************************************************************
+Memory Allocation - heap profile dump
+***************************************************************************** */
+#if FIO_MEMORY_PROFILE
+
+/* a small buffered writer, so the dump doesn't allocate memory per line */
+typedef struct {
+  int fd;
+  int err;
+  size_t len;
+  char buf[8192];
+} FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s);
+
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w) {
+  const char *pos = w->buf;
+  while (w->len && !w->err) {
+    ssize_t r = write(w->fd, pos, w->len);
+    if (r > 0) {
+      pos += r;
+      w->len -= (size_t)r;
+    } else if (r == -1 && errno == EINTR) {
+      continue;
+    } else {
+      w->err = -1;
+    }
+  }
+  w->len = 0;
+}
+
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w,
+    const char *str,
+    size_t len) {
+  while (len) {
+    if (w->len == sizeof(w->buf))
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(w);
+    size_t part = sizeof(w->buf) - w->len;
+    if (part > len)
+      part = len;
+    FIO_MEMCPY(w->buf + w->len, str, part);
+    w->len += part;
+    str += part;
+    len -= part;
+  }
+}
+
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w,
+    const char *format,
+    ...) {
+  char tmp[256];
+  va_list argv;
+  va_start(argv, format);
+  int len = vsnprintf(tmp, sizeof(tmp), format, argv);
+  va_end(argv);
+  if (len <= 0)
+    return;
+  if ((size_t)len >= sizeof(tmp))
+    len = (int)(sizeof(tmp) - 1);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, tmp, (size_t)len);
+}
+
+/* writes a frame's name, as returned by `backtrace_symbols` */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_frame)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) * w,
+    const char *sym,
+    void *address) {
+  const char *start, *end;
+  if (!sym)
+    goto address;
+  if ((start = strchr(sym, '('))) { /* glibc: "module(name+0x10) [0x...]" */
+    end = ++start;
+    while (*end && *end != '+' && *end != ')')
+      ++end;
+    if (end > start) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, start, end - start);
+      return;
+    }
+    /* unnamed (static) function: "module+0x10" can still be symbolized */
+    const char *module = sym;
+    for (const char *i = sym; i + 1 < start; ++i)
+      if (*i == '/')
+        module = i + 1;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, module, (start - 1) - module);
+    start = end;
+    while (*end && *end != ')')
+      ++end;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, start, end - start);
+    return;
+  }
+  if ((start = strstr(sym, " 0x"))) { /* BSD: "0 module 0x... name + 16" */
+    start += 3;
+    while (*start && *start != ' ')
+      ++start;
+    while (*start == ' ')
+      ++start;
+    if (!(end = strstr(start, " + ")))
+      end = start + strlen(start);
+    if (end > start) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, start, end - start);
+      return;
+    }
+  }
+address:
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+  (w, "0x%zx", (size_t)(uintptr_t)address);
+}
+
+/* SublimeText marker */
+void fio_malloc_profile_dump___(void);
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded) {
+  const size_t table_len = sizeof(FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) *samples;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) *w;
+  size_t count = 0, bytes = 0;
+  if (fd == -1) {
+    errno = EBADF;
+    return -1;
+  }
+  /* system memory, so the dump doesn't change the profile it's reporting */
+  samples = (FIO_NAME(FIO_MEMORY_NAME, __mem_prof_sample_s) *)FIO_MEM_SYS_ALLOC(
+      FIO_MEM_BYTES2PAGES(table_len + sizeof(*w)),
+      FIO_MEM_PAGE_SIZE_LOG);
+  if (!samples) {
+    errno = ENOMEM;
+    return -1;
+  }
+  w = (FIO_NAME(FIO_MEMORY_NAME, __mem_prof_writer_s) *)((char *)samples +
+                                                         table_len);
+  w->fd = fd;
+  w->err = 0;
+  w->len = 0;
+  /* copy the samples, so formatting (and I/O) is performed outside the lock */
+  fio_lock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  for (size_t i = 0; i <= FIO_MEMORY_PROFILE_MASK; ++i) {
+    if (!FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i].ptr)
+      continue;
+    samples[count++] = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).table[i];
+  }
+  fio_unlock(&FIO_NAME(FIO_MEMORY_NAME, __mem_prof).lock);
+  for (size_t i = 0; i < count; ++i)
+    bytes += samples[i].size;
+
+  if (folded) {
+    /* "root;caller;callee bytes" (frame 0 is the profiler's sampling code) */
+    for (size_t i = 0; i < count && !w->err; ++i) {
+      if (samples[i].depth < 2)
+        continue;
+      char **symbols = backtrace_symbols(samples[i].stack + 1,
+                                         (int)samples[i].depth - 1);
+      for (size_t f = samples[i].depth - 1; f; --f) {
+        FIO_NAME(FIO_MEMORY_NAME, __mem_prof_frame)
+        (w, (symbols ? symbols[f - 1] : NULL), samples[i].stack[f]);
+        if (f > 1)
+          FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, ";", 1);
+      }
+      free(symbols); /* allocated by the system (libc) */
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+      (w, " %zu\n", samples[i].size);
+    }
+  } else {
+    /* the legacy pprof heap profile, with the sampling interval */
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+    (w,
+     "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n",
+     count,
+     bytes,
+     count,
+     bytes,
+     (size_t)FIO_MEMORY_PROFILE);
+    for (size_t i = 0; i < count && !w->err; ++i) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+      (w, "1: %zu [1: %zu] @", samples[i].size, samples[i].size);
+      for (size_t f = 1; f < samples[i].depth; ++f)
+        FIO_NAME(FIO_MEMORY_NAME, __mem_prof_printf)
+        (w, " 0x%zx", (size_t)(uintptr_t)samples[i].stack[f]);
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, "\n", 1);
+    }
+    /* pprof uses the memory map to symbolize the addresses */
+    int maps = open("/proc/self/maps", O_RDONLY);
+    if (maps != -1) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_out)(w, "\nMAPPED_LIBRARIES:\n", 19);
+      for (;;) {
+        if (w->len == sizeof(w->buf))
+          FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(w);
+        ssize_t r = read(maps, w->buf + w->len, sizeof(w->buf) - w->len);
+        if (r > 0) {
+          w->len += (size_t)r;
+          continue;
+        }
+        if (r == -1 && errno == EINTR)
+          continue;
+        break;
+      }
+      close(maps);
+    }
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_flush)(w);
+  const int r = w->err;
+  FIO_MEM_SYS_FREE(samples, FIO_MEM_BYTES2PAGES(table_len + sizeof(*w)));
+  return r;
+}
+
+/* dumps the heap profile from the `fio_signal_review` callback */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_prof_on_signal)(int sig,
+                                                               void *filename) {
+  int fd = open((const char *)filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    FIO_LOG_ERROR("heap profile file couldn't be opened (%s): %s",
+                  (const char *)filename,
+                  strerror(errno));
+    return;
+  }
+  if (FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(fd, 0))
+    FIO_LOG_ERROR("heap profile dump failed (%s)", (const char *)filename);
+  else
+    FIO_LOG_INFO("(%d) heap profile written to %s (signal %d)",
+                 (int)getpid(),
+                 (const char *)filename,
+                 sig);
+  close(fd);
+}
+
+/* SublimeText marker */
+void fio_malloc_profile_dump_on_signal___(void);
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename) {
+  if (!filename) {
+    errno = EINVAL;
+    return -1;
+  }
+  return fio_signal_monitor(sig,
+                            FIO_NAME(FIO_MEMORY_NAME, __mem_prof_on_signal),
+                            (void *)filename);
+}
+
+#else /* FIO_MEMORY_PROFILE */
+
+SFUNC int FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(int fd, int folded) {
+  errno = ENOTSUP;
+  return -1;
+  (void)fd, (void)folded;
+}
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_profile_dump_on_signal)(int sig,
+                                                  const char *filename) {
+  errno = ENOTSUP;
+  return -1;
+  (void)sig, (void)filename;
+}
+#endif /* FIO_MEMORY_PROFILE */
+
+/* *****************************************************************************
+Memory Allocation - NUMA topology
+***************************************************************************** */
+#if FIO_MEMORY_NUMA
+
+/** Returns the number of NUMA nodes the allocator's arenas are grouped by. */
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void) {
+  const size_t nodes = FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes;
+  return (nodes ? nodes : 1);
+}
+
+/** Overrides the detected NUMA topology (i.e., for testing). */
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void)) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa_detect)();
+  if (!nodes) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake = NULL;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_numa).detected;
+    return 0;
+  }
+  if (!node || nodes > FIO_MEMORY_NUMA_MAX_NODES) {
+    errno = EINVAL;
+    return -1;
+  }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).fake = node;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes = nodes;
+  return 0;
+}
+
+#else /* FIO_MEMORY_NUMA */
+
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)(void) { return 1; }
+SFUNC int FIO_NAME(FIO_MEMORY_NAME,
+                   malloc_numa_topology)(size_t nodes, size_t (*node)(void)) {
+  errno = ENOTSUP;
+  return -1;
+  (void)nodes, (void)node;
+}
+#endif /* FIO_MEMORY_NUMA */
+
+/* *****************************************************************************
+Memory Allocation - state printing (debug helper)
+***************************************************************************** */
+
+/* SublimeText marker */
+void fio_malloc_print_state___(void);
+/** Prints the allocator's data structure. May be used for debugging. */
+SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {
+  fprintf(
+      stderr,
+      FIO_MACRO2STR(FIO_NAME(FIO_MEMORY_NAME, malloc)) " allocator state:\n");
+  for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+       ++i) {
+    fprintf(stderr,
+            "\t* arena[%zu] block: %p\n",
+            i,
+            (void *)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(
+              FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
       size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(
           c,
           FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].block);
@@ -1332,6 +2775,37 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {
               (size_t)c->blocks[b].pos);
     }
   }
+#if FIO_MEMORY_THREAD_CACHE
+  fprintf(stderr,
+          "\t* thread cache block (calling thread): %p\n",
+          (void *)FIO_NAME(FIO_MEMORY_NAME, __mem_tcache).block);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_SLAB_CLASSES
+  fprintf(stderr, "\t---slabs---\n");
+  for (size_t i = 0; i < FIO_MEMORY_SLAB_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *cls =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + i;
+    size_t slabs = 0, slots = 0, used = 0;
+    FIO_MEMORY_LOCK(cls->lock);
+    FIO_LIST_EACH(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s), all, &cls->all, s) {
+      ++slabs;
+      slots += s->slots;
+      used += s->used;
+    }
+    FIO_MEMORY_UNLOCK(cls->lock);
+    if (!slabs)
+      continue;
+    fprintf(stderr,
+            "\t* class[%zu] (%zu bytes): %zu slabs, %zu/%zu slots used "
+            "(%zu%% fragmentation)\n",
+            i,
+            (i + 1) << FIO_MEMORY_ALIGN_LOG,
+            slabs,
+            used,
+            slots,
+            ((slots - used) * 100) / slots);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_block) {
     fprintf(stderr, "\t---big allocations---\n");
@@ -1364,17 +2838,20 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_state)(void) {
 void fio_malloc_print_free_block_list___(void);
 /** Prints the allocator's free block list. May be used for debugging. */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_free_block_list)(void) {
-  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev ==
-      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks)
-    return;
-  fprintf(stderr,
-          FIO_MACRO2STR(FIO_NAME(FIO_MEMORY_NAME,
-                                 malloc)) " allocator free block list:\n");
-  FIO_LIST_NODE *n = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev;
-  for (size_t i = 0; n != &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks;
-       ++i) {
-    fprintf(stderr, "\t[%zu] %p\n", i, (void *)n);
-    n = n->prev;
+  for (size_t node = 0; node < FIO_MEMORY_NUMA_LISTS; ++node) {
+    FIO_LIST_HEAD *head = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks + node;
+    if (head->prev == head)
+      continue;
+    fprintf(stderr,
+            FIO_MACRO2STR(FIO_NAME(
+                FIO_MEMORY_NAME,
+                malloc)) " allocator free block list (node %zu):\n",
+            node);
+    FIO_LIST_NODE *n = head->prev;
+    for (size_t i = 0; n != head; ++i) {
+      fprintf(stderr, "\t[%zu] %p\n", i, (void *)n);
+      n = n->prev;
+    }
   }
 }
 
@@ -1390,6 +2867,7 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_dealloc)(
   if (!c)
     return;
   FIO_MEMORY_ON_CHUNK_FREE(c);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks, 1);
   FIO_MEM_SYS_FREE(((void *)c), FIO_MEMORY_SYS_ALLOCATION_SIZE);
 }
 
@@ -1400,6 +2878,18 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_cache_or_dealloc)(
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos <
       FIO_MEMORY_CACHE_SLOTS) {
     FIO_MEMORY_ON_CHUNK_CACHE(c);
+#if FIO_MEMORY_CACHE_DECAY
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)
+        ->cache.at[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] =
+        fio___mem_time_milli();
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)
+        ->cache.purged[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] = 0;
+#endif /* FIO_MEMORY_CACHE_DECAY */
+#if FIO_MEMORY_NUMA
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)
+        ->cache.node[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] =
+        (uint8_t)c->node;
+#endif /* FIO_MEMORY_NUMA */
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)
         ->cache.a[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos++] = c;
     c = NULL;
@@ -1436,35 +2926,82 @@ void fio___mem_chunk_new___(void);
 FIO_IFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_new)(const size_t needs_lock) {
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c = NULL;
+#if FIO_MEMORY_NUMA
+  const size_t node = FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)();
+#endif /* FIO_MEMORY_NUMA */
 #if FIO_MEMORY_CACHE_SLOTS
   /* cache allocation */
   if (needs_lock) {
     FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
   }
   if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos) {
-    c = FIO_NAME(FIO_MEMORY_NAME, __mem_state)
-            ->cache.a[--FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos];
+    size_t i = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos - 1;
+#if FIO_MEMORY_NUMA
+    /* use the newest chunk on the thread's node (any chunk if single node) */
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_numa).nodes > 1) {
+      while (i &&
+             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] != node)
+        --i;
+      if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] != node)
+        goto cache_missed;
+    }
+#endif /* FIO_MEMORY_NUMA */
+    c = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i];
+    /* keep the cache ordered (the oldest chunks are at the bottom) */
+    for (; i + 1 < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos; ++i) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[i + 1];
+#if FIO_MEMORY_NUMA
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.node[i + 1];
+#endif /* FIO_MEMORY_NUMA */
+#if FIO_MEMORY_CACHE_DECAY
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i + 1];
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i] =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[i + 1];
+#endif /* FIO_MEMORY_CACHE_DECAY */
+    }
     FIO_NAME(FIO_MEMORY_NAME, __mem_state)
-        ->cache.a[FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] = NULL;
+        ->cache.a[--FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos] = NULL;
   }
+#if FIO_MEMORY_NUMA
+cache_missed:
+#endif /* FIO_MEMORY_NUMA */
   if (needs_lock) {
     FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
   }
   if (c) {
     FIO_MEMORY_ON_CHUNK_UNCACHE(c);
     *c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s)){.ref = 1};
+#if FIO_MEMORY_NUMA
+    c->node = (uint32_t)node; /* cached chunks have no blocks in free lists */
+#endif /* FIO_MEMORY_NUMA */
     return c;
   }
 #endif /* FIO_MEMORY_CACHE_SLOTS */
 
   /* system allocation */
+#if FIO_MEMORY_HUGE_PAGES
+  c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_ALLOC_HUGE(
+      FIO_MEMORY_SYS_ALLOCATION_SIZE,
+      FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG,
+      (FIO_MEMORY_HUGE_PAGES > 1));
+#else
   c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_ALLOC(
       FIO_MEMORY_SYS_ALLOCATION_SIZE,
       FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG);
+#endif /* FIO_MEMORY_HUGE_PAGES */
 
   if (!c)
     return c;
+#if FIO_MEMORY_NUMA
+  /* bind before the memory is touched (first-touch places unbound memory) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_numa_bind)(c, node);
+  c->node = (uint32_t)node;
+#endif /* FIO_MEMORY_NUMA */
   FIO_MEMORY_ON_CHUNK_ALLOC(c);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks, 1);
   c->ref = 1;
   return c;
   (void)needs_lock; /* in case it isn't used */
@@ -1527,11 +3064,40 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *p) {
   /* reset memory */
   FIO_NAME(FIO_MEMORY_NAME, __mem_block__reset_memory)(c, b);
 
+  if (c->blocks[b].arena) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena +
+        (c->blocks[b].arena - 1);
+    void *owner;
+    fio_atomic_load(owner, &a->owner);
+    if (owner != (void *)&FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token)) {
+      /* push to the arena's remote-free list (keeps the chunk reference) */
+      FIO_LIST_NODE *n =
+          (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
+      FIO_LIST_NODE *head;
+      n->prev = NULL;
+      do {
+        head = a->remote;
+        n->next = head;
+      } while (!fio_atomic_compare_exchange_p(&a->remote, &head, &n));
+      if (fio_atomic_add(&a->remote_count, 1) + 1 <
+          FIO___MEM_REMOTE_FREE_LIMIT)
+        return;
+      /* don't wait for the arena's next block to release the chunks */
+      fio_atomic_exchange(&a->remote_count, 0);
+      FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)
+      (fio_atomic_exchange(&a->remote, (FIO_LIST_NODE *)NULL));
+      return;
+    }
+  }
+
   /* place in free list */
   FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
   FIO_LIST_NODE *n =
       (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
-  FIO_LIST_PUSH(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks, n);
+  FIO_LIST_PUSH(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c),
+                n);
   /* free chunk reference while in locked state */
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c);
 }
@@ -1543,13 +3109,15 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)(void) {
   void *p = NULL;
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c = NULL;
   size_t b;
+  /* the free list for the calling thread's NUMA node */
+  FIO_LIST_HEAD *const blocks = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                                FIO_NAME(FIO_MEMORY_NAME, __mem_numa_node)();
 
   FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
 
   /* try to collect from list */
-  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev !=
-      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks) {
-    FIO_LIST_NODE *n = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev;
+  if (blocks->prev != blocks) {
+    FIO_LIST_NODE *n = blocks->prev;
     FIO_LIST_REMOVE(n);
     n->next = n->prev = NULL;
     c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
@@ -1571,7 +3139,9 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)(void) {
   for (b = 1; b < FIO_MEMORY_BLOCKS_PER_ALLOCATION; ++b) {
     FIO_LIST_NODE *n =
         (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
-    FIO_LIST_PUSH(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks, n);
+    FIO_LIST_PUSH(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c),
+                  n);
   }
   /* set block index to zero */
   b = 0;
@@ -1583,26 +3153,137 @@ done:
   /* update block reference and allocation position */
   c->blocks[b].ref = 1;
   c->blocks[b].pos = 0;
+  c->blocks[b].arena = 0;
   return p;
 }
 
+/* SublimeText marker */
+void fio___mem_block_free_list___(void);
+/** returns a list of empty blocks (linked by `next`) to the free list */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)(
+    FIO_LIST_NODE *n) {
+  if (!n)
+    return;
+  FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  while (n) {
+    FIO_LIST_NODE *next = n->next;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
+    FIO_LIST_PUSH(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks +
+                      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c),
+                  n);
+    n = next;
+    /* chunk references only change within the lock */
+    if (c->ref > 1) {
+      fio_atomic_sub(&c->ref, 1);
+      continue;
+    }
+    /* the chunk is free: cache / deallocate (unlocks) */
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c);
+    FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+  }
+  FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+}
+
+/* SublimeText marker */
+void fio___mem_arena_block_new___(void);
+/**
+ * Returns a new block for the arena (owned by the caller), reclaiming the
+ * blocks in the arena's remote-free list before using the shared free list.
+ *
+ * The first reclaimed block is reused without locking and the rest are
+ * returned to the free list using a single lock.
+ */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_arena_block_new)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) * a) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c;
+  size_t b;
+  FIO_LIST_NODE *n = NULL;
+  if (a->remote) {
+    fio_atomic_exchange(&a->remote_count, 0);
+    n = fio_atomic_exchange(&a->remote, (FIO_LIST_NODE *)NULL);
+  }
+  if (n) {
+    size_t count = 1;
+    for (FIO_LIST_NODE *i = n->next; i; i = i->next)
+      ++count;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free_list)(n->next);
+    n->next = NULL;
+    a->reclaimed += count;
+    c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
+  } else {
+    n = (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+    if (!n)
+      return NULL;
+    c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
+  }
+  b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, (void *)n);
+  c->blocks[b].ref = 1;
+  c->blocks[b].pos = 0;
+  /* arenas in the state's arena array own their blocks' remote frees */
+  c->blocks[b].arena = 0;
+  if (a >= FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena &&
+      a < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena +
+              FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
+    c->blocks[b].arena =
+        (int32_t)(a - FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena) + 1;
+  return (void *)n;
+}
+
 /* *****************************************************************************
-Small allocation internal API
+Arena slicing (the arena is owned by the caller)
 ***************************************************************************** */
 
 /* SublimeText marker */
-void fio___mem_slice_new___(void);
-/** slice a block to allocate a set number of bytes. */
-FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
-                                           __mem_slice_new)(size_t bytes,
-                                                            void *is_realloc) {
-  void *p = NULL;
-  bytes = (bytes + ((1UL << FIO_MEMORY_ALIGN_LOG) - 1)) >> FIO_MEMORY_ALIGN_LOG;
-  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
-      FIO_NAME(FIO_MEMORY_NAME, __mem_arena_lock)();
+void fio___mem_arena_resize___(void);
+/**
+ * Resizes the last slice in the arena's block (`c`, `b`) in place, keeping
+ * (at most) `keep` bytes. Returns -1 if `ptr` isn't the last slice or the block
+ * is too small.
+ *
+ * The arena must be owned by the caller (locked or thread local).
+ */
+FIO_IFUNC int FIO_NAME(FIO_MEMORY_NAME, __mem_arena_resize)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) * a,
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
+    size_t b,
+    void *ptr,
+    size_t units,
+    size_t keep) {
+  if (ptr != FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, a->last_pos) ||
+      a->last_pos + units >= FIO_MEMORY_UNITS_PER_BLOCK)
+    return -1;
+  const int32_t end = a->last_pos + (int32_t)units;
+  const int32_t old = c->blocks[b].pos;
+  if (end > old)
+    a->bytes += (size_t)(end - old) << FIO_MEMORY_ALIGN_LOG;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  { /* memory past the kept data (and past the block's position) is zero */
+    const size_t used = (size_t)(old - a->last_pos) << FIO_MEMORY_ALIGN_LOG;
+    if (keep < used)
+      FIO_MEMSET((char *)ptr + keep, 0, used - keep);
+  }
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+  c->blocks[b].pos = end;
+  return 0;
+  (void)keep;
+}
 
+/* SublimeText marker */
+void fio___mem_arena_slice___(void);
+/**
+ * Slices the arena's block to allocate a set number of allocation units.
+ *
+ * The arena must be owned by the caller (locked or thread local).
+ */
+FIO_SFUNC void *FIO_MEM_ALIGN_NEW
+FIO_NAME(FIO_MEMORY_NAME, __mem_arena_slice)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) * a,
+    size_t bytes,
+    void *is_realloc) {
+  void *p = NULL;
   if (!a->block) {
-    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_arena_block_new)(a);
     a->last_pos = 0;
   }
   for (;;) {
@@ -1622,21 +3303,26 @@ FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
       a->last_pos = 0;
     }
 
+    /* a lucky realloc? (the last slice is resized in place) */
+    if (is_realloc &&
+        !FIO_NAME(FIO_MEMORY_NAME, __mem_arena_resize)(
+            a,
+            c,
+            b,
+            is_realloc,
+            bytes,
+            bytes << FIO_MEMORY_ALIGN_LOG)) {
+      fio_atomic_sub(&c->blocks[b].ref, 1); /* release reference added */
+      return is_realloc;
+    }
+
     /* enough space? allocate */
     if (c->blocks[b].pos + bytes < FIO_MEMORY_UNITS_PER_BLOCK) {
-      /* a lucky realloc? */
-      if (is_realloc &&
-          is_realloc ==
-              FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, a->last_pos)) {
-        c->blocks[b].pos += bytes;
-        fio_atomic_sub(&c->blocks[b].ref, 1); /* release reference added */
-        FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
-        return is_realloc;
-      }
       p = FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, c->blocks[b].pos);
       a->last_pos = c->blocks[b].pos;
       c->blocks[b].pos += bytes;
-      FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
+      a->bytes += bytes << FIO_MEMORY_ALIGN_LOG;
+      ++a->allocations;
       return p;
     }
     is_realloc = NULL;
@@ -1645,7 +3331,7 @@ FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
      * allocate a new block before freeing the existing block
      * this prevents the last chunk from de-allocating and reallocating
      */
-    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+    a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_arena_block_new)(a);
     a->last_pos = 0;
 
     /* release allocation reference added */
@@ -1655,18 +3341,343 @@ FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
   }
 
 no_mem:
-  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
   errno = ENOMEM;
   return p;
 }
 
+/* *****************************************************************************
+Thread cache - lock free slicing of a thread's private block
+***************************************************************************** */
+#if FIO_MEMORY_THREAD_CACHE
+
+/* SublimeText marker */
+void fio___mem_tcache_flush___(void);
+/** Returns a thread's private block to the allocator (on thread exit). */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)(void *tc_) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *tc =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *)tc_;
+  void *block = tc->block;
+  tc->block = NULL;
+  tc->last_pos = 0;
+  if (!block || !FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(block);
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_slice___(void);
+/** Slices the thread's private block, registering the thread on first use. */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME,
+                         __mem_tcache_slice)(size_t units, void *is_realloc) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *tc =
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+  if (!tc->block &&
+      !pthread_getspecific(FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key)))
+    pthread_setspecific(FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key),
+                        (void *)tc);
+  return FIO_NAME(FIO_MEMORY_NAME, __mem_arena_slice)(tc, units, is_realloc);
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_rollback___(void);
+/**
+ * If `p` is the latest slice cut from the thread's private block, the block's
+ * position is rolled back so the memory is reused by the next allocation.
+ */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_rollback)(void *p) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *tc =
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+  if (!tc->block || FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p) !=
+                        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(tc->block))
+    return;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *const c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, tc->block);
+  if (p != FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, tc->last_pos) ||
+      c->blocks[b].pos <= tc->last_pos)
+    return;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  FIO_MEMSET(p,
+             0,
+             ((size_t)(c->blocks[b].pos - tc->last_pos)
+              << FIO_MEMORY_ALIGN_LOG));
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+  c->blocks[b].pos = tc->last_pos;
+}
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+/* *****************************************************************************
+Size-class slabs - bitmap slot allocation within a dedicated block
+***************************************************************************** */
+#if FIO_MEMORY_SLAB_CLASSES
+
+/* SublimeText marker */
+void fio___mem_slab_new___(void);
+/** Returns a new (empty) slab for slots of `units` allocation units. */
+FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_new)(size_t units) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *s =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *)FIO_NAME(FIO_MEMORY_NAME,
+                                                         __mem_block_new)();
+  if (!s)
+    return s;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(s);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, s);
+  /* the bitmap is sized for the worst case (no header) */
+  const size_t words = ((FIO_MEMORY_UNITS_PER_BLOCK / units) + 63) >> 6;
+  const size_t offset =
+      (sizeof(*s) + (words << 3) + (FIO_MEMORY_ALIGN_SIZE - 1)) >>
+      FIO_MEMORY_ALIGN_LOG;
+  const size_t slots = (FIO_MEMORY_UNITS_PER_BLOCK - offset) / units;
+  s->node.next = s->node.prev = NULL;
+  s->all.next = s->all.prev = NULL;
+  s->next = NULL;
+  s->used = 0;
+  s->listed = 1;
+  s->slots = (uint32_t)slots;
+  s->units = (uint32_t)units;
+  s->offset = (uint32_t)offset;
+  s->hint = 0;
+  for (size_t i = 0; i < words; ++i)
+    s->map[i] = 0;
+  /* mark the bits past the last slot as used */
+  if ((slots & 63))
+    s->map[slots >> 6] = (~(uint64_t)0) << (slots & 63);
+  /* a negative position marks the block as a slab */
+  c->blocks[b].pos = -(int32_t)units;
+  return s;
+}
+
+/* SublimeText marker */
+void fio___mem_slab_release___(void);
+/** Returns an empty slab's block to the allocator (class lock is held). */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(s);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, s);
+  FIO_LIST_REMOVE(&s->all);
+  /* freed slots are already clean, only the header needs to be reset */
+  c->blocks[b].pos = (int32_t)s->offset;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(s);
+}
+
+/* SublimeText marker */
+void fio___mem_slab_slot_new___(void);
+/** Reserves a free slot in the slab, returns NULL if the slab is full. */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slot_new)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s) {
+  const size_t words = ((size_t)s->slots + 63) >> 6;
+  size_t w = s->hint;
+  for (size_t i = 0; i < words; ++i) {
+    const uint64_t free_slots = ~s->map[w];
+    if (free_slots) {
+      const size_t bit = fio_lsb_index_unsafe(free_slots);
+      /* only allocations set bits and they're serialized by the class lock */
+      fio_atomic_or(s->map + w, ((uint64_t)1 << bit));
+      fio_atomic_add(&s->used, 1);
+      s->hint = (uint32_t)w;
+      return (void *)((uintptr_t)s +
+                      ((s->offset + (((w << 6) | bit) * s->units))
+                       << FIO_MEMORY_ALIGN_LOG));
+    }
+    if (++w == words)
+      w = 0;
+  }
+  return NULL;
+}
+
+/* SublimeText marker */
+void fio___mem_slab_slice_new___(void);
+/** Allocates a slot of `units` allocation units from the size class. */
+FIO_SFUNC void *FIO_MEM_ALIGN_NEW
+FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_new)(size_t units) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *const cls =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + (units - 1);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * s;
+  void *p = NULL;
+  FIO_MEMORY_LOCK(cls->lock);
+  for (;;) {
+    if ((s = cls->current)) {
+      if ((p = FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slot_new)(s)))
+        break;
+      /* full slab: unlist it, unless a slot was freed in the meanwhile */
+      cls->current = NULL;
+      fio_atomic_exchange(&s->listed, 0);
+      if (s->used < s->slots && !fio_atomic_exchange(&s->listed, 1))
+        FIO_LIST_PUSH(&cls->partial, &s->node);
+    }
+    /* collect slabs that had a slot freed while they were full */
+    s = fio_atomic_exchange(&cls->pending,
+                            (FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *)NULL);
+    while (s) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *next = s->next;
+      s->next = NULL;
+      FIO_LIST_PUSH(&cls->partial, &s->node);
+      s = next;
+    }
+    /* reuse a partially used slab, releasing surplus empty slabs */
+    while (!FIO_LIST_IS_EMPTY(&cls->partial)) {
+      FIO_LIST_POP(FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s),
+                   node,
+                   s,
+                   &cls->partial);
+      s->node.next = s->node.prev = NULL;
+      if (!s->used && !FIO_LIST_IS_EMPTY(&cls->partial)) {
+        FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(s);
+        continue;
+      }
+      cls->current = s;
+      break;
+    }
+    if (cls->current)
+      continue;
+    s = FIO_NAME(FIO_MEMORY_NAME, __mem_slab_new)(units);
+    if (!s)
+      goto no_mem;
+    FIO_LIST_PUSH(&cls->all, &s->all);
+    cls->current = s;
+  }
+  FIO_MEMORY_UNLOCK(cls->lock);
+  return p;
+
+no_mem:
+  FIO_MEMORY_UNLOCK(cls->lock);
+  errno = ENOMEM;
+  return p;
+}
+
+/* SublimeText marker */
+void fio___mem_slab_slice_free___(void);
+/** Frees a slab slot (lock free, unless the slab was full). */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_free)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
+    size_t b,
+    void *p) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *s =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) *)FIO_NAME(FIO_MEMORY_NAME,
+                                                         __mem_chunk2ptr)(c,
+                                                                          b,
+                                                                          0);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_slab_class_s) *const cls =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->slab + (s->units - 1);
+  const size_t units = s->units;
+  const uint32_t slots = s->slots;
+  const size_t i =
+      ((((uintptr_t)p - (uintptr_t)s) >> FIO_MEMORY_ALIGN_LOG) - s->offset) /
+      units;
+  const uint64_t bit = (uint64_t)1 << (i & 63);
+  uint64_t old;
+  FIO_ASSERT_DEBUG(
+      (uintptr_t)p ==
+          (uintptr_t)s + ((s->offset + (i * units)) << FIO_MEMORY_ALIGN_LOG),
+      "slab slot address error (%p), not a slab allocation?",
+      p);
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  FIO_MEMSET(p, 0, units << FIO_MEMORY_ALIGN_LOG);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+  if (s->used == 1 && s != cls->current)
+    goto last_slot;
+  old = fio_atomic_and(s->map + (i >> 6), ~bit);
+  FIO_ASSERT_DEBUG((old & bit), "slab slot freed twice? (%p)", p);
+  if (!(old & bit))
+    return;
+  /* once `used` is updated, the slab may be released by another thread */
+  if (fio_atomic_sub(&s->used, 1) != slots ||
+      fio_atomic_exchange(&s->listed, 1))
+    return;
+  { /* the slab was full and unlisted, push it to the pending stack */
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_s) * head;
+    do {
+      head = cls->pending;
+      s->next = head;
+    } while (!fio_atomic_compare_exchange_p(&cls->pending, &head, &s));
+  }
+  return;
+
+last_slot:
+  /* the slab is (probably) becoming empty, release it while locked */
+  FIO_MEMORY_LOCK(cls->lock);
+  old = fio_atomic_and(s->map + (i >> 6), ~bit);
+  FIO_ASSERT_DEBUG((old & bit), "slab slot freed twice? (%p)", p);
+  if ((old & bit) && fio_atomic_sub(&s->used, 1) == slots &&
+      !fio_atomic_exchange(&s->listed, 1))
+    FIO_LIST_PUSH(&cls->partial, &s->node);
+  if (!s->used && s->node.next && s != cls->current) {
+    FIO_LIST_REMOVE(&s->node);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_slab_release)(s);
+  }
+  FIO_MEMORY_UNLOCK(cls->lock);
+}
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
+/* *****************************************************************************
+Small allocation internal API
+***************************************************************************** */
+
+/* SublimeText marker */
+void fio___mem_slice_new___(void);
+/** slice a block to allocate a set number of bytes. */
+FIO_SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
+                                           __mem_slice_new)(size_t bytes,
+                                                            void *is_realloc) {
+  void *p;
+  bytes = (bytes + ((1UL << FIO_MEMORY_ALIGN_LOG) - 1)) >> FIO_MEMORY_ALIGN_LOG;
+#if FIO_MEMORY_THREAD_CACHE
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_valid))
+    return FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_slice)(bytes, is_realloc);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_arena_lock)();
+  if (a->owner != (void *)&FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token))
+    (void)fio_atomic_exchange(
+        &a->owner,
+        (void *)&FIO_NAME(FIO_MEMORY_NAME, __mem_thread_token));
+  p = FIO_NAME(FIO_MEMORY_NAME, __mem_arena_slice)(a, bytes, is_realloc);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
+  return p;
+}
+
 /* SublimeText marker */
 void fio_____mem_slice_free___(void);
 /** slice a block to allocate a set number of bytes. */
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slice_free)(void *p) {
+#if FIO_MEMORY_THREAD_CACHE
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_rollback)(p);
+#endif /* FIO_MEMORY_THREAD_CACHE */
   FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(p);
 }
 
+/* SublimeText marker */
+void fio_____mem_slice_resize___(void);
+/**
+ * Resizes a slice in place if it's the last slice in its arena's block,
+ * returning NULL if the slice can't be resized (or the arena is busy).
+ */
+FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_slice_resize)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
+    size_t b,
+    void *p,
+    size_t bytes,
+    size_t keep) {
+  void *r = NULL;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena +
+      (c->blocks[b].arena - 1);
+  if (keep > bytes)
+    keep = bytes;
+  bytes = (bytes + ((1UL << FIO_MEMORY_ALIGN_LOG) - 1)) >> FIO_MEMORY_ALIGN_LOG;
+  /* don't wait for the arena, allocating a new slice is cheaper */
+  if (FIO_MEMORY_TRYLOCK(a->lock))
+    return r;
+  if (a->block == FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0) &&
+      !FIO_NAME(FIO_MEMORY_NAME, __mem_arena_resize)(a, c, b, p, bytes, keep))
+    r = p;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
+  return r;
+}
+
 /* *****************************************************************************
 big block allocation / de-allocation
 ***************************************************************************** */
@@ -1805,19 +3816,29 @@ FIO_NAME(FIO_MEMORY_NAME, __mem_big_slice_new)(size_t bytes, void *is_realloc) {
       FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos = 0;
     }
 
+    /* a lucky realloc? (the last slice is resized in place) */
+    if (is_realloc &&
+        is_realloc ==
+            FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(
+                b,
+                FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos) &&
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos + bytes <
+            FIO_MEMORY_UNITS_PER_BIG_BLOCK) {
+      const int32_t end =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos + (int32_t)bytes;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+      if (end < b->pos) /* memory past the block's position is zero */
+        FIO_MEMSET(FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(b, end),
+                   0,
+                   (size_t)(b->pos - end) << FIO_MEMORY_ALIGN_LOG);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+      b->pos = end;
+      FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
+      return is_realloc;
+    }
+
     /* enough space? */
     if (b->pos + bytes < FIO_MEMORY_UNITS_PER_BIG_BLOCK) {
-      /* a lucky realloc? */
-      if (is_realloc &&
-          is_realloc ==
-              FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(
-                  b,
-                  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos)) {
-        b->pos += bytes;
-        FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
-        return is_realloc;
-      }
-
       p = FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(b, b->pos);
       fio_atomic_add(&b->ref, 1); /* keep inside lock to enable reset */
       FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_last_pos = b->pos;
@@ -1895,6 +3916,12 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void) {
                    "\t* local per-allocation limit (before mmap): %zu bytes\n"
                    "\t* malloc(0) pointer:                        %p\n"
                    "\t* always initializes memory  (zero-out):    %s\n"
+                   "\t* per-thread block cache:                   %s\n"
+                   "\t* size-class slab limit:                    %zu bytes\n"
+                   "\t* huge page backed chunks:                  %s\n"
+                   "\t* cached system allocation decay:           %zu ms\n"
+                   "\t* heap profiler sampling interval:          %zu bytes\n"
+                   "\t* NUMA nodes (arena groups):                %zu nodes\n"
                    "\t* " FIO_MEMORY_LOCK_NAME " locking system\n",
       (size_t)FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count,
       (size_t)FIO_MEMORY_SYS_ALLOCATION_SIZE,
@@ -1907,7 +3934,15 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void) {
       (size_t)FIO_MEMORY_BLOCK_ALLOC_LIMIT,
       (size_t)FIO_MEMORY_ALLOC_LIMIT,
       FIO_MEMORY_MALLOC_ZERO_POINTER,
-      (FIO_MEMORY_INITIALIZE_ALLOCATIONS ? "true" : "false"));
+      (FIO_MEMORY_INITIALIZE_ALLOCATIONS ? "true" : "false"),
+      (FIO_MEMORY_THREAD_CACHE ? "true" : "false"),
+      (size_t)FIO_MEMORY_SLAB_LIMIT,
+      (FIO_MEMORY_HUGE_PAGES > 1
+           ? "explicit (MAP_HUGETLB)"
+           : (FIO_MEMORY_HUGE_PAGES ? "transparent (madvise)" : "false")),
+      (size_t)FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay_time)(),
+      (size_t)FIO_MEMORY_PROFILE,
+      FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)());
 }
 
 /* *****************************************************************************
@@ -1947,6 +3982,8 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
             FIO_NAME(FIO_MEMORY_NAME, mmap)) " allocation (slow): %zu bytes",
         FIO_MEM_BYTES2PAGES(size));
 #endif
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_redirects,
+                   1);
     p = FIO_NAME(FIO_MEMORY_NAME, mmap)(size);
     return p;
   }
@@ -1960,14 +3997,28 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
     p = FIO_NAME(FIO_MEMORY_NAME, __mem_big_slice_new)(size, is_realloc);
     if (p && p != is_realloc) {
       FIO_MEMORY_ON_ALLOC_FUNC();
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(p, size);
     }
     return p;
   }
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
 
+#if FIO_MEMORY_SLAB_CLASSES
+  if (size <= FIO_MEMORY_SLAB_LIMIT) {
+    p = FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_new)(
+        (size + (FIO_MEMORY_ALIGN_SIZE - 1)) >> FIO_MEMORY_ALIGN_LOG);
+    if (p) {
+      FIO_MEMORY_ON_ALLOC_FUNC();
+      FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(p, size);
+    }
+    return p;
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
   p = FIO_NAME(FIO_MEMORY_NAME, __mem_slice_new)(size, is_realloc);
   if (p && p != is_realloc) {
     FIO_MEMORY_ON_ALLOC_FUNC();
+    FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)(p, size);
   }
   return p;
 malloc_zero:
@@ -2041,6 +4092,7 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, free)(void *ptr) {
     return;
   }
   FIO_MEMORY_ON_FREE_FUNC();
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_free)(ptr);
 
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
   if (c->marker == FIO_MEMORY_BIG_BLOCK_MARKER) {
@@ -2053,6 +4105,16 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, free)(void *ptr) {
   if (((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE) == (uintptr_t)ptr && c->marker)
     goto mmap_free;
 
+#if FIO_MEMORY_SLAB_CLASSES
+  { /* slab allocation? (slabs have a negative block position) */
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, ptr);
+    if (c->blocks[b].pos < 0) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_slab_slice_free)(c, b, ptr);
+      return;
+    }
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+
   FIO_NAME(FIO_MEMORY_NAME, __mem_slice_free)(ptr);
   return;
 
@@ -2063,14 +4125,20 @@ mmap_free:
              ((size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG) -
                  FIO_MEMORY_ALIGN_SIZE);
   FIO_MEMORY_ON_CHUNK_FREE(c);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_allocations,
+                 1);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes,
+                 (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
   FIO_MEM_SYS_FREE(c, (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
 }
 
 /* SublimeText marker */
 void fio_realloc__(void);
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  */
 SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc)(void *ptr,
                                                              size_t new_size) {
@@ -2084,13 +4152,17 @@ FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
     size_t new_size) {
   const size_t new_len = FIO_MEM_BYTES2PAGES(new_size + FIO_MEMORY_ALIGN_SIZE);
+  const size_t old_len = (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG;
   c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_REALLOC(
       c,
-      (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG,
+      old_len,
       new_len,
       FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG);
   if (!c)
     return NULL;
+  /* unsigned wrap-around subtracts the difference when shrinking */
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes,
+                 new_len - old_len);
   c->marker = (uint32_t)(new_len >> FIO_MEM_PAGE_SIZE_LOG);
   return (void *)((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE);
 }
@@ -2098,8 +4170,10 @@ FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(
 /* SublimeText marker */
 void fio_realloc2__(void);
 /**
- * Re-allocates memory. An attempt to avoid copying the data is made only for
- * big memory allocations (larger than FIO_MEMORY_BLOCK_ALLOC_LIMIT).
+ * Re-allocates memory. An attempt to avoid copying the data is made when the
+ * memory shrinks, when the memory is the last slice in a block (it's resized in
+ * place) and for big memory allocations (larger than
+ * FIO_MEMORY_BLOCK_ALLOC_LIMIT).
  *
  * This variation is slightly faster as it might copy less data.
  */
@@ -2124,6 +4198,9 @@ SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc2)(void *ptr,
         ((uintptr_t)ptr);
 #if FIO_MEMORY_ENABLE_BIG_ALLOC
     if (c->marker == FIO_MEMORY_BIG_BLOCK_MARKER) {
+      /* shrinking? the memory is valid for the new size */
+      if (new_size <= copy_len)
+        return (mem = ptr);
       /* extend max_len to accommodate possible length */
       max_len =
           ((uintptr_t)c + FIO_MEMORY_SYS_ALLOCATION_SIZE) - ((uintptr_t)ptr);
@@ -2131,11 +4208,37 @@ SFUNC void *FIO_MEM_ALIGN FIO_NAME(FIO_MEMORY_NAME, realloc2)(void *ptr,
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
       if ((uintptr_t)(c) + FIO_MEMORY_ALIGN_SIZE == (uintptr_t)ptr &&
           c->marker) {
-        if (new_size > FIO_MEMORY_ALLOC_LIMIT)
-          return (
-              mem = FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(c, new_size));
+        if (new_size > FIO_MEMORY_ALLOC_LIMIT) {
+          mem = FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(c, new_size);
+          if (mem)
+            FIO_NAME(FIO_MEMORY_NAME, __mem_prof_move)(ptr, mem, new_size);
+          return mem;
+        }
         max_len = new_size; /* shrinking from mmap to allocator */
       }
+#if FIO_MEMORY_SLAB_CLASSES
+      else if (c->blocks[b].pos < 0) {
+        /* slab slots are fixed in size, reuse the slot if it's big enough */
+        max_len = (size_t)(-c->blocks[b].pos) << FIO_MEMORY_ALIGN_LOG;
+        if (new_size <= max_len) {
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+          if (copy_len < max_len)
+            FIO_MEMSET((char *)ptr + copy_len, 0, max_len - copy_len);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+          return (mem = ptr);
+        }
+      }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+      else {
+        /* the last slice in an arena's block is resized in place */
+        if (c->blocks[b].arena &&
+            (mem = FIO_NAME(FIO_MEMORY_NAME,
+                            __mem_slice_resize)(c, b, ptr, new_size, copy_len)))
+          return mem;
+        /* shrinking? the memory is valid for the new size */
+        if (new_size <= copy_len)
+          return (mem = ptr);
+      }
 
     if (copy_len > max_len)
       copy_len = max_len;
@@ -2201,7 +4304,12 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size) {
     goto no_mem;
   FIO_MEMORY_ON_ALLOC_FUNC();
   FIO_MEMORY_ON_CHUNK_ALLOC(c);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_allocations,
+                 1);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_counters).mmap_bytes, pages);
   c->marker = (uint32_t)(pages >> FIO_MEM_PAGE_SIZE_LOG);
+  FIO_NAME(FIO_MEMORY_NAME, __mem_prof_alloc)
+  ((void *)((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE), size);
   return (void *)((uintptr_t)c + FIO_MEMORY_ALIGN_SIZE);
 no_mem:
   errno = ENOMEM;
@@ -2429,6 +4537,74 @@ FIO_IFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
   return NULL;
 }
 
+#if FIO_MEMORY_THREAD_CACHE
+#define FIO___MEM_TEST_TCACHE_SLICES 256
+/* allocates slices in a thread that exits before the slices are freed */
+FIO_SFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                              mem_tcache_tsk)(void *ary_) {
+  void **ary = (void **)ary_;
+  for (size_t i = 0; i < FIO___MEM_TEST_TCACHE_SLICES; ++i) {
+    ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(48);
+    FIO_ASSERT(ary[i], "thread cache allocation failed!");
+    FIO_MEMSET(ary[i], (int)(i & 0xFF), 48);
+  }
+  return NULL;
+}
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+#if !FIO_MEMORY_THREAD_CACHE
+#define FIO___MEM_TEST_REMOTE_SLICES 256
+/* frees slices that were allocated by another thread (NULL terminated) */
+FIO_SFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                              mem_remote_tsk)(void *ary_) {
+  void **ary = (void **)ary_;
+  for (size_t i = 0; ary[i]; ++i)
+    FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+  return NULL;
+}
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+#if FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE
+#define FIO___MEM_TEST_NUMA_SLICES 8
+/* the (fake) NUMA node of the calling thread */
+static __thread size_t FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                     mem_numa_node_value);
+FIO_SFUNC size_t FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                               mem_numa_node)(void) {
+  return FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio), mem_numa_node_value);
+}
+/* allocates blocks on a fake node, testing arena and chunk placement */
+FIO_SFUNC void *FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                              mem_numa_tsk)(void *node_) {
+  void *ary[FIO___MEM_TEST_NUMA_SLICES];
+  const size_t node = (size_t)(uintptr_t)node_;
+  const size_t group = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count /
+                       FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)();
+  FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio), mem_numa_node_value) = node;
+  /* blocks sliced before the topology changed are used up first */
+  for (size_t i = 0; i < FIO___MEM_TEST_NUMA_SLICES; ++i) {
+    ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+    FIO_ASSERT(ary[i], "NUMA block allocation failed!");
+    FIO_MEMSET(ary[i], (int)node, FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+  }
+  void *p = ary[FIO___MEM_TEST_NUMA_SLICES - 1];
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+  const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, p);
+  const size_t arena = (size_t)c->blocks[b].arena;
+  FIO_ASSERT(arena > node * group && arena <= (node + 1) * group,
+             "thread on node %zu should use the node's arenas (used %zu)",
+             node,
+             arena - 1);
+  FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_node)(c) == node,
+             "blocks should be taken from chunks on the thread's node (%zu)",
+             node);
+  for (size_t i = 0; i < FIO___MEM_TEST_NUMA_SLICES; ++i)
+    FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+  return NULL;
+}
+#endif /* FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE */
+
 /* main test function */
 FIO_SFUNC void FIO_NAME_TEST(FIO_NAME(stl, FIO_MEMORY_NAME), mem)(void) {
   fprintf(stderr,
@@ -2487,6 +4663,351 @@ FIO_SFUNC void FIO_NAME_TEST(FIO_NAME(stl, FIO_MEMORY_NAME), mem)(void) {
       }
     }
   }
+#if FIO_MEMORY_THREAD_CACHE
+  {
+    fprintf(stderr, "* Testing per-thread block cache.\n");
+    char *a = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(32);
+    FIO_ASSERT(a, "thread cache allocation failed!");
+    FIO_MEMSET(a, 0xFF, 32);
+    FIO_NAME(FIO_MEMORY_NAME, free)(a);
+    char *b = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(32);
+    FIO_ASSERT(a == b, "thread cache didn't reuse the latest (freed) slice!");
+    FIO_ASSERT(!FIO_MEMORY_INITIALIZE_ALLOCATIONS || (!b[0] && !b[31]),
+               "thread cache reused memory that wasn't zeroed out!");
+    FIO_NAME(FIO_MEMORY_NAME, free)(b);
+
+    void *ary[4][FIO___MEM_TEST_TCACHE_SLICES];
+    fio_thread_t threads[4];
+    for (size_t i = 0; i < 4; ++i) {
+      FIO_ASSERT(!fio_thread_create(
+                     threads + i,
+                     FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                   mem_tcache_tsk),
+                     (void *)ary[i]),
+                 "couldn't spawn thread for thread cache test");
+    }
+    for (size_t i = 0; i < 4; ++i)
+      fio_thread_join(threads + i);
+    for (size_t i = 0; i < 4; ++i) {
+      /* the thread's reference to the block is released on thread exit */
+      FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+          FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(ary[i][0]);
+      size_t blk = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, ary[i][0]);
+      FIO_ASSERT((size_t)c->blocks[blk].ref == FIO___MEM_TEST_TCACHE_SLICES,
+                 "thread cache block wasn't released on thread exit (%zu)",
+                 (size_t)c->blocks[blk].ref);
+      for (size_t j = 0; j < FIO___MEM_TEST_TCACHE_SLICES; ++j) {
+        FIO_ASSERT(((uint8_t *)ary[i][j])[0] == (uint8_t)(j & 0xFF) &&
+                       ((uint8_t *)ary[i][j])[47] == (uint8_t)(j & 0xFF),
+                   "thread cache memory corrupted (thread %zu, slice %zu)",
+                   i,
+                   j);
+        FIO_NAME(FIO_MEMORY_NAME, free)(ary[i][j]);
+      }
+    }
+  }
+#undef FIO___MEM_TEST_TCACHE_SLICES
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_SLAB_CLASSES
+  {
+    fprintf(stderr, "* Testing size-class slabs (slot reuse).\n");
+    void *ary[512];
+    char *keep = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(48);
+    FIO_ASSERT(keep, "slab allocation failed!");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(keep);
+    size_t blk = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, keep);
+    FIO_ASSERT(c->blocks[blk].pos < 0, "small allocation isn't in a slab!");
+    for (size_t round = 0; round < 2; ++round) {
+      for (size_t i = 0; i < 512; ++i) {
+        ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(48);
+        FIO_ASSERT(ary[i], "slab allocation failed!");
+        FIO_ASSERT(!FIO_MEMORY_INITIALIZE_ALLOCATIONS ||
+                       (!((char *)ary[i])[0] && !((char *)ary[i])[47]),
+                   "slab slot wasn't zeroed out!");
+        /* freed slots are reused, the kept slot doesn't pin new blocks */
+        FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(ary[i]) == c &&
+                       FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(
+                           c,
+                           ary[i]) == blk,
+                   "slab slots weren't reused (round %zu, slot %zu)",
+                   round,
+                   i);
+        FIO_MEMSET(ary[i], 0xFF, 48);
+      }
+      for (size_t i = 0; i < 512; ++i)
+        FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+    }
+    keep[0] = 1;
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, realloc2)(keep, 40, 1) == keep,
+               "slab reallocation within the slot should be in place");
+    FIO_ASSERT(keep[0] == 1, "slab reallocation lost data!");
+    FIO_NAME(FIO_MEMORY_NAME, free)(keep);
+  }
+#endif /* FIO_MEMORY_SLAB_CLASSES */
+#if FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY
+  {
+    fprintf(stderr, "* Testing cached chunk decay.\n");
+    /* age (and unmap) any existing cached chunks */
+    for (size_t i = 0; i < FIO_MEMORY_CACHE_SLOTS; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[i] -=
+          ((int64_t)FIO_MEMORY_CACHE_DECAY << 1);
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos,
+               "aged cached chunks should have been unmapped");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_new)(1);
+    FIO_ASSERT(c, "chunk allocation failed!");
+    FIO_MEMORY_LOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->lock);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c); /* caches and unlocks */
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos == 1 &&
+                   FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.a[0] == c,
+               "freed chunk should have been cached");
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos == 1 &&
+                   !FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[0],
+               "a recently cached chunk shouldn't decay");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[0] -=
+        FIO_MEMORY_CACHE_DECAY;
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos == 1 &&
+                   FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.purged[0],
+               "an idle cached chunk should be released, but remain mapped");
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.at[0] -=
+        FIO_MEMORY_CACHE_DECAY;
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos,
+               "a long idle cached chunk should be unmapped");
+  }
+#endif /* FIO_MEMORY_CACHE_SLOTS && FIO_MEMORY_CACHE_DECAY */
+  {
+    fprintf(stderr, "* Testing allocator statistics.\n");
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    s0 = FIO_NAME(FIO_MEMORY_NAME, malloc_stats)();
+    FIO_ASSERT(s0.arenas ==
+                   FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count,
+               "statistics arena count error");
+    FIO_ASSERT(s0.chunks_mapped >= s0.chunks_cached,
+               "statistics should count cached chunks as mapped");
+    void *p = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_ALLOC_LIMIT + 1);
+    FIO_ASSERT(p, "mmap redirected allocation failed!");
+    FIO_NAME(FIO_MEMORY_NAME, malloc_stats_s)
+    s1 = FIO_NAME(FIO_MEMORY_NAME, malloc_stats)();
+    FIO_ASSERT(s1.mmap_redirects == s0.mmap_redirects + 1 &&
+                   s1.mmap_allocations == s0.mmap_allocations + 1 &&
+                   s1.mmap_bytes > s0.mmap_bytes + FIO_MEMORY_ALLOC_LIMIT,
+               "statistics should count allocations redirected to mmap");
+    FIO_NAME(FIO_MEMORY_NAME, free)(p);
+    s1 = FIO_NAME(FIO_MEMORY_NAME, malloc_stats)();
+    FIO_ASSERT(s1.mmap_allocations == s0.mmap_allocations &&
+                   s1.mmap_bytes == s0.mmap_bytes,
+               "statistics should count mmap deallocations");
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(s0.arenas)
+                    .allocations,
+               "statistics for a missing arena should be zero");
+#if !FIO_MEMORY_THREAD_CACHE
+    size_t allocations = 0;
+    for (size_t i = 0; i < s0.arenas; ++i)
+      allocations +=
+          FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).allocations;
+    p = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_SLAB_LIMIT + 16);
+    FIO_ASSERT(p, "arena allocation failed!");
+    for (size_t i = 0; i < s0.arenas; ++i)
+      allocations -=
+          FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).allocations;
+    FIO_ASSERT(allocations == (size_t)-1,
+               "statistics should count arena allocations");
+    FIO_NAME(FIO_MEMORY_NAME, free)(p);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+  }
+#if !FIO_MEMORY_THREAD_CACHE
+  {
+    fprintf(stderr, "* Testing remote (cross-thread) block frees.\n");
+    void *ary[FIO___MEM_TEST_REMOTE_SLICES + 1];
+    size_t reclaimed = 0, remote = 0, count;
+    fio_thread_t t;
+    const size_t per_block =
+        FIO_MEMORY_BLOCK_SIZE / FIO_MEMORY_BLOCK_ALLOC_LIMIT;
+    FIO_ASSERT(per_block * FIO_MEMORY_BLOCKS_PER_ALLOCATION * 3 <=
+                       FIO___MEM_TEST_REMOTE_SLICES &&
+                   per_block * FIO___MEM_REMOTE_FREE_LIMIT * 2 <=
+                       FIO___MEM_TEST_REMOTE_SLICES,
+               "remote free test array too small");
+    /* blocks freed by the arena's owner are released without waiting */
+    count = per_block * FIO_MEMORY_BLOCKS_PER_ALLOCATION * 3;
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    {
+      size_t mapped = FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks;
+      size_t cached = 0;
+#if FIO_MEMORY_CACHE_SLOTS
+      cached = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos;
+#endif /* FIO_MEMORY_CACHE_SLOTS */
+      for (size_t i = 0; i < count; ++i)
+        FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+#if FIO_MEMORY_CACHE_SLOTS
+      cached = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cache.pos - cached;
+#endif /* FIO_MEMORY_CACHE_SLOTS */
+      FIO_ASSERT(cached ||
+                     FIO_NAME(FIO_MEMORY_NAME, __mem_counters).chunks < mapped,
+                 "chunks emptied by the arena's owner should be released");
+    }
+    /* remote-free lists are bounded */
+    count = per_block * FIO___MEM_REMOTE_FREE_LIMIT * 2;
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    ary[count] = NULL;
+    FIO_ASSERT(!fio_thread_create(&t,
+                                  FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                                mem_remote_tsk),
+                                  (void *)ary),
+               "couldn't start remote free thread");
+    fio_thread_join(&t);
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i) {
+      size_t len = 0;
+      for (FIO_LIST_NODE *n =
+               FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote;
+           n;
+           n = n->next)
+        ++len;
+      FIO_ASSERT(len < FIO___MEM_REMOTE_FREE_LIMIT,
+                 "remote-free lists should be returned once they're full");
+    }
+    /* remote-free lists are reclaimed by the arena */
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    count = per_block * (FIO___MEM_REMOTE_FREE_LIMIT >> 1);
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    ary[count] = NULL;
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      reclaimed += FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).reclaimed;
+    FIO_ASSERT(!fio_thread_create(&t,
+                                  FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                                mem_remote_tsk),
+                                  (void *)ary),
+               "couldn't start remote free thread");
+    fio_thread_join(&t);
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      remote += !!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote;
+    FIO_ASSERT(remote,
+               "blocks emptied by another thread should wait in the arena's "
+               "remote-free list");
+    for (size_t i = 0; i < count; ++i) {
+      ary[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_BLOCK_ALLOC_LIMIT);
+      FIO_ASSERT(ary[i], "block allocation failed!");
+    }
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      reclaimed -= FIO_NAME(FIO_MEMORY_NAME, malloc_arena_stats)(i).reclaimed;
+    FIO_ASSERT((intptr_t)reclaimed < 0,
+               "the arena should reclaim blocks from its remote-free list");
+    for (size_t i = 0; i < count; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, free)(ary[i]);
+    FIO_NAME(FIO_MEMORY_NAME, malloc_cache_decay)();
+    for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
+         ++i)
+      FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].remote,
+                 "malloc_cache_decay should empty the remote-free lists");
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if !FIO_MEMORY_THREAD_CACHE
+  if (((FIO_MEMORY_SLAB_LIMIT + 64) << 1) < FIO_MEMORY_BLOCK_ALLOC_LIMIT) {
+    fprintf(stderr, "* Testing in place reallocation (last slice in block).\n");
+    const size_t len = FIO_MEMORY_SLAB_LIMIT + 64;
+    char *p = (char *)FIO_NAME(FIO_MEMORY_NAME, malloc)(len);
+    FIO_ASSERT(p, "arena allocation failed!");
+    FIO_MEMSET(p, 'a', len);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, p);
+    const size_t offset =
+        (size_t)((uintptr_t)p -
+                 (uintptr_t)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0));
+    char *tmp = (char *)FIO_NAME(FIO_MEMORY_NAME, realloc2)(p, len << 1, len);
+    FIO_ASSERT(tmp, "reallocation failed!");
+    FIO_ASSERT(tmp == p || offset + (len << 1) >= FIO_MEMORY_BLOCK_SIZE,
+               "the last slice in a block should grow in place");
+    p = tmp;
+    FIO_ASSERT(p[0] == 'a' && p[len - 1] == 'a',
+               "in place reallocation should keep the data");
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+    for (size_t i = len; i < (len << 1); ++i)
+      FIO_ASSERT(!p[i], "reallocated memory should be zeroed (%zu)", i);
+#endif /* FIO_MEMORY_INITIALIZE_ALLOCATIONS */
+    tmp = (char *)FIO_NAME(FIO_MEMORY_NAME, realloc2)(p, 32, 32);
+    FIO_ASSERT(tmp == p, "shrinking should never move the memory");
+    FIO_ASSERT(p[0] == 'a' && p[31] == 'a',
+               "in place shrinking should keep the data");
+    FIO_NAME(FIO_MEMORY_NAME, free)(p);
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count > 1) {
+    fprintf(stderr, "* Testing NUMA arena groups (fake topology).\n");
+    const size_t detected = FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)();
+    FIO_ASSERT(
+        FIO_NAME(FIO_MEMORY_NAME, malloc_numa_topology)(
+            2,
+            FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio), mem_numa_node)) == 0,
+        "faking the NUMA topology failed");
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)() == 2,
+               "the fake NUMA topology should have 2 nodes");
+    for (size_t node = 0; node < 2; ++node) {
+      fio_thread_t t;
+      FIO_ASSERT(
+          !fio_thread_create(&t,
+                             FIO_NAME_TEST(FIO_NAME(FIO_MEMORY_NAME, fio),
+                                           mem_numa_tsk),
+                             (void *)(uintptr_t)node),
+          "couldn't start NUMA test thread");
+      fio_thread_join(&t);
+    }
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, malloc_numa_topology)(0, NULL) == 0 &&
+                   FIO_NAME(FIO_MEMORY_NAME, malloc_numa_nodes)() == detected,
+               "restoring the detected NUMA topology failed");
+  }
+#endif /* FIO_MEMORY_NUMA && !FIO_MEMORY_THREAD_CACHE */
+#if FIO_MEMORY_PROFILE
+  {
+    void *p[64];
+    const size_t live = FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count;
+    const size_t before = live + FIO_NAME(FIO_MEMORY_NAME, __mem_prof).dropped;
+    fprintf(stderr, "* Testing heap profiler (sampled allocations).\n");
+    /* each allocation is larger than the longest sampling interval */
+    for (size_t i = 0; i < 64; ++i) {
+      p[i] = FIO_NAME(FIO_MEMORY_NAME, malloc)(FIO_MEMORY_PROFILE * 2);
+      FIO_ASSERT(p[i], "sampled allocation failed!");
+    }
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count +
+                       FIO_NAME(FIO_MEMORY_NAME, __mem_prof).dropped >=
+                   before + 63,
+               "heap profiler should sample large allocations");
+    FILE *tmp = tmpfile();
+    FIO_ASSERT(tmp, "couldn't create a temporary file for the heap profile");
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(fileno(tmp), 0),
+               "heap profile dump (pprof) failed");
+    FIO_ASSERT(!FIO_NAME(FIO_MEMORY_NAME, malloc_profile_dump)(fileno(tmp), 1),
+               "heap profile dump (folded) failed");
+    char header[16] = {0};
+    FIO_ASSERT(pread(fileno(tmp), header, 14, 0) == 14 &&
+                   !FIO_MEMCMP(header, "heap profile: ", 14),
+               "heap profile dump header error");
+    fclose(tmp);
+    for (size_t i = 0; i < 64; ++i)
+      FIO_NAME(FIO_MEMORY_NAME, free)(p[i]);
+    FIO_ASSERT(FIO_NAME(FIO_MEMORY_NAME, __mem_prof).count <= live,
+               "heap profiler should forget freed allocations");
+  }
+#endif /* FIO_MEMORY_PROFILE */
   fprintf(stderr,
           "* Re-validating allocation alignment on %zu byte border.\n",
           (size_t)(FIO_MEMORY_ALIGN_SIZE));
@@ -2528,8 +5049,10 @@ Memory pool cleanup
 #undef FIO_MEMORY_PRINT_STATS_END
 
 #undef FIO_MEMORY_ARENA_COUNT
+#undef FIO_MEMORY_THREAD_CACHE
 #undef FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG
 #undef FIO_MEMORY_CACHE_SLOTS
+#undef FIO_MEMORY_CACHE_DECAY
 #undef FIO_MEMORY_ALIGN_LOG
 #undef FIO_MEMORY_INITIALIZE_ALLOCATIONS
 #undef FIO_MEMORY_USE_THREAD_MUTEX
@@ -2537,6 +5060,19 @@ Memory pool cleanup
 #undef FIO_MEMORY_BLOCKS_PER_ALLOCATION_LOG
 #undef FIO_MEMORY_BLOCKS_PER_ALLOCATION
 #undef FIO_MEMORY_ENABLE_BIG_ALLOC
+#undef FIO_MEMORY_SLAB_LIMIT
+#undef FIO_MEMORY_SLAB_CLASSES
+#undef FIO_MEMORY_HUGE_PAGES
+#undef FIO_MEMORY_PROFILE
+#undef FIO_MEMORY_PROFILE_DEPTH
+#undef FIO_MEMORY_PROFILE_SLOTS
+#undef FIO_MEMORY_PROFILE_SLOTS_LOG
+#undef FIO_MEMORY_PROFILE_MASK
+#undef FIO_MEMORY_PROFILE_FILTER_MASK
+#undef FIO_MEMORY_NUMA
+#undef FIO_MEMORY_NUMA_MAX_NODES
+#undef FIO_MEMORY_NUMA_MAX_CPUS
+#undef FIO_MEMORY_NUMA_LISTS
 #undef FIO_MEMORY_ARENA_COUNT_FALLBACK
 #undef FIO_MEMORY_ARENA_COUNT_MAX
 #undef FIO_MEMORY_WARMUP
@@ -2547,5 +5083,7 @@ Memory pool cleanup
 #undef FIO_MEMORY_TRYLOCK
 #undef FIO_MEMORY_LOCK
 #undef FIO_MEMORY_UNLOCK
+#undef FIO___MEM_ARENA_ALIGN
+#undef FIO___MEM_REMOTE_FREE_LIMIT
 
 /* don't undefine FIO_MEMORY_NAME due to possible use in allocation macros */
@@ -0,0 +1,437 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_REGION_NAME region /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                  Region (bump / arena) Memory Allocator
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_REGION_NAME) && !defined(FIO___RECURSIVE_INCLUDE)
+
+/* *****************************************************************************
+Region Settings
+***************************************************************************** */
+
+#ifndef FIO_REGION_PAGE_SIZE
+/** The size of each page (system allocation) in the region's page chain. */
+#define FIO_REGION_PAGE_SIZE 8192
+#endif
+
+#ifndef FIO_REGION_ALIGN_LOG
+/** Allocation alignment, MUST be >= 3 and <= 10 */
+#define FIO_REGION_ALIGN_LOG 4
+#elif FIO_REGION_ALIGN_LOG < 3 || FIO_REGION_ALIGN_LOG > 10
+#undef FIO_REGION_ALIGN_LOG
+#define FIO_REGION_ALIGN_LOG 4
+#endif
+
+/* Helper macros, don't change their values */
+#undef FIO_REGION_ALIGN_SIZE
+#undef FIO_REGION_HEADER_SIZE
+#undef FIO_REGION_PAGE_CAPA
+#undef FIO_REGION_ALLOC_LIMIT
+
+#define FIO_REGION_ALIGN_SIZE (1UL << FIO_REGION_ALIGN_LOG)
+/* page header size, rounded up to the allocation alignment */
+#define FIO_REGION_HEADER_SIZE                                                 \
+  ((sizeof(FIO_NAME(FIO_REGION_NAME, __page_s)) +                              \
+    (FIO_REGION_ALIGN_SIZE - 1)) &                                             \
+   (~(FIO_REGION_ALIGN_SIZE - 1)))
+/* bytes available for allocations in each (regular) page */
+#define FIO_REGION_PAGE_CAPA (FIO_REGION_PAGE_SIZE - FIO_REGION_HEADER_SIZE)
+/* larger allocations are given their own (dedicated) page */
+#define FIO_REGION_ALLOC_LIMIT (FIO_REGION_PAGE_CAPA >> 2)
+
+/* *****************************************************************************
+Region API - types, constructor / destructor
+***************************************************************************** */
+
+typedef struct FIO_NAME(FIO_REGION_NAME, __page_s)
+    FIO_NAME(FIO_REGION_NAME, __page_s);
+
+/* a page in the region's page chain, the allocations follow the header */
+struct FIO_NAME(FIO_REGION_NAME, __page_s) {
+  FIO_NAME(FIO_REGION_NAME, __page_s) * next;
+  /* bytes available after the (aligned) header */
+  size_t capa;
+};
+
+typedef struct {
+  /* do not directly access! */
+  FIO_NAME(FIO_REGION_NAME, __page_s) * first; /* retained page chain */
+  FIO_NAME(FIO_REGION_NAME, __page_s) * page;  /* current page in the chain */
+  FIO_NAME(FIO_REGION_NAME, __page_s) * big;   /* dedicated (large) pages */
+  char *pos;
+  char *end;
+  void *last; /* the last allocation may be resized / freed in place */
+} FIO_NAME(FIO_REGION_NAME, s);
+
+#ifndef FIO_REGION_INIT
+/* Initialization macro. */
+#define FIO_REGION_INIT                                                        \
+  { 0 }
+#endif
+
+/* do we have a constructor? */
+#ifndef FIO_REF_CONSTRUCTOR_ONLY
+
+/* Allocates a new region object on the heap and initializes it's memory. */
+FIO_IFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, new)(void);
+
+/* Frees all the region's memory AND the object's container! */
+FIO_IFUNC int FIO_NAME(FIO_REGION_NAME, free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                               r);
+
+#endif /* FIO_REF_CONSTRUCTOR_ONLY */
+
+/** Returns all the region's memory to the system and re-initializes it. */
+SFUNC void FIO_NAME(FIO_REGION_NAME, destroy)(FIO_NAME(FIO_REGION_NAME, s) *
+                                              r);
+
+/**
+ * Invalidates all the allocations made using the region, so its memory can be
+ * reused.
+ *
+ * The page chain is retained, so this is O(1) unless large (dedicated page)
+ * allocations were made, which are returned to the system.
+ */
+FIO_IFUNC void FIO_NAME(FIO_REGION_NAME, reset)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                r);
+
+/* *****************************************************************************
+Region API - allocation
+***************************************************************************** */
+
+/**
+ * Allocates `size` bytes from the region.
+ *
+ * Memory isn't initialized (it may contain junk data from before a `reset`).
+ *
+ * Returns NULL on error (`errno` is set to ENOMEM).
+ */
+FIO_IFUNC void *FIO_NAME(FIO_REGION_NAME, malloc)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                      r,
+                                                  size_t size);
+
+/**
+ * Re-allocates memory, copying (at most) `copy_len` bytes if the memory moved.
+ *
+ * The last allocation made using the region is resized in place whenever
+ * possible. Otherwise the old memory remains reserved until the region is
+ * reset (or destroyed).
+ */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, realloc2)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                    r,
+                                                void *ptr,
+                                                size_t new_size,
+                                                size_t copy_len);
+
+/**
+ * Allows the memory to be reused if `ptr` was the last allocation made using
+ * the region (or a large allocation). Otherwise does nothing.
+ *
+ * Memory is normally reclaimed in bulk, using `reset` or `destroy`.
+ */
+SFUNC void FIO_NAME(FIO_REGION_NAME, dealloc)(FIO_NAME(FIO_REGION_NAME, s) * r,
+                                              void *ptr);
+
+/* *****************************************************************************
+Region API - the calling thread's region (used by types)
+***************************************************************************** */
+
+/**
+ * Sets the calling thread's current region, returning the previous one.
+ *
+ * Types defined in the same `include` statement as the region allocate their
+ * memory from the calling thread's current region (see `FIO_MEM_REALLOC_`).
+ */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) *
+    FIO_NAME(FIO_REGION_NAME, use)(FIO_NAME(FIO_REGION_NAME, s) * r);
+
+/** Returns the calling thread's current region (or NULL). */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, current)(void);
+
+/* *****************************************************************************
+Region Implementation - inlined static functions
+***************************************************************************** */
+
+/* returns the first (aligned) allocation address in a page */
+#define FIO_REGION_PAGE2PTR(page) ((char *)(page) + FIO_REGION_HEADER_SIZE)
+
+/* do we have a constructor? */
+#ifndef FIO_REF_CONSTRUCTOR_ONLY
+/* Allocates a new region object on the heap and initializes it's memory. */
+FIO_IFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, new)(void) {
+  FIO_NAME(FIO_REGION_NAME, s) *r = (FIO_NAME(FIO_REGION_NAME, s) *)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*r), 0);
+  if (r) {
+    *r = (FIO_NAME(FIO_REGION_NAME, s))FIO_REGION_INIT;
+  }
+  return r;
+}
+/* Frees all the region's memory AND the object's container! */
+FIO_IFUNC int FIO_NAME(FIO_REGION_NAME, free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                               r) {
+  FIO_NAME(FIO_REGION_NAME, destroy)(r);
+  FIO_MEM_FREE_(r, sizeof(*r));
+  return 0;
+}
+#endif /* FIO_REF_CONSTRUCTOR_ONLY */
+
+/* allocates a new page / collects a large allocation (slow path) */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, __malloc_slow)(FIO_NAME(FIO_REGION_NAME,
+                                                              s) *
+                                                         r,
+                                                     size_t size);
+
+/* returns the large allocation (dedicated page) list to the system */
+SFUNC void FIO_NAME(FIO_REGION_NAME, __big_free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                 r);
+
+/* Invalidates all allocations (O(1) unless large allocations were made). */
+FIO_IFUNC void FIO_NAME(FIO_REGION_NAME, reset)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                r) {
+  if (!r)
+    return;
+  if (r->big)
+    FIO_NAME(FIO_REGION_NAME, __big_free)(r);
+  r->page = r->first;
+  r->last = NULL;
+  r->pos = r->end = NULL;
+  if (r->first) {
+    r->pos = FIO_REGION_PAGE2PTR(r->first);
+    r->end = r->pos + r->first->capa;
+  }
+}
+
+/* Allocates `size` bytes from the region. */
+FIO_IFUNC void *FIO_NAME(FIO_REGION_NAME, malloc)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                      r,
+                                                  size_t size) {
+  void *p;
+  if (!r || size > ((~(size_t)0) >> 1))
+    goto no_mem;
+  size = (size + (!size << FIO_REGION_ALIGN_LOG) +
+          (FIO_REGION_ALIGN_SIZE - 1)) &
+         (~(FIO_REGION_ALIGN_SIZE - 1));
+  if ((size_t)(r->end - r->pos) < size)
+    return FIO_NAME(FIO_REGION_NAME, __malloc_slow)(r, size);
+  p = (void *)r->pos;
+  r->pos += size;
+  r->last = p;
+  return p;
+no_mem:
+  errno = ENOMEM;
+  return NULL;
+}
+
+/* *****************************************************************************
+Region Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+/* the calling thread's current region */
+static __thread FIO_NAME(FIO_REGION_NAME, s) *
+    FIO_NAME(FIO_REGION_NAME, __current);
+
+/** Sets the calling thread's current region, returning the previous one. */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) *
+    FIO_NAME(FIO_REGION_NAME, use)(FIO_NAME(FIO_REGION_NAME, s) * r) {
+  FIO_NAME(FIO_REGION_NAME, s) *old = FIO_NAME(FIO_REGION_NAME, __current);
+  FIO_NAME(FIO_REGION_NAME, __current) = r;
+  return old;
+}
+
+/** Returns the calling thread's current region (or NULL). */
+SFUNC FIO_NAME(FIO_REGION_NAME, s) * FIO_NAME(FIO_REGION_NAME, current)(void) {
+  return FIO_NAME(FIO_REGION_NAME, __current);
+}
+
+/* allocates a page with `capa` bytes available for allocations */
+FIO_SFUNC FIO_NAME(FIO_REGION_NAME, __page_s) *
+    FIO_NAME(FIO_REGION_NAME, __page_new)(size_t capa) {
+  FIO_NAME(FIO_REGION_NAME, __page_s) *page =
+      (FIO_NAME(FIO_REGION_NAME, __page_s) *)
+          FIO_MEM_REALLOC_(NULL, 0, FIO_REGION_HEADER_SIZE + capa, 0);
+  if (!page)
+    return page;
+  page->next = NULL;
+  page->capa = capa;
+  return page;
+}
+
+/* returns a page list to the system */
+FIO_SFUNC void FIO_NAME(FIO_REGION_NAME, __page_free_all)(
+    FIO_NAME(FIO_REGION_NAME, __page_s) * page) {
+  while (page) {
+    FIO_NAME(FIO_REGION_NAME, __page_s) *tmp = page;
+    page = page->next;
+    FIO_MEM_FREE_(tmp, FIO_REGION_HEADER_SIZE + tmp->capa);
+  }
+}
+
+/* returns the large allocation (dedicated page) list to the system */
+SFUNC void FIO_NAME(FIO_REGION_NAME, __big_free)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                 r) {
+  FIO_NAME(FIO_REGION_NAME, __page_free_all)(r->big);
+  r->big = NULL;
+}
+
+/* allocates a new page / collects a large allocation (slow path) */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, __malloc_slow)(FIO_NAME(FIO_REGION_NAME,
+                                                              s) *
+                                                         r,
+                                                     size_t size) {
+  FIO_NAME(FIO_REGION_NAME, __page_s) * page;
+  if (size > FIO_REGION_ALLOC_LIMIT) {
+    /* large allocations are given a dedicated page */
+    if (size + FIO_REGION_HEADER_SIZE < size)
+      goto no_mem;
+    page = FIO_NAME(FIO_REGION_NAME, __page_new)(size);
+    if (!page)
+      goto no_mem;
+    page->next = r->big;
+    r->big = page;
+    return (void *)FIO_REGION_PAGE2PTR(page);
+  }
+  if (r->page && r->page->next) {
+    /* reuse a page retained by `reset` */
+    page = r->page->next;
+  } else {
+    page = FIO_NAME(FIO_REGION_NAME, __page_new)(FIO_REGION_PAGE_CAPA);
+    if (!page)
+      goto no_mem;
+    if (r->page)
+      r->page->next = page;
+    else
+      r->first = page;
+  }
+  r->page = page;
+  r->pos = FIO_REGION_PAGE2PTR(page) + size;
+  r->end = FIO_REGION_PAGE2PTR(page) + page->capa;
+  r->last = (void *)FIO_REGION_PAGE2PTR(page);
+  return r->last;
+no_mem:
+  errno = ENOMEM;
+  return NULL;
+}
+
+/** Returns all the region's memory to the system and re-initializes it. */
+SFUNC void FIO_NAME(FIO_REGION_NAME, destroy)(FIO_NAME(FIO_REGION_NAME, s) *
+                                              r) {
+  if (!r)
+    return;
+  FIO_NAME(FIO_REGION_NAME, __page_free_all)(r->big);
+  FIO_NAME(FIO_REGION_NAME, __page_free_all)(r->first);
+  *r = (FIO_NAME(FIO_REGION_NAME, s))FIO_REGION_INIT;
+}
+
+/** Re-allocates memory, copying (at most) `copy_len` if the memory moved. */
+SFUNC void *FIO_NAME(FIO_REGION_NAME, realloc2)(FIO_NAME(FIO_REGION_NAME, s) *
+                                                    r,
+                                                void *ptr,
+                                                size_t new_size,
+                                                size_t copy_len) {
+  void *p;
+  if (!ptr)
+    return FIO_NAME(FIO_REGION_NAME, malloc)(r, new_size);
+  if (!r || new_size > ((~(size_t)0) >> 1))
+    goto no_mem;
+  new_size = (new_size + (!new_size << FIO_REGION_ALIGN_LOG) +
+              (FIO_REGION_ALIGN_SIZE - 1)) &
+             (~(FIO_REGION_ALIGN_SIZE - 1));
+  if (ptr == r->last && (size_t)(r->end - (char *)ptr) >= new_size) {
+    /* the last allocation is resized in place */
+    r->pos = (char *)ptr + new_size;
+    return ptr;
+  }
+  if (r->big && ptr == (void *)FIO_REGION_PAGE2PTR(r->big) &&
+      new_size > FIO_REGION_ALLOC_LIMIT) {
+    /* the last large allocation is reallocated by the system allocator */
+    if (new_size + FIO_REGION_HEADER_SIZE < new_size)
+      goto no_mem;
+    if (copy_len > new_size)
+      copy_len = new_size;
+    FIO_NAME(FIO_REGION_NAME, __page_s) *page =
+        (FIO_NAME(FIO_REGION_NAME, __page_s) *)FIO_MEM_REALLOC_(
+            r->big,
+            FIO_REGION_HEADER_SIZE + r->big->capa,
+            FIO_REGION_HEADER_SIZE + new_size,
+            FIO_REGION_HEADER_SIZE + copy_len);
+    if (!page)
+      goto no_mem;
+    page->capa = new_size;
+    r->big = page;
+    return (void *)FIO_REGION_PAGE2PTR(page);
+  }
+  p = FIO_NAME(FIO_REGION_NAME, malloc)(r, new_size);
+  if (!p)
+    return p;
+  if (copy_len > new_size)
+    copy_len = new_size;
+  if (copy_len)
+    FIO_MEMCPY(p, ptr, copy_len);
+  return p;
+no_mem:
+  errno = ENOMEM;
+  return NULL;
+}
+
+/** Allows the memory to be reused if `ptr` was the last allocation. */
+SFUNC void FIO_NAME(FIO_REGION_NAME, dealloc)(FIO_NAME(FIO_REGION_NAME, s) * r,
+                                              void *ptr) {
+  if (!r || !ptr)
+    return;
+  if (ptr == r->last) {
+    r->pos = (char *)ptr;
+    r->last = NULL;
+    return;
+  }
+  if (r->big && ptr == (void *)FIO_REGION_PAGE2PTR(r->big)) {
+    FIO_NAME(FIO_REGION_NAME, __page_s) *page = r->big;
+    r->big = page->next;
+    FIO_MEM_FREE_(page, FIO_REGION_HEADER_SIZE + page->capa);
+  }
+}
+
+/* *****************************************************************************
+Module Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO_REGION_PAGE2PTR
+#undef FIO_REGION_ALIGN_SIZE
+#undef FIO_REGION_HEADER_SIZE
+#undef FIO_REGION_PAGE_CAPA
+#undef FIO_REGION_ALLOC_LIMIT
+
+/* *****************************************************************************
+Route the memory allocation macros to the calling thread's current region
+***************************************************************************** */
+#ifndef FIO_MALLOC_TMP_USE_SYSTEM
+
+#undef FIO_MEM_REALLOC_
+#undef FIO_MEM_FREE_
+#undef FIO_MEM_REALLOC_IS_SAFE_
+
+#define FIO_MEM_REALLOC_(ptr, old_size, new_size, copy_len)                    \
+  FIO_NAME(FIO_REGION_NAME, realloc2)                                          \
+  (FIO_NAME(FIO_REGION_NAME, current)(), (ptr), (new_size), (copy_len))
+#define FIO_MEM_FREE_(ptr, size)                                               \
+  FIO_NAME(FIO_REGION_NAME, dealloc)                                           \
+  (FIO_NAME(FIO_REGION_NAME, current)(), (ptr))
+#define FIO_MEM_REALLOC_IS_SAFE_ 0
+
+#endif /* FIO_MALLOC_TMP_USE_SYSTEM */
+
+#undef FIO_REGION_PAGE_SIZE
+#undef FIO_REGION_ALIGN_LOG
+#endif /* FIO_REGION_NAME */
@@ -0,0 +1,500 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_POOL_NAME pool     /* Development inclusion - ignore line */
+#define FIO_POOL_TYPE size_t   /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                        Fixed Size Object Pool
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if !defined(H___FIO_POOL_CORE___H) &&                                         \
+    (defined(FIO_POOL_NAME) || defined(FIO_REF_POOL) ||                        \
+     (FIO_USE_POOL && (defined(FIO_QUEUE) || defined(FIO_STREAM))))
+#define H___FIO_POOL_CORE___H
+#if FIO_OS_POSIX
+#include <pthread.h>
+#endif
+
+/* *****************************************************************************
+Pool Settings
+***************************************************************************** */
+
+#ifndef FIO_POOL_DEPOT
+/**
+ * The number of slots in each pool's global (shared) free list, MUST be a power
+ * of 2.
+ *
+ * Each slot holds a chain of free objects (at least a magazine's worth).
+ */
+#define FIO_POOL_DEPOT 32
+#elif (FIO_POOL_DEPOT & (FIO_POOL_DEPOT - 1)) || FIO_POOL_DEPOT < 1
+#undef FIO_POOL_DEPOT
+#define FIO_POOL_DEPOT 32
+#endif
+
+/* *****************************************************************************
+Pool Core - types
+
+Objects are carved from page sized slabs. Each thread caches free objects in a
+private magazine (a singly linked list), so most allocations and frees are a
+pointer swap.
+
+Magazines exchange whole chains of objects with a global "depot" - an array of
+slots, each holding a single chain. A chain is placed in an empty slot using
+CAS (`NULL` => chain) and taken using an atomic exchange (chain => `NULL`),
+which makes the depot lock-free without suffering from the ABA problem.
+***************************************************************************** */
+
+typedef struct fio___pool_node_s fio___pool_node_s;
+/* a free object - the first object in a chain stores the chain's tail / size */
+struct fio___pool_node_s {
+  fio___pool_node_s *next;
+  fio___pool_node_s *tail;
+  size_t count;
+};
+
+typedef struct fio___pool_slab_s fio___pool_slab_s;
+/* a slab (system allocation), objects follow the (aligned) header */
+struct fio___pool_slab_s {
+  fio___pool_slab_s *next;
+};
+
+typedef struct fio___pool_s {
+  /* global free list: chains of free objects (see above) */
+  fio___pool_node_s *volatile depot[FIO_POOL_DEPOT];
+  /* all the slabs allocated by the pool (returned to the system on exit) */
+  fio___pool_slab_s *volatile slabs;
+  /* the number of objects carved from the slabs */
+  volatile size_t objects;
+  /* object (slot) size, slab size and magazine length */
+  size_t size;
+  size_t slab;
+  size_t mag;
+  /* slab allocation and pool cleanup are routed to the defining module */
+  void *(*slab_alloc)(size_t size);
+  void (*slab_free)(void *slab, size_t size);
+  void (*at_exit)(void *ignr_);
+  fio_lock_i lock;
+  volatile uint8_t ready;
+  volatile uint8_t registered;
+#if FIO_OS_POSIX
+  /* the key's destructor returns a thread's magazine when the thread exits */
+  pthread_key_t key;
+#endif
+} fio___pool_s;
+
+/* a thread's magazine (a private list of free objects) */
+typedef struct fio___pool_mag_s {
+  fio___pool_node_s *head;
+  size_t count;
+  size_t hint;
+  fio___pool_s *pool; /* set once the thread is known to the pool */
+} fio___pool_mag_s;
+
+/* slab header size, rounded up to 16 bytes (the objects' alignment) */
+#define FIO___POOL_SLAB_HEADER                                                 \
+  ((sizeof(fio___pool_slab_s) + 15) & (~(size_t)15))
+/* object size, rounded up to 16 bytes and able to hold a chain's head */
+#define FIO___POOL_OBJ_SIZE(size)                                              \
+  ((((size) > sizeof(fio___pool_node_s) ? (size)                               \
+                                        : sizeof(fio___pool_node_s)) +         \
+    15) &                                                                      \
+   (~(size_t)15))
+/* slab size, whole pages holding at least two magazines */
+#define FIO___POOL_SLAB_SIZE(obj_size, mag)                                    \
+  ((FIO___POOL_SLAB_HEADER + ((obj_size) * ((mag) << 1)) +                     \
+    ((1UL << FIO_MEM_PAGE_SIZE_LOG) - 1)) &                                    \
+   (~((1UL << FIO_MEM_PAGE_SIZE_LOG) - 1)))
+
+/* pool initializer */
+#define FIO___POOL_INIT(obj_size, mag_, alloc_fn, free_fn, exit_fn)            \
+  {                                                                            \
+    .depot = {0}, .slabs = NULL, .objects = 0,                                 \
+    .size = FIO___POOL_OBJ_SIZE(obj_size),                                     \
+    .slab = FIO___POOL_SLAB_SIZE(FIO___POOL_OBJ_SIZE(obj_size), (mag_)),       \
+    .mag = (mag_), .slab_alloc = alloc_fn, .slab_free = free_fn,               \
+    .at_exit = exit_fn                                                         \
+  }
+
+/**
+ * Defines a static pool named `name` for objects of `obj_size` bytes, with a
+ * per-thread magazine of `mag` objects (`FIO_NAME(name, __mag)`).
+ *
+ * Slabs are allocated using the `FIO_MEM_REALLOC_` of the defining module and
+ * the pool's memory is returned to the system on exit (if all objects were
+ * returned to the pool).
+ */
+#define FIO___POOL_DEF(name, obj_size, mag_)                                   \
+  FIO_SFUNC void *FIO_NAME(name, __slab_alloc)(size_t size) {                  \
+    return FIO_MEM_REALLOC_(NULL, 0, size, 0);                                 \
+  }                                                                            \
+  FIO_SFUNC void FIO_NAME(name, __slab_free)(void *slab, size_t size) {        \
+    FIO_MEM_FREE_(slab, size);                                                 \
+    (void)size;                                                                \
+  }                                                                            \
+  FIO_SFUNC void FIO_NAME(name, __at_exit)(void *ignr_);                       \
+  static fio___pool_s name = FIO___POOL_INIT(obj_size,                         \
+                                             mag_,                             \
+                                             FIO_NAME(name, __slab_alloc),     \
+                                             FIO_NAME(name, __slab_free),      \
+                                             FIO_NAME(name, __at_exit));       \
+  static __thread fio___pool_mag_s FIO_NAME(name, __mag);                      \
+  FIO_SFUNC void FIO_NAME(name, __at_exit)(void *ignr_) {                      \
+    if (fio___pool_destroy(&name, &FIO_NAME(name, __mag)))                     \
+      FIO_LOG_DEBUG2("object pool " FIO_MACRO2STR(                             \
+          name) " retained (objects still in use at exit).");                  \
+    (void)ignr_;                                                               \
+  }
+
+/* *****************************************************************************
+Pool Core - API (used by the pool template and other modules)
+***************************************************************************** */
+
+/* allocates an object (slow path: refills the magazine). */
+FIO_SFUNC void *fio___pool_alloc_slow(fio___pool_s *p, fio___pool_mag_s *m);
+
+/* moves all but `keep` objects from the magazine to the depot. */
+FIO_SFUNC void fio___pool_flush(fio___pool_s *p,
+                                fio___pool_mag_s *m,
+                                size_t keep);
+
+/* registers the thread's magazine with the pool (for thread exit). */
+FIO_SFUNC void fio___pool_register(fio___pool_s *p, fio___pool_mag_s *m);
+
+/* allocates slabs so that (at least) `count` objects were carved. */
+FIO_SFUNC size_t fio___pool_warmup(fio___pool_s *p, size_t count);
+
+/* returns the pool's memory to the system if all objects were returned. */
+FIO_SFUNC int fio___pool_destroy(fio___pool_s *p, fio___pool_mag_s *m);
+
+/* allocates an object (memory isn't initialized). */
+FIO_IFUNC void *fio___pool_alloc(fio___pool_s *p, fio___pool_mag_s *m) {
+  fio___pool_node_s *n = m->head;
+  if (FIO_UNLIKELY(!n))
+    return fio___pool_alloc_slow(p, m);
+  m->head = n->next;
+  --m->count;
+  return (void *)n;
+}
+
+/* returns an object to the pool. */
+FIO_IFUNC void fio___pool_free(fio___pool_s *p, fio___pool_mag_s *m, void *o) {
+  fio___pool_node_s *n = (fio___pool_node_s *)o;
+  if (!n)
+    return;
+  if (FIO_UNLIKELY(!m->pool))
+    fio___pool_register(p, m);
+  n->next = m->head;
+  m->head = n;
+  if (FIO_UNLIKELY(++m->count >= (p->mag << 1)))
+    fio___pool_flush(p, m, p->mag);
+}
+
+/* *****************************************************************************
+Pool Core - Implementation
+***************************************************************************** */
+
+/* places a chain in the depot, merging chains if the depot is full. */
+FIO_SFUNC void fio___pool_depot_put(fio___pool_s *p,
+                                    fio___pool_node_s *chain,
+                                    size_t hint) {
+  for (;;) {
+    for (size_t i = 0; i < FIO_POOL_DEPOT; ++i) {
+      fio___pool_node_s **slot = (fio___pool_node_s **)(p->depot +
+                                                        ((hint + i) &
+                                                         (FIO_POOL_DEPOT - 1)));
+      fio___pool_node_s *expected = NULL;
+      if (!*slot && fio_atomic_compare_exchange_p(slot, &expected, &chain))
+        return;
+    }
+    /* depot is full, take a chain and append it to ours */
+    fio___pool_node_s *other = fio_atomic_exchange(
+        (fio___pool_node_s **)(p->depot + (hint & (FIO_POOL_DEPOT - 1))),
+        (fio___pool_node_s *)NULL);
+    if (!other)
+      continue;
+    chain->tail->next = other;
+    chain->tail = other->tail;
+    chain->count += other->count;
+  }
+}
+
+/* takes a chain from the depot (or returns NULL). */
+FIO_SFUNC fio___pool_node_s *fio___pool_depot_take(fio___pool_s *p,
+                                                   size_t hint) {
+  for (size_t i = 0; i < FIO_POOL_DEPOT; ++i) {
+    fio___pool_node_s **slot = (fio___pool_node_s **)(p->depot +
+                                                      ((hint + i) &
+                                                       (FIO_POOL_DEPOT - 1)));
+    fio___pool_node_s *c;
+    if (*slot && (c = fio_atomic_exchange(slot, (fio___pool_node_s *)NULL)))
+      return c;
+  }
+  return NULL;
+}
+
+/* allocates a slab and returns its objects as a chain (or NULL). */
+FIO_SFUNC fio___pool_node_s *fio___pool_slab_new(fio___pool_s *p) {
+  fio___pool_slab_s *s = (fio___pool_slab_s *)p->slab_alloc(p->slab);
+  if (!s)
+    return NULL;
+  const size_t count = (p->slab - FIO___POOL_SLAB_HEADER) / p->size;
+  char *pos = (char *)s + FIO___POOL_SLAB_HEADER;
+  fio___pool_node_s *head = (fio___pool_node_s *)pos;
+  for (size_t i = 1; i < count; ++i) {
+    ((fio___pool_node_s *)pos)->next = (fio___pool_node_s *)(pos + p->size);
+    pos += p->size;
+  }
+  ((fio___pool_node_s *)pos)->next = NULL;
+  head->tail = (fio___pool_node_s *)pos;
+  head->count = count;
+  /* push the slab to the slab list (push only, no ABA concerns) */
+  s->next = p->slabs;
+  while (!fio_atomic_compare_exchange_p((fio___pool_slab_s **)&p->slabs,
+                                        &s->next,
+                                        &s))
+    ;
+  fio_atomic_add(&p->objects, count);
+  /* registered after the first slab, so cleanup runs before the allocator's */
+  if (!p->registered && !fio_atomic_exchange(&p->registered, 1))
+    fio_state_callback_add(FIO_CALL_AT_EXIT, p->at_exit, NULL);
+  return head;
+}
+
+/* registers the thread's magazine with the pool (for thread exit). */
+FIO_SFUNC void fio___pool_on_thread_exit(void *m_) {
+  fio___pool_mag_s *m = (fio___pool_mag_s *)m_;
+  if (m && m->pool)
+    fio___pool_flush(m->pool, m, 0);
+}
+
+FIO_SFUNC void fio___pool_register(fio___pool_s *p, fio___pool_mag_s *m) {
+  m->pool = p;
+  m->hint = (size_t)(((uintptr_t)m >> 6) ^ ((uintptr_t)m >> 12));
+#if FIO_OS_POSIX
+  if (!p->ready) {
+    fio_lock(&p->lock);
+    if (!p->ready)
+      p->ready = !pthread_key_create(&p->key, fio___pool_on_thread_exit);
+    fio_unlock(&p->lock);
+  }
+  if (p->ready)
+    pthread_setspecific(p->key, (void *)m);
+#endif
+}
+
+/* allocates an object (slow path: refills the magazine). */
+FIO_SFUNC void *fio___pool_alloc_slow(fio___pool_s *p, fio___pool_mag_s *m) {
+  fio___pool_node_s *c;
+  if (!m->pool)
+    fio___pool_register(p, m);
+  c = fio___pool_depot_take(p, m->hint);
+  if (!c && !(c = fio___pool_slab_new(p))) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  if (c->count > p->mag) { /* keep a magazine's worth, return the rest */
+    fio___pool_node_s *last = c;
+    for (size_t i = 1; i < p->mag; ++i)
+      last = last->next;
+    fio___pool_node_s *rest = last->next;
+    rest->tail = c->tail;
+    rest->count = c->count - p->mag;
+    last->next = NULL;
+    c->count = p->mag;
+    fio___pool_depot_put(p, rest, m->hint + 1);
+  }
+  m->head = c->next;
+  m->count = c->count - 1;
+  return (void *)c;
+}
+
+/* moves all but `keep` objects from the magazine to the depot. */
+FIO_SFUNC void fio___pool_flush(fio___pool_s *p,
+                                fio___pool_mag_s *m,
+                                size_t keep) {
+  fio___pool_node_s *c, **pos = &m->head;
+  if (m->count <= keep)
+    return;
+  /* the most recently freed (cache hot) objects stay in the magazine */
+  for (size_t i = 0; i < keep; ++i)
+    pos = &(*pos)->next;
+  c = *pos;
+  *pos = NULL;
+  c->count = m->count - keep;
+  c->tail = c;
+  while (c->tail->next)
+    c->tail = c->tail->next;
+  m->count = keep;
+  fio___pool_depot_put(p, c, m->hint);
+}
+
+/* allocates slabs so that (at least) `count` objects were carved. */
+FIO_SFUNC size_t fio___pool_warmup(fio___pool_s *p, size_t count) {
+  while (p->objects < count) {
+    fio___pool_node_s *c = fio___pool_slab_new(p);
+    if (!c)
+      break;
+    fio___pool_depot_put(p, c, (size_t)p->objects);
+  }
+  return p->objects;
+}
+
+/* returns the pool's memory to the system if all objects were returned. */
+FIO_SFUNC int fio___pool_destroy(fio___pool_s *p, fio___pool_mag_s *m) {
+  fio___pool_node_s *chains[FIO_POOL_DEPOT];
+  size_t count = 0;
+  if (m && m->pool == p)
+    count = m->count;
+  for (size_t i = 0; i < FIO_POOL_DEPOT; ++i) {
+    chains[i] = fio_atomic_exchange((fio___pool_node_s **)(p->depot + i),
+                                    (fio___pool_node_s *)NULL);
+    if (chains[i])
+      count += chains[i]->count;
+  }
+  if (count != p->objects) { /* objects are still in use, retain memory */
+    for (size_t i = 0; i < FIO_POOL_DEPOT; ++i)
+      if (chains[i])
+        fio___pool_depot_put(p, chains[i], i);
+    return -1;
+  }
+  fio___pool_slab_s *s =
+      fio_atomic_exchange((fio___pool_slab_s **)&p->slabs,
+                          (fio___pool_slab_s *)NULL);
+  while (s) {
+    fio___pool_slab_s *tmp = s;
+    s = s->next;
+    p->slab_free((void *)tmp, p->slab);
+  }
+  p->objects = 0;
+  if (m && m->pool == p) {
+    m->head = NULL;
+    m->count = 0;
+  }
+  return 0;
+}
+
+#endif /* H___FIO_POOL_CORE___H */
+
+/* *****************************************************************************
+
+
+
+
+                        Fixed Size Object Pool Template
+
+
+
+
+***************************************************************************** */
+#if defined(FIO_POOL_NAME)
+
+#ifndef FIO_POOL_TYPE
+#error FIO_POOL_TYPE must be defined when defining an object pool.
+#endif
+
+#ifndef FIO_POOL_MAGAZINE
+/** The number of objects exchanged between a thread and the global list. */
+#define FIO_POOL_MAGAZINE 32
+#elif FIO_POOL_MAGAZINE < 1
+#undef FIO_POOL_MAGAZINE
+#define FIO_POOL_MAGAZINE 32
+#endif
+
+#ifndef FIO_POOL_WARMUP
+/** The number of objects to allocate when the program starts (pre-warming). */
+#define FIO_POOL_WARMUP 0
+#endif
+
+/* *****************************************************************************
+Pool API
+***************************************************************************** */
+
+/**
+ * Allocates an object from the pool.
+ *
+ * Memory isn't initialized (it may contain junk data from a previous object).
+ *
+ * Returns NULL on error (`errno` is set to ENOMEM).
+ */
+SFUNC FIO_POOL_TYPE *FIO_NAME(FIO_POOL_NAME, alloc)(void);
+
+/** Returns an object to the pool. */
+SFUNC void FIO_NAME(FIO_POOL_NAME, free)(FIO_POOL_TYPE *obj);
+
+/**
+ * Allocates slabs until at least `count` objects were carved (pre-warming).
+ *
+ * Returns the number of objects carved from the pool's slabs.
+ */
+SFUNC size_t FIO_NAME(FIO_POOL_NAME, warmup)(size_t count);
+
+/**
+ * Returns the pool's memory to the system if all the objects were returned to
+ * the pool (and other threads exited or aren't holding any free objects).
+ *
+ * Returns 0 on success or -1 if the memory was retained.
+ *
+ * This is performed automatically on exit.
+ */
+SFUNC int FIO_NAME(FIO_POOL_NAME, destroy)(void);
+
+/* *****************************************************************************
+Pool Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+FIO___POOL_DEF(FIO_NAME(FIO_POOL_NAME, __pool),
+               sizeof(FIO_POOL_TYPE),
+               FIO_POOL_MAGAZINE)
+
+/** Allocates an object from the pool. */
+SFUNC FIO_POOL_TYPE *FIO_NAME(FIO_POOL_NAME, alloc)(void) {
+  return (FIO_POOL_TYPE *)fio___pool_alloc(
+      &FIO_NAME(FIO_POOL_NAME, __pool),
+      &FIO_NAME(FIO_NAME(FIO_POOL_NAME, __pool), __mag));
+}
+
+/** Returns an object to the pool. */
+SFUNC void FIO_NAME(FIO_POOL_NAME, free)(FIO_POOL_TYPE *obj) {
+  fio___pool_free(&FIO_NAME(FIO_POOL_NAME, __pool),
+                  &FIO_NAME(FIO_NAME(FIO_POOL_NAME, __pool), __mag),
+                  (void *)obj);
+}
+
+/** Allocates slabs until at least `count` objects were carved. */
+SFUNC size_t FIO_NAME(FIO_POOL_NAME, warmup)(size_t count) {
+  return fio___pool_warmup(&FIO_NAME(FIO_POOL_NAME, __pool), count);
+}
+
+/** Returns the pool's memory to the system if all objects were returned. */
+SFUNC int FIO_NAME(FIO_POOL_NAME, destroy)(void) {
+  return fio___pool_destroy(&FIO_NAME(FIO_POOL_NAME, __pool),
+                            &FIO_NAME(FIO_NAME(FIO_POOL_NAME, __pool), __mag));
+}
+
+#if FIO_POOL_WARMUP
+/* pre-warms the pool when the program starts */
+FIO_CONSTRUCTOR(FIO_NAME(FIO_POOL_NAME, __pool_warmup)) {
+  FIO_NAME(FIO_POOL_NAME, warmup)(FIO_POOL_WARMUP);
+}
+#endif /* FIO_POOL_WARMUP */
+
+/* *****************************************************************************
+Module Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO_POOL_NAME
+#undef FIO_POOL_TYPE
+#undef FIO_POOL_MAGAZINE
+#undef FIO_POOL_WARMUP
+#endif /* FIO_POOL_NAME */
@@ -33,6 +33,11 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #endif
 #endif
 
+#ifndef FIO_POLL_URING_ENTRIES
+/** relevant only for io_uring - the submission queue's size (power of 2) */
+#define FIO_POLL_URING_ENTRIES 256
+#endif
+
 /* *****************************************************************************
 Possible polling engine (system call) selection
 ***************************************************************************** */
@@ -49,6 +54,14 @@ Possible polling engine (system call) selection
 /** define `FIO_POLL_ENGINE` as `FIO_POLL_ENGINE_KQUEUE` to use `kqueue` */
 #define FIO_POLL_ENGINE_KQUEUE 3
 #endif
+#ifndef FIO_POLL_ENGINE_EPOLL_ET
+/** define `FIO_POLL_ENGINE` as `FIO_POLL_ENGINE_EPOLL_ET` for edge triggering */
+#define FIO_POLL_ENGINE_EPOLL_ET 4
+#endif
+#ifndef FIO_POLL_ENGINE_IO_URING
+/** define `FIO_POLL_ENGINE` as `FIO_POLL_ENGINE_IO_URING` to use `io_uring` */
+#define FIO_POLL_ENGINE_IO_URING 5
+#endif
 
 /* if `FIO_POLL_ENGINE` wasn't define, detect automatically. */
 #if !defined(FIO_POLL_ENGINE)
@@ -73,6 +86,14 @@ Possible polling engine (system call) selection
 #ifndef FIO_POLL_ENGINE_STR
 #define FIO_POLL_ENGINE_STR "kqueue"
 #endif
+#elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_EPOLL_ET
+#ifndef FIO_POLL_ENGINE_STR
+#define FIO_POLL_ENGINE_STR "epoll-et"
+#endif
+#elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+#ifndef FIO_POLL_ENGINE_STR
+#define FIO_POLL_ENGINE_STR "io_uring"
+#endif
 #endif
 /* *****************************************************************************
 Polling API
@@ -99,7 +120,11 @@ FIO_IFUNC void fio_poll_init(fio_poll_s *p, fio_poll_settings_s);
 /** Destroys the polling object, freeing its resources. */
 FIO_IFUNC void fio_poll_destroy(fio_poll_s *p);
 
-/** returns the system call used for polling as a constant string. */
+/**
+ * Returns the system call used for polling as a constant string.
+ *
+ * The `io_uring` engine reports `"epoll-et"` when it falls back to `epoll`.
+ */
 FIO_IFUNC const char *fio_poll_engine(void);
 
 /**
@@ -136,12 +161,47 @@ SFUNC int fio_poll_review(fio_poll_s *p, size_t timeout);
 /** Stops monitoring the specified file descriptor (if monitoring). */
 SFUNC int fio_poll_forget(fio_poll_s *p, int fd);
 
+/**
+ * Hints that an IO operation on `fd` would block (i.e., `read` returned
+ * `EAGAIN` or less data than requested), so the `flags` events (`POLLIN` /
+ * `POLLOUT`) are no longer ready.
+ *
+ * Edge triggered engines use the hint to avoid testing if an event that was
+ * already reported is still ready. Other engines ignore it.
+ */
+FIO_IFUNC void fio_poll_would_block(fio_poll_s *p,
+                                    int fd,
+                                    unsigned short flags);
+
+/**
+ * Accepts a new connection from the (monitored) listening socket `fd`, same as
+ * calling `accept(fd, NULL, NULL)`.
+ *
+ * The `io_uring` engine accepts connections in the kernel (multishot accept)
+ * and returns a connection that was already accepted, if any.
+ *
+ * Returns -1 on error (`errno == EAGAIN` when no connections are waiting).
+ */
+SFUNC int fio_poll_accept(fio_poll_s *p, int fd);
+
 /* *****************************************************************************
 Implementation Helpers
 ***************************************************************************** */
 
+#if FIO_POLL_ENGINE != FIO_POLL_ENGINE_IO_URING
 /** returns the system call used for polling as a constant string. */
 FIO_IFUNC const char *fio_poll_engine(void) { return FIO_POLL_ENGINE_STR; }
+#endif
+
+#if FIO_POLL_ENGINE != FIO_POLL_ENGINE_EPOLL_ET &&                             \
+    FIO_POLL_ENGINE != FIO_POLL_ENGINE_IO_URING
+/* one-shot engines review the state of every monitored event. */
+FIO_IFUNC void fio_poll_would_block(fio_poll_s *p,
+                                    int fd,
+                                    unsigned short flags) {
+  (void)p, (void)fd, (void)flags;
+}
+#endif
 
 /* validate settings */
 #define FIO_POLL_VALIDATE(settings_dest)                                       \
@@ -157,6 +217,14 @@ SFUNC void fio___poll_ev_mock(void *udata);
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 /* mock event */
 SFUNC void fio___poll_ev_mock(void *udata) { (void)udata; }
+
+#if FIO_POLL_ENGINE != FIO_POLL_ENGINE_IO_URING
+/** Accepts a new connection from the listening socket `fd`. */
+SFUNC int fio_poll_accept(fio_poll_s *p, int fd) {
+  (void)p;
+  return (int)accept(fd, NULL, NULL);
+}
+#endif
 #endif /* defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN) */
 /* *****************************************************************************
 Cleanup
@@ -0,0 +1,822 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE)                   /* Dev test - ignore line */
+#define FIO_POLL_ENGINE FIO_POLL_ENGINE_IO_URING /* Dev */
+#define FIO___DEV___    /* Development inclusion - ignore line */
+#define FIO_POLL        /* Development inclusion - ignore line */
+#include "./include.h"  /* Development inclusion - ignore line */
+#endif                  /* Development inclusion - ignore line */
+/* ************************************************************************* */
+#if defined(FIO_POLL) &&                                                       \
+    (defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)) &&                  \
+    (FIO_POLL_ENGINE == FIO_POLL_ENGINE_EPOLL_ET ||                            \
+     FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING) &&                           \
+    !defined(H___FIO_POLL_EGN___H) && !defined(H___FIO_POLL___H) &&            \
+    !defined(FIO___RECURSIVE_INCLUDE)
+#define H___FIO_POLL_EGN___H
+/* *****************************************************************************
+
+
+
+
+        POSIX Portable Polling with edge triggered `epoll` / `io_uring`
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#include <sys/epoll.h>
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef POLLRDHUP
+#define FIO___POLL_EDGE_RDHUP POLLRDHUP
+#else
+#define FIO___POLL_EDGE_RDHUP 0
+#endif
+
+/* *****************************************************************************
+Polling API
+
+File descriptors are registered once (for both reading and writing) and the
+one-shot monitoring state is kept in user space:
+
+* `armed` - events the user is waiting for (removed once fired).
+* `ready` - events reported by the kernel that weren't fired yet.
+* `stale` - fired events that may still be ready (the kernel won't report them).
+
+Armed stale events are tested using a single `poll` call per review, unless the
+user hinted that they would block (see `fio_poll_would_block`).
+
+The kernel reports events using `EPOLLET` or, for the `io_uring` engine, using
+a multishot poll request per file descriptor. The `io_uring` engine falls back
+to `EPOLLET` if the kernel doesn't support `io_uring` (or multishot accept).
+***************************************************************************** */
+
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+/* internal use - a submission and completion queue pair (an `io_uring`) */
+typedef struct {
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_flags;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned sq_mask;
+  unsigned cq_mask;
+  unsigned sq_entries;
+  /** SQEs that were queued but weren't submitted yet. */
+  unsigned queued;
+  void *rings;
+  size_t rings_len;
+  size_t sqes_len;
+  int fd;
+} fio___poll_uring_s;
+
+/* multishot accept states */
+#define FIO___POLL_URING_ACCEPT_NONE    0
+#define FIO___POLL_URING_ACCEPT_ARMED   1
+#define FIO___POLL_URING_ACCEPT_ACTIVE  2
+#define FIO___POLL_URING_ACCEPT_FAILED  3
+#endif
+
+/* internal use - a file descriptor's monitoring state */
+typedef struct {
+  void *udata;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  /** connections accepted by the kernel (listening sockets only). */
+  int *accepted;
+  uint32_t accepted_count;
+  uint32_t accepted_capa;
+  /** invalidates completions of requests made before `fio_poll_forget`. */
+  uint16_t gen;
+  unsigned char accepting;
+#endif
+  unsigned short armed;
+  unsigned short ready;
+  unsigned short stale;
+  unsigned char registered;
+  unsigned char pending;
+} fio___poll_edge_fd_s;
+
+/** the `fio_poll_s` type should be considered opaque. */
+struct fio_poll_s {
+  fio_poll_settings_s settings;
+  /** monitoring state, indexed by file descriptor. */
+  fio___poll_edge_fd_s *fds;
+  /** file descriptors with armed events that are (or may be) ready. */
+  int *pending;
+  size_t capa;
+  size_t pending_count;
+  size_t pending_capa;
+  FIO___LOCK_TYPE lock;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  fio___poll_uring_s ring;
+#endif
+  /** the `epoll` file descriptor (-1 when using `io_uring`). */
+  int fd;
+};
+
+/* *****************************************************************************
+`io_uring` queues (Linux 5.19 or later)
+***************************************************************************** */
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+
+/* request `user_data`: fd (32 bits) | generation (16 bits) | kind (16 bits) */
+#define FIO___POLL_URING_POLL   1
+#define FIO___POLL_URING_ACCEPT 2
+#define FIO___POLL_URING_CANCEL 3
+#define FIO___POLL_URING_ID(fd, gen, kind)                                     \
+  ((uint64_t)(uint32_t)(fd) | ((uint64_t)(uint16_t)(gen) << 32) |              \
+   ((uint64_t)(kind) << 48))
+
+/* `io_uring` support: 0 - untested, 1 - supported, -1 - falls back to epoll */
+static volatile int fio___poll_uring_support;
+
+FIO_IFUNC int fio___poll_uring_enter(int fd,
+                                     unsigned submit,
+                                     unsigned wait,
+                                     unsigned flags,
+                                     void *arg,
+                                     size_t arg_len) {
+  return (int)
+      syscall(__NR_io_uring_enter, fd, submit, wait, flags, arg, arg_len);
+}
+
+/* multishot accept was added together with IORING_OP_SOCKET (Linux 5.19). */
+FIO_SFUNC int fio___poll_uring_probe(int fd) {
+  uint64_t buf[(sizeof(struct io_uring_probe) +
+                (sizeof(struct io_uring_probe_op) * 256)) /
+               sizeof(uint64_t)];
+  struct io_uring_probe *probe = (struct io_uring_probe *)buf;
+  FIO_MEMSET(buf, 0, sizeof(buf));
+  if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256))
+    return -1;
+  if (probe->last_op < IORING_OP_SOCKET ||
+      !(probe->ops[IORING_OP_SOCKET].flags & IO_URING_OP_SUPPORTED))
+    return -1;
+  return 0;
+}
+
+FIO_SFUNC void fio___poll_uring_destroy(fio___poll_uring_s *r) {
+  if (r->sqes)
+    munmap(r->sqes, r->sqes_len);
+  if (r->rings)
+    munmap(r->rings, r->rings_len);
+  if (r->fd != -1)
+    close(r->fd);
+  *r = (fio___poll_uring_s){.fd = -1};
+}
+
+/* sets up the queues, returns -1 (marking `io_uring` as unsupported) on error */
+FIO_SFUNC int fio___poll_uring_init(fio___poll_uring_s *r) {
+  struct io_uring_params params;
+  const uint32_t required =
+      (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG);
+  char *rings;
+  *r = (fio___poll_uring_s){.fd = -1};
+  if (fio___poll_uring_support < 0)
+    return -1;
+  FIO_MEMSET(&params, 0, sizeof(params));
+  r->fd = (int)syscall(__NR_io_uring_setup, FIO_POLL_URING_ENTRIES, &params);
+  if (r->fd == -1 || (params.features & required) != required ||
+      fio___poll_uring_probe(r->fd))
+    goto unsupported;
+  r->rings_len = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+  if (r->rings_len <
+      params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe)))
+    r->rings_len =
+        params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+  r->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+  r->rings = mmap(NULL,
+                  r->rings_len,
+                  PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE,
+                  r->fd,
+                  IORING_OFF_SQ_RING);
+  if (r->rings == MAP_FAILED) {
+    r->rings = NULL;
+    goto unsupported;
+  }
+  r->sqes = (struct io_uring_sqe *)mmap(NULL,
+                                        r->sqes_len,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE,
+                                        r->fd,
+                                        IORING_OFF_SQES);
+  if ((void *)r->sqes == MAP_FAILED) {
+    r->sqes = NULL;
+    goto unsupported;
+  }
+  rings = (char *)r->rings;
+  r->sq_head = (unsigned *)(rings + params.sq_off.head);
+  r->sq_tail = (unsigned *)(rings + params.sq_off.tail);
+  r->sq_flags = (unsigned *)(rings + params.sq_off.flags);
+  r->sq_mask = *(unsigned *)(rings + params.sq_off.ring_mask);
+  r->cq_head = (unsigned *)(rings + params.cq_off.head);
+  r->cq_tail = (unsigned *)(rings + params.cq_off.tail);
+  r->cq_mask = *(unsigned *)(rings + params.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe *)(rings + params.cq_off.cqes);
+  r->sq_entries = params.sq_entries;
+  for (unsigned i = 0; i < params.sq_entries; ++i) /* SQE index == slot */
+    ((unsigned *)(rings + params.sq_off.array))[i] = i;
+  fio___poll_uring_support = 1;
+  return 0;
+unsupported:
+  FIO_LOG_DEBUG2("io_uring unavailable, polling with edge triggered epoll");
+  fio___poll_uring_destroy(r);
+  fio___poll_uring_support = -1;
+  return -1;
+}
+
+/* submits queued SQEs without waiting, returns the number submitted. */
+FIO_SFUNC int fio___poll_uring_submit(fio___poll_uring_s *r) {
+  int ret;
+  if (!r->queued)
+    return 0;
+  ret = fio___poll_uring_enter(r->fd, r->queued, 0, 0, NULL, 0);
+  if (ret > 0)
+    r->queued -= ((unsigned)ret > r->queued) ? r->queued : (unsigned)ret;
+  return ret;
+}
+
+/* returns a zeroed SQE, published by `fio___poll_uring_push`, or NULL. */
+FIO_SFUNC struct io_uring_sqe *fio___poll_uring_sqe(fio___poll_uring_s *r) {
+  unsigned head;
+  const unsigned tail = *r->sq_tail; /* only written by us */
+  fio_atomic_load(head, r->sq_head);
+  if (tail - head >= r->sq_entries) { /* full, submit before queueing more */
+    fio___poll_uring_submit(r);
+    fio_atomic_load(head, r->sq_head);
+    if (tail - head >= r->sq_entries)
+      return NULL;
+  }
+  struct io_uring_sqe *sqe = r->sqes + (tail & r->sq_mask);
+  FIO_MEMSET(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+/* publishes the SQE returned by `fio___poll_uring_sqe`. */
+FIO_IFUNC void fio___poll_uring_push(fio___poll_uring_s *r) {
+  fio_atomic_exchange(r->sq_tail, (*r->sq_tail + 1));
+  ++r->queued;
+}
+
+/* queues a multishot poll request for all the events we care about. */
+FIO_SFUNC int fio___poll_uring_poll(fio___poll_uring_s *r, int fd, uint16_t g) {
+  uint32_t events = (POLLIN | POLLOUT | FIO___POLL_EDGE_RDHUP);
+  struct io_uring_sqe *sqe = fio___poll_uring_sqe(r);
+  if (!sqe)
+    return -1;
+#if __BIG_ENDIAN__
+  events = (events << 16) | (events >> 16);
+#endif
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->user_data = FIO___POLL_URING_ID(fd, g, FIO___POLL_URING_POLL);
+  fio___poll_uring_push(r);
+  return 0;
+}
+
+/* queues a multishot accept request for a listening socket. */
+FIO_SFUNC int fio___poll_uring_accept(fio___poll_uring_s *r,
+                                      int fd,
+                                      uint16_t g) {
+  struct io_uring_sqe *sqe = fio___poll_uring_sqe(r);
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->user_data = FIO___POLL_URING_ID(fd, g, FIO___POLL_URING_ACCEPT);
+  fio___poll_uring_push(r);
+  return 0;
+}
+
+/* queues a cancellation (by `user_data`, the fd might have been closed). */
+FIO_SFUNC int fio___poll_uring_cancel(fio___poll_uring_s *r, uint64_t id) {
+  struct io_uring_sqe *sqe = fio___poll_uring_sqe(r);
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = id;
+  sqe->user_data = FIO___POLL_URING_ID(0, 0, FIO___POLL_URING_CANCEL);
+  fio___poll_uring_push(r);
+  return 0;
+}
+
+/* closes the connections that were accepted for `e` but never collected. */
+FIO_SFUNC void fio___poll_uring_accepted_clear(fio___poll_edge_fd_s *e) {
+  for (uint32_t i = 0; i < e->accepted_count; ++i)
+    close(e->accepted[i]);
+  FIO_MEM_FREE_(e->accepted, sizeof(*e->accepted) * e->accepted_capa);
+  e->accepted = NULL;
+  e->accepted_count = e->accepted_capa = 0;
+}
+
+FIO_SFUNC int fio___poll_uring_accepted_push(fio___poll_edge_fd_s *e, int fd) {
+  if (e->accepted_count == e->accepted_capa) {
+    const uint32_t capa = e->accepted_capa ? (e->accepted_capa << 1) : 16;
+    int *tmp =
+        (int *)FIO_MEM_REALLOC_(e->accepted,
+                                sizeof(*e->accepted) * e->accepted_capa,
+                                sizeof(*e->accepted) * capa,
+                                sizeof(*e->accepted) * e->accepted_count);
+    if (!tmp)
+      return -1;
+    e->accepted = tmp;
+    e->accepted_capa = capa;
+  }
+  e->accepted[e->accepted_count++] = fd;
+  return 0;
+}
+
+/* returns the engine's name, testing for `io_uring` support if required. */
+FIO_IFUNC const char *fio_poll_engine(void) {
+  if (!fio___poll_uring_support) {
+    fio___poll_uring_s r;
+    if (!fio___poll_uring_init(&r))
+      fio___poll_uring_destroy(&r);
+  }
+  return (fio___poll_uring_support > 0) ? FIO_POLL_ENGINE_STR : "epoll-et";
+}
+#endif /* FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING */
+
+/* *****************************************************************************
+Polling object life cycle
+***************************************************************************** */
+
+FIO_SFUNC void fio___poll_edge_after_fork(void *p_) {
+  fio_poll_s *p = (fio_poll_s *)p_;
+  fio_poll_destroy(p);
+  fio_poll_init FIO_NOOP(p, p->settings);
+}
+
+/** Initializes the polling object, allocating its resources. */
+FIO_IFUNC void fio_poll_init FIO_NOOP(fio_poll_s *p, fio_poll_settings_s args) {
+  *p = (fio_poll_s){
+      .settings = args,
+      .lock = FIO___LOCK_INIT,
+      .fd = -1,
+  };
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  if (fio___poll_uring_init(&p->ring))
+#endif
+    p->fd = epoll_create1(0);
+  FIO_POLL_VALIDATE(p->settings);
+  fio_state_callback_add(FIO_CALL_IN_CHILD, fio___poll_edge_after_fork, p);
+}
+
+/** Destroys the polling object, freeing its resources. */
+FIO_IFUNC void fio_poll_destroy(fio_poll_s *p) {
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  for (size_t i = 0; i < p->capa; ++i)
+    fio___poll_uring_accepted_clear(p->fds + i);
+  fio___poll_uring_destroy(&p->ring); /* cancels all requests */
+#endif
+  if (p->fd != -1)
+    close(p->fd);
+  p->fd = -1;
+  FIO_MEM_FREE_(p->fds, sizeof(*p->fds) * p->capa);
+  FIO_MEM_FREE_(p->pending, sizeof(*p->pending) * p->pending_capa);
+  p->fds = NULL;
+  p->pending = NULL;
+  p->capa = p->pending_count = p->pending_capa = 0;
+  FIO___LOCK_DESTROY(p->lock);
+  fio_state_callback_remove(FIO_CALL_IN_CHILD, fio___poll_edge_after_fork, p);
+}
+
+/** Hints that an IO operation on `fd` would block (the events aren't ready). */
+FIO_IFUNC void fio_poll_would_block(fio_poll_s *p,
+                                    int fd,
+                                    unsigned short flags) {
+  FIO___LOCK_LOCK(p->lock);
+  if ((size_t)fd < p->capa)
+    p->fds[fd].stale &= ~flags;
+  FIO___LOCK_UNLOCK(p->lock);
+}
+
+/* *****************************************************************************
+Poll Monitoring Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+/* grows the monitoring state table to fit `fd`. Returns -1 on error. */
+FIO_SFUNC int fio___poll_edge_reserve(fio_poll_s *p, int fd) {
+  size_t capa = p->capa ? p->capa : 64;
+  while (capa <= (size_t)fd)
+    capa <<= 1;
+  fio___poll_edge_fd_s *tmp =
+      (fio___poll_edge_fd_s *)FIO_MEM_REALLOC_(p->fds,
+                                               sizeof(*p->fds) * p->capa,
+                                               sizeof(*p->fds) * capa,
+                                               sizeof(*p->fds) * p->capa);
+  if (!tmp)
+    return -1;
+  FIO_MEMSET(tmp + p->capa, 0, sizeof(*tmp) * (capa - p->capa));
+  p->fds = tmp;
+  p->capa = capa;
+  return 0;
+}
+
+/* lists `fd` as pending if it has armed events that may be ready. */
+FIO_IFUNC int fio___poll_edge_pend(fio_poll_s *p, int fd) {
+  fio___poll_edge_fd_s *e = p->fds + fd;
+  if (e->pending || !(e->armed & (e->ready | e->stale)))
+    return 0;
+  if (p->pending_count == p->pending_capa) {
+    const size_t capa = p->pending_capa ? (p->pending_capa << 1) : 64;
+    int *tmp = (int *)FIO_MEM_REALLOC_(p->pending,
+                                       sizeof(*p->pending) * p->pending_capa,
+                                       sizeof(*p->pending) * capa,
+                                       sizeof(*p->pending) * p->pending_count);
+    if (!tmp)
+      return -1;
+    p->pending = tmp;
+    p->pending_capa = capa;
+  }
+  e->pending = 1;
+  p->pending[p->pending_count++] = fd;
+  return 0;
+}
+
+/* converts `epoll` / `poll` events, a closed connection is also readable. */
+FIO_IFUNC unsigned short fio___poll_edge_flags(uint32_t events,
+                                               uint32_t in,
+                                               uint32_t out,
+                                               uint32_t closed) {
+  unsigned short r = 0;
+  if ((events & in))
+    r |= POLLIN;
+  if ((events & out))
+    r |= POLLOUT;
+  if ((events & closed))
+    r |= (POLLIN | POLLHUP);
+  return r;
+}
+
+/* registers `fd` with the kernel (once), called while locked. */
+FIO_IFUNC int fio___poll_edge_add(fio_poll_s *p, int fd) {
+  int r;
+  struct epoll_event chevent = {
+      .events = (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET),
+      .data.fd = fd,
+  };
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  if (p->fd == -1) /* submitted by the next `fio_poll_review` */
+    return fio___poll_uring_poll(&p->ring, fd, p->fds[fd].gen);
+#endif
+  do {
+    r = epoll_ctl(p->fd, EPOLL_CTL_ADD, fd, &chevent);
+  } while (r == -1 && errno == EINTR);
+  if (r == -1 && errno == EEXIST)
+    r = 0;
+  return r;
+}
+
+/**
+ * Adds a file descriptor to be monitored, adds events to be monitored or
+ * updates the monitored file's `udata`.
+ *
+ * Possible flags are: `POLLIN` and `POLLOUT`. Other flags may be set but might
+ * be ignored.
+ *
+ * Monitoring mode is always one-shot. If an event if fired, it is removed from
+ * the monitoring state.
+ *
+ * Returns -1 on error.
+ */
+SFUNC int fio_poll_monitor(fio_poll_s *p,
+                           int fd,
+                           void *udata,
+                           unsigned short flags) {
+  int r = -1;
+  if (!p || fd < 0)
+    return r;
+  FIO___LOCK_LOCK(p->lock);
+  if ((size_t)fd >= p->capa && fio___poll_edge_reserve(p, fd))
+    goto finish;
+  p->fds[fd].udata = udata;
+  if (!p->fds[fd].registered) {
+    if (fio___poll_edge_add(p, fd))
+      goto finish;
+    p->fds[fd].registered = 1;
+  }
+  p->fds[fd].armed |= (flags & (POLLIN | POLLOUT));
+  r = fio___poll_edge_pend(p, fd);
+finish:
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+}
+
+/** Stops monitoring the specified file descriptor, returning -1 on error. */
+SFUNC int fio_poll_forget(fio_poll_s *p, int fd) {
+  int r = -1;
+  struct epoll_event chevent = {.events = (EPOLLOUT | EPOLLIN)};
+  FIO___LOCK_LOCK(p->lock);
+  if ((size_t)fd < p->capa && p->fds[fd].registered) {
+    fio___poll_edge_fd_s *e = p->fds + fd;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+    const uint16_t gen = e->gen;
+    if (p->fd == -1) {
+      /* requests hold a reference to the (possibly closed) file, submit now */
+      fio___poll_uring_cancel(
+          &p->ring,
+          FIO___POLL_URING_ID(fd, gen, FIO___POLL_URING_POLL));
+      if (e->accepting == FIO___POLL_URING_ACCEPT_ARMED ||
+          e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE)
+        fio___poll_uring_cancel(
+            &p->ring,
+            FIO___POLL_URING_ID(fd, gen, FIO___POLL_URING_ACCEPT));
+      fio___poll_uring_submit(&p->ring);
+    }
+    fio___poll_uring_accepted_clear(e);
+    /* the pending list is cleaned up by `fio_poll_review` */
+    *e = (fio___poll_edge_fd_s){.gen = (uint16_t)(gen + 1),
+                                .pending = e->pending};
+    if (p->fd != -1)
+#else
+    /* the pending list is cleaned up by `fio_poll_review` */
+    *e = (fio___poll_edge_fd_s){.pending = e->pending};
+#endif
+      epoll_ctl(p->fd, EPOLL_CTL_DEL, fd, &chevent); /* fails if fd closed */
+    r = 0;
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+}
+
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+/**
+ * Accepts a connection from a listening socket, as if calling `accept`.
+ *
+ * Starts a multishot accept request for the listening socket, so connections
+ * are accepted by the kernel and collected here without a system call.
+ */
+SFUNC int fio_poll_accept(fio_poll_s *p, int fd) {
+  int r = -1;
+  FIO___LOCK_LOCK(p->lock);
+  if (p->fd == -1 && (size_t)fd < p->capa && p->fds[fd].registered) {
+    fio___poll_edge_fd_s *e = p->fds + fd;
+    if (e->accepted_count) {
+      r = e->accepted[0];
+      if (--e->accepted_count)
+        FIO_MEMMOVE(e->accepted,
+                    e->accepted + 1,
+                    sizeof(*e->accepted) * e->accepted_count);
+      FIO___LOCK_UNLOCK(p->lock);
+      return r;
+    }
+    if (e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE) {
+      e->stale &= ~POLLIN; /* drained */
+      FIO___LOCK_UNLOCK(p->lock);
+      errno = EAGAIN;
+      return r;
+    }
+    if (e->accepting == FIO___POLL_URING_ACCEPT_NONE &&
+        !fio___poll_uring_accept(&p->ring, fd, e->gen))
+      e->accepting = FIO___POLL_URING_ACCEPT_ARMED;
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  /* until the kernel starts accepting connections, accept them here */
+  return accept(fd, NULL, NULL);
+}
+
+/* handles a completion event, called while locked. */
+FIO_SFUNC void fio___poll_uring_on_cqe(fio_poll_s *p, struct io_uring_cqe *c) {
+  const int fd = (int)(uint32_t)c->user_data;
+  const uint16_t gen = (uint16_t)(c->user_data >> 32);
+  const unsigned kind = (unsigned)(c->user_data >> 48);
+  const int more = !!(c->flags & IORING_CQE_F_MORE);
+  fio___poll_edge_fd_s *e = ((size_t)fd < p->capa) ? p->fds + fd : NULL;
+  if (kind == FIO___POLL_URING_CANCEL)
+    return;
+  if (!e || !e->registered || e->gen != gen) {
+    if (kind == FIO___POLL_URING_ACCEPT && c->res >= 0)
+      close(c->res); /* accepted after `fio_poll_forget` was called */
+    return;
+  }
+  if (kind == FIO___POLL_URING_ACCEPT) {
+    if (c->res >= 0) {
+      if (fio___poll_uring_accepted_push(e, c->res))
+        close(c->res);
+      e->accepting = FIO___POLL_URING_ACCEPT_ACTIVE;
+      e->ready |= POLLIN;
+      e->stale &= ~POLLIN;
+    }
+    if (!more) {
+      if (c->res >= 0 && !fio___poll_uring_accept(&p->ring, fd, gen)) {
+        e->accepting = FIO___POLL_URING_ACCEPT_ARMED;
+      } else {
+        /* `accept` reports (or handles) the error, never retry unsupported */
+        e->accepting = (c->res == -EINVAL || c->res == -EOPNOTSUPP)
+                           ? FIO___POLL_URING_ACCEPT_FAILED
+                           : FIO___POLL_URING_ACCEPT_NONE;
+        e->ready |= POLLIN;
+      }
+    }
+  } else if (c->res >= 0) {
+    unsigned short flags =
+        fio___poll_edge_flags((uint32_t)c->res,
+                              POLLIN,
+                              POLLOUT,
+                              (FIO___POLL_EDGE_RDHUP | POLLHUP | POLLERR));
+    /* connections are collected by the kernel, ignore the listening socket */
+    if (e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE && !(flags & POLLHUP))
+      flags &= ~POLLIN;
+    e->ready |= flags;
+    e->stale &= ~flags;
+    /* the request was terminated (i.e., overflow), a new one reports state */
+    if (!more && fio___poll_uring_poll(&p->ring, fd, gen))
+      e->ready |= (POLLIN | POLLHUP);
+  } else { /* errors are handled as disconnections */
+    e->ready |= (POLLIN | POLLHUP);
+  }
+  fio___poll_edge_pend(p, fd);
+}
+
+/* submits queued requests, waits for completions and collects their events. */
+FIO_SFUNC void fio___poll_uring_review(fio_poll_s *p, size_t timeout) {
+  fio___poll_uring_s *r = &p->ring;
+  unsigned submit, head, tail, flags;
+  int submitted = 0;
+  FIO___LOCK_LOCK(p->lock);
+  submit = r->queued;
+  head = *r->cq_head;
+  fio_atomic_load(tail, r->cq_tail);
+  fio_atomic_load(flags, r->sq_flags);
+  FIO___LOCK_UNLOCK(p->lock);
+  if (head == tail && timeout) {
+    struct __kernel_timespec ts = {
+        .tv_sec = (long long)(timeout / 1000),
+        .tv_nsec = (long long)((timeout % 1000) * 1000000),
+    };
+    struct io_uring_getevents_arg arg = {.ts = (uint64_t)(uintptr_t)&ts};
+    submitted =
+        fio___poll_uring_enter(r->fd,
+                               submit,
+                               1,
+                               (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG),
+                               &arg,
+                               sizeof(arg));
+  } else if (submit || (flags & IORING_SQ_CQ_OVERFLOW)) {
+    submitted = fio___poll_uring_enter(r->fd,
+                                       submit,
+                                       0,
+                                       IORING_ENTER_GETEVENTS,
+                                       NULL,
+                                       0);
+  }
+  FIO___LOCK_LOCK(p->lock);
+  if (submitted > 0)
+    r->queued -= ((unsigned)submitted > r->queued) ? r->queued
+                                                   : (unsigned)submitted;
+  head = *r->cq_head;
+  fio_atomic_load(tail, r->cq_tail);
+  for (; head != tail; ++head)
+    fio___poll_uring_on_cqe(p, r->cqes + (head & r->cq_mask));
+  fio_atomic_exchange(r->cq_head, head);
+  FIO___LOCK_UNLOCK(p->lock);
+}
+#endif /* FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING */
+
+/* waits for `epoll` events and collects them. */
+FIO_SFUNC void fio___poll_edge_epoll_review(fio_poll_s *p, size_t timeout) {
+  struct epoll_event events[FIO_POLL_MAX_EVENTS];
+  int count = epoll_wait(p->fd, events, FIO_POLL_MAX_EVENTS, (int)timeout);
+  FIO___LOCK_LOCK(p->lock);
+  for (int i = 0; i < count; ++i) {
+    const int fd = events[i].data.fd;
+    const unsigned short flags =
+        fio___poll_edge_flags(events[i].events,
+                              EPOLLIN,
+                              EPOLLOUT,
+                              (EPOLLRDHUP | EPOLLHUP | EPOLLERR));
+    if ((size_t)fd >= p->capa || !p->fds[fd].registered)
+      continue;
+    p->fds[fd].ready |= flags;
+    p->fds[fd].stale &= ~flags;
+    fio___poll_edge_pend(p, fd);
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+}
+
+/**
+ * Reviews if any of the monitored file descriptors has any events.
+ *
+ * `timeout` is in milliseconds.
+ *
+ * Returns the number of events called.
+ *
+ * Polling is thread safe, but has different effects on different threads.
+ *
+ * Adding a new file descriptor from one thread while polling in a different
+ * thread will not poll that IO until `fio_poll_review` is called again.
+ */
+SFUNC int fio_poll_review(fio_poll_s *p, size_t timeout) {
+  struct pollfd tests[FIO_POLL_MAX_EVENTS];
+  struct {
+    void *udata;
+    unsigned short flags;
+  } fired[FIO_POLL_MAX_EVENTS];
+  size_t test_count = 0, fired_count = 0, kept = 0;
+  /* armed events might be ready, don't wait */
+  FIO___LOCK_LOCK(p->lock);
+  if (p->pending_count)
+    timeout = 0;
+  FIO___LOCK_UNLOCK(p->lock);
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+  if (p->fd == -1)
+    fio___poll_uring_review(p, timeout);
+  else
+#endif
+    fio___poll_edge_epoll_review(p, timeout);
+  FIO___LOCK_LOCK(p->lock);
+  /* test armed stale events, the kernel won't report these again */
+  for (size_t i = 0; i < p->pending_count && test_count < FIO_POLL_MAX_EVENTS;
+       ++i) {
+    fio___poll_edge_fd_s *e = p->fds + p->pending[i];
+    unsigned short flags = e->armed & e->stale & ~e->ready;
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+    if ((flags & POLLIN) && e->accepting == FIO___POLL_URING_ACCEPT_ACTIVE) {
+      /* the kernel accepts connections, test for collected connections */
+      e->stale &= ~POLLIN;
+      if (e->accepted_count)
+        e->ready |= POLLIN;
+      flags &= ~POLLIN;
+    }
+#endif
+    if (!flags)
+      continue;
+    tests[test_count++] = (struct pollfd){
+        .fd = p->pending[i],
+        .events = (short)(flags | FIO___POLL_EDGE_RDHUP),
+    };
+  }
+  if (test_count) {
+    FIO___LOCK_UNLOCK(p->lock);
+    const int tested = poll(tests, (nfds_t)test_count, 0);
+    FIO___LOCK_LOCK(p->lock);
+    for (size_t i = 0; tested >= 0 && i < test_count; ++i) {
+      const int fd = tests[i].fd;
+      const unsigned short flags = fio___poll_edge_flags(
+          (uint32_t)tests[i].revents,
+          POLLIN,
+          POLLOUT,
+          (FIO___POLL_EDGE_RDHUP | POLLHUP | POLLERR | POLLNVAL));
+      if ((size_t)fd >= p->capa)
+        continue;
+      p->fds[fd].stale &= ~((unsigned short)tests[i].events);
+      p->fds[fd].ready |= flags;
+    }
+  }
+  /* fire armed ready events (one-shot), keep fds that may still have some */
+  for (size_t i = 0; i < p->pending_count; ++i) {
+    const int fd = p->pending[i];
+    fio___poll_edge_fd_s *e = p->fds + fd;
+    unsigned short flags = e->armed & e->ready;
+    if (flags && fired_count < FIO_POLL_MAX_EVENTS) {
+      if ((e->ready & POLLHUP) && (e->armed & POLLIN)) {
+        flags = POLLHUP;
+        e->armed = 0;
+      } else {
+        e->armed &= ~flags;
+        e->ready &= ~flags;
+        e->stale |= flags;
+      }
+      fired[fired_count].udata = e->udata;
+      fired[fired_count++].flags = flags;
+    }
+    if ((e->armed & (e->ready | e->stale))) {
+      p->pending[kept++] = fd;
+      continue;
+    }
+    e->pending = 0;
+  }
+  p->pending_count = kept;
+  FIO___LOCK_UNLOCK(p->lock);
+  for (size_t i = 0; i < fired_count; ++i) {
+    if ((fired[i].flags & POLLHUP)) {
+      p->settings.on_close(fired[i].udata);
+      continue;
+    }
+    if ((fired[i].flags & POLLOUT))
+      p->settings.on_ready(fired[i].udata);
+    if ((fired[i].flags & POLLIN))
+      p->settings.on_data(fired[i].udata);
+  }
+  return (int)fired_count;
+}
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO___POLL_EDGE_RDHUP
+#endif /* FIO_POLL_ENGINE_EPOLL_ET || FIO_POLL_ENGINE_IO_URING */
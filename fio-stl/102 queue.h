@@ -34,6 +34,72 @@ Queue Type(s)
 #endif
 #endif
 
+#ifndef FIO_QUEUE_LOCKFREE
+/**
+ * If true, tasks are exchanged using a lock-free (MPMC) ring buffer.
+ *
+ * The locked ring buffers are only used for urgent tasks and when the lock-free
+ * ring is full.
+ */
+#define FIO_QUEUE_LOCKFREE 0
+#endif
+
+#ifndef FIO_QUEUE_LOCKFREE_SLOTS
+/** The number of slots in the lock-free ring. Must be a power of 2. */
+#define FIO_QUEUE_LOCKFREE_SLOTS 512
+#endif
+
+#if (FIO_QUEUE_LOCKFREE_SLOTS & (FIO_QUEUE_LOCKFREE_SLOTS - 1))
+#error FIO_QUEUE_LOCKFREE_SLOTS must be a power of 2
+#endif
+
+#ifndef FIO_QUEUE_WORKER_DEQUE
+/** The number of tasks a work-stealing worker keeps locally (power of 2). */
+#define FIO_QUEUE_WORKER_DEQUE 256
+#endif
+
+#if (FIO_QUEUE_WORKER_DEQUE & (FIO_QUEUE_WORKER_DEQUE - 1))
+#error FIO_QUEUE_WORKER_DEQUE must be a power of 2
+#endif
+
+#ifndef FIO_QUEUE_BATCH
+/** The number of tasks `fio_queue_perform_batch` pops at once (on the stack). */
+#define FIO_QUEUE_BATCH 32
+#endif
+
+#ifndef FIO_QUEUE_SPIN
+/**
+ * The number of times an idle worker thread polls for new tasks (pausing the
+ * CPU between polls) before it parks (sleeps until woken). `0` == never spin.
+ *
+ * The budget adapts: it shrinks when spinning fails and resets when it works.
+ */
+#define FIO_QUEUE_SPIN 256
+#endif
+
+#ifndef FIO_QUEUE_STATS
+/**
+ * If true, queues collect statistics (see `fio_queue_stats`): the time tasks
+ * wait in the queue, the time each callback runs and the queue's depth
+ * high-water mark.
+ *
+ * Tasks are timestamped when pushed, performed and done (adds a small cost).
+ */
+#define FIO_QUEUE_STATS 0
+#endif
+
+#ifndef FIO_QUEUE_STATS_FUNCTIONS
+/** The number of callbacks a queue collects statistics for (power of 2). */
+#define FIO_QUEUE_STATS_FUNCTIONS 32
+#endif
+
+#if (FIO_QUEUE_STATS_FUNCTIONS & (FIO_QUEUE_STATS_FUNCTIONS - 1))
+#error FIO_QUEUE_STATS_FUNCTIONS must be a power of 2
+#endif
+
+/** Histogram bins: `[0]` < 1us, `[i]` < 2^i us, the last bin holds the rest. */
+#define FIO_QUEUE_STATS_BINS 24
+
 /** Task information */
 typedef struct {
   /** The function to call */
@@ -42,8 +108,48 @@ typedef struct {
   void *udata1;
   /** User opaque data */
   void *udata2;
+#if FIO_QUEUE_STATS
+  /** The time the task was pushed, in nanoseconds (set by the queue). */
+  int64_t queued_at;
+#endif
 } fio_queue_task_s;
 
+#if FIO_QUEUE_STATS
+/** Callback statistics (see `fio_queue_stats_s`). */
+typedef struct {
+  /** The callback (NULL for unused entries). */
+  void (*fn)(void *, void *);
+  /** The number of times the callback was performed. */
+  uint64_t count;
+  /** The callback's total run time, in nanoseconds. */
+  uint64_t total;
+  /** The callback's longest run time, in nanoseconds. */
+  uint64_t max;
+  /** Run time histogram (see `FIO_QUEUE_STATS_BINS`). */
+  uint64_t hist[FIO_QUEUE_STATS_BINS];
+} fio_queue_fn_stats_s;
+
+/** Queue statistics, collected when `FIO_QUEUE_STATS` is true. */
+typedef struct {
+  /** The number of tasks pushed to the queue. */
+  uint64_t pushed;
+  /** The number of tasks performed by the queue. */
+  uint64_t performed;
+  /** Tasks performed by callbacks that didn't fit the callback table. */
+  uint64_t untracked;
+  /** The queue's depth high-water mark (the most tasks waiting at once). */
+  uint64_t depth_max;
+  /** The total time tasks waited in the queue, in nanoseconds. */
+  uint64_t wait_total;
+  /** The longest time a task waited in the queue, in nanoseconds. */
+  uint64_t wait_max;
+  /** Wait time histogram (see `FIO_QUEUE_STATS_BINS`). */
+  uint64_t wait[FIO_QUEUE_STATS_BINS];
+  /** Per callback run time statistics (a hash table). */
+  fio_queue_fn_stats_s fn[FIO_QUEUE_STATS_FUNCTIONS];
+} fio_queue_stats_s;
+#endif
+
 /* internal use */
 typedef struct fio___task_ring_s {
   uint16_t r;   /* reader position */
@@ -53,6 +159,15 @@ typedef struct fio___task_ring_s {
   fio_queue_task_s buf[FIO_QUEUE_TASKS_PER_ALLOC];
 } fio___task_ring_s;
 
+#if FIO_QUEUE_LOCKFREE
+/* internal use - a lock-free ring slot */
+typedef struct {
+  /* the slot's sequence number, relative to the slot's index */
+  size_t seq;
+  fio_queue_task_s task;
+} fio___task_slot_s;
+#endif
+
 /** The queue object - should be considered opaque (or, at least, read only). */
 typedef struct {
   /** task read pointer. */
@@ -67,6 +182,28 @@ typedef struct {
   FIO_LIST_NODE consumers;
   /** main ring buffer associated with the queue. */
   fio___task_ring_s mem;
+  /** the number of worker threads that are parked (or about to park). */
+  volatile uint32_t idle;
+  /** wake-up sequence (futex word), incremented before waking workers. */
+  volatile uint32_t wake;
+#if FIO_QUEUE_LOCKFREE
+  /** urgent tasks waiting in the locked ring buffers. */
+  volatile uint32_t urgent;
+  /** tasks waiting in the locked ring buffers after the lock-free ring. */
+  volatile uint32_t overflow;
+  /** lock-free ring reader position (and cache line padding). */
+  size_t head;
+  char pad0_[64 - sizeof(size_t)];
+  /** lock-free ring writer position (and cache line padding). */
+  size_t tail;
+  char pad1_[64 - sizeof(size_t)];
+  /** lock-free ring slots (zero initialized). */
+  fio___task_slot_s slots[FIO_QUEUE_LOCKFREE_SLOTS];
+#endif
+#if FIO_QUEUE_STATS
+  /** task statistics. */
+  fio_queue_stats_s stats;
+#endif
 } fio_queue_s;
 
 typedef struct {
@@ -77,8 +214,22 @@ typedef struct {
   fio_thread_cond_t cond;
   size_t workers;
   volatile int stop;
+  /** work-stealing worker deques (NULL unless work-stealing). */
+  struct fio___queue_worker_s *deques;
 } fio___thread_group_s;
 
+/* internal use - a work-stealing worker and its local deque */
+typedef struct fio___queue_worker_s {
+  fio___thread_group_s *grp;
+  size_t index;
+  fio_lock_i lock;
+  /* thieves take the oldest task, at the top */
+  volatile uint32_t top;
+  /* the owner pushes and pops the newest task, at the bottom */
+  volatile uint32_t bottom;
+  fio_queue_task_s buf[FIO_QUEUE_WORKER_DEQUE];
+} fio___queue_worker_s;
+
 /* *****************************************************************************
 Queue API
 ***************************************************************************** */
@@ -141,12 +292,49 @@ SFUNC int fio_queue_perform(fio_queue_s *q);
 /** Performs all tasks in the queue. */
 SFUNC void fio_queue_perform_all(fio_queue_s *q);
 
+/**
+ * Pushes `count` tasks to the queue, acquiring the queue's lock only once.
+ *
+ * Returns the number of tasks pushed (less than `count` on error).
+ */
+SFUNC size_t fio_queue_push_many(fio_queue_s *q,
+                                 fio_queue_task_s *tasks,
+                                 size_t count);
+
+/**
+ * Pops up to `max` tasks from the queue (FIFO), acquiring the queue's lock only
+ * once.
+ *
+ * Returns the number of tasks placed in the `tasks` array.
+ */
+SFUNC size_t fio_queue_pop_many(fio_queue_s *q,
+                                fio_queue_task_s *tasks,
+                                size_t max);
+
+/**
+ * Performs up to `max` tasks from the queue, popping tasks in batches (see
+ * `FIO_QUEUE_BATCH`).
+ *
+ * Returns the number of tasks performed.
+ */
+SFUNC size_t fio_queue_perform_batch(fio_queue_s *q, size_t max);
+
 /** returns the number of tasks in the queue. */
 FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q);
 
 /** Adds worker / consumer threads to perform the jobs in the queue. */
 SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t count);
 
+/**
+ * Adds work-stealing worker threads to perform the jobs in the queue.
+ *
+ * Tasks pushed by these workers (except urgent tasks) are kept in the worker's
+ * local deque and performed LIFO. Idle workers steal tasks from other workers.
+ *
+ * Note: tasks in local deques aren't counted by `fio_queue_count`.
+ */
+SFUNC int fio_queue_workers_add_stealing(fio_queue_s *q, size_t count);
+
 /** Signals all worker threads to stop performing tasks and terminate. */
 SFUNC void fio_queue_workers_stop(fio_queue_s *q);
 
@@ -156,15 +344,54 @@ SFUNC void fio_queue_workers_join(fio_queue_s *q);
 /** Signals all worker threads to go back to work (new tasks added). */
 SFUNC void fio_queue_workers_wake(fio_queue_s *q);
 
+#if FIO_QUEUE_STATS
+/** Returns the queue's statistics (live counters, read only). */
+FIO_IFUNC fio_queue_stats_s *fio_queue_stats(fio_queue_s *q);
+
+/** Resets the queue's statistics (concurrent updates may be lost). */
+SFUNC void fio_queue_stats_reset(fio_queue_s *q);
+
+/**
+ * Returns the upper bound (in microseconds) of the histogram bin holding the
+ * `percentile` (0.0-1.0) sample, `(uint64_t)-1` for the last bin.
+ *
+ * Returns 0 if the histogram is empty.
+ */
+SFUNC uint64_t fio_queue_stats_percentile(const uint64_t *histogram,
+                                          double percentile);
+
+/**
+ * Prints the queue's statistics to `stderr`, busiest callbacks first.
+ *
+ * May be used as a state callback, i.e.:
+ *
+ *     fio_state_callback_add(FIO_CALL_AT_EXIT, fio_queue_stats_print, q);
+ */
+SFUNC void fio_queue_stats_print(void *q);
+#endif
+
 /* *****************************************************************************
 Timer Queue Types and API
 ***************************************************************************** */
 
 typedef struct fio___timer_event_s fio___timer_event_s;
 
+/* timing wheel levels, each level has 64 slots (covers 2^36 milliseconds) */
+#define FIO___TIMER_LEVELS 6
+
+/** A hierarchical timing wheel (millisecond resolution). */
 typedef struct {
-  fio___timer_event_s *next;
+  /** the wheel's position (the last millisecond pushed to a queue). */
+  int64_t at;
+  /** the number of scheduled events. */
+  size_t count;
   FIO___LOCK_TYPE lock;
+  /** occupied slots bitmap, per level. */
+  uint64_t map[FIO___TIMER_LEVELS];
+  /** events too far in the future for the wheel (rare). */
+  fio___timer_event_s *overflow;
+  /** event lists, per level and slot. */
+  fio___timer_event_s *slots[FIO___TIMER_LEVELS][64];
 } fio_timer_queue_s;
 
 #if FIO_USE_THREAD_MUTEX_TMP
@@ -214,7 +441,7 @@ SFUNC size_t fio_timer_push2queue(fio_queue_s *queue,
  * NOTE: unless manually specified, millisecond timers are relative to
  * `fio_time_milli()`.
  */
-FIO_IFUNC int64_t fio_timer_next_at(fio_timer_queue_s *timer_queue);
+SFUNC int64_t fio_timer_next_at(fio_timer_queue_s *timer_queue);
 
 /**
  * Clears any waiting timer bound tasks.
@@ -236,6 +463,13 @@ Queue Inline Helpers
 /** returns the number of tasks in the queue. */
 FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q) { return q->count; }
 
+#if FIO_QUEUE_STATS
+/** Returns the queue's statistics (live counters, read only). */
+FIO_IFUNC fio_queue_stats_s *fio_queue_stats(fio_queue_s *q) {
+  return &q->stats;
+}
+#endif
+
 /** Initializes a fio_queue_s object. */
 FIO_IFUNC void fio_queue_init(fio_queue_s *q) {
   /* do this manually, we don't want to reset a whole page */
@@ -246,6 +480,15 @@ FIO_IFUNC void fio_queue_init(fio_queue_s *q) {
   q->lock = FIO___LOCK_INIT;
   q->mem.next = NULL;
   q->mem.r = q->mem.w = q->mem.dir = 0;
+  q->idle = q->wake = 0;
+#if FIO_QUEUE_LOCKFREE
+  q->urgent = q->overflow = 0;
+  q->head = q->tail = 0;
+  FIO_MEMSET(q->slots, 0, sizeof(q->slots));
+#endif
+#if FIO_QUEUE_STATS
+  FIO_MEMSET(&q->stats, 0, sizeof(q->stats));
+#endif
 }
 
 /* *****************************************************************************
@@ -263,36 +506,72 @@ struct fio___timer_event_s {
   struct fio___timer_event_s *next;
 };
 
-/*
- * Returns the millisecond at which the next event should occur.
- *
- * If no timer is due (list is empty), returns `-1`.
- *
- * NOTE: unless manually specified, millisecond timers are relative to
- * `fio_time_milli()`.
- */
-FIO_IFUNC int64_t fio_timer_next_at(fio_timer_queue_s *tq) {
-  int64_t v = -1;
-  if (!tq)
-    goto missing_tq;
-  if (!tq || !tq->next)
-    return v;
-  FIO___LOCK_LOCK(tq->lock);
-  if (tq->next)
-    v = tq->next->due;
-  FIO___LOCK_UNLOCK(tq->lock);
-  return v;
-
-missing_tq:
-  FIO_LOG_ERROR("`fio_timer_next_at` called with a NULL timer queue!");
-  return v;
-}
-
 /* *****************************************************************************
 Queue Implementation
 ***************************************************************************** */
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 
+/* *****************************************************************************
+Worker Parking (futex on Linux, a condition variable elsewhere)
+***************************************************************************** */
+#if defined(__linux__)
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FIO___QUEUE_PAUSE() __asm__ volatile("pause" ::: "memory")
+#elif defined(__aarch64__)
+#define FIO___QUEUE_PAUSE() __asm__ volatile("yield" ::: "memory")
+#else
+#define FIO___QUEUE_PAUSE() FIO_COMPILER_GUARD
+#endif
+
+/* parks the calling worker unless the queue's wake sequence moved on. */
+FIO_SFUNC void fio___queue_park(fio___thread_group_s *grp, uint32_t seq) {
+#if defined(__linux__)
+  syscall(SYS_futex, &grp->queue->wake, FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+  fio_thread_mutex_lock(&grp->mutex);
+  if (grp->queue->wake == seq && !grp->stop)
+    fio_thread_cond_wait(&grp->cond, &grp->mutex);
+  fio_thread_mutex_unlock(&grp->mutex);
+#endif
+}
+
+/* wakes up to `count` parked workers (call outside the queue's lock). */
+FIO_SFUNC void fio___queue_wake(fio_queue_s *q, uint32_t count) {
+  fio_atomic_add(&q->wake, 1);
+#if defined(__linux__)
+  syscall(SYS_futex,
+          &q->wake,
+          FUTEX_WAKE_PRIVATE,
+          (count > INT_MAX ? INT_MAX : (int)count),
+          NULL,
+          NULL,
+          0);
+#else
+  FIO___LOCK_LOCK(q->lock);
+  FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
+    fio_thread_mutex_lock(&pos->mutex);
+    for (size_t i = 0; i < count && i < pos->workers; ++i)
+      fio_thread_cond_signal(&pos->cond);
+    fio_thread_mutex_unlock(&pos->mutex);
+  }
+  FIO___LOCK_UNLOCK(q->lock);
+#endif
+}
+
+/* wakes parked workers, if any (call after the new tasks were counted). */
+FIO_IFUNC void fio___queue_wake_idle(fio_queue_s *q, uint32_t count) {
+  uint32_t idle;
+  fio_atomic_load(idle, &q->idle);
+  if (idle)
+    fio___queue_wake(q, (count < idle ? count : idle));
+}
+
 /* task queue leak detection */
 FIO___LEAK_COUNTER_DEF(fio_queue)
 FIO___LEAK_COUNTER_DEF(fio_queue_task_rings)
@@ -312,9 +591,10 @@ SFUNC void fio_queue_destroy(fio_queue_s *q) {
     }
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       pos->stop = 1;
-      for (size_t i = 0; i < pos->workers; ++i)
-        fio_thread_cond_signal(&pos->cond);
     }
+    FIO___LOCK_UNLOCK(q->lock);
+    fio___queue_wake(q, (uint32_t)-1);
+    FIO___LOCK_LOCK(q->lock);
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       FIO___LOCK_UNLOCK(q->lock);
       fio_thread_join(&pos->thread);
@@ -389,12 +669,334 @@ FIO_IFUNC fio_queue_task_s fio___task_ring_pop(fio___task_ring_s *r) {
   return t;
 }
 
-int fio_queue_push___(void); /* sublime text marker */
-/** Pushes a task to the queue. Returns -1 on error. */
-SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
-  if (!task.fn)
+#if FIO_QUEUE_LOCKFREE
+/* *****************************************************************************
+Lock-Free Ring (MPMC, sequence numbered slots)
+
+Slot sequence numbers are stored relative to the slot's index, so a zeroed ring
+is a valid (empty) ring and FIO_QUEUE_STATIC_INIT still works.
+***************************************************************************** */
+
+#define FIO___QUEUE_LAP(pos) ((pos) & (~(size_t)(FIO_QUEUE_LOCKFREE_SLOTS - 1)))
+
+FIO_IFUNC int fio___queue_ring_push(fio_queue_s *q, fio_queue_task_s task) {
+  fio___task_slot_s *slot;
+  size_t pos, seq, next;
+  fio_atomic_load(pos, &q->tail);
+  for (;;) {
+    slot = q->slots + (pos & (FIO_QUEUE_LOCKFREE_SLOTS - 1));
+    fio_atomic_load(seq, &slot->seq);
+    intptr_t dif = (intptr_t)(seq - FIO___QUEUE_LAP(pos));
+    if (!dif) {
+      next = pos + 1;
+      if (fio_atomic_compare_exchange_p(&q->tail, &pos, &next))
+        break;
+      continue; /* `pos` was updated */
+    }
+    if (dif < 0)
+      return -1; /* ring is full */
+    fio_atomic_load(pos, &q->tail);
+  }
+  slot->task = task;
+  fio_atomic_exchange(&slot->seq, FIO___QUEUE_LAP(pos) + 1);
+  return 0;
+}
+
+FIO_IFUNC fio_queue_task_s fio___queue_ring_pop(fio_queue_s *q) {
+  fio_queue_task_s t = {.fn = NULL};
+  fio___task_slot_s *slot;
+  size_t pos, seq, next;
+  fio_atomic_load(pos, &q->head);
+  for (;;) {
+    slot = q->slots + (pos & (FIO_QUEUE_LOCKFREE_SLOTS - 1));
+    fio_atomic_load(seq, &slot->seq);
+    intptr_t dif = (intptr_t)(seq - (FIO___QUEUE_LAP(pos) + 1));
+    if (!dif) {
+      next = pos + 1;
+      if (fio_atomic_compare_exchange_p(&q->head, &pos, &next))
+        break;
+      continue; /* `pos` was updated */
+    }
+    if (dif < 0)
+      return t; /* ring is empty */
+    fio_atomic_load(pos, &q->head);
+  }
+  t = slot->task;
+  fio_atomic_exchange(&slot->seq,
+                      FIO___QUEUE_LAP(pos) + FIO_QUEUE_LOCKFREE_SLOTS);
+  return t;
+}
+
+#undef FIO___QUEUE_LAP
+
+/* counts a task added to the locked ring buffers (call within the lock). */
+FIO_IFUNC void fio___queue_count_add(fio_queue_s *q, int urgent) {
+  if (urgent)
+    ++q->urgent;
+  else
+    ++q->overflow;
+  fio_atomic_add(&q->count, 1);
+}
+
+/* counts a task taken from the locked ring buffers, returns remaining. */
+FIO_IFUNC uint32_t fio___queue_count_sub(fio_queue_s *q) {
+  if (q->urgent)
+    --q->urgent;
+  else
+    --q->overflow;
+  fio_atomic_sub(&q->count, 1);
+  return q->urgent + q->overflow;
+}
+
+#else /* FIO_QUEUE_LOCKFREE */
+
+/* the atomic operation orders the count before testing for idle workers. */
+FIO_IFUNC void fio___queue_count_add(fio_queue_s *q, int urgent) {
+  fio_atomic_add(&q->count, 1);
+  (void)urgent;
+}
+
+FIO_IFUNC uint32_t fio___queue_count_sub(fio_queue_s *q) { return --q->count; }
+#endif /* FIO_QUEUE_LOCKFREE */
+
+/* *****************************************************************************
+Queue Statistics
+***************************************************************************** */
+
+FIO_SFUNC void fio___timer_perform(void *timer_, void *t_);
+
+#if FIO_QUEUE_STATS
+
+/* timestamps a task as it's pushed */
+#define FIO___QUEUE_STATS_STAMP(task) ((task).queued_at = fio_time_nano())
+/* counts pushed tasks */
+#define FIO___QUEUE_STATS_PUSH(q, n) fio___queue_stats_push((q), (n))
+
+/* the histogram bin for a duration in nanoseconds. */
+FIO_IFUNC size_t fio___queue_stats_bin(uint64_t ns) {
+  const uint64_t us = ns / 1000;
+  const size_t bin = us ? fio_bits_msb_index(us) + 1 : 0;
+  return bin < FIO_QUEUE_STATS_BINS ? bin : FIO_QUEUE_STATS_BINS - 1;
+}
+
+/* sets `*dest` to `value` if `value` is bigger. */
+FIO_IFUNC void fio___queue_stats_max(uint64_t *dest, uint64_t value) {
+  uint64_t old;
+  for (;;) {
+    fio_atomic_load(old, dest);
+    if (old >= value || fio_atomic_compare_exchange_p(dest, &old, &value))
+      return;
+  }
+}
+
+/* counts pushed tasks and updates the queue's depth high-water mark. */
+FIO_IFUNC void fio___queue_stats_push(fio_queue_s *q, size_t count) {
+  uint32_t depth;
+  if (!count)
+    return;
+  fio_atomic_add(&q->stats.pushed, (uint64_t)count);
+  fio_atomic_load(depth, &q->count);
+  fio___queue_stats_max(&q->stats.depth_max, (uint64_t)depth);
+}
+
+/* finds (or adds) a callback's entry, returns NULL if the table is full. */
+FIO_IFUNC fio_queue_fn_stats_s *fio___queue_stats_fn(
+    fio_queue_s *q,
+    void (*fn)(void *, void *)) {
+  const size_t mask = FIO_QUEUE_STATS_FUNCTIONS - 1;
+  const size_t pos =
+      (size_t)(((uint64_t)(uintptr_t)fn * 0x9E3779B97F4A7C15ULL) >> 32);
+  for (size_t i = 0; i < FIO_QUEUE_STATS_FUNCTIONS; ++i) {
+    fio_queue_fn_stats_s *e = q->stats.fn + ((pos + i) & mask);
+    void (*existing)(void *, void *);
+    fio_atomic_load(existing, &e->fn);
+    if (!existing) {
+      fio_atomic_compare_exchange_p(&e->fn, &existing, &fn);
+      fio_atomic_load(existing, &e->fn);
+    }
+    if (existing == fn)
+      return e;
+  }
+  return NULL;
+}
+
+/* records a task's wait time (before it's performed). */
+FIO_IFUNC void fio___queue_stats_wait(fio_queue_s *q, uint64_t ns) {
+  fio_atomic_add(&q->stats.wait_total, ns);
+  fio_atomic_add(q->stats.wait + fio___queue_stats_bin(ns), 1);
+  fio___queue_stats_max(&q->stats.wait_max, ns);
+}
+
+/* records a callback's run time. */
+FIO_SFUNC void fio___queue_stats_run(fio_queue_s *q,
+                                     void (*fn)(void *, void *),
+                                     uint64_t ns) {
+  fio_queue_fn_stats_s *e = fio___queue_stats_fn(q, fn);
+  fio_atomic_add(&q->stats.performed, 1);
+  if (!e) {
+    fio_atomic_add(&q->stats.untracked, 1);
+    return;
+  }
+  fio_atomic_add(&e->count, 1);
+  fio_atomic_add(&e->total, ns);
+  fio_atomic_add(e->hist + fio___queue_stats_bin(ns), 1);
+  fio___queue_stats_max(&e->max, ns);
+}
+
+/* performs a task, recording its wait time and its callback's run time. */
+FIO_IFUNC void fio___queue_task_perform(fio_queue_s *q, fio_queue_task_s t) {
+  const int64_t start = fio_time_nano();
+  void (*fn)(void *, void *) = t.fn;
+  /* timer tasks are recorded using the timer's callback */
+  if (fn == fio___timer_perform)
+    fn = (void (*)(void *, void *))(uintptr_t)(
+        (fio___timer_event_s *)t.udata2)->fn;
+  fio___queue_stats_wait(q,
+                         (uint64_t)(start > t.queued_at ? start - t.queued_at
+                                                        : 0));
+  t.fn(t.udata1, t.udata2);
+  fio___queue_stats_run(q, fn, (uint64_t)(fio_time_nano() - start));
+}
+
+/** Resets the queue's statistics (concurrent updates may be lost). */
+SFUNC void fio_queue_stats_reset(fio_queue_s *q) {
+  FIO_MEMSET(&q->stats, 0, sizeof(q->stats));
+}
+
+/** Returns the upper bound (in microseconds) of a percentile's bin. */
+SFUNC uint64_t fio_queue_stats_percentile(const uint64_t *histogram,
+                                          double percentile) {
+  uint64_t total = 0, seen = 0;
+  for (size_t i = 0; i < FIO_QUEUE_STATS_BINS; ++i)
+    total += histogram[i];
+  if (!total)
     return 0;
-  FIO___LOCK_LOCK(q->lock);
+  const uint64_t target = (uint64_t)(percentile * (double)total);
+  for (size_t i = 0; i < FIO_QUEUE_STATS_BINS - 1; ++i) {
+    seen += histogram[i];
+    if (seen > target || seen == total)
+      return (uint64_t)1 << i;
+  }
+  return (uint64_t)-1;
+}
+
+/** Prints the queue's statistics to `stderr`, busiest callbacks first. */
+SFUNC void fio_queue_stats_print(void *q_) {
+  fio_queue_s *q = (fio_queue_s *)q_;
+  fio_queue_stats_s *st = &q->stats;
+  fio_queue_fn_stats_s *order[FIO_QUEUE_STATS_FUNCTIONS];
+  size_t count = 0;
+  /* order callbacks by their total run time (insertion sort) */
+  for (size_t i = 0; i < FIO_QUEUE_STATS_FUNCTIONS; ++i) {
+    size_t pos = count;
+    if (!st->fn[i].fn)
+      continue;
+    for (; pos && order[pos - 1]->total < st->fn[i].total; --pos)
+      order[pos] = order[pos - 1];
+    order[pos] = st->fn + i;
+    ++count;
+  }
+  fprintf(stderr,
+          "Queue %p statistics:\n"
+          "\t* tasks: %llu pushed, %llu performed (%llu untracked)\n"
+          "\t* depth high-water mark: %llu\n"
+          "\t* wait: avg %llu us, p50 < %llu us, p99 < %llu us, max %llu us\n",
+          q_,
+          (unsigned long long)st->pushed,
+          (unsigned long long)st->performed,
+          (unsigned long long)st->untracked,
+          (unsigned long long)st->depth_max,
+          (unsigned long long)(st->performed
+                                   ? st->wait_total / st->performed / 1000
+                                   : 0),
+          (unsigned long long)fio_queue_stats_percentile(st->wait, 0.5),
+          (unsigned long long)fio_queue_stats_percentile(st->wait, 0.99),
+          (unsigned long long)(st->wait_max / 1000));
+  for (size_t i = 0; i < count; ++i) {
+    fprintf(stderr,
+            "\t* callback %p: %llu tasks, %llu us total, avg %llu us, "
+            "p99 < %llu us, max %llu us\n",
+            (void *)(uintptr_t)order[i]->fn,
+            (unsigned long long)order[i]->count,
+            (unsigned long long)(order[i]->total / 1000),
+            (unsigned long long)(order[i]->count
+                                     ? order[i]->total / order[i]->count / 1000
+                                     : 0),
+            (unsigned long long)fio_queue_stats_percentile(order[i]->hist,
+                                                           0.99),
+            (unsigned long long)(order[i]->max / 1000));
+  }
+}
+
+#else /* FIO_QUEUE_STATS */
+
+#define FIO___QUEUE_STATS_STAMP(task) ((void)0)
+#define FIO___QUEUE_STATS_PUSH(q, n)  ((void)(n))
+
+/* performs a task. */
+FIO_IFUNC void fio___queue_task_perform(fio_queue_s *q, fio_queue_task_s t) {
+  t.fn(t.udata1, t.udata2);
+  (void)q;
+}
+#endif /* FIO_QUEUE_STATS */
+
+/* *****************************************************************************
+Work-Stealing Worker Deques
+***************************************************************************** */
+
+/* the work-stealing worker running on the current thread (if any) */
+static __thread fio___queue_worker_s *fio___queue_worker_current;
+
+/* pushes a task to the bottom of the worker's deque (owner only). */
+FIO_IFUNC int fio___queue_worker_push(fio___queue_worker_s *w,
+                                      fio_queue_task_s task) {
+  uint32_t count;
+  fio_lock(&w->lock);
+  count = w->bottom - w->top;
+  if (count == FIO_QUEUE_WORKER_DEQUE) {
+    fio_unlock(&w->lock);
+    return -1;
+  }
+  w->buf[w->bottom & (FIO_QUEUE_WORKER_DEQUE - 1)] = task;
+  /* the atomic operation orders the task before testing for idle workers */
+  fio_atomic_add(&w->bottom, 1);
+  fio_unlock(&w->lock);
+  /* wake an idle worker whenever the surplus doubles (2, 4, 8... tasks) */
+  if (!count || (count & (count + 1)))
+    return 0;
+  fio___queue_wake_idle(w->grp->queue, 1);
+  return 0;
+}
+
+/* pops the newest task from the bottom of the worker's deque (owner only). */
+FIO_IFUNC fio_queue_task_s fio___queue_worker_pop(fio___queue_worker_s *w) {
+  fio_queue_task_s t = {.fn = NULL};
+  if (w->bottom == w->top)
+    return t;
+  fio_lock(&w->lock);
+  if (w->bottom != w->top) {
+    --w->bottom;
+    t = w->buf[w->bottom & (FIO_QUEUE_WORKER_DEQUE - 1)];
+  }
+  fio_unlock(&w->lock);
+  return t;
+}
+
+/* steals the oldest task from the top of a worker's deque. */
+FIO_IFUNC fio_queue_task_s fio___queue_worker_steal(fio___queue_worker_s *w) {
+  fio_queue_task_s t = {.fn = NULL};
+  if (w->bottom == w->top || fio_trylock(&w->lock))
+    return t;
+  if (w->bottom != w->top) {
+    t = w->buf[w->top & (FIO_QUEUE_WORKER_DEQUE - 1)];
+    ++w->top;
+  }
+  fio_unlock(&w->lock);
+  return t;
+}
+
+/* pushes a task to the locked ring buffers (call within the lock). */
+FIO_IFUNC int fio___queue_push_locked(fio_queue_s *q, fio_queue_task_s task) {
   if (fio___task_ring_push(q->w, task)) {
     if (q->w != &q->mem && q->mem.next == NULL) {
       q->w->next = &q->mem;
@@ -403,7 +1005,7 @@ SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
       void *tmp = (fio___task_ring_s *)
           FIO_MEM_REALLOC_(NULL, 0, sizeof(*q->w->next), 0);
       if (!tmp)
-        goto no_mem;
+        return -1;
       FIO___LEAK_COUNTER_ON_ALLOC(fio_queue_task_rings);
       q->w->next = (fio___task_ring_s *)tmp;
       if (!FIO_MEM_REALLOC_IS_SAFE_) {
@@ -415,13 +1017,38 @@ SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
     q->w = q->w->next;
     fio___task_ring_push(q->w, task);
   }
-  ++q->count;
-  if (!FIO_LIST_IS_EMPTY(&q->consumers)) {
-    FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
-      fio_thread_cond_signal(&pos->cond);
-    }
+  fio___queue_count_add(q, 0);
+  return 0;
+}
+
+int fio_queue_push___(void); /* sublime text marker */
+/** Pushes a task to the queue. Returns -1 on error. */
+SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
+  if (!task.fn)
+    return 0;
+  FIO___QUEUE_STATS_STAMP(task);
+  /* tasks pushed by a work-stealing worker stay local (unless it's full) */
+  if (fio___queue_worker_current &&
+      fio___queue_worker_current->grp->queue == q &&
+      !fio___queue_worker_push(fio___queue_worker_current, task)) {
+    FIO___QUEUE_STATS_PUSH(q, 1);
+    return 0;
+  }
+#if FIO_QUEUE_LOCKFREE
+  /* tasks overflow to the locked ring buffers only when the ring is full */
+  if (!q->overflow && !fio___queue_ring_push(q, task)) {
+    fio_atomic_add(&q->count, 1);
+    FIO___QUEUE_STATS_PUSH(q, 1);
+    fio___queue_wake_idle(q, 1);
+    return 0;
   }
+#endif
+  FIO___LOCK_LOCK(q->lock);
+  if (fio___queue_push_locked(q, task))
+    goto no_mem;
   FIO___LOCK_UNLOCK(q->lock);
+  FIO___QUEUE_STATS_PUSH(q, 1);
+  fio___queue_wake_idle(q, 1);
   return 0;
 no_mem:
   FIO___LOCK_UNLOCK(q->lock);
@@ -430,12 +1057,74 @@ no_mem:
   return -1;
 }
 
+/**
+ * Pushes `count` tasks to the queue, acquiring the queue's lock only once.
+ *
+ * Returns the number of tasks pushed (less than `count` on error).
+ */
+SFUNC size_t fio_queue_push_many(fio_queue_s *q,
+                                 fio_queue_task_s *tasks,
+                                 size_t count) {
+  size_t i = 0;
+  if (!count)
+    return 0;
+  /* work-stealing workers keep their tasks local */
+  if (fio___queue_worker_current &&
+      fio___queue_worker_current->grp->queue == q) {
+    for (; i < count; ++i)
+      if (fio_queue_push FIO_NOOP(q, tasks[i]))
+        break;
+    return i;
+  }
+#if FIO_QUEUE_STATS
+  {
+    const int64_t now = fio_time_nano();
+    for (size_t j = 0; j < count; ++j)
+      tasks[j].queued_at = now;
+  }
+#endif
+#if FIO_QUEUE_LOCKFREE
+  if (!q->overflow) {
+    size_t added = 0;
+    for (; i < count; ++i) {
+      if (!tasks[i].fn)
+        continue;
+      if (fio___queue_ring_push(q, tasks[i]))
+        break;
+      ++added;
+    }
+    if (added)
+      fio_atomic_add(&q->count, (uint32_t)added);
+    FIO___QUEUE_STATS_PUSH(q, added);
+    if (i == count) {
+      fio___queue_wake_idle(q, (uint32_t)added);
+      return i;
+    }
+  }
+#endif
+  const size_t first = i;
+  FIO___LOCK_LOCK(q->lock);
+  for (; i < count; ++i) {
+    if (tasks[i].fn && fio___queue_push_locked(q, tasks[i]))
+      break;
+  }
+  FIO___LOCK_UNLOCK(q->lock);
+  FIO___QUEUE_STATS_PUSH(q, i - first);
+  /* wake (up to) as many parked workers as there are new tasks */
+  fio___queue_wake_idle(q, (uint32_t)i);
+  if (i < count)
+    FIO_LOG_ERROR("No memory for Queue %p to increase task ring buffer.",
+                  (void *)q);
+  return i;
+}
+
 int fio_queue_push_urgent___(void); /* IDE marker */
 /** Pushes a task to the head of the queue. Returns -1 on error (no memory). */
 SFUNC int fio_queue_push_urgent FIO_NOOP(fio_queue_s *q,
                                          fio_queue_task_s task) {
   if (!task.fn)
     return 0;
+  FIO___QUEUE_STATS_STAMP(task);
   FIO___LOCK_LOCK(q->lock);
   if (fio___task_ring_unpop(q->r, task)) {
     /* such a shame... but we must allocate a while task block for one task */
@@ -450,13 +1139,10 @@ SFUNC int fio_queue_push_urgent FIO_NOOP(fio_queue_s *q,
     tmp->dir = tmp->r = 0;
     tmp->buf[0] = task;
   }
-  ++q->count;
-  if (!FIO_LIST_IS_EMPTY(&q->consumers)) {
-    FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
-      fio_thread_cond_signal(&pos->cond);
-    }
-  }
+  fio___queue_count_add(q, 1);
   FIO___LOCK_UNLOCK(q->lock);
+  FIO___QUEUE_STATS_PUSH(q, 1);
+  fio___queue_wake_idle(q, 1);
   return 0;
 no_mem:
   FIO___LOCK_UNLOCK(q->lock);
@@ -465,37 +1151,92 @@ no_mem:
   return -1;
 }
 
+/*
+ * Pops a task from the locked ring buffers (call within the lock).
+ *
+ * Task rings that are no longer used are added to the `to_free` list.
+ */
+FIO_IFUNC fio_queue_task_s fio___queue_pop_locked(fio_queue_s *q,
+                                                  fio___task_ring_s **to_free) {
+  fio_queue_task_s t;
+  if (!(t = fio___task_ring_pop(q->r)).fn) {
+    fio___task_ring_s *done = q->r;
+    q->r = done->next;
+    done->next = NULL;
+    if (done != &q->mem) {
+      done->next = *to_free;
+      *to_free = done;
+    }
+    t = fio___task_ring_pop(q->r);
+  }
+  if (t.fn && !fio___queue_count_sub(q) && q->r != &q->mem) {
+    q->r->next = *to_free;
+    *to_free = q->r;
+    q->r = q->w = &q->mem;
+    q->mem.w = q->mem.r = q->mem.dir = 0;
+  }
+  return t;
+}
+
 /** Pops a task from the queue (FIFO). Returns a NULL task on error. */
 SFUNC fio_queue_task_s fio_queue_pop(fio_queue_s *q) {
   fio_queue_task_s t = {.fn = NULL};
+  fio_queue_pop_many(q, &t, 1);
+  return t;
+}
+
+/**
+ * Pops up to `max` tasks from the queue (FIFO), acquiring the queue's lock only
+ * once.
+ *
+ * Returns the number of tasks placed in the `tasks` array.
+ */
+SFUNC size_t fio_queue_pop_many(fio_queue_s *q,
+                                fio_queue_task_s *tasks,
+                                size_t max) {
+  size_t i = 0;
   fio___task_ring_s *to_free = NULL;
-  if (!q->count)
-    return t;
-  FIO___LOCK_LOCK(q->lock);
-  if (!q->count)
-    goto finish;
-  if (!(t = fio___task_ring_pop(q->r)).fn) {
-    to_free = q->r;
-    q->r = to_free->next;
-    to_free->next = NULL;
-    t = fio___task_ring_pop(q->r);
+  if (!q->count || !max)
+    return 0;
+#if FIO_QUEUE_LOCKFREE
+  if (!q->urgent) {
+    while (i < max && (tasks[i] = fio___queue_ring_pop(q)).fn)
+      ++i;
+    if (i)
+      fio_atomic_sub(&q->count, (uint32_t)i);
+    if (i == max || !q->overflow)
+      return i;
   }
-  if (t.fn && !(--q->count) && q->r != &q->mem) {
-    if (to_free && to_free != &q->mem) { // edge case
-      FIO___LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
-      FIO_MEM_FREE_(to_free, sizeof(*to_free));
+#endif
+  FIO___LOCK_LOCK(q->lock);
+  while (i < max) {
+#if FIO_QUEUE_LOCKFREE
+    if (!q->urgent) {
+      /* overflow tasks were pushed after the tasks in the lock-free ring */
+      if ((tasks[i] = fio___queue_ring_pop(q)).fn) {
+        fio_atomic_sub(&q->count, 1);
+        ++i;
+        continue;
+      }
+      if (!q->overflow)
+        break;
     }
-    to_free = q->r;
-    q->r = q->w = &q->mem;
-    q->mem.w = q->mem.r = q->mem.dir = 0;
+#else
+    if (!q->count)
+      break;
+#endif
+    if (!(tasks[i] = fio___queue_pop_locked(q, &to_free)).fn)
+      break;
+    ++i;
   }
-finish:
   FIO___LOCK_UNLOCK(q->lock);
-  if (to_free && to_free != &q->mem) {
+  while (to_free) {
+    fio___task_ring_s *tmp = to_free;
+    to_free = to_free->next;
     FIO___LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
-    FIO_MEM_FREE_(to_free, sizeof(*to_free));
+    FIO_MEM_FREE_(tmp, sizeof(*tmp));
   }
-  return t;
+  return i;
 }
 
 /** Performs a task from the queue. Returns -1 on error (queue empty). */
@@ -503,7 +1244,7 @@ SFUNC int fio_queue_perform(fio_queue_s *q) {
   fio_queue_task_s t = fio_queue_pop(q);
   if (!t.fn)
     return -1;
-  t.fn(t.udata1, t.udata2);
+  fio___queue_task_perform(q, t);
   return 0;
 }
 
@@ -511,25 +1252,116 @@ SFUNC int fio_queue_perform(fio_queue_s *q) {
 SFUNC void fio_queue_perform_all(fio_queue_s *q) {
   fio_queue_task_s t;
   while ((t = fio_queue_pop(q)).fn)
-    t.fn(t.udata1, t.udata2);
+    fio___queue_task_perform(q, t);
+}
+
+/** Performs up to `max` tasks from the queue, popping tasks in batches. */
+SFUNC size_t fio_queue_perform_batch(fio_queue_s *q, size_t max) {
+  fio_queue_task_s tasks[FIO_QUEUE_BATCH];
+  size_t r = 0;
+  while (r < max) {
+    const size_t limit = (max - r) > FIO_QUEUE_BATCH ? FIO_QUEUE_BATCH : max - r;
+    const size_t count = fio_queue_pop_many(q, tasks, limit);
+    for (size_t i = 0; i < count; ++i)
+      fio___queue_task_perform(q, tasks[i]);
+    r += count;
+    if (count < limit)
+      break;
+  }
+  return r;
 }
 
 /* *****************************************************************************
 Queue Consumer Threads
 ***************************************************************************** */
 
+/* returns true if any of the group's worker deques has tasks. */
+FIO_SFUNC int fio___queue_worker_stealable(fio___thread_group_s *grp) {
+  for (size_t i = 0; i < grp->workers; ++i) {
+    if (grp->deques[i].bottom != grp->deques[i].top)
+      return 1;
+  }
+  return 0;
+}
+
+/* returns true if the group's workers have tasks to perform (or should stop) */
+FIO_IFUNC int fio___queue_worker_has_tasks(fio___thread_group_s *grp) {
+  uint32_t count;
+  fio_atomic_load(count, &grp->queue->count);
+  return grp->stop || count ||
+         (grp->deques && fio___queue_worker_stealable(grp));
+}
+
+/*
+ * Waits for new tasks: spins (up to `*spin` times), then parks.
+ *
+ * The spin budget resets when spinning finds a task and halves when it doesn't,
+ * so workers stop spinning when tasks arrive slower than the spin lasts.
+ */
+FIO_SFUNC void fio___queue_worker_idle(fio___thread_group_s *grp,
+                                       size_t *spin) {
+  uint32_t seq;
+  for (size_t i = 0; i < *spin; ++i) {
+    FIO___QUEUE_PAUSE();
+    if (fio___queue_worker_has_tasks(grp)) {
+      *spin = FIO_QUEUE_SPIN;
+      return;
+    }
+  }
+  const size_t spin_min = (FIO_QUEUE_SPIN >> 4);
+  *spin >>= 1;
+  if (*spin < spin_min)
+    *spin = spin_min;
+  /* producers test `idle` after the task was counted (no lost wake-ups) */
+  fio_atomic_load(seq, &grp->queue->wake);
+  fio_atomic_add(&grp->queue->idle, 1);
+  if (!fio___queue_worker_has_tasks(grp))
+    fio___queue_park(grp, seq);
+  fio_atomic_sub(&grp->queue->idle, 1);
+}
+
 FIO_SFUNC void *fio___queue_worker_task(void *g_) {
   fio___thread_group_s *grp = (fio___thread_group_s *)g_;
+  size_t spin = FIO_QUEUE_SPIN;
   while (!grp->stop) {
     fio_queue_perform_all(grp->queue);
-    fio_thread_mutex_lock(&grp->mutex);
-    if (!grp->stop)
-      fio_thread_cond_wait(&grp->cond, &grp->mutex);
-    fio_thread_mutex_unlock(&grp->mutex);
-    fio_queue_perform_all(grp->queue);
+    fio___queue_worker_idle(grp, &spin);
+  }
+  return NULL;
+}
+
+/* the next task: local (LIFO), then the shared queue, then stolen (FIFO). */
+FIO_SFUNC fio_queue_task_s fio___queue_worker_next(fio___queue_worker_s *w) {
+  fio___thread_group_s *grp = w->grp;
+  fio_queue_task_s t = fio___queue_worker_pop(w);
+  if (t.fn)
+    return t;
+  t = fio_queue_pop(grp->queue);
+  for (size_t i = 1; !t.fn && i < grp->workers; ++i)
+    t = fio___queue_worker_steal(grp->deques + ((w->index + i) % grp->workers));
+  return t;
+}
+
+FIO_SFUNC void *fio___queue_worker_steal_task(void *w_) {
+  fio___queue_worker_s *w = (fio___queue_worker_s *)w_;
+  fio___thread_group_s *grp = w->grp;
+  fio_queue_task_s t;
+  size_t spin = FIO_QUEUE_SPIN;
+  fio___queue_worker_current = w;
+  while (!grp->stop) {
+    if ((t = fio___queue_worker_next(w)).fn) {
+      fio___queue_task_perform(grp->queue, t);
+      continue;
+    }
+    fio___queue_worker_idle(grp, &spin);
   }
+  /* local tasks are never lost (these may push more local tasks) */
+  while ((t = fio___queue_worker_pop(w)).fn)
+    fio___queue_task_perform(grp->queue, t);
+  fio___queue_worker_current = NULL;
   return NULL;
 }
+
 FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   fio_thread_t threads_buf[256];
   fio___thread_group_s grp = *(fio___thread_group_s *)g_;
@@ -542,7 +1374,21 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
           : threads_buf;
   fio_thread_mutex_init(&grp.mutex);
   fio_thread_cond_init(&grp.cond);
+  if (grp.deques) {
+    grp.deques = (fio___queue_worker_s *)
+        FIO_MEM_REALLOC_(NULL, 0, sizeof(*grp.deques) * grp.workers, 0);
+    if (!grp.deques)
+      FIO_LOG_ERROR("No memory for work-stealing deques, using a shared queue");
+    for (size_t i = 0; grp.deques && i < grp.workers; ++i)
+      grp.deques[i] = (fio___queue_worker_s){.grp = &grp, .index = i};
+  }
   for (size_t i = 0; i < grp.workers; ++i) {
+    if (grp.deques) {
+      fio_thread_create(threads + i,
+                        fio___queue_worker_steal_task,
+                        (void *)(grp.deques + i));
+      continue;
+    }
     fio_thread_create(threads + i, fio___queue_worker_task, (void *)&grp);
   }
   ((fio___thread_group_s *)g_)->stop = 0;
@@ -552,6 +1398,8 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   }
   if (threads != threads_buf)
     FIO_MEM_FREE_(threads, sizeof(*threads) * grp.workers);
+  if (grp.deques)
+    FIO_MEM_FREE_(grp.deques, sizeof(*grp.deques) * grp.workers);
   FIO___LOCK_LOCK(grp.queue->lock);
   FIO_LIST_REMOVE(&grp.node);
   FIO___LOCK_UNLOCK(grp.queue->lock);
@@ -559,41 +1407,51 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   return NULL;
 }
 
-SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
+FIO_SFUNC int fio___queue_workers_add(fio_queue_s *q,
+                                      size_t workers,
+                                      int stealing) {
   FIO___LOCK_LOCK(q->lock);
   if (!q->consumers.next || !q->consumers.prev) {
     q->consumers = FIO_LIST_INIT(q->consumers);
   }
   fio___thread_group_s grp = {.queue = q, .workers = workers, .stop = 1};
-  if (fio_thread_create(&grp.thread, fio___queue_worker_manager, &grp))
+  /* a non-NULL value marks the group, the manager allocates the deques */
+  if (stealing)
+    grp.deques = (fio___queue_worker_s *)&grp;
+  if (fio_thread_create(&grp.thread, fio___queue_worker_manager, &grp)) {
+    FIO___LOCK_UNLOCK(q->lock);
     return -1;
+  }
   while (grp.stop)
     FIO_THREAD_RESCHEDULE();
   FIO___LOCK_UNLOCK(q->lock);
   return 0;
 }
 
+SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
+  return fio___queue_workers_add(q, workers, 0);
+}
+
+SFUNC int fio_queue_workers_add_stealing(fio_queue_s *q, size_t workers) {
+  return fio___queue_workers_add(q, workers, 1);
+}
+
 SFUNC void fio_queue_workers_stop(fio_queue_s *q) {
   if (FIO_LIST_IS_EMPTY(&q->consumers))
     return;
   FIO___LOCK_LOCK(q->lock);
   FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
     pos->stop = 1;
-    for (size_t i = 0; i < pos->workers * 2; ++i)
-      fio_thread_cond_signal(&pos->cond);
   }
   FIO___LOCK_UNLOCK(q->lock);
+  fio___queue_wake(q, (uint32_t)-1);
 }
 
 /** Signals all worker threads to go back to work (new tasks were). */
 SFUNC void fio_queue_workers_wake(fio_queue_s *q) {
   if (FIO_LIST_IS_EMPTY(&q->consumers))
     return;
-  FIO___LOCK_LOCK(q->lock);
-  FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
-    fio_thread_cond_signal(&pos->cond);
-  }
-  FIO___LOCK_UNLOCK(q->lock);
+  fio___queue_wake(q, (uint32_t)-1);
 }
 
 /** Signals all worker threads to stop, waiting for them to complete. */
@@ -613,27 +1471,90 @@ Timer Queue Implementation
 ***************************************************************************** */
 FIO___LEAK_COUNTER_DEF(fio___timer_event_s)
 
-FIO_IFUNC void fio___timer_insert(fio___timer_event_s **pos,
-                                  fio___timer_event_s *e) {
-  while (*pos && e->due >= (*pos)->due)
-    pos = &((*pos)->next);
-  e->next = *pos;
-  *pos = e;
+#if FIO_USE_POOL
+/* timer events are allocated from an object pool */
+FIO___POOL_DEF(fio___timer_pool, sizeof(fio___timer_event_s), 32)
+#endif
+
+/* *****************************************************************************
+Hierarchical Timing Wheel
+
+Level `n` slots hold events whose due time shares all bits above bit `6n + 6`
+with the wheel's position (`at`), indexed by bits `6n` to `6n + 5` of the due
+time. Overdue events are placed in the current level 0 slot.
+
+When the wheel's position enters a slot of a higher level, its events are
+cascaded (re-added) to lower levels. Insertion and cascading are O(1) per event.
+***************************************************************************** */
+
+/* adds an event to the wheel (call within the lock). */
+FIO_IFUNC void fio___timer_add(fio_timer_queue_s *tq, fio___timer_event_s *e) {
+  uint64_t due = (uint64_t)(e->due < tq->at ? tq->at : e->due);
+  uint64_t dif = due ^ (uint64_t)tq->at;
+  size_t level = dif ? (fio_msb_index_unsafe(dif) / 6) : 0;
+  if (level >= FIO___TIMER_LEVELS) {
+    e->next = tq->overflow;
+    tq->overflow = e;
+    return;
+  }
+  const size_t slot = (size_t)(due >> (level * 6)) & 63;
+  e->next = tq->slots[level][slot];
+  tq->slots[level][slot] = e;
+  tq->map[level] |= (uint64_t)1 << slot;
 }
 
-FIO_IFUNC fio___timer_event_s *fio___timer_pop(fio___timer_event_s **pos,
-                                               int64_t due) {
-  if (!*pos || (*pos)->due > due)
-    return NULL;
-  fio___timer_event_s *t = *pos;
-  *pos = t->next;
-  return t;
+/* detaches the events in a slot (call within the lock). */
+FIO_IFUNC fio___timer_event_s *fio___timer_take(fio_timer_queue_s *tq,
+                                                size_t level,
+                                                size_t slot) {
+  fio___timer_event_s *list = tq->slots[level][slot];
+  tq->slots[level][slot] = NULL;
+  tq->map[level] &= ~((uint64_t)1 << slot);
+  return list;
+}
+
+/* re-adds a list of events (call within the lock). */
+FIO_IFUNC void fio___timer_readd(fio_timer_queue_s *tq,
+                                 fio___timer_event_s *list) {
+  while (list) {
+    fio___timer_event_s *e = list;
+    list = list->next;
+    fio___timer_add(tq, e);
+  }
+}
+
+/* moves the wheel's position forward (call within the lock). */
+FIO_IFUNC void fio___timer_move(fio_timer_queue_s *tq, int64_t to) {
+  const uint64_t old = (uint64_t)tq->at;
+  if (to <= tq->at)
+    return;
+  tq->at = to;
+  /* events in the overflow list may now fit in the wheel */
+  if (tq->overflow && ((old ^ (uint64_t)to) >> (FIO___TIMER_LEVELS * 6))) {
+    fio___timer_event_s *list = tq->overflow;
+    tq->overflow = NULL;
+    fio___timer_readd(tq, list);
+  }
+}
+
+/* returns the earliest due time in a list of events. */
+FIO_IFUNC int64_t fio___timer_list_min(fio___timer_event_s *list) {
+  int64_t r = list->due;
+  for (list = list->next; list; list = list->next)
+    if (list->due < r)
+      r = list->due;
+  return r;
 }
 
 FIO_IFUNC fio___timer_event_s *fio___timer_event_new(
     fio_timer_schedule_args_s args) {
   fio___timer_event_s *t = NULL;
+#if FIO_USE_POOL
+  t = (fio___timer_event_s *)fio___pool_alloc(&fio___timer_pool,
+                                              &fio___timer_pool___mag);
+#else
   t = (fio___timer_event_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*t), 0);
+#endif
   if (!t)
     goto init_error;
   FIO___LEAK_COUNTER_ON_ALLOC(fio___timer_event_s);
@@ -659,14 +1580,19 @@ FIO_IFUNC void fio___timer_event_free(fio_timer_queue_s *tq,
                                       fio___timer_event_s *t) {
   if (tq && (t->repetitions < 0 || fio_atomic_sub_fetch(&t->repetitions, 1))) {
     FIO___LOCK_LOCK(tq->lock);
-    fio___timer_insert(&tq->next, t);
+    ++tq->count;
+    fio___timer_add(tq, t);
     FIO___LOCK_UNLOCK(tq->lock);
     return;
   }
   if (t->on_finish)
     t->on_finish(t->udata1, t->udata2);
   FIO___LEAK_COUNTER_ON_FREE(fio___timer_event_s);
+#if FIO_USE_POOL
+  fio___pool_free(&fio___timer_pool, &fio___timer_pool___mag, (void *)t);
+#else
   FIO_MEM_FREE_(t, sizeof(*t));
+#endif
 }
 
 FIO_SFUNC void fio___timer_perform(void *timer_, void *t_) {
@@ -685,16 +1611,62 @@ SFUNC size_t fio_timer_push2queue(fio_queue_s *queue,
   size_t r = 0;
   if (!start_at)
     start_at = fio_time_milli();
-  if (FIO___LOCK_TRYLOCK(timer->lock))
+  if (!timer->count || FIO___LOCK_TRYLOCK(timer->lock))
     return 0;
-  fio___timer_event_s *t;
-  while ((t = fio___timer_pop(&timer->next, start_at))) {
-    fio_queue_push(queue,
-                   .fn = fio___timer_perform,
-                   .udata1 = timer,
-                   .udata2 = t);
-    ++r;
+  while (timer->count) {
+    const uint64_t at = (uint64_t)timer->at;
+    size_t level;
+    /* cascade the slots the wheel's position entered (top down) */
+    for (level = FIO___TIMER_LEVELS - 1; level; --level) {
+      const size_t slot = (size_t)(at >> (level * 6)) & 63;
+      if ((timer->map[level] >> slot) & 1)
+        fio___timer_readd(timer, fio___timer_take(timer, level, slot));
+    }
+    /* perform due events in the current level 0 block */
+    uint64_t map = timer->map[0] & (~(uint64_t)0 << (at & 63));
+    if (map) {
+      const size_t slot = fio_lsb_index_unsafe(map);
+      const int64_t due = (int64_t)((at & ~(uint64_t)63) | slot);
+      if (due > start_at)
+        break;
+      fio___timer_move(timer, due);
+      fio___timer_event_s *t = fio___timer_take(timer, 0, slot), *tmp = NULL;
+      while (t) { /* reverse the list, events are performed FIFO */
+        fio___timer_event_s *next = t->next;
+        t->next = tmp;
+        tmp = t;
+        t = next;
+      }
+      for (t = tmp; t; t = tmp) {
+        tmp = t->next;
+        fio_queue_push(queue,
+                       .fn = fio___timer_perform,
+                       .udata1 = timer,
+                       .udata2 = t);
+        --timer->count;
+        ++r;
+      }
+      continue;
+    }
+    /* jump to the next occupied slot (or to the next overflow block) */
+    int64_t next = -1;
+    for (level = 1; level < FIO___TIMER_LEVELS; ++level) {
+      const size_t shift = level * 6;
+      map = timer->map[level] & (~(uint64_t)0 << ((at >> shift) & 63));
+      if (!map)
+        continue;
+      next = (int64_t)(((at >> (shift + 6)) << (shift + 6)) |
+                       ((uint64_t)fio_lsb_index_unsafe(map) << shift));
+      break;
+    }
+    if (next == -1)
+      next = (int64_t)(((at >> (FIO___TIMER_LEVELS * 6)) + 1)
+                       << (FIO___TIMER_LEVELS * 6));
+    if (next > start_at)
+      break;
+    fio___timer_move(timer, next);
   }
+  fio___timer_move(timer, start_at);
   FIO___LOCK_UNLOCK(timer->lock);
   return r;
 }
@@ -712,7 +1684,11 @@ SFUNC void fio_timer_schedule FIO_NOOP(fio_timer_queue_s *timer,
   if (!t)
     return;
   FIO___LOCK_LOCK(timer->lock);
-  fio___timer_insert(&timer->next, t);
+  /* a new (or empty) wheel may start earlier, when the timer starts */
+  if (!timer->at || (!timer->count && args.start_at < timer->at))
+    timer->at = args.start_at;
+  ++timer->count;
+  fio___timer_add(timer, t);
   FIO___LOCK_UNLOCK(timer->lock);
   return;
 no_timer_queue:
@@ -733,10 +1709,32 @@ no_timer_queue:
  * they repeat).
  */
 SFUNC void fio_timer_destroy(fio_timer_queue_s *tq) {
-  fio___timer_event_s *next;
+  fio___timer_event_s *next = NULL;
   FIO___LOCK_LOCK(tq->lock);
-  next = tq->next;
-  tq->next = NULL;
+  /* collect all events into a single list */
+  for (size_t level = 0; level < FIO___TIMER_LEVELS; ++level) {
+    while (tq->map[level]) {
+      fio___timer_event_s *list = fio___timer_take(
+          tq,
+          level,
+          fio_lsb_index_unsafe(tq->map[level]));
+      fio___timer_event_s *last = list;
+      while (last->next)
+        last = last->next;
+      last->next = next;
+      next = list;
+    }
+  }
+  if (tq->overflow) {
+    fio___timer_event_s *last = tq->overflow;
+    while (last->next)
+      last = last->next;
+    last->next = next;
+    next = tq->overflow;
+    tq->overflow = NULL;
+  }
+  tq->count = 0;
+  tq->at = 0;
   FIO___LOCK_UNLOCK(tq->lock);
   FIO___LOCK_DESTROY(tq->lock);
   while (next) {
@@ -746,6 +1744,44 @@ SFUNC void fio_timer_destroy(fio_timer_queue_s *tq) {
     fio___timer_event_free(NULL, tmp);
   }
 }
+
+/*
+ * Returns the millisecond at which the next event should occur.
+ *
+ * If no timer is due (list is empty), returns `-1`.
+ *
+ * NOTE: unless manually specified, millisecond timers are relative to
+ * `fio_time_milli()`.
+ */
+SFUNC int64_t fio_timer_next_at(fio_timer_queue_s *tq) {
+  int64_t v = -1;
+  if (!tq)
+    goto missing_tq;
+  if (!tq->count)
+    return v;
+  FIO___LOCK_LOCK(tq->lock);
+  /* the first occupied slot of each level holds that level's earliest event */
+  for (size_t level = 0; level < FIO___TIMER_LEVELS; ++level) {
+    const size_t shift = level * 6;
+    const uint64_t map =
+        tq->map[level] & (~(uint64_t)0 << (((uint64_t)tq->at >> shift) & 63));
+    if (!map)
+      continue;
+    const int64_t due = fio___timer_list_min(
+        tq->slots[level][fio_lsb_index_unsafe(map)]);
+    if (v == -1 || due < v)
+      v = due;
+  }
+  /* overflow events are always later than events in the wheel */
+  if (v == -1 && tq->overflow)
+    v = fio___timer_list_min(tq->overflow);
+  FIO___LOCK_UNLOCK(tq->lock);
+  return v;
+
+missing_tq:
+  FIO_LOG_ERROR("`fio_timer_next_at` called with a NULL timer queue!");
+  return v;
+}
 /* *****************************************************************************
 Queue/Timer Cleanup
 ***************************************************************************** */
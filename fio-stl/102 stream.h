@@ -18,6 +18,15 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #if defined(FIO_STREAM) && !defined(H___FIO_STREAM___H)
 #define H___FIO_STREAM___H
 #include <sys/stat.h>
+#if FIO_OS_POSIX
+#include <sys/uio.h>
+#else
+/** A POSIX style `iovec` (used by `fio_stream_read_iov`). */
+struct iovec {
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
 
 #ifndef FIO_STREAM_COPY_PER_PACKET
 /** Break apart large memory blocks into smaller pieces. by default 96Kb */
@@ -115,6 +124,23 @@ Stream API - Consuming the stream
  */
 SFUNC void fio_stream_read(fio_stream_s *stream, char **buf, size_t *len);
 
+/**
+ * Exports the stream's leading data as an `iovec` array, leaving it in the
+ * stream.
+ *
+ * The `iovec` entries point directly to the packets' memory (no copy), so they
+ * are only valid until the stream is advanced or destroyed.
+ *
+ * Sets up to `max` entries and returns the number of entries set. File packets
+ * can't be exported, so the export stops at the first file packet (use
+ * `fio_stream_read` when 0 is returned for a non-empty stream).
+ *
+ * Note: this isn't thread safe.
+ */
+SFUNC size_t fio_stream_read_iov(fio_stream_s *stream,
+                                 struct iovec *iov,
+                                 size_t max);
+
 /**
  * Advances the Stream, so the first `len` bytes are marked as consumed.
  *
@@ -239,6 +265,33 @@ typedef struct {
   int fd;
 } fio_stream_packet_fd_s;
 
+#if FIO_USE_POOL
+/* fixed size packets and small embedded packets are allocated from a pool */
+#define FIO___STREAM_POOL_SLOT 128
+FIO___POOL_DEF(fio___stream_pool, FIO___STREAM_POOL_SLOT, 32)
+#endif
+
+FIO_IFUNC fio_stream_packet_s *fio___stream_packet_alloc(size_t size) {
+#if FIO_USE_POOL
+  if (size <= FIO___STREAM_POOL_SLOT)
+    return (fio_stream_packet_s *)fio___pool_alloc(&fio___stream_pool,
+                                                   &fio___stream_pool___mag);
+#endif
+  return (fio_stream_packet_s *)FIO_MEM_REALLOC_(NULL, 0, size, 0);
+}
+
+FIO_IFUNC void fio___stream_packet_dealloc(fio_stream_packet_s *p,
+                                           size_t size) {
+#if FIO_USE_POOL
+  if (size <= FIO___STREAM_POOL_SLOT) {
+    fio___pool_free(&fio___stream_pool, &fio___stream_pool___mag, (void *)p);
+    return;
+  }
+#endif
+  FIO_MEM_FREE_(p, size);
+  (void)size;
+}
+
 FIO_SFUNC void fio_stream_packet_free(fio_stream_packet_s *p) {
   if (!p)
     return;
@@ -250,12 +303,12 @@ FIO_SFUNC void fio_stream_packet_free(fio_stream_packet_s *p) {
   } const u = {.em = (fio_stream_packet_embd_s *)(p + 1)};
   switch (u.em->type) {
   case FIO_PACKET_TYPE_EMBEDDED:
-    FIO_MEM_FREE_(p, sizeof(*p) + sizeof(*u.em) + u.em->length);
+    fio___stream_packet_dealloc(p, sizeof(*p) + sizeof(*u.em) + u.em->length);
     break;
   case FIO_PACKET_TYPE_EXTERNAL:
     if (u.ext->dealloc)
       u.ext->dealloc(u.ext->buf);
-    FIO_MEM_FREE_(p, sizeof(*p) + sizeof(*u.ext));
+    fio___stream_packet_dealloc(p, sizeof(*p) + sizeof(*u.ext));
     break;
   case FIO_PACKET_TYPE_FILE: close(u.f->fd);
 #ifdef DEBUG
@@ -263,7 +316,7 @@ FIO_SFUNC void fio_stream_packet_free(fio_stream_packet_s *p) {
 #endif
     /* fall through */
   case FIO_PACKET_TYPE_FILE_NO_CLOSE:
-    FIO_MEM_FREE_(p, sizeof(*p) + sizeof(*u.f));
+    fio___stream_packet_dealloc(p, sizeof(*p) + sizeof(*u.f));
     break;
   }
 }
@@ -311,11 +364,8 @@ SFUNC fio_stream_packet_s *fio_stream_pack_data(void *buf,
       const size_t slice =
           (len > FIO_STREAM_COPY_PER_PACKET) ? FIO_STREAM_COPY_PER_PACKET : len;
       fio_stream_packet_embd_s *em;
-      fio_stream_packet_s *tmp = (fio_stream_packet_s *)FIO_MEM_REALLOC_(
-          NULL,
-          0,
-          sizeof(*p) + sizeof(*em) + (sizeof(char) * slice),
-          0);
+      fio_stream_packet_s *tmp = fio___stream_packet_alloc(
+          sizeof(*p) + sizeof(*em) + (sizeof(char) * slice));
       if (!tmp)
         goto error;
       FIO___LEAK_COUNTER_ON_ALLOC(fio_stream_packet_s);
@@ -331,8 +381,7 @@ SFUNC fio_stream_packet_s *fio_stream_pack_data(void *buf,
       dealloc_func(buf);
   } else {
     fio_stream_packet_extrn_s *ext;
-    p = (fio_stream_packet_s *)
-        FIO_MEM_REALLOC_(NULL, 0, sizeof(*p) + sizeof(*ext), 0);
+    p = fio___stream_packet_alloc(sizeof(*p) + sizeof(*ext));
     if (!p)
       goto error;
     FIO___LEAK_COUNTER_ON_ALLOC(fio_stream_packet_s);
@@ -373,8 +422,7 @@ SFUNC fio_stream_packet_s *fio_stream_pack_fd(int fd,
     len -= offset;
   }
 
-  p = (fio_stream_packet_s *)
-      FIO_MEM_REALLOC_(NULL, 0, sizeof(*p) + sizeof(*f), 0);
+  p = fio___stream_packet_alloc(sizeof(*p) + sizeof(*f));
   if (!p)
     goto error;
   FIO___LEAK_COUNTER_ON_ALLOC(fio_stream_packet_s);
@@ -562,6 +610,37 @@ none:
   *len = 0;
 }
 
+/** Exports the stream's leading data as an `iovec` array (no copy). */
+SFUNC size_t fio_stream_read_iov(fio_stream_s *s,
+                                 struct iovec *iov,
+                                 size_t max) {
+  size_t count = 0;
+  if (!s || !iov)
+    return count;
+  size_t offset = s->consumed;
+  for (fio_stream_packet_s *p = s->next; p && count < max; p = p->next) {
+    union {
+      fio_stream_packet_embd_s *em;
+      fio_stream_packet_extrn_s *ext;
+    } const u = {.em = (fio_stream_packet_embd_s *)(p + 1)};
+    switch (u.em->type) {
+    case FIO_PACKET_TYPE_EMBEDDED:
+      iov[count].iov_base = (void *)(u.em->buf + offset);
+      iov[count].iov_len = (size_t)u.em->length - offset;
+      break;
+    case FIO_PACKET_TYPE_EXTERNAL:
+      iov[count].iov_base = (void *)(u.ext->buf + u.ext->offset + offset);
+      iov[count].iov_len = u.ext->length - offset;
+      break;
+    case FIO_PACKET_TYPE_FILE: /* fall through */
+    case FIO_PACKET_TYPE_FILE_NO_CLOSE: return count; /* requires a copy */
+    }
+    ++count;
+    offset = 0;
+  }
+  return count;
+}
+
 /**
  * Advances the Stream, so the first `len` bytes are marked as consumed.
  *
@@ -598,5 +677,6 @@ Cleanup
 ***************************************************************************** */
 #endif /* FIO_EXTERN_COMPLETE */
 #undef FIO_STREAM___TYPE_BITS
+#undef FIO___STREAM_POOL_SLOT
 #endif /* FIO_STREAM */
 #undef FIO_STREAM
@@ -22,10 +22,27 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #define FIO_REF_TYPE FIO_NAME(FIO_REF_NAME, s)
 #endif
 
+/*
+ * FIO_REF_POOL allocates objects from an object pool (see FIO_POOL_NAME). Set
+ * it to the number of objects to allocate when the program starts (or 0).
+ *
+ * For flexible types, objects with up to FIO_REF_POOL_FLEX members are pooled,
+ * larger objects are allocated normally.
+ */
+#ifdef FIO_REF_POOL
+#ifndef FIO_REF_POOL_FLEX
+#define FIO_REF_POOL_FLEX 0
+#endif
+/* pooled objects are never initialized by the allocator */
+#define FIO___REF_MEM_IS_SAFE 0
+#else
+#define FIO___REF_MEM_IS_SAFE FIO_MEM_REALLOC_IS_SAFE_
+#endif
+
 #ifndef FIO_REF_INIT
 #define FIO_REF_INIT(obj)                                                      \
   do {                                                                         \
-    if (!FIO_MEM_REALLOC_IS_SAFE_)                                             \
+    if (!FIO___REF_MEM_IS_SAFE)                                                \
       (obj) = (FIO_REF_TYPE){0};                                               \
   } while (0)
 #endif
@@ -38,7 +55,7 @@ Copyright and License: see header file (000 copyright.h) or top of file
 #ifdef FIO_REF_METADATA
 #define FIO_REF_METADATA_INIT(meta)                                            \
   do {                                                                         \
-    if (!FIO_MEM_REALLOC_IS_SAFE_)                                             \
+    if (!FIO___REF_MEM_IS_SAFE)                                                \
       (meta) = (FIO_REF_METADATA){0};                                          \
   } while (0)
 #else
@@ -70,6 +87,9 @@ Copyright and License: see header file (000 copyright.h) or top of file
 
 typedef struct {
   volatile size_t ref;
+#if defined(FIO_REF_POOL) && defined(FIO_REF_FLEX_TYPE)
+  size_t pooled;
+#endif
 #ifdef FIO_REF_METADATA
   FIO_REF_METADATA metadata;
 #endif
@@ -138,10 +158,49 @@ Reference Counter (Wrapper) Implementation
 
 FIO___LEAK_COUNTER_DEF(FIO_REF_NAME)
 
+#ifdef FIO_REF_POOL
+#ifdef FIO_REF_FLEX_TYPE
+FIO___POOL_DEF(FIO_NAME(FIO_REF_NAME, __pool),
+               (sizeof(FIO_NAME(FIO_REF_NAME, _wrapper_s)) +
+                sizeof(FIO_REF_TYPE) +
+                (sizeof(FIO_REF_FLEX_TYPE) * FIO_REF_POOL_FLEX)),
+               32)
+#else
+FIO___POOL_DEF(FIO_NAME(FIO_REF_NAME, __pool),
+               (sizeof(FIO_NAME(FIO_REF_NAME, _wrapper_s)) +
+                sizeof(FIO_REF_TYPE)),
+               32)
+#endif /* FIO_REF_FLEX_TYPE */
+#if (FIO_REF_POOL + 0) > 0
+/* pre-warms the object pool when the program starts */
+FIO_CONSTRUCTOR(FIO_NAME(FIO_REF_NAME, __pool_warmup)) {
+  fio___pool_warmup(&FIO_NAME(FIO_REF_NAME, __pool), FIO_REF_POOL);
+}
+#endif
+#define FIO___REF_POOL_ALLOC()                                                 \
+  fio___pool_alloc(&FIO_NAME(FIO_REF_NAME, __pool),                            \
+                   &FIO_NAME(FIO_NAME(FIO_REF_NAME, __pool), __mag))
+#define FIO___REF_POOL_FREE(o)                                                 \
+  fio___pool_free(&FIO_NAME(FIO_REF_NAME, __pool),                             \
+                  &FIO_NAME(FIO_NAME(FIO_REF_NAME, __pool), __mag),            \
+                  (void *)(o))
+#endif /* FIO_REF_POOL */
+
 /** Allocates a reference counted object. */
 #ifdef FIO_REF_FLEX_TYPE
 IFUNC FIO_REF_TYPE_PTR FIO_NAME(FIO_REF_NAME,
                                 FIO_REF_CONSTRUCTOR)(size_t members) {
+#ifdef FIO_REF_POOL
+  FIO_NAME(FIO_REF_NAME, _wrapper_s) *o =
+      (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)(
+          (members <= FIO_REF_POOL_FLEX)
+              ? FIO___REF_POOL_ALLOC()
+              : FIO_MEM_REALLOC_(NULL,
+                                 0,
+                                 sizeof(*o) + sizeof(FIO_REF_TYPE) +
+                                     (sizeof(FIO_REF_FLEX_TYPE) * members),
+                                 0));
+#else
   FIO_NAME(FIO_REF_NAME, _wrapper_s) *o =
       (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)FIO_MEM_REALLOC_(
           NULL,
@@ -149,14 +208,23 @@ IFUNC FIO_REF_TYPE_PTR FIO_NAME(FIO_REF_NAME,
           sizeof(*o) + sizeof(FIO_REF_TYPE) +
               (sizeof(FIO_REF_FLEX_TYPE) * members),
           0);
+#endif /* FIO_REF_POOL */
 #else
 IFUNC FIO_REF_TYPE_PTR FIO_NAME(FIO_REF_NAME, FIO_REF_CONSTRUCTOR)(void) {
+#ifdef FIO_REF_POOL
+  FIO_NAME(FIO_REF_NAME, _wrapper_s) *o =
+      (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)FIO___REF_POOL_ALLOC();
+#else
   FIO_NAME(FIO_REF_NAME, _wrapper_s) *o = (FIO_NAME(FIO_REF_NAME, _wrapper_s) *)
       FIO_MEM_REALLOC_(NULL, 0, sizeof(*o) + sizeof(FIO_REF_TYPE), 0);
+#endif /* FIO_REF_POOL */
 #endif /* FIO_REF_FLEX_TYPE */
   if (!o)
     return (FIO_REF_TYPE_PTR)(o);
   FIO___LEAK_COUNTER_ON_ALLOC(FIO_REF_NAME);
+#if defined(FIO_REF_POOL) && defined(FIO_REF_FLEX_TYPE)
+  o->pooled = (members <= FIO_REF_POOL_FLEX);
+#endif
   o->ref = 1;
   FIO_REF_METADATA_INIT((o->metadata));
   FIO_REF_TYPE *ret = (FIO_REF_TYPE *)(o + 1);
@@ -181,7 +249,17 @@ IFUNC void FIO_NAME(FIO_REF_NAME,
   FIO_REF_DESTROY((wrapped[0]));
   FIO_REF_METADATA_DESTROY((o->metadata));
   FIO___LEAK_COUNTER_ON_FREE(FIO_REF_NAME);
+#ifdef FIO_REF_POOL
+#ifdef FIO_REF_FLEX_TYPE
+  if (!o->pooled) {
+    FIO_MEM_FREE_(o, sizeof(*o) + sizeof(FIO_REF_TYPE));
+    return;
+  }
+#endif /* FIO_REF_FLEX_TYPE */
+  FIO___REF_POOL_FREE(o);
+#else
   FIO_MEM_FREE_(o, sizeof(*o) + sizeof(FIO_REF_TYPE));
+#endif /* FIO_REF_POOL */
 }
 
 #ifdef FIO_REF_METADATA
@@ -199,8 +277,13 @@ IFUNC FIO_REF_METADATA *FIO_NAME(FIO_REF_NAME,
 Reference Counter (Wrapper) Cleanup
 ***************************************************************************** */
 
+#undef FIO___REF_POOL_ALLOC
+#undef FIO___REF_POOL_FREE
 #endif /* FIO_EXTERN_COMPLETE */
 #undef FIO_REF_NAME
+#undef FIO_REF_POOL
+#undef FIO_REF_POOL_FLEX
+#undef FIO___REF_MEM_IS_SAFE
 #undef FIO_REF_FLEX_TYPE
 #undef FIO_REF_TYPE
 #undef FIO_REF_INIT
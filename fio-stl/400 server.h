@@ -30,6 +30,11 @@ developer.
 #define FIO_SRV_BUFFER_PER_WRITE 65536U
 #endif
 
+#ifndef FIO_SRV_IOV_PER_WRITE
+/** The maximum number of buffers sent by a single vectored (`writev`) call. */
+#define FIO_SRV_IOV_PER_WRITE 64
+#endif
+
 #ifndef FIO_SRV_THROTTLE_LIMIT
 /** IO will be throttled (no `on_data` events) if outgoing buffer is large. */
 #define FIO_SRV_THROTTLE_LIMIT 2097152U
@@ -45,6 +50,26 @@ developer.
 #define FIO_SRV_SHUTDOWN_TIMEOUT 10000
 #endif
 
+#ifndef FIO_SRV_TICK_BUDGET
+/** The time (in microseconds) a reactor cycle may spend performing tasks. */
+#define FIO_SRV_TICK_BUDGET 4000
+#endif
+
+#ifndef FIO_SRV_LANE_WEIGHTS
+/** Tasks performed per scheduling round: IO, timers, user, background. */
+#define FIO_SRV_LANE_WEIGHTS {16, 8, 8, 1}
+#endif
+
+#ifndef FIO_SRV_BUSY_POLL
+/** The time (in microseconds) the reactor polls before blocking (0 = off). */
+#define FIO_SRV_BUSY_POLL 0
+#endif
+
+#ifndef FIO_SRV_THREADS
+/** The number of reactor threads per process (see `fio_srv_threads_set`). */
+#define FIO_SRV_THREADS 1
+#endif
+
 /* *****************************************************************************
 IO Types
 ***************************************************************************** */
@@ -92,6 +117,37 @@ SFUNC int fio_srv_pid(void);
 /** Returns the root / master process id. */
 SFUNC int fio_srv_root_pid(void);
 
+/**
+ * Sets the busy-poll window (in microseconds), 0 disables busy polling.
+ *
+ * The reactor keeps polling for IO events (without blocking) until the window
+ * passes since the last IO event or task, trading CPU time for latency.
+ *
+ * Accepted sockets are marked with `SO_BUSY_POLL` / `SO_PREFER_BUSY_POLL`.
+ */
+SFUNC void fio_srv_busy_poll_set(uint32_t window_us);
+
+/** Returns the busy-poll window (in microseconds), 0 if disabled. */
+SFUNC uint32_t fio_srv_busy_poll_get(void);
+
+/**
+ * Sets the number of reactor threads each (worker) process runs.
+ *
+ * Each reactor thread polls its own IO, performs its own task lanes and runs
+ * its own timers. Negative values are a fraction of the CPU cores (as with
+ * `fio_srv_workers`).
+ *
+ * Must be called before `fio_srv_start` (and before `fio_srv_listen`, so
+ * listening sockets could use `SO_REUSEPORT`).
+ */
+SFUNC void fio_srv_threads_set(int threads);
+
+/** Returns the number of reactor threads each (worker) process runs. */
+SFUNC uint16_t fio_srv_threads(void);
+
+/** Returns the calling reactor thread's index (0 = main) or -1 if none. */
+SFUNC int fio_srv_thread(void);
+
 /* *****************************************************************************
 Listening to Incoming Connections
 ***************************************************************************** */
@@ -382,11 +438,50 @@ SFUNC int fio_srv_is_open(fio_s *io);
 Task Scheduling
 ***************************************************************************** */
 
-/** Schedules a task for delayed execution. This function is thread-safe. */
+/** Server task lanes, performed using weighted fair scheduling. */
+typedef enum {
+  /** IO events (`on_data`, `on_ready`, `on_close`). */
+  FIO_SRV_LANE_IO = 0,
+  /** Timer bound tasks (`fio_srv_run_every`). */
+  FIO_SRV_LANE_TIMER = 1,
+  /** Deferred tasks (`fio_srv_defer`), the default lane. */
+  FIO_SRV_LANE_USER = 2,
+  /** Background / maintenance tasks (i.e., IO timeout reviews). */
+  FIO_SRV_LANE_BACKGROUND = 3,
+} fio_srv_lane_e;
+
+/**
+ * Schedules a task for delayed execution by the calling reactor thread (or the
+ * main reactor thread, if called from any other thread).
+ *
+ * This function is thread-safe.
+ */
 SFUNC void fio_srv_defer(void (*task)(void *, void *),
                          void *udata1,
                          void *udata2);
 
+/**
+ * Schedules a task for delayed execution by the main reactor thread.
+ *
+ * Tasks that manage state shared by all the reactor threads should be
+ * performed by the main reactor thread.
+ *
+ * This function is thread-safe.
+ */
+SFUNC void fio_srv_defer_main(void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2);
+
+/**
+ * Schedules a task for delayed execution in a specific task lane.
+ *
+ * This function is thread-safe.
+ */
+SFUNC void fio_srv_defer_lane(fio_srv_lane_e lane,
+                              void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2);
+
 /** Schedules a timer bound task, see `fio_timer_schedule`. */
 SFUNC void fio_srv_run_every(fio_timer_schedule_args_s args);
 /**
@@ -413,9 +508,12 @@ SFUNC void fio_srv_run_every(fio_timer_schedule_args_s args);
 /** Returns the last millisecond when the server reviewed pending IO events. */
 SFUNC int64_t fio_srv_last_tick(void);
 
-/** Returns a pointer for the server's queue. */
+/** Returns a pointer for the reactor's queue (the user lane). */
 SFUNC fio_queue_s *fio_srv_queue(void);
 
+/** Returns a pointer for the queue of a reactor's task lane. */
+SFUNC fio_queue_s *fio_srv_lane(fio_srv_lane_e lane);
+
 /**************************************************************************/ /**
 Protocol IO Functions
 ============
@@ -438,6 +536,15 @@ struct fio_io_functions_s {
   ssize_t (*read)(int fd, void *buf, size_t len, void *context);
   /** Called to perform a non-blocking `write`, same as the system call. */
   ssize_t (*write)(int fd, const void *buf, size_t len, void *context);
+  /**
+   * Called to perform a non-blocking `writev`, same as the system call.
+   *
+   * Optional: if missing and `write` isn't the default, `write` is used.
+   */
+  ssize_t (*writev)(int fd,
+                    const struct iovec *iov,
+                    size_t count,
+                    void *context);
   /** Sends any unsent internal data. Returns 0 only if all data was sent. */
   int (*flush)(int fd, void *context);
   /** Called when the IO object has closed . */
@@ -517,7 +624,12 @@ struct fio_protocol_s {
   uint32_t timeout;
 };
 
-/** Performs a task for each IO in the stated protocol. */
+/**
+ * Performs a task for each IO in the stated protocol.
+ *
+ * Note: the protocol's IO list is shared by all reactor threads, so this should
+ * only be used for protocols attached by a single reactor thread.
+ */
 FIO_SFUNC size_t fio_protocol_each(fio_protocol_s *protocol,
                                    void (*task)(fio_s *, void *udata2),
                                    void *udata2);
@@ -823,6 +935,19 @@ static ssize_t fio___io_func_default_write(int fd,
   return fio_sock_write(fd, buf, len);
   (void)tls;
 }
+/** Called to perform a non-blocking `writev`, same as the system call. */
+static ssize_t fio___io_func_default_writev(int fd,
+                                            const struct iovec *iov,
+                                            size_t count,
+                                            void *tls) {
+#if FIO_OS_POSIX
+  return writev(fd, iov, (int)count);
+#else
+  return fio_sock_write(fd, iov[0].iov_base, iov[0].iov_len);
+  (void)count;
+#endif
+  (void)tls;
+}
 /** Sends any unsent internal data. Returns 0 only if all data was sent. */
 static int fio___io_func_default_flush(int fd, void *tls) {
   return 0;
@@ -894,6 +1019,7 @@ FIO_SFUNC void fio___srv_init_protocol(fio_protocol_s *pr, _Bool has_tls) {
       .start = fio___srv_on_ev_mock,
       .read = fio___io_func_default_read,
       .write = fio___io_func_default_write,
+      .writev = fio___io_func_default_writev,
       .flush = fio___io_func_default_flush,
       .finish = fio___io_func_default_finish,
       .cleanup = fio___srv_on_close_mock,
@@ -932,6 +1058,8 @@ FIO_SFUNC void fio___srv_init_protocol(fio_protocol_s *pr, _Bool has_tls) {
     pr->io_functions.read = io_fn.read;
   if (!pr->io_functions.write)
     pr->io_functions.write = io_fn.write;
+  if (!pr->io_functions.writev && pr->io_functions.write == io_fn.write)
+    pr->io_functions.writev = io_fn.writev; /* may be NULL (use `write`) */
   if (!pr->io_functions.flush)
     pr->io_functions.flush = io_fn.flush;
   if (!pr->io_functions.finish)
@@ -1071,6 +1199,42 @@ static void fio___srv_poll_on_data_schd(void *udata);
 static void fio___srv_poll_on_ready_schd(void *udata);
 static void fio___srv_poll_on_close_schd(void *udata);
 
+/* poll events are pushed to the task queue in batches of this size */
+#define FIO___SRV_EVENT_BATCH 64
+
+#define FIO___SRV_LANES 4
+
+/* a reactor polls its own IO, performs its own task lanes and timers */
+typedef struct {
+  fio_poll_s poll_data;
+  fio_queue_s lanes[FIO___SRV_LANES];
+  fio_timer_queue_s timer;
+  fio_s *wakeup;
+  int wakeup_fd;
+  int wakeup_wait;
+  /* busy polling: the last activity and if the reactor spins */
+  int64_t busy_since;
+  volatile uint8_t busy_spinning;
+  uint8_t performed_idle;
+  /* the reactor's index (0 == main reactor) */
+  uint16_t id;
+  /* the number of IO objects attached to the reactor */
+  size_t ios;
+  int64_t last_to_review;
+  fio_thread_t thread;
+  /* poll events waiting to be pushed to the task queue */
+  size_t events;
+  fio_queue_task_s event_tasks[FIO___SRV_EVENT_BATCH];
+} fio___srv_reactor_s;
+
+static fio___srv_reactor_s fio___srv_main_reactor[1] = {{
+    .timer = FIO_TIMER_QUEUE_INIT,
+    .wakeup_fd = -1,
+}};
+
+/* the reactor owned by the calling thread (NULL for non-reactor threads) */
+static __thread fio___srv_reactor_s *fio___srv_current_reactor;
+
 static struct {
   FIO_LIST_HEAD protocols;
 #if FIO_VALIDITY_MAP_USE
@@ -1080,16 +1244,20 @@ static struct {
 #endif
 #endif /* FIO_VALIDITY_MAP_USE */
   fio___srv_env_safe_s env;
-  fio_poll_s poll_data;
   int64_t tick;
   fio_thread_pid_t root_pid;
   fio_thread_pid_t pid;
-  fio_s *wakeup;
-  int wakeup_fd;
-  int wakeup_wait;
   uint16_t workers;
   uint8_t is_worker;
   volatile uint8_t stop;
+  /* the busy-poll window */
+  uint32_t busy_poll;
+  /* reactor threads: configured, running and the non-main reactors */
+  uint16_t threads;
+  uint16_t reactor_count;
+  fio___srv_reactor_s *reactors;
+  /* protects the protocol / IO lists while more than one reactor runs */
+  FIO___LOCK_TYPE ios_lock;
   FIO_LIST_HEAD async;
 } fio___srvdata = {
 #if FIO_VALIDATE_IO_MUTEX && FIO_VALIDITY_MAP_USE
@@ -1099,44 +1267,112 @@ static struct {
     .env = FIO___SRV_ENV_SAFE_INIT,
 #endif
     .tick = 0,
-    .wakeup_fd = -1,
     .stop = 1,
+    .busy_poll = FIO_SRV_BUSY_POLL,
+    .reactor_count = 1,
+    .ios_lock = FIO___LOCK_INIT,
 };
 
+/* returns the calling thread's reactor (or the main reactor). */
+FIO_IFUNC fio___srv_reactor_s *fio___srv_reactor(void) {
+  fio___srv_reactor_s *r = fio___srv_current_reactor;
+  return r ? r : fio___srv_main_reactor;
+}
+
+/* the tick is written by every reactor, so it's accessed atomically. */
+FIO_IFUNC int64_t fio___srv_tick_get(void) {
+  int64_t t;
+  fio_atomic_load(t, &fio___srvdata.tick);
+  return t;
+}
+FIO_IFUNC int64_t fio___srv_tick_update(void) {
+  int64_t t = FIO___SRV_GET_TIME_MILLI();
+  fio_atomic_exchange(&fio___srvdata.tick, t);
+  return t;
+}
+
+#define FIO___SRV_IOS_LOCK()                                                   \
+  do {                                                                         \
+    if (fio___srvdata.reactor_count > 1)                                       \
+      FIO___LOCK_LOCK(fio___srvdata.ios_lock);                                 \
+  } while (0)
+#define FIO___SRV_IOS_UNLOCK()                                                 \
+  do {                                                                         \
+    if (fio___srvdata.reactor_count > 1)                                       \
+      FIO___LOCK_UNLOCK(fio___srvdata.ios_lock);                               \
+  } while (0)
+
 /** Returns current process id. */
 SFUNC int fio_srv_pid(void) { return fio___srvdata.pid; }
 
 /** Returns the root / master process id. */
 SFUNC int fio_srv_root_pid(void) { return fio___srvdata.root_pid; }
 
+/** Sets the busy-poll window (in microseconds), 0 disables busy polling. */
+SFUNC void fio_srv_busy_poll_set(uint32_t window_us) {
+  fio___srvdata.busy_poll = window_us;
+}
+
+/** Returns the busy-poll window (in microseconds), 0 if disabled. */
+SFUNC uint32_t fio_srv_busy_poll_get(void) { return fio___srvdata.busy_poll; }
+
+/* marks an accepted socket for busy polling (if the system allows it). */
+FIO_SFUNC void fio___srv_busy_poll_sock(int fd) {
+#if defined(SO_BUSY_POLL)
+  static int reported;
+  int value = (int)fio___srvdata.busy_poll;
+  if (!value)
+    return;
+  if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, (void *)&value, sizeof(value)) &&
+      !reported) {
+    reported = 1; /* usually requires CAP_NET_ADMIN */
+    FIO_LOG_DEBUG("%d SO_BUSY_POLL unavailable: %s",
+                  fio___srvdata.pid,
+                  strerror(errno));
+  }
+#if defined(SO_PREFER_BUSY_POLL)
+  value = 1;
+  setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, (void *)&value, sizeof(value));
+#endif
+#endif /* SO_BUSY_POLL */
+  (void)fd;
+}
+
 /* *****************************************************************************
 Wakeup Protocol
 ***************************************************************************** */
 
 FIO_SFUNC void fio___srv_wakeup_cb(fio_s *io) {
+  fio___srv_reactor_s *r = (fio___srv_reactor_s *)fio_udata_get(io);
   char buf[512];
-  ssize_t r = fio_sock_read(fio_fd_get(io), buf, 512);
-  (void)r;
-  fio___srvdata.wakeup_wait = 0;
+  ssize_t rd = fio_sock_read(fio_fd_get(io), buf, 512);
+  if (rd < 512) /* drained, skip the edge triggered engine's readiness test */
+    fio_poll_would_block(&r->poll_data, fio_fd_get(io), POLLIN);
+  r->wakeup_wait = 0;
 #if DEBUG
-  FIO_LOG_DEBUG2("%d fio___srv_wakeup called", fio___srvdata.pid);
+  FIO_LOG_DEBUG2("%d fio___srv_wakeup called (reactor %d)",
+                 fio___srvdata.pid,
+                 (int)r->id);
 #endif
 }
-FIO_SFUNC void fio___srv_wakeup_on_close(void *ignr_) {
-  (void)ignr_;
-  fio_sock_close(fio___srvdata.wakeup_fd);
-  fio___srvdata.wakeup = NULL;
-  fio___srvdata.wakeup_fd = -1;
-  FIO_LOG_DEBUG2("%d fio___srv_wakeup destroyed", fio___srvdata.pid);
+FIO_SFUNC void fio___srv_wakeup_on_close(void *r_) {
+  fio___srv_reactor_s *r = (fio___srv_reactor_s *)r_;
+  fio_sock_close(r->wakeup_fd);
+  r->wakeup = NULL;
+  r->wakeup_fd = -1;
+  FIO_LOG_DEBUG2("%d fio___srv_wakeup destroyed (reactor %d)",
+                 fio___srvdata.pid,
+                 (int)r->id);
 }
 
-FIO_SFUNC void fio___srv_wakeup(void) {
-  if (!fio___srvdata.wakeup || fio_queue_count(fio_srv_queue()) > 3 ||
-      fio_atomic_or(&fio___srvdata.wakeup_wait, 1))
+FIO_SFUNC void fio___srv_wakeup(fio___srv_reactor_s *r) {
+  if (!r->wakeup || r->busy_spinning ||
+      fio_queue_count(r->lanes + FIO_SRV_LANE_USER) > 3 ||
+      fio_atomic_or(&r->wakeup_wait, 1))
     return;
-  fio___srvdata.wakeup_wait = 1;
+  r->wakeup_wait = 1;
   char buf[1] = {~0};
-  ssize_t ignr = fio_sock_write(fio___srvdata.wakeup_fd, buf, 1);
+  ssize_t ignr = fio_sock_write(r->wakeup_fd, buf, 1);
   (void)ignr;
 }
 
@@ -1146,8 +1382,10 @@ static fio_protocol_s FIO___SRV_WAKEUP_PROTOCOL = {
     .on_timeout = fio___srv_on_timeout_never,
 };
 
+/* initializes the calling reactor's wakeup pipe. */
 FIO_SFUNC void fio___srv_wakeup_init(void) {
-  if (fio___srvdata.wakeup)
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  if (r->wakeup)
     return;
   int fds[2];
   if (pipe(fds)) {
@@ -1157,40 +1395,121 @@ FIO_SFUNC void fio___srv_wakeup_init(void) {
   }
   fio_sock_set_non_block(fds[0]);
   fio_sock_set_non_block(fds[1]);
-  fio___srvdata.wakeup_fd = fds[1];
-  fio___srvdata.wakeup = fio_srv_attach_fd(fds[0],
-                                           &FIO___SRV_WAKEUP_PROTOCOL,
-                                           (void *)(uintptr_t)fds[1],
-                                           NULL);
-  FIO_LOG_DEBUG2("%d fio___srv_wakeup initialized", fio___srvdata.pid);
+  r->wakeup_fd = fds[1];
+  r->wakeup =
+      fio_srv_attach_fd(fds[0], &FIO___SRV_WAKEUP_PROTOCOL, (void *)r, NULL);
+  FIO_LOG_DEBUG2("%d fio___srv_wakeup initialized (reactor %d)",
+                 fio___srvdata.pid,
+                 (int)r->id);
 }
 
 /* *****************************************************************************
 Server Timers and Task Queues
 ***************************************************************************** */
 
-static fio_timer_queue_s fio___srv_timer[1] = {FIO_TIMER_QUEUE_INIT};
-static fio_queue_s fio___srv_tasks[1];
+/* returns the number of tasks waiting in all of the reactor's lanes. */
+FIO_SFUNC size_t fio___srv_lanes_count(void) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  size_t count = 0;
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    count += fio_queue_count(r->lanes + i);
+  return count;
+}
+
+/* performs all tasks in all lanes, in lane order (no time budget). */
+FIO_SFUNC void fio___srv_lanes_perform_all(void) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  for (size_t performed = 1; performed;) {
+    performed = 0;
+    for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+      while (!fio_queue_perform(r->lanes + i))
+        ++performed;
+  }
+}
+
+/*
+ * Performs tasks from all lanes until the lanes are empty or the time budget
+ * (in microseconds) is spent.
+ *
+ * Each round performs up to a lane's weight in tasks from each lane (weighted
+ * round robin), so busy lanes can't starve the others.
+ */
+FIO_SFUNC void fio___srv_lanes_perform(int64_t budget) {
+  static const size_t weights[FIO___SRV_LANES] = FIO_SRV_LANE_WEIGHTS;
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  const int64_t deadline = fio_time_micro() + budget;
+  for (;;) {
+    size_t performed = 0;
+    for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+      performed += fio_queue_perform_batch(r->lanes + i, weights[i]);
+    if (!performed || fio_time_micro() >= deadline)
+      return;
+  }
+}
+
+/* schedules a task in a reactor's lane, waking the reactor if required. */
+FIO_IFUNC void fio___srv_defer_to(fio___srv_reactor_s *r,
+                                  fio_srv_lane_e lane,
+                                  void (*task)(void *, void *),
+                                  void *udata1,
+                                  void *udata2) {
+  fio_queue_push(r->lanes + lane, task, udata1, udata2);
+  if (r != fio___srv_current_reactor) /* a reactor reviews its own lanes */
+    fio___srv_wakeup(r);
+}
 
 /** Returns the last millisecond when the server reviewed pending IO events. */
-SFUNC int64_t fio_srv_last_tick(void) { return fio___srvdata.tick; }
+SFUNC int64_t fio_srv_last_tick(void) { return fio___srv_tick_get(); }
 
 /** Schedules a task for delayed execution. This function is thread-safe. */
 SFUNC void fio_srv_defer(void (*task)(void *, void *),
                          void *udata1,
                          void *udata2) {
-  fio_queue_push(fio___srv_tasks, task, udata1, udata2);
-  fio___srv_wakeup();
+  fio___srv_defer_to(fio___srv_reactor(),
+                     FIO_SRV_LANE_USER,
+                     task,
+                     udata1,
+                     udata2);
+}
+
+/** Schedules a task for delayed execution by the main reactor thread. */
+SFUNC void fio_srv_defer_main(void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2) {
+  fio___srv_defer_to(fio___srv_main_reactor,
+                     FIO_SRV_LANE_USER,
+                     task,
+                     udata1,
+                     udata2);
+}
+
+/** Schedules a task for delayed execution in a specific task lane. */
+SFUNC void fio_srv_defer_lane(fio_srv_lane_e lane,
+                              void (*task)(void *, void *),
+                              void *udata1,
+                              void *udata2) {
+  if ((unsigned)lane >= FIO___SRV_LANES)
+    lane = FIO_SRV_LANE_USER;
+  fio___srv_defer_to(fio___srv_reactor(), lane, task, udata1, udata2);
 }
 
 /** Schedules a timer bound task, see `fio_timer_schedule` in the CSTL. */
 SFUNC void fio_srv_run_every FIO_NOOP(fio_timer_schedule_args_s args) {
-  args.start_at += ((uint64_t)0 - !args.start_at) & fio___srvdata.tick;
-  fio_timer_schedule FIO_NOOP(fio___srv_timer, args);
+  args.start_at += ((uint64_t)0 - !args.start_at) & fio___srv_tick_get();
+  fio_timer_schedule FIO_NOOP(&fio___srv_reactor()->timer, args);
 }
 
-/** Returns a pointer for the server's queue. */
-SFUNC fio_queue_s *fio_srv_queue(void) { return fio___srv_tasks; }
+/** Returns a pointer for the reactor's queue (the user lane). */
+SFUNC fio_queue_s *fio_srv_queue(void) {
+  return fio___srv_reactor()->lanes + FIO_SRV_LANE_USER;
+}
+
+/** Returns a pointer for the queue of a reactor's task lane. */
+SFUNC fio_queue_s *fio_srv_lane(fio_srv_lane_e lane) {
+  if ((unsigned)lane >= FIO___SRV_LANES)
+    lane = FIO_SRV_LANE_USER;
+  return fio___srv_reactor()->lanes + lane;
+}
 
 /* *****************************************************************************
 IO Validity Map - Implementation
@@ -1272,6 +1591,7 @@ struct fio_s {
   void *udata;
   void *tls;
   fio_protocol_s *pr;
+  fio___srv_reactor_s *reactor;
   FIO_LIST_NODE node;
   fio_stream_s stream;
   fio___srv_env_safe_s env;
@@ -1295,22 +1615,27 @@ struct fio_s {
 FIO_SFUNC void fio_s_init(fio_s *io) {
   *io = (fio_s){
       .pr = &FIO___MOCK_PROTOCOL,
+      .reactor = fio___srv_reactor(),
       .node = FIO_LIST_INIT(io->node),
       .stream = FIO_STREAM_INIT(io->stream),
       .env = FIO___SRV_ENV_SAFE_INIT,
-      .active = fio___srvdata.tick,
+      .active = fio___srv_tick_get(),
       .state = FIO_STATE_OPEN,
       .fd = -1,
   };
+  fio_atomic_add(&io->reactor->ios, 1);
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
   FIO_LIST_REMOVE(&FIO___MOCK_PROTOCOL.reserved.protocols);
   FIO_LIST_PUSH(&fio___srvdata.protocols,
                 &FIO___MOCK_PROTOCOL.reserved.protocols);
+  FIO___SRV_IOS_UNLOCK();
   fio_set_valid(io);
 }
 
 FIO_SFUNC void fio_s_destroy(fio_s *io) {
   fio_set_invalid(io);
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_REMOVE(&io->node);
 #ifdef DEBUG
   FIO_LOG_DDEBUG2("detaching and destroying %p (fd %d): %zu bytes total",
@@ -1323,17 +1648,22 @@ FIO_SFUNC void fio_s_destroy(fio_s *io) {
   /* store info, as it might be freed if the protocol is freed. */
   if (FIO_LIST_IS_EMPTY(&io->pr->reserved.ios))
     FIO_LIST_REMOVE_RESET(&io->pr->reserved.protocols);
+  FIO___SRV_IOS_UNLOCK();
   /* call on_finish / free callbacks . */
   io->pr->io_functions.cleanup(io->tls);
   io->pr->on_close(io->udata); /* may destroy protocol object! */
   fio___srv_env_safe_destroy(&io->env);
   fio_sock_close(io->fd);
   fio_stream_destroy(&io->stream);
-  fio_poll_forget(&fio___srvdata.poll_data, io->fd);
+  fio_poll_forget(&io->reactor->poll_data, io->fd);
+  fio_atomic_sub(&io->reactor->ios, 1);
 }
 #define FIO_REF_NAME            fio
 #define FIO_REF_INIT(o)         fio_s_init(&(o))
 #define FIO_REF_DESTROY(o)      fio_s_destroy(&(o))
+#if FIO_USE_POOL
+#define FIO_REF_POOL 0
+#endif
 #define FIO___RECURSIVE_INCLUDE 1
 #include FIO_INCLUDE_FILE
 #undef FIO___RECURSIVE_INCLUDE
@@ -1341,14 +1671,16 @@ FIO_SFUNC void fio_s_destroy(fio_s *io) {
 static void fio___protocol_set_task(void *io_, void *old_) {
   fio_s *io = (fio_s *)io_;
   fio_protocol_s *old = (fio_protocol_s *)old_;
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_REMOVE(&io->node);
   if (FIO_LIST_IS_EMPTY(&old->reserved.ios))
     FIO_LIST_REMOVE_RESET(&old->reserved.protocols);
   FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
   if (io->node.next == io->node.prev) /* list was empty before IO was added */
     FIO_LIST_PUSH(&fio___srvdata.protocols, &io->pr->reserved.protocols);
+  FIO___SRV_IOS_UNLOCK();
   io->pr->on_attach(io);
-  fio_poll_monitor(&fio___srvdata.poll_data,
+  fio_poll_monitor(&io->reactor->poll_data,
                    io->fd,
                    (void *)io,
                    POLLIN | POLLOUT);
@@ -1365,7 +1697,7 @@ SFUNC fio_protocol_s *fio_protocol_set(fio_s *io, fio_protocol_s *pr) {
   if (pr == old)
     return NULL;
   io->pr = pr;
-  // fio_queue_push(fio___srv_tasks, fio___protocol_set_task, io, old);
+  // fio_srv_defer(fio___protocol_set_task, io, old);
   fio___protocol_set_task((void *)io, (void *)old);
   return old;
 }
@@ -1397,7 +1729,11 @@ SFUNC fio_s *fio_srv_attach_fd(int fd,
   io->pr = protocol;
   io->udata = udata;
   io->tls = tls;
-  fio_queue_push(fio___srv_tasks, fio___protocol_set_task, io, old);
+  fio___srv_defer_to(io->reactor,
+                     FIO_SRV_LANE_USER,
+                     fio___protocol_set_task,
+                     io,
+                     old);
   return io;
 error:
   protocol->on_close(udata);
@@ -1420,7 +1756,7 @@ static void fio_undup_task(void *io, void *ignr_) {
  * when all other tasks have completed.
  */
 SFUNC void fio_undup(fio_s *io) {
-  fio_queue_push(fio___srv_tasks, fio_undup_task, io);
+  fio___srv_defer_to(io->reactor, FIO_SRV_LANE_USER, fio_undup_task, io, NULL);
 }
 
 /** Performs a task for each IO in the stated protocol. */
@@ -1503,10 +1839,10 @@ static void fio___srv_poll_on_data(void *io_, void *ignr_) {
     /* this also tests for the suspended / throttled / closing flags */
     io->pr->on_data(io);
     if (io->state == FIO_STATE_OPEN) {
-      fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLIN);
+      fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLIN);
     }
   } else if ((io->state & FIO_STATE_OPEN)) {
-    fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLOUT);
+    fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLOUT);
   }
   fio_free2(io);
   return;
@@ -1519,22 +1855,33 @@ static void fio___srv_poll_on_ready(void *io_, void *ignr_) {
 #endif
   fio_s *io = (fio_s *)io_;
   char buf_mem[FIO_SRV_BUFFER_PER_WRITE];
+  struct iovec iov[FIO_SRV_IOV_PER_WRITE];
   size_t total = 0;
   if (!(io->state & FIO_STATE_OPEN))
     goto finish;
   for (;;) {
-    size_t len = FIO_SRV_BUFFER_PER_WRITE;
-    char *buf = buf_mem;
-    fio_stream_read(&io->stream, &buf, &len);
-    if (!len)
-      break;
-    ssize_t r = io->pr->io_functions.write(io->fd, buf, len, io->tls);
+    ssize_t r;
+    size_t count = 0;
+    if (io->pr->io_functions.writev) /* send queued packets without copying */
+      count = fio_stream_read_iov(&io->stream, iov, FIO_SRV_IOV_PER_WRITE);
+    if (count > 1) {
+      r = io->pr->io_functions.writev(io->fd, iov, count, io->tls);
+    } else {
+      size_t len = FIO_SRV_BUFFER_PER_WRITE;
+      char *buf = buf_mem;
+      fio_stream_read(&io->stream, &buf, &len);
+      if (!len)
+        break;
+      r = io->pr->io_functions.write(io->fd, buf, len, io->tls);
+    }
     if (r > 0) {
       total += r;
       fio_stream_advance(&io->stream, r);
       continue;
     } else if ((r == -1) & ((errno == EWOULDBLOCK) || (errno == EAGAIN) ||
                             (errno == EINTR))) {
+      if (errno != EINTR)
+        fio_poll_would_block(&io->reactor->poll_data, io->fd, POLLOUT);
       break;
     } else {
 #if DEBUG
@@ -1564,7 +1911,7 @@ static void fio___srv_poll_on_ready(void *io_, void *ignr_) {
     } else {
       if ((io->state & FIO_STATE_THROTTLED)) {
         fio_atomic_and(&io->state, ~FIO_STATE_THROTTLED);
-        fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLIN);
+        fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLIN);
       }
       FIO_LOG_DDEBUG2("calling on_ready for %p (fd %d)", (void *)io, io->fd);
       io->pr->on_ready(io);
@@ -1575,7 +1922,7 @@ static void fio___srv_poll_on_ready(void *io_, void *ignr_) {
         FIO_LOG_DDEBUG2("throttled IO %p (fd %d)", (void *)io, io->fd);
       fio_atomic_or(&io->state, FIO_STATE_THROTTLED);
     }
-    fio_poll_monitor(&fio___srvdata.poll_data, io->fd, io, POLLOUT);
+    fio_poll_monitor(&io->reactor->poll_data, io->fd, io, POLLOUT);
   }
 finish:
   fio_free2(io);
@@ -1600,42 +1947,54 @@ static void fio___srv_poll_on_timeout(void *io_, void *ignr_) {
 Event scheduling
 ***************************************************************************** */
 
+/* pushes the collected poll events to the task queue (one lock round-trip). */
+FIO_SFUNC void fio___srv_poll_events_push(fio___srv_reactor_s *r) {
+  if (!r->events)
+    return;
+  fio_queue_push_many(r->lanes + FIO_SRV_LANE_IO, r->event_tasks, r->events);
+  r->events = 0;
+}
+
+/* collects a poll event task, pushing the tasks when the batch is full. */
+FIO_IFUNC void fio___srv_poll_event_add(void (*fn)(void *, void *), void *io) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  r->event_tasks[r->events++] =
+      (fio_queue_task_s){.fn = fn, .udata1 = fio_dup2((fio_s *)io)};
+  if (r->events == FIO___SRV_EVENT_BATCH)
+    fio___srv_poll_events_push(r);
+}
+
 static void fio___srv_poll_on_data_schd(void *io) {
   if (!fio_is_valid(io))
     return;
-  fio_queue_push(fio___srv_tasks,
-                 fio___srv_poll_on_data,
-                 fio_dup2((fio_s *)io));
+  fio___srv_poll_event_add(fio___srv_poll_on_data, io);
 }
 static void fio___srv_poll_on_ready_schd(void *io) {
   if (!fio_is_valid(io))
     return;
-  fio_queue_push(fio___srv_tasks,
-                 fio___srv_poll_on_ready,
-                 fio_dup2((fio_s *)io));
+  fio___srv_poll_event_add(fio___srv_poll_on_ready, io);
 }
 static void fio___srv_poll_on_close_schd(void *io) {
   if (!fio_is_valid(io))
     return;
-  fio_queue_push(fio___srv_tasks,
-                 fio___srv_poll_on_close,
-                 fio_dup2((fio_s *)io));
+  fio___srv_poll_event_add(fio___srv_poll_on_close, io);
 }
 
 /* *****************************************************************************
 Timeout Review
 ***************************************************************************** */
 
-/** Schedules the timeout event for any timed out IO object */
+/** Schedules the timeout event for the reactor's timed out IO objects */
 static int fio___srv_review_timeouts(void) {
   int c = 0;
-  static time_t last_to_review = 0;
+  fio___srv_reactor_s *r = fio___srv_reactor();
   /* test timeouts at whole second intervals */
-  if (last_to_review + 1000 > fio___srvdata.tick)
+  const int64_t now_milli = fio___srv_tick_get();
+  if (r->last_to_review + 1000 > now_milli)
     return c;
-  last_to_review = fio___srvdata.tick;
-  const int64_t now_milli = fio___srvdata.tick;
+  r->last_to_review = now_milli;
 
+  FIO___SRV_IOS_LOCK();
   FIO_LIST_EACH(fio_protocol_s,
                 reserved.protocols,
                 &fio___srvdata.protocols,
@@ -1645,17 +2004,46 @@ static int fio___srv_review_timeouts(void) {
       pr->timeout = FIO_SRV_TIMEOUT_MAX;
     int64_t limit = now_milli - ((int64_t)pr->timeout);
     FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
-      FIO_ASSERT_DEBUG(io->pr == pr, "IO protocol ownership error");
       if (io->active >= limit)
         break;
+      if (io->reactor != r) /* reviewed by the IO's reactor thread */
+        continue;
+      FIO_ASSERT_DEBUG(io->pr == pr, "IO protocol ownership error");
       FIO_LOG_DDEBUG2("scheduling timeout for %p (fd %d)", (void *)io, io->fd);
-      fio_queue_push(fio___srv_tasks, fio___srv_poll_on_timeout, fio_dup2(io));
+      fio_queue_push(r->lanes + FIO_SRV_LANE_BACKGROUND,
+                     fio___srv_poll_on_timeout,
+                     fio_dup2(io));
       ++c;
     }
   }
+  FIO___SRV_IOS_UNLOCK();
   return c;
 }
 
+/* performs a task for each of the reactor's IO objects (outside the lock). */
+FIO_SFUNC size_t fio___srv_reactor_ios_each(void (*task)(void *io, void *)) {
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  fio_queue_s tasks;
+  size_t count = 0;
+  fio_queue_init(&tasks);
+  FIO___SRV_IOS_LOCK();
+  FIO_LIST_EACH(fio_protocol_s,
+                reserved.protocols,
+                &fio___srvdata.protocols,
+                pr) {
+    FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
+      if (io->reactor != r)
+        continue;
+      fio_queue_push(&tasks, task, fio_dup2(io));
+      ++count;
+    }
+  }
+  FIO___SRV_IOS_UNLOCK();
+  fio_queue_perform_all(&tasks);
+  fio_queue_destroy(&tasks);
+  return count;
+}
+
 /* *****************************************************************************
 Reactor cycling
 ***************************************************************************** */
@@ -1665,23 +2053,35 @@ static void fio___srv_signal_handle(int sig, void *flg) {
 }
 
 FIO_SFUNC void fio___srv_tick(int timeout) {
-  static size_t performed_idle = 0;
-  if (fio_poll_review(&fio___srvdata.poll_data, timeout) > 0) {
-    performed_idle = 0;
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  int64_t now = 0;
+  if (fio___srvdata.busy_poll) {
+    now = fio_time_micro();
+    if (!timeout) {
+      r->busy_since = now;
+    } else if (now - r->busy_since < (int64_t)fio___srvdata.busy_poll) {
+      timeout = 0;
+      fio_atomic_exchange(&r->busy_spinning, 1);
+    } else if (fio_atomic_exchange(&r->busy_spinning, 0)) {
+      timeout = 0; /* tasks deferred while spinning didn't wake the reactor */
+    }
+  }
+  if (fio_poll_review(&r->poll_data, timeout) > 0) {
+    r->performed_idle = 0;
+    r->busy_since = now;
   } else if (timeout) {
-    if (!performed_idle)
+    if (!r->performed_idle && !r->id)
       fio_state_callback_force(FIO_CALL_ON_IDLE);
-    performed_idle = 1;
+    r->performed_idle = 1;
   }
-  fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
-  fio_timer_push2queue(fio___srv_tasks, fio___srv_timer, fio___srvdata.tick);
-  for (size_t i = 0; i < 2048; ++i)
-    if (fio_queue_perform(fio___srv_tasks))
-      break;
-  // fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_poll_events_push(r);
+  fio_timer_push2queue(r->lanes + FIO_SRV_LANE_TIMER,
+                       &r->timer,
+                       fio___srv_tick_update());
+  fio___srv_lanes_perform(FIO_SRV_TICK_BUDGET);
   fio___srv_review_timeouts();
-  // fio_queue_perform_all(fio___srv_tasks);
-  fio_signal_review();
+  if (!r->id)
+    fio_signal_review();
 }
 
 FIO_SFUNC void fio___srv_run_async_as_sync(void *ignr_1, void *ignr_2) {
@@ -1695,80 +2095,208 @@ FIO_SFUNC void fio___srv_run_async_as_sync(void *ignr_1, void *ignr_2) {
     repeat = 1;
   }
   if (repeat)
-    fio_queue_push(fio___srv_tasks, fio___srv_run_async_as_sync);
+    fio_queue_push(fio_srv_queue(), fio___srv_run_async_as_sync);
 }
 
 FIO_SFUNC void fio___srv_shutdown_task(void *shutdown_start_, void *a2) {
   intptr_t shutdown_start = (intptr_t)shutdown_start_;
-  if (shutdown_start + FIO_SRV_SHUTDOWN_TIMEOUT < fio___srvdata.tick ||
-      FIO_LIST_IS_EMPTY(&fio___srvdata.protocols))
+  if (shutdown_start + FIO_SRV_SHUTDOWN_TIMEOUT < fio___srv_tick_get() ||
+      !fio___srv_reactor()->ios)
     return;
-  fio___srv_tick(fio_queue_count(fio___srv_tasks) ? 0 : 100);
-  fio_queue_push(fio___srv_tasks, fio___srv_run_async_as_sync);
-  fio_queue_push(fio___srv_tasks, fio___srv_shutdown_task, shutdown_start_, a2);
+  fio___srv_tick(fio___srv_lanes_count() ? 0 : 100);
+  fio_queue_push(fio_srv_queue(), fio___srv_run_async_as_sync);
+  fio_queue_push(fio_srv_queue(), fio___srv_shutdown_task, shutdown_start_, a2);
+}
+
+FIO_SFUNC void fio___srv_shutdown_io_task(void *io_, void *ignr_) {
+  fio_s *io = (fio_s *)io_;
+  io->pr->on_shutdown(io); /* TODO / FIX: skip close on return value? */
+  fio_close(io);
+  fio_free2(io);
+  (void)ignr_;
+}
+
+FIO_SFUNC void fio___srv_close_now_task(void *io_, void *ignr_) {
+  fio_close_now((fio_s *)io_);
+  fio_free2((fio_s *)io_);
+  (void)ignr_;
 }
 
 FIO_SFUNC void fio___srv_shutdown(void) {
   /* collect tick for shutdown start, to monitor for possible timeout */
-  int64_t shutdown_start = fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
+  int64_t shutdown_start = fio___srv_tick_update();
   size_t connected = 0;
   /* first notify that shutdown is starting */
-  fio_state_callback_force(FIO_CALL_ON_SHUTDOWN);
+  if (!fio___srv_reactor()->id)
+    fio_state_callback_force(FIO_CALL_ON_SHUTDOWN);
   /* preform on_shutdown callback for each connection and close */
-  FIO_LIST_EACH(fio_protocol_s,
-                reserved.protocols,
-                &fio___srvdata.protocols,
-                pr) {
-    FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
-      pr->on_shutdown(io); /* TODO / FIX: move callback to task? */
-      fio_close(io);       /* TODO / FIX: skip close on return value? */
-      ++connected;
-    }
-  }
+  connected = fio___srv_reactor_ios_each(fio___srv_shutdown_io_task);
   FIO_LOG_DEBUG2("Server shutting down with %zu connected clients", connected);
   /* cycle while connections exist. */
-  fio_queue_push(fio___srv_tasks,
+  fio_queue_push(fio_srv_queue(),
                  fio___srv_shutdown_task,
                  (void *)(intptr_t)shutdown_start,
                  NULL);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   /* in case of timeout, force close remaining connections. */
-  connected = 0;
-  FIO_LIST_EACH(fio_protocol_s,
-                reserved.protocols,
-                &fio___srvdata.protocols,
-                pr) {
-    FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) {
-      fio_close_now(io);
-      ++connected;
-    }
-  }
+  connected = fio___srv_reactor_ios_each(fio___srv_close_now_task);
   FIO_LOG_DEBUG("Server shutdown timed out with %zu clients", connected);
   /* perform remaining tasks. */
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
 }
 
 FIO_SFUNC void fio___srv_work_task(void *ignr_1, void *ignr_2) {
   if (fio___srvdata.stop)
     return;
-  fio___srv_tick(fio_queue_count(fio___srv_tasks) ? 0 : 500);
-  fio_queue_push(fio___srv_tasks, fio___srv_work_task, ignr_1, ignr_2);
+  fio___srv_tick(fio___srv_lanes_count() ? 0 : 500);
+  fio_queue_push(fio_srv_queue(), fio___srv_work_task, ignr_1, ignr_2);
+}
+
+/* runs the calling thread's reactor until the server stops. */
+FIO_SFUNC void fio___srv_reactor_run(void) {
+  fio___srv_wakeup_init();
+  fio_queue_push(fio_srv_queue(), fio___srv_work_task);
+  fio___srv_lanes_perform_all();
+  fio___srv_shutdown();
+  fio___srv_lanes_perform_all();
+}
+
+/* *****************************************************************************
+Reactor Threads
+***************************************************************************** */
+
+FIO_SFUNC void fio___srv_reactor_init(fio___srv_reactor_s *r, uint16_t id) {
+  *r = (fio___srv_reactor_s){
+      .timer = FIO_TIMER_QUEUE_INIT,
+      .wakeup_fd = -1,
+      .id = id,
+  };
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    fio_queue_init(r->lanes + i);
+  fio_poll_init(&r->poll_data,
+                .on_data = fio___srv_poll_on_data_schd,
+                .on_ready = fio___srv_poll_on_ready_schd,
+                .on_close = fio___srv_poll_on_close_schd);
+}
+
+FIO_SFUNC void fio___srv_reactor_destroy(fio___srv_reactor_s *r) {
+  /* perform tasks other threads scheduled after the reactor stopped */
+  fio___srv_reactor_s *caller = fio___srv_current_reactor;
+  fio___srv_current_reactor = r;
+  fio___srv_lanes_perform_all();
+  fio_timer_destroy(&r->timer);
+  fio___srv_lanes_perform_all();
+  fio___srv_current_reactor = caller;
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    fio_queue_destroy(r->lanes + i);
+  fio_poll_destroy(&r->poll_data);
+}
+
+static void *fio___srv_reactor_thread(void *r_) {
+  fio___srv_current_reactor = (fio___srv_reactor_s *)r_;
+  FIO_LOG_DEBUG2("%d reactor thread %d starting.",
+                 (int)fio___srvdata.pid,
+                 (int)fio___srv_current_reactor->id);
+  fio___srv_reactor_run();
+  FIO_LOG_DEBUG2("%d reactor thread %d exiting.",
+                 (int)fio___srvdata.pid,
+                 (int)fio___srv_current_reactor->id);
+  return NULL;
+}
+
+/* starts the reactor threads (the calling thread runs the main reactor). */
+FIO_SFUNC void fio___srv_threads_start(void) {
+  const uint16_t count = fio___srvdata.threads;
+  if (count < 2)
+    return;
+  fio___srvdata.reactors = (fio___srv_reactor_s *)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*fio___srvdata.reactors) * (count - 1), 0);
+  FIO_ASSERT_ALLOC(fio___srvdata.reactors);
+  for (uint16_t i = 1; i < count; ++i)
+    fio___srv_reactor_init(fio___srvdata.reactors + (i - 1), i);
+  fio___srvdata.reactor_count = count;
+  for (uint16_t i = 1; i < count; ++i) {
+    if (!fio_thread_create(&fio___srvdata.reactors[i - 1].thread,
+                           fio___srv_reactor_thread,
+                           (void *)(fio___srvdata.reactors + (i - 1))))
+      continue;
+    FIO_LOG_ERROR("%d couldn't spawn reactor thread, running %d threads.",
+                  (int)fio___srvdata.pid,
+                  (int)i);
+    fio___srvdata.reactor_count = i;
+    break;
+  }
+  FIO_LOG_DEBUG2("%d running %d reactor threads.",
+                 (int)fio___srvdata.pid,
+                 (int)fio___srvdata.reactor_count);
+}
+
+/* joins the reactor threads once they stopped. */
+FIO_SFUNC void fio___srv_threads_join(void) {
+  if (!fio___srvdata.reactors)
+    return;
+  for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+    fio_thread_join(&fio___srvdata.reactors[i - 1].thread);
+  fio___srvdata.reactor_count = 1;
+  for (uint16_t i = 1; i < fio___srvdata.threads; ++i)
+    fio___srv_reactor_destroy(fio___srvdata.reactors + (i - 1));
+  FIO_MEM_FREE_(fio___srvdata.reactors,
+                sizeof(*fio___srvdata.reactors) * (fio___srvdata.threads - 1));
+  fio___srvdata.reactors = NULL;
+}
+
+/** Sets the number of reactor threads each (worker) process runs. */
+SFUNC void fio_srv_threads_set(int threads) {
+  if (fio_srv_is_running()) {
+    FIO_LOG_WARNING("fio_srv_threads_set called while the server is running.");
+    return;
+  }
+  threads = (int)fio_srv_workers(threads);
+  fio___srvdata.threads = (uint16_t)(threads + !threads);
+}
+
+/** Returns the number of reactor threads each (worker) process runs. */
+SFUNC uint16_t fio_srv_threads(void) { return fio___srvdata.threads; }
+
+/** Returns the calling reactor thread's index (0 = main) or -1 if none. */
+SFUNC int fio_srv_thread(void) {
+  return fio___srv_current_reactor ? (int)fio___srv_current_reactor->id : -1;
+}
+
+/* *****************************************************************************
+Starting a Worker
+***************************************************************************** */
+
+#if defined(H___FIO_MALLOC___H)
+/* returns idle cached memory to the system, even if the server stays idle */
+FIO_SFUNC int fio___srv_malloc_cache_decay(void *ignr_1, void *ignr_2) {
+  fio_malloc_cache_decay();
+  return 0;
+  (void)ignr_1, (void)ignr_2;
 }
+#endif /* H___FIO_MALLOC___H */
 
 FIO_SFUNC void fio___srv_work(int is_worker) {
+  fio___srv_current_reactor = fio___srv_main_reactor;
   fio___srvdata.is_worker = is_worker;
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   if (is_worker) {
+    fio___srv_threads_start();
     fio_state_callback_force(FIO_CALL_ON_START);
   }
-  fio___srv_wakeup_init();
-  fio_queue_push(fio___srv_tasks, fio___srv_work_task);
-  fio_queue_perform_all(fio___srv_tasks);
-  fio___srv_shutdown();
-  fio_queue_perform_all(fio___srv_tasks);
+#if defined(H___FIO_MALLOC___H)
+  if (fio_malloc_cache_decay_time())
+    fio_srv_run_every(.fn = fio___srv_malloc_cache_decay,
+                      .every = (uint32_t)(fio_malloc_cache_decay_time() >> 1) |
+                               1,
+                      .repetitions = -1);
+#endif /* H___FIO_MALLOC___H */
+  fio___srv_reactor_run();
+  fio___srv_threads_join();
   fio_state_callback_force(FIO_CALL_ON_FINISH);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   fio___srvdata.workers = 0;
+  fio___srv_current_reactor = NULL;
 }
 
 /* *****************************************************************************
@@ -1805,7 +2333,7 @@ static void *fio___srv_worker_sentinel(void *pid_data) {
                               fio___srv_wait_for_worker,
                               (void *)thr);
     fio_thread_detach(&thr);
-    fio_queue_push(fio___srv_tasks, fio___srv_spawn_worker, (void *)thr);
+    fio_queue_push(fio_srv_queue(), fio___srv_spawn_worker, (void *)thr);
   }
 #else /* Non POSIX? no `fork`? no fio_thread_waitpid? */
   FIO_ASSERT(
@@ -1827,7 +2355,7 @@ static void fio___srv_spawn_worker(void *ignr_1, void *ignr_2) {
 
   fio_state_callback_force(FIO_CALL_BEFORE_FORK);
   /* do not allow master tasks to run in worker */
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   /* perform actual fork */
   fio_thread_pid_t pid = fio_thread_fork();
   FIO_ASSERT(pid != (fio_thread_pid_t)-1, "system call `fork` failed.");
@@ -1843,7 +2371,7 @@ static void fio___srv_spawn_worker(void *ignr_1, void *ignr_2) {
     fio_srv_stop();
   }
   if (!fio_atomic_xor_fetch(&fio___srvdata.stop, 2))
-    fio_queue_push(fio___srv_tasks, fio___srv_work_task);
+    fio_queue_push(fio_srv_queue(), fio___srv_work_task);
   return;
 
 is_worker_process:
@@ -1903,7 +2431,7 @@ SFUNC void fio_srv_start(int workers) {
   fio___srvdata.is_worker = !workers;
   fio_sock_maximize_limits(0);
   fio_state_callback_force(FIO_CALL_PRE_START);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   fio_signal_monitor(SIGINT,
                      fio___srv_signal_handle,
                      (void *)&fio___srvdata.stop);
@@ -1913,7 +2441,7 @@ SFUNC void fio_srv_start(int workers) {
 #ifdef SIGPIPE
   fio_signal_monitor(SIGPIPE, NULL, NULL);
 #endif
-  fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
+  fio___srv_tick_update();
   if (workers) {
     FIO_LOG_INFO("%d spawning %d workers.", fio___srvdata.root_pid, workers);
     for (int i = 0; i < workers; ++i) {
@@ -1929,7 +2457,7 @@ SFUNC void fio_srv_start(int workers) {
 #ifdef SIGPIPE
   fio_signal_forget(SIGPIPE);
 #endif
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
 }
 
 /* *****************************************************************************
@@ -1942,15 +2470,19 @@ SFUNC int fio_fd_get(fio_s *io) { return io->fd; }
 FIO_SFUNC void fio_touch___task(void *io_, void *ignr_) {
   (void)ignr_;
   fio_s *io = (fio_s *)io_;
-  io->active = fio___srvdata.tick;
+  FIO___SRV_IOS_LOCK();
+  io->active = fio___srv_tick_get();
   FIO_LIST_REMOVE(&io->node);
   FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
+  FIO___SRV_IOS_UNLOCK();
   fio_free2(io);
 }
 
 /* Resets a socket's timeout counter. */
 SFUNC void fio_touch(fio_s *io) {
-  fio_queue_push_urgent(fio___srv_tasks, fio_touch___task, fio_dup(io));
+  fio_queue_push_urgent(io->reactor->lanes + FIO_SRV_LANE_USER,
+                        fio_touch___task,
+                        fio_dup(io));
 }
 
 /**
@@ -1962,9 +2494,15 @@ SFUNC void fio_touch(fio_s *io) {
 SFUNC size_t fio_read(fio_s *io, void *buf, size_t len) {
   ssize_t r = io->pr->io_functions.read(io->fd, buf, len, io->tls);
   if (r > 0) {
+    /* a short socket read drained the socket (TLS may buffer more data) */
+    if ((size_t)r < len &&
+        io->pr->io_functions.read == fio___io_func_default_read)
+      fio_poll_would_block(&io->reactor->poll_data, io->fd, POLLIN);
     fio_touch(io);
     return r;
   }
+  if ((r == -1) & ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    fio_poll_would_block(&io->reactor->poll_data, io->fd, POLLIN);
   if ((!len) | ((r == -1) & ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
                              (errno == EINTR))))
     return 0;
@@ -1986,7 +2524,7 @@ FIO_SFUNC void fio_write2___task(void *io_, void *packet_) {
   if (!(io->state & FIO_STATE_OPEN))
     goto io_error;
   fio_stream_add(&io->stream, packet);
-  fio_queue_push(fio___srv_tasks,
+  fio_queue_push(io->reactor->lanes + FIO_SRV_LANE_USER,
                  fio___srv_poll_on_ready,
                  io); /* no dup/undup, already done.*/
   return;
@@ -2016,7 +2554,11 @@ SFUNC void fio_write2 FIO_NOOP(fio_s *io, fio_write_args_s args) {
     goto error;
   if ((io->state & FIO_STATE_CLOSING))
     goto write_called_after_close;
-  fio_srv_defer(fio_write2___task, fio_dup2(io), packet);
+  fio___srv_defer_to(io->reactor,
+                     FIO_SRV_LANE_USER,
+                     fio_write2___task,
+                     fio_dup2(io),
+                     packet);
   return;
 error: /* note: `dealloc` is called by the `fio_stream` API error handler. */
   FIO_LOG_ERROR("couldn't create %zu bytes long user-packet for IO %p (%d)",
@@ -2032,7 +2574,7 @@ write_called_after_close:
       void (*fn)(fio_stream_packet_s *);
     } u = {.fn = fio_stream_pack_free};
     // u.fn(packet);
-    fio_queue_push(fio___srv_tasks, fio_write2___dealloc_task, u.ptr, packet);
+    fio_queue_push(fio_srv_queue(), fio_write2___dealloc_task, u.ptr, packet);
   }
   return;
 io_error_null:
@@ -2044,7 +2586,7 @@ io_error_null:
       void (*fn)(void *);
     } u = {.fn = args.dealloc};
     // u.fn(args.buf);
-    fio_queue_push(fio___srv_tasks, fio_write2___dealloc_task, u.ptr, args.buf);
+    fio_queue_push(fio_srv_queue(), fio_write2___dealloc_task, u.ptr, args.buf);
   }
 }
 
@@ -2054,9 +2596,11 @@ SFUNC void fio_close(fio_s *io) {
       !(fio_atomic_or(&io->state, (FIO_STATE_CLOSING | FIO_STATE_CLOSE_LOCAL)) &
         FIO_STATE_CLOSING)) {
     FIO_LOG_DDEBUG2("scheduling IO %p (fd %d) for closure", (void *)io, io->fd);
-    fio_queue_push(fio___srv_tasks,
-                   fio___srv_poll_on_ready,
-                   fio_dup2((fio_s *)io));
+    fio___srv_defer_to(io->reactor,
+                       FIO_SRV_LANE_USER,
+                       fio___srv_poll_on_ready,
+                       fio_dup2((fio_s *)io),
+                       NULL);
   }
 }
 
@@ -2074,7 +2618,7 @@ SFUNC void fio_srv_suspend(fio_s *io) { io->state |= FIO_STATE_SUSPENDED; }
 SFUNC void fio_srv_unsuspend(fio_s *io) {
   if ((fio_atomic_and(&io->state, ~FIO_STATE_SUSPENDED) &
        FIO_STATE_SUSPENDED)) {
-    fio_poll_monitor(&fio___srvdata.poll_data, io->fd, (void *)io, POLLIN);
+    fio_poll_monitor(&io->reactor->poll_data, io->fd, (void *)io, POLLIN);
   }
 }
 
@@ -2103,7 +2647,7 @@ static void fio___srv_listen2_on_data_task(void *io_, void *ignr_) {
   fio_free2(io);
 }
 static void fio___srv_listen_on_data_task_reschd(void *io_, void *ignr_) {
-  fio_queue_push(fio___srv_tasks, fio___srv_listen2_on_data_task, io_, ignr_);
+  fio_queue_push(fio_srv_queue(), fio___srv_listen2_on_data_task, io_, ignr_);
 }
 
 static void fio___srv_listen2_on_data(fio_s *io) {
@@ -2259,6 +2803,8 @@ typedef struct {
   size_t ref_count;
   size_t url_len;
   uint8_t hide_from_log;
+  uint8_t on_root;
+  uint8_t reuseport;
   char url[];
 } fio___srv_listen_s;
 
@@ -2269,18 +2815,20 @@ static fio___srv_listen_s *fio___srv_listen_dup(fio___srv_listen_s *l) {
   return l;
 }
 
-static void fio___srv_listen_free(void *l_) {
-  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
-  fio_close(l->io);
+static void fio___srv_listen_free(void *l_);
+FIO_SFUNC void fio___srv_listen_attach_task(void *l_);
+
+/* drops a reference, cleaning up once the last reference was dropped. */
+static void fio___srv_listen_unref(fio___srv_listen_s *l) {
   if (fio_atomic_sub(&l->ref_count, 1))
     return;
 
   fio_state_callback_remove(FIO_CALL_AT_EXIT, fio___srv_listen_free, (void *)l);
   fio_state_callback_remove(FIO_CALL_ON_START,
-                            fio___srv_listen_free,
+                            fio___srv_listen_attach_task,
                             (void *)l);
   fio_state_callback_remove(FIO_CALL_PRE_START,
-                            fio___srv_listen_free,
+                            fio___srv_listen_attach_task,
                             (void *)l);
   fio___io_func_free_context_caller(l->protocol->io_functions.free_context,
                                     l->tls_ctx);
@@ -2308,11 +2856,54 @@ static void fio___srv_listen_free(void *l_) {
                  getpid(),
                  (int)l->url_len,
                  l->url);
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   FIO___LEAK_COUNTER_ON_FREE(fio_srv_listen);
   FIO_MEM_FREE_(l, sizeof(*l) + l->url_len + 1);
 }
 
+static void fio___srv_listen_on_data(fio_s *io);
+
+static void fio___srv_listen_thread_on_close(void *l) {
+  fio___srv_listen_unref((fio___srv_listen_s *)l);
+}
+
+static fio_protocol_s FIO___LISTEN_THREAD_PROTOCOL = {
+    .on_data = fio___srv_listen_on_data,
+    .on_close = fio___srv_listen_thread_on_close,
+    .on_timeout = fio___srv_on_timeout_never,
+};
+
+/* closes the calling reactor's listening IO(s) for the listener. */
+FIO_SFUNC void fio___srv_listen_thread_stop_task(void *l_, void *ignr_) {
+  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
+  fio___srv_reactor_s *r = fio___srv_reactor();
+  FIO___SRV_IOS_LOCK();
+  if (FIO___LISTEN_THREAD_PROTOCOL.reserved.ios.next) {
+    FIO_LIST_EACH(fio_s,
+                  node,
+                  &FIO___LISTEN_THREAD_PROTOCOL.reserved.ios,
+                  io) {
+      if (io->reactor == r && io->udata == l)
+        fio_close(io);
+    }
+  }
+  FIO___SRV_IOS_UNLOCK();
+  fio___srv_listen_unref(l);
+  (void)ignr_;
+}
+
+static void fio___srv_listen_free(void *l_) {
+  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
+  fio_close(l->io);
+  for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+    fio___srv_defer_to(fio___srvdata.reactors + (i - 1),
+                       FIO_SRV_LANE_USER,
+                       fio___srv_listen_thread_stop_task,
+                       fio___srv_listen_dup(l),
+                       NULL);
+  fio___srv_listen_unref(l);
+}
+
 SFUNC void fio_srv_listen_stop(void *listener) {
   if (listener)
     fio___srv_listen_free(listener);
@@ -2323,13 +2914,19 @@ static void fio___srv_listen_on_data_task(void *io_, void *ignr_) {
   fio_s *io = (fio_s *)io_;
   int fd;
   fio___srv_listen_s *l = (fio___srv_listen_s *)(io->udata);
-  while ((fd = accept(fio_fd_get(io), NULL, NULL)) != -1) {
+  while ((fd = fio_poll_accept(&io->reactor->poll_data, fio_fd_get(io))) !=
+         -1) {
+    fio___srv_busy_poll_sock(fd);
     fio_srv_attach_fd(fd, l->protocol, l->udata, l->tls_ctx);
   }
   fio_free2(io);
 }
 static void fio___srv_listen_on_data_task_reschd(void *io_, void *ignr_) {
-  fio_srv_defer(fio___srv_listen_on_data_task, io_, ignr_);
+  fio___srv_defer_to(((fio_s *)io_)->reactor,
+                     FIO_SRV_LANE_USER,
+                     fio___srv_listen_on_data_task,
+                     io_,
+                     ignr_);
 }
 
 static void fio___srv_listen_on_data(fio_s *io) {
@@ -2353,6 +2950,30 @@ static fio_protocol_s FIO___LISTEN_PROTOCOL = {
     .on_timeout = fio___srv_on_timeout_never,
 };
 
+/* attaches a listening socket to the calling (non-main) reactor thread. */
+FIO_SFUNC void fio___srv_listen_thread_attach_task(void *l_, void *ignr_) {
+  fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
+  int fd = -1;
+  if (l->reuseport) /* the kernel balances connections between the sockets */
+    fd = fio_sock_open2(l->url,
+                        FIO_SOCK_SERVER | FIO_SOCK_TCP | FIO_SOCK_REUSEPORT);
+  if (fd == -1) /* no SO_REUSEPORT - threads share the same socket */
+    fd = fio_sock_dup(l->fd);
+  if (fd == -1)
+    FIO_LOG_ERROR("%d reactor thread %d couldn't listen @ %s",
+                  (int)fio___srvdata.pid,
+                  fio_srv_thread(),
+                  l->url);
+  else
+    FIO_LOG_DEBUG2("%d reactor thread %d listening @ %s (fd %d)",
+                   (int)fio___srvdata.pid,
+                   fio_srv_thread(),
+                   l->url,
+                   fd);
+  fio_srv_attach_fd(fd, &FIO___LISTEN_THREAD_PROTOCOL, l, NULL);
+  (void)ignr_;
+}
+
 FIO_SFUNC void fio___srv_listen_attach_task_deferred(void *l_, void *ignr_) {
   fio___srv_listen_s *l = (fio___srv_listen_s *)l_;
   l = fio___srv_listen_dup(l);
@@ -2363,6 +2984,13 @@ FIO_SFUNC void fio___srv_listen_attach_task_deferred(void *l_, void *ignr_) {
                  l->fd,
                  fd);
   l->io = fio_srv_attach_fd(fd, &FIO___LISTEN_PROTOCOL, l, NULL);
+  if (!l->on_root)
+    for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+      fio___srv_defer_to(fio___srvdata.reactors + (i - 1),
+                         FIO_SRV_LANE_USER,
+                         fio___srv_listen_thread_attach_task,
+                         fio___srv_listen_dup(l),
+                         NULL);
   if (l->on_start)
     l->on_start(l->protocol, l->udata);
   if (l->hide_from_log)
@@ -2373,8 +3001,8 @@ FIO_SFUNC void fio___srv_listen_attach_task_deferred(void *l_, void *ignr_) {
 }
 
 FIO_SFUNC void fio___srv_listen_attach_task(void *l_) {
-  /* make sure to run in server thread */
-  fio_srv_defer(fio___srv_listen_attach_task_deferred, l_, NULL);
+  /* make sure to run in the main reactor thread */
+  fio_srv_defer_main(fio___srv_listen_attach_task_deferred, l_, NULL);
 }
 
 int fio_srv_listen___(void); /* IDE marker */
@@ -2449,19 +3077,24 @@ SFUNC void *fio_srv_listen FIO_NOOP(struct fio_srv_listen_args args) {
       .owner = fio___srvdata.pid,
       .url_len = url_buf.len,
       .hide_from_log = args.hide_from_log,
+      .on_root = !!args.on_root,
+      .reuseport = (fio___srvdata.threads > 1 && !args.on_root &&
+                    url.port.len),
   };
   FIO_MEMCPY(l->url, url_buf.buf, url_buf.len);
   l->url[l->url_len] = 0;
   if (should_free_tls)
     fio_tls_free(args.tls);
 
-  l->fd = fio_sock_open2(l->url, FIO_SOCK_SERVER | FIO_SOCK_TCP);
+  l->fd = fio_sock_open2(l->url,
+                         FIO_SOCK_SERVER | FIO_SOCK_TCP |
+                             (l->reuseport ? FIO_SOCK_REUSEPORT : 0));
   if (l->fd == -1) {
     fio___srv_listen_free(l);
     return (l = NULL);
   }
   if (fio_srv_is_running()) {
-    fio_srv_defer(fio___srv_listen_attach_task_deferred, l, NULL);
+    fio_srv_defer_main(fio___srv_listen_attach_task_deferred, l, NULL);
   } else {
     fio_state_callback_add(
         (args.on_root ? FIO_CALL_PRE_START : FIO_CALL_ON_START),
@@ -2565,22 +3198,23 @@ Managing data after a fork
 FIO_SFUNC void fio___srv_after_fork(void *ignr_) {
   (void)ignr_;
   fio___srvdata.pid = fio_thread_getpid();
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   FIO_LIST_EACH(fio_protocol_s,
                 reserved.protocols,
                 &fio___srvdata.protocols,
                 pr) {
     FIO_LIST_EACH(fio_s, node, &pr->reserved.ios, io) { fio_close_now(io); }
   }
-  fio_queue_perform_all(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
   fio_invalidate_all();
-  fio_queue_perform_all(fio___srv_tasks);
-  fio_queue_destroy(fio___srv_tasks);
+  fio___srv_lanes_perform_all();
+  for (size_t i = 0; i < FIO___SRV_LANES; ++i)
+    fio_queue_destroy(fio___srv_main_reactor->lanes + i);
 }
 
 FIO_SFUNC void fio___srv_cleanup_at_exit(void *ignr_) {
   fio___srv_after_fork(ignr_);
-  fio_poll_destroy(&fio___srvdata.poll_data);
+  fio_poll_destroy(&fio___srv_main_reactor->poll_data);
   fio___srv_env_safe_destroy(&fio___srvdata.env);
 }
 
@@ -2588,17 +3222,15 @@ FIO_SFUNC void fio___srv_cleanup_at_exit(void *ignr_) {
 Initializing Server State
 ***************************************************************************** */
 FIO_CONSTRUCTOR(fio___srv) {
-  fio_queue_init(fio___srv_tasks);
+  fio___srv_reactor_init(fio___srv_main_reactor, 0);
   fio___srvdata.protocols = FIO_LIST_INIT(fio___srvdata.protocols);
-  fio___srvdata.tick = FIO___SRV_GET_TIME_MILLI();
+  fio___srv_tick_update();
   fio___srvdata.root_pid = fio___srvdata.pid = fio_thread_getpid();
   fio___srvdata.async = FIO_LIST_INIT(fio___srvdata.async);
-  fio_poll_init(&fio___srvdata.poll_data,
-                .on_data = fio___srv_poll_on_data_schd,
-                .on_ready = fio___srv_poll_on_ready_schd,
-                .on_close = fio___srv_poll_on_close_schd);
+  fio_srv_threads_set(FIO_SRV_THREADS);
   fio___srv_init_protocol_test(&FIO___MOCK_PROTOCOL, 0);
   fio___srv_init_protocol_test(&FIO___LISTEN_PROTOCOL, 0);
+  fio___srv_init_protocol_test(&FIO___LISTEN_THREAD_PROTOCOL, 0);
   fio_state_callback_add(FIO_CALL_IN_CHILD, fio___srv_after_fork, NULL);
   fio_state_callback_add(FIO_CALL_AT_EXIT, fio___srv_cleanup_at_exit, NULL);
 }
@@ -3014,6 +3646,7 @@ SFUNC fio_io_functions_s fio_tls_default_io_functions(fio_io_functions_s *f) {
       .start = fio___srv_on_ev_mock,
       .read = fio___io_func_default_read,
       .write = fio___io_func_default_write,
+      .writev = fio___io_func_default_writev,
       .flush = fio___io_func_default_flush,
       .finish = fio___io_func_default_finish,
       .cleanup = fio___srv_on_close_mock,
@@ -3028,6 +3661,8 @@ SFUNC fio_io_functions_s fio_tls_default_io_functions(fio_io_functions_s *f) {
     f->read = fio___io_func_default_read;
   if (!f->write)
     f->write = fio___io_func_default_write;
+  if (!f->writev && f->write == fio___io_func_default_write)
+    f->writev = fio___io_func_default_writev;
   if (!f->flush)
     f->flush = fio___io_func_default_flush;
   if (!f->finish)
@@ -3055,7 +3690,7 @@ failed:
 }
 FIO_SFUNC void fio___srv_async_finish(void *q_) {
   fio_srv_async_s *q = (fio_srv_async_s *)q_;
-  q->q = fio___srv_tasks;
+  q->q = fio___srv_main_reactor->lanes + FIO_SRV_LANE_USER;
   fio_queue_workers_stop(&q->queue);
   fio_queue_perform_all(&q->queue);
   fio_queue_destroy(&q->queue);
@@ -579,6 +579,10 @@ FIO_SFUNC void fio___pubsub_message_on_destroy(fio___pubsub_message_s *m);
 #define FIO_REF_NAME             fio___pubsub_message
 #define FIO_REF_DESTROY(obj)     fio___pubsub_message_on_destroy(&(obj))
 #define FIO_REF_FLEX_TYPE        char
+#if FIO_USE_POOL
+#define FIO_REF_POOL      0
+#define FIO_REF_POOL_FLEX 512 /* small messages are pooled */
+#endif
 #define FIO_REF_CONSTRUCTOR_ONLY 1
 #define FIO___RECURSIVE_INCLUDE  1
 #include FIO_INCLUDE_FILE
@@ -1113,10 +1117,7 @@ FIO_IFUNC void fio___pubsub_subscription_unsubscribe(fio_subscription_s *s) {
   if (!s)
     return;
   s->on_message = fio___subscription_mock_cb;
-  fio_queue_push(fio_srv_queue(),
-                 fio___pubsub_unsubscribe_task,
-                 (void *)s,
-                 NULL);
+  fio_srv_defer_main(fio___pubsub_unsubscribe_task, (void *)s, NULL);
 }
 
 /** Subscribes to a named channel in the numerical filter's namespace. */
@@ -1152,7 +1153,7 @@ SFUNC void fio_subscribe FIO_NOOP(fio_subscribe_args_s args) {
       args.channel.len,
       FIO___PUBSUB_CHANNEL_ENCODE_CAPA(args.filter, args.is_pattern));
 
-  fio_srv_defer(fio___pubsub_subscribe_task, (void *)s, NULL);
+  fio_srv_defer_main(fio___pubsub_subscribe_task, (void *)s, NULL);
 
   if (args.master_only && !args.io)
     goto is_master_only;
@@ -1260,6 +1261,14 @@ FIO_IFUNC void fio___subscription_on_message_task(void *s_, void *m_) {
   fio___pubsub_message_free(m);
   return;
 reschedule:
+  if (s->io) { /* IO bound callbacks are performed by the IO's reactor */
+    fio___srv_defer_to(s->io->reactor,
+                       FIO_SRV_LANE_USER,
+                       fio___subscription_on_message_task,
+                       s_,
+                       m_);
+    return;
+  }
   fio_queue_push(fio_srv_queue(), fio___subscription_on_message_task, s_, m_);
 }
 
@@ -1273,53 +1282,77 @@ SFUNC void fio_pubsub_message_defer(fio_msg_s *msg) {
   ((uintptr_t *)(msg + 1))[1] = 1;
 }
 
+/* subscription tasks are pushed to the queue in batches of this size */
+#define FIO___PUBSUB_DELIVERY_BATCH 32
+
+typedef struct {
+  size_t count;
+  fio_queue_task_s tasks[FIO___PUBSUB_DELIVERY_BATCH];
+} fio___pubsub_delivery_s;
+
+/* pushes the collected subscription tasks to the queue. */
+FIO_IFUNC void fio___pubsub_delivery_push(fio___pubsub_delivery_s *d) {
+  if (!d->count)
+    return;
+  fio_queue_push_many(fio_srv_queue(), d->tasks, d->count);
+  d->count = 0;
+}
+
+/* collects a subscription task, pushing the tasks when the batch is full. */
+FIO_IFUNC void fio___pubsub_delivery_add(fio___pubsub_delivery_s *d,
+                                         fio_subscription_s *s,
+                                         fio___pubsub_message_s *m) {
+  if (s->io && s->io->reactor != fio___srv_reactor()) {
+    /* IO bound callbacks are performed by the IO's reactor (thread) */
+    fio___srv_defer_to(s->io->reactor,
+                       FIO_SRV_LANE_USER,
+                       fio___subscription_on_message_task,
+                       fio_subscription_dup(s),
+                       fio___pubsub_message_dup(m));
+    return;
+  }
+  d->tasks[d->count++] = (fio_queue_task_s){
+      .fn = (void (*)(void *, void *))fio___subscription_on_message_task,
+      .udata1 = fio_subscription_dup(s),
+      .udata2 = fio___pubsub_message_dup(m)};
+  if (d->count == FIO___PUBSUB_DELIVERY_BATCH)
+    fio___pubsub_delivery_push(d);
+}
+
 /* distributes a message to all of a channel's subscribers */
 FIO_SFUNC void fio___pubsub_channel_deliver_task(void *ch_, void *m_) {
   fio_channel_s *ch = (fio_channel_s *)ch_;
   fio___pubsub_message_s *m = (fio___pubsub_message_s *)m_;
+  fio___pubsub_delivery_s d;
   FIO_LIST_HEAD *head = (&ch->subscriptions);
   _Bool is_history = !!(m->data.is_json & FIO___PUBSUB_REPLAY);
   head += is_history;
+  d.count = 0;
   if (m->data.io) { /* move as many `if` statements as possible out of loops. */
     if (is_history) {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
         if (m->data.io != s->io && m->data.published >= s->replay_since)
-          fio_queue_push(
-              fio_srv_queue(),
-              (void (*)(void *, void *))fio___subscription_on_message_task,
-              fio_subscription_dup(s),
-              fio___pubsub_message_dup(m));
+          fio___pubsub_delivery_add(&d, s, m);
       }
     } else {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
         if (m->data.io != s->io)
-          fio_queue_push(
-              fio_srv_queue(),
-              (void (*)(void *, void *))fio___subscription_on_message_task,
-              fio_subscription_dup(s),
-              fio___pubsub_message_dup(m));
+          fio___pubsub_delivery_add(&d, s, m);
       }
     }
   } else {
     if (is_history) {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
         if (m->data.published >= s->replay_since)
-          fio_queue_push(
-              fio_srv_queue(),
-              (void (*)(void *, void *))fio___subscription_on_message_task,
-              fio_subscription_dup(s),
-              fio___pubsub_message_dup(m));
+          fio___pubsub_delivery_add(&d, s, m);
       }
     } else {
       FIO_LIST_EACH(fio_subscription_s, node, head, s) {
-        fio_queue_push(
-            fio_srv_queue(),
-            (void (*)(void *, void *))fio___subscription_on_message_task,
-            fio_subscription_dup(s),
-            fio___pubsub_message_dup(m));
+        fio___pubsub_delivery_add(&d, s, m);
       }
     }
   }
+  fio___pubsub_delivery_push(&d);
   fio___pubsub_message_free(m);
   fio_channel_free(ch);
 }
@@ -1666,7 +1699,7 @@ void fio_publish FIO_NOOP(fio_publish_args_s args) {
   m = fio___pubsub_message_author(args);
   m->data.is_json = ((!!args.is_json) | ((uint8_t)(uintptr_t)args.engine));
 
-  fio_srv_defer(fio___publish_message_task, m, NULL);
+  fio_srv_defer_main(fio___publish_message_task, m, NULL);
   return;
 
 external_engine:
@@ -1679,7 +1712,7 @@ external_engine:
   m->data.is_json = ((!!args.is_json) | ((uint8_t)FIO___PUBSUB_FORWARDER));
   FIO_MEMCPY(m->data.message.buf, msg.message.buf, msg.message.len);
   fio_u2buf64u(m->data.message.buf + msg.message.len, (uintptr_t)args.engine);
-  fio_srv_defer(fio___publish_message_task, m, NULL);
+  fio_srv_defer_main(fio___publish_message_task, m, NULL);
 }
 
 /* *****************************************************************************
@@ -1847,12 +1880,12 @@ FIO_SFUNC void fio___pubsub_detach_task(void *engine, void *ignr_) {
 SFUNC void fio_pubsub_attach(fio_pubsub_engine_s *engine) {
   if (!engine)
     return;
-  fio_srv_defer(fio___pubsub_attach_task, engine, NULL);
+  fio_srv_defer_main(fio___pubsub_attach_task, engine, NULL);
 }
 
 /** Schedules an engine for Detachment, so it could be safely destroyed. */
 SFUNC void fio_pubsub_detach(fio_pubsub_engine_s *engine) {
-  fio_queue_push(fio_srv_queue(), fio___pubsub_detach_task, engine, NULL);
+  fio_srv_defer_main(fio___pubsub_detach_task, engine, NULL);
 }
 
 /* *****************************************************************************
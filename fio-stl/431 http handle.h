@@ -1264,6 +1264,9 @@ struct fio_http_s {
     .received_at = fio_http_get_timestump(), .body.fd = -1                     \
   }
 #define FIO_REF_DESTROY(h) fio_http_destroy(&(h))
+#if FIO_USE_POOL
+#define FIO_REF_POOL 0
+#endif
 SFUNC fio_http_s *fio_http_destroy(fio_http_s *h) {
   if (!h)
     return h;
@@ -724,7 +724,7 @@ SFUNC void *fio_http_listen FIO_NOOP(const char *url, fio_http_settings_s s) {
                             ? fio___http_on_http_with_public_folder
                             : fio___http_on_http_direct;
   p->settings.public_folder.buf = p->public_folder_buf;
-  p->queue = p->settings.queue ? p->settings.queue->q : fio_srv_queue();
+  p->queue = p->settings.queue ? p->settings.queue->q : NULL;
   if (s.public_folder.len)
     FIO_MEMCPY(p->public_folder_buf, s.public_folder.buf, s.public_folder.len);
   void *listener =
@@ -733,7 +733,7 @@ SFUNC void *fio_http_listen FIO_NOOP(const char *url, fio_http_settings_s s) {
                      .tls = s.tls,
                      // .on_open = fio___http_on_open,
                      .on_finish = fio___http_listen_on_finished,
-                     .queue_for_accept = p->queue ? p->queue : NULL);
+                     .queue_for_accept = p->queue);
   return listener;
 }
 
@@ -816,7 +816,7 @@ SFUNC fio_s *fio_http_connect FIO_NOOP(const char *url,
   p->settings.public_folder.buf = p->public_folder_buf;
   p->settings.public_folder.len = 0;
   p->settings.public_folder.buf[0] = 0;
-  p->queue = p->settings.queue ? p->settings.queue->q : fio_srv_queue();
+  p->queue = p->settings.queue ? p->settings.queue->q : NULL;
   p->on_http_callback = fio___http_on_http_client;
   fio___http_connection_s *c =
       fio___http_connection_new(p->settings.max_line_len);
@@ -825,7 +825,7 @@ SFUNC fio_s *fio_http_connect FIO_NOOP(const char *url,
       .io = NULL,
       .h = h,
       .settings = &(p->settings),
-      .queue = p->queue,
+      .queue = (p->queue ? p->queue : fio_srv_queue()),
       .udata = p->settings.udata,
       .state.http =
           {
@@ -1022,7 +1022,7 @@ FIO_SFUNC void fio___http_on_attach_accept(fio_s *io) {
   FIO_ASSERT_ALLOC(c);
   *c = (fio___http_connection_s){
       .settings = &(p->settings),
-      .queue = p->queue,
+      .queue = (p->queue ? p->queue : fio_srv_queue()),
       .udata = p->settings.udata,
       .io = io,
       .state.http =
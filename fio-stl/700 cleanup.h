@@ -33,6 +33,7 @@ Common cleanup
 #undef FIO_MEM_FREE_
 #undef FIO_MEM_REALLOC_IS_SAFE_
 #undef FIO_MEMORY_NAME /* postponed due to possible use in macros */
+#undef FIO_REGION_NAME /* postponed due to possible use in macros */
 
 #undef FIO___LOCK_TYPE
 #undef FIO___LOCK_INIT
@@ -49,6 +49,7 @@ Memory Allocator Tests
 #undef FIO_MEMORY_USE_THREAD_MUTEX
 #define FIO_MEMORY_USE_THREAD_MUTEX 0
 #define FIO_MEMORY_ARENA_COUNT      4
+#define FIO_MEMORY_CACHE_DECAY      1000
 #include FIO_INCLUDE_FILE
 
 #define FIO_MEMORY_NAME                   fio_mem_test_unsafe
@@ -56,6 +57,25 @@ Memory Allocator Tests
 #undef FIO_MEMORY_USE_THREAD_MUTEX
 #define FIO_MEMORY_USE_THREAD_MUTEX 0
 #define FIO_MEMORY_ARENA_COUNT      4
+#define FIO_MEMORY_NUMA             1
+#include FIO_INCLUDE_FILE
+
+#define FIO_MEMORY_NAME                   fio_mem_test_tcache
+#define FIO_MEMORY_INITIALIZE_ALLOCATIONS 1
+#undef FIO_MEMORY_USE_THREAD_MUTEX
+#define FIO_MEMORY_USE_THREAD_MUTEX 0
+#define FIO_MEMORY_ARENA_COUNT      2
+#define FIO_MEMORY_THREAD_CACHE     1
+#define FIO_MEMORY_HUGE_PAGES       1
+#include FIO_INCLUDE_FILE
+
+#define FIO_MEMORY_NAME                   fio_mem_test_slab
+#define FIO_MEMORY_INITIALIZE_ALLOCATIONS 1
+#undef FIO_MEMORY_USE_THREAD_MUTEX
+#define FIO_MEMORY_USE_THREAD_MUTEX 0
+#define FIO_MEMORY_ARENA_COUNT      2
+#define FIO_MEMORY_SLAB_LIMIT       256
+#define FIO_MEMORY_PROFILE          4096
 #include FIO_INCLUDE_FILE
 
 #undef FIO___TEST_REINCLUDE
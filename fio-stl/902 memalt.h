@@ -92,6 +92,106 @@ FIO_SFUNC void FIO_NAME_TEST(stl, memalt)(void) {
       FIO_ASSERT(len == i, "fio_strlen failed.");
     }
   }
+  { /* test all alignments and tail lengths (SIMD kernels) against libc */
+    char a[1024 + 64], b[1024 + 64];
+    memset(a, 0x80, sizeof(a));
+    for (size_t offset = 0; offset < 64; ++offset) {
+      for (size_t len = 0; len < 1024 - offset; len += 1 + (len > 300) * 7) {
+        char *s = a + offset;
+        s[len] = 0;
+        FIO_ASSERT(fio_strlen(s) == len,
+                   "fio_strlen failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        FIO_ASSERT(fio_memchr(s, 0, len + 1) == s + len &&
+                       !fio_memchr(s, 0, len),
+                   "fio_memchr failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        s[len] = (char)0x80;
+        fio_memcpy(b + (offset ^ 63), s, len);
+        FIO_ASSERT(!memcmp(b + (offset ^ 63), s, len) &&
+                       !fio_memcmp(b + (offset ^ 63), s, len),
+                   "fio_memcpy / fio_memcmp failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        if (!len)
+          continue;
+        b[(offset ^ 63) + (len >> 1)] = 1;
+        FIO_ASSERT(fio_memcmp(b + (offset ^ 63), s, len) < 0 &&
+                       fio_memcmp(s, b + (offset ^ 63), len) > 0,
+                   "fio_memcmp order failed (offset %zu, len %zu)",
+                   offset,
+                   len);
+        b[(offset ^ 63) + (len >> 1)] = (char)0x80;
+      }
+    }
+  }
+  { /* test fio_memchr2, fio_memchr3, fio_memchr_class and fio_memmem */
+    fprintf(stderr, "* Testing multi-token seeking (memchr2/3, class, memmem).\n");
+    char buf[640];
+    uint8_t table[256] = {0};
+    fio_byte_class_s cls, wide;
+    table[' '] = table['\r'] = table['\n'] = table[':'] = table[0xF1] = 1;
+    fio_byte_class_init(&cls, table);
+    FIO_ASSERT(cls.nibbles, "a small byte class should use nibble tables");
+    for (size_t i = 0; i < 256; i += 15)
+      table[i] = 1; /* too many distinct rows for nibble tables */
+    fio_byte_class_init(&wide, table);
+    FIO_ASSERT(!wide.nibbles, "a wide byte class can't use nibble tables");
+    for (size_t round = 0; round < 512; ++round) {
+      const size_t len = (size_t)(fio_rand64() % (sizeof(buf) - 64));
+      const size_t offset = round & 63;
+      char *s = buf + offset;
+      for (size_t i = 0; i < len; ++i) /* lower case letters, few matches */
+        s[i] = (char)('a' + (fio_rand64() % 26));
+      if (len && (round & 1))
+        s[fio_rand64() % len] = (round & 2) ? '\n' : ':';
+      if (len && (round & 4))
+        s[fio_rand64() % len] = (char)(fio_rand64() & 0xFF);
+      char *e2 = NULL, *e3 = NULL, *ec = NULL, *ew = NULL;
+      for (size_t i = len; i--;) { /* naive first occurrences */
+        if (s[i] == '\n' || s[i] == ':')
+          e2 = s + i;
+        if (s[i] == '\n' || s[i] == ':' || s[i] == 'z')
+          e3 = s + i;
+        if (cls.map[(uint8_t)s[i]])
+          ec = s + i;
+        if (wide.map[(uint8_t)s[i]])
+          ew = s + i;
+      }
+      FIO_ASSERT(fio_memchr2(s, '\n', ':', len) == e2,
+                 "fio_memchr2 failed (round %zu, len %zu)",
+                 round,
+                 len);
+      FIO_ASSERT(fio_memchr3(s, '\n', ':', 'z', len) == e3,
+                 "fio_memchr3 failed (round %zu, len %zu)",
+                 round,
+                 len);
+      FIO_ASSERT(fio_memchr_class(s, &cls, len) == ec &&
+                     fio_memchr_class(s, &wide, len) == ew,
+                 "fio_memchr_class failed (round %zu, len %zu)",
+                 round,
+                 len);
+      const size_t nlen = 1 + (round % 24);
+      if (len < nlen)
+        continue;
+      const size_t at = (size_t)(fio_rand64() % (len - nlen + 1));
+      char *found = (char *)fio_memmem(s, len, s + at, nlen);
+      FIO_ASSERT(found && found <= s + at && !memcmp(found, s + at, nlen),
+                 "fio_memmem failed (round %zu, len %zu, needle %zu)",
+                 round,
+                 len,
+                 nlen);
+      for (char *p = s; p < found; ++p)
+        FIO_ASSERT(memcmp(p, s + at, nlen),
+                   "fio_memmem missed an earlier match (round %zu)",
+                   round);
+      FIO_ASSERT(!fio_memmem(s, len, "0123", 4) &&
+                     fio_memmem(s, len, "", 0) == s,
+                 "fio_memmem edge cases failed");
+    }
+  }
 #ifndef DEBUG
   const size_t base_repetitions = 8192;
   fprintf(stderr, "* Speed testing core memcpy primitives:\n");
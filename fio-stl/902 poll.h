@@ -38,6 +38,101 @@ FIO_SFUNC void FIO_NAME_TEST(stl, poll)(void) {
           "* SKIPPED testing file descriptor polling (engine: kqueue).\n");
 }
 
+#elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_EPOLL_ET ||                          \
+    FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+/* counters: [0] on_data, [1] on_ready, [2] on_close */
+FIO_SFUNC void fio___poll_test_on_data(void *c) { ((size_t *)c)[0] += 1; }
+FIO_SFUNC void fio___poll_test_on_ready(void *c) { ((size_t *)c)[1] += 1; }
+FIO_SFUNC void fio___poll_test_on_close(void *c) { ((size_t *)c)[2] += 1; }
+
+FIO_SFUNC void FIO_NAME_TEST(stl, poll)(void) {
+  fprintf(stderr,
+          "* Testing file descriptor monitoring (engine: %s).\n",
+          fio_poll_engine());
+  fio_poll_s p;
+  size_t in[3] = {0}, out[3] = {0};
+  int fds[2];
+  char buf[16];
+  fio_poll_init(&p,
+                .on_data = fio___poll_test_on_data,
+                .on_ready = fio___poll_test_on_ready,
+                .on_close = fio___poll_test_on_close);
+  FIO_ASSERT(!pipe(fds), "couldn't open pipe for polling test");
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], in, POLLIN) &&
+                 !fio_poll_monitor(&p, fds[1], out, POLLOUT),
+             "fio_poll_monitor failed");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(!in[0] && out[1] == 1, "only the pipe's writing end is ready");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(out[1] == 1, "monitoring should be one-shot");
+  fio_poll_monitor(&p, fds[1], out, POLLOUT);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(out[1] == 2, "stale events that are still ready should fire");
+  FIO_ASSERT(write(fds[1], "hello", 5) == 5, "pipe write failed");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 1, "on_data should be called for new data");
+  fio_poll_monitor(&p, fds[0], in, POLLIN);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 2, "unread data should fire when monitored again");
+  FIO_ASSERT(read(fds[0], buf, 16) == 5, "pipe read failed");
+  fio_poll_monitor(&p, fds[0], in, POLLIN);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 2, "drained file descriptors shouldn't fire");
+  FIO_ASSERT(write(fds[1], "hello", 5) == 5, "pipe write failed");
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 3, "new data should fire (new edge)");
+  FIO_ASSERT(read(fds[0], buf, 16) == 5, "pipe read failed");
+  fio_poll_would_block(&p, fds[0], POLLIN);
+  fio_poll_monitor(&p, fds[0], in, POLLIN);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[0] == 3, "fio_poll_would_block hint ignored");
+  FIO_ASSERT(!fio_poll_forget(&p, fds[1]) && fio_poll_forget(&p, fds[1]),
+             "fio_poll_forget error");
+  close(fds[1]);
+  fio_poll_review(&p, 0);
+  FIO_ASSERT(in[2] == 1 && in[0] == 3 && !out[2],
+             "on_close should be called when the pipe is closed");
+  FIO_ASSERT(!fio_poll_forget(&p, fds[0]), "fio_poll_forget error");
+  close(fds[0]);
+  { /* listening sockets (connections might be accepted by the kernel) */
+    size_t lc[3] = {0};
+    int cl[3], acc[3];
+    int srv = fio_sock_open("127.0.0.1", "9437", FIO_SOCK_TCP | FIO_SOCK_SERVER);
+    FIO_ASSERT(srv != -1, "couldn't open listening socket for polling test");
+    fio_sock_set_non_block(srv);
+    for (size_t i = 0; i < 3; ++i) {
+      cl[i] = fio_sock_open("127.0.0.1",
+                            "9437",
+                            FIO_SOCK_TCP | FIO_SOCK_CLIENT);
+      FIO_ASSERT(cl[i] != -1, "couldn't connect for polling test");
+      acc[i] = -1;
+      for (size_t j = 0; acc[i] == -1 && j < 100; ++j) {
+        fio_poll_monitor(&p, srv, lc, POLLIN);
+        fio_poll_review(&p, 10);
+        acc[i] = fio_poll_accept(&p, srv);
+      }
+      FIO_ASSERT(acc[i] != -1, "fio_poll_accept failed (%zu)", i);
+    }
+    FIO_ASSERT(lc[0] >= 1, "on_data should be called for new connections");
+    FIO_ASSERT(fio_poll_accept(&p, srv) == -1 &&
+                   (errno == EAGAIN || errno == EWOULDBLOCK),
+               "fio_poll_accept should return -1 (EAGAIN) when no connections "
+               "are waiting");
+#if FIO_POLL_ENGINE == FIO_POLL_ENGINE_IO_URING
+    if (p.fd == -1)
+      FIO_ASSERT(p.fds[srv].accepting == FIO___POLL_URING_ACCEPT_ACTIVE,
+                 "io_uring should accept connections in the kernel");
+#endif
+    FIO_ASSERT(!fio_poll_forget(&p, srv), "fio_poll_forget error");
+    fio_sock_close(srv);
+    for (size_t i = 0; i < 3; ++i) {
+      fio_sock_close(cl[i]);
+      fio_sock_close(acc[i]);
+    }
+  }
+  fio_poll_destroy(&p);
+}
+
 #elif FIO_POLL_ENGINE == FIO_POLL_ENGINE_POLL
 FIO_SFUNC void FIO_NAME_TEST(stl, poll)(void) {
   fprintf(
@@ -0,0 +1,136 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_TEST_ALL           /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                          FIO_POOL_NAME Test Helper
+
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_TEST_ALL) && !defined(FIO___TEST_REINCLUDE) &&                 \
+    !defined(H___FIO_POOL_TEST___H)
+#define H___FIO_POOL_TEST___H
+
+typedef struct {
+  size_t index;
+  char junk[40];
+} fio___pool_test_s;
+
+/* a small magazine makes threads exchange chains with the depot often */
+#define FIO_POOL_NAME     fio___pool_test
+#define FIO_POOL_TYPE     fio___pool_test_s
+#define FIO_POOL_MAGAZINE 4
+#define FIO_POOL_WARMUP   100
+#define FIO___TEST_REINCLUDE
+#include FIO_INCLUDE_FILE
+#undef FIO___TEST_REINCLUDE
+
+/* a reference counted flexible type, small objects are pooled */
+#define FIO_REF_NAME             fio___pool_test_ref
+#define FIO_REF_TYPE             fio___pool_test_s
+#define FIO_REF_FLEX_TYPE        char
+#define FIO_REF_CONSTRUCTOR_ONLY 1
+#define FIO_REF_POOL             0
+#define FIO_REF_POOL_FLEX        32
+#define FIO___TEST_REINCLUDE
+#include FIO_INCLUDE_FILE
+#undef FIO___TEST_REINCLUDE
+
+#define FIO___POOL_TEST_OBJECTS 4096
+
+FIO_SFUNC void *fio___pool_test_task(void *ignr_) {
+  fio___pool_test_s **objs = (fio___pool_test_s **)FIO_MEM_REALLOC(
+      NULL,
+      0,
+      sizeof(*objs) * FIO___POOL_TEST_OBJECTS,
+      0);
+  FIO_ASSERT_ALLOC(objs);
+  for (size_t round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < FIO___POOL_TEST_OBJECTS; ++i) {
+      objs[i] = fio___pool_test_alloc();
+      FIO_ASSERT(objs[i], "pool allocation failed (%zu)!", i);
+      FIO_ASSERT(!((uintptr_t)objs[i] & 15), "pool objects should be aligned");
+      objs[i]->index = i;
+    }
+    for (size_t i = 0; i < FIO___POOL_TEST_OBJECTS; ++i) {
+      FIO_ASSERT(objs[i]->index == i,
+                 "pool object overwritten (shared by two owners?)");
+      /* free in a different order than allocated */
+      if ((i & 1))
+        fio___pool_test_free(objs[i]);
+    }
+    for (size_t i = 0; i < FIO___POOL_TEST_OBJECTS; i += 2)
+      fio___pool_test_free(objs[i]);
+  }
+  FIO_MEM_FREE(objs, sizeof(*objs) * FIO___POOL_TEST_OBJECTS);
+  return ignr_;
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, pool)(void) {
+  fprintf(stderr, "* Testing fixed size object pool (magazines + depot).\n");
+  FIO_ASSERT(fio___pool_test___pool.objects >= 100,
+             "the pool should have been pre-warmed on startup");
+  { /* single thread - freed objects are reused */
+    fio___pool_test_s *a = fio___pool_test_alloc();
+    FIO_ASSERT(a, "pool allocation failed!");
+    fio___pool_test_free(a);
+    FIO_ASSERT(fio___pool_test_alloc() == a,
+               "the last freed object should be reused first");
+    fio___pool_test_free(a);
+    fio___pool_test_task(NULL);
+    const size_t carved = fio___pool_test___pool.objects;
+    fio___pool_test_task(NULL);
+    FIO_ASSERT(fio___pool_test___pool.objects == carved,
+               "freed objects should be reused (no new slabs)");
+  }
+#if FIO_OS_POSIX
+  { /* threads - objects move between threads through the depot */
+    fio_thread_t threads[4];
+    for (size_t i = 0; i < 4; ++i)
+      FIO_ASSERT(!fio_thread_create(threads + i, fio___pool_test_task, NULL),
+                 "couldn't start pool test thread");
+    for (size_t i = 0; i < 4; ++i)
+      fio_thread_join(threads + i);
+    FIO_ASSERT(!fio___pool_test_destroy(),
+               "all objects were returned, pool memory should be released");
+    FIO_ASSERT(!fio___pool_test___pool.objects && !fio___pool_test___pool.slabs,
+               "pool destruction should release all slabs");
+    fio___pool_test_s *a = fio___pool_test_alloc();
+    FIO_ASSERT(a, "pool allocation failed after pool was destroyed!");
+    FIO_ASSERT(fio___pool_test_destroy() == -1,
+               "pool memory should be retained while objects are in use");
+    fio___pool_test_free(a);
+  }
+#endif
+  { /* reference counted objects */
+    fio___pool_test_s *small = fio___pool_test_ref_new(16);
+    fio___pool_test_s *big = fio___pool_test_ref_new(128);
+    FIO_ASSERT(small && big, "pooled reference allocation failed!");
+    FIO_ASSERT(fio___pool_test_ref___pool.objects,
+               "small flexible objects should be pooled");
+    FIO_ASSERT(!small->index && !big->index,
+               "pooled reference objects should be initialized");
+    fio___pool_test_ref_dup(small);
+    fio___pool_test_ref_free(small);
+    fio___pool_test_ref_free(small);
+    fio___pool_test_ref_free(big);
+    FIO_ASSERT(fio___pool_test_ref_new(16) == small,
+               "freed pooled reference objects should be reused");
+    fio___pool_test_ref_free(small);
+  }
+}
+#undef FIO___POOL_TEST_OBJECTS
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_TEST_ALL */
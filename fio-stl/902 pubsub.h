@@ -130,7 +130,7 @@ FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_roundtrip)(void) {
     fio_unsubscribe FIO_NOOP(sub[i]);
     --delta;
     --expected;
-    fio_queue_perform_all(fio___srv_tasks);
+    fio_queue_perform_all(fio_srv_queue());
     FIO_ASSERT(state == expected, "unsubscribe should call callback");
     FIO___PUBLISH2TEST();
     FIO_ASSERT(state == expected, "pub/sub test state incorrect (3-%d)", i);
@@ -140,6 +140,68 @@ FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_roundtrip)(void) {
 #undef FIO___PUBLISH2TEST
 }
 
+/* *****************************************************************************
+IO Bound Subscriptions (reactor threads)
+***************************************************************************** */
+#if FIO_OS_POSIX
+
+/* state: [0] the IO's reactor thread, [1] on_message's thread, [2] peer fd */
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_thread_on_message)(fio_msg_s *msg) {
+  int *state = (int *)msg->udata;
+  state[1] = fio_srv_thread();
+  fio_srv_stop();
+}
+
+/* attaches an IO to the calling (non-main) reactor, subscribes and publishes */
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_thread_task)(void *state_,
+                                                      void *ignr_) {
+  int *state = (int *)state_;
+  int fds[2];
+  FIO_ASSERT(!socketpair(AF_UNIX, SOCK_STREAM, 0, fds), "socketpair failed");
+  state[0] = fio_srv_thread();
+  state[2] = fds[1];
+  fio_s *io = fio_srv_attach_fd(fds[0], NULL, NULL, NULL);
+  fio_subscribe(.io = io,
+                .channel = FIO_BUF_INFO1((char *)"pubsub_thread_channel"),
+                .on_message = FIO_NAME_TEST(stl, pubsub_thread_on_message),
+                .udata = state_,
+                .filter = -127);
+  fio_publish(.channel = FIO_BUF_INFO1((char *)"pubsub_thread_channel"),
+              .filter = -127);
+  (void)ignr_;
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_thread_on_start)(void *state_) {
+  fio___srv_defer_to(fio___srvdata.reactors,
+                     FIO_SRV_LANE_USER,
+                     FIO_NAME_TEST(stl, pubsub_thread_task),
+                     state_,
+                     NULL);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_threads)(void) {
+  fprintf(stderr, "* Testing pub/sub IO bound subscriptions (threads).\n");
+  int state[3] = {-1, -1, -1};
+  const uint16_t old = fio_srv_threads();
+  fio_srv_threads_set(2);
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         FIO_NAME_TEST(stl, pubsub_thread_on_start),
+                         state);
+  fio_srv_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            FIO_NAME_TEST(stl, pubsub_thread_on_start),
+                            state);
+  fio_srv_threads_set(old);
+  if (state[2] != -1)
+    fio_sock_close(state[2]);
+  FIO_ASSERT(state[0] == 1, "the IO should be attached by reactor thread 1");
+  FIO_ASSERT(state[1] == state[0],
+             "on_message should be performed by the IO's reactor (%d != %d)",
+             state[1],
+             state[0]);
+}
+#endif /* FIO_OS_POSIX */
+
 /* *****************************************************************************
 
 ***************************************************************************** */
@@ -147,6 +209,9 @@ FIO_SFUNC void FIO_NAME_TEST(stl, pubsub_roundtrip)(void) {
 FIO_SFUNC void FIO_NAME_TEST(stl, pubsub)(void) {
   FIO_NAME_TEST(stl, pubsub_encryption)();
   FIO_NAME_TEST(stl, pubsub_roundtrip)();
+#if FIO_OS_POSIX
+  FIO_NAME_TEST(stl, pubsub_threads)();
+#endif /* FIO_OS_POSIX */
   fio___srv_cleanup_at_exit(NULL);
 }
 
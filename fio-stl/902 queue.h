@@ -79,11 +79,97 @@ FIO_SFUNC void fio___queue_test_sched_sample_task(void *t_, void *i_count) {
   }
 }
 
+typedef struct {
+  fio_queue_s *q;
+  size_t count;
+  size_t total;
+  uintptr_t *counter;
+} fio___queue_test_mpmc_s;
+
+FIO_SFUNC void *fio___queue_test_mpmc_producer(void *info_) {
+  fio___queue_test_mpmc_s *info = (fio___queue_test_mpmc_s *)info_;
+  for (size_t i = 0; i < info->count; ++i) {
+    FIO_ASSERT(!fio_queue_push(info->q,
+                               .fn = fio___queue_test_sample_task,
+                               .udata1 = info->counter),
+               "Couldn't push task!");
+  }
+  return NULL;
+}
+
+FIO_SFUNC void *fio___queue_test_mpmc_consumer(void *info_) {
+  fio___queue_test_mpmc_s *info = (fio___queue_test_mpmc_s *)info_;
+  for (;;) {
+    uintptr_t performed;
+    fio_atomic_load(performed, info->counter);
+    if (performed >= info->total)
+      break;
+    if (fio_queue_perform(info->q))
+      FIO_THREAD_RESCHEDULE();
+  }
+  return NULL;
+}
+
+#define FIO___QUEUE_TEST_FANOUT_DEPTH 8 /* 4^8 leaves */
+
+FIO_SFUNC void fio___queue_test_fanout_task(void *t_, void *depth_) {
+  fio___queue_test_s *t = (fio___queue_test_s *)t_;
+  size_t depth = (size_t)(uintptr_t)depth_;
+  if (!depth) {
+    fio_atomic_add(t->counter, 1);
+    return;
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    FIO_ASSERT(!fio_queue_push(t->q,
+                               fio___queue_test_fanout_task,
+                               t,
+                               (void *)(uintptr_t)(depth - 1)),
+               "Couldn't push task!");
+  }
+  /* `t->count` marks work-stealing workers, where pushed tasks stay local */
+  if (t->count && depth == FIO___QUEUE_TEST_FANOUT_DEPTH)
+    FIO_ASSERT(!fio_queue_count(t->q),
+               "tasks pushed by work-stealing workers should stay local");
+}
+
+/* replaces the task's push time with the time it waited in the queue */
+FIO_SFUNC void fio___queue_test_latency_task(void *sample_, void *counter_) {
+  int64_t *sample = (int64_t *)sample_;
+  sample[0] = fio_time_nano() - sample[0];
+  fio_atomic_add((uintptr_t *)counter_, 1);
+}
+
+FIO_SFUNC int fio___queue_test_latency_cmp(const void *a_, const void *b_) {
+  const int64_t a = ((const int64_t *)a_)[0], b = ((const int64_t *)b_)[0];
+  return (a > b) - (a < b);
+}
+
 FIO_SFUNC int fio___queue_test_timer_task(void *i_count, void *unused2) {
   fio_atomic_add((uintptr_t *)i_count, 1);
   return (unused2 ? -1 : 0);
 }
 
+/* tests that timers are performed in order, `due_` is the timer's due time */
+FIO_SFUNC int fio___queue_test_timer_order(void *last_, void *due_) {
+  int64_t *last = (int64_t *)last_;
+  FIO_ASSERT((int64_t)(intptr_t)due_ >= *last,
+             "timers performed out of order (%zd < %zd)",
+             (ssize_t)(intptr_t)due_,
+             (ssize_t)*last);
+  *last = (int64_t)(intptr_t)due_;
+  return 0;
+}
+
+#if FIO_QUEUE_STATS
+/* busy-waits for `us_` microseconds. */
+FIO_SFUNC void fio___queue_test_slow_task(void *us_, void *unused2) {
+  const int64_t until = fio_time_micro() + (int64_t)(uintptr_t)us_;
+  while (fio_time_micro() < until)
+    ;
+  (void)unused2;
+}
+#endif
+
 FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
   fprintf(stderr, "* Testing facil.io task scheduling (fio_queue)\n");
   /* ************** testing queue ************** */
@@ -156,6 +242,60 @@ FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
   }
   FIO_ASSERT(i_count == i_count_should_be, "ERROR: queue count invalid\n");
 
+  { /* batch push / pop / perform - order and data integrity */
+    fio_queue_task_s tasks[100];
+    size_t pushed = 0;
+    fio___queue_test_counter_task(NULL, NULL);
+    for (size_t round = 0; round < (FIO_QUEUE_TASKS_PER_ALLOC >> 2); ++round) {
+      for (size_t i = 0; i < 100; ++i, ++pushed)
+        tasks[i] = (fio_queue_task_s){.fn = fio___queue_test_counter_task,
+                                      .udata1 = (void *)(pushed + 1),
+                                      .udata2 = (void *)(pushed + 2)};
+      FIO_ASSERT(fio_queue_push_many(q, tasks, 100) == 100,
+                 "fio_queue_push_many didn't push all the tasks");
+      fio_queue_push(q,
+                     .fn = fio___queue_test_counter_task,
+                     .udata1 = (void *)(pushed + 1),
+                     .udata2 = (void *)(pushed + 2));
+      ++pushed;
+    }
+    FIO_ASSERT(fio_queue_count(q) == pushed,
+               "fio_queue_push_many count error (%zu != %zu)",
+               (size_t)fio_queue_count(q),
+               pushed);
+    FIO_ASSERT(fio_queue_pop_many(q, tasks, 7) == 7,
+               "fio_queue_pop_many should pop the requested number of tasks");
+    for (size_t i = 0; i < 7; ++i)
+      tasks[i].fn(tasks[i].udata1, tasks[i].udata2);
+    FIO_ASSERT(fio_queue_perform_batch(q, 1000) == 1000,
+               "fio_queue_perform_batch should stop at `max`");
+    FIO_ASSERT(fio_queue_perform_batch(q, (size_t)-1) == pushed - 1007,
+               "fio_queue_perform_batch should perform all remaining tasks");
+    FIO_ASSERT(!fio_queue_count(q) && !fio_queue_pop_many(q, tasks, 100),
+               "fio_queue_perform_batch didn't perform all");
+  }
+
+  i_count = 0;
+  start = fio_time_milli();
+  {
+    fio_queue_task_s tasks[FIO_QUEUE_BATCH];
+    for (size_t i = 0; i < FIO_QUEUE_BATCH; ++i)
+      tasks[i] = (fio_queue_task_s){.fn = fio___queue_test_sample_task,
+                                    .udata1 = (void *)&i_count};
+    for (size_t i = 0; i < FIO___QUEUE_TOTAL_COUNT; i += FIO_QUEUE_BATCH)
+      fio_queue_push_many(q, tasks, FIO_QUEUE_BATCH);
+    fio_queue_perform_batch(q, (size_t)-1);
+  }
+  end = fio_time_milli();
+  if (FIO___QUEUE_TEST_PRINT) {
+    fprintf(stderr,
+            "\t- batched (%zu) task counter: %lu ms with i_count = %lu\n",
+            (size_t)FIO_QUEUE_BATCH,
+            (unsigned long)(end - start),
+            (unsigned long)i_count);
+  }
+  FIO_ASSERT(i_count == i_count_should_be, "ERROR: queue count invalid\n");
+
   if (FIO___QUEUE_TEST_PRINT) {
     fprintf(stderr, "\n");
   }
@@ -224,6 +364,191 @@ FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
   FIO_ASSERT(q->w == &q->mem,
              "queue library didn't release dynamic queue (should be static)");
   fio_queue_free(q);
+  {
+    fprintf(stderr,
+            "* Testing queue contention (%s, producers == consumers)\n",
+            (FIO_QUEUE_LOCKFREE ? "lock-free ring" : "locked ring"));
+    fio_queue_init(&q2);
+    for (size_t threads = 1; threads <= 16; threads <<= 1) {
+      fio_thread_t producers[16], consumers[16];
+      fio___queue_test_mpmc_s info = {
+          .q = &q2,
+          .count = (FIO___QUEUE_TOTAL_COUNT >> 1) / threads,
+          .counter = &i_count,
+      };
+      info.total = info.count * threads;
+      i_count = 0;
+      start = fio_time_milli();
+      for (size_t i = 0; i < threads; ++i) {
+        FIO_ASSERT(!fio_thread_create(consumers + i,
+                                      fio___queue_test_mpmc_consumer,
+                                      &info),
+                   "couldn't start consumer thread");
+        FIO_ASSERT(!fio_thread_create(producers + i,
+                                      fio___queue_test_mpmc_producer,
+                                      &info),
+                   "couldn't start producer thread");
+      }
+      for (size_t i = 0; i < threads; ++i) {
+        fio_thread_join(producers + i);
+        fio_thread_join(consumers + i);
+      }
+      end = fio_time_milli();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- %zu producers / %zu consumers: %lu ms for %zu tasks\n",
+                threads,
+                threads,
+                (unsigned long)(end - start),
+                info.total);
+      }
+      FIO_ASSERT(i_count == info.total && !fio_queue_count(&q2),
+                 "ERROR: queue contention count invalid (%zu != %zu)\n",
+                 (size_t)i_count,
+                 info.total);
+    }
+    FIO_ASSERT(q2.w == &q2.mem,
+               "queue didn't release dynamic ring buffers after contention");
+    fio_queue_destroy(&q2);
+  }
+  {
+    fprintf(stderr, "* Testing worker threads (recursive fan-out)\n");
+    const uintptr_t leaves = (uintptr_t)1 << (FIO___QUEUE_TEST_FANOUT_DEPTH * 2);
+    fio_queue_init(&q2);
+    for (size_t stealing = 0; stealing < 2; ++stealing) {
+      fio___queue_test_s info = {
+          .q = &q2,
+          .count = stealing,
+          .counter = &i_count,
+      };
+      i_count = 0;
+      start = fio_time_milli();
+      FIO_ASSERT(!(stealing ? fio_queue_workers_add_stealing(&q2, 4)
+                            : fio_queue_workers_add(&q2, 4)),
+                 "couldn't start worker threads");
+      fio_queue_push(&q2,
+                     fio___queue_test_fanout_task,
+                     &info,
+                     (void *)(uintptr_t)FIO___QUEUE_TEST_FANOUT_DEPTH);
+      for (;;) {
+        uintptr_t performed;
+        fio_atomic_load(performed, &i_count);
+        if (performed >= leaves)
+          break;
+        FIO_THREAD_RESCHEDULE();
+      }
+      fio_queue_workers_join(&q2);
+      end = fio_time_milli();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- 4 %s workers: %lu ms for %zu leaf tasks\n",
+                (stealing ? "work-stealing" : "shared queue"),
+                (unsigned long)(end - start),
+                (size_t)leaves);
+      }
+      FIO_ASSERT(i_count == leaves && !fio_queue_count(&q2),
+                 "ERROR: fan-out count invalid (%zu != %zu)\n",
+                 (size_t)i_count,
+                 (size_t)leaves);
+    }
+    fio_queue_destroy(&q2);
+  }
+  {
+    /* tasks arrive slower than they are performed, so workers are idle */
+    const size_t samples = 4096;
+    fprintf(stderr,
+            "* Testing worker wake-up latency (spin budget: %zu)\n",
+            (size_t)FIO_QUEUE_SPIN);
+    int64_t *lat =
+        (int64_t *)FIO_MEM_REALLOC(NULL, 0, sizeof(*lat) * samples, 0);
+    FIO_ASSERT_ALLOC(lat);
+    fio_queue_init(&q2);
+    FIO_ASSERT(!fio_queue_workers_add(&q2, 2), "couldn't start worker threads");
+    i_count = 0;
+    for (size_t i = 0; i < samples; ++i) {
+      lat[i] = fio_time_nano();
+      fio_queue_push(&q2, fio___queue_test_latency_task, lat + i, &i_count);
+      for (;;) {
+        uintptr_t performed;
+        fio_atomic_load(performed, &i_count);
+        if (performed > i)
+          break;
+        fio_thread_yield();
+      }
+      if ((i & 3) == 3)
+        FIO_THREAD_WAIT(50000); /* long enough for workers to park */
+    }
+    fio_queue_workers_join(&q2);
+    fio_queue_destroy(&q2);
+    FIO_ASSERT(i_count == samples, "wake-up latency tasks weren't performed");
+    qsort(lat, samples, sizeof(*lat), fio___queue_test_latency_cmp);
+    if (FIO___QUEUE_TEST_PRINT) {
+      fprintf(stderr,
+              "\t- push to perform: p50 %zu ns, p99 %zu ns, max %zu ns\n",
+              (size_t)lat[samples >> 1],
+              (size_t)lat[samples - 1 - (samples / 100)],
+              (size_t)lat[samples - 1]);
+    }
+    FIO_MEM_FREE(lat, sizeof(*lat) * samples);
+  }
+#if FIO_QUEUE_STATS
+  {
+    fprintf(stderr, "* Testing queue statistics (FIO_QUEUE_STATS)\n");
+    fio_timer_queue_s tq = FIO_TIMER_QUEUE_INIT;
+    fio_queue_stats_s *st;
+    fio_queue_fn_stats_s *fast = NULL, *slow = NULL, *timer = NULL;
+    fio_queue_init(&q2);
+    i_count = 0;
+    for (size_t i = 0; i < 100; ++i)
+      fio_queue_push(&q2, fio___queue_test_sample_task, (void *)&i_count);
+    fio_queue_push(&q2, fio___queue_test_slow_task, (void *)(uintptr_t)2000);
+    fio_timer_schedule(&tq,
+                       .fn = fio___queue_test_timer_task,
+                       .udata1 = (void *)&i_count,
+                       .every = 1,
+                       .repetitions = 1,
+                       .start_at = fio_time_milli() - 10);
+    fio_timer_push2queue(&q2, &tq, 0);
+    FIO_THREAD_WAIT(1000000); /* tasks wait (at least) a millisecond */
+    fio_queue_perform_all(&q2);
+    st = fio_queue_stats(&q2);
+    for (size_t i = 0; i < FIO_QUEUE_STATS_FUNCTIONS; ++i) {
+      if (st->fn[i].fn == fio___queue_test_sample_task)
+        fast = st->fn + i;
+      if (st->fn[i].fn == fio___queue_test_slow_task)
+        slow = st->fn + i;
+      if ((uintptr_t)st->fn[i].fn == (uintptr_t)fio___queue_test_timer_task)
+        timer = st->fn + i;
+    }
+    if (FIO___QUEUE_TEST_PRINT)
+      fio_queue_stats_print(&q2);
+    FIO_ASSERT(i_count == 101, "statistics test tasks weren't performed");
+    FIO_ASSERT(st->pushed == 102 && st->performed == 102 && !st->untracked,
+               "queue statistics task counts error (%zu, %zu)",
+               (size_t)st->pushed,
+               (size_t)st->performed);
+    FIO_ASSERT(st->depth_max == 102,
+               "queue depth high-water mark error (%zu)",
+               (size_t)st->depth_max);
+    FIO_ASSERT(st->wait_max >= 1000000 &&
+                   fio_queue_stats_percentile(st->wait, 0.5) >= 1024,
+               "queue wait time wasn't recorded");
+    FIO_ASSERT(fast && fast->count == 100 && slow && slow->count == 1,
+               "callback statistics missing");
+    FIO_ASSERT(timer && timer->count == 1,
+               "timer tasks should be recorded using the timer's callback");
+    FIO_ASSERT(slow->max >= 1900000 && slow->total == slow->max &&
+                   fio_queue_stats_percentile(slow->hist, 0.99) >= 1024 &&
+                   fio_queue_stats_percentile(fast->hist, 0.5) <
+                       fio_queue_stats_percentile(slow->hist, 0.5),
+               "callback run time wasn't recorded");
+    fio_queue_stats_reset(&q2);
+    FIO_ASSERT(!st->pushed && !st->fn[0].fn && !st->wait_max,
+               "fio_queue_stats_reset failed");
+    fio_timer_destroy(&tq);
+    fio_queue_destroy(&q2);
+  }
+#endif
   {
     fprintf(stderr, "* Testing urgent insertion\n");
     fio_queue_init(&q2);
@@ -353,11 +678,81 @@ FIO_SFUNC void FIO_NAME_TEST(stl, queue)(void) {
         tester == 3,
         "fio_timer_destroy should have called on_finish of future task (%zu).",
         (size_t)tester);
-    FIO_ASSERT(!tq.next, "timer queue should be empty.");
+    FIO_ASSERT(fio_timer_next_at(&tq) == -1, "timer queue should be empty.");
+
+    /* test timers far in the future (beyond the timing wheel) */
+    tester = 0;
+    for (size_t i = 0; i < 3; ++i) {
+      fio_timer_schedule(&tq,
+                         .fn = fio___queue_test_timer_task,
+                         .udata1 = (void *)&tester,
+                         .every = 1,
+                         .start_at = milli_now + (int64_t)(i ? (1LL << 37) : 0) +
+                                     (int64_t)(i << 2));
+    }
+    FIO_ASSERT(fio_timer_push2queue(&q2, &tq, milli_now + 1) == 1,
+               "only the first timer should be due");
+    FIO_ASSERT(fio_timer_next_at(&tq) == milli_now + (1LL << 37) + 5,
+               "fio_timer_next_at value error for a distant timer.");
+    FIO_ASSERT(!fio_timer_push2queue(&q2, &tq, milli_now + (1LL << 37) + 4),
+               "distant timers shouldn't be due");
+    FIO_ASSERT(fio_timer_push2queue(&q2, &tq, milli_now + (1LL << 37) + 9) == 2,
+               "distant timers should be due");
+    fio_queue_perform_all(&q2);
+    FIO_ASSERT(tester == 3 && fio_timer_next_at(&tq) == -1,
+               "all timers should have been performed (%zu)",
+               (size_t)tester);
+
+    /* test timer ordering and the timing wheel's cost (1M timers) */
+    {
+      const size_t timer_count = 1024 * 1024;
+      int64_t last = 0;
+      milli_now = fio_time_milli();
+      start = fio_time_micro();
+      for (size_t i = 0; i < timer_count; ++i) {
+        /* spread over a minute (cascades through several wheel levels) */
+        const uint32_t every = 1 + (uint32_t)((i * 7919) % 60000);
+        fio_timer_schedule(&tq,
+                           .fn = fio___queue_test_timer_order,
+                           .udata1 = (void *)&last,
+                           .udata2 = (void *)(intptr_t)(milli_now + every),
+                           .every = every,
+                           .start_at = milli_now);
+      }
+      end = fio_time_micro();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- scheduled %zu timers in %lu us\n",
+                timer_count,
+                (unsigned long)(end - start));
+      }
+      size_t performed = 0;
+      start = fio_time_micro();
+      for (int64_t now = milli_now; now <= milli_now + 60000; now += 250) {
+        performed += fio_timer_push2queue(&q2, &tq, now);
+        fio_queue_perform_all(&q2);
+        FIO_ASSERT(fio_timer_next_at(&tq) > now ||
+                       fio_timer_next_at(&tq) == -1,
+                   "a due timer wasn't pushed to the queue");
+      }
+      end = fio_time_micro();
+      if (FIO___QUEUE_TEST_PRINT) {
+        fprintf(stderr,
+                "\t- expired and performed %zu timers in %lu us\n",
+                performed,
+                (unsigned long)(end - start));
+      }
+      FIO_ASSERT(performed == timer_count && fio_timer_next_at(&tq) == -1,
+                 "all timers should have been performed (%zu / %zu)",
+                 performed,
+                 timer_count);
+    }
+    fio_timer_destroy(&tq);
     fio_queue_destroy(&q2);
   }
   fprintf(stderr, "* passed.\n");
 }
+#undef FIO___QUEUE_TEST_FANOUT_DEPTH
 /* *****************************************************************************
 Cleanup
 ***************************************************************************** */
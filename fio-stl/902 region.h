@@ -0,0 +1,101 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_TEST_ALL           /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                        FIO_REGION_NAME Test Helper
+
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_TEST_ALL) && !defined(FIO___TEST_REINCLUDE) &&                 \
+    !defined(H___FIO_REGION_TEST___H)
+#define H___FIO_REGION_TEST___H
+
+/* types defined with the region allocate from the thread's current region */
+#define FIO_REGION_NAME      fio___region_test
+#define FIO_REGION_PAGE_SIZE 1024
+#define FIO_STR_NAME         fio___region_test_str
+#define FIO_ARRAY_NAME       fio___region_test_ary
+#define FIO_ARRAY_TYPE       size_t
+#define FIO___TEST_REINCLUDE
+#include FIO_INCLUDE_FILE
+#undef FIO___TEST_REINCLUDE
+
+FIO_SFUNC void FIO_NAME_TEST(stl, region)(void) {
+  fprintf(stderr, "* Testing region allocator (bump allocation + reset).\n");
+  fio___region_test_s *r = fio___region_test_new();
+  FIO_ASSERT(r, "region allocation failed!");
+  { /* bump allocation */
+    char *a = (char *)fio___region_test_malloc(r, 1);
+    char *b = (char *)fio___region_test_malloc(r, 24);
+    FIO_ASSERT(a && b, "region allocation failed!");
+    FIO_ASSERT(!((uintptr_t)a & 15) && !((uintptr_t)b & 15),
+               "region allocations should be aligned");
+    FIO_ASSERT(b == a + 16, "region allocations should be consecutive");
+    FIO_ASSERT(fio___region_test_realloc2(r, b, 64, 24) == b,
+               "the last allocation should grow in place");
+    FIO_ASSERT(fio___region_test_realloc2(r, a, 64, 1) != a,
+               "an older allocation can't grow in place");
+    char *c = (char *)fio___region_test_malloc(r, 16);
+    fio___region_test_dealloc(r, c);
+    FIO_ASSERT(fio___region_test_malloc(r, 16) == c,
+               "freeing the last allocation should allow its reuse");
+    /* fill a few pages (and a dedicated page for a large allocation) */
+    for (size_t i = 0; i < 256; ++i) {
+      char *tmp = (char *)fio___region_test_malloc(r, 48);
+      FIO_ASSERT(tmp, "region allocation failed (%zu)!", i);
+      FIO_MEMSET(tmp, (int)i, 48);
+    }
+    char *big = (char *)fio___region_test_malloc(r, 4096);
+    FIO_ASSERT(big, "large region allocation failed!");
+    FIO_MEMSET(big, 1, 4096);
+    big = (char *)fio___region_test_realloc2(r, big, 8192, 4096);
+    FIO_ASSERT(big && big[4095] == 1,
+               "large region reallocation should copy data");
+    fio___region_test_reset(r);
+    FIO_ASSERT(fio___region_test_malloc(r, 1) == a,
+               "reset should reuse the region's first page");
+  }
+  { /* types instantiated on top of the region */
+    fio___region_test_reset(r);
+    fio___region_test_s *old = fio___region_test_use(r);
+    FIO_ASSERT(fio___region_test_current() == r,
+               "the thread's current region should be set");
+    fio___region_test_str_s *s = fio___region_test_str_new();
+    FIO_ASSERT(s, "string allocation on the region failed!");
+    for (size_t i = 0; i < 128; ++i)
+      fio___region_test_str_write(s, "Hello World! ", 13);
+    FIO_ASSERT(fio___region_test_str_len(s) == 128 * 13,
+               "string written to the region has the wrong length");
+    FIO_ASSERT(!FIO_MEMCMP(fio___region_test_str_ptr(s) + (127 * 13),
+                           "Hello World! ",
+                           13),
+               "string written to the region has the wrong data");
+    fio___region_test_ary_s ary = FIO_ARRAY_INIT;
+    for (size_t i = 0; i < 1024; ++i)
+      fio___region_test_ary_push(&ary, i);
+    for (size_t i = 0; i < 1024; ++i)
+      FIO_ASSERT(fio___region_test_ary_get(&ary, (int32_t)i) == i,
+                 "array allocated on the region has the wrong data");
+    fio___region_test_ary_destroy(&ary);
+    fio___region_test_str_free(s);
+    fio___region_test_reset(r);
+    FIO_ASSERT(fio___region_test_use(old) == r,
+               "the previous current region should be returned");
+  }
+  fio___region_test_free(r);
+}
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_TEST_ALL */
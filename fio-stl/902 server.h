@@ -290,12 +290,226 @@ FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), env)(void) {
   FIO_ASSERT(a == 2 && b == 1 && c == 1, "destroy should call callbacks.");
 }
 
+/* *****************************************************************************
+Test Task Lanes
+***************************************************************************** */
+
+/* logs the task's lane, slow tasks busy-wait for 200 microseconds */
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             lane_task)(void *log_, void *lane_) {
+  size_t *log = (size_t *)log_;
+  if ((uintptr_t)lane_ & 256) {
+    const int64_t until = fio_time_micro() + 200;
+    while (fio_time_micro() < until)
+      ;
+  }
+  log[++log[0]] = (uintptr_t)lane_ & 255;
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lanes)(void) {
+  fprintf(stderr, "   * Testing server task lanes.\n");
+  size_t log[128] = {0};
+  const size_t weights[FIO___SRV_LANES] = FIO_SRV_LANE_WEIGHTS;
+  FIO_ASSERT(fio_srv_queue() == fio_srv_lane(FIO_SRV_LANE_USER),
+             "the server's queue should be the user lane");
+  FIO_ASSERT(!fio___srv_lanes_count(), "server lanes should start empty");
+  for (size_t i = 0; i < 40; ++i) {
+    fio_queue_push(fio_srv_lane(FIO_SRV_LANE_BACKGROUND),
+                   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lane_task),
+                   log,
+                   (void *)(uintptr_t)FIO_SRV_LANE_BACKGROUND);
+    fio_queue_push(fio_srv_lane(FIO_SRV_LANE_IO),
+                   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lane_task),
+                   log,
+                   (void *)(uintptr_t)FIO_SRV_LANE_IO);
+  }
+  fio___srv_lanes_perform(1000000);
+  FIO_ASSERT(log[0] == 80 && !fio___srv_lanes_count(),
+             "all lane tasks should have been performed (%zu)",
+             log[0]);
+  /* the first round performs a lane's weight of tasks from each lane */
+  for (size_t i = 1; i <= weights[FIO_SRV_LANE_IO]; ++i)
+    FIO_ASSERT(log[i] == FIO_SRV_LANE_IO, "IO lane should be performed first");
+  FIO_ASSERT(log[weights[FIO_SRV_LANE_IO] + 1] == FIO_SRV_LANE_BACKGROUND,
+             "background lane should be performed each round (weighted)");
+  /* the time budget limits the work performed in each cycle */
+  log[0] = 0;
+  for (size_t i = 0; i < 100; ++i)
+    fio_queue_push(fio_srv_lane(FIO_SRV_LANE_BACKGROUND),
+                   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lane_task),
+                   log,
+                   (void *)(uintptr_t)(FIO_SRV_LANE_BACKGROUND | 256));
+  fio___srv_lanes_perform(1000);
+  FIO_ASSERT(log[0] && log[0] < 100 && fio___srv_lanes_count() == 100 - log[0],
+             "the lanes' time budget should have been honored (%zu)",
+             log[0]);
+  fio___srv_lanes_perform_all();
+  FIO_ASSERT(log[0] == 100 && !fio___srv_lanes_count(),
+             "fio___srv_lanes_perform_all should perform all tasks");
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), busy_poll)(void) {
+  fprintf(stderr, "   * Testing server busy polling.\n");
+  const uint32_t old = fio_srv_busy_poll_get();
+  int64_t start;
+  fio_srv_busy_poll_set(1000000);
+  FIO_ASSERT(fio_srv_busy_poll_get() == 1000000, "busy-poll window not set");
+  fio___srv_main_reactor->busy_since = fio_time_micro();
+  start = fio_time_milli();
+  fio___srv_tick(200);
+  FIO_ASSERT(fio_time_milli() - start < 100 &&
+                 fio___srv_main_reactor->busy_spinning,
+             "the reactor shouldn't block within the busy-poll window");
+  fio___srv_main_reactor->busy_since -= 2000000;
+  fio___srv_tick(200);
+  FIO_ASSERT(!fio___srv_main_reactor->busy_spinning,
+             "the reactor should stop spinning once the window passed");
+  fio_srv_busy_poll_set(old);
+}
+
+FIO_SFUNC ssize_t FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                                write_mock)(int fd,
+                                            const void *buf,
+                                            size_t len,
+                                            void *tls) {
+  return fio_sock_write(fd, buf, len);
+  (void)tls;
+}
+
+/* counts the `writev` calls that send more than a single buffer. */
+static size_t FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_multi);
+
+FIO_SFUNC ssize_t FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                                writev_mock)(int fd,
+                                             const struct iovec *iov,
+                                             size_t count,
+                                             void *tls) {
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_multi) += (count > 1);
+  return fio___io_func_default_writev(fd, iov, count, tls);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev)(void) {
+  fprintf(stderr, "   * Testing server vectored writes.\n");
+  fio_protocol_s pr = {0}, custom = {0}, counted = {0};
+  custom.io_functions.write =
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), write_mock);
+  counted.io_functions.writev =
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_mock);
+  fio___srv_init_protocol_test(&pr, 0);
+  fio___srv_init_protocol_test(&custom, 0);
+  fio___srv_init_protocol_test(&counted, 0);
+  FIO_ASSERT(pr.io_functions.writev == fio___io_func_default_writev,
+             "the default IO functions should offer a vectored write");
+  FIO_ASSERT(!custom.io_functions.writev,
+             "a custom `write` shouldn't be bypassed by the default `writev`");
+#if FIO_OS_POSIX
+  static char data[4][256];
+  char buf[1024 + 1];
+  size_t got = 0;
+  int fds[2];
+  FIO_ASSERT(!socketpair(AF_UNIX, SOCK_STREAM, 0, fds), "socketpair failed");
+  fio_s *io = fio_srv_attach_fd(fds[0], &counted, NULL, NULL);
+  fio___srv_lanes_perform_all();
+  for (size_t i = 0; i < 4; ++i) {
+    FIO_MEMSET(data[i], (int)('a' + i), 256);
+    fio_write2(io, .buf = data[i], .len = 256); /* no copy, packet per write */
+  }
+  fio___srv_lanes_perform_all();
+  while (got < 1024 && fio_sock_wait_io(fds[1], POLLIN, 100) > 0) {
+    ssize_t r = fio_sock_read(fds[1], buf + got, 1024 - got);
+    if (r <= 0)
+      break;
+    got += (size_t)r;
+  }
+  FIO_ASSERT(got == 1024, "vectored write data missing (%zu / 1024)", got);
+  FIO_ASSERT(FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev_multi),
+             "queued packets should be sent by a single `writev` call");
+  for (size_t i = 0; i < 1024; ++i)
+    FIO_ASSERT(buf[i] == (char)('a' + (i >> 8)),
+               "vectored write data / order error @ %zu",
+               i);
+  fio_close(io);
+  fio___srv_lanes_perform_all();
+  fio_sock_close(fds[1]);
+#endif
+}
+
+/* state: [0] expected, [1] performed, [2] misplaced tasks */
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             thread_task2)(void *state_, void *id_) {
+  size_t *state = (size_t *)state_;
+  if (fio_srv_thread() != (int)(uintptr_t)id_)
+    fio_atomic_add(state + 2, 1);
+  if (fio_atomic_add(state + 1, 1) + 1 == state[0])
+    fio_srv_stop();
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             thread_task)(void *state_, void *id_) {
+  if (fio_srv_thread() != (int)(uintptr_t)id_)
+    fio_atomic_add((size_t *)state_ + 2, 1);
+  /* deferred tasks should be performed by the same reactor thread */
+  fio_srv_defer(FIO_NAME_TEST(FIO_NAME_TEST(stl, server), thread_task2),
+                state_,
+                id_);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server),
+                             threads_on_start)(void *state_) {
+  size_t *state = (size_t *)state_;
+  state[0] = fio___srvdata.reactor_count;
+  fio_srv_defer_main(FIO_NAME_TEST(FIO_NAME_TEST(stl, server), thread_task),
+                     state_,
+                     NULL);
+  for (uint16_t i = 1; i < fio___srvdata.reactor_count; ++i)
+    fio___srv_defer_to(fio___srvdata.reactors + (i - 1),
+                       FIO_SRV_LANE_USER,
+                       FIO_NAME_TEST(FIO_NAME_TEST(stl, server), thread_task),
+                       state_,
+                       (void *)(uintptr_t)i);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads)(void) {
+  fprintf(stderr, "   * Testing server reactor threads.\n");
+  size_t state[3] = {0};
+  const uint16_t old = fio_srv_threads();
+  fio_srv_threads_set(3);
+  FIO_ASSERT(fio_srv_threads() == 3, "reactor thread count not set");
+  FIO_ASSERT(fio_srv_thread() == -1, "not a reactor thread (yet)");
+  void *listener = fio_srv_listen(.url = "tcp://127.0.0.1:9441",
+                                  .protocol = &FIO___MOCK_PROTOCOL,
+                                  .hide_from_log = 1);
+  FIO_ASSERT(listener, "couldn't listen (with reactor threads)");
+  fio_state_callback_add(
+      FIO_CALL_ON_START,
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads_on_start),
+      state);
+  fio_srv_start(0);
+  fio_state_callback_remove(
+      FIO_CALL_ON_START,
+      FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads_on_start),
+      state);
+  fio_srv_listen_stop(listener);
+  FIO_ASSERT(state[0] == 3 && state[1] == 3,
+             "each reactor thread should perform its tasks (%zu/%zu)",
+             state[1],
+             state[0]);
+  FIO_ASSERT(!state[2], "tasks should be performed by their reactor thread");
+  FIO_ASSERT(fio_srv_thread() == -1 && !fio___srvdata.reactors,
+             "reactor threads should be joined once the server stops");
+  fio_srv_threads_set(old);
+}
+
 /* *****************************************************************************
 Test Server Modules
 ***************************************************************************** */
 
 FIO_SFUNC void FIO_NAME_TEST(stl, server)(void) {
   fprintf(stderr, "* Testing fio_srv units (TODO).\n");
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), lanes)();
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), busy_poll)();
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), writev)();
+  FIO_NAME_TEST(FIO_NAME_TEST(stl, server), threads)();
   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), env)();
   FIO_NAME_TEST(FIO_NAME_TEST(stl, server), tls_helpers)();
 }
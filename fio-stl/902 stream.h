@@ -160,6 +160,21 @@ FIO_SFUNC void FIO_NAME_TEST(stl, stream)(void) {
 
   fio_stream_add(&s, fio_stream_pack_fd(open(__FILE__, O_RDONLY), 20, 0, 0));
   FIO_ASSERT(fio_stream_length(&s) == 80, "stream length error (3).");
+  {
+    struct iovec iov[8];
+    size_t count = fio_stream_read_iov(&s, iov, 8);
+    FIO_ASSERT(count == 2,
+               "fio_stream_read_iov should stop at file packets (%zu)",
+               count);
+    FIO_ASSERT(iov[0].iov_len == 40 && iov[1].iov_len == 20 &&
+                   !memcmp(str + 20, iov[0].iov_base, 40) &&
+                   !memcmp(str + 60, iov[1].iov_base, 20),
+               "fio_stream_read_iov data error");
+    FIO_ASSERT(fio_stream_read_iov(&s, iov, 1) == 1 && iov[0].iov_len == 40,
+               "fio_stream_read_iov should honor the `max` limit");
+    FIO_ASSERT(fio_stream_length(&s) == 80,
+               "fio_stream_read_iov shouldn't consume the stream");
+  }
   buf = mem;
   len = 4000;
   fio_stream_read(&s, &buf, &len);
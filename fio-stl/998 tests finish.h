@@ -359,6 +359,16 @@ FIO_SFUNC void fio_test_dynamic_types(void) {
   /* test memory allocator that allows junk data in allocations */
   FIO_NAME_TEST(FIO_NAME(stl, fio_mem_test_unsafe), mem)();
   fprintf(stderr, "===============\n");
+  /* test memory allocator that uses a per-thread cache and huge pages */
+  FIO_NAME_TEST(FIO_NAME(stl, fio_mem_test_tcache), mem)();
+  fprintf(stderr, "===============\n");
+  /* test memory allocator that uses size-class slabs for small objects */
+  FIO_NAME_TEST(FIO_NAME(stl, fio_mem_test_slab), mem)();
+  fprintf(stderr, "===============\n");
+  FIO_NAME_TEST(stl, region)();
+  fprintf(stderr, "===============\n");
+  FIO_NAME_TEST(stl, pool)();
+  fprintf(stderr, "===============\n");
   FIO_NAME_TEST(stl, sock)();
   fprintf(stderr, "===============\n");
   FIO_NAME_TEST(stl, fiobj)();
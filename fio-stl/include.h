@@ -73,9 +73,17 @@
 #if defined(FIO_MEMORY_NAME) || defined(FIO_MALLOC) || defined(FIOBJ_MALLOC)
 #include "010 mem.h"
 #endif
+#if defined(FIO_REGION_NAME) && !defined(FIO___RECURSIVE_INCLUDE)
+#include "011 region.h"
+#endif
+#if defined(FIO_POOL_NAME) || defined(FIO_REF_POOL) ||                         \
+    (FIO_USE_POOL && (defined(FIO_QUEUE) || defined(FIO_STREAM)))
+#include "012 pool.h"
+#endif
 
 #if defined(FIO_POLL) && !defined(FIO___RECURSIVE_INCLUDE)
 #include "102 poll api.h"
+#include "102 poll edge.h"
 #include "102 poll epoll.h"
 #include "102 poll kqueue.h"
 #include "102 poll poll.h"
@@ -171,7 +179,9 @@
 #include "902 poll.h"
 #include "902 pubsub.h"
 #include "902 queue.h"
+#include "902 pool.h"
 #include "902 random.h"
+#include "902 region.h"
 #include "902 server.h"
 #include "902 sock.h"
 #include "902 sort.h"
@@ -0,0 +1,151 @@
+/* *****************************************************************************
+Busy Polling Benchmark - round trip latency vs. the reactor's CPU time.
+
+An echo server is tested by a client thread that sends a small message, waits
+for the echo and "thinks" (sleeps) before sending the next one, so the reactor
+goes idle between messages (as it would for a latency sensitive gateway).
+
+Each round uses a different busy-poll window (see `fio_srv_busy_poll_set`).
+
+Run with: make tests/busy-poll
+***************************************************************************** */
+#define FIO_LOG
+#define FIO_EVERYTHING
+#include "fio-stl/include.h"
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+
+#define BENCH_PORT        "9439"
+#define BENCH_MSG_LEN     64
+#define BENCH_ROUND_TRIPS 4000
+#define BENCH_THINK_US    200
+
+static const uint32_t BENCH_WINDOWS[] = {0, 50, 500, 5000};
+static pthread_t BENCH_SERVER_THREAD;
+
+/* *****************************************************************************
+Echo Server
+***************************************************************************** */
+
+FIO_SFUNC void echo_on_data(fio_s *io) {
+  char buf[4096];
+  size_t len;
+  while ((len = fio_read(io, buf, 4096)))
+    fio_write(io, buf, len);
+}
+
+static fio_protocol_s ECHO_PROTOCOL = {
+    .on_data = echo_on_data,
+    .timeout = 60000,
+};
+
+/* *****************************************************************************
+Client
+***************************************************************************** */
+
+static int64_t bench_thread_cpu(pthread_t t) {
+  clockid_t clk;
+  struct timespec ts;
+  if (pthread_getcpuclockid(t, &clk) || clock_gettime(clk, &ts))
+    return 0;
+  return ((int64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static int bench_cmp(const void *a, const void *b) {
+  const int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int bench_connect(void) {
+  int fd =
+      fio_sock_open("127.0.0.1", BENCH_PORT, FIO_SOCK_TCP | FIO_SOCK_CLIENT);
+  int one = 1;
+  FIO_ASSERT(fd != -1, "couldn't connect to the echo server");
+  FIO_ASSERT(fio_sock_wait_io(fd, POLLOUT, 1000) > 0, "connection timed out");
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK); /* blocking client */
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+/* performs a round trip, returning its duration in nanoseconds. */
+static int64_t bench_round_trip(int fd, char *msg) {
+  char buf[BENCH_MSG_LEN];
+  size_t got = 0;
+  const int64_t start = fio_time_nano();
+  FIO_ASSERT(write(fd, msg, BENCH_MSG_LEN) == BENCH_MSG_LEN, "write failed");
+  while (got < BENCH_MSG_LEN) {
+    ssize_t r = read(fd, buf + got, BENCH_MSG_LEN - got);
+    FIO_ASSERT(r > 0, "read failed");
+    got += (size_t)r;
+  }
+  return fio_time_nano() - start;
+}
+
+static void *bench_client(void *ignr_) {
+  static int64_t rtt[BENCH_ROUND_TRIPS];
+  char msg[BENCH_MSG_LEN];
+  const struct timespec think = {.tv_nsec = BENCH_THINK_US * 1000};
+  FIO_MEMSET(msg, 'x', BENCH_MSG_LEN);
+  fprintf(stderr,
+          "\n%zu round trips (%d bytes), %dus think time, engine: %s\n\n",
+          (size_t)BENCH_ROUND_TRIPS,
+          BENCH_MSG_LEN,
+          BENCH_THINK_US,
+          fio_poll_engine());
+  fprintf(stderr,
+          "| busy-poll window | p50 (us) | p99 (us) | p99.9 (us) "
+          "| reactor CPU |\n"
+          "|---:|---:|---:|---:|---:|\n");
+  for (size_t w = 0; w < sizeof(BENCH_WINDOWS) / sizeof(BENCH_WINDOWS[0]);
+       ++w) {
+    fio_srv_busy_poll_set(BENCH_WINDOWS[w]);
+    int fd = bench_connect(); /* accepted sockets are marked for busy polling */
+    for (size_t i = 0; i < 100; ++i) /* warm up */
+      bench_round_trip(fd, msg);
+    const int64_t cpu = bench_thread_cpu(BENCH_SERVER_THREAD);
+    const int64_t start = fio_time_micro();
+    for (size_t i = 0; i < BENCH_ROUND_TRIPS; ++i) {
+      rtt[i] = bench_round_trip(fd, msg);
+      nanosleep(&think, NULL);
+    }
+    const int64_t wall = fio_time_micro() - start;
+    const int64_t used = bench_thread_cpu(BENCH_SERVER_THREAD) - cpu;
+    fio_sock_close(fd);
+    qsort(rtt, BENCH_ROUND_TRIPS, sizeof(rtt[0]), bench_cmp);
+    fprintf(stderr,
+            "| %uus | %.1f | %.1f | %.1f | %.0f%% |\n",
+            (unsigned)BENCH_WINDOWS[w],
+            rtt[BENCH_ROUND_TRIPS / 2] / 1000.0,
+            rtt[(BENCH_ROUND_TRIPS * 99) / 100] / 1000.0,
+            rtt[(BENCH_ROUND_TRIPS * 999) / 1000] / 1000.0,
+            (100.0 * used) / (wall ? wall : 1));
+  }
+  fprintf(stderr, "\n");
+  fio_srv_stop();
+  return ignr_;
+}
+
+static void bench_start(void *thr_) {
+  FIO_ASSERT(!pthread_create((pthread_t *)thr_, NULL, bench_client, NULL),
+             "couldn't start the client thread");
+}
+
+/* *****************************************************************************
+Main
+***************************************************************************** */
+
+int main(void) {
+  pthread_t client;
+  FIO_LOG_LEVEL = FIO_LOG_LEVEL_WARNING;
+  BENCH_SERVER_THREAD = pthread_self();
+  FIO_ASSERT(fio_srv_listen(.url = "tcp://127.0.0.1:" BENCH_PORT,
+                            .protocol = &ECHO_PROTOCOL),
+             "couldn't listen on port " BENCH_PORT);
+  fio_state_callback_add(FIO_CALL_ON_START, bench_start, &client);
+  fio_srv_start(0);
+  pthread_join(client, NULL);
+  return 0;
+}
@@ -18,6 +18,15 @@
 #define FIO_MALLOC_TMP_USE_SYSTEM 1
 #include <fio-stl.h>
 
+/* the same allocator, with chunks backed by huge pages (see --huge) */
+#define FIO_MEMORY_NAME                   fio_huge
+#define FIO_MEMORY_INITIALIZE_ALLOCATIONS 0
+#define FIO_MEMORY_HUGE_PAGES             2
+#ifdef DEBUG
+#define FIO_MEMORY_ARENA_COUNT 2
+#endif
+#include <fio-stl.h>
+
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,6 +36,12 @@
 #include <sys/resource.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 static size_t TEST_CYCLES_START;
 static size_t TEST_CYCLES_END;
 static size_t TEST_CYCLES_REPEAT;
@@ -74,8 +89,9 @@ static size_t test_mem_functions(void *(*malloc_func)(size_t),
                                  realloc_func_p realloc_func,
                                  void (*free_func)(void *)) {
   static size_t clock_alloc = 0, clock_realloc = 0, clock_free = 0,
-                clock_free2 = 0, clock_calloc = 0, fio_optimized = 0,
-                fio_optimized2 = 0, errors = 0, repetitions = 0;
+                clock_free2 = 0, clock_calloc = 0, clock_grow = 0,
+                fio_optimized = 0, fio_optimized2 = 0, errors = 0,
+                repetitions = 0;
 
   const size_t size_units = TEST_CYCLES_END - TEST_CYCLES_START;
   const size_t pointers_per_unit =
@@ -84,12 +100,13 @@ static size_t test_mem_functions(void *(*malloc_func)(size_t),
 
   if (!malloc_func) {
     size_t total = clock_alloc + clock_realloc + clock_free + clock_free2 +
-                   clock_calloc + fio_optimized + fio_optimized2;
+                   clock_calloc + clock_grow + fio_optimized + fio_optimized2;
     clock_alloc /= repetitions;
     clock_realloc /= repetitions;
     clock_free /= repetitions;
     clock_free2 /= repetitions;
     clock_calloc /= repetitions;
+    clock_grow /= repetitions;
     fio_optimized /= repetitions;
     fio_optimized2 /= repetitions;
     if (!calloc_func) {
@@ -108,6 +125,10 @@ static size_t test_mem_functions(void *(*malloc_func)(size_t),
       fprintf(stderr,
               "* Micro-seconds performing free (re-cycle): %zu\n",
               clock_free2);
+      fprintf(stderr,
+              "* Micro-seconds performing a growing realloc"
+              " (string builder): %zu\n",
+              clock_grow);
       fprintf(stderr,
               "* Micro-seconds performing a zero-life span"
               " (malloc-free): %zu\n",
@@ -126,6 +147,7 @@ static size_t test_mem_functions(void *(*malloc_func)(size_t),
     clock_free = 0;
     clock_free2 = 0;
     clock_calloc = 0;
+    clock_grow = 0;
     fio_optimized = 0;
     fio_optimized2 = 0;
     errors = 0;
@@ -206,6 +228,29 @@ static size_t test_mem_functions(void *(*malloc_func)(size_t),
     }
     fio_atomic_add(&clock_free2, fio_time_micro() - start);
 
+    /* realloc heavy - grow a buffer 16 bytes at a time (string builder) */
+    start = fio_time_micro();
+    for (size_t unit = 0; unit < size_units; ++unit) {
+      const size_t bytes = (TEST_CYCLES_START + unit) << 4;
+      char *buf = malloc_func(16);
+      if (!buf) {
+        ++errors;
+        continue;
+      }
+      buf[0] = '1';
+      for (size_t len = 16; len < bytes; len += 16) {
+        char *tmp = REALLOC_FUNC(realloc_func, buf, len + 16, len);
+        if (!tmp) {
+          ++errors;
+          break;
+        }
+        buf = tmp;
+        buf[len] = '1';
+      }
+      free_func(buf);
+    }
+    fio_atomic_add(&clock_grow, fio_time_micro() - start);
+
     /* immediate use-release */
     start = fio_time_micro();
     for (size_t pi = 0; pi < pointers_per_unit; ++pi) {
@@ -280,6 +325,97 @@ void *test_facil_malloc(void *ignr) {
   return (void *)result;
 }
 
+void *test_huge_malloc(void *ignr) {
+  (void)ignr;
+#if TEST_WITH_REALLOC2
+  uintptr_t result = test_mem_functions(fio_huge_malloc,
+                                        fio_huge_calloc,
+                                        fio_huge_realloc2,
+                                        fio_huge_free);
+#else
+  uintptr_t result = test_mem_functions(fio_huge_malloc,
+                                        fio_huge_calloc,
+                                        fio_huge_realloc,
+                                        fio_huge_free);
+#endif
+  return (void *)result;
+}
+
+/* *****************************************************************************
+dTLB miss counting (Linux perf events, when available)
+***************************************************************************** */
+
+/* opens a dTLB load miss counter for this process and any new threads */
+static int test_dtlb_open(void) {
+#if defined(__linux__) && defined(__NR_perf_event_open)
+  struct perf_event_attr attr;
+  FIO_MEMSET(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+/* prints and closes the dTLB load miss counter */
+static void test_dtlb_close(int fd) {
+  uint64_t misses = 0;
+  if (fd == -1) {
+    fprintf(stderr, "* dTLB load misses: unavailable (perf events)\n");
+    return;
+  }
+#if !FIO_OS_WIN
+  if (read(fd, &misses, sizeof(misses)) == sizeof(misses))
+    fprintf(stderr, "* dTLB load misses: %zu\n", (size_t)misses);
+  close(fd);
+#endif
+}
+
+/* *****************************************************************************
+Test runner
+***************************************************************************** */
+
+static void test_run_threads(void *(*task)(void *), size_t thread_count) {
+#if _MSC_VER
+  fio_thread_t threads[100];
+  FIO_ASSERT(thread_count < 100,
+             "Windows MSVC has anooying limitations and defaults.");
+
+#else
+  fio_thread_t threads[thread_count];
+#endif
+  for (size_t i = 0; i < thread_count; ++i) {
+    FIO_ASSERT(fio_thread_create(threads + i, task, NULL) == 0,
+               "Couldn't spawn thread.");
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    FIO_ASSERT(fio_thread_join(threads + i) == 0,
+               "Couldn't join thread %zu. errno: %d",
+               i,
+               errno);
+  }
+}
+
+static void test_run(void *(*task)(void *),
+                     size_t thread_count,
+                     size_t warmup) {
+  if (warmup) {
+    test_run_threads(task, thread_count);
+    test_mem_functions(NULL, calloc, NULL, NULL);
+  }
+  int dtlb = test_dtlb_open();
+  test_run_threads(task, thread_count);
+  test_mem_functions(NULL, NULL, NULL, NULL);
+  test_dtlb_close(dtlb);
+}
+
 /* *****************************************************************************
 Main function
 ***************************************************************************** */
@@ -308,12 +444,15 @@ int main(int argc, char const *argv[]) {
       FIO_CLI_PRINT(
           "maximum amount of bytes allocated is at least twice the minimal."),
       FIO_CLI_BOOL(
-          "--warmup -w perform a warmup cycle before testing allocator."));
+          "--warmup -w perform a warmup cycle before testing allocator."),
+      FIO_CLI_BOOL("--huge -hp also test fio_malloc with huge page backed "
+                   "chunks (compare throughput and dTLB misses)."));
 
   TEST_CYCLES_REPEAT = (size_t)fio_cli_get_i("-c");
   TEST_CYCLES_START = (15 + (size_t)fio_cli_get_i("-s")) >> 4;
   TEST_CYCLES_END = (15 + (size_t)fio_cli_get_i("-e")) >> 5;
   size_t warmup = fio_cli_get_bool("-w");
+  size_t huge = fio_cli_get_bool("-hp");
   if (TEST_CYCLES_START >= TEST_CYCLES_END)
     TEST_CYCLES_END = TEST_CYCLES_START + 1;
   if (!TEST_CYCLES_REPEAT)
@@ -329,15 +468,6 @@ int main(int argc, char const *argv[]) {
   fio_cli_end();
   fio_free(fio_malloc(16)); /* initialize allocator if needed */
   free(malloc(16));         /* initialize allocator if needed */
-#if _MSC_VER
-  fio_thread_t threads[100];
-  FIO_ASSERT(thread_count < 100,
-             "Windows MSVC has anooying limitations and defaults.");
-
-#else
-  fio_thread_t threads[thread_count];
-#endif
-
   fprintf(stderr, "========================================\n");
   fprintf(stderr, FIO_MALLOC_TEST_NOTICE "\n");
   fio_malloc_print_settings();
@@ -372,31 +502,19 @@ int main(int argc, char const *argv[]) {
           "Performance Testing facil.io memory allocator with %zu threads "
           "(please wait):\n\n",
           thread_count);
-  if (warmup) {
-    for (size_t i = 0; i < thread_count; ++i) {
-      FIO_ASSERT(fio_thread_create(threads + i, test_facil_malloc, NULL) == 0,
-                 "Couldn't spawn thread.");
-    }
-    for (size_t i = 0; i < thread_count; ++i) {
-      FIO_ASSERT(fio_thread_join(threads + i) == 0,
-                 "Couldn't join thread %zu. errno: %d",
-                 i,
-                 errno);
-    }
-    test_mem_functions(NULL, calloc, NULL, NULL);
-  }
+  test_run(test_facil_malloc, thread_count, warmup);
 
-  for (size_t i = 0; i < thread_count; ++i) {
-    FIO_ASSERT(fio_thread_create(threads + i, test_facil_malloc, NULL) == 0,
-               "Couldn't spawn thread.");
-  }
-  for (size_t i = 0; i < thread_count; ++i) {
-    FIO_ASSERT(fio_thread_join(threads + i) == 0,
-               "Couldn't join thread %zu. errno: %d",
-               i,
-               errno);
+  /* test facil.io allocations using huge pages */
+  if (huge) {
+    fprintf(stderr, "========================================\n");
+    fprintf(stderr,
+            "Performance Testing facil.io memory allocator using huge pages "
+            "with %zu threads (please wait):\n\n",
+            thread_count);
+    fio_huge_free(fio_huge_malloc(16)); /* initialize allocator */
+    fio_huge_malloc_print_settings();
+    test_run(test_huge_malloc, thread_count, warmup);
   }
-  test_mem_functions(NULL, NULL, NULL, NULL);
 
   /* test system allocations */
   fprintf(stderr, "========================================\n");
@@ -404,30 +522,7 @@ int main(int argc, char const *argv[]) {
           "Performance Testing system memory allocator with %zu threads "
           "(please wait):\n\n",
           thread_count);
-  if (warmup) {
-    for (size_t i = 0; i < thread_count; ++i) {
-      FIO_ASSERT(fio_thread_create(threads + i, test_system_malloc, NULL) == 0,
-                 "Couldn't spawn thread.");
-    }
-    for (size_t i = 0; i < thread_count; ++i) {
-      FIO_ASSERT(fio_thread_join(threads + i) == 0,
-                 "Couldn't join thread %zu. errno: %d",
-                 i,
-                 errno);
-    }
-    test_mem_functions(NULL, calloc, NULL, NULL);
-  }
-  for (size_t i = 0; i < thread_count; ++i) {
-    FIO_ASSERT(fio_thread_create(threads + i, test_system_malloc, NULL) == 0,
-               "Couldn't spawn thread.");
-  }
-  for (size_t i = 0; i < thread_count; ++i) {
-    FIO_ASSERT(fio_thread_join(threads + i) == 0,
-               "Couldn't join thread %zu. errno: %d",
-               i,
-               errno);
-  }
-  test_mem_functions(NULL, NULL, NULL, NULL);
+  test_run(test_system_malloc, thread_count, warmup);
 
   return 0; // fio_cycles > sys_cycles;
 }
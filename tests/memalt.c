@@ -0,0 +1,179 @@
+/* benchmarks the memalt SIMD kernels against the system's (libc) functions */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* memmem */
+#endif
+#define FIO_MEMALT
+#define FIO_LOG
+#define FIO_TIME
+#define FIO_CLI
+#include "fio-stl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t TEST_BYTES_MAX;
+static size_t TEST_BYTES_PER_ROUND;
+
+/* volatile function pointers prevent the compiler from inlining builtins */
+static void *(*volatile sys_memchr)(const void *, int, size_t) = memchr;
+static int (*volatile sys_memcmp)(const void *, const void *, size_t) = memcmp;
+static size_t (*volatile sys_strlen)(const char *) = strlen;
+static void *(*volatile sys_memcpy)(void *, const void *, size_t) = memcpy;
+static size_t (*volatile sys_strcspn)(const char *, const char *) = strcspn;
+static void *(*volatile sys_memmem)(const void *,
+                                    size_t,
+                                    const void *,
+                                    size_t) = memmem;
+
+/* prints the throughput for `repetitions` rounds over `len` bytes */
+static void test_print(const char *name,
+                       size_t len,
+                       size_t repetitions,
+                       uint64_t start) {
+  uint64_t micro = fio_time_micro() - start;
+  if (!micro)
+    micro = 1;
+  fprintf(stderr,
+          "\t%-12s(%8zu bytes):\t%10.2f MB/s\n",
+          name,
+          len,
+          ((double)len * repetitions) / (double)micro);
+}
+
+static void test_size(char *a, char *b, size_t len) {
+  const size_t repetitions = (TEST_BYTES_PER_ROUND / len) + 1;
+  uint64_t start;
+  memset(a, 'a', len + 1);
+  memset(b, 'a', len + 1);
+  a[len] = 0; /* the token / NUL byte is at the end of the buffer */
+  b[len] = 0;
+
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(fio_memchr(a, 0, len + 1) == a + len, "fio_memchr failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("fio_memchr", len, repetitions, start);
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(sys_memchr(a, 0, len + 1) == a + len, "memchr failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("memchr", len, repetitions, start);
+
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(fio_strlen(a) == len, "fio_strlen failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("fio_strlen", len, repetitions, start);
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(sys_strlen(a) == len, "strlen failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("strlen", len, repetitions, start);
+
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(!fio_memcmp(a, b, len + 1), "fio_memcmp failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("fio_memcmp", len, repetitions, start);
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(!sys_memcmp(a, b, len + 1), "memcmp failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("memcmp", len, repetitions, start);
+
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    fio_memcpy(b + 1, a, len);
+    FIO_COMPILER_GUARD;
+  }
+  test_print("fio_memcpy", len, repetitions, start);
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    sys_memcpy(b + 1, a, len);
+    FIO_COMPILER_GUARD;
+  }
+  test_print("memcpy", len, repetitions, start);
+
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(fio_memchr3(a, '\r', '\n', 0, len + 1) == a + len,
+               "fio_memchr3 failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("fio_memchr3", len, repetitions, start);
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(sys_strcspn(a, "\r\n") == len, "strcspn failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("strcspn", len, repetitions, start);
+
+  a[len] = 'b'; /* the needle is at the end of the buffer */
+  a[len - (len > 1)] = 'b';
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(fio_memmem(a, len + 1, "ab", 2), "fio_memmem failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("fio_memmem", len, repetitions, start);
+  start = fio_time_micro();
+  for (size_t i = 0; i < repetitions; ++i) {
+    FIO_ASSERT(sys_memmem(a, len + 1, "ab", 2), "memmem failed");
+    FIO_COMPILER_GUARD;
+  }
+  test_print("memmem", len, repetitions, start);
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char const *argv[]) {
+  fio_cli_start(argc,
+                argv,
+                0,
+                0,
+                "This program speed tests the fio_memchr, fio_strlen, "
+                "fio_memcmp, fio_memcpy, fio_memchr3 and fio_memmem (memalt) "
+                "kernels against the system's (libc) implementation.\n\n"
+                "the following arguments are available:",
+                FIO_CLI_INT("--start-from -s (16) the smallest buffer to test "
+                            "(sizes grow by a factor of 4)."),
+                FIO_CLI_INT("--end-at -e (1048576) the largest buffer to test."),
+                FIO_CLI_INT("--round -r (256) the amount of megabytes to "
+                            "process for each test."));
+  size_t len = (size_t)fio_cli_get_i("-s");
+  TEST_BYTES_MAX = (size_t)fio_cli_get_i("-e");
+  TEST_BYTES_PER_ROUND = (size_t)fio_cli_get_i("-r") << 20;
+  fio_cli_end();
+  if (!len)
+    len = 1;
+  if (TEST_BYTES_MAX < len)
+    TEST_BYTES_MAX = len;
+
+#if DEBUG
+  fprintf(stderr,
+          "\n=== WARNING: performance tests using the DEBUG mode are "
+          "invalid. \n");
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__amd64__))
+  __builtin_cpu_init();
+  fprintf(stderr,
+          "* CPU AVX2 support: %s (FIO_MEMALT_SIMD %d)\n",
+          (__builtin_cpu_supports("avx2") ? "yes" : "no"),
+          (int)FIO_MEMALT_SIMD);
+#endif
+
+  char *a = (char *)malloc(TEST_BYTES_MAX + 64);
+  char *b = (char *)malloc(TEST_BYTES_MAX + 64);
+  FIO_ASSERT_ALLOC(a && b);
+  for (; len <= TEST_BYTES_MAX; len <<= 2)
+    test_size(a, b, len);
+  free(a);
+  free(b);
+  return 0;
+}